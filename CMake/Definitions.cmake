@@ -13,11 +13,15 @@ foreach(
   GPERF
   GPERF_HEAP_MAIN
   GPERF_HEAP_FIRST_GAME_ITERATION
+  PERF_TRACE
   STREAM_ALL_AUDIO
   PACKET_ENCRYPTION
   DEVILUTIONX_RESAMPLER_SPEEX
   DEVILUTIONX_RESAMPLER_SDL
   DEVILUTIONX_PALETTE_TRANSPARENCY_BLACK_16_LUT
+  DEVILUTIONX_MMAP_MPQ
+  DEVILUTIONX_CL2_CACHE
+  DEVILUTIONX_ALLOCATION_TRACKING
 )
   if(${def_name})
     list(APPEND DEVILUTIONX_DEFINITIONS ${def_name})
@@ -86,6 +90,8 @@ foreach(
   JOY_BUTTON_BACK
   REMAP_KEYBOARD_KEYS
   DEVILUTIONX_DEFAULT_RESAMPLER
+  DEVILUTIONX_MPQ_BLOCK_CACHE_SIZE
+  DEVILUTIONX_PLAYER_GRAPHICS_BUDGET
 )
   if(DEFINED ${def_name})
     list(APPEND DEVILUTIONX_DEFINITIONS ${def_name}=${${def_name}})
@@ -219,6 +219,10 @@ if(BUILD_TESTING)
   endif()
 endif()
 
+if(BUILD_BENCHMARKS)
+  find_package(benchmark REQUIRED)
+endif()
+
 if(GPERF)
   find_package(Gperftools REQUIRED)
   message("INFO: ${GPERFTOOLS_LIBRARIES}")
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <string>
+#include <utility>
 
 #include "DiabloUI/art_draw.h"
 #include "DiabloUI/button.h"
@@ -17,11 +18,13 @@
 #include "engine/dx.h"
 #include "engine/load_pcx.hpp"
 #include "engine/render/cl2_render.hpp"
+#include "engine/surface.hpp"
 #include "hwcursor.hpp"
 #include "utils/display.h"
 #include "utils/language.h"
 #include "utils/log.hpp"
 #include "utils/pcx_to_cl2.hpp"
+#include "utils/perf_scope.hpp"
 #include "utils/sdl_compat.h"
 #include "utils/sdl_geometry.h"
 #include "utils/sdl_wrap.h"
@@ -80,6 +83,17 @@ bool allowEmptyTextInput = false;
 uint32_t fadeTc;
 int fadeValue = 0;
 
+/**
+ * @brief The backgrounds of the current menu, composed once so that every frame only has to copy them.
+ */
+struct BackgroundLayer {
+	std::optional<OwnedSurface> surface;
+	/** @brief The images the layer was composed from, with their sprite data in case the art was reloaded. */
+	std::vector<std::pair<const UiItemBase *, const byte *>> items;
+};
+
+BackgroundLayer CachedBackground;
+
 struct ScrollBarState {
 	bool upArrowPressed;
 	bool downArrowPressed;
@@ -558,6 +572,8 @@ void LoadHeros()
 
 void LoadUiGFX()
 {
+	DVL_PERF_FUNCTION();
+
 	if (gbIsHellfire) {
 		ArtLogo = LoadPcxSpriteSheetAsCl2("ui_art\\hf_logo2.pcx", /*numFrames=*/16, /*transparentColor=*/0);
 	} else {
@@ -594,13 +610,17 @@ void UnloadUiGFX()
 	for (std::optional<devilution::OwnedCelSpriteWithFrameHeight> &override : ArtHeroOverrides)
 		override = std::nullopt;
 	ArtCursor.Unload();
+	FreeHardwareCursors();
 	for (auto &art : ArtFocus)
 		art = std::nullopt;
 	ArtLogo = std::nullopt;
+	CachedBackground = {};
 }
 
 void UiInitialize()
 {
+	DVL_PERF_FUNCTION();
+
 	LoadUiGFX();
 
 	if (ArtCursor.surface != nullptr) {
@@ -683,6 +703,7 @@ bool UiLoadBlackBackground()
 void LoadBackgroundArt(const char *pszFile, int frames)
 {
 	ArtBackground = std::nullopt;
+	CachedBackground = {};
 	SDL_Color pPal[256];
 	ArtBackground = LoadPcxSpriteSheetAsCl2(pszFile, static_cast<uint16_t>(frames), /*transparentColor=*/std::nullopt, pPal);
 	if (!ArtBackground)
@@ -821,14 +842,19 @@ void Render(const UiArtText *uiArtText)
 	DrawString(out, uiArtText->GetText(), MakeRectangle(uiArtText->m_rect), uiArtText->GetFlags(), uiArtText->GetSpacing(), uiArtText->GetLineHeight());
 }
 
-void Render(const UiImageCl2 *uiImage)
+void RenderImage(const UiImageCl2 &uiImage, const Surface &out)
 {
-	CelFrameWithHeight sprite = uiImage->sprite();
-	int x = uiImage->m_rect.x;
-	if (uiImage->isCentered()) {
-		x += GetCenterOffset(sprite.width(), uiImage->m_rect.w);
+	CelFrameWithHeight sprite = uiImage.sprite();
+	int x = uiImage.m_rect.x;
+	if (uiImage.isCentered()) {
+		x += GetCenterOffset(sprite.width(), uiImage.m_rect.w);
 	}
-	RenderCl2Sprite(Surface(DiabloUiSurface()), sprite, { x, uiImage->m_rect.y });
+	RenderCl2Sprite(out, sprite, { x, uiImage.m_rect.y });
+}
+
+void Render(const UiImageCl2 *uiImage)
+{
+	RenderImage(*uiImage, Surface(DiabloUiSurface()));
 }
 
 void Render(const UiImageAnimatedCl2 *uiImage)
@@ -946,6 +972,55 @@ void RenderItem(UiItemBase *item)
 	}
 }
 
+bool IsBackgroundImage(const UiItemBase &item)
+{
+	if (!item.IsType(UiType::ImageCl2) || item.IsHidden())
+		return false;
+	const byte *data = static_cast<const UiImageCl2 &>(item).sprite().sprite.Data();
+	return (ArtBackground && data == ArtBackground->sprite(0).sprite.Data())
+	    || (ArtBackgroundWidescreen && data == ArtBackgroundWidescreen->sprite().sprite.Data());
+}
+
+/**
+ * @brief Draws the backgrounds a menu starts with (see UiAddBackground) from the cached layer.
+ *
+ * Decoding the full-screen backgrounds is most of the cost of drawing an idle menu. The layer is composed on black,
+ * which is also what UiClearScreen leaves behind the backgrounds that don't cover the whole screen.
+ *
+ * @return The number of leading items that have been drawn
+ */
+template <typename T>
+size_t RenderBackgroundLayer(const std::vector<T> &items)
+{
+	size_t count = 0;
+	while (count < items.size() && IsBackgroundImage(*items[count]))
+		count++;
+	if (count == 0)
+		return 0;
+
+	const Surface out(DiabloUiSurface());
+	bool valid = CachedBackground.surface && CachedBackground.surface->w() == out.w() && CachedBackground.surface->h() == out.h()
+	    && CachedBackground.items.size() == count;
+	for (size_t i = 0; valid && i < count; i++) {
+		const UiItemBase *item = &*items[i];
+		valid = CachedBackground.items[i].first == item && CachedBackground.items[i].second == static_cast<const UiImageCl2 *>(item)->sprite().sprite.Data();
+	}
+
+	if (!valid) {
+		CachedBackground.surface.emplace(out.w(), out.h());
+		SDL_FillRect(CachedBackground.surface->surface, nullptr, 0);
+		CachedBackground.items.clear();
+		for (size_t i = 0; i < count; i++) {
+			const auto &image = static_cast<const UiImageCl2 &>(*items[i]);
+			RenderImage(image, *CachedBackground.surface);
+			CachedBackground.items.emplace_back(&image, image.sprite().sprite.Data());
+		}
+	}
+
+	out.BlitFrom(*CachedBackground.surface, MakeSdlRect(0, 0, out.w(), out.h()), { 0, 0 });
+	return count;
+}
+
 bool HandleMouseEventArtTextButton(const SDL_Event &event, const UiArtTextButton *uiButton)
 {
 	if (event.type != SDL_MOUSEBUTTONUP || event.button.button != SDL_BUTTON_LEFT) {
@@ -1065,14 +1140,14 @@ void LoadPalInMem(const SDL_Color *pPal)
 
 void UiRenderItems(const std::vector<UiItemBase *> &items)
 {
-	for (const auto &item : items)
-		RenderItem(item);
+	for (size_t i = RenderBackgroundLayer(items); i < items.size(); i++)
+		RenderItem(items[i]);
 }
 
 void UiRenderItems(const std::vector<std::unique_ptr<UiItemBase>> &items)
 {
-	for (const auto &item : items)
-		RenderItem(item.get());
+	for (size_t i = RenderBackgroundLayer(items); i < items.size(); i++)
+		RenderItem(items[i].get());
 }
 
 bool UiItemMouseEvents(SDL_Event *event, const std::vector<UiItemBase *> &items)
@@ -71,6 +71,7 @@ bool IsGameCompatible(const GameData &data)
 	return (data.versionMajor == PROJECT_VERSION_MAJOR
 	    && data.versionMinor == PROJECT_VERSION_MINOR
 	    && data.versionPatch == PROJECT_VERSION_PATCH
+	    && data.protocolVersion == NetworkProtocolVersion
 	    && data.programid == GAME_ID);
 	return false;
 }
@@ -96,6 +97,8 @@ static std::string GetErrorMessageIncompatibility(const GameData &data)
 			return std::string(_("The host is running a different game than you."));
 		}
 		return fmt::format(fmt::runtime(_("The host is running a different game mode ({:s}) than you.")), gameMode);
+	} else if (data.versionMajor == PROJECT_VERSION_MAJOR && data.versionMinor == PROJECT_VERSION_MINOR && data.versionPatch == PROJECT_VERSION_PATCH) {
+		return std::string(_(/* TRANSLATORS: Error message when somebody tries to join a game of a build with the same version but other network messages. */ "The host is running an incompatible build of your version."));
 	} else {
 		return fmt::format(fmt::runtime(_(/* TRANSLATORS: Error message when somebody tries to join a game running another version. */ "Your version {:s} does not match the host {:d}.{:d}.{:d}.")), PROJECT_VERSION, data.versionMajor, data.versionMinor, data.versionPatch);
 	}
@@ -5,17 +5,25 @@
  */
 #include "automap.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
 #include <fmt/format.h>
 
 #include "control.h"
 #include "engine/load_file.hpp"
 #include "engine/palette.h"
 #include "engine/render/automap_render.hpp"
+#include "engine/surface.hpp"
 #include "levels/gendung.h"
 #include "levels/setmaps.h"
 #include "player.h"
 #include "utils/language.h"
 #include "utils/stdcompat/algorithm.hpp"
+#include "utils/stdcompat/optional.hpp"
 #include "utils/ui_fwd.h"
 #include "utils/utf8.hpp"
 
@@ -361,28 +369,30 @@ void SearchAutomapItem(const Surface &out, const Displacement &myPlayerOffset)
 	const int endX = clamp(tile.x + 8, 0, MAXDUNX);
 	const int endY = clamp(tile.y + 8, 0, MAXDUNY);
 
-	for (int i = startX; i < endX; i++) {
-		for (int j = startY; j < endY; j++) {
-			if (dItem[i][j] == 0)
-				continue;
-
-			int px = i - 2 * AutomapOffset.deltaX - ViewPosition.x;
-			int py = j - 2 * AutomapOffset.deltaY - ViewPosition.y;
-
-			Point screen = {
-				(myPlayerOffset.deltaX * AutoMapScale / 100 / 2) + (px - py) * AmLine16 + gnScreenWidth / 2,
-				(myPlayerOffset.deltaY * AutoMapScale / 100 / 2) + (px + py) * AmLine8 + (gnScreenHeight - GetMainPanel().size.height) / 2
-			};
-
-			if (CanPanelsCoverView()) {
-				if (IsRightPanelOpen())
-					screen.x -= 160;
-				if (IsLeftPanelOpen())
-					screen.x += 160;
-			}
-			screen.y -= AmLine8;
-			DrawDiamond(out, screen, MapColorsItem);
+	// The floor items are already listed in ActiveItems, which is cheaper to walk than the square of dItem around the player.
+	for (uint8_t i = 0; i < ActiveItemCount; i++) {
+		const Point position = Items[ActiveItems[i]].position;
+		if (position.x < startX || position.x >= endX || position.y < startY || position.y >= endY)
+			continue;
+		if (dItem[position.x][position.y] == 0)
+			continue;
+
+		int px = position.x - 2 * AutomapOffset.deltaX - ViewPosition.x;
+		int py = position.y - 2 * AutomapOffset.deltaY - ViewPosition.y;
+
+		Point screen = {
+			(myPlayerOffset.deltaX * AutoMapScale / 100 / 2) + (px - py) * AmLine16 + gnScreenWidth / 2,
+			(myPlayerOffset.deltaY * AutoMapScale / 100 / 2) + (px + py) * AmLine8 + (gnScreenHeight - GetMainPanel().size.height) / 2
+		};
+
+		if (CanPanelsCoverView()) {
+			if (IsRightPanelOpen())
+				screen.x -= 160;
+			if (IsLeftPanelOpen())
+				screen.x += 160;
 		}
+		screen.y -= AmLine8;
+		DrawDiamond(out, screen, MapColorsItem);
 	}
 }
 
@@ -405,6 +415,7 @@ void DrawAutomapPlr(const Surface &out, const Displacement &myPlayerOffset, int
 	Displacement playerOffset = player.position.offset;
 	if (player.IsWalking())
 		playerOffset = GetOffsetForWalking(player.AnimInfo, player._pdir);
+	playerOffset += GetPredictedWalkOffset(player);
 
 	Point base = {
 		((playerOffset.deltaX + myPlayerOffset.deltaX) * AutoMapScale / 100 / 2) + (px - py) * AmLine16 + gnScreenWidth / 2,
@@ -536,6 +547,134 @@ void DrawAutomapText(const Surface &out)
 	DrawString(out, description, linePosition);
 }
 
+/**
+ * @brief Renders the explored tiles, starting with the tile `map` at `screen`.
+ */
+void DrawAutomapTiles(const Surface &out, Point screen, Point map, int cells)
+{
+	for (int i = 0; i <= cells + 1; i++) {
+		Point tile1 = screen;
+		for (int j = 0; j < cells; j++) {
+			DrawAutomapTile(out, tile1, { map.x + j, map.y - j });
+			tile1.x += AmLine64;
+		}
+		map.y++;
+
+		Point tile2 { screen.x - AmLine32, screen.y + AmLine16 };
+		for (int j = 0; j <= cells; j++) {
+			DrawAutomapTile(out, tile2, { map.x + j, map.y - j });
+			tile2.x += AmLine64;
+		}
+		map.x++;
+		screen.y += AmLine32;
+	}
+}
+
+/**
+ * @brief The rendered automap tiles, they only change when tiles are explored or the map is moved by a whole tile.
+ *
+ * The tiles are rendered with a margin around the output, so that the smooth scrolling while walking
+ * only moves the rendered image instead of rendering it again.
+ */
+class AutomapTileCache {
+public:
+	void Draw(const Surface &out, Point screen, Displacement scroll, Point map, int cells)
+	{
+		if (std::abs(scroll.deltaX) > Margin() || std::abs(scroll.deltaY) > Margin()) {
+			DrawAutomapTiles(out, screen + scroll, map, cells);
+			return;
+		}
+		if (!IsUpToDate(out, screen, map, cells))
+			Render(out, screen, map, cells);
+		Composite(out, { margin_ - scroll.deltaX, margin_ - scroll.deltaY });
+	}
+
+	void Invalidate()
+	{
+		valid_ = false;
+	}
+
+private:
+	/** @brief Fills the pixels that no tile drew to, the automap never draws with it. */
+	static constexpr uint8_t TransparentColor = PAL16_GRAY + 15;
+
+	/** @brief More than the largest walking offset, which is half a tile at any scale. */
+	static int Margin()
+	{
+		return AmLine64;
+	}
+
+	bool IsUpToDate(const Surface &out, Point screen, Point map, int cells) const
+	{
+		return valid_ && outSize_ == Size { out.w(), out.h() } && screen_ == screen && map_ == map && cells_ == cells && amLine64_ == AmLine64
+		    && memcmp(view_, AutomapView, sizeof(view_)) == 0 && memcmp(dungeon_, dungeon, sizeof(dungeon_)) == 0;
+	}
+
+	void Render(const Surface &out, Point screen, Point map, int cells)
+	{
+		valid_ = true;
+		outSize_ = { out.w(), out.h() };
+		screen_ = screen;
+		map_ = map;
+		cells_ = cells;
+		amLine64_ = AmLine64;
+		memcpy(view_, AutomapView, sizeof(view_));
+		memcpy(dungeon_, dungeon, sizeof(dungeon_));
+		margin_ = Margin();
+
+		const Size size { outSize_.width + 2 * margin_, outSize_.height + 2 * margin_ };
+		if (!surface_ || surface_->w() != size.width || surface_->h() != size.height)
+			surface_.emplace(size);
+		for (int y = 0; y < size.height; y++)
+			memset(surface_->at(0, y), TransparentColor, size.width);
+
+		DrawAutomapTiles(*surface_, screen + Displacement { margin_, margin_ }, map, cells);
+
+		// Remember which part of each row was drawn to, so that compositing skips the empty parts.
+		rowSpans_.resize(size.height);
+		for (int y = 0; y < size.height; y++) {
+			const uint8_t *row = surface_->at(0, y);
+			int first = 0;
+			while (first < size.width && row[first] == TransparentColor)
+				first++;
+			int last = size.width;
+			while (last > first && row[last - 1] == TransparentColor)
+				last--;
+			rowSpans_[y] = { first, last };
+		}
+	}
+
+	void Composite(const Surface &out, Displacement origin) const
+	{
+		for (int y = 0; y < out.h(); y++) {
+			const std::pair<int, int> &span = rowSpans_[y + origin.deltaY];
+			const int begin = std::max(span.first - origin.deltaX, 0);
+			const int end = std::min(span.second - origin.deltaX, out.w());
+			const uint8_t *src = surface_->at(origin.deltaX, y + origin.deltaY);
+			uint8_t *dst = out.at(0, y);
+			for (int x = begin; x < end; x++) {
+				if (src[x] != TransparentColor)
+					dst[x] = src[x];
+			}
+		}
+	}
+
+	std::optional<OwnedSurface> surface_;
+	/** @brief First and one past the last drawn column of each row. */
+	std::vector<std::pair<int, int>> rowSpans_;
+	int margin_ = 0;
+	bool valid_ = false;
+	Size outSize_;
+	Point screen_;
+	Point map_;
+	int cells_;
+	int amLine64_;
+	uint8_t view_[DMAXX][DMAXY];
+	uint8_t dungeon_[DMAXX][DMAXY];
+};
+
+AutomapTileCache AutomapTiles;
+
 std::unique_ptr<AutomapTile[]> LoadAutomapData(size_t &tileCount)
 {
 	switch (leveltype) {
@@ -588,6 +727,7 @@ void InitAutomap()
 	}
 
 	memset(AutomapView, 0, sizeof(AutomapView));
+	AutomapTiles.Invalidate();
 
 	for (auto &column : dFlags)
 		for (auto &dFlag : column)
@@ -674,6 +814,7 @@ void DrawAutomap(const Surface &out)
 	Displacement myPlayerOffset = ScrollInfo.offset;
 	if (myPlayer.IsWalking())
 		myPlayerOffset = GetOffsetForWalking(myPlayer.AnimInfo, myPlayer._pdir, true);
+	myPlayerOffset -= GetPredictedWalkOffset(myPlayer);
 
 	int d = (AutoMapScale * 64) / 100;
 	int cells = 2 * (gnScreenWidth / 2 / d) + 1;
@@ -704,8 +845,7 @@ void DrawAutomap(const Surface &out)
 		screen.y -= AmLine8;
 	}
 
-	screen.x += AutoMapScale * myPlayerOffset.deltaX / 100 / 2;
-	screen.y += AutoMapScale * myPlayerOffset.deltaY / 100 / 2;
+	const Displacement scroll { AutoMapScale * myPlayerOffset.deltaX / 100 / 2, AutoMapScale * myPlayerOffset.deltaY / 100 / 2 };
 
 	if (CanPanelsCoverView()) {
 		if (IsRightPanelOpen()) {
@@ -716,24 +856,7 @@ void DrawAutomap(const Surface &out)
 		}
 	}
 
-	Point map = { Automap.x - cells, Automap.y - 1 };
-
-	for (int i = 0; i <= cells + 1; i++) {
-		Point tile1 = screen;
-		for (int j = 0; j < cells; j++) {
-			DrawAutomapTile(out, tile1, { map.x + j, map.y - j });
-			tile1.x += AmLine64;
-		}
-		map.y++;
-
-		Point tile2 { screen.x - AmLine32, screen.y + AmLine16 };
-		for (int j = 0; j <= cells; j++) {
-			DrawAutomapTile(out, tile2, { map.x + j, map.y - j });
-			tile2.x += AmLine64;
-		}
-		map.x++;
-		screen.y += AmLine32;
-	}
+	AutomapTiles.Draw(out, screen, scroll, { Automap.x - cells, Automap.y - 1 }, cells);
 
 	for (int playerId = 0; playerId < MAX_PLRS; playerId++) {
 		Player &player = Players[playerId];
@@ -1,21 +1,54 @@
 /**
  * @file capture.cpp
  *
- * Implementation of the screenshot function.
+ * Implementation of the screenshot function and the flight recorder.
  */
+#include "capture.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <deque>
 #include <fmt/chrono.h>
 #include <fstream>
+#include <memory>
+#include <vector>
 
 #include "DiabloUI/diabloui.h"
+#include "diablo.h"
 #include "engine/dx.h"
+#include "engine/frame_timings.hpp"
 #include "engine/palette.h"
+#include "levels/gendung.h"
+#include "options.h"
 #include "utils/file_util.h"
 #include "utils/log.hpp"
 #include "utils/paths.h"
 #include "utils/pcx.hpp"
+#include "utils/sdl_thread.h"
 #include "utils/ui_fwd.h"
 
+#ifndef DEVILUTIONX_FLIGHT_RECORDER_SECONDS
+#define DEVILUTIONX_FLIGHT_RECORDER_SECONDS 10
+#endif
+
+#ifndef DEVILUTIONX_FLIGHT_RECORDER_MAX_BYTES
+#define DEVILUTIONX_FLIGHT_RECORDER_MAX_BYTES (64 * 1024 * 1024)
+#endif
+
+#ifndef DEVILUTIONX_FLIGHT_RECORDER_SPIKE_MS
+#define DEVILUTIONX_FLIGHT_RECORDER_SPIKE_MS 100
+#endif
+
+#ifdef _WIN32
+#define FLIGHT_RECORDING_SEPARATOR "\\"
+#else
+#define FLIGHT_RECORDING_SEPARATOR "/"
+#endif
+
 namespace devilution {
 namespace {
 
@@ -75,7 +108,7 @@ bool CapturePal(SDL_Color *palette, std::ofstream *out)
 
  * @return Output buffer
  */
-uint8_t *CaptureEnc(uint8_t *src, uint8_t *dst, int width)
+uint8_t *CaptureEnc(const uint8_t *src, uint8_t *dst, int width)
 {
 	int rleLength;
 
@@ -112,18 +145,18 @@ uint8_t *CaptureEnc(uint8_t *src, uint8_t *dst, int width)
 /**
  * @brief Write the pixel data to the PCX file
  *
- * @param buf Pixel data
+ * @param pixels Pixel data, without padding between the rows
+ * @param width Image width
+ * @param height Image height
  * @param out File stream for the PCX file.
  * @return True if successful, else false
  */
-bool CapturePix(const Surface &buf, std::ofstream *out)
+bool CapturePix(const uint8_t *pixels, int width, int height, std::ofstream *out)
 {
-	int width = buf.w();
 	std::unique_ptr<uint8_t[]> pBuffer { new uint8_t[2 * width] };
-	uint8_t *pixels = buf.begin();
-	for (int height = buf.h(); height > 0; height--) {
+	for (; height > 0; height--) {
 		const uint8_t *pBufferEnd = CaptureEnc(pixels, pBuffer.get(), width);
-		pixels += buf.pitch();
+		pixels += width;
 		out->write(reinterpret_cast<const char *>(pBuffer.get()), pBufferEnd - pBuffer.get());
 		if (out->fail())
 			return false;
@@ -131,6 +164,192 @@ bool CapturePix(const Surface &buf, std::ofstream *out)
 	return true;
 }
 
+/** @brief A copy of the screen that is encoded by ScreenshotThread, the main thread only touches it after joining the thread. */
+struct Screenshot {
+	std::string path;
+	std::ofstream out;
+	int width;
+	int height;
+	std::unique_ptr<uint8_t[]> pixels;
+	SDL_Color palette[256];
+};
+
+std::unique_ptr<Screenshot> CurrentScreenshot;
+SdlThread ScreenshotThread;
+
+int SDLCALL EncodeScreenshot(void *data)
+{
+	Screenshot &screenshot = *static_cast<Screenshot *>(data);
+	bool success = CaptureHdr(screenshot.width, screenshot.height, &screenshot.out);
+	if (success) {
+		success = CapturePix(screenshot.pixels.get(), screenshot.width, screenshot.height, &screenshot.out);
+	}
+	if (success) {
+		success = CapturePal(screenshot.palette, &screenshot.out);
+	}
+	screenshot.out.close();
+
+	if (!success) {
+		Log("Failed to save screenshot at {}", screenshot.path);
+		RemoveFile(screenshot.path.c_str());
+	} else {
+		Log("Screenshot saved at {}", screenshot.path);
+	}
+	return 0;
+}
+
+/** @brief A frame kept by the flight recorder, the pixels are stored as encoded PCX rows so that saving only writes them. */
+struct RecordedFrame {
+	/** @brief Microseconds since the previous frame was finished. */
+	uint32_t frameUs;
+	FrameStageTimes stageUs;
+	int width;
+	int height;
+	/** @brief Empty if the frame wasn't drawn. */
+	std::vector<uint8_t> pixels;
+	std::array<SDL_Color, 256> palette;
+};
+
+/** @brief Frames handed over to FlightRecordingThread, the main thread only touches them after joining the thread. */
+struct FlightRecording {
+	std::string folder;
+	std::deque<RecordedFrame> frames;
+	/** @brief The frame time that triggered the recording, 0 if it was saved by hand. */
+	uint32_t spikeUs;
+	std::atomic<bool> done;
+};
+
+bool FlightRecorderActive;
+/** @brief The last DEVILUTIONX_FLIGHT_RECORDER_SECONDS of frames, oldest first. */
+std::deque<RecordedFrame> RecordedFrames;
+size_t RecordedBytes;
+/** @brief Sum of the frame times of RecordedFrames. */
+uint64_t RecordedUs;
+uint64_t LastRecordedFrameUs;
+/** @brief Row buffer of CaptureEnc, an encoded row can take up to twice the width. */
+std::vector<uint8_t> RecorderRow;
+/** @brief The level of the last recorded frame, the frame after a level change includes the loading screen. */
+std::array<int, 3> RecordedLevel;
+
+std::unique_ptr<FlightRecording> CurrentFlightRecording;
+SdlThread FlightRecordingThread;
+
+uint64_t MicrosecondsNow()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void JoinFlightRecordingThread()
+{
+	FlightRecordingThread.join();
+	CurrentFlightRecording = nullptr;
+}
+
+std::string FlightRecordingTimingsToJson(const FlightRecording &recording)
+{
+	std::string out = "{\"spike_us\":";
+	out += recording.spikeUs != 0 ? std::to_string(recording.spikeUs) : "null";
+	out += ",\"frames\":[";
+	for (size_t i = 0; i < recording.frames.size(); i++) {
+		const RecordedFrame &frame = recording.frames[i];
+		if (i != 0)
+			out += ',';
+		out += fmt::format("{{\"index\":{},\"drawn\":{},\"frame_us\":{},\"stages\":{{", i, frame.pixels.empty() ? "false" : "true", frame.frameUs);
+		for (size_t j = 0; j < NumFrameStages; j++) {
+			if (j != 0)
+				out += ',';
+			out += fmt::format("\"{}\":{}", GetFrameStageName(static_cast<FrameStage>(j)), frame.stageUs[j]);
+		}
+		out += "}}";
+	}
+	out += "]}\n";
+	return out;
+}
+
+int SDLCALL SaveFlightRecordingFrames(void *data)
+{
+	FlightRecording &recording = *static_cast<FlightRecording *>(data);
+	bool success = CreateDir(recording.folder.c_str());
+	for (size_t i = 0; success && i < recording.frames.size(); i++) {
+		RecordedFrame &frame = recording.frames[i];
+		if (frame.pixels.empty())
+			continue;
+		const std::string path = recording.folder + fmt::format(FLIGHT_RECORDING_SEPARATOR "frame-{:04}.PCX", i);
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		success = CaptureHdr(frame.width, frame.height, &out);
+		if (success) {
+			out.write(reinterpret_cast<const char *>(frame.pixels.data()), frame.pixels.size());
+			success = !out.fail();
+		}
+		if (success)
+			success = CapturePal(frame.palette.data(), &out);
+	}
+	if (success) {
+		std::ofstream out(recording.folder + FLIGHT_RECORDING_SEPARATOR "timings.json", std::ios::trunc);
+		out << FlightRecordingTimingsToJson(recording);
+		success = !out.fail();
+	}
+
+	if (!success)
+		Log("Failed to save flight recording at {}", recording.folder);
+	else
+		Log("Flight recording of {} frames saved at {}", recording.frames.size(), recording.folder);
+	recording.done = true;
+	return 0;
+}
+
+/**
+ * @brief Hands the recorded frames over to the flight recording thread, recording starts over afterwards.
+ * @param spikeUs The frame time that triggered the recording, 0 if it was saved by hand
+ */
+void StartSavingFlightRecording(uint32_t spikeUs)
+{
+	JoinFlightRecordingThread();
+
+	std::time_t tt = std::time(nullptr);
+	std::tm *tm = std::localtime(&tt);
+	const std::string folder = paths::PrefPath() + fmt::format("Flight recording from {:%Y-%m-%d %H-%M-%S}", *tm);
+	auto recording = std::make_unique<FlightRecording>();
+	recording->folder = folder;
+	for (int i = 1; FileExists(recording->folder.c_str()); i++)
+		recording->folder = folder + "-" + std::to_string(i);
+	recording->frames = std::move(RecordedFrames);
+	recording->spikeUs = spikeUs;
+	recording->done = false;
+	RecordedFrames.clear();
+	RecordedBytes = 0;
+	RecordedUs = 0;
+
+	CurrentFlightRecording = std::move(recording);
+	FlightRecordingThread = SdlThread { SaveFlightRecordingFrames, CurrentFlightRecording.get() };
+}
+
+void StopFlightRecorder()
+{
+	SetLastFrameTimingsEnabled(false);
+	RecordedFrames.clear();
+	RecordedFrames.shrink_to_fit();
+	RecordedBytes = 0;
+	RecordedUs = 0;
+	RecorderRow = {};
+	FlightRecorderActive = false;
+}
+
+/** @brief Drops the oldest frames that are too old or over the memory budget, the pixel storage of the last one is kept for reuse. */
+std::vector<uint8_t> DropExpiredFrames()
+{
+	constexpr uint64_t MaxAgeUs = DEVILUTIONX_FLIGHT_RECORDER_SECONDS * 1000000ULL;
+	std::vector<uint8_t> spare;
+	while (!RecordedFrames.empty() && (RecordedUs > MaxAgeUs || RecordedBytes > DEVILUTIONX_FLIGHT_RECORDER_MAX_BYTES)) {
+		RecordedFrame &oldest = RecordedFrames.front();
+		RecordedUs -= oldest.frameUs;
+		RecordedBytes -= oldest.pixels.size();
+		spare = std::move(oldest.pixels);
+		RecordedFrames.pop_front();
+	}
+	return spare;
+}
+
 std::ofstream CaptureFile(std::string *dstPath)
 {
 	std::time_t tt = std::time(nullptr);
@@ -162,39 +381,105 @@ void RedPalette()
 
 void CaptureScreen()
 {
-	SDL_Color palette[256];
-	std::string fileName;
-	bool success;
+	// The file name is only unique once the previous screenshot exists.
+	WaitForScreenshot();
 
-	std::ofstream outStream = CaptureFile(&fileName);
-	if (!outStream.is_open())
+	auto screenshot = std::make_unique<Screenshot>();
+	screenshot->out = CaptureFile(&screenshot->path);
+	if (!screenshot->out.is_open())
 		return;
 	DrawAndBlit();
-	PaletteGetEntries(256, palette);
-	RedPalette();
+	PaletteGetEntries(256, screenshot->palette);
 
+	// Only copying the frame has to happen right away, encoding and writing the file is left to the screenshot thread
 	const Surface &buf = GlobalBackBuffer();
-	success = CaptureHdr(buf.w(), buf.h(), &outStream);
-	if (success) {
-		success = CapturePix(buf, &outStream);
-	}
-	if (success) {
-		success = CapturePal(palette, &outStream);
-	}
-	outStream.close();
+	screenshot->width = buf.w();
+	screenshot->height = buf.h();
+	screenshot->pixels.reset(new uint8_t[screenshot->width * screenshot->height]);
+	for (int y = 0; y < screenshot->height; y++)
+		memcpy(&screenshot->pixels[y * screenshot->width], buf.at(0, y), screenshot->width);
+	CurrentScreenshot = std::move(screenshot);
+	ScreenshotThread = SdlThread { EncodeScreenshot, CurrentScreenshot.get() };
 
-	if (!success) {
-		Log("Failed to save screenshot at {}", fileName);
-		RemoveFile(fileName.c_str());
-	} else {
-		Log("Screenshot saved at {}", fileName);
-	}
+	if (!*sgOptions.Graphics.screenshotFlash)
+		return;
+	RedPalette();
 	SDL_Delay(300);
 	for (int i = 0; i < 256; i++) {
-		system_palette[i] = palette[i];
+		system_palette[i] = CurrentScreenshot->palette[i];
 	}
 	palette_update();
 	force_redraw = 255;
 }
 
+void WaitForScreenshot()
+{
+	ScreenshotThread.join();
+	CurrentScreenshot = nullptr;
+}
+
+void RecordFlightRecorderFrame(bool drawn)
+{
+	if (!*sgOptions.Graphics.flightRecorder || HeadlessMode) {
+		if (FlightRecorderActive)
+			StopFlightRecorder();
+		return;
+	}
+
+	const uint64_t nowUs = MicrosecondsNow();
+	const std::array<int, 3> level { currlevel, setlevel ? 1 : 0, setlvlnum };
+	if (!FlightRecorderActive) {
+		// The stages are only timed from the next frame on.
+		SetLastFrameTimingsEnabled(true);
+		FlightRecorderActive = true;
+		LastRecordedFrameUs = nowUs;
+		RecordedLevel = level;
+		return;
+	}
+
+	const auto frameUs = static_cast<uint32_t>(std::min<uint64_t>(nowUs - LastRecordedFrameUs, UINT32_MAX));
+	LastRecordedFrameUs = nowUs;
+	const bool levelChanged = level != RecordedLevel;
+	RecordedLevel = level;
+
+	std::vector<uint8_t> pixels = DropExpiredFrames();
+	pixels.clear();
+	RecordedFrame &frame = RecordedFrames.emplace_back();
+	frame.frameUs = frameUs;
+	frame.stageUs = GetLastFrameTimings();
+	if (drawn) {
+		const Surface &buf = GlobalBackBuffer();
+		frame.width = buf.w();
+		frame.height = buf.h();
+		RecorderRow.resize(2 * static_cast<size_t>(frame.width));
+		for (int y = 0; y < frame.height; y++) {
+			uint8_t *rowEnd = CaptureEnc(buf.at(0, y), RecorderRow.data(), frame.width);
+			pixels.insert(pixels.end(), RecorderRow.data(), rowEnd);
+		}
+		PaletteGetEntries(256, frame.palette.data());
+	}
+	frame.pixels = std::move(pixels);
+	RecordedBytes += frame.pixels.size();
+	RecordedUs += frameUs;
+
+	// A single frame doesn't show much, and a recording that is still being saved is left alone.
+	constexpr uint32_t SpikeUs = DEVILUTIONX_FLIGHT_RECORDER_SPIKE_MS * 1000;
+	if (frameUs >= SpikeUs && !levelChanged && RecordedFrames.size() > 1 && (CurrentFlightRecording == nullptr || CurrentFlightRecording->done))
+		StartSavingFlightRecording(frameUs);
+}
+
+void SaveFlightRecording()
+{
+	if (!FlightRecorderActive || RecordedFrames.empty())
+		return;
+	StartSavingFlightRecording(0);
+}
+
+void WaitForFlightRecorder()
+{
+	JoinFlightRecordingThread();
+	if (FlightRecorderActive)
+		StopFlightRecorder();
+}
+
 } // namespace devilution
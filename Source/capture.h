@@ -1,15 +1,36 @@
 /**
  * @file capture.h
  *
- * Interface of the screenshot function.
+ * Interface of the screenshot function and the flight recorder.
  */
 #pragma once
 
 namespace devilution {
 
 /**
- * @brief Save the current screen to a screen??.PCX (00-99) in file if available, then make the screen red for 200ms.
+ * @brief Save the current screen to a screen??.PCX (00-99) in file if available, then make the screen red for 300ms.
+ *
+ * The file is encoded and written on a background thread, the flash can be turned off in the graphics options.
  */
 void CaptureScreen();
 
+/** @brief Waits until the last screenshot has been written. */
+void WaitForScreenshot();
+
+/**
+ * @brief Keeps the frame that was just finished in the flight recorder, if it is turned on in the graphics options.
+ *
+ * The recorder holds the last seconds of frames, RLE encoded like screenshots, together with their stage timings. They
+ * are saved to a folder of PCX files and a timings.json when a frame takes unusually long or by SaveFlightRecording.
+ *
+ * @param drawn Whether the back buffer holds a new frame, otherwise only the timings are kept
+ */
+void RecordFlightRecorderFrame(bool drawn);
+
+/** @brief Saves the frames kept by the flight recorder on a background thread, recording starts over afterwards. */
+void SaveFlightRecording();
+
+/** @brief Waits until the last flight recording has been written and frees the recorded frames. */
+void WaitForFlightRecorder();
+
 } // namespace devilution
@@ -147,7 +147,9 @@ void codec_encode(byte *pbSrcDst, std::size_t size, std::size_t size64, const ch
 	size_t lastChunk = 0;
 	while (size != 0) {
 		const size_t chunk = std::min(size, BlockSizeBytes);
-		memset(buf, 0, sizeof(buf));
+		// Only the last chunk can be partial, the rest of it is encoded as zeroes
+		if (chunk != BlockSizeBytes)
+			memset(buf, 0, sizeof(buf));
 		memcpy(buf, pbSrcDst, chunk);
 		ByteSwapBlock(buf);
 		SHA1Result(context, dst);
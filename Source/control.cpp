@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <iterator>
 #include <string>
 
 #include <fmt/format.h>
@@ -34,6 +35,7 @@
 #include "miniwin/misc_msg.h"
 #include "missiles.h"
 #include "options.h"
+#include "panels/cached_panel.hpp"
 #include "panels/charpanel.hpp"
 #include "panels/mainpanel.hpp"
 #include "panels/spell_book.hpp"
@@ -135,6 +137,10 @@ SDL_Rect PanBtnPos[8] = {
 
 namespace {
 
+constexpr Size MainPanelSize { 640, 128 };
+constexpr int LifeFlaskLowerOffset = 96;
+constexpr int ManaFlaskLowerOffset = 464;
+
 std::optional<OwnedSurface> pLifeBuff;
 std::optional<OwnedSurface> pManaBuff;
 OptionalOwnedCelSprite talkButtons;
@@ -229,25 +235,33 @@ void DrawFlaskUpper(const Surface &out, const Surface &sourceBuffer, int offset,
 		DrawFlask(out, *pBtmBuff, { offset, emptyPortion + 3 }, GetMainPanel().position + Displacement { offset, -13 + emptyPortion }, 13 - emptyPortion);
 }
 
+/**
+ * @brief How much of the life/mana flask inside the bottom panel is filled
+ * @param fillPer How full the flask is (a value from 0 to 80)
+ */
+int GetFlaskLowerFill(int fillPer)
+{
+	return clamp(fillPer, 0, 69);
+}
+
 /**
  * @brief Draws the part of the life/mana flasks inside the bottom panel
  * @see DrawFlaskUpper()
  * @param out The display region to draw to
+ * @param panelPosition Position of the main panel within the display region
  * @param sourceBuffer A sprite representing the appropriate background/empty flask style
  * @param offset X coordinate offset for where the flask should be drawn
- * @param fillPer How full the flask is (a value from 0 to 80)
+ * @param filled How far the flask is filled, see GetFlaskLowerFill()
  */
-void DrawFlaskLower(const Surface &out, const Surface &sourceBuffer, int offset, int fillPer)
+void DrawFlaskLower(const Surface &out, Point panelPosition, const Surface &sourceBuffer, int offset, int filled)
 {
-	int filled = clamp(fillPer, 0, 69);
-
 	if (filled < 69)
-		DrawFlaskTop(out, GetMainPanel().position + Displacement { offset, 0 }, sourceBuffer, 16, 85 - filled);
+		DrawFlaskTop(out, panelPosition + Displacement { offset, 0 }, sourceBuffer, 16, 85 - filled);
 
 	// It appears that the panel defaults to having a filled flask and DrawFlaskTop only overlays the appropriate amount of empty space.
 	// This draw might not be necessary?
 	if (filled > 0)
-		DrawPanelBox(out, MakeSdlRect(offset, 85 - filled, 88, filled), GetMainPanel().position + Displacement { offset, 69 - filled });
+		DrawPanelBox(out, MakeSdlRect(offset, 85 - filled, 88, filled), panelPosition + Displacement { offset, 69 - filled });
 }
 
 void SetButtonStateDown(int btnId)
@@ -257,7 +271,7 @@ void SetButtonStateDown(int btnId)
 	panbtndown = true;
 }
 
-void PrintInfo(const Surface &out)
+void PrintInfo(const Surface &out, Point panelPosition)
 {
 	if (talkflag)
 		return;
@@ -265,7 +279,7 @@ void PrintInfo(const Surface &out)
 	const int LineStart[] = { 70, 58, 52, 48, 46 };
 	const int LineHeights[] = { 30, 24, 18, 15, 12 };
 
-	Rectangle line { GetMainPanel().position + Displacement { 177, LineStart[pnumlines] }, { 288, 12 } };
+	Rectangle line { panelPosition + Displacement { 177, LineStart[pnumlines] }, { 288, 12 } };
 
 	if (!InfoString.empty()) {
 		DrawString(out, InfoString, line, InfoColor | UiFlags::AlignCenter | UiFlags::KerningFitSpacing, 2);
@@ -409,12 +423,140 @@ bool IsLevelUpButtonVisible()
 	return true;
 }
 
+void DrawPanelButtons(const Surface &out, Point panelPosition)
+{
+	for (int i = 0; i < 6; i++) {
+		if (!PanelButtons[i]) {
+			DrawPanelBox(out, MakeSdlRect(PanBtnPos[i].x, PanBtnPos[i].y + 16, 71, 20), panelPosition + Displacement { PanBtnPos[i].x, PanBtnPos[i].y });
+		} else {
+			Point position = panelPosition + Displacement { PanBtnPos[i].x, PanBtnPos[i].y + 18 };
+			Cl2Draw(out, position, CelSprite { *pPanelButtons }, i);
+			DrawArt(out, position + Displacement { 4, -18 }, &PanelButtonDown, i);
+		}
+	}
+	if (PanelButtonIndex == 8) {
+		CelSprite sprite { *multiButtons };
+		Cl2Draw(out, panelPosition + Displacement { 87, 122 }, sprite, PanelButtons[6] ? 1 : 0);
+		if (MyPlayer->friendlyMode)
+			Cl2Draw(out, panelPosition + Displacement { 527, 122 }, sprite, PanelButtons[7] ? 3 : 2);
+		else
+			Cl2Draw(out, panelPosition + Displacement { 527, 122 }, sprite, PanelButtons[7] ? 5 : 4);
+	}
+}
+
+/**
+ * @brief Everything the main panel is drawn from, apart from the spell icon.
+ *
+ * The life and mana rarely change from one frame to the next, so the panel is composed offscreen and only drawn again
+ * when one of these does.
+ */
+struct MainPanelContents {
+	/** @brief Row of the panel background within pBtmBuff, it differs while talking. */
+	int backgroundRow;
+	bool talking;
+	std::string infoString;
+	UiFlags infoColor;
+	int numInfoLines;
+	std::array<std::string, 4> infoLines;
+	int lifeFill;
+	int manaFill;
+	std::array<bool, 8> buttons;
+	int numButtons;
+	bool friendlyMode;
+	BeltContents belt;
+
+	bool operator==(const MainPanelContents &other) const
+	{
+		return backgroundRow == other.backgroundRow && talking == other.talking
+		    && infoString == other.infoString && infoColor == other.infoColor && numInfoLines == other.numInfoLines && infoLines == other.infoLines
+		    && lifeFill == other.lifeFill && manaFill == other.manaFill
+		    && buttons == other.buttons && numButtons == other.numButtons && friendlyMode == other.friendlyMode
+		    && belt == other.belt;
+	}
+};
+
+CachedPanel<MainPanelContents> MainPanelCache { MainPanelSize };
+
+/**
+ * @brief Draws the panel in the same order as the separate draw functions, so that the flasks still cover the edge of
+ * the info box.
+ *
+ * The info box and the buttons are drawn from the globals, which the contents were just taken from.
+ */
+void DrawMainPanelContents(const Surface &out, const MainPanelContents &contents)
+{
+	const Point origin { 0, 0 };
+	DrawPanelBox(out, MakeSdlRect(0, contents.backgroundRow + 16, MainPanelSize.width, MainPanelSize.height), origin);
+	DrawPanelBox(out, { 177, 62, 288, 63 }, origin + Displacement { 177, 46 });
+	if (!contents.infoString.empty() || contents.numInfoLines != 0)
+		PrintInfo(out, origin);
+	DrawFlaskLower(out, origin, *pLifeBuff, LifeFlaskLowerOffset, contents.lifeFill);
+	DrawFlaskLower(out, origin, *pManaBuff, ManaFlaskLowerOffset, contents.manaFill);
+	DrawPanelButtons(out, origin);
+	if (!contents.talking)
+		DrawBeltContents(out, origin, contents.belt);
+}
+
+/** @brief Sets the string shown in the info box, depending on what is under the cursor. */
+void UpdateInfoBox()
+{
+	if (!panelflag && !trigflag && pcursinvitem == -1 && pcursstashitem == uint16_t(-1) && !spselflag) {
+		InfoString = {};
+		InfoColor = UiFlags::ColorWhite;
+		ClearPanel();
+	}
+	Player &myPlayer = *MyPlayer;
+	if (spselflag || trigflag) {
+		InfoColor = UiFlags::ColorWhite;
+	} else if (!myPlayer.HoldItem.isEmpty()) {
+		if (myPlayer.HoldItem._itype == ItemType::Gold) {
+			int nGold = myPlayer.HoldItem._ivalue;
+			InfoString = fmt::format(fmt::runtime(ngettext("{:s} gold piece", "{:s} gold pieces", nGold)), FormatInteger(nGold));
+		} else if (!myPlayer.CanUseItem(myPlayer.HoldItem)) {
+			InfoString = _("Requirements not met");
+		} else {
+			if (myPlayer.HoldItem._iIdentified)
+				InfoString = string_view(myPlayer.HoldItem._iIName);
+			else
+				InfoString = string_view(myPlayer.HoldItem._iName);
+			InfoColor = myPlayer.HoldItem.getTextColor();
+		}
+	} else {
+		if (pcursitem != -1)
+			GetItemStr(Items[pcursitem]);
+		else if (ObjectUnderCursor != nullptr)
+			GetObjectStr(*ObjectUnderCursor);
+		if (pcursmonst != -1) {
+			if (leveltype != DTYPE_TOWN) {
+				const auto &monster = Monsters[pcursmonst];
+				InfoColor = UiFlags::ColorWhite;
+				InfoString = monster.name();
+				ClearPanel();
+				if (monster.isUnique()) {
+					InfoColor = UiFlags::ColorWhitegold;
+					PrintUniqueHistory();
+				} else {
+					PrintMonstHistory(monster.type().type);
+				}
+			} else if (pcursitem == -1) {
+				InfoString = string_view(Towners[pcursmonst].name);
+			}
+		}
+		if (pcursplr != -1) {
+			InfoColor = UiFlags::ColorWhitegold;
+			auto &target = Players[pcursplr];
+			InfoString = string_view(target._pName);
+			ClearPanel();
+			AddPanelString(fmt::format(fmt::runtime(_("{:s}, Level: {:d}")), _(ClassStrTbl[static_cast<std::size_t>(target._pClass)]), target._pLevel));
+			AddPanelString(fmt::format(fmt::runtime(_("Hit Points {:d} of {:d}")), target._pHitPoints >> 6, target._pMaxHP >> 6));
+		}
+	}
+}
+
 } // namespace
 
 void CalculatePanelAreas()
 {
-	constexpr Size MainPanelSize { 640, 128 };
-
 	MainPanel = {
 		{ (gnScreenWidth - MainPanelSize.width) / 2, gnScreenHeight - MainPanelSize.height },
 		MainPanelSize
@@ -468,6 +610,11 @@ void AddPanelString(string_view str)
 		pnumlines++;
 }
 
+string_view GetPanelString(int line)
+{
+	return panelstr[line];
+}
+
 void ClearPanel()
 {
 	pnumlines = 0;
@@ -511,14 +658,12 @@ void DrawManaFlaskUpper(const Surface &out)
 
 void DrawLifeFlaskLower(const Surface &out)
 {
-	constexpr int LifeFlaskLowerOffset = 96;
-	DrawFlaskLower(out, *pLifeBuff, LifeFlaskLowerOffset, MyPlayer->_pHPPer);
+	DrawFlaskLower(out, GetMainPanel().position, *pLifeBuff, LifeFlaskLowerOffset, GetFlaskLowerFill(MyPlayer->_pHPPer));
 }
 
 void DrawManaFlaskLower(const Surface &out)
 {
-	constexpr int ManaFlaskLowerOffeset = 464;
-	DrawFlaskLower(out, *pManaBuff, ManaFlaskLowerOffeset, MyPlayer->_pManaPer);
+	DrawFlaskLower(out, GetMainPanel().position, *pManaBuff, ManaFlaskLowerOffset, GetFlaskLowerFill(MyPlayer->_pManaPer));
 }
 
 void DrawFlaskValues(const Surface &out, Point pos, int currValue, int maxValue)
@@ -530,10 +675,11 @@ void DrawFlaskValues(const Surface &out, Point pos, int currValue, int maxValue)
 		DrawString(out, text, pos, color | UiFlags::KerningFitSpacing, 0);
 	};
 
-	std::string currText = StrCat(currValue);
+	char buf[16];
+	const string_view currText = StrCatTo(buf, currValue);
 	drawStringWithShadow(currText, pos - Displacement { GetLineWidth(currText, GameFont12) + 1, 0 });
 	drawStringWithShadow("/", pos);
-	drawStringWithShadow(StrCat(maxValue), pos + Displacement { GetLineWidth("/", GameFont12) + 1, 0 });
+	drawStringWithShadow(StrCatTo(buf, maxValue), pos + Displacement { GetLineWidth("/", GameFont12) + 1, 0 });
 }
 
 void control_update_life_mana()
@@ -623,32 +769,38 @@ void InitControlPan()
 		InitModifierHints();
 }
 
-void DrawCtrlPan(const Surface &out)
+void DrawMainPanel(const Surface &out)
 {
-	DrawPanelBox(out, MakeSdlRect(0, sgbPlrTalkTbl + 16, GetMainPanel().size.width, GetMainPanel().size.height), GetMainPanel().position);
-	DrawInfoBox(out);
+	static MainPanelContents contents;
+	contents.backgroundRow = sgbPlrTalkTbl;
+	contents.talking = talkflag;
+
+	UpdateInfoBox();
+	contents.infoString.assign(InfoString.str().data(), InfoString.str().size());
+	contents.infoColor = InfoColor;
+	contents.numInfoLines = pnumlines;
+	for (int i = 0; i < 4; i++) {
+		contents.infoLines[i].assign(i < pnumlines ? panelstr[i] : "");
+	}
+
+	contents.lifeFill = GetFlaskLowerFill(MyPlayer->_pHPPer);
+	contents.manaFill = GetFlaskLowerFill(MyPlayer->_pManaPer);
+
+	std::copy(std::begin(PanelButtons), std::end(PanelButtons), contents.buttons.begin());
+	contents.numButtons = PanelButtonIndex;
+	contents.friendlyMode = MyPlayer->friendlyMode;
+
+	if (talkflag)
+		contents.belt = {};
+	else
+		GetBeltContents(contents.belt);
+
+	MainPanelCache.Draw(out, GetMainPanel().position, contents, DrawMainPanelContents);
 }
 
 void DrawCtrlBtns(const Surface &out)
 {
-	const Point mainPanelPosition = GetMainPanel().position;
-	for (int i = 0; i < 6; i++) {
-		if (!PanelButtons[i]) {
-			DrawPanelBox(out, MakeSdlRect(PanBtnPos[i].x, PanBtnPos[i].y + 16, 71, 20), mainPanelPosition + Displacement { PanBtnPos[i].x, PanBtnPos[i].y });
-		} else {
-			Point position = mainPanelPosition + Displacement { PanBtnPos[i].x, PanBtnPos[i].y + 18 };
-			Cl2Draw(out, position, CelSprite { *pPanelButtons }, i);
-			DrawArt(out, position + Displacement { 4, -18 }, &PanelButtonDown, i);
-		}
-	}
-	if (PanelButtonIndex == 8) {
-		CelSprite sprite { *multiButtons };
-		Cl2Draw(out, mainPanelPosition + Displacement { 87, 122 }, sprite, PanelButtons[6] ? 1 : 0);
-		if (MyPlayer->friendlyMode)
-			Cl2Draw(out, mainPanelPosition + Displacement { 527, 122 }, sprite, PanelButtons[7] ? 3 : 2);
-		else
-			Cl2Draw(out, mainPanelPosition + Displacement { 527, 122 }, sprite, PanelButtons[7] ? 5 : 4);
-	}
+	DrawPanelButtons(out, GetMainPanel().position);
 }
 
 void ClearPanBtn()
@@ -837,6 +989,8 @@ void CheckBtnUp()
 			CloseGoldWithdraw();
 			IsStashOpen = false;
 			invflag = !invflag;
+			if (!invflag)
+				DiscardInventoryWeaponGraphics();
 			if (dropGoldFlag) {
 				CloseGoldDrop();
 				dropGoldValue = 0;
@@ -869,6 +1023,7 @@ void CheckBtnUp()
 
 void FreeControlPan()
 {
+	MainPanelCache.Clear();
 	pBtmBuff = std::nullopt;
 	pManaBuff = std::nullopt;
 	pLifeBuff = std::nullopt;
@@ -889,59 +1044,9 @@ void FreeControlPan()
 void DrawInfoBox(const Surface &out)
 {
 	DrawPanelBox(out, { 177, 62, 288, 63 }, GetMainPanel().position + Displacement { 177, 46 });
-	if (!panelflag && !trigflag && pcursinvitem == -1 && pcursstashitem == uint16_t(-1) && !spselflag) {
-		InfoString = {};
-		InfoColor = UiFlags::ColorWhite;
-		ClearPanel();
-	}
-	Player &myPlayer = *MyPlayer;
-	if (spselflag || trigflag) {
-		InfoColor = UiFlags::ColorWhite;
-	} else if (!myPlayer.HoldItem.isEmpty()) {
-		if (myPlayer.HoldItem._itype == ItemType::Gold) {
-			int nGold = myPlayer.HoldItem._ivalue;
-			InfoString = fmt::format(fmt::runtime(ngettext("{:s} gold piece", "{:s} gold pieces", nGold)), FormatInteger(nGold));
-		} else if (!myPlayer.CanUseItem(myPlayer.HoldItem)) {
-			InfoString = _("Requirements not met");
-		} else {
-			if (myPlayer.HoldItem._iIdentified)
-				InfoString = string_view(myPlayer.HoldItem._iIName);
-			else
-				InfoString = string_view(myPlayer.HoldItem._iName);
-			InfoColor = myPlayer.HoldItem.getTextColor();
-		}
-	} else {
-		if (pcursitem != -1)
-			GetItemStr(Items[pcursitem]);
-		else if (ObjectUnderCursor != nullptr)
-			GetObjectStr(*ObjectUnderCursor);
-		if (pcursmonst != -1) {
-			if (leveltype != DTYPE_TOWN) {
-				const auto &monster = Monsters[pcursmonst];
-				InfoColor = UiFlags::ColorWhite;
-				InfoString = monster.name();
-				ClearPanel();
-				if (monster.isUnique()) {
-					InfoColor = UiFlags::ColorWhitegold;
-					PrintUniqueHistory();
-				} else {
-					PrintMonstHistory(monster.type().type);
-				}
-			} else if (pcursitem == -1) {
-				InfoString = string_view(Towners[pcursmonst].name);
-			}
-		}
-		if (pcursplr != -1) {
-			InfoColor = UiFlags::ColorWhitegold;
-			auto &target = Players[pcursplr];
-			InfoString = string_view(target._pName);
-			ClearPanel();
-			AddPanelString(fmt::format(fmt::runtime(_("{:s}, Level: {:d}")), _(ClassStrTbl[static_cast<std::size_t>(target._pClass)]), target._pLevel));
-			AddPanelString(fmt::format(fmt::runtime(_("Hit Points {:d} of {:d}")), target._pHitPoints >> 6, target._pMaxHP >> 6));
-		}
-	}
+	UpdateInfoBox();
 	if (!InfoString.empty() || pnumlines != 0)
-		PrintInfo(out);
+		PrintInfo(out, GetMainPanel().position);
 }
 
 void CheckLvlBtn()
@@ -1060,10 +1165,12 @@ void DrawDurIcon(const Surface &out)
 void RedBack(const Surface &out)
 {
 	uint8_t *dst = out.begin();
-	uint8_t *tbl = GetPauseTRN();
+	const uint8_t *tbl = GetPauseTRN();
+	// Hell cycles the first 32 colors, they stay as they are. Checked once, as the writes through dst could alias leveltype.
+	const uint8_t firstColor = leveltype == DTYPE_HELL ? 32 : 0;
 	for (int h = gnViewportHeight; h != 0; h--, dst += out.pitch() - gnScreenWidth) {
 		for (int w = gnScreenWidth; w != 0; w--) {
-			if (leveltype != DTYPE_HELL || *dst >= 32)
+			if (*dst >= firstColor)
 				*dst = tbl[*dst];
 			dst++;
 		}
@@ -1076,7 +1183,8 @@ void DrawGoldSplit(const Surface &out, int amount)
 
 	Cl2Draw(out, GetPanelPosition(UiPanels::Inventory, { dialogX, 178 }), CelSprite { *pGBoxBuff }, 0);
 
-	const std::string description = fmt::format(
+	FrameString description;
+	fmt::format_to(std::back_inserter(description),
 	    fmt::runtime(ngettext(
 	        /* TRANSLATORS: {:s} is a number with separators. Dialog is shown when splitting a stash of Gold.*/
 	        "You have {:s} gold piece. How many do you want to remove?",
@@ -1085,7 +1193,7 @@ void DrawGoldSplit(const Surface &out, int amount)
 	    FormatInteger(initialDropGoldValue));
 
 	// Pre-wrap the string at spaces, otherwise DrawString would hard wrap in the middle of words
-	const std::string wrapped = WordWrapString(description, 200);
+	const FrameString wrapped = WordWrapStringForFrame(description, 200);
 
 	// The split gold dialog is roughly 4 lines high, but we need at least one line for the player to input an amount.
 	// Using a clipping region 50 units high (approx 3 lines with a lineheight of 17) to ensure there is enough room left
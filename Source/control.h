@@ -77,6 +77,8 @@ void SetSpeedSpell(size_t slot);
 void ToggleSpell(size_t slot);
 
 void AddPanelString(string_view str);
+/** @brief Returns a line added with AddPanelString, line has to be less than pnumlines. */
+string_view GetPanelString(int line);
 void ClearPanel();
 void DrawPanelBox(const Surface &out, SDL_Rect srcRect, Point targetPosition);
 Point GetPanelPosition(UiPanels panel, Point offset = { 0, 0 });
@@ -128,7 +130,13 @@ void control_update_life_mana();
 void DrawSpell(const Surface &out);
 
 void InitControlPan();
-void DrawCtrlPan(const Surface &out);
+
+/**
+ * @brief Draws the control panel with the info box, the lower part of the flasks, the buttons and the belt.
+ *
+ * The panel is composed offscreen and only drawn again when one of these changes, the spell icon is drawn separately.
+ */
+void DrawMainPanel(const Surface &out);
 
 /**
  * Draws the control panel buttons in their current state. If the button is in the default
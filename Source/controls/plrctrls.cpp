@@ -2,7 +2,7 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <list>
+#include <vector>
 
 #ifdef USE_SDL1
 #include "utils/sdl2_to_1_2_backports.h"
@@ -207,7 +207,7 @@ void FindItemOrObject()
 
 void CheckTownersNearby()
 {
-	for (int i = 0; i < 16; i++) {
+	for (int i = 0; i < NumTowners; i++) {
 		int distance = GetDistance(Towners[i].position, 2);
 		if (distance == 0)
 			continue;
@@ -286,7 +286,9 @@ void FindMeleeTarget()
 		int x, y;
 		int steps;
 	};
-	std::list<SearchNode> queue;
+	// Runs every frame. Nodes are only appended, so the queue is a vector that is read from the front and reused.
+	static std::vector<SearchNode> queue;
+	queue.clear();
 
 	Player &myPlayer = *MyPlayer;
 
@@ -297,9 +299,8 @@ void FindMeleeTarget()
 		queue.push_back({ startX, startY, 0 });
 	}
 
-	while (!queue.empty()) {
-		SearchNode node = queue.front();
-		queue.pop_front();
+	for (size_t head = 0; head < queue.size(); head++) {
+		const SearchNode node = queue[head];
 
 		for (auto pathDir : PathDirs) {
 			const int dx = node.x + pathDir.deltaX;
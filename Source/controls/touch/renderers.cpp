@@ -1,5 +1,8 @@
 #include "controls/touch/renderers.h"
 
+#include <algorithm>
+#include <numeric>
+
 #include "control.h"
 #include "cursor.h"
 #include "diablo.h"
@@ -23,6 +26,20 @@ namespace {
 
 VirtualGamepadRenderer Renderer(&VirtualGamepadState);
 
+VirtualGamepadAtlas Atlas;
+
+/** @brief Width the atlas rows are filled up to, unless a single piece of art is wider. */
+constexpr int AtlasRowWidth = 1024;
+
+/** @brief Gap between the regions of the atlas, so that scaling doesn't bleed the neighbouring art in. */
+constexpr int AtlasPadding = 1;
+
+void AddLoadedArt(std::vector<Art *> &loaded, Art &art)
+{
+	if (art.surface != nullptr)
+		loaded.push_back(&art);
+}
+
 VirtualGamepadButtonType GetAttackButtonType(bool isPressed)
 {
 	return isPressed ? GAMEPAD_ATTACKDOWN : GAMEPAD_ATTACK;
@@ -88,7 +105,7 @@ VirtualGamepadButtonType GetStandButtonType(bool isPressed)
 	return isPressed ? GAMEPAD_STANDDOWN : GAMEPAD_STAND;
 }
 
-void LoadButtonArt(Art *buttonArt, SDL_Renderer *renderer)
+void LoadButtonArt(Art *buttonArt)
 {
 	const int Frames = 26;
 	buttonArt->surface.reset(LoadPNG("ui_art\\button.png"));
@@ -98,14 +115,9 @@ void LoadButtonArt(Art *buttonArt, SDL_Renderer *renderer)
 	buttonArt->logical_width = buttonArt->surface->w;
 	buttonArt->frame_height = buttonArt->surface->h / Frames;
 	buttonArt->frames = Frames;
-
-	if (renderer != nullptr) {
-		buttonArt->texture.reset(SDL_CreateTextureFromSurface(renderer, buttonArt->surface.get()));
-		buttonArt->surface = nullptr;
-	}
 }
 
-void LoadPotionArt(Art *potionArt, SDL_Renderer *renderer)
+void LoadPotionArt(Art *potionArt)
 {
 	item_cursor_graphic potionGraphics[] {
 		ICURS_POTION_OF_HEALING,
@@ -149,13 +161,7 @@ void LoadPotionArt(Art *potionArt, SDL_Renderer *renderer)
 	potionArt->logical_width = potionSize.width;
 	potionArt->frame_height = potionSize.height;
 	potionArt->frames = sizeof(potionGraphics);
-
-	if (renderer == nullptr) {
-		potionArt->surface.reset(SDL_ConvertSurfaceFormat(surface.get(), SDL_PIXELFORMAT_ARGB8888, 0));
-	} else {
-		potionArt->texture.reset(SDL_CreateTextureFromSurface(renderer, surface.get()));
-		potionArt->surface = nullptr;
-	}
+	potionArt->surface.reset(SDL_ConvertSurfaceFormat(surface.get(), SDL_PIXELFORMAT_ARGB8888, 0));
 }
 
 bool InteractsWithCharButton(Point point)
@@ -184,6 +190,8 @@ void RenderVirtualGamepad(SDL_Renderer *renderer)
 		return;
 
 	RenderFunction renderFunction = [&](Art &art, SDL_Rect *src, SDL_Rect *dst) {
+		if (Atlas.Add(art, src, *dst))
+			return;
 		if (art.texture == nullptr)
 			return;
 
@@ -192,6 +200,7 @@ void RenderVirtualGamepad(SDL_Renderer *renderer)
 	};
 
 	Renderer.Render(renderFunction);
+	Atlas.Flush(renderer);
 }
 
 void RenderVirtualGamepad(SDL_Surface *surface)
@@ -210,41 +219,173 @@ void RenderVirtualGamepad(SDL_Surface *surface)
 	Renderer.Render(renderFunction);
 }
 
-void VirtualGamepadRenderer::LoadArt(SDL_Renderer *renderer)
+bool VirtualGamepadAtlas::Build(SDL_Renderer *renderer, const std::vector<Art *> &arts)
+{
+	Unload();
+
+	std::vector<size_t> order(arts.size());
+	std::iota(order.begin(), order.end(), 0);
+	// Shelf packing: the tallest art goes first, so that the rows waste little space.
+	std::stable_sort(order.begin(), order.end(), [&arts](size_t a, size_t b) {
+		return arts[a]->surface->h > arts[b]->surface->h;
+	});
+	int rowWidth = AtlasRowWidth;
+	for (const Art *art : arts)
+		rowWidth = std::max(rowWidth, art->surface->w);
+
+	int x = 0;
+	int y = 0;
+	int rowHeight = 0;
+	std::vector<Region> packed;
+	for (size_t i : order) {
+		const SDL_Surface &surface = *arts[i]->surface;
+		if (x + surface.w > rowWidth) {
+			x = 0;
+			y += rowHeight + AtlasPadding;
+			rowHeight = 0;
+		}
+		packed.push_back({ arts[i], MakeSdlRect(x, y, surface.w, surface.h) });
+		textureSize.width = std::max(textureSize.width, x + surface.w);
+		x += surface.w + AtlasPadding;
+		rowHeight = std::max(rowHeight, surface.h);
+	}
+	textureSize.height = y + rowHeight;
+
+	SDL_RendererInfo info;
+	if (SDL_GetRendererInfo(renderer, &info) < 0)
+		ErrSdl();
+	if ((info.max_texture_width != 0 && textureSize.width > info.max_texture_width)
+	    || (info.max_texture_height != 0 && textureSize.height > info.max_texture_height)) {
+		textureSize = {};
+		return false;
+	}
+
+	SDLSurfaceUniquePtr atlasSurface = SDLWrap::CreateRGBSurfaceWithFormat(
+	    /*flags=*/0, textureSize.width, textureSize.height, /*depth=*/32, SDL_PIXELFORMAT_ARGB8888);
+	if (SDL_FillRect(atlasSurface.get(), nullptr, 0) < 0)
+		ErrSdl();
+	for (const Region &region : packed) {
+		SDLSurfaceUniquePtr converted { SDL_ConvertSurfaceFormat(region.art->surface.get(), SDL_PIXELFORMAT_ARGB8888, 0) };
+		if (converted == nullptr)
+			ErrSdl();
+		// The atlas starts out transparent, so the art's alpha is copied rather than blended.
+		if (SDL_SetSurfaceBlendMode(converted.get(), SDL_BLENDMODE_NONE) < 0)
+			ErrSdl();
+		SDL_Rect dst = region.rect;
+		if (SDL_BlitSurface(converted.get(), nullptr, atlasSurface.get(), &dst) < 0)
+			ErrSdl();
+	}
+
+	texture.reset(SDL_CreateTextureFromSurface(renderer, atlasSurface.get()));
+	if (texture == nullptr)
+		ErrSdl();
+	if (SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND) < 0)
+		ErrSdl();
+
+	for (Art *art : arts)
+		art->surface = nullptr;
+	regions = std::move(packed);
+	return true;
+}
+
+bool VirtualGamepadAtlas::Add(const Art &art, const SDL_Rect *src, const SDL_Rect &dst)
 {
-	menuPanelRenderer.LoadArt(renderer);
-	directionPadRenderer.LoadArt(renderer);
-	LoadButtonArt(&buttonArt, renderer);
-	LoadPotionArt(&potionArt, renderer);
+	for (const Region &region : regions) {
+		if (region.art != &art)
+			continue;
+		SDL_Rect atlasSrc = region.rect;
+		if (src != nullptr)
+			atlasSrc = MakeSdlRect(region.rect.x + src->x, region.rect.y + src->y, src->w, src->h);
+		copies.push_back({ atlasSrc, dst });
+		return true;
+	}
+	return false;
 }
 
-void VirtualMenuPanelRenderer::LoadArt(SDL_Renderer *renderer)
+void VirtualGamepadAtlas::Flush(SDL_Renderer *renderer)
 {
-	menuArt.surface.reset(LoadPNG("ui_art\\menu.png"));
-	menuArtLevelUp.surface.reset(LoadPNG("ui_art\\menu-levelup.png"));
+	if (copies.empty())
+		return;
 
-	if (renderer != nullptr) {
-		menuArt.texture.reset(SDL_CreateTextureFromSurface(renderer, menuArt.surface.get()));
-		menuArt.surface = nullptr;
-		menuArtLevelUp.texture.reset(SDL_CreateTextureFromSurface(renderer, menuArtLevelUp.surface.get()));
-		menuArtLevelUp.surface = nullptr;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	static std::vector<SDL_Vertex> vertices;
+	static std::vector<int> indices;
+	vertices.clear();
+	indices.clear();
+	const auto textureWidth = static_cast<float>(textureSize.width);
+	const auto textureHeight = static_cast<float>(textureSize.height);
+	for (const Copy &copy : copies) {
+		const auto first = static_cast<int>(vertices.size());
+		const float left = static_cast<float>(copy.src.x) / textureWidth;
+		const float top = static_cast<float>(copy.src.y) / textureHeight;
+		const float right = static_cast<float>(copy.src.x + copy.src.w) / textureWidth;
+		const float bottom = static_cast<float>(copy.src.y + copy.src.h) / textureHeight;
+		const auto dstLeft = static_cast<float>(copy.dst.x);
+		const auto dstTop = static_cast<float>(copy.dst.y);
+		const auto dstRight = static_cast<float>(copy.dst.x + copy.dst.w);
+		const auto dstBottom = static_cast<float>(copy.dst.y + copy.dst.h);
+		constexpr SDL_Color White { 255, 255, 255, 255 };
+		vertices.push_back({ { dstLeft, dstTop }, White, { left, top } });
+		vertices.push_back({ { dstRight, dstTop }, White, { right, top } });
+		vertices.push_back({ { dstRight, dstBottom }, White, { right, bottom } });
+		vertices.push_back({ { dstLeft, dstBottom }, White, { left, bottom } });
+		for (int corner : { 0, 1, 2, 0, 2, 3 })
+			indices.push_back(first + corner);
 	}
+	if (SDL_RenderGeometry(renderer, texture.get(), vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size())) < 0)
+		ErrSdl();
+#else
+	// Consecutive copies of the same texture are still batched by SDL's renderer.
+	for (const Copy &copy : copies) {
+		if (SDL_RenderCopy(renderer, texture.get(), &copy.src, &copy.dst) < 0)
+			ErrSdl();
+	}
+#endif
+	copies.clear();
 }
 
-void VirtualDirectionPadRenderer::LoadArt(SDL_Renderer *renderer)
+void VirtualGamepadAtlas::Unload()
 {
-	padArt.surface.reset(LoadPNG("ui_art\\directions.png"));
-	knobArt.surface.reset(LoadPNG("ui_art\\directions2.png"));
+	texture = nullptr;
+	textureSize = {};
+	regions.clear();
+	copies.clear();
+}
 
-	if (renderer != nullptr) {
-		padArt.texture.reset(SDL_CreateTextureFromSurface(renderer, padArt.surface.get()));
-		padArt.surface = nullptr;
+void VirtualGamepadRenderer::LoadArt(SDL_Renderer *renderer)
+{
+	std::vector<Art *> loaded;
+	menuPanelRenderer.LoadArt(loaded);
+	directionPadRenderer.LoadArt(loaded);
+	LoadButtonArt(&buttonArt);
+	AddLoadedArt(loaded, buttonArt);
+	LoadPotionArt(&potionArt);
+	AddLoadedArt(loaded, potionArt);
 
-		knobArt.texture.reset(SDL_CreateTextureFromSurface(renderer, knobArt.surface.get()));
-		knobArt.surface = nullptr;
+	if (renderer == nullptr || Atlas.Build(renderer, loaded))
+		return;
+	for (Art *art : loaded) {
+		art->texture.reset(SDL_CreateTextureFromSurface(renderer, art->surface.get()));
+		art->surface = nullptr;
 	}
 }
 
+void VirtualMenuPanelRenderer::LoadArt(std::vector<Art *> &loaded)
+{
+	menuArt.surface.reset(LoadPNG("ui_art\\menu.png"));
+	menuArtLevelUp.surface.reset(LoadPNG("ui_art\\menu-levelup.png"));
+	AddLoadedArt(loaded, menuArt);
+	AddLoadedArt(loaded, menuArtLevelUp);
+}
+
+void VirtualDirectionPadRenderer::LoadArt(std::vector<Art *> &loaded)
+{
+	padArt.surface.reset(LoadPNG("ui_art\\directions.png"));
+	knobArt.surface.reset(LoadPNG("ui_art\\directions2.png"));
+	AddLoadedArt(loaded, padArt);
+	AddLoadedArt(loaded, knobArt);
+}
+
 void VirtualGamepadRenderer::Render(RenderFunction renderFunction)
 {
 	if (CurrentEventHandler == DisableInputEventHandler)
@@ -496,6 +637,7 @@ VirtualGamepadButtonType PotionButtonRenderer::GetButtonType()
 
 void VirtualGamepadRenderer::UnloadArt()
 {
+	Atlas.Unload();
 	menuPanelRenderer.UnloadArt();
 	directionPadRenderer.UnloadArt();
 	buttonArt.Unload();
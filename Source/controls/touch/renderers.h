@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <SDL.h>
 
 #include "DiabloUI/art.h"
@@ -53,6 +55,42 @@ enum VirtualGamepadPotionType {
 
 typedef std::function<void(Art &art, SDL_Rect *src, SDL_Rect *dst)> RenderFunction;
 
+/**
+ * @brief All of the virtual gamepad's art packed into one texture, so that the gamepad renders with a single draw call.
+ */
+class VirtualGamepadAtlas {
+public:
+	/**
+	 * @brief Packs the surfaces of the given art into one texture and frees the surfaces.
+	 * @return false if the art doesn't fit into a texture, the art keeps its surfaces then
+	 */
+	bool Build(SDL_Renderer *renderer, const std::vector<Art *> &arts);
+
+	/** @brief Queues a copy of the art, src is relative to the art and nullptr for all of it. */
+	bool Add(const Art &art, const SDL_Rect *src, const SDL_Rect &dst);
+
+	/** @brief Draws the queued copies. */
+	void Flush(SDL_Renderer *renderer);
+
+	void Unload();
+
+private:
+	struct Region {
+		const Art *art;
+		SDL_Rect rect;
+	};
+
+	struct Copy {
+		SDL_Rect src;
+		SDL_Rect dst;
+	};
+
+	SDLTextureUniquePtr texture;
+	Size textureSize;
+	std::vector<Region> regions;
+	std::vector<Copy> copies;
+};
+
 class VirtualMenuPanelRenderer {
 public:
 	VirtualMenuPanelRenderer(VirtualMenuPanel *virtualMenuPanel)
@@ -60,7 +98,8 @@ public:
 	{
 	}
 
-	void LoadArt(SDL_Renderer *renderer);
+	/** @brief Loads the art as surfaces and appends it to loaded, the gamepad renderer turns it into textures. */
+	void LoadArt(std::vector<Art *> &loaded);
 	void Render(RenderFunction renderFunction);
 	void UnloadArt();
 
@@ -77,7 +116,7 @@ public:
 	{
 	}
 
-	void LoadArt(SDL_Renderer *renderer);
+	void LoadArt(std::vector<Art *> &loaded);
 	void Render(RenderFunction renderFunction);
 	void UnloadArt();
 
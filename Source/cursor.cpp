@@ -16,6 +16,7 @@
 #include "engine/load_cel.hpp"
 #include "engine/point.hpp"
 #include "engine/render/cl2_render.hpp"
+#include "engine/render/scrollrt.h"
 #include "engine/trn.hpp"
 #include "hwcursor.hpp"
 #include "inv.h"
@@ -108,6 +109,67 @@ const uint16_t InvItemHeight2[InvItems2Size] = {
 	// clang-format on
 };
 
+/** @brief Which half of the tile the cursor has to be on for a cell to be probed. */
+enum class ProbeHalf : uint8_t {
+	Any,
+	Unflipped,
+	Flipped,
+};
+
+/** @brief A cell near the cursor's tile that a monster standing on can be selected from, see MonsterData::selectionType. */
+struct MonsterProbe {
+	Displacement offset;
+	ProbeHalf half;
+	uint8_t selectionMask;
+};
+
+/**
+ * @brief The cells the dungeon monsters are looked up in, a later match wins over an earlier one.
+ *
+ * Tall monsters are selectable from the tiles below them (bit 4), regular ones from the tile below (bit 2) and all of
+ * them from their own tile (bit 1).
+ */
+constexpr MonsterProbe DungeonMonsterProbes[] = {
+	{ { 2, 1 }, ProbeHalf::Unflipped, 4 },
+	{ { 1, 2 }, ProbeHalf::Flipped, 4 },
+	{ { 2, 2 }, ProbeHalf::Any, 4 },
+	{ { 1, 0 }, ProbeHalf::Unflipped, 2 },
+	{ { 0, 1 }, ProbeHalf::Flipped, 2 },
+	{ { 0, 0 }, ProbeHalf::Any, 1 },
+	{ { 1, 1 }, ProbeHalf::Any, 2 },
+};
+
+/**
+ * @brief Looks for a selectable dungeon monster around the cursor's tile and sets pcursmonst and cursPosition to it.
+ * @param onlyMonster only this monster is looked for, unless it's -1
+ */
+void FindDungeonMonsterUnderCursor(Point tile, bool flipflag, int onlyMonster)
+{
+	for (const MonsterProbe &probe : DungeonMonsterProbes) {
+		if ((probe.half == ProbeHalf::Unflipped && flipflag) || (probe.half == ProbeHalf::Flipped && !flipflag))
+			continue;
+		const Point position = tile + probe.offset;
+		if (position.x >= MAXDUNX || position.y >= MAXDUNY)
+			continue;
+		if (dMonster[position.x][position.y] == 0 || !IsTileLit(position))
+			continue;
+		const int mi = abs(dMonster[position.x][position.y]) - 1;
+		if (onlyMonster != -1 && mi != onlyMonster)
+			continue;
+		if (Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & probe.selectionMask) != 0) {
+			cursPosition = position;
+			pcursmonst = mi;
+		}
+	}
+	if (pcursmonst != -1 && (Monsters[pcursmonst].flags & MFLAG_HIDDEN) != 0) {
+		pcursmonst = -1;
+		cursPosition = tile;
+	}
+	if (pcursmonst != -1 && (Monsters[pcursmonst].flags & MFLAG_GOLEM) != 0 && (Monsters[pcursmonst].flags & MFLAG_BERSERK) == 0) {
+		pcursmonst = -1;
+	}
+}
+
 } // namespace
 
 /** Current highlighted monster */
@@ -170,7 +232,7 @@ void DrawItem(const Item &item, const Surface &out, Point position, CelSprite ce
 	if (usable) {
 		Cl2Draw(out, position, cel, frame);
 	} else {
-		Cl2DrawTRN(out, position, cel, frame, GetInfravisionTRN());
+		Cl2DrawTRNCached(out, position, cel, frame, GetInfravisionTRN());
 	}
 }
 
@@ -283,7 +345,7 @@ void CheckCursMove()
 		sy = mainPanel.position.y - 1;
 	}
 
-	if (*sgOptions.Graphics.zoom) {
+	if (IsViewZoomed()) {
 		sx /= 2;
 		sy /= 2;
 	}
@@ -296,6 +358,7 @@ void CheckCursMove()
 	Displacement offset = ScrollInfo.offset;
 	if (myPlayer.IsWalking())
 		offset = GetOffsetForWalking(myPlayer.AnimInfo, myPlayer._pdir, true);
+	offset -= GetPredictedWalkOffset(myPlayer);
 	sx -= offset.deltaX - xo;
 	sy -= offset.deltaY - yo;
 
@@ -330,7 +393,7 @@ void CheckCursMove()
 		my++;
 	}
 
-	if (*sgOptions.Graphics.zoom) {
+	if (IsViewZoomed()) {
 		sy -= TILE_HEIGHT / 4;
 	}
 
@@ -415,123 +478,14 @@ void CheckCursMove()
 	}
 
 	if (leveltype != DTYPE_TOWN) {
+		// Keep the previous target while it's still under the cursor, even if another monster is too.
 		if (pcurstemp != -1) {
-			if (!flipflag && mx + 2 < MAXDUNX && my + 1 < MAXDUNY && dMonster[mx + 2][my + 1] != 0 && IsTileLit({ mx + 2, my + 1 })) {
-				int mi = abs(dMonster[mx + 2][my + 1]) - 1;
-				if (mi == pcurstemp && Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 4) != 0) {
-					cursPosition = Point { mx, my } + Displacement { 2, 1 };
-					pcursmonst = mi;
-				}
-			}
-			if (flipflag && mx + 1 < MAXDUNX && my + 2 < MAXDUNY && dMonster[mx + 1][my + 2] != 0 && IsTileLit({ mx + 1, my + 2 })) {
-				int mi = abs(dMonster[mx + 1][my + 2]) - 1;
-				if (mi == pcurstemp && Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 4) != 0) {
-					cursPosition = Point { mx, my } + Displacement { 1, 2 };
-					pcursmonst = mi;
-				}
-			}
-			if (mx + 2 < MAXDUNX && my + 2 < MAXDUNY && dMonster[mx + 2][my + 2] != 0 && IsTileLit({ mx + 2, my + 2 })) {
-				int mi = abs(dMonster[mx + 2][my + 2]) - 1;
-				if (mi == pcurstemp && Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 4) != 0) {
-					cursPosition = Point { mx, my } + Displacement { 2, 2 };
-					pcursmonst = mi;
-				}
-			}
-			if (mx + 1 < MAXDUNX && !flipflag && dMonster[mx + 1][my] != 0 && IsTileLit({ mx + 1, my })) {
-				int mi = abs(dMonster[mx + 1][my]) - 1;
-				if (mi == pcurstemp && Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 2) != 0) {
-					cursPosition = Point { mx, my } + Displacement { 1, 0 };
-					pcursmonst = mi;
-				}
-			}
-			if (my + 1 < MAXDUNY && flipflag && dMonster[mx][my + 1] != 0 && IsTileLit({ mx, my + 1 })) {
-				int mi = abs(dMonster[mx][my + 1]) - 1;
-				if (mi == pcurstemp && Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 2) != 0) {
-					cursPosition = Point { mx, my } + Displacement { 0, 1 };
-					pcursmonst = mi;
-				}
-			}
-			if (dMonster[mx][my] != 0 && IsTileLit({ mx, my })) {
-				int mi = abs(dMonster[mx][my]) - 1;
-				if (mi == pcurstemp && Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 1) != 0) {
-					cursPosition = { mx, my };
-					pcursmonst = mi;
-				}
-			}
-			if (mx + 1 < MAXDUNX && my + 1 < MAXDUNY && dMonster[mx + 1][my + 1] != 0 && IsTileLit({ mx + 1, my + 1 })) {
-				int mi = abs(dMonster[mx + 1][my + 1]) - 1;
-				if (mi == pcurstemp && Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 2) != 0) {
-					cursPosition = Point { mx, my } + Displacement { 1, 1 };
-					pcursmonst = mi;
-				}
-			}
-			if (pcursmonst != -1 && (Monsters[pcursmonst].flags & MFLAG_HIDDEN) != 0) {
-				pcursmonst = -1;
-				cursPosition = { mx, my };
-			}
-			if (pcursmonst != -1 && (Monsters[pcursmonst].flags & MFLAG_GOLEM) != 0 && (Monsters[pcursmonst].flags & MFLAG_BERSERK) == 0) {
-				pcursmonst = -1;
-			}
+			FindDungeonMonsterUnderCursor(currentTile, flipflag, pcurstemp);
 			if (pcursmonst != -1) {
 				return;
 			}
 		}
-		if (!flipflag && mx + 2 < MAXDUNX && my + 1 < MAXDUNY && dMonster[mx + 2][my + 1] != 0 && IsTileLit({ mx + 2, my + 1 })) {
-			int mi = abs(dMonster[mx + 2][my + 1]) - 1;
-			if (Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 4) != 0) {
-				cursPosition = Point { mx, my } + Displacement { 2, 1 };
-				pcursmonst = mi;
-			}
-		}
-		if (flipflag && mx + 1 < MAXDUNX && my + 2 < MAXDUNY && dMonster[mx + 1][my + 2] != 0 && IsTileLit({ mx + 1, my + 2 })) {
-			int mi = abs(dMonster[mx + 1][my + 2]) - 1;
-			if (Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 4) != 0) {
-				cursPosition = Point { mx, my } + Displacement { 1, 2 };
-				pcursmonst = mi;
-			}
-		}
-		if (mx + 2 < MAXDUNX && my + 2 < MAXDUNY && dMonster[mx + 2][my + 2] != 0 && IsTileLit({ mx + 2, my + 2 })) {
-			int mi = abs(dMonster[mx + 2][my + 2]) - 1;
-			if (Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 4) != 0) {
-				cursPosition = Point { mx, my } + Displacement { 2, 2 };
-				pcursmonst = mi;
-			}
-		}
-		if (!flipflag && mx + 1 < MAXDUNX && dMonster[mx + 1][my] != 0 && IsTileLit({ mx + 1, my })) {
-			int mi = abs(dMonster[mx + 1][my]) - 1;
-			if (Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 2) != 0) {
-				cursPosition = Point { mx, my } + Displacement { 1, 0 };
-				pcursmonst = mi;
-			}
-		}
-		if (flipflag && my + 1 < MAXDUNY && dMonster[mx][my + 1] != 0 && IsTileLit({ mx, my + 1 })) {
-			int mi = abs(dMonster[mx][my + 1]) - 1;
-			if (Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 2) != 0) {
-				cursPosition = Point { mx, my } + Displacement { 0, 1 };
-				pcursmonst = mi;
-			}
-		}
-		if (dMonster[mx][my] != 0 && IsTileLit({ mx, my })) {
-			int mi = abs(dMonster[mx][my]) - 1;
-			if (Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 1) != 0) {
-				cursPosition = { mx, my };
-				pcursmonst = mi;
-			}
-		}
-		if (mx + 1 < MAXDUNX && my + 1 < MAXDUNY && dMonster[mx + 1][my + 1] != 0 && IsTileLit({ mx + 1, my + 1 })) {
-			int mi = abs(dMonster[mx + 1][my + 1]) - 1;
-			if (Monsters[mi].hitPoints >> 6 > 0 && (Monsters[mi].data().selectionType & 2) != 0) {
-				cursPosition = Point { mx, my } + Displacement { 1, 1 };
-				pcursmonst = mi;
-			}
-		}
-		if (pcursmonst != -1 && (Monsters[pcursmonst].flags & MFLAG_HIDDEN) != 0) {
-			pcursmonst = -1;
-			cursPosition = { mx, my };
-		}
-		if (pcursmonst != -1 && (Monsters[pcursmonst].flags & MFLAG_GOLEM) != 0 && (Monsters[pcursmonst].flags & MFLAG_BERSERK) == 0) {
-			pcursmonst = -1;
-		}
+		FindDungeonMonsterUnderCursor(currentTile, flipflag, -1);
 	} else {
 		if (!flipflag && mx + 1 < MAXDUNX && dMonster[mx + 1][my] > 0) {
 			pcursmonst = dMonster[mx + 1][my] - 1;
@@ -9,18 +9,25 @@
 #include <fstream>
 #include <sstream>
 
+#include <fmt/format.h>
+
 #include "debug.h"
 
 #include "automap.h"
 #include "control.h"
 #include "cursor.h"
+#include "engine/frame_timings.hpp"
 #include "engine/load_cel.hpp"
 #include "engine/point.hpp"
+#include "engine/render/scrollrt.h"
+#include "engine/render/text_render.hpp"
 #include "error.h"
+#include "init.h"
 #include "inv.h"
 #include "levels/setmaps.h"
 #include "lighting.h"
 #include "miniwin/misc_msg.h"
+#include "missiles.h"
 #include "monstdat.h"
 #include "monster.h"
 #include "plrmsg.h"
@@ -28,8 +35,12 @@
 #include "spells.h"
 #include "towners.h"
 #include "utils/endian_stream.hpp"
+#include "utils/frame_arena.hpp"
 #include "utils/language.h"
 #include "utils/log.hpp"
+#include "utils/memory_budget.hpp"
+#include "utils/paths.h"
+#include "utils/perf_scope.hpp"
 #include "utils/str_cat.hpp"
 
 namespace devilution {
@@ -948,6 +959,101 @@ std::string DebugCmdToggleFPS(const string_view parameter)
 	return "";
 }
 
+std::string DebugCmdNetworkStats(const string_view parameter)
+{
+	ShowNetworkStats = !ShowNetworkStats;
+
+	std::string stats = multi_format_network_stats();
+	if (stats.empty())
+		return "There are no network stats in single player.";
+	return stats;
+}
+
+std::string DebugCmdFontStats(const string_view parameter)
+{
+	const FontCacheStats stats = GetFontCacheStats();
+	return fmt::format("{} font sheets loaded, {} of {} KiB used\n{} hits, {} misses, {} evictions",
+	    stats.fonts, stats.usedBytes / 1024, stats.capacity / 1024, stats.hits, stats.misses, stats.evictions);
+}
+
+std::string DebugCmdPerfOverlay(const string_view parameter)
+{
+	ShowFrameTimings = !ShowFrameTimings;
+	SetLastFrameTimingsEnabled(ShowFrameTimings);
+	return "";
+}
+
+std::string DebugCmdMemoryStats(const string_view parameter)
+{
+	const MonsterGfxStats monsters = GetMonsterGfxStats();
+	const FrameArena &arena = GetFrameArena();
+	std::string stats;
+	for (size_t i = 0; i < NumMemoryTags; i++) {
+		const auto tag = static_cast<MemoryTag>(i);
+		stats += fmt::format("{}: {} KiB, budget {} KiB\n", GetMemoryTagName(tag), GetMemoryUsage(tag) / 1024, GetMemoryBudget(tag) / 1024);
+	}
+	stats += fmt::format("Monster types: {} on the level, {} retained\n"
+	                     "Frame arena: {} of {} KiB",
+	    monsters.levelTypes, monsters.retainedTypes, arena.BytesUsed() / 1024, arena.Capacity() / 1024);
+	const std::optional<MpqArchive> &archive = diabdat_mpq ? diabdat_mpq : spawn_mpq;
+	if (archive) {
+		const MpqBlockCache::Stats blocks = archive->GetBlockCacheStats();
+		StrAppend(stats, "\nMPQ block cache: ", static_cast<int>(blocks.hits), " hits, ", static_cast<int>(blocks.misses), " misses");
+	}
+	return stats;
+}
+
+std::string DebugCmdStressMonsters(const string_view parameter)
+{
+	if (leveltype == DTYPE_TOWN)
+		return "Do you want to kill the towners?!?";
+	if (LevelMonsterTypeCount == 0)
+		return "There are no monster types on this level.";
+
+	const int count = std::max(atoi(std::string(parameter).c_str()), 1);
+	Player &myPlayer = *MyPlayer;
+	int spawnedMonsters = 0;
+	Crawl(0, MaxCrawlRadius, [&](Displacement displacement) -> std::optional<bool> {
+		Point pos = myPlayer.position.tile + displacement;
+		if (dPlayer[pos.x][pos.y] != 0 || dMonster[pos.x][pos.y] != 0 || !IsTileWalkable(pos))
+			return {};
+		// Cycling through the types instead of picking them at random keeps the game's RNG untouched.
+		if (AddMonster(pos, myPlayer._pdir, spawnedMonsters % LevelMonsterTypeCount, true) == nullptr)
+			return false;
+		spawnedMonsters++;
+		if (spawnedMonsters >= count)
+			return true;
+		return {};
+	});
+	return StrCat("Spawned ", spawnedMonsters, " monsters, ", static_cast<int>(ActiveMonsterCount), " are active.");
+}
+
+std::string DebugCmdStressMissiles(const string_view parameter)
+{
+	const int count = std::max(atoi(std::string(parameter).c_str()), 1);
+	const Player &myPlayer = *MyPlayer;
+	const Point src = myPlayer.position.tile;
+	int addedMissiles = 0;
+	for (; addedMissiles < count; addedMissiles++) {
+		const auto dir = static_cast<Direction>(addedMissiles % 8);
+		if (AddMissile(src, src + Displacement(dir) * 8, dir, MIS_FIREBOLT, TARGET_MONSTERS, MyPlayerId, 0, 1) == nullptr)
+			break;
+	}
+	return StrCat("Added ", addedMissiles, " missiles, ", static_cast<int>(Missiles.size()), " are active.");
+}
+
+/** @brief Number of frames left to time for "capture trace". */
+int DebugTraceFramesLeft;
+
+std::string DebugCmdCaptureTrace(const string_view parameter)
+{
+	if (DebugTraceFramesLeft > 0)
+		return StrCat("Still capturing ", DebugTraceFramesLeft, " frames.");
+	DebugTraceFramesLeft = std::max(atoi(std::string(parameter).c_str()), 1);
+	StartFrameTimings();
+	return "";
+}
+
 std::vector<DebugCmdItem> DebugCmdList = {
 	{ "help", "Prints help overview or help for a specific command.", "({command})", &DebugCmdHelp },
 	{ "give gold", "Fills the inventory with gold.", "", &DebugCmdGiveGoldCheat },
@@ -984,6 +1090,13 @@ std::vector<DebugCmdItem> DebugCmdList = {
 	{ "questinfo", "Shows info of quests.", "{id}", &DebugCmdQuestInfo },
 	{ "playerinfo", "Shows info of player.", "{playerid}", &DebugCmdPlayerInfo },
 	{ "fps", "Toggles displaying FPS", "", &DebugCmdToggleFPS },
+	{ "netstats", "Toggles displaying network stats and prints them.", "", &DebugCmdNetworkStats },
+	{ "fontstats", "Prints how much memory the loaded fonts use.", "", &DebugCmdFontStats },
+	{ "perf", "Toggles displaying the time spent in each stage of a frame.", "", &DebugCmdPerfOverlay },
+	{ "memstats", "Prints how much memory the caches and the frame arena use and may use.", "", &DebugCmdMemoryStats },
+	{ "stress monsters", "Spawns {count} monsters of the types on the level.", "{count}", &DebugCmdStressMonsters },
+	{ "stress missiles", "Shoots {count} firebolts around the player.", "{count}", &DebugCmdStressMissiles },
+	{ "capture trace", "Times the next {frames} frames and writes them to frame_timings.json.", "{frames}", &DebugCmdCaptureTrace },
 };
 
 } // namespace
@@ -1046,6 +1159,20 @@ bool CheckDebugTextCommand(const string_view text)
 	return true;
 }
 
+void DebugFinishFrame()
+{
+	if (DebugTraceFramesLeft == 0 || --DebugTraceFramesLeft > 0)
+		return;
+	StopFrameTimings();
+	DVL_PERF_FLUSH();
+	const std::string path = paths::PrefPath() + "frame_timings.json";
+	std::ofstream out(path, std::ios::trunc);
+	out << FrameTimingsToJson();
+	const std::string message = out ? StrCat("Wrote ", static_cast<int>(GetNumTimedFrames()), " frames to ", path) : StrCat("Failed to write ", path);
+	Log("{}", message);
+	EventPlrMsg(message);
+}
+
 bool IsDebugGridTextNeeded()
 {
 	return SelectedDebugGridTextItem != DebugGridTextItem::None;
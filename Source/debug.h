@@ -28,6 +28,8 @@ void GetDebugMonster();
 void NextDebugMonster();
 void SetDebugLevelSeedInfos(uint32_t mid1Seed, uint32_t mid2Seed, uint32_t mid3Seed, uint32_t endSeed);
 bool CheckDebugTextCommand(const string_view text);
+/** @brief Called at the end of every frame, finishes a "capture trace" command. */
+void DebugFinishFrame();
 bool IsDebugGridTextNeeded();
 bool IsDebugGridInMegatiles();
 bool GetDebugGridText(Point dungeonCoords, char *debugGridTextBuffer);
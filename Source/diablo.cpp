@@ -29,6 +29,8 @@
 #include "engine/cel_sprite.hpp"
 #include "engine/demomode.h"
 #include "engine/dx.h"
+#include "engine/frame_timings.hpp"
+#include "engine/input_latency.hpp"
 #include "engine/load_cel.hpp"
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
@@ -76,8 +78,11 @@
 #include "track.h"
 #include "utils/console.h"
 #include "utils/display.h"
+#include "utils/frame_arena.hpp"
+#include "utils/job_system.hpp"
 #include "utils/language.h"
 #include "utils/paths.h"
+#include "utils/perf_scope.hpp"
 #include "utils/stdcompat/string_view.hpp"
 #include "utils/str_cat.hpp"
 #include "utils/utf8.hpp"
@@ -146,6 +151,16 @@ bool was_archives_init = false;
 bool was_window_init = false;
 bool was_ui_init = false;
 
+/** @brief How long a paused game has to go without input before it's redrawn less often, in milliseconds. */
+constexpr uint32_t IdleDelay = 500;
+/** @brief How often an idle game is still redrawn, in milliseconds. */
+constexpr uint32_t IdleRedrawInterval = 250;
+/** @brief How long the loop sleeps between checks for input while idle, in milliseconds. */
+constexpr uint32_t IdleSleepTime = 10;
+
+uint32_t LastActivityTc;
+uint32_t LastIdleRedrawTc;
+
 void StartGame(interface_mode uMsg)
 {
 	CalcViewportGeometry();
@@ -189,8 +204,44 @@ void FreeGame()
 	music_stop();
 }
 
+/**
+ * @brief Whether the picture can only change in response to input, see SkipIdleFrame.
+ *
+ * The world and the palette cycling stand still in a paused game, and the pause text doesn't move. The game menu is
+ * excluded for its animated cursor.
+ */
+bool IsScreenStatic()
+{
+	return PauseMode == 2 && !gmenu_is_active() && !demo::IsRunning() && !demo::IsRecording();
+}
+
+/**
+ * @brief Decides whether the frame can be left out, sleeping instead of presenting.
+ *
+ * A paused game that sees no input for a while is only redrawn every IdleRedrawInterval, so that a game left paused
+ * on a handheld doesn't run at full rate. Any input redraws the next frame.
+ *
+ * @param hadInput Whether any messages were received since the previous frame
+ */
+bool SkipIdleFrame(bool hadInput)
+{
+	const uint32_t now = SDL_GetTicks();
+	if (hadInput || !IsScreenStatic()) {
+		LastActivityTc = now;
+		return false;
+	}
+	if (now - LastActivityTc < IdleDelay || now - LastIdleRedrawTc >= IdleRedrawInterval) {
+		LastIdleRedrawTc = now;
+		return false;
+	}
+	SDL_Delay(IdleSleepTime);
+	return true;
+}
+
 bool ProcessInput()
 {
+	FrameStageTimer frameStageTimer(FrameStage::Input);
+
 	if (PauseMode == 2) {
 		return false;
 	}
@@ -719,6 +770,7 @@ void RunGameLoop(interface_mode uMsg)
 #endif
 
 	while (gbRunGame) {
+		DVL_PERF_SCOPE("RunGameLoop");
 
 #ifdef _DEBUG
 		if (!gbGameLoopStartup && !DebugCmdsFromCommandLine.empty()) {
@@ -729,41 +781,68 @@ void RunGameLoop(interface_mode uMsg)
 		}
 #endif
 
-		while (FetchMessage(&msg)) {
-			if (msg.message == DVL_WM_QUIT) {
-				gbRunGameResult = false;
-				gbRunGame = false;
-				break;
+		bool hadInput = false;
+		{
+			FrameStageTimer inputTimer(FrameStage::Input);
+			while (FetchMessage(&msg)) {
+				hadInput = true;
+				if (msg.message == DVL_WM_QUIT) {
+					gbRunGameResult = false;
+					gbRunGame = false;
+					break;
+				}
+				PushMessage(&msg);
 			}
-			PushMessage(&msg);
 		}
 		if (!gbRunGame)
 			break;
 
 		bool drawGame = true;
 		bool processInput = true;
-		bool runGameLoop = demo::IsRunning() ? demo::GetRunGameLoop(drawGame, processInput) : nthread_has_500ms_passed();
+		bool runGameLoop;
+		if (demo::IsRunning())
+			runGameLoop = demo::GetRunGameLoop(drawGame, processInput);
+		else if (HeadlessMode && !gbIsMultiplayer)
+			runGameLoop = true; // Nobody is watching, so simulations run as fast as they can.
+		else
+			runGameLoop = nthread_has_500ms_passed();
 		if (demo::IsRecording())
 			demo::RecordGameLoopResult(runGameLoop);
 
 		discord_manager::UpdateGame();
+		RunMainThreadJobs();
 
 		if (!runGameLoop) {
 			if (processInput)
 				ProcessInput();
-			if (!drawGame)
+			if (!drawGame || SkipIdleFrame(hadInput))
 				continue;
 			force_redraw |= 1;
 			DrawAndBlit();
+			FinishFrameTimings();
+#ifdef _DEBUG
+			DebugFinishFrame();
+#endif
+			RecordFlightRecorderFrame(/*drawn=*/true);
 			continue;
 		}
 
-		diablo_color_cyc_logic();
-		multi_process_network_packets();
+		if (!HeadlessMode)
+			diablo_color_cyc_logic();
+		{
+			FrameStageTimer networkTimer(FrameStage::Network);
+			multi_process_network_packets();
+		}
 		game_loop(gbGameLoopStartup);
 		gbGameLoopStartup = false;
-		if (drawGame)
+		const bool drawn = drawGame && !SkipIdleFrame(hadInput);
+		if (drawn)
 			DrawAndBlit();
+		FinishFrameTimings();
+#ifdef _DEBUG
+		DebugFinishFrame();
+#endif
+		RecordFlightRecorderFrame(drawn);
 #ifdef GPERF_HEAP_FIRST_GAME_ITERATION
 		if (run_game_iteration++ == 0)
 			HeapProfilerDump("first_game_iteration");
@@ -771,6 +850,9 @@ void RunGameLoop(interface_mode uMsg)
 	}
 
 	demo::NotifyGameLoopEnd();
+	DVL_PERF_FLUSH();
+	if (InputLatencyEnabled)
+		Log("Input latency: {}", InputLatencyToJson());
 
 	if (gbIsMultiplayer) {
 		pfile_write_hero(/*writeGameData=*/false);
@@ -824,6 +906,7 @@ void PrintHelpOption(string_view flags, string_view description)
 	PrintHelpOption("--record <#>", _(/* TRANSLATORS: Commandline Option */ "Record a demo file"));
 	PrintHelpOption("--demo <#>", _(/* TRANSLATORS: Commandline Option */ "Play a demo file"));
 	PrintHelpOption("--timedemo", _(/* TRANSLATORS: Commandline Option */ "Disable all frame limiting during demo playback"));
+	PrintHelpOption("--latency", _(/* TRANSLATORS: Commandline Option */ "Log the input latencies at the end of every game"));
 	printNewlineInConsole();
 	printInConsole(_(/* TRANSLATORS: Commandline Option */ "Game selection:"));
 	printNewlineInConsole();
@@ -905,6 +988,8 @@ void DiabloParseFlags(int argc, char **argv)
 				diablo_quit(0);
 			}
 			recordNumber = SDL_atoi(argv[++i]);
+		} else if (arg == "--latency") {
+			StartInputLatency();
 		} else if (arg == "--create-reference") {
 			createDemoReference = true;
 		} else if (arg == "-n") {
@@ -974,6 +1059,8 @@ void SetApplicationVersions()
 
 void DiabloInit()
 {
+	DVL_PERF_FUNCTION();
+
 	if (*sgOptions.Graphics.showFPS)
 		EnableFrameCount();
 
@@ -1026,7 +1113,7 @@ void DiabloInit()
 
 	ui_sound_init();
 
-	// Item graphics are loaded early, they already get touched during hero selection.
+	// Only resets the item state, the item graphics are loaded when a game starts.
 	InitItemGFX();
 
 	// Always available.
@@ -1035,6 +1122,8 @@ void DiabloInit()
 
 void DiabloSplash()
 {
+	DVL_PERF_FUNCTION();
+
 	if (!gbShowIntro)
 		return;
 
@@ -1069,64 +1158,15 @@ void DiabloDeinit()
 		UiDestroy();
 	if (was_archives_init)
 		init_cleanup();
+	FreeRenderThreads();
 	if (was_window_init)
 		dx_cleanup(); // Cleanup SDL surfaces stuff, so we have to do it before SDL_Quit().
 	UnloadFonts();
+	DVL_PERF_FLUSH();
 	if (SDL_WasInit(SDL_INIT_EVERYTHING & ~SDL_INIT_HAPTIC) != 0)
 		SDL_Quit();
 }
 
-void LoadLvlGFX()
-{
-	assert(pDungeonCels == nullptr);
-	constexpr int SpecialCelWidth = 64;
-
-	switch (leveltype) {
-	case DTYPE_TOWN:
-		if (gbIsHellfire) {
-			pDungeonCels = LoadFileInMem("NLevels\\TownData\\Town.CEL");
-			pMegaTiles = LoadFileInMem<MegaTile>("NLevels\\TownData\\Town.TIL");
-		} else {
-			pDungeonCels = LoadFileInMem("Levels\\TownData\\Town.CEL");
-			pMegaTiles = LoadFileInMem<MegaTile>("Levels\\TownData\\Town.TIL");
-		}
-		pSpecialCels = LoadCelAsCl2("Levels\\TownData\\TownS.CEL", SpecialCelWidth);
-		break;
-	case DTYPE_CATHEDRAL:
-		pDungeonCels = LoadFileInMem("Levels\\L1Data\\L1.CEL");
-		pMegaTiles = LoadFileInMem<MegaTile>("Levels\\L1Data\\L1.TIL");
-		pSpecialCels = LoadCelAsCl2("Levels\\L1Data\\L1S.CEL", SpecialCelWidth);
-		break;
-	case DTYPE_CATACOMBS:
-		pDungeonCels = LoadFileInMem("Levels\\L2Data\\L2.CEL");
-		pMegaTiles = LoadFileInMem<MegaTile>("Levels\\L2Data\\L2.TIL");
-		pSpecialCels = LoadCelAsCl2("Levels\\L2Data\\L2S.CEL", SpecialCelWidth);
-		break;
-	case DTYPE_CAVES:
-		pDungeonCels = LoadFileInMem("Levels\\L3Data\\L3.CEL");
-		pMegaTiles = LoadFileInMem<MegaTile>("Levels\\L3Data\\L3.TIL");
-		pSpecialCels = LoadCelAsCl2("Levels\\L1Data\\L1S.CEL", SpecialCelWidth);
-		break;
-	case DTYPE_HELL:
-		pDungeonCels = LoadFileInMem("Levels\\L4Data\\L4.CEL");
-		pMegaTiles = LoadFileInMem<MegaTile>("Levels\\L4Data\\L4.TIL");
-		pSpecialCels = LoadCelAsCl2("Levels\\L2Data\\L2S.CEL", SpecialCelWidth);
-		break;
-	case DTYPE_NEST:
-		pDungeonCels = LoadFileInMem("NLevels\\L6Data\\L6.CEL");
-		pMegaTiles = LoadFileInMem<MegaTile>("NLevels\\L6Data\\L6.TIL");
-		pSpecialCels = LoadCelAsCl2("Levels\\L1Data\\L1S.CEL", SpecialCelWidth);
-		break;
-	case DTYPE_CRYPT:
-		pDungeonCels = LoadFileInMem("NLevels\\L5Data\\L5.CEL");
-		pMegaTiles = LoadFileInMem<MegaTile>("NLevels\\L5Data\\L5.TIL");
-		pSpecialCels = LoadCelAsCl2("NLevels\\L5Data\\L5S.CEL", SpecialCelWidth);
-		break;
-	default:
-		app_fatal("LoadLvlGFX");
-	}
-}
-
 void LoadAllGFX()
 {
 	IncProgress();
@@ -1227,6 +1267,10 @@ void UpdateMonsterLights()
 
 void GameLogic()
 {
+	FrameStageTimer frameStageTimer(FrameStage::GameLogic);
+
+	if (InputLatencyEnabled)
+		MarkInputTicked();
 	if (!ProcessInput()) {
 		return;
 	}
@@ -1261,7 +1305,10 @@ void GameLogic()
 	}
 #endif
 
-	sound_update();
+	{
+		FrameStageTimer audioTimer(FrameStage::Audio);
+		sound_update();
+	}
 	CheckTriggers();
 	CheckQuests();
 	force_redraw |= 1;
@@ -1322,6 +1369,8 @@ void InventoryKeyPressed()
 	if (stextflag != STORE_NONE)
 		return;
 	invflag = !invflag;
+	if (!invflag)
+		DiscardInventoryWeaponGraphics();
 	if (!IsLeftPanelOpen() && CanPanelsCoverView()) {
 		if (!invflag) { // We closed the invetory
 			if (MousePosition.x < 480 && MousePosition.y < GetMainPanel().position.y) {
@@ -1437,6 +1486,8 @@ bool CanPlayerTakeAction()
 
 void InitKeymapActions()
 {
+	DVL_PERF_FUNCTION();
+
 	for (int i = 0; i < 8; ++i) {
 		sgOptions.Keymapper.AddAction(
 		    "BeltItem{}",
@@ -1648,6 +1699,13 @@ void InitKeymapActions()
 	    SDLK_PRINTSCREEN,
 	    nullptr,
 	    CaptureScreen);
+	sgOptions.Keymapper.AddAction(
+	    "SaveFlightRecording",
+	    N_("Save flight recording"),
+	    N_("Saves the last seconds of frames and their timings, needs the flight recorder in the graphics options."),
+	    SDLK_UNKNOWN,
+	    nullptr,
+	    SaveFlightRecording);
 	sgOptions.Keymapper.AddAction(
 	    "GameInfo",
 	    N_("Game info"),
@@ -1682,12 +1740,9 @@ void InitKeymapActions()
 #endif
 }
 
-void FreeGameMem()
+void FreeLevelMem()
 {
-	pDungeonCels = nullptr;
-	pMegaTiles = nullptr;
-	pSpecialCels = std::nullopt;
-
+	ReleaseLvlGFX();
 	FreeMonsters();
 	FreeMissileGFX();
 	FreeObjectGFX();
@@ -1698,6 +1753,14 @@ void FreeGameMem()
 #endif
 }
 
+void FreeGameMem()
+{
+	FreeLevelMem();
+	FreeTilesets();
+	FreeRetainedMonsterGFX();
+	FreeRetainedTownerGFX();
+}
+
 bool StartGame(bool bNewGame, bool bSinglePlayer)
 {
 	gbSelectProvider = true;
@@ -1714,6 +1777,7 @@ bool StartGame(bool bNewGame, bool bSinglePlayer)
 		// Save 2.8 MiB of RAM by freeing all main menu resources
 		// before starting the game.
 		UiDestroy();
+		LoadItemGFX();
 
 		gbSelectProvider = false;
 
@@ -1831,6 +1895,7 @@ bool TryIconCurs()
 		else if (pcursstashitem != uint16_t(-1)) {
 			Item &item = Stash.stashList[pcursstashitem];
 			item._iIdentified = true;
+			Stash.MarkPageDirty(Stash.GetPage());
 		}
 		NewCursor(CURSOR_HAND);
 		return true;
@@ -1842,6 +1907,7 @@ bool TryIconCurs()
 		else if (pcursstashitem != uint16_t(-1)) {
 			Item &item = Stash.stashList[pcursstashitem];
 			RepairItem(item, myPlayer._pLevel);
+			Stash.MarkPageDirty(Stash.GetPage());
 		}
 		NewCursor(CURSOR_HAND);
 		return true;
@@ -1853,6 +1919,7 @@ bool TryIconCurs()
 		else if (pcursstashitem != uint16_t(-1)) {
 			Item &item = Stash.stashList[pcursstashitem];
 			RechargeItem(item, myPlayer);
+			Stash.MarkPageDirty(Stash.GetPage());
 		}
 		NewCursor(CURSOR_HAND);
 		return true;
@@ -1865,6 +1932,7 @@ bool TryIconCurs()
 		else if (pcursstashitem != uint16_t(-1)) {
 			Item &item = Stash.stashList[pcursstashitem];
 			changeCursor = ApplyOilToItem(item, myPlayer);
+			Stash.MarkPageDirty(Stash.GetPage());
 		}
 		if (changeCursor)
 			NewCursor(CURSOR_HAND);
@@ -2053,6 +2121,8 @@ void DisableInputEventHandler(uint32_t uMsg, uint32_t wParam, uint16_t /*lParam*
 
 void LoadGameLevel(bool firstflag, lvl_entry lvldir)
 {
+	DVL_PERF_FUNCTION();
+
 	_music_id neededTrack = GetLevelMusic(leveltype);
 
 	if (neededTrack != sgnMusicTrack)
@@ -2101,6 +2171,7 @@ void LoadGameLevel(bool firstflag, lvl_entry lvldir)
 		InitVision();
 	}
 
+	InvalidateVisionCache();
 	InitLevelMonsters();
 	IncProgress();
 
@@ -2327,6 +2398,8 @@ void LoadGameLevel(bool firstflag, lvl_entry lvldir)
 
 void game_loop(bool bStartup)
 {
+	DVL_PERF_FUNCTION();
+
 	uint16_t wait = bStartup ? sgGameInitInfo.nTickRate * 3 : 3;
 
 	for (unsigned i = 0; i < wait; i++) {
@@ -2336,11 +2409,14 @@ void game_loop(bool bStartup)
 		}
 		TimeoutCursor(false);
 		GameLogic();
+		NetSendDroppedItems();
+		demo::NotifyGameLogicEnd();
 		ClearLastSendPlayerCmd();
 
 		if (!gbRunGame || !gbIsMultiplayer || demo::IsRunning() || demo::IsRecording() || !nthread_has_500ms_passed())
 			break;
 	}
+	GetFrameArena().Reset();
 }
 
 void diablo_color_cyc_logic()
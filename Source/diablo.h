@@ -83,6 +83,12 @@ extern char gszProductName[64];
 extern MouseActionType LastMouseButtonAction;
 
 void InitKeymapActions();
+
+/**
+ * @brief Frees the graphics of the current level, the tileset is kept for later levels, see ReleaseLvlGFX.
+ */
+void FreeLevelMem();
+
 void FreeGameMem();
 bool StartGame(bool bNewGame, bool bSinglePlayer);
 [[noreturn]] void diablo_quit(int exitStatus);
@@ -4,10 +4,15 @@
  * Implementation of functions for updating game state from network commands.
  */
 
+#include <algorithm>
 #include <list>
 #include <mutex>
 
+#include <SDL.h>
+
+#include "encrypt.h"
 #include "nthread.h"
+#include "storm/storm_net.hpp"
 #include "utils/sdl_cond.h"
 #include "utils/sdl_thread.h"
 
@@ -18,12 +23,14 @@ struct DThreadPkt {
 	_cmd_id cmd;
 	std::unique_ptr<byte[]> data;
 	uint32_t len;
+	bool compress;
 
-	DThreadPkt(int pnum, _cmd_id(cmd), std::unique_ptr<byte[]> data, uint32_t len)
+	DThreadPkt(int pnum, _cmd_id(cmd), std::unique_ptr<byte[]> data, uint32_t len, bool compress)
 	    : pnum(pnum)
 	    , cmd(cmd)
 	    , data(std::move(data))
 	    , len(len)
+	    , compress(compress)
 	{
 	}
 };
@@ -35,9 +42,77 @@ std::list<DThreadPkt> InfoList;
 bool DthreadRunning;
 std::optional<SdlCond> WorkToDo;
 
+/**
+ * @brief Player that the packet being sent goes to, -1 if none.
+ * Packets are sent in chunks, so that the rest of it can be dropped when the player leaves.
+ */
+int SendingToPlayer = -1;
+bool SendingCancelled;
+
+/** @brief Delta data sent per second, so that a player joining doesn't flood the link and delay the turns. */
+uint32_t SendBytesPerSecond;
+uint32_t PacingStart;
+uint64_t BytesPaced;
+
 /* rdata */
 SdlThread Thread;
 
+/**
+ * @brief Compresses everything after the first byte in place and records in the first byte whether it was compressed.
+ * @return The size of the data including the flag byte.
+ */
+uint32_t CompressData(byte *buffer, uint32_t len)
+{
+	const uint32_t size = len - 1;
+	const uint32_t pkSize = PkwareCompress(buffer + 1, size);
+
+	*buffer = size != pkSize ? byte { 1 } : byte { 0 };
+
+	return pkSize + 1;
+}
+
+bool ShouldKeepSending()
+{
+	return DthreadRunning && !SendingCancelled;
+}
+
+/**
+ * @brief Waits until sending more data stays within SendBytesPerSecond. Must be called with DthreadMutex locked.
+ */
+void WaitForBandwidth()
+{
+	while (ShouldKeepSending()) {
+		const uint32_t elapsed = SDL_GetTicks() - PacingStart;
+		const uint64_t due = BytesPaced * 1000 / SendBytesPerSecond;
+		if (elapsed >= due)
+			return;
+		WorkToDo->wait_for(*DthreadMutex, static_cast<Uint32>(due - elapsed));
+	}
+}
+
+void SendInChunks(DThreadPkt &pkt)
+{
+	// Don't let the time spent idle be used for a burst.
+	if (SDL_GetTicks() - PacingStart >= BytesPaced * 1000 / SendBytesPerSecond) {
+		PacingStart = SDL_GetTicks();
+		BytesPaced = 0;
+	}
+
+	for (uint32_t offset = 0; offset < pkt.len;) {
+		WaitForBandwidth();
+		if (!ShouldKeepSending())
+			return;
+
+		DthreadMutex->unlock();
+		const size_t chunkSize = multi_send_zero_packet(pkt.pnum, pkt.cmd, pkt.data.get(), pkt.len, offset);
+		DthreadMutex->lock();
+		if (chunkSize == 0)
+			return;
+		offset += static_cast<uint32_t>(chunkSize);
+		BytesPaced += chunkSize;
+	}
+}
+
 void DthreadHandler()
 {
 	std::lock_guard<SdlMutex> lock(*DthreadMutex);
@@ -45,10 +120,16 @@ void DthreadHandler()
 		while (!InfoList.empty()) {
 			DThreadPkt pkt = std::move(InfoList.front());
 			InfoList.pop_front();
+			SendingToPlayer = pkt.pnum;
+			SendingCancelled = false;
 
 			DthreadMutex->unlock();
-			multi_send_zero_packet(pkt.pnum, pkt.cmd, pkt.data.get(), pkt.len);
+			if (pkt.compress)
+				pkt.len = CompressData(pkt.data.get(), pkt.len);
 			DthreadMutex->lock();
+
+			SendInChunks(pkt);
+			SendingToPlayer = -1;
 		}
 		if (!DthreadRunning)
 			return;
@@ -67,14 +148,18 @@ void dthread_remove_player(uint8_t pnum)
 	InfoList.remove_if([&](auto &pkt) {
 		return pkt.pnum == pnum;
 	});
+	if (SendingToPlayer == pnum) {
+		SendingCancelled = true;
+		WorkToDo->signal();
+	}
 }
 
-void dthread_send_delta(int pnum, _cmd_id cmd, std::unique_ptr<byte[]> data, uint32_t len)
+void dthread_send_delta(int pnum, _cmd_id cmd, std::unique_ptr<byte[]> data, uint32_t len, bool compress)
 {
 	if (!gbIsMultiplayer || !DthreadRunning)
 		return;
 
-	DThreadPkt pkt { pnum, cmd, std::move(data), len };
+	DThreadPkt pkt { pnum, cmd, std::move(data), len, compress };
 
 	std::lock_guard<SdlMutex> lock(*DthreadMutex);
 	InfoList.push_back(std::move(pkt));
@@ -86,6 +171,15 @@ void dthread_start()
 	if (!gbIsMultiplayer)
 		return;
 
+	_SNETCAPS caps;
+	caps.size = 36;
+	SNetGetProviderCaps(&caps);
+	// The turns get three quarters of the bandwidth, see nthread_start.
+	SendBytesPerSecond = std::max<uint32_t>(caps.bytessec / 4, 0x1000);
+	PacingStart = SDL_GetTicks();
+	BytesPaced = 0;
+	SendingToPlayer = -1;
+
 	DthreadRunning = true;
 	DthreadMutex.emplace();
 	WorkToDo.emplace();
@@ -12,7 +12,11 @@
 namespace devilution {
 
 void dthread_remove_player(uint8_t pnum);
-void dthread_send_delta(int pnum, _cmd_id cmd, std::unique_ptr<byte[]> data, uint32_t len);
+/**
+ * @brief Queues data to be sent to a player on the dthread.
+ * @param compress Compress the data before sending it. The first byte is reserved for the compression flag.
+ */
+void dthread_send_delta(int pnum, _cmd_id cmd, std::unique_ptr<byte[]> data, uint32_t len, bool compress = false);
 void dthread_start();
 void DThreadCleanup();
 
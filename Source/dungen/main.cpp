@@ -0,0 +1,281 @@
+/**
+ * @file dungen/main.cpp
+ *
+ * Entry point of devilutionx-dungen, a tool that generates the dungeons of a range of seeds.
+ *
+ * The output starts with a header (magic "DGEN", LE32 format version, level, entry, width and height)
+ * followed by one record per seed: LE32 seed, LE32 number of layouts the generator threw away, the x and y
+ * of the entry position and the tiles in column major order, the same layout as the dungeon array.
+ */
+#define SDL_MAIN_HANDLED
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#define DUNGEN_USE_FORK
+#endif
+
+#include "diablo.h"
+#include "init.h"
+#include "levels/gendung.h"
+#include "player.h"
+#include "utils/endian.hpp"
+#include "utils/str_cat.hpp"
+
+namespace devilution {
+
+namespace {
+
+constexpr char FileMagic[4] = { 'D', 'G', 'E', 'N' };
+constexpr uint32_t FormatVersion = 2;
+constexpr size_t HeaderSize = 24;
+constexpr size_t RecordSize = 10 + DMAXX * DMAXY;
+
+struct DungenOptions {
+	unsigned level = 1;
+	uint32_t firstSeed = 0;
+	uint32_t count = 1;
+	unsigned jobs = 1;
+	lvl_entry entry = ENTRY_MAIN;
+	std::string outputPath = "dungeons.bin";
+};
+
+struct FileCloser {
+	void operator()(FILE *file) const
+	{
+		std::fclose(file);
+	}
+};
+
+using FileUniquePtr = std::unique_ptr<FILE, FileCloser>;
+
+void PrintHelp()
+{
+	std::puts("Usage: devilutionx-dungen [options]");
+	std::puts("  --level <level>         Dungeon level, 1-24 (default 1)");
+	std::puts("  --seed <seed>           First seed (default 0)");
+	std::puts("  --count <count>         Number of consecutive seeds (default 1)");
+	std::puts("  --entry <main|prev>     Whether the player enters from above or below (default main)");
+	std::puts("  --jobs <count>          Number of worker processes (default 1)");
+	std::puts("  --output <path>         File the dungeons are written to (default dungeons.bin)");
+}
+
+bool ParseNumber(const char *arg, unsigned long min, unsigned long max, unsigned long &out)
+{
+	char *end;
+	out = std::strtoul(arg, &end, 10);
+	return *arg != '\0' && *end == '\0' && out >= min && out <= max;
+}
+
+bool ParseOptions(int argc, char **argv, DungenOptions &options)
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		if (std::strcmp(arg, "-h") == 0 || std::strcmp(arg, "--help") == 0) {
+			PrintHelp();
+			std::exit(0);
+		}
+		if (i + 1 == argc) {
+			std::fprintf(stderr, "Missing value for %s\n", arg);
+			return false;
+		}
+		const char *value = argv[++i];
+		unsigned long number;
+		if (std::strcmp(arg, "--output") == 0) {
+			options.outputPath = value;
+		} else if (std::strcmp(arg, "--entry") == 0 && std::strcmp(value, "main") == 0) {
+			options.entry = ENTRY_MAIN;
+		} else if (std::strcmp(arg, "--entry") == 0 && std::strcmp(value, "prev") == 0) {
+			options.entry = ENTRY_PREV;
+		} else if (std::strcmp(arg, "--level") == 0 && ParseNumber(value, 1, 24, number)) {
+			options.level = static_cast<unsigned>(number);
+		} else if (std::strcmp(arg, "--seed") == 0 && ParseNumber(value, 0, 0xFFFFFFFF, number)) {
+			options.firstSeed = static_cast<uint32_t>(number);
+		} else if (std::strcmp(arg, "--count") == 0 && ParseNumber(value, 1, 0xFFFFFFFF, number)) {
+			options.count = static_cast<uint32_t>(number);
+		} else if (std::strcmp(arg, "--jobs") == 0 && ParseNumber(value, 1, 256, number)) {
+			options.jobs = static_cast<unsigned>(number);
+		} else {
+			std::fprintf(stderr, "Invalid option %s %s\n", arg, value);
+			return false;
+		}
+	}
+	if (options.firstSeed + static_cast<uint64_t>(options.count) - 1 > 0xFFFFFFFF) {
+		std::fputs("The seed range doesn't fit in 32 bits\n", stderr);
+		return false;
+	}
+	return true;
+}
+
+int GetTileCount(dungeon_type levelType)
+{
+	switch (levelType) {
+	case DTYPE_CATHEDRAL:
+		return 206;
+	case DTYPE_CATACOMBS:
+		return 160;
+	case DTYPE_CAVES:
+		return 206;
+	case DTYPE_HELL:
+		return 137;
+	case DTYPE_NEST:
+		return 166;
+	case DTYPE_CRYPT:
+		return 217;
+	default:
+		app_fatal("Invalid level type");
+	}
+}
+
+/**
+ * @brief Generates the dungeons of the given seeds and appends their records to the file.
+ */
+bool GenerateDungeons(const DungenOptions &options, uint32_t firstSeed, uint32_t count, FILE *file)
+{
+	currlevel = options.level;
+	leveltype = GetLevelType(options.level);
+	gbIsHellfire = IsAnyOf(leveltype, DTYPE_NEST, DTYPE_CRYPT);
+	MyPlayer->pOriginalCathedral = true;
+
+	// Only the tiles are written, the megatiles are needed for placing the pieces but their contents don't matter.
+	pMegaTiles = std::make_unique<MegaTile[]>(GetTileCount(leveltype));
+
+	uint8_t record[RecordSize];
+	for (uint32_t i = 0; i < count; i++) {
+		const uint32_t seed = firstSeed + i;
+		CreateDungeon(seed, options.entry);
+
+		WriteLE32(&record[0], seed);
+		WriteLE32(&record[4], DungeonRetries);
+		record[8] = static_cast<uint8_t>(ViewPosition.x);
+		record[9] = static_cast<uint8_t>(ViewPosition.y);
+		std::memcpy(&record[10], dungeon, DMAXX * DMAXY);
+		if (std::fwrite(record, sizeof(record), 1, file) != 1)
+			return false;
+	}
+	return true;
+}
+
+bool WriteHeader(const DungenOptions &options, FILE *file)
+{
+	uint8_t header[HeaderSize];
+	std::memcpy(header, FileMagic, sizeof(FileMagic));
+	WriteLE32(&header[4], FormatVersion);
+	WriteLE32(&header[8], options.level);
+	WriteLE32(&header[12], options.entry);
+	WriteLE32(&header[16], DMAXX);
+	WriteLE32(&header[20], DMAXY);
+	return std::fwrite(header, sizeof(header), 1, file) == 1;
+}
+
+#ifdef DUNGEN_USE_FORK
+/**
+ * @brief Splits the seeds over worker processes and concatenates their output in seed order.
+ *
+ * The generators keep their state in globals, so each worker is a fork with its own copy of them.
+ */
+bool GenerateDungeonsInWorkers(const DungenOptions &options, FILE *file)
+{
+	const uint32_t jobs = std::min<uint32_t>(options.jobs, options.count);
+	std::vector<std::string> partPaths;
+	std::vector<pid_t> workers;
+	bool success = true;
+	for (uint32_t job = 0; job < jobs; job++) {
+		// Spread the remainder over the first workers so that all of them get a contiguous range.
+		const uint32_t count = options.count / jobs + (job < options.count % jobs ? 1 : 0);
+		const uint32_t firstSeed = options.firstSeed + job * (options.count / jobs) + std::min(job, options.count % jobs);
+		partPaths.push_back(StrCat(options.outputPath, ".part", job));
+
+		std::fflush(file);
+		const pid_t pid = fork();
+		if (pid == 0) {
+			FileUniquePtr part { std::fopen(partPaths.back().c_str(), "wb") };
+			const bool written = part != nullptr && GenerateDungeons(options, firstSeed, count, part.get()) && std::fclose(part.release()) == 0;
+			_exit(written ? 0 : 1);
+		}
+		if (pid < 0) {
+			std::perror("fork");
+			success = false;
+			break;
+		}
+		workers.push_back(pid);
+	}
+
+	for (pid_t pid : workers) {
+		int status;
+		if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			success = false;
+	}
+
+	std::vector<char> buffer(RecordSize * 256);
+	for (size_t job = 0; job < workers.size(); job++) {
+		if (success) {
+			FileUniquePtr part { std::fopen(partPaths[job].c_str(), "rb") };
+			success = part != nullptr;
+			size_t read;
+			while (success && (read = std::fread(buffer.data(), 1, buffer.size(), part.get())) != 0)
+				success = std::fwrite(buffer.data(), read, 1, file) == 1;
+		}
+		std::remove(partPaths[job].c_str());
+	}
+	return success;
+}
+#endif
+
+int RunDungen(const DungenOptions &options)
+{
+	// No quests are active, but the last level of hell is always made of set pieces from the game archives.
+	HeadlessMode = true;
+	LoadCoreArchives();
+	LoadGameArchives();
+	if (options.level == 16 && !spawn_mpq && !diabdat_mpq) {
+		std::fputs("Level 16 needs diabdat.mpq\n", stderr);
+		return 1;
+	}
+
+	FileUniquePtr file { std::fopen(options.outputPath.c_str(), "wb") };
+	if (file == nullptr || !WriteHeader(options, file.get())) {
+		std::fprintf(stderr, "Failed to write %s\n", options.outputPath.c_str());
+		return 1;
+	}
+
+	bool success;
+#ifdef DUNGEN_USE_FORK
+	if (options.jobs > 1)
+		success = GenerateDungeonsInWorkers(options, file.get());
+	else
+#endif
+		success = GenerateDungeons(options, options.firstSeed, options.count, file.get());
+
+	if (std::fclose(file.release()) != 0)
+		success = false;
+	if (!success) {
+		std::fprintf(stderr, "Failed to generate the dungeons into %s\n", options.outputPath.c_str());
+		std::remove(options.outputPath.c_str());
+		return 1;
+	}
+	return 0;
+}
+
+} // namespace
+
+} // namespace devilution
+
+int main(int argc, char **argv)
+{
+	devilution::DungenOptions options;
+	if (!devilution::ParseOptions(argc, argv, options)) {
+		devilution::PrintHelp();
+		return 1;
+	}
+	return devilution::RunDungen(options);
+}
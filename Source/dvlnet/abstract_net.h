@@ -63,6 +63,11 @@ public:
 		return std::vector<GameInfo>();
 	}
 
+	virtual bool get_network_stats(NetworkStats &stats)
+	{
+		return false;
+	}
+
 	static std::unique_ptr<abstract_net> MakeNet(provider_t provider);
 };
 
@@ -1,6 +1,7 @@
 #include "dvlnet/base.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <memory>
 
@@ -42,8 +43,71 @@ void base::SendEchoRequest(plr_t player)
 		return;
 
 	timestamp_t now = SDL_GetTicks();
+	PeerStats &stats = playerStateTable_[player].stats;
+	stats.echoRequests[stats.nextEchoRequest] = { now, true, false };
+	stats.nextEchoRequest = (stats.nextEchoRequest + 1) % EchoWindowSize;
+
 	auto echo = pktfty->make_packet<PT_ECHO_REQUEST>(plr_self, player, now);
-	send(*echo);
+	SendCounted(*echo);
+}
+
+void base::SendCounted(packet &pkt)
+{
+	bytesSent_ += pkt.Data().size();
+	send(pkt);
+}
+
+void base::UpdateNetworkStats()
+{
+	if (plr_self == PLR_BROADCAST)
+		return;
+
+	const timestamp_t now = SDL_GetTicks();
+	const uint32_t elapsed = now - lastStatsUpdate_;
+	if (elapsed < StatsIntervalMs)
+		return;
+	lastStatsUpdate_ = now;
+
+	for (plr_t player = 0; player < MAX_PLRS; player++) {
+		PlayerState &playerState = playerStateTable_[player];
+		PeerStats &stats = playerState.stats;
+		stats.bytesReceivedPerSecond = static_cast<uint32_t>(uint64_t { stats.bytesReceived } * 1000 / elapsed);
+		stats.bytesReceived = 0;
+		if (player != plr_self && playerState.isConnected)
+			SendEchoRequest(player);
+	}
+	bytesSentPerSecond_ = static_cast<uint32_t>(uint64_t { bytesSent_ } * 1000 / elapsed);
+	bytesSent_ = 0;
+}
+
+bool base::get_network_stats(NetworkStats &stats)
+{
+	const timestamp_t now = SDL_GetTicks();
+	for (plr_t player = 0; player < MAX_PLRS; player++) {
+		const PlayerState &playerState = playerStateTable_[player];
+		const PeerStats &peerStats = playerState.stats;
+		PeerNetworkStats &out = stats.peers[player];
+		out.connected = player != plr_self && playerState.isConnected;
+		out.roundTripLatency = peerStats.roundTripLatency;
+		out.jitter = peerStats.scaledJitter >> 4;
+		out.bytesReceivedPerSecond = peerStats.bytesReceivedPerSecond;
+
+		unsigned finished = 0;
+		unsigned lost = 0;
+		for (const EchoRequest &request : peerStats.echoRequests) {
+			if (!request.sent)
+				continue;
+			if (request.answered) {
+				finished++;
+			} else if (now - request.time >= EchoTimeoutMs) {
+				finished++;
+				lost++;
+			}
+		}
+		out.packetLoss = finished != 0 ? static_cast<uint8_t>(100 * lost / finished) : 0;
+	}
+	stats.bytesSentPerSecond = bytesSentPerSecond_;
+	return true;
 }
 
 void base::HandleAccept(packet &pkt)
@@ -103,6 +167,7 @@ void base::HandleDisconnect(packet &pkt)
 			PlayerState &playerState = playerStateTable_[newPlayer];
 			playerState.isConnected = false;
 			playerState.turnQueue.clear();
+			playerState.stats = {};
 		}
 	} else {
 		ABORT(); // we were dropped by the owner?!?
@@ -112,15 +177,28 @@ void base::HandleDisconnect(packet &pkt)
 void base::HandleEchoRequest(packet &pkt)
 {
 	auto reply = pktfty->make_packet<PT_ECHO_REPLY>(plr_self, pkt.Source(), pkt.Time());
-	send(*reply);
+	SendCounted(*reply);
 }
 
 void base::HandleEchoReply(packet &pkt)
 {
 	uint32_t now = SDL_GetTicks();
 	plr_t src = pkt.Source();
-	PlayerState &playerState = playerStateTable_[src];
-	playerState.roundTripLatency = now - pkt.Time();
+	PeerStats &stats = playerStateTable_[src].stats;
+	const timestamp_t requestTime = pkt.Time();
+	const uint32_t latency = now - requestTime;
+
+	auto request = std::find_if(stats.echoRequests.begin(), stats.echoRequests.end(), [requestTime](const EchoRequest &echoRequest) {
+		return echoRequest.sent && !echoRequest.answered && echoRequest.time == requestTime;
+	});
+	if (request != stats.echoRequests.end()) {
+		if (std::any_of(stats.echoRequests.begin(), stats.echoRequests.end(), [](const EchoRequest &echoRequest) { return echoRequest.answered; })) {
+			const uint32_t difference = std::abs(static_cast<int32_t>(latency - stats.roundTripLatency));
+			stats.scaledJitter += difference - ((stats.scaledJitter + 8) >> 4);
+		}
+		request->answered = true;
+	}
+	stats.roundTripLatency = latency;
 }
 
 void base::ClearMsg(plr_t plr)
@@ -153,6 +231,7 @@ void base::RecvLocal(packet &pkt)
 {
 	if (pkt.Source() < MAX_PLRS) {
 		Connect(pkt.Source());
+		playerStateTable_[pkt.Source()].stats.bytesReceived += pkt.Data().size();
 	}
 	switch (pkt.Type()) {
 	case PT_MESSAGE:
@@ -211,7 +290,7 @@ bool base::SNetSendMessage(int playerId, void *data, unsigned int size)
 		dest = playerId;
 	if (dest != plr_self) {
 		auto pkt = pktfty->make_packet<PT_MESSAGE>(plr_self, dest, message);
-		send(*pkt);
+		SendCounted(*pkt);
 	}
 	return true;
 }
@@ -236,6 +315,7 @@ bool base::AllTurnsArrived()
 bool base::SNetReceiveTurns(char **data, size_t *size, uint32_t *status)
 {
 	poll();
+	UpdateNetworkStats();
 
 	for (auto i = 0; i < MAX_PLRS; ++i) {
 		status[i] = 0;
@@ -322,7 +402,7 @@ void base::SendTurnIfReady(turn_t turn)
 
 	if (!awaitingSequenceNumber_) {
 		auto pkt = pktfty->make_packet<PT_TURN>(plr_self, PLR_BROADCAST, turn);
-		send(*pkt);
+		SendCounted(*pkt);
 	}
 }
 
@@ -338,7 +418,7 @@ void base::SendFirstTurnIfReady(plr_t player)
 
 	turn_t turn = turnQueue.back();
 	auto pkt = pktfty->make_packet<PT_TURN>(plr_self, player, turn);
-	send(*pkt);
+	SendCounted(*pkt);
 }
 
 void base::MakeReady(seq_t sequenceNumber)
@@ -41,6 +41,8 @@ public:
 	virtual void setup_password(std::string pw);
 	virtual void clear_password();
 
+	bool get_network_stats(NetworkStats &stats) override;
+
 	virtual ~base() = default;
 
 protected:
@@ -62,11 +64,30 @@ protected:
 		}
 	};
 
+	static constexpr size_t EchoWindowSize = 16;
+
+	struct EchoRequest {
+		timestamp_t time = {};
+		bool sent = {};
+		bool answered = {};
+	};
+
+	struct PeerStats {
+		uint32_t roundTripLatency = {};
+		/** @brief Smoothed variation of the round trip latency in 1/16 ms, computed like the interarrival jitter of RFC 3550. */
+		uint32_t scaledJitter = {};
+		/** @brief The latest echo requests, to find out how many went unanswered. */
+		std::array<EchoRequest, EchoWindowSize> echoRequests;
+		size_t nextEchoRequest = {};
+		uint32_t bytesReceived = {};
+		uint32_t bytesReceivedPerSecond = {};
+	};
+
 	struct PlayerState {
 		bool isConnected = {};
 		std::deque<turn_t> turnQueue;
 		int32_t lastTurnValue = {};
-		uint32_t roundTripLatency = {};
+		PeerStats stats;
 	};
 
 	seq_t next_turn = 0;
@@ -87,8 +108,19 @@ protected:
 	virtual bool IsGameHost() = 0;
 
 private:
+	/** @brief How often the stats are updated and echo requests are sent to every player. */
+	static constexpr uint32_t StatsIntervalMs = 1000;
+	/** @brief Echo requests that haven't been answered after this long are counted as lost. */
+	static constexpr uint32_t EchoTimeoutMs = 2000;
+
 	std::array<PlayerState, MAX_PLRS> playerStateTable_;
 	bool awaitingSequenceNumber_ = true;
+	timestamp_t lastStatsUpdate_ = 0;
+	uint32_t bytesSent_ = 0;
+	uint32_t bytesSentPerSecond_ = 0;
+
+	void SendCounted(packet &pkt);
+	void UpdateNetworkStats();
 
 	plr_t GetOwner();
 	bool AllTurnsArrived();
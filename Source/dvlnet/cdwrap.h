@@ -43,6 +43,7 @@ public:
 	virtual bool send_info_request();
 	virtual void clear_gamelist();
 	virtual std::vector<GameInfo> get_gamelist();
+	virtual bool get_network_stats(NetworkStats &stats);
 	virtual void setup_password(std::string pw);
 	virtual void clear_password();
 
@@ -174,6 +175,12 @@ std::string cdwrap<T>::make_default_gamename()
 	return dvlnet_wrap->make_default_gamename();
 }
 
+template <class T>
+bool cdwrap<T>::get_network_stats(NetworkStats &stats)
+{
+	return dvlnet_wrap->get_network_stats(stats);
+}
+
 template <class T>
 bool cdwrap<T>::send_info_request()
 {
@@ -15,39 +15,22 @@ namespace net {
 #define FRAME_QUEUE_ERROR app_fatal("frame queue error")
 #endif
 
-framesize_t frame_queue::Size() const
+size_t frame_queue::Size() const
 {
-	return current_size;
+	return buffer.size() - read_pos;
 }
 
-buffer_t frame_queue::Read(framesize_t s)
+void frame_queue::Write(const unsigned char *data, size_t size)
 {
-	if (current_size < s)
-		FRAME_QUEUE_ERROR;
-	buffer_t ret;
-	while (s > 0 && s >= buffer_deque.front().size()) {
-		s -= buffer_deque.front().size();
-		current_size -= buffer_deque.front().size();
-		ret.insert(ret.end(),
-		    buffer_deque.front().begin(),
-		    buffer_deque.front().end());
-		buffer_deque.pop_front();
-	}
-	if (s > 0) {
-		ret.insert(ret.end(),
-		    buffer_deque.front().begin(),
-		    buffer_deque.front().begin() + s);
-		buffer_deque.front().erase(buffer_deque.front().begin(),
-		    buffer_deque.front().begin() + s);
-		current_size -= s;
+	if (read_pos == buffer.size()) {
+		buffer.clear();
+		read_pos = 0;
+	} else if (read_pos != 0 && (read_pos >= Size() || buffer.size() + size > buffer.capacity())) {
+		// Only the unread tail is moved, and only once it is smaller than what was already read.
+		buffer.erase(buffer.begin(), buffer.begin() + read_pos);
+		read_pos = 0;
 	}
-	return ret;
-}
-
-void frame_queue::Write(buffer_t buf)
-{
-	current_size += buf.size();
-	buffer_deque.push_back(std::move(buf));
+	buffer.insert(buffer.end(), data, data + size);
 }
 
 bool frame_queue::PacketReady()
@@ -55,9 +38,10 @@ bool frame_queue::PacketReady()
 	if (nextsize == 0) {
 		if (Size() < sizeof(framesize_t))
 			return false;
-		auto szbuf = Read(sizeof(framesize_t));
-		std::memcpy(&nextsize, &szbuf[0], sizeof(framesize_t));
-		if (nextsize == 0)
+		std::memcpy(&nextsize, &buffer[read_pos], sizeof(framesize_t));
+		read_pos += sizeof(framesize_t);
+		// Senders never make larger frames, so don't buffer an unbounded amount of data for them.
+		if (nextsize == 0 || nextsize > max_frame_size)
 			FRAME_QUEUE_ERROR;
 	}
 	return Size() >= nextsize;
@@ -67,20 +51,44 @@ buffer_t frame_queue::ReadPacket()
 {
 	if (nextsize == 0 || Size() < nextsize)
 		FRAME_QUEUE_ERROR;
-	auto ret = Read(nextsize);
+	buffer_t ret(buffer.begin() + read_pos, buffer.begin() + read_pos + nextsize);
+	read_pos += nextsize;
 	nextsize = 0;
 	return ret;
 }
 
-buffer_t frame_queue::MakeFrame(buffer_t packetbuf)
+buffer_t frame_queue::MakeFrame(const buffer_t &packetbuf)
 {
 	buffer_t ret;
+	MakeFrame(packetbuf, ret);
+	return ret;
+}
+
+void frame_queue::MakeFrame(const buffer_t &packetbuf, buffer_t &frame)
+{
 	if (packetbuf.size() > max_frame_size)
 		ABORT();
 	framesize_t size = packetbuf.size();
-	ret.insert(ret.end(), packet_out::begin(size), packet_out::end(size));
-	ret.insert(ret.end(), packetbuf.begin(), packetbuf.end());
-	return ret;
+	frame.clear();
+	frame.reserve(sizeof(size) + packetbuf.size());
+	frame.insert(frame.end(), packet_out::begin(size), packet_out::end(size));
+	frame.insert(frame.end(), packetbuf.begin(), packetbuf.end());
+}
+
+std::shared_ptr<buffer_t> frame_pool::Acquire()
+{
+	if (free_frames.empty())
+		return std::make_shared<buffer_t>();
+	std::shared_ptr<buffer_t> frame = std::move(free_frames.back());
+	free_frames.pop_back();
+	return frame;
+}
+
+void frame_pool::Release(std::shared_ptr<buffer_t> frame)
+{
+	if (frame.use_count() != 1 || free_frames.size() >= max_free_frames)
+		return;
+	free_frames.push_back(std::move(frame));
 }
 
 } // namespace net
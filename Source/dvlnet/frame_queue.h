@@ -1,8 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <deque>
 #include <exception>
+#include <memory>
 #include <vector>
 
 namespace devilution {
@@ -25,19 +26,47 @@ public:
 	constexpr static framesize_t max_frame_size = 0xFFFF;
 
 private:
-	framesize_t current_size = 0;
-	std::deque<buffer_t> buffer_deque;
+	/**
+	 * Received bytes, the ones that haven't been read yet start at `read_pos`.
+	 * Read bytes are only dropped when more data is written, so the storage is reused rather than reallocated.
+	 */
+	buffer_t buffer;
+	size_t read_pos = 0;
 	framesize_t nextsize = 0;
 
-	framesize_t Size() const;
-	buffer_t Read(framesize_t s);
+	size_t Size() const;
 
 public:
 	bool PacketReady();
 	buffer_t ReadPacket();
-	void Write(buffer_t buf);
+	void Write(const unsigned char *data, size_t size);
 
-	static buffer_t MakeFrame(buffer_t packetbuf);
+	static buffer_t MakeFrame(const buffer_t &packetbuf);
+
+	/**
+	 * @brief Writes the frame into a caller-provided buffer, reusing its capacity.
+	 */
+	static void MakeFrame(const buffer_t &packetbuf, buffer_t &frame);
+};
+
+/**
+ * @brief Recycles the buffers of frames that were sent, so that sending doesn't allocate in the steady state.
+ *
+ * Frames are shared, so that a packet sent to several peers is only framed once.
+ */
+class frame_pool {
+public:
+	std::shared_ptr<buffer_t> Acquire();
+
+	/**
+	 * @brief Returns the frame to the pool once no other send is using it anymore.
+	 */
+	void Release(std::shared_ptr<buffer_t> frame);
+
+private:
+	static constexpr size_t max_free_frames = 16;
+
+	std::vector<std::shared_ptr<buffer_t>> free_frames;
 };
 
 } // namespace net
@@ -1,5 +1,7 @@
 #include "dvlnet/loopback.h"
 
+#include <algorithm>
+
 #include "multi.h"
 #include "utils/language.h"
 #include "utils/stubs.h"
@@ -17,24 +19,44 @@ int loopback::join(std::string /*addrstr*/)
 	ABORT();
 }
 
+void loopback::grow_message_ring()
+{
+	std::vector<buffer_t> grown;
+	grown.reserve(std::max<size_t>(16, message_ring.size() * 2));
+	// Moving a buffer keeps its data where it is, so the held message stays valid.
+	for (size_t i = 0; i < message_ring.size(); i++)
+		grown.push_back(std::move(message_ring[(message_first + i) % message_ring.size()]));
+	grown.resize(grown.capacity());
+	message_ring = std::move(grown);
+	message_first = 0;
+}
+
 bool loopback::SNetReceiveMessage(int *sender, void **data, uint32_t *size)
 {
-	if (message_queue.empty())
+	// The caller is done with the previous message now, so its slot can be reused.
+	if (message_held) {
+		message_first = (message_first + 1) % message_ring.size();
+		message_count--;
+		message_held = false;
+	}
+	if (message_count == 0)
 		return false;
-	message_last = message_queue.front();
-	message_queue.pop();
+	buffer_t &message = message_ring[message_first];
+	message_held = true;
 	*sender = plr_single;
-	*size = message_last.size();
-	*data = message_last.data();
+	*size = message.size();
+	*data = message.data();
 	return true;
 }
 
 bool loopback::SNetSendMessage(int dest, void *data, unsigned int size)
 {
 	if (dest == plr_single || dest == SNPLAYER_ALL) {
+		if (message_count == message_ring.size())
+			grow_message_ring();
 		auto *rawMessage = reinterpret_cast<unsigned char *>(data);
-		buffer_t message(rawMessage, rawMessage + size);
-		message_queue.push(message);
+		message_ring[(message_first + message_count) % message_ring.size()].assign(rawMessage, rawMessage + size);
+		message_count++;
 	}
 	return true;
 }
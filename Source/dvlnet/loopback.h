@@ -1,7 +1,7 @@
 #pragma once
 
-#include <queue>
 #include <string>
+#include <vector>
 
 #include "dvlnet/abstract_net.h"
 
@@ -10,10 +10,20 @@ namespace net {
 
 class loopback : public abstract_net {
 private:
-	std::queue<buffer_t> message_queue;
-	buffer_t message_last;
+	/**
+	 * @brief Ring buffer of the queued messages.
+	 *
+	 * The slots keep their capacity once a message was copied into them, so only the first messages allocate.
+	 */
+	std::vector<buffer_t> message_ring;
+	size_t message_first = 0;
+	size_t message_count = 0;
+	/** @brief The first message was handed out by SNetReceiveMessage and stays queued until the next call. */
+	bool message_held = false;
 	int plr_single;
 
+	void grow_message_ring();
+
 public:
 	loopback()
 	{
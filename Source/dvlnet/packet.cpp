@@ -66,6 +66,8 @@ const char *packet_type_to_string(uint8_t packetType)
 		return "PT_CONNECT";
 	case PT_DISCONNECT:
 		return "PT_DISCONNECT";
+	case PT_SPECTATE_REQUEST:
+		return "PT_SPECTATE_REQUEST";
 	case PT_INFO_REQUEST:
 		return "PT_INFO_REQUEST";
 	case PT_INFO_REPLY:
@@ -159,7 +161,7 @@ turn_t packet::Turn()
 cookie_t packet::Cookie()
 {
 	assert(have_decrypted);
-	CheckPacketTypeOneOf({ PT_JOIN_REQUEST, PT_JOIN_ACCEPT }, m_type);
+	CheckPacketTypeOneOf({ PT_JOIN_REQUEST, PT_SPECTATE_REQUEST, PT_JOIN_ACCEPT }, m_type);
 	return m_cookie;
 }
 
@@ -180,7 +182,7 @@ timestamp_t packet::Time()
 const buffer_t &packet::Info()
 {
 	assert(have_decrypted);
-	CheckPacketTypeOneOf({ PT_JOIN_REQUEST, PT_JOIN_ACCEPT, PT_CONNECT, PT_INFO_REPLY }, m_type);
+	CheckPacketTypeOneOf({ PT_JOIN_REQUEST, PT_SPECTATE_REQUEST, PT_JOIN_ACCEPT, PT_CONNECT, PT_INFO_REPLY }, m_type);
 	return m_info;
 }
 
@@ -201,14 +203,10 @@ void packet_in::Create(buffer_t buf)
 		app_fatal("invalid packet");
 #endif
 
+	// TCP server implementation forwards the original data to clients,
+	// which `Data()` still returns because parsing doesn't modify it.
 	decrypted_buffer = std::move(buf);
 	have_decrypted = true;
-
-	// TCP server implementation forwards the original data to clients
-	// so although we are not decrypting anything,
-	// we save a copy in encrypted_buffer anyway
-	encrypted_buffer = decrypted_buffer;
-	have_encrypted = true;
 }
 
 #ifdef PACKET_ENCRYPTION
@@ -239,6 +237,18 @@ void packet_in::Decrypt(buffer_t buf)
 }
 #endif
 
+void packet_out::Serialize(size_t headroom)
+{
+	// Upper bound for the type, source, destination and the fixed size fields of any packet type.
+	constexpr size_t MaxFixedFieldsSize = 16;
+
+	assert(have_decrypted);
+	decrypted_buffer.clear();
+	decrypted_buffer.reserve(headroom + MaxFixedFieldsSize + m_message.size() + m_info.size());
+	decrypted_buffer.resize(headroom);
+	process_data();
+}
+
 #ifdef PACKET_ENCRYPTION
 void packet_out::Encrypt()
 {
@@ -247,21 +257,22 @@ void packet_out::Encrypt()
 	if (have_encrypted)
 		return;
 
-	auto lenCleartext = decrypted_buffer.size();
-	encrypted_buffer.insert(encrypted_buffer.begin(),
-	    crypto_secretbox_NONCEBYTES, 0);
-	encrypted_buffer.insert(encrypted_buffer.end(),
-	    crypto_secretbox_MACBYTES + lenCleartext, 0);
-	randombytes_buf(encrypted_buffer.data(), crypto_secretbox_NONCEBYTES);
+	// The buffer is laid out as nonce, MAC and cleartext. libsodium allows the ciphertext
+	// (which starts with the MAC) to overlap the cleartext, so no second buffer is needed.
+	assert(decrypted_buffer.size() >= EncryptionHeadroom);
+	auto lenCleartext = decrypted_buffer.size() - EncryptionHeadroom;
+	randombytes_buf(decrypted_buffer.data(), crypto_secretbox_NONCEBYTES);
 	int status = crypto_secretbox_easy(
-	    encrypted_buffer.data() + crypto_secretbox_NONCEBYTES,
-	    decrypted_buffer.data(),
+	    decrypted_buffer.data() + crypto_secretbox_NONCEBYTES,
+	    decrypted_buffer.data() + EncryptionHeadroom,
 	    lenCleartext,
-	    encrypted_buffer.data(),
+	    decrypted_buffer.data(),
 	    key.data());
 	if (status != 0)
 		ABORT();
 
+	encrypted_buffer = std::move(decrypted_buffer);
+	decrypted_buffer.clear();
 	have_encrypted = true;
 }
 #endif
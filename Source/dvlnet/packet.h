@@ -20,16 +20,17 @@ namespace net {
 
 enum packet_type : uint8_t {
 	// clang-format off
-	PT_MESSAGE      = 0x01,
-	PT_TURN         = 0x02,
-	PT_JOIN_REQUEST = 0x11,
-	PT_JOIN_ACCEPT  = 0x12,
-	PT_CONNECT      = 0x13,
-	PT_DISCONNECT   = 0x14,
-	PT_INFO_REQUEST = 0x21,
-	PT_INFO_REPLY   = 0x22,
-	PT_ECHO_REQUEST = 0x31,
-	PT_ECHO_REPLY   = 0x32,
+	PT_MESSAGE          = 0x01,
+	PT_TURN             = 0x02,
+	PT_JOIN_REQUEST     = 0x11,
+	PT_JOIN_ACCEPT      = 0x12,
+	PT_CONNECT          = 0x13,
+	PT_DISCONNECT       = 0x14,
+	PT_SPECTATE_REQUEST = 0x15,
+	PT_INFO_REQUEST     = 0x21,
+	PT_INFO_REPLY       = 0x22,
+	PT_ECHO_REQUEST     = 0x31,
+	PT_ECHO_REPLY       = 0x32,
 	// clang-format on
 };
 
@@ -95,6 +96,11 @@ protected:
 	bool have_decrypted = false;
 	buffer_t encrypted_buffer;
 	buffer_t decrypted_buffer;
+	/**
+	 * Incoming packets are parsed without modifying decrypted_buffer, so that it can still be forwarded as is.
+	 * Kept here rather than in packet_in because packets are deleted through a pointer to this class.
+	 */
+	size_t read_offset = 0;
 
 public:
 	packet(const key_t &k)
@@ -138,6 +144,12 @@ public:
 	template <packet_type t, typename... Args>
 	void create(Args... args);
 
+	/**
+	 * @brief Serializes the fields into a single buffer.
+	 * @param headroom Number of bytes to leave in front of the fields, see Encrypt.
+	 */
+	void Serialize(size_t headroom);
+
 	void process_element(buffer_t &x);
 	template <class T>
 	void process_element(T &x);
@@ -146,7 +158,19 @@ public:
 	template <class T>
 	static const unsigned char *end(const T &x);
 	static cookie_t GenerateCookie();
+
+	/**
+	 * @brief Encrypts the packet in place.
+	 *
+	 * Requires the packet to be serialized with `EncryptionHeadroom` bytes of headroom. The cipher is always
+	 * XSalsa20-Poly1305: libsodium only offers AES-256-GCM on CPUs with AES instructions, and as the packets don't
+	 * negotiate a cipher every peer has to be able to decrypt every packet, including relayed broadcasts.
+	 */
 	void Encrypt();
+
+#ifdef PACKET_ENCRYPTION
+	static constexpr size_t EncryptionHeadroom = crypto_secretbox_NONCEBYTES + crypto_secretbox_MACBYTES;
+#endif
 };
 
 template <class P>
@@ -165,6 +189,7 @@ void packet_proc<P>::process_data()
 		self.process_element(m_turn.Value);
 		break;
 	case PT_JOIN_REQUEST:
+	case PT_SPECTATE_REQUEST:
 		self.process_element(m_cookie);
 		self.process_element(m_info);
 		break;
@@ -195,22 +220,21 @@ void packet_proc<P>::process_data()
 
 inline void packet_in::process_element(buffer_t &x)
 {
-	x.insert(x.begin(), decrypted_buffer.begin(), decrypted_buffer.end());
-	decrypted_buffer.resize(0);
+	x.assign(decrypted_buffer.begin() + read_offset, decrypted_buffer.end());
+	read_offset = decrypted_buffer.size();
 }
 
 template <class T>
 void packet_in::process_element(T &x)
 {
-	if (decrypted_buffer.size() < sizeof(T))
+	if (decrypted_buffer.size() - read_offset < sizeof(T))
 #if DVL_EXCEPTIONS
 		throw packet_exception();
 #else
 		app_fatal("invalid packet");
 #endif
-	std::memcpy(&x, decrypted_buffer.data(), sizeof(T));
-	decrypted_buffer.erase(decrypted_buffer.begin(),
-	    decrypted_buffer.begin() + sizeof(T));
+	std::memcpy(&x, decrypted_buffer.data() + read_offset, sizeof(T));
+	read_offset += sizeof(T);
 }
 
 template <>
@@ -274,6 +298,20 @@ inline void packet_out::create<PT_JOIN_REQUEST>(plr_t s, plr_t d,
 	m_info = i;
 }
 
+template <>
+inline void packet_out::create<PT_SPECTATE_REQUEST>(plr_t s, plr_t d,
+    cookie_t c, buffer_t i)
+{
+	if (have_encrypted || have_decrypted)
+		ABORT();
+	have_decrypted = true;
+	m_type = PT_SPECTATE_REQUEST;
+	m_src = s;
+	m_dest = d;
+	m_cookie = c;
+	m_info = i;
+}
+
 template <>
 inline void packet_out::create<PT_JOIN_ACCEPT>(plr_t s, plr_t d, cookie_t c,
     plr_t n, buffer_t i)
@@ -409,11 +447,14 @@ std::unique_ptr<packet> packet_factory::make_packet(Args... args)
 {
 	auto ret = std::make_unique<packet_out>(key);
 	ret->create<t>(args...);
-	ret->process_data();
 #ifdef PACKET_ENCRYPTION
-	if (secure)
+	if (secure) {
+		ret->Serialize(packet_out::EncryptionHeadroom);
 		ret->Encrypt();
+		return ret;
+	}
 #endif
+	ret->Serialize(0);
 	return ret;
 }
 
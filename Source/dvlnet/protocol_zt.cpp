@@ -154,33 +154,71 @@ bool protocol_zt::recv_peer(const endpoint &peer)
 	while (true) {
 		auto len = lwip_recv(peer_list[peer].fd, buf, sizeof(buf), 0);
 		if (len >= 0) {
-			peer_list[peer].recv_queue.Write(buffer_t(buf, buf + len));
+			peer_list[peer].recv_queue.Write(buf, len);
 		} else {
 			return errno == EAGAIN || errno == EWOULDBLOCK;
 		}
 	}
 }
 
-bool protocol_zt::send_queued_all()
+void protocol_zt::service_ready_sockets()
 {
+	fd_set readfds;
+	fd_set writefds;
+	FD_ZERO(&readfds);
+	FD_ZERO(&writefds);
+	int maxfd = std::max(fd_tcp, fd_udp);
+	if (fd_tcp != -1)
+		FD_SET(fd_tcp, &readfds);
+	if (fd_udp != -1)
+		FD_SET(fd_udp, &readfds);
 	for (auto &peer : peer_list) {
-		if (!send_queued_peer(peer.first)) {
-			// handle error?
+		const int fd = peer.second.fd;
+		if (fd == -1)
+			continue;
+		FD_SET(fd, &readfds);
+		if (!peer.second.send_queue.empty())
+			FD_SET(fd, &writefds);
+		maxfd = std::max(maxfd, fd);
+	}
+
+	if (maxfd != -1) {
+		struct timeval timeout {
+		};
+		if (lwip_select(maxfd + 1, &readfds, &writefds, nullptr, &timeout) < 0) {
+			// Fall back to trying every socket, the non-blocking calls below can't hang.
+			Log("lwip_select: {}", strerror(errno));
+			for (auto &peer : peer_list) {
+				if (peer.second.fd != -1) {
+					FD_SET(peer.second.fd, &readfds);
+					FD_SET(peer.second.fd, &writefds);
+				}
+			}
+			if (fd_tcp != -1)
+				FD_SET(fd_tcp, &readfds);
+			if (fd_udp != -1)
+				FD_SET(fd_udp, &readfds);
 		}
 	}
-	return true;
-}
 
-bool protocol_zt::recv_from_peers()
-{
 	for (auto &peer : peer_list) {
-		if (peer.second.fd != -1) {
-			if (!recv_peer(peer.first)) {
-				disconnect_queue.push_back(peer.first);
-			}
+		const int fd = peer.second.fd;
+		// A peer without a socket yet connects on its first send.
+		if (fd == -1) {
+			if (!peer.second.send_queue.empty())
+				send_queued_peer(peer.first);
+			continue;
 		}
+		if (FD_ISSET(fd, &writefds))
+			send_queued_peer(peer.first);
+		if (FD_ISSET(fd, &readfds) && !recv_peer(peer.first))
+			disconnect_queue.push_back(peer.first);
 	}
-	return true;
+	if (fd_udp != -1 && FD_ISSET(fd_udp, &readfds))
+		recv_from_udp();
+	// Last, so that the sockets accepted now aren't mistaken for ones in the sets.
+	if (fd_tcp != -1 && FD_ISSET(fd_tcp, &readfds))
+		accept_all();
 }
 
 bool protocol_zt::recv_from_udp()
@@ -224,10 +262,7 @@ bool protocol_zt::accept_all()
 
 bool protocol_zt::recv(endpoint &peer, buffer_t &data)
 {
-	accept_all();
-	send_queued_all();
-	recv_from_peers();
-	recv_from_udp();
+	service_ready_sockets();
 
 	if (!oob_recv_queue.empty()) {
 		peer = oob_recv_queue.front().first;
@@ -102,8 +102,12 @@ private:
 
 	bool send_queued_peer(const endpoint &peer);
 	bool recv_peer(const endpoint &peer);
-	bool send_queued_all();
-	bool recv_from_peers();
+	/**
+	 * @brief Services only the sockets with something to do, found with a single select.
+	 *
+	 * Idle peers cost nothing, the sockets used to be polled with a send and a receive each every frame.
+	 */
+	void service_ready_sockets();
 	bool recv_from_udp();
 	bool accept_all();
 };
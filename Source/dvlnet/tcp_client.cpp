@@ -1,6 +1,7 @@
 #include "dvlnet/tcp_client.h"
 #include "options.h"
 #include "utils/language.h"
+#include "utils/log.hpp"
 
 #include <SDL.h>
 #include <exception>
@@ -9,6 +10,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <system_error>
+#include <utility>
 
 #include <asio/connect.hpp>
 
@@ -17,10 +19,26 @@ namespace net {
 
 int tcp_client::create(std::string addrstr)
 {
+	if (*sgOptions.Network.szRelayHost != '\0') {
+		// The first player to join an empty game on the relay provides the game settings, the same as with a local server.
+		// If the game wasn't empty the relay answers with the settings of the game that is running, see HandleAccept.
+		const buffer_t requestedInfo = game_init_info;
+		const int result = join(sgOptions.Network.szRelayHost);
+		hosting_on_relay = result != -1 && game_init_info == requestedInfo;
+		return result;
+	}
 	try {
 		auto port = *sgOptions.Network.port;
-		local_server = std::make_unique<tcp_server>(ioc, addrstr, port, *pktfty);
-		return join(local_server->LocalhostSelf());
+		if (!*sgOptions.Network.serverThread) {
+			local_server = std::make_unique<tcp_server>(ioc, addrstr, port, *pktfty);
+			return join(local_server->LocalhostSelf());
+		}
+		server_ioc = std::make_unique<asio::io_context>();
+		local_server = std::make_unique<tcp_server>(*server_ioc, addrstr, port, *pktfty);
+		// Nothing but the server thread may touch the server once it's running.
+		const std::string localhost = local_server->LocalhostSelf();
+		server_thread = SdlThread { RunServer, server_ioc.get() };
+		return join(localhost);
 	} catch (std::system_error &e) {
 		SDL_SetError("%s", e.what());
 		return -1;
@@ -69,9 +87,29 @@ int tcp_client::join(std::string addrstr)
 	return plr_self;
 }
 
+int SDLCALL tcp_client::RunServer(void *data)
+{
+	auto &serverIoc = *static_cast<asio::io_context *>(data);
+	try {
+		// The acceptor always has an accept pending, so this only returns once the server is stopped.
+		serverIoc.run();
+	} catch (std::exception &e) {
+		LogError("Server error: {}", e.what());
+	}
+	return 0;
+}
+
+void tcp_client::StopServerThread()
+{
+	if (!server_thread.joinable())
+		return;
+	server_ioc->stop();
+	server_thread.join();
+}
+
 bool tcp_client::IsGameHost()
 {
-	return local_server != nullptr;
+	return local_server != nullptr || hosting_on_relay;
 }
 
 void tcp_client::poll()
@@ -90,9 +128,7 @@ void tcp_client::HandleReceive(const asio::error_code &error, size_t bytesRead)
 	if (bytesRead == 0) {
 		throw std::runtime_error(_("error: read 0 bytes from server").data());
 	}
-	recv_buffer.resize(bytesRead);
-	recv_queue.Write(std::move(recv_buffer));
-	recv_buffer.resize(frame_queue::max_frame_size);
+	recv_queue.Write(recv_buffer.data(), bytesRead);
 	while (recv_queue.PacketReady()) {
 		auto pkt = pktfty->make_packet(recv_queue.ReadPacket());
 		RecvLocal(*pkt);
@@ -114,10 +150,30 @@ void tcp_client::HandleSend(const asio::error_code &error, size_t bytesSent)
 
 void tcp_client::send(packet &pkt)
 {
-	auto frame = std::make_unique<buffer_t>(frame_queue::MakeFrame(pkt.Data()));
-	auto buf = asio::buffer(*frame);
-	asio::async_write(sock, buf, [this, frame = std::move(frame)](const asio::error_code &error, size_t bytesSent) {
+	std::shared_ptr<buffer_t> frame = send_frames.Acquire();
+	frame_queue::MakeFrame(pkt.Data(), *frame);
+	send_queue.push_back(std::move(frame));
+	// Only one write may be in flight per socket, the frames queued meanwhile are batched into the next one.
+	if (sending.empty())
+		FlushSendQueue();
+}
+
+void tcp_client::FlushSendQueue()
+{
+	std::swap(sending, send_queue);
+	std::vector<asio::const_buffer> buffers;
+	buffers.reserve(sending.size());
+	for (const std::shared_ptr<buffer_t> &frame : sending)
+		buffers.push_back(asio::buffer(*frame));
+	asio::async_write(sock, buffers, [this](const asio::error_code &error, size_t bytesSent) {
+		for (std::shared_ptr<buffer_t> &frame : sending)
+			send_frames.Release(std::move(frame));
+		sending.clear();
 		HandleSend(error, bytesSent);
+		if (error)
+			send_queue.clear();
+		else if (!send_queue.empty())
+			FlushSendQueue();
 	});
 }
 
@@ -125,8 +181,14 @@ bool tcp_client::SNetLeaveGame(int type)
 {
 	auto ret = base::SNetLeaveGame(type);
 	poll();
-	if (local_server != nullptr)
-		local_server->Close();
+	if (local_server != nullptr) {
+		if (server_thread.joinable()) {
+			tcp_server *server = local_server.get();
+			asio::post(*server_ioc, [server]() { server->Close(); });
+		} else {
+			local_server->Close();
+		}
+	}
 	sock.close();
 	return ret;
 }
@@ -137,7 +199,9 @@ std::string tcp_client::make_default_gamename()
 }
 
 tcp_client::~tcp_client()
-    = default;
+{
+	StopServerThread();
+}
 
 } // namespace net
 } // namespace devilution
@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <asio/ts/buffer.hpp>
 #include <asio/ts/internet.hpp>
@@ -12,6 +13,7 @@
 #include "dvlnet/frame_queue.h"
 #include "dvlnet/packet.h"
 #include "dvlnet/tcp_server.h"
+#include "utils/sdl_thread.h"
 
 namespace devilution {
 namespace net {
@@ -36,15 +38,28 @@ protected:
 private:
 	frame_queue recv_queue;
 	buffer_t recv_buffer = buffer_t(frame_queue::max_frame_size);
+	frame_pool send_frames;
+	/** @brief Frames waiting for the write in flight to finish, they go out together in the next one. */
+	std::vector<std::shared_ptr<buffer_t>> send_queue;
+	/** @brief Frames of the write in flight, empty if there is none. */
+	std::vector<std::shared_ptr<buffer_t>> sending;
 
 	asio::io_context ioc;
 	asio::ip::tcp::resolver resolver = asio::ip::tcp::resolver(ioc);
 	asio::ip::tcp::socket sock = asio::ip::tcp::socket(ioc);
-	std::unique_ptr<tcp_server> local_server; // must be declared *after* ioc
+	/** @brief Runs the local server when it has its own thread, in which case the thread is the only one touching it. */
+	std::unique_ptr<asio::io_context> server_ioc;
+	std::unique_ptr<tcp_server> local_server; // must be declared *after* ioc and server_ioc
+	SdlThread server_thread;
+	bool hosting_on_relay = false;
+
+	static int SDLCALL RunServer(void *data);
+	void StopServerThread();
 
 	void HandleReceive(const asio::error_code &error, size_t bytesRead);
 	void StartReceive();
 	void HandleSend(const asio::error_code &error, size_t bytesSent);
+	void FlushSendQueue();
 };
 
 } // namespace net
@@ -1,5 +1,6 @@
 #include "dvlnet/tcp_server.h"
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <memory>
@@ -37,6 +38,19 @@ std::string tcp_server::LocalhostSelf()
 	return addr.to_string();
 }
 
+tcp_server::stats tcp_server::GetStats() const
+{
+	stats result {};
+	for (const scc &con : connections) {
+		if (con)
+			result.players++;
+	}
+	result.spectators = spectators.size();
+	result.packets_received = packets_received;
+	result.bytes_sent = bytes_sent;
+	return result;
+}
+
 tcp_server::scc tcp_server::MakeConnection()
 {
 	return std::make_shared<client_connection>(ioc);
@@ -72,14 +86,16 @@ void tcp_server::HandleReceive(const scc &con, const asio::error_code &ec,
 		DropConnection(con);
 		return;
 	}
-	con->recv_buffer.resize(bytesRead);
-	con->recv_queue.Write(std::move(con->recv_buffer));
-	con->recv_buffer.resize(frame_queue::max_frame_size);
+	con->recv_queue.Write(con->recv_buffer.data(), bytesRead);
 	try {
 		while (con->recv_queue.PacketReady()) {
 			try {
 				auto pkt = pktfty.make_packet(con->recv_queue.ReadPacket());
-				if (con->plr == PLR_BROADCAST) {
+				packets_received++;
+				if (con->spectator) {
+					// Anything keeps a spectator connected, but it's not passed on.
+					con->timeout = timeout_active;
+				} else if (con->plr == PLR_BROADCAST) {
 					HandleReceiveNewPlayer(con, *pkt);
 				} else {
 					con->timeout = timeout_active;
@@ -101,6 +117,11 @@ void tcp_server::HandleReceive(const scc &con, const asio::error_code &ec,
 
 void tcp_server::HandleReceiveNewPlayer(const scc &con, packet &pkt)
 {
+	if (pkt.Type() == PT_SPECTATE_REQUEST) {
+		HandleReceiveSpectator(con, pkt);
+		return;
+	}
+
 	auto newplr = NextFree();
 	if (newplr == PLR_BROADCAST)
 		throw server_exception();
@@ -125,6 +146,29 @@ void tcp_server::HandleReceiveNewPlayer(const scc &con, packet &pkt)
 	con->plr = newplr;
 	connections[newplr] = con;
 	con->timeout = timeout_active;
+
+	auto spectatorPacket = pktfty.make_packet<PT_CONNECT>(PLR_MASTER, PLR_BROADCAST, newplr);
+	std::shared_ptr<buffer_t> frame = send_frames.Acquire();
+	frame_queue::MakeFrame(spectatorPacket->Data(), *frame);
+	SendToSpectators(frame);
+}
+
+void tcp_server::HandleReceiveSpectator(const scc &con, packet &pkt)
+{
+	// Without the whole history a spectator couldn't arrive at the state the players are in.
+	if (Empty() || !history_complete || spectators.size() >= max_spectators)
+		throw server_exception();
+
+	// A spectator has no player ID, it learns about the players from the PT_CONNECT in the history.
+	auto reply = pktfty.make_packet<PT_JOIN_ACCEPT>(PLR_MASTER, PLR_BROADCAST,
+	    pkt.Cookie(), PLR_BROADCAST,
+	    game_init_info);
+	StartSend(con, *reply);
+	for (const std::shared_ptr<buffer_t> &frame : history)
+		StartSend(con, frame);
+	con->spectator = true;
+	con->timeout = timeout_active;
+	spectators.push_back(con);
 }
 
 void tcp_server::HandleReceivePacket(packet &pkt)
@@ -135,9 +179,21 @@ void tcp_server::HandleReceivePacket(packet &pkt)
 void tcp_server::SendPacket(packet &pkt)
 {
 	if (pkt.Destination() == PLR_BROADCAST) {
-		for (auto i = 0; i < MAX_PLRS; ++i)
-			if (i != pkt.Source() && connections[i])
-				StartSend(connections[i], pkt);
+		std::shared_ptr<buffer_t> frame;
+		for (auto i = 0; i < MAX_PLRS; ++i) {
+			if (i == pkt.Source() || !connections[i])
+				continue;
+			if (frame == nullptr) {
+				frame = send_frames.Acquire();
+				frame_queue::MakeFrame(pkt.Data(), *frame);
+			}
+			StartSend(connections[i], frame);
+		}
+		if (frame == nullptr) {
+			frame = send_frames.Acquire();
+			frame_queue::MakeFrame(pkt.Data(), *frame);
+		}
+		SendToSpectators(frame);
 	} else {
 		if (pkt.Destination() >= MAX_PLRS)
 			throw server_exception();
@@ -146,20 +202,63 @@ void tcp_server::SendPacket(packet &pkt)
 	}
 }
 
+void tcp_server::SendToSpectators(const std::shared_ptr<buffer_t> &frame)
+{
+	for (const scc &spectator : spectators)
+		StartSend(spectator, frame);
+
+	if (!history_complete)
+		return;
+	history_size += frame->size();
+	if (history_size > max_history_size) {
+		Log("Game history exceeds {} bytes, no more spectators can join", max_history_size);
+		history.clear();
+		history_size = 0;
+		history_complete = false;
+		return;
+	}
+	history.push_back(frame);
+}
+
 void tcp_server::StartSend(const scc &con, packet &pkt)
 {
-	auto frame = std::make_unique<buffer_t>(frame_queue::MakeFrame(pkt.Data()));
-	auto buf = asio::buffer(*frame);
-	asio::async_write(con->socket, buf,
-	    [this, con, frame = std::move(frame)](const asio::error_code &ec, size_t bytesSent) {
+	std::shared_ptr<buffer_t> frame = send_frames.Acquire();
+	frame_queue::MakeFrame(pkt.Data(), *frame);
+	StartSend(con, std::move(frame));
+}
+
+void tcp_server::StartSend(const scc &con, std::shared_ptr<buffer_t> frame)
+{
+	con->send_queue.push_back(std::move(frame));
+	// Only one write may be in flight per socket, the frames queued meanwhile are batched into the next one.
+	if (con->sending.empty())
+		FlushSendQueue(con);
+}
+
+void tcp_server::FlushSendQueue(const scc &con)
+{
+	std::swap(con->sending, con->send_queue);
+	std::vector<asio::const_buffer> buffers;
+	buffers.reserve(con->sending.size());
+	for (const std::shared_ptr<buffer_t> &frame : con->sending)
+		buffers.push_back(asio::buffer(*frame));
+	asio::async_write(con->socket, buffers,
+	    [this, con](const asio::error_code &ec, size_t bytesSent) {
+		    for (std::shared_ptr<buffer_t> &frame : con->sending)
+			    send_frames.Release(std::move(frame));
+		    con->sending.clear();
 		    HandleSend(con, ec, bytesSent);
+		    if (ec)
+			    con->send_queue.clear();
+		    else if (!con->send_queue.empty())
+			    FlushSendQueue(con);
 	    });
 }
 
 void tcp_server::HandleSend(const scc &con, const asio::error_code &ec,
     size_t bytesSent)
 {
-	// empty for now
+	bytes_sent += bytesSent;
 }
 
 void tcp_server::StartAccept()
@@ -174,7 +273,7 @@ void tcp_server::HandleAccept(const scc &con, const asio::error_code &ec)
 {
 	if (ec)
 		return;
-	if (NextFree() == PLR_BROADCAST) {
+	if (NextFree() == PLR_BROADCAST && spectators.size() >= max_spectators) {
 		DropConnection(con);
 	} else {
 		asio::ip::tcp::no_delay option(true);
@@ -211,13 +310,26 @@ void tcp_server::HandleTimeout(const scc &con, const asio::error_code &ec)
 
 void tcp_server::DropConnection(const scc &con)
 {
+	if (con->spectator) {
+		con->spectator = false;
+		spectators.erase(std::find(spectators.begin(), spectators.end(), con));
+	}
 	if (con->plr != PLR_BROADCAST) {
 		auto pkt = pktfty.make_packet<PT_DISCONNECT>(PLR_MASTER, PLR_BROADCAST,
 		    con->plr, LEAVE_DROP);
 		connections[con->plr] = nullptr;
+		con->plr = PLR_BROADCAST;
 		SendPacket(*pkt);
 		// TODO: investigate if it is really ok for the server to
 		//       drop a client directly.
+		if (Empty()) {
+			// The game is over, the next player to join creates a new one.
+			while (!spectators.empty())
+				DropConnection(spectators.back());
+			history.clear();
+			history_size = 0;
+			history_complete = true;
+		}
 	}
 	con->timer.cancel();
 	con->socket.close();
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <asio/ts/buffer.hpp>
 #include <asio/ts/internet.hpp>
@@ -27,23 +29,40 @@ public:
 
 class tcp_server {
 public:
+	struct stats {
+		size_t players;
+		size_t spectators;
+		uint64_t packets_received;
+		uint64_t bytes_sent;
+	};
+
 	tcp_server(asio::io_context &ioc, const std::string &bindaddr,
 	    unsigned short port, packet_factory &pktfty);
 	std::string LocalhostSelf();
+	stats GetStats() const;
 	void Close();
 	virtual ~tcp_server();
 
 private:
 	static constexpr int timeout_connect = 30;
 	static constexpr int timeout_active = 60;
+	static constexpr size_t max_spectators = 64;
+	/** @brief Frames kept for spectators who join late, once a game sent more they can't catch up anymore. */
+	static constexpr size_t max_history_size = 64 * 1024 * 1024;
 
 	struct client_connection {
 		frame_queue recv_queue;
 		buffer_t recv_buffer = buffer_t(frame_queue::max_frame_size);
 		plr_t plr = PLR_BROADCAST;
+		/** @brief Spectators receive what is broadcast to the players, but everything they send is dropped. */
+		bool spectator = false;
 		asio::ip::tcp::socket socket;
 		asio::steady_timer timer;
 		int timeout;
+		/** @brief Frames waiting for the write in flight to finish, they go out together in the next one. */
+		std::vector<std::shared_ptr<buffer_t>> send_queue;
+		/** @brief Frames of the write in flight, empty if there is none. */
+		std::vector<std::shared_ptr<buffer_t>> sending;
 		client_connection(asio::io_context &ioc)
 		    : socket(ioc)
 		    , timer(ioc)
@@ -57,7 +76,18 @@ private:
 	packet_factory &pktfty;
 	std::unique_ptr<asio::ip::tcp::acceptor> acceptor;
 	std::array<scc, MAX_PLRS> connections;
+	std::vector<scc> spectators;
+	/**
+	 * @brief Every frame broadcast since the game was created, so that a spectator can run the game from the start.
+	 */
+	std::vector<std::shared_ptr<buffer_t>> history;
+	size_t history_size = 0;
+	/** @brief False once the history outgrew max_history_size, new spectators are turned away then. */
+	bool history_complete = true;
 	buffer_t game_init_info;
+	frame_pool send_frames;
+	uint64_t packets_received = 0;
+	uint64_t bytes_sent = 0;
 
 	scc MakeConnection();
 	plr_t NextFree();
@@ -67,9 +97,14 @@ private:
 	void StartReceive(const scc &con);
 	void HandleReceive(const scc &con, const asio::error_code &ec, size_t bytesRead);
 	void HandleReceiveNewPlayer(const scc &con, packet &pkt);
+	void HandleReceiveSpectator(const scc &con, packet &pkt);
 	void HandleReceivePacket(packet &pkt);
 	void SendPacket(packet &pkt);
+	/** @brief Sends a broadcast frame to the spectators and keeps it for the ones that join later. */
+	void SendToSpectators(const std::shared_ptr<buffer_t> &frame);
 	void StartSend(const scc &con, packet &pkt);
+	void StartSend(const scc &con, std::shared_ptr<buffer_t> frame);
+	void FlushSendQueue(const scc &con);
 	void HandleSend(const scc &con, const asio::error_code &ec, size_t bytesSent);
 	void StartTimeout(const scc &con);
 	void HandleTimeout(const scc &con, const asio::error_code &ec);
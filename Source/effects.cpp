@@ -10,6 +10,7 @@
 #include "engine/sound_defs.hpp"
 #include "init.h"
 #include "player.h"
+#include "utils/perf_scope.hpp"
 #include "utils/stdcompat/algorithm.hpp"
 #include "utils/str_cat.hpp"
 
@@ -1306,6 +1307,8 @@ void sound_init()
 
 void ui_sound_init()
 {
+	DVL_PERF_FUNCTION();
+
 	PrivSoundInit(sfx_UI);
 }
 
@@ -3,6 +3,7 @@
  *
  * Implementation of functions for compression and decompressing MPQ data.
  */
+#include <algorithm>
 #include <array>
 #include <cctype>
 #include <cstring>
@@ -57,6 +58,33 @@ const std::array<std::array<uint32_t, 256>, 5> hashtable = []() {
 	return ret;
 }();
 
+/**
+ * @brief The work memory of the PKWARE codec and a buffer for its output, reused by every call on the same thread.
+ *
+ * Saving compresses every file of the save and delta levels are compressed for every player that joins, so allocating
+ * them per call added up. The buffers are per thread because saves are written on a worker thread.
+ */
+struct PkwareContext {
+	std::unique_ptr<char[]> workBuffer { new char[std::max(CMP_BUFFER_SIZE, EXP_BUFFER_SIZE)] };
+	std::unique_ptr<byte[]> output;
+	size_t outputSize = 0;
+
+	byte *getOutput(size_t size)
+	{
+		if (size > outputSize) {
+			output.reset(new byte[size]);
+			outputSize = size;
+		}
+		return output.get();
+	}
+};
+
+PkwareContext &GetPkwareContext()
+{
+	thread_local PkwareContext context;
+	return context;
+}
+
 } // namespace
 
 void Decrypt(uint32_t *castBlock, uint32_t size, uint32_t key)
@@ -103,27 +131,27 @@ uint32_t Hash(const char *s, int type)
 
 uint32_t PkwareCompress(byte *srcData, uint32_t size)
 {
-	std::unique_ptr<char[]> ptr = std::make_unique<char[]>(CMP_BUFFER_SIZE);
+	PkwareContext &context = GetPkwareContext();
 
 	unsigned destSize = 2 * size;
 	if (destSize < 2 * 4096)
 		destSize = 2 * 4096;
 
-	std::unique_ptr<byte[]> destData { new byte[destSize] };
+	byte *destData = context.getOutput(destSize);
 
 	TDataInfo param;
 	param.srcData = srcData;
 	param.srcOffset = 0;
-	param.destData = destData.get();
+	param.destData = destData;
 	param.destOffset = 0;
 	param.size = size;
 
 	unsigned type = 0;
 	unsigned dsize = 4096;
-	implode(PkwareBufferRead, PkwareBufferWrite, ptr.get(), &param, &type, &dsize);
+	implode(PkwareBufferRead, PkwareBufferWrite, context.workBuffer.get(), &param, &type, &dsize);
 
 	if (param.destOffset < size) {
-		memcpy(srcData, destData.get(), param.destOffset);
+		memcpy(srcData, destData, param.destOffset);
 		size = param.destOffset;
 	}
 
@@ -132,18 +160,18 @@ uint32_t PkwareCompress(byte *srcData, uint32_t size)
 
 void PkwareDecompress(byte *inBuff, uint32_t recvSize, int maxBytes)
 {
-	std::unique_ptr<char[]> ptr = std::make_unique<char[]>(CMP_BUFFER_SIZE);
-	std::unique_ptr<byte[]> outBuff { new byte[maxBytes] };
+	PkwareContext &context = GetPkwareContext();
+	byte *outBuff = context.getOutput(maxBytes);
 
 	TDataInfo info;
 	info.srcData = inBuff;
 	info.srcOffset = 0;
-	info.destData = outBuff.get();
+	info.destData = outBuff;
 	info.destOffset = 0;
 	info.size = recvSize;
 
-	explode(PkwareBufferRead, PkwareBufferWrite, ptr.get(), &info);
-	memcpy(inBuff, outBuff.get(), info.destOffset);
+	explode(PkwareBufferRead, PkwareBufferWrite, context.workBuffer.get(), &info);
+	memcpy(inBuff, outBuff, info.destOffset);
 }
 
 } // namespace devilution
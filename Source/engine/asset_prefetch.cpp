@@ -0,0 +1,242 @@
+#include "engine/asset_prefetch.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+#include <SDL.h>
+
+#include "engine/assets.hpp"
+#include "utils/sdl_cond.h"
+#include "utils/sdl_mutex.h"
+#include "utils/sdl_thread.h"
+#include "utils/stdcompat/optional.hpp"
+
+namespace devilution {
+
+namespace {
+
+enum class PrefetchState : uint8_t {
+	Pending,
+	Reading,
+	Done,
+};
+
+struct PrefetchedAsset {
+	std::string filename;
+	/** @brief Opened on the main thread, read and closed by the worker. */
+	SDL_RWops *handle;
+	PrefetchState state = PrefetchState::Pending;
+	/** @brief Set for assets that were discarded while being read, the worker frees them once it's done. */
+	bool discarded = false;
+	std::unique_ptr<byte[]> data;
+	std::size_t size = 0;
+};
+
+struct Prefetcher {
+	SdlMutex mutex;
+	SdlCond workAvailable;
+	SdlCond assetDone;
+	std::vector<std::unique_ptr<PrefetchedAsset>> assets;
+	bool stopping = false;
+	SdlThread worker;
+
+	Prefetcher()
+	    : worker(WorkerMain, this)
+	{
+	}
+
+	~Prefetcher()
+	{
+		{
+			std::lock_guard<SdlMutex> lock(mutex);
+			DiscardAll();
+			stopping = true;
+			workAvailable.signal();
+		}
+		worker.join();
+	}
+
+	/** @brief Requires the mutex. */
+	void DiscardAll()
+	{
+		for (std::unique_ptr<PrefetchedAsset> &asset : assets) {
+			if (asset->state == PrefetchState::Pending)
+				SDL_RWclose(asset->handle);
+			asset->discarded = true;
+		}
+		EraseDiscarded();
+	}
+
+	/** @brief Requires the mutex. */
+	void EraseDiscarded()
+	{
+		assets.erase(std::remove_if(assets.begin(), assets.end(), [](const std::unique_ptr<PrefetchedAsset> &asset) {
+			return asset->discarded && asset->state != PrefetchState::Reading;
+		}),
+		    assets.end());
+	}
+
+	static int SDLCALL WorkerMain(void *data)
+	{
+		Prefetcher &prefetcher = *static_cast<Prefetcher *>(data);
+		std::unique_lock<SdlMutex> lock(prefetcher.mutex);
+		while (true) {
+			auto it = std::find_if(prefetcher.assets.begin(), prefetcher.assets.end(), [](const std::unique_ptr<PrefetchedAsset> &asset) {
+				return asset->state == PrefetchState::Pending;
+			});
+			if (it == prefetcher.assets.end()) {
+				if (prefetcher.stopping)
+					return 0;
+				prefetcher.workAvailable.wait(prefetcher.mutex);
+				continue;
+			}
+
+			PrefetchedAsset &asset = **it;
+			asset.state = PrefetchState::Reading;
+			lock.unlock();
+			const Sint64 rwSize = SDL_RWsize(asset.handle);
+			const std::size_t size = rwSize > 0 ? static_cast<std::size_t>(rwSize) : 0;
+			std::unique_ptr<byte[]> contents;
+			if (size != 0) {
+				contents = std::unique_ptr<byte[]> { new byte[size] };
+				if (SDL_RWread(asset.handle, contents.get(), size, 1) != 1)
+					contents = nullptr;
+			}
+			SDL_RWclose(asset.handle);
+			lock.lock();
+
+			asset.data = std::move(contents);
+			asset.size = size;
+			asset.state = PrefetchState::Done;
+			if (asset.discarded)
+				prefetcher.EraseDiscarded();
+			prefetcher.assetDone.broadcast();
+		}
+	}
+};
+
+std::optional<Prefetcher> ThePrefetcher;
+
+} // namespace
+
+void PrefetchAssets(const std::vector<std::string> &filenames)
+{
+	if (!ThePrefetcher)
+		ThePrefetcher.emplace();
+
+	std::lock_guard<SdlMutex> lock(ThePrefetcher->mutex);
+	ThePrefetcher->DiscardAll();
+	for (const std::string &filename : filenames) {
+		// Opening the archive clone is done here, in the same way as for streamed audio.
+		SDL_RWops *handle = OpenAsset(filename.c_str(), /*threadsafe=*/true);
+		if (handle == nullptr)
+			continue;
+		auto asset = std::make_unique<PrefetchedAsset>();
+		asset->filename = filename;
+		asset->handle = handle;
+		ThePrefetcher->assets.push_back(std::move(asset));
+	}
+	ThePrefetcher->workAvailable.signal();
+}
+
+bool PrefetchAsset(const char *filename)
+{
+	if (!ThePrefetcher)
+		ThePrefetcher.emplace();
+
+	std::lock_guard<SdlMutex> lock(ThePrefetcher->mutex);
+	std::vector<std::unique_ptr<PrefetchedAsset>> &assets = ThePrefetcher->assets;
+	if (std::any_of(assets.begin(), assets.end(), [filename](const std::unique_ptr<PrefetchedAsset> &asset) {
+		    return !asset->discarded && asset->filename == filename;
+	    })) {
+		return true;
+	}
+	SDL_RWops *handle = OpenAsset(filename, /*threadsafe=*/true);
+	if (handle == nullptr)
+		return false;
+	auto asset = std::make_unique<PrefetchedAsset>();
+	asset->filename = filename;
+	asset->handle = handle;
+	assets.push_back(std::move(asset));
+	ThePrefetcher->workAvailable.signal();
+	return true;
+}
+
+PrefetchStatus GetPrefetchStatus(const char *filename)
+{
+	if (!ThePrefetcher)
+		return PrefetchStatus::NotQueued;
+
+	std::lock_guard<SdlMutex> lock(ThePrefetcher->mutex);
+	const std::vector<std::unique_ptr<PrefetchedAsset>> &assets = ThePrefetcher->assets;
+	auto it = std::find_if(assets.begin(), assets.end(), [filename](const std::unique_ptr<PrefetchedAsset> &asset) {
+		return !asset->discarded && asset->filename == filename;
+	});
+	if (it == assets.end())
+		return PrefetchStatus::NotQueued;
+	return (*it)->state == PrefetchState::Done ? PrefetchStatus::Ready : PrefetchStatus::Loading;
+}
+
+std::unique_ptr<byte[]> TakePrefetchedAsset(const char *filename, std::size_t &size)
+{
+	if (!ThePrefetcher)
+		return nullptr;
+
+	std::lock_guard<SdlMutex> lock(ThePrefetcher->mutex);
+	std::vector<std::unique_ptr<PrefetchedAsset>> &assets = ThePrefetcher->assets;
+	auto it = std::find_if(assets.begin(), assets.end(), [filename](const std::unique_ptr<PrefetchedAsset> &asset) {
+		return !asset->discarded && asset->filename == filename;
+	});
+	if (it == assets.end())
+		return nullptr;
+
+	PrefetchedAsset &asset = **it;
+	if (asset.state == PrefetchState::Pending) {
+		// Reading it here is just as fast as waiting for the worker to get to it.
+		SDL_RWclose(asset.handle);
+		assets.erase(it);
+		return nullptr;
+	}
+	while (asset.state != PrefetchState::Done)
+		ThePrefetcher->assetDone.wait(ThePrefetcher->mutex);
+
+	std::unique_ptr<byte[]> data = std::move(asset.data);
+	size = asset.size;
+	// The worker may have erased other assets while we were waiting, so look this one up again.
+	assets.erase(std::find_if(assets.begin(), assets.end(), [&asset](const std::unique_ptr<PrefetchedAsset> &other) {
+		return other.get() == &asset;
+	}));
+	return data;
+}
+
+void DiscardPrefetchedAsset(const char *filename)
+{
+	if (!ThePrefetcher)
+		return;
+
+	std::lock_guard<SdlMutex> lock(ThePrefetcher->mutex);
+	for (std::unique_ptr<PrefetchedAsset> &asset : ThePrefetcher->assets) {
+		if (asset->discarded || asset->filename != filename)
+			continue;
+		if (asset->state == PrefetchState::Pending)
+			SDL_RWclose(asset->handle);
+		asset->discarded = true;
+	}
+	ThePrefetcher->EraseDiscarded();
+}
+
+void DiscardPrefetchedAssets()
+{
+	if (!ThePrefetcher)
+		return;
+
+	std::lock_guard<SdlMutex> lock(ThePrefetcher->mutex);
+	ThePrefetcher->DiscardAll();
+}
+
+void StopAssetPrefetch()
+{
+	ThePrefetcher = std::nullopt;
+}
+
+} // namespace devilution
@@ -0,0 +1,67 @@
+/**
+ * @file asset_prefetch.hpp
+ *
+ * Interface for reading assets on a background thread before they are needed.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utils/stdcompat/cstddef.hpp"
+
+namespace devilution {
+
+/**
+ * @brief Starts reading the given assets on a background thread.
+ *
+ * Assets that were prefetched earlier and haven't been taken yet are discarded.
+ * The prefetch functions must only be called from the main thread.
+ */
+void PrefetchAssets(const std::vector<std::string> &filenames);
+
+/**
+ * @brief Queues a single asset for the background thread, keeping the ones that are already queued.
+ *
+ * Does nothing if the asset is already queued. It stays until it is taken or the next PrefetchAssets call.
+ * @return false if the asset can't be opened
+ */
+bool PrefetchAsset(const char *filename);
+
+enum class PrefetchStatus : uint8_t {
+	NotQueued,
+	/** @brief TakePrefetchedAsset would have to wait for the asset or read it itself. */
+	Loading,
+	Ready,
+};
+
+[[nodiscard]] PrefetchStatus GetPrefetchStatus(const char *filename);
+
+/**
+ * @brief Hands over the contents of a prefetched asset, waiting for it if it is still being read.
+ *
+ * @param filename Must be spelled the same way as when it was passed to PrefetchAssets.
+ * @param size Receives the size of the asset.
+ * @return nullptr if the asset wasn't prefetched or its reading hasn't started yet.
+ */
+std::unique_ptr<byte[]> TakePrefetchedAsset(const char *filename, std::size_t &size);
+
+/**
+ * @brief Frees a prefetched asset that hasn't been taken, does nothing if it isn't queued.
+ */
+void DiscardPrefetchedAsset(const char *filename);
+
+/**
+ * @brief Frees all prefetched assets that haven't been taken.
+ */
+void DiscardPrefetchedAssets();
+
+/**
+ * @brief Discards all prefetched assets and stops the background thread.
+ */
+void StopAssetPrefetch();
+
+} // namespace devilution
@@ -3,12 +3,22 @@
 #include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include "init.h"
 #include "mpq/mpq_sdl_rwops.hpp"
 #include "utils/file_util.h"
 #include "utils/log.hpp"
 #include "utils/paths.h"
+#include "utils/sdl_mutex.h"
+#include "utils/str_cat.hpp"
+
+#ifdef USE_SDL1
+#include "utils/sdl2_to_1_2_backports.h"
+#endif
 
 namespace devilution {
 
@@ -29,8 +39,165 @@ bool OpenMpqFile(const char *filename, MpqArchive **archive, uint32_t *fileNumbe
 	    || (gbIsHellfire && (at(hfvoice_mpq) || at(hfmusic_mpq) || at(hfbarb_mpq) || at(hfbard_mpq) || at(hfmonk_mpq) || at(hellfire_mpq))) || at(spawn_mpq) || at(diabdat_mpq);
 }
 
+struct AssetLocation {
+	enum class Source : uint8_t {
+		/** @brief A loose file in the `PrefPath()` directory. */
+		Override,
+		Mpq,
+		/** @brief Neither of the above, the remaining locations are checked every time. */
+		Other,
+	};
+
+	Source source;
+	MpqArchive *archive;
+	uint32_t fileNumber;
+};
+
+struct SharedAssetEntry {
+	ArrayWeakPtr<std::uint8_t> data;
+	std::size_t size;
+};
+
+/**
+ * @brief Remembers where each asset was found, so that the override directory and the archives are only searched once per file.
+ *
+ * MPQ archives don't list their contents, so the index is filled in as files are looked up rather than up front.
+ */
+struct AssetIndex {
+	SdlMutex mutex;
+	std::unordered_map<std::string, AssetLocation> locations;
+	/** @brief Assets loaded with LoadSharedAsset, so that consumers loading the same file share a single buffer. */
+	std::unordered_map<std::string, SharedAssetEntry> sharedAssets;
+	/** @brief The Hellfire archives are only searched in Hellfire games. */
+	bool isHellfire = false;
+
+	/** @brief Requires the mutex. */
+	void Clear()
+	{
+		locations.clear();
+		sharedAssets.clear();
+	}
+
+	/** @brief Requires the mutex. */
+	void ClearIfGameTypeChanged()
+	{
+		if (isHellfire != gbIsHellfire) {
+			Clear();
+			isHellfire = gbIsHellfire;
+		}
+	}
+};
+
+AssetIndex &GetAssetIndex()
+{
+	static AssetIndex Index;
+	return Index;
+}
+
+AssetLocation FindAsset(const char *filename, const std::string &relativePath)
+{
+	AssetIndex &index = GetAssetIndex();
+	std::lock_guard<SdlMutex> lock(index.mutex);
+	index.ClearIfGameTypeChanged();
+
+	const auto it = index.locations.find(filename);
+	if (it != index.locations.end())
+		return it->second;
+
+	AssetLocation location { AssetLocation::Source::Other, nullptr, 0 };
+	if (FileExists((paths::PrefPath() + relativePath).c_str()))
+		location.source = AssetLocation::Source::Override;
+	else if (OpenMpqFile(filename, &location.archive, &location.fileNumber))
+		location.source = AssetLocation::Source::Mpq;
+	index.locations.emplace(filename, location);
+	return location;
+}
+
+struct SharedAssetRwData {
+	SharedAsset asset;
+	std::size_t position;
+};
+
+SharedAssetRwData *GetSharedAssetRwData(struct SDL_RWops *context)
+{
+	return reinterpret_cast<SharedAssetRwData *>(context->hidden.unknown.data1);
+}
+
+#ifndef USE_SDL1
+using OffsetType = Sint64;
+using SizeType = size_t;
+#else
+using OffsetType = int;
+using SizeType = int;
+#endif
+
+extern "C" {
+
+#ifndef USE_SDL1
+static Sint64 SharedAssetRwSize(struct SDL_RWops *context)
+{
+	return GetSharedAssetRwData(context)->asset.size();
+}
+#endif
+
+static OffsetType SharedAssetRwSeek(struct SDL_RWops *context, OffsetType offset, int whence)
+{
+	SharedAssetRwData &data = *GetSharedAssetRwData(context);
+	OffsetType newPosition;
+	switch (whence) {
+	case RW_SEEK_SET:
+		newPosition = offset;
+		break;
+	case RW_SEEK_CUR:
+		newPosition = static_cast<OffsetType>(data.position) + offset;
+		break;
+	case RW_SEEK_END:
+		newPosition = static_cast<OffsetType>(data.asset.size()) + offset;
+		break;
+	default:
+		return -1;
+	}
+
+	if (newPosition < 0 || newPosition > static_cast<OffsetType>(data.asset.size())) {
+		SDL_SetError("SharedAssetRwSeek out of bounds (%d)", static_cast<int>(newPosition));
+		return -1;
+	}
+
+	data.position = static_cast<std::size_t>(newPosition);
+	return newPosition;
+}
+
+static SizeType SharedAssetRwRead(struct SDL_RWops *context, void *ptr, SizeType size, SizeType maxnum)
+{
+	SharedAssetRwData &data = *GetSharedAssetRwData(context);
+	if (size == 0)
+		return 0;
+	const std::size_t remaining = data.asset.size() - data.position;
+	const SizeType num = std::min(maxnum, static_cast<SizeType>(remaining / size));
+	const std::size_t readSize = static_cast<std::size_t>(num) * size;
+	std::memcpy(ptr, data.asset.data() + data.position, readSize);
+	data.position += readSize;
+	return num;
+}
+
+static int SharedAssetRwClose(struct SDL_RWops *context)
+{
+	delete GetSharedAssetRwData(context);
+	delete context;
+	return 0;
+}
+
+} // extern "C"
+
 } // namespace
 
+void ResetAssetIndex()
+{
+	AssetIndex &index = GetAssetIndex();
+	std::lock_guard<SdlMutex> lock(index.mutex);
+	index.Clear();
+}
+
 SDL_RWops *OpenAsset(const char *filename, bool threadsafe)
 {
 	std::string relativePath = filename;
@@ -52,20 +219,20 @@ SDL_RWops *OpenAsset(const char *filename, bool threadsafe)
 		    && (rwops = SDL_RWFromFile(path.c_str(), "rb")) != nullptr;
 	};
 
+	const AssetLocation location = FindAsset(filename, relativePath);
+
 	// Files in the `PrefPath()` directory can override MPQ contents.
-	{
+	if (location.source == AssetLocation::Source::Override) {
 		const std::string path = paths::PrefPath() + relativePath;
-		if (loadFile(path)) {
+		if ((rwops = SDL_RWFromFile(path.c_str(), "rb")) != nullptr) {
 			LogVerbose("Loaded MPQ file override: {}", path);
 			return rwops;
 		}
 	}
 
 	// Load from all the MPQ archives.
-	MpqArchive *archive;
-	uint32_t fileNumber;
-	if (OpenMpqFile(filename, &archive, &fileNumber))
-		return SDL_RWops_FromMpqFile(*archive, fileNumber, filename, threadsafe);
+	if (location.source == AssetLocation::Source::Mpq)
+		return SDL_RWops_FromMpqFile(*location.archive, location.fileNumber, filename, threadsafe);
 
 	// Load from the `/assets` directory next to the devilutionx binary.
 	if (loadFile(paths::AssetsPath() + relativePath))
@@ -81,4 +248,86 @@ SDL_RWops *OpenAsset(const char *filename, bool threadsafe)
 	return nullptr;
 }
 
+std::optional<std::string> GetMpqAssetFingerprint(const char *filename)
+{
+	std::string relativePath = filename;
+#ifndef _WIN32
+	std::replace(relativePath.begin(), relativePath.end(), '\\', '/');
+#endif
+	if (relativePath[0] == '/')
+		return std::nullopt;
+
+	const AssetLocation location = FindAsset(filename, relativePath);
+	if (location.source != AssetLocation::Source::Mpq)
+		return std::nullopt;
+	MpqArchive *archive = location.archive;
+	const uint32_t fileNumber = location.fileNumber;
+
+	std::uintmax_t archiveSize;
+	if (!GetFileSize(archive->GetPath().c_str(), &archiveSize))
+		return std::nullopt;
+	int32_t error = 0;
+	const std::size_t unpackedSize = archive->GetUnpackedFileSize(fileNumber, error);
+	if (error != 0)
+		return std::nullopt;
+
+	return StrCat(archive->GetPath(), ":", std::to_string(archiveSize), ":", static_cast<int>(fileNumber), ":", std::to_string(unpackedSize));
+}
+
+SharedAsset LoadSharedAsset(const char *filename)
+{
+	AssetIndex &index = GetAssetIndex();
+	{
+		std::lock_guard<SdlMutex> lock(index.mutex);
+		index.ClearIfGameTypeChanged();
+		const auto it = index.sharedAssets.find(filename);
+		if (it != index.sharedAssets.end()) {
+			if (ArraySharedPtr<std::uint8_t> data = it->second.data.lock())
+				return SharedAsset { std::move(data), it->second.size };
+			index.sharedAssets.erase(it);
+		}
+	}
+
+	// Read without holding the lock, so that other assets can be opened in the meantime.
+	SDL_RWops *handle = OpenAsset(filename);
+	if (handle == nullptr)
+		return {};
+	const Sint64 rwSize = SDL_RWsize(handle);
+	if (rwSize < 0) {
+		SDL_RWclose(handle);
+		return {};
+	}
+	const auto size = static_cast<std::size_t>(rwSize);
+	ArraySharedPtr<std::uint8_t> data = MakeArraySharedPtr<std::uint8_t>(size);
+	if (size != 0 && SDL_RWread(handle, data.get(), size, 1) != 1) {
+		SDL_RWclose(handle);
+		return {};
+	}
+	SDL_RWclose(handle);
+
+	std::lock_guard<SdlMutex> lock(index.mutex);
+	index.sharedAssets[filename] = SharedAssetEntry { data, size };
+	return SharedAsset { std::move(data), size };
+}
+
+SDL_RWops *SDL_RWops_FromSharedAsset(SharedAsset asset)
+{
+	auto result = std::make_unique<SDL_RWops>();
+	std::memset(result.get(), 0, sizeof(*result));
+
+#ifndef USE_SDL1
+	result->size = &SharedAssetRwSize;
+	result->type = SDL_RWOPS_UNKNOWN;
+#else
+	result->type = 0;
+#endif
+
+	result->seek = &SharedAssetRwSeek;
+	result->read = &SharedAssetRwRead;
+	result->write = nullptr;
+	result->close = &SharedAssetRwClose;
+	result->hidden.unknown.data1 = new SharedAssetRwData { std::move(asset), 0 };
+	return result.release();
+}
+
 } // namespace devilution
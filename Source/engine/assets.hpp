@@ -1,7 +1,15 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
 #include <SDL.h>
 
+#include "utils/stdcompat/optional.hpp"
+#include "utils/stdcompat/shared_ptr_array.hpp"
+
 namespace devilution {
 
 /**
@@ -11,4 +19,68 @@ namespace devilution {
  */
 SDL_RWops *OpenAsset(const char *filename, bool threadsafe = false);
 
+/**
+ * @brief Forgets where assets were found. Must be called whenever MPQ archives are opened or closed.
+ */
+void ResetAssetIndex();
+
+/**
+ * @brief Describes the MPQ archive entry that `OpenAsset` would load the file from, without reading it.
+ *
+ * @return The archive path and size followed by the file number and unpacked size of the entry,
+ *         or nullopt if the file is overridden by a loose file or isn't in any of the archives.
+ */
+std::optional<std::string> GetMpqAssetFingerprint(const char *filename);
+
+/**
+ * @brief Immutable, reference counted contents of an asset.
+ *
+ * Copies share the same buffer, which is freed once the last copy is gone.
+ */
+class SharedAsset {
+public:
+	SharedAsset() = default;
+
+	SharedAsset(ArraySharedPtr<std::uint8_t> data, std::size_t size)
+	    : data_(std::move(data))
+	    , size_(size)
+	{
+	}
+
+	[[nodiscard]] const std::uint8_t *data() const
+	{
+		return data_.get();
+	}
+
+	[[nodiscard]] std::size_t size() const
+	{
+		return size_;
+	}
+
+	explicit operator bool() const
+	{
+		return data_ != nullptr;
+	}
+
+private:
+	ArraySharedPtr<std::uint8_t> data_;
+	std::size_t size_ = 0;
+};
+
+/**
+ * @brief Reads the whole asset into memory.
+ *
+ * While any copy of the result is still alive, loading the same asset again returns that copy instead of reading it again.
+ *
+ * @return An empty SharedAsset if the file couldn't be opened or read, see SDL_GetError for the reason.
+ */
+SharedAsset LoadSharedAsset(const char *filename);
+
+/**
+ * @brief Creates a read-only SDL_RWops over the asset's contents without copying them.
+ *
+ * The RWops keeps the buffer alive until it gets closed.
+ */
+SDL_RWops *SDL_RWops_FromSharedAsset(SharedAsset asset);
+
 } // namespace devilution
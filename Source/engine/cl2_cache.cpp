@@ -0,0 +1,148 @@
+#include "engine/cl2_cache.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <fmt/format.h>
+
+#include "engine/assets.hpp"
+#include "utils/endian.hpp"
+#include "utils/file_util.h"
+#include "utils/log.hpp"
+#include "utils/paths.h"
+#include "utils/str_cat.hpp"
+
+namespace devilution {
+
+namespace {
+
+#ifdef _WIN32
+#define CACHE_DIRECTORY "cl2cache\\"
+#else
+#define CACHE_DIRECTORY "cl2cache/"
+#endif
+
+constexpr char EntryMagic[4] = { 'C', 'L', '2', 'C' };
+
+// Bump whenever the CL2 conversion changes so that entries written by older versions are ignored.
+constexpr uint32_t FormatVersion = 1;
+
+// Magic, format version, key size, metadata size, CL2 size.
+constexpr size_t EntryHeaderSize = 20;
+
+struct FileCloser {
+	void operator()(FILE *file) const
+	{
+		std::fclose(file);
+	}
+};
+
+using FileUniquePtr = std::unique_ptr<FILE, FileCloser>;
+
+struct CacheLocation {
+	std::string key;
+	std::string path;
+};
+
+std::optional<CacheLocation> GetCacheLocation(const char *assetName, string_view parameters)
+{
+	std::optional<std::string> fingerprint = GetMpqAssetFingerprint(assetName);
+	if (!fingerprint)
+		return std::nullopt;
+
+	CacheLocation location;
+	location.key = StrCat(*fingerprint, "|", assetName, "|");
+	location.key.append(parameters.data(), parameters.size());
+
+	// FNV-1a, only used to name the entry. The full key is stored in the entry and compared when loading.
+	uint64_t hash = 0xCBF29CE484222325;
+	for (char c : location.key) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 0x100000001B3;
+	}
+	location.path = StrCat(paths::PrefPath(), CACHE_DIRECTORY, fmt::format("{:016x}", hash), ".cl2");
+	return location;
+}
+
+bool ReadExactly(FILE *file, void *out, size_t size)
+{
+	return size == 0 || std::fread(out, size, 1, file) == 1;
+}
+
+bool EnsureCacheDirectory()
+{
+	static const bool Created = []() {
+		const std::string path = paths::PrefPath() + CACHE_DIRECTORY;
+		if (!CreateDir(path.c_str())) {
+			LogWarn("Failed to create the CL2 cache directory {}", path);
+			return false;
+		}
+		return true;
+	}();
+	return Created;
+}
+
+} // namespace
+
+std::optional<Cl2CacheEntry> LoadFromCl2Cache(const char *assetName, string_view parameters)
+{
+	const std::optional<CacheLocation> location = GetCacheLocation(assetName, parameters);
+	if (!location)
+		return std::nullopt;
+
+	FileUniquePtr file { FOpen(location->path.c_str(), "rb") };
+	if (file == nullptr)
+		return std::nullopt;
+
+	uint8_t header[EntryHeaderSize];
+	if (!ReadExactly(file.get(), header, sizeof(header))
+	    || std::memcmp(header, EntryMagic, sizeof(EntryMagic)) != 0
+	    || LoadLE32(&header[4]) != FormatVersion
+	    || LoadLE32(&header[8]) != location->key.size())
+		return std::nullopt;
+
+	std::string key(location->key.size(), '\0');
+	if (!ReadExactly(file.get(), &key[0], key.size()) || key != location->key)
+		return std::nullopt;
+
+	Cl2CacheEntry entry;
+	entry.metadata.resize(LoadLE32(&header[12]));
+	entry.size = LoadLE32(&header[16]);
+	entry.data = std::unique_ptr<byte[]> { new byte[entry.size] };
+	if (!ReadExactly(file.get(), &entry.metadata[0], entry.metadata.size())
+	    || !ReadExactly(file.get(), entry.data.get(), entry.size)) {
+		// Most likely an entry that was only partially written. It is overwritten once the sprite is converted again.
+		return std::nullopt;
+	}
+	return entry;
+}
+
+void StoreInCl2Cache(const char *assetName, string_view parameters, const byte *data, size_t size, string_view metadata)
+{
+	const std::optional<CacheLocation> location = GetCacheLocation(assetName, parameters);
+	if (!location || !EnsureCacheDirectory())
+		return;
+
+	FileUniquePtr file { FOpen(location->path.c_str(), "wb") };
+	if (file == nullptr) {
+		LogVerbose("Failed to write CL2 cache entry {}", location->path);
+		return;
+	}
+
+	uint8_t header[EntryHeaderSize];
+	std::memcpy(header, EntryMagic, sizeof(EntryMagic));
+	WriteLE32(&header[4], FormatVersion);
+	WriteLE32(&header[8], static_cast<uint32_t>(location->key.size()));
+	WriteLE32(&header[12], static_cast<uint32_t>(metadata.size()));
+	WriteLE32(&header[16], static_cast<uint32_t>(size));
+	if (std::fwrite(header, sizeof(header), 1, file.get()) != 1
+	    || std::fwrite(location->key.data(), location->key.size(), 1, file.get()) != 1
+	    || (!metadata.empty() && std::fwrite(metadata.data(), metadata.size(), 1, file.get()) != 1)
+	    || std::fwrite(data, size, 1, file.get()) != 1) {
+		file = nullptr;
+		RemoveFile(location->path.c_str());
+	}
+}
+
+} // namespace devilution
@@ -0,0 +1,42 @@
+/**
+ * @file cl2_cache.hpp
+ *
+ * On-disk cache of sprites that were converted to CL2 at load time.
+ * Only available when built with DEVILUTIONX_CL2_CACHE.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "utils/stdcompat/cstddef.hpp"
+#include "utils/stdcompat/optional.hpp"
+#include "utils/stdcompat/string_view.hpp"
+
+namespace devilution {
+
+struct Cl2CacheEntry {
+	std::unique_ptr<byte[]> data;
+	size_t size;
+	/** @brief Conversion results that aren't part of the CL2 data, e.g. the frame size or the palette. */
+	std::string metadata;
+};
+
+/**
+ * @brief Loads a sprite that was previously converted from the given asset with the same parameters.
+ *
+ * Entries are keyed by the location of the asset within the MPQ archives and the size of the archive,
+ * so an updated archive or a loose file override never returns a stale sprite.
+ *
+ * @param assetName The asset the sprite was converted from.
+ * @param parameters Serialized conversion parameters.
+ */
+std::optional<Cl2CacheEntry> LoadFromCl2Cache(const char *assetName, string_view parameters);
+
+/**
+ * @brief Stores a converted sprite. Does nothing if the asset isn't cacheable or the cache can't be written.
+ */
+void StoreInCl2Cache(const char *assetName, string_view parameters, const byte *data, size_t size, string_view metadata);
+
+} // namespace devilution
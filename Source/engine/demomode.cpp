@@ -1,11 +1,16 @@
 #include "engine/demomode.h"
 
+#include <cstring>
 #include <deque>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <sstream>
+#include <vector>
 
 #include "controls/plrctrls.h"
+#include "engine/frame_timings.hpp"
+#include "engine/state_hash.hpp"
 #include "menu.h"
 #include "nthread.h"
 #include "options.h"
@@ -33,15 +38,39 @@ struct DemoMsg {
 	float progressToNextGameTick;
 };
 
+/**
+ * @brief Version of the demos that are recorded
+ *
+ * Version 0 stores every record as fixed-width fields. Version 1 starts each record with a byte holding the type in
+ * its low bits and whether the progress to the next game tick changed since the previous record. The progress follows
+ * only if it changed, the fields of a message are LEB128 varints.
+ */
+constexpr uint8_t DemoVersion = 1;
+constexpr uint8_t RecordTypeMask = 0x03;
+constexpr uint8_t RecordNewProgress = 0x04;
+
+/** @brief Recorded demo data is collected here and written in chunks of this size. */
+constexpr size_t DemoRecordingFlushSize = 64 * 1024;
+
 int DemoNumber = -1;
 bool Timedemo = false;
 int RecordNumber = -1;
 bool CreateDemoReference = false;
 
 std::ofstream DemoRecording;
+std::vector<uint8_t> DemoRecordingBuffer;
+/** @brief The progress to the next game tick of the last record written, records only store it when it changes. */
+float DemoRecordingProgress = 0.F;
 std::deque<DemoMsg> Demo_Message_Queue;
 uint32_t DemoModeLastTick = 0;
 
+constexpr uint8_t StateHashVersion = 0;
+std::ofstream StateHashRecording;
+std::vector<GameStateHash> RecordedStateHashes;
+size_t StateHashTick = 0;
+/** @brief Only the first divergence is reported, everything after it follows from it. */
+bool StateHashDiverged = false;
+
 int LogicTick = 0;
 int StartTime = 0;
 
@@ -53,6 +82,95 @@ void PumpDemoMessage(DemoMsgType demoMsgType, uint32_t message, uint32_t wParam,
 	Demo_Message_Queue.push_back(DemoMsg { demoMsgType, message, wParam, lParam, progressToNextGameTick });
 }
 
+bool SameProgress(float a, float b)
+{
+	return memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+void WriteVarint(std::vector<uint8_t> &out, uint32_t value)
+{
+	while (value >= 0x80) {
+		out.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+bool ReadVarint(const uint8_t *&src, const uint8_t *end, uint32_t &value)
+{
+	value = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		if (src == end)
+			return false;
+		const uint8_t byte = *src++;
+		value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+void FlushDemoRecording()
+{
+	DemoRecording.write(reinterpret_cast<const char *>(DemoRecordingBuffer.data()), DemoRecordingBuffer.size());
+	DemoRecordingBuffer.clear();
+}
+
+void WriteDemoRecord(DemoMsgType type, const tagMSG *msg)
+{
+	const bool newProgress = !SameProgress(gfProgressToNextGameTick, DemoRecordingProgress);
+	DemoRecordingBuffer.push_back(static_cast<uint8_t>(static_cast<uint8_t>(type) | (newProgress ? RecordNewProgress : 0)));
+	if (newProgress) {
+		uint8_t progress[4];
+		uint32_t progressBits;
+		memcpy(&progressBits, &gfProgressToNextGameTick, sizeof(progressBits));
+		WriteLE32(progress, progressBits);
+		DemoRecordingBuffer.insert(DemoRecordingBuffer.end(), std::begin(progress), std::end(progress));
+		DemoRecordingProgress = gfProgressToNextGameTick;
+	}
+	if (msg != nullptr) {
+		WriteVarint(DemoRecordingBuffer, msg->message);
+		WriteVarint(DemoRecordingBuffer, msg->wParam);
+		WriteVarint(DemoRecordingBuffer, msg->lParam);
+	}
+	if (DemoRecordingBuffer.size() >= DemoRecordingFlushSize)
+		FlushDemoRecording();
+}
+
+/**
+ * @brief Reads the records of a version 1 demo
+ * @return false if the records are cut short or corrupt
+ */
+bool LoadDemoRecords(std::ifstream &demofile)
+{
+	const std::vector<uint8_t> data { std::istreambuf_iterator<char>(demofile), std::istreambuf_iterator<char>() };
+	const uint8_t *src = data.data();
+	const uint8_t *end = src + data.size();
+	float progressToNextGameTick = 0.F;
+	while (src != end) {
+		const uint8_t header = *src++;
+		const auto type = static_cast<DemoMsgType>(header & RecordTypeMask);
+		if ((header & RecordNewProgress) != 0) {
+			if (end - src < 4)
+				return false;
+			const uint32_t progressBits = LoadLE32(src);
+			memcpy(&progressToNextGameTick, &progressBits, sizeof(progressToNextGameTick));
+			src += 4;
+		}
+		if (type != DemoMsgType::Message) {
+			PumpDemoMessage(type, 0, 0, 0, progressToNextGameTick);
+			continue;
+		}
+		uint32_t message;
+		uint32_t wParam;
+		uint32_t lParam;
+		if (!ReadVarint(src, end, message) || !ReadVarint(src, end, wParam) || !ReadVarint(src, end, lParam))
+			return false;
+		PumpDemoMessage(type, message, wParam, static_cast<uint16_t>(lParam), progressToNextGameTick);
+	}
+	return true;
+}
+
 bool LoadDemoMessages(int i)
 {
 	std::ifstream demofile;
@@ -62,7 +180,7 @@ bool LoadDemoMessages(int i)
 	}
 
 	const uint8_t version = ReadByte(demofile);
-	if (version != 0) {
+	if (version > DemoVersion) {
 		return false;
 	}
 
@@ -70,6 +188,13 @@ bool LoadDemoMessages(int i)
 	DemoGraphicsWidth = ReadLE16(demofile);
 	DemoGraphicsHeight = ReadLE16(demofile);
 
+	if (version == 1) {
+		if (!LoadDemoRecords(demofile))
+			return false;
+		DemoModeLastTick = SDL_GetTicks();
+		return true;
+	}
+
 	while (!demofile.eof()) {
 		const uint32_t typeNum = ReadLE32(demofile);
 		const auto type = static_cast<DemoMsgType>(typeNum);
@@ -97,6 +222,48 @@ bool LoadDemoMessages(int i)
 	return true;
 }
 
+std::string GetStateHashPath(int i)
+{
+	return StrCat(paths::PrefPath(), "demo_", i, ".hash");
+}
+
+void LoadStateHashes(int i)
+{
+	RecordedStateHashes.clear();
+
+	std::ifstream hashFile(GetStateHashPath(i), std::fstream::binary);
+	if (!hashFile.is_open() || ReadByte(hashFile) != StateHashVersion)
+		return;
+
+	while (true) {
+		GameStateHash hash;
+		for (uint32_t &categoryHash : hash.categories)
+			categoryHash = ReadLE32(hashFile);
+		if (!hashFile)
+			break;
+		RecordedStateHashes.push_back(hash);
+	}
+}
+
+void CompareStateHash(const GameStateHash &hash)
+{
+	if (StateHashDiverged || StateHashTick >= RecordedStateHashes.size())
+		return;
+
+	const GameStateHash &recorded = RecordedStateHashes[StateHashTick];
+	if (hash == recorded)
+		return;
+
+	StateHashDiverged = true;
+	for (size_t i = 0; i < NumStateHashCategories; i++) {
+		if (hash.categories[i] == recorded.categories[i])
+			continue;
+		const auto category = static_cast<StateHashCategory>(i);
+		SDL_Log("Demo: %s diverged from the recording at tick %u", GetStateHashCategoryName(category), static_cast<unsigned>(StateHashTick));
+		LogStateHashEntities(category);
+	}
+}
+
 } // namespace
 
 namespace demo {
@@ -111,6 +278,7 @@ void InitPlayBack(int demoNumber, bool timedemo)
 		SDL_Log("Unable to load demo file");
 		diablo_quit(1);
 	}
+	LoadStateHashes(demoNumber);
 }
 void InitRecording(int recordNumber, bool createDemoReference)
 {
@@ -150,8 +318,8 @@ bool GetRunGameLoop(bool &drawGame, bool &processInput)
 	const DemoMsg dmsg = Demo_Message_Queue.front();
 	if (dmsg.type == DemoMsgType::Message)
 		app_fatal("Unexpected Message");
-	if (Timedemo) {
-		// disable additonal rendering to speedup replay
+	if (Timedemo || HeadlessMode) {
+		// disable additonal rendering to speedup replay, without a window there is nothing to pace the replay for either
 		drawGame = dmsg.type == DemoMsgType::GameTick && !HeadlessMode;
 	} else {
 		int currentTickCount = SDL_GetTicks();
@@ -183,7 +351,8 @@ bool GetRunGameLoop(bool &drawGame, bool &processInput)
 bool FetchMessage(tagMSG *lpMsg)
 {
 	SDL_Event e;
-	if (SDL_PollEvent(&e) != 0) {
+	// Without a window there are no key presses to stop or speed up the replay with.
+	if (!HeadlessMode && SDL_PollEvent(&e) != 0) {
 		if (e.type == SDL_QUIT) {
 			lpMsg->message = DVL_WM_QUIT;
 			lpMsg->wParam = 0;
@@ -230,42 +399,46 @@ bool FetchMessage(tagMSG *lpMsg)
 
 void RecordGameLoopResult(bool runGameLoop)
 {
-	WriteLE32(DemoRecording, static_cast<uint32_t>(runGameLoop ? DemoMsgType::GameTick : DemoMsgType::Rendering));
-	WriteLEFloat(DemoRecording, gfProgressToNextGameTick);
+	WriteDemoRecord(runGameLoop ? DemoMsgType::GameTick : DemoMsgType::Rendering, nullptr);
 }
 
 void RecordMessage(tagMSG *lpMsg)
 {
 	if (!gbRunGame || !DemoRecording.is_open())
 		return;
-	WriteLE32(DemoRecording, static_cast<uint32_t>(DemoMsgType::Message));
-	WriteLEFloat(DemoRecording, gfProgressToNextGameTick);
-	WriteLE32(DemoRecording, lpMsg->message);
-	WriteLE32(DemoRecording, lpMsg->wParam);
-	WriteLE16(DemoRecording, lpMsg->lParam);
+	WriteDemoRecord(DemoMsgType::Message, lpMsg);
 }
 
 void NotifyGameLoopStart()
 {
 	if (IsRecording()) {
 		DemoRecording.open(StrCat(paths::PrefPath(), "demo_", RecordNumber, ".dmo"), std::fstream::trunc | std::fstream::binary);
-		constexpr uint8_t Version = 0;
-		WriteByte(DemoRecording, Version);
+		WriteByte(DemoRecording, DemoVersion);
 		WriteLE32(DemoRecording, gSaveNumber);
 		WriteLE16(DemoRecording, gnScreenWidth);
 		WriteLE16(DemoRecording, gnScreenHeight);
+
+		StateHashRecording.open(GetStateHashPath(RecordNumber), std::fstream::trunc | std::fstream::binary);
+		WriteByte(StateHashRecording, StateHashVersion);
+		DemoRecordingBuffer.clear();
+		DemoRecordingProgress = 0.F;
 	}
 
 	if (IsRunning()) {
 		StartTime = SDL_GetTicks();
 		LogicTick = 0;
 	}
+
+	StateHashTick = 0;
+	StateHashDiverged = false;
 }
 
 void NotifyGameLoopEnd()
 {
 	if (IsRecording()) {
+		FlushDemoRecording();
 		DemoRecording.close();
+		StateHashRecording.close();
 		if (CreateDemoReference)
 			pfile_write_hero_demo(RecordNumber);
 
@@ -294,6 +467,24 @@ void NotifyGameLoopEnd()
 	}
 }
 
+void NotifyGameLogicEnd()
+{
+	const bool recording = IsRecording() && StateHashRecording.is_open();
+	const bool comparing = IsRunning() && !RecordedStateHashes.empty();
+	if (!recording && !comparing)
+		return;
+
+	FrameStageTimer frameStageTimer(FrameStage::StateHash);
+	const GameStateHash hash = ComputeGameStateHash();
+	if (recording) {
+		for (uint32_t categoryHash : hash.categories)
+			WriteLE32(StateHashRecording, categoryHash);
+	}
+	if (comparing)
+		CompareStateHash(hash);
+	StateHashTick++;
+}
+
 } // namespace demo
 
 } // namespace devilution
@@ -26,6 +26,13 @@ void RecordMessage(tagMSG *lpMsg);
 void NotifyGameLoopStart();
 void NotifyGameLoopEnd();
 
+/**
+ * @brief Records the state hash after a game tick, or compares it with the recorded one when replaying.
+ *
+ * The hashes are kept next to the demo in demo_<number>.hash. Demos without one replay without the check.
+ */
+void NotifyGameLogicEnd();
+
 } // namespace demo
 
 } // namespace devilution
@@ -5,15 +5,25 @@
  */
 #include "engine/dx.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
 #include <SDL.h>
 
 #include "controls/plrctrls.h"
 #include "controls/touch/renderers.h"
 #include "engine.h"
+#include "engine/frame_timings.hpp"
+#include "engine/input_latency.hpp"
 #include "options.h"
 #include "utils/display.h"
 #include "utils/log.hpp"
 #include "utils/sdl_wrap.h"
+#include "utils/stdcompat/optional.hpp"
 
 #ifdef __3DS__
 #include <3ds.h>
@@ -38,6 +48,34 @@ SDLSurfaceUniquePtr RendererTextureSurface;
 SDL_Surface *PalSurface;
 namespace {
 SDLSurfaceUniquePtr PinnedPalSurface;
+
+/** Copy of `PalSurface` as it was last copied to the output surface, used to skip the rows that did not change. */
+std::unique_ptr<uint8_t[]> PresentedPalSurface;
+/** Whether the output surface may no longer match `PresentedPalSurface`, until the next full copy. */
+bool PresentedPalSurfaceStale = true;
+/**
+ * Palette colors that changed since the last presented frame, a row showing any of them has to be copied again even if
+ * its pixels are unchanged. Color cycling only changes a few colors, most rows don't show them.
+ */
+std::array<bool, 256> ChangedPaletteColors {};
+bool AnyPaletteColorChanged = false;
+
+/** Threads that share the rendering work, started on demand when the Render Threads option is above 1 */
+std::optional<ThreadPool> RenderThreads;
+
+/** Part of the output surface that was written to since the last `RenderPresent`. */
+SDL_Rect OutputDirtyRect {};
+bool OutputFullyDirty = true;
+
+#ifndef USE_SDL1
+/**
+ * Whether the last full frame was converted straight into the renderer texture, leaving the output surface behind.
+ * The frame is then `PresentedPalSurface` converted with `TextureColors`.
+ */
+bool TextureAheadOfOutputSurface = false;
+/** Palette of the frame in the renderer texture, in the pixel format of the texture. */
+uint32_t TextureColors[256];
+#endif
 } // namespace
 
 /** Whether we render directly to the screen surface, i.e. `PalSurface == GetOutputSurface()` */
@@ -61,21 +99,156 @@ bool CanRenderDirectlyToOutputSurface()
 #endif
 }
 
+void AddOutputDirtyRect(const SDL_Rect *rect)
+{
+	if (rect == nullptr) {
+		OutputFullyDirty = true;
+		return;
+	}
+	if (OutputDirtyRect.w == 0 || OutputDirtyRect.h == 0) {
+		OutputDirtyRect = *rect;
+		return;
+	}
+	const int left = std::min<int>(OutputDirtyRect.x, rect->x);
+	const int top = std::min<int>(OutputDirtyRect.y, rect->y);
+	const int right = std::max<int>(OutputDirtyRect.x + OutputDirtyRect.w, rect->x + rect->w);
+	const int bottom = std::max<int>(OutputDirtyRect.y + OutputDirtyRect.h, rect->y + rect->h);
+	using CoordType = decltype(SDL_Rect {}.x);
+	using SizeType = decltype(SDL_Rect {}.w);
+	OutputDirtyRect = { static_cast<CoordType>(left), static_cast<CoordType>(top), static_cast<SizeType>(right - left), static_cast<SizeType>(bottom - top) };
+}
+
+/**
+ * @brief Records the rows of `PalSurface` that were copied to the same position on the output surface
+ * @param rect Copied area, nullptr for the whole surface
+ */
+void RememberPresentedRows(const SDL_Rect *rect)
+{
+	if (PresentedPalSurface == nullptr)
+		return;
+
+	const int x = rect != nullptr ? std::max<int>(rect->x, 0) : 0;
+	const int y = rect != nullptr ? std::max<int>(rect->y, 0) : 0;
+	const int right = rect != nullptr ? std::min<int>(rect->x + rect->w, PalSurface->w) : PalSurface->w;
+	const int bottom = rect != nullptr ? std::min<int>(rect->y + rect->h, PalSurface->h) : PalSurface->h;
+	if (x >= right || y >= bottom)
+		return;
+
+	const auto *pixels = static_cast<const uint8_t *>(PalSurface->pixels);
+	const int pitch = PalSurface->pitch;
+	for (int row = y; row < bottom; row++)
+		memcpy(&PresentedPalSurface[row * pitch + x], &pixels[row * pitch + x], right - x);
+
+	if (x == 0 && y == 0 && right == PalSurface->w && bottom == PalSurface->h)
+		PresentedPalSurfaceStale = false;
+}
+
+#ifndef USE_SDL1
+/**
+ * @brief Converts the 8-bit pixels to the 32-bit output format with a palette lookup
+ */
+void ConvertRowsOnThisThread(const uint8_t *src, int srcPitch, uint8_t *dst, int dstPitch, int width, int height)
+{
+	for (int y = 0; y < height; y++, src += srcPitch, dst += dstPitch) {
+		auto *out = reinterpret_cast<uint32_t *>(dst);
+		for (int x = 0; x < width; x++)
+			out[x] = TextureColors[src[x]];
+	}
+}
+
+/**
+ * @brief Converts the 8-bit pixels to the 32-bit output format, split into bands over the render threads
+ *
+ * Only the conversion is spread over the threads, SDL requires the texture to be locked and presented on the main thread.
+ */
+void ConvertRows(const uint8_t *src, int srcPitch, uint8_t *dst, int dstPitch, int width, int height)
+{
+	ThreadPool *threads = GetRenderThreads();
+	if (threads == nullptr) {
+		ConvertRowsOnThisThread(src, srcPitch, dst, dstPitch, width, height);
+		return;
+	}
+	const int numBands = static_cast<int>(threads->concurrency());
+	const int bandHeight = (height + numBands - 1) / numBands;
+	threads->ParallelFor(numBands, [&](int band) {
+		const int top = band * bandHeight;
+		const int bandRows = std::min(bandHeight, height - top);
+		if (bandRows > 0)
+			ConvertRowsOnThisThread(src + top * srcPitch, srcPitch, dst + top * dstPitch, dstPitch, width, bandRows);
+	});
+}
+
+/**
+ * @brief Converts the whole of `PalSurface` straight into the renderer texture instead of going through the output surface
+ *
+ * This skips converting into the output surface and copying that into the texture, which is most of the cost of
+ * presenting the menus and palette fades that redraw the whole screen every frame.
+ *
+ * @return Whether the frame was converted, the caller needs to blit it the regular way otherwise
+ */
+bool ConvertPalSurfaceToTexture()
+{
+	const SDL_Surface *outputSurface = RendererTextureSurface.get();
+	if (renderer == nullptr || texture == nullptr || outputSurface == nullptr || outputSurface->format->BytesPerPixel != 4
+	    || outputSurface->w != PalSurface->w || outputSurface->h != PalSurface->h || PresentedPalSurface == nullptr)
+		return false;
+
+	// Videos are played on a texture of their own size.
+	int textureWidth;
+	int textureHeight;
+	if (SDL_QueryTexture(texture.get(), nullptr, nullptr, &textureWidth, &textureHeight) < 0 || textureWidth != PalSurface->w || textureHeight != PalSurface->h)
+		return false;
+
+	const SDL_Color *colors = Palette->colors;
+	for (int i = 0; i < 256; i++)
+		TextureColors[i] = SDL_MapRGB(outputSurface->format, colors[i].r, colors[i].g, colors[i].b);
+
+	void *pixels;
+	int pitch;
+	if (SDL_LockTexture(texture.get(), nullptr, &pixels, &pitch) < 0)
+		return false;
+	ConvertRows(static_cast<const uint8_t *>(PalSurface->pixels), PalSurface->pitch, static_cast<uint8_t *>(pixels), pitch, PalSurface->w, PalSurface->h);
+	SDL_UnlockTexture(texture.get());
+
+	RememberPresentedRows(nullptr);
+	TextureAheadOfOutputSurface = true;
+	// The texture is complete, whatever was written to the output surface before is overwritten.
+	OutputFullyDirty = false;
+	OutputDirtyRect = {};
+	return true;
+}
+#endif
+
 /**
  * @brief Limit FPS to avoid high CPU load, use when v-sync isn't available
+ *
+ * Frames are paced on a fixed grid of the refresh rate, so a frame that finishes early or a little late doesn't
+ * shift the ones after it. Most of the wait is slept, the last stretch is spun as SDL_Delay only has millisecond
+ * granularity and often overshoots.
  */
 void LimitFrameRate()
 {
 	if (!*sgOptions.Graphics.limitFPS)
 		return;
-	static uint32_t frameDeadline;
-	uint32_t tc = SDL_GetTicks() * 1000;
-	uint32_t v = 0;
-	if (frameDeadline > tc) {
-		v = tc % refreshDelay;
-		SDL_Delay(v / 1000 + 1); // ceil
+	using Clock = std::chrono::steady_clock;
+	constexpr std::chrono::microseconds SpinTime { 1000 };
+	static Clock::time_point frameDeadline;
+	const std::chrono::microseconds frameTime { refreshDelay };
+
+	Clock::time_point now = Clock::now();
+	if (now < frameDeadline) {
+		const Clock::duration remaining = frameDeadline - now;
+		if (remaining > SpinTime)
+			SDL_Delay(static_cast<Uint32>(std::chrono::duration_cast<std::chrono::milliseconds>(remaining - SpinTime).count()));
+		while (Clock::now() < frameDeadline) {
+		}
+		now = frameDeadline;
 	}
-	frameDeadline = tc + v + refreshDelay;
+	frameDeadline += frameTime;
+	// Start a new grid after missing a whole frame instead of rushing the next frames to catch up,
+	// this also covers the first frame and refresh rate changes.
+	if (frameDeadline <= now || frameDeadline - now > frameTime)
+		frameDeadline = now + frameTime;
 }
 
 } // namespace
@@ -106,7 +279,11 @@ void dx_cleanup()
 
 	PalSurface = nullptr;
 	PinnedPalSurface = nullptr;
+	PresentedPalSurface = nullptr;
 	Palette = nullptr;
+#ifndef USE_SDL1
+	TextureAheadOfOutputSurface = false;
+#endif
 	RendererTextureSurface = nullptr;
 #ifndef USE_SDL1
 	texture = nullptr;
@@ -130,7 +307,9 @@ void CreateBackBuffer()
 		    /*depth=*/8,
 		    SDL_PIXELFORMAT_INDEX8);
 		PalSurface = PinnedPalSurface.get();
+		PresentedPalSurface = std::make_unique<uint8_t[]>(static_cast<size_t>(PalSurface->pitch) * PalSurface->h);
 	}
+	InvalidateOutputSurface();
 
 #ifndef USE_SDL1
 	// In SDL2, `PalSurface` points to the global `palette`.
@@ -152,7 +331,65 @@ void BltFast(SDL_Rect *srcRect, SDL_Rect *dstRect)
 {
 	if (RenderDirectlyToOutputSurface)
 		return;
+#ifndef USE_SDL1
+	if (srcRect == nullptr && dstRect == nullptr && !HeadlessMode && ConvertPalSurfaceToTexture())
+		return;
+#endif
 	Blit(PalSurface, srcRect, dstRect);
+	if (srcRect == nullptr && dstRect == nullptr) {
+		RememberPresentedRows(nullptr);
+	} else if (srcRect != nullptr && dstRect != nullptr && srcRect->x == dstRect->x && srcRect->y == dstRect->y) {
+		RememberPresentedRows(srcRect);
+	} else {
+		PresentedPalSurfaceStale = true;
+	}
+}
+
+void BltFastIfChanged(SDL_Rect rect)
+{
+	if (RenderDirectlyToOutputSurface || HeadlessMode)
+		return;
+
+	if (PresentedPalSurface == nullptr || PresentedPalSurfaceStale) {
+		BltFast(&rect, &rect);
+		return;
+	}
+
+	const int x = std::max<int>(rect.x, 0);
+	const int width = std::min<int>(rect.x + rect.w, PalSurface->w) - x;
+	const int bottom = std::min<int>(rect.y + rect.h, PalSurface->h);
+	if (width <= 0)
+		return;
+
+	const auto *pixels = static_cast<const uint8_t *>(PalSurface->pixels);
+	const int pitch = PalSurface->pitch;
+	const auto showsChangedColor = [&](int row) {
+		const uint8_t *rowPixels = &pixels[row * pitch + x];
+		for (int i = 0; i < width; i++) {
+			if (ChangedPaletteColors[rowPixels[i]])
+				return true;
+		}
+		return false;
+	};
+	const auto isRowChanged = [&](int row) {
+		return memcmp(&pixels[row * pitch + x], &PresentedPalSurface[row * pitch + x], width) != 0
+		    || (AnyPaletteColorChanged && showsChangedColor(row));
+	};
+
+	using CoordType = decltype(SDL_Rect {}.x);
+	using SizeType = decltype(SDL_Rect {}.w);
+	int row = std::max<int>(rect.y, 0);
+	while (row < bottom) {
+		while (row < bottom && !isRowChanged(row))
+			row++;
+		const int firstChanged = row;
+		while (row < bottom && isRowChanged(row))
+			row++;
+		if (row == firstChanged)
+			break;
+		SDL_Rect changed { static_cast<CoordType>(x), static_cast<CoordType>(firstChanged), static_cast<SizeType>(width), static_cast<SizeType>(row - firstChanged) };
+		BltFast(&changed, &changed);
+	}
 }
 
 void Blit(SDL_Surface *src, SDL_Rect *srcRect, SDL_Rect *dstRect)
@@ -161,6 +398,9 @@ void Blit(SDL_Surface *src, SDL_Rect *srcRect, SDL_Rect *dstRect)
 		return;
 
 	SDL_Surface *dst = GetOutputSurface();
+	if (src != PalSurface)
+		PresentedPalSurfaceStale = true;
+	AddOutputDirtyRect(dstRect);
 #ifndef USE_SDL1
 	if (SDL_BlitSurface(src, srcRect, dst, dstRect) < 0)
 		ErrSdl();
@@ -213,17 +453,37 @@ void RenderPresent()
 	if (HeadlessMode)
 		return;
 
-	SDL_Surface *surface = GetOutputSurface();
+	FrameStageTimer frameStageTimer(FrameStage::RenderPresent);
 
 	if (!gbActive) {
 		LimitFrameRate();
 		return;
 	}
 
+	const bool outputFullyDirty = OutputFullyDirty;
+	const SDL_Rect outputDirtyRect = OutputDirtyRect;
+	OutputFullyDirty = false;
+	OutputDirtyRect = {};
+	if (AnyPaletteColorChanged) {
+		ChangedPaletteColors = {};
+		AnyPaletteColorChanged = false;
+	}
+
 #ifndef USE_SDL1
 	if (renderer != nullptr) {
-		if (SDL_UpdateTexture(texture.get(), nullptr, surface->pixels, surface->pitch) <= -1) { // pitch is 2560
-			ErrSdl();
+		// The texture keeps its contents between frames, so only the area that was written to needs to be uploaded.
+		// The output surface is only requested when needed, as that brings it up to date with the texture.
+		if (outputFullyDirty) {
+			SDL_Surface *surface = GetOutputSurface();
+			if (SDL_UpdateTexture(texture.get(), nullptr, surface->pixels, surface->pitch) <= -1) { // pitch is 2560
+				ErrSdl();
+			}
+		} else if (outputDirtyRect.w > 0 && outputDirtyRect.h > 0) {
+			SDL_Surface *surface = GetOutputSurface();
+			const auto *pixels = static_cast<const uint8_t *>(surface->pixels) + outputDirtyRect.y * surface->pitch + outputDirtyRect.x * surface->format->BytesPerPixel;
+			if (SDL_UpdateTexture(texture.get(), &outputDirtyRect, pixels, surface->pitch) <= -1) {
+				ErrSdl();
+			}
 		}
 
 		// Clear buffer to avoid artifacts in case the window was resized
@@ -246,8 +506,11 @@ void RenderPresent()
 			LimitFrameRate();
 		}
 	} else {
+		SDL_Surface *surface = GetOutputSurface();
 		if (ControlMode == ControlTypes::VirtualGamepad) {
 			RenderVirtualGamepad(surface);
+			// The gamepad is drawn over the output surface and has to be cleared by the next frame.
+			InvalidateOutputSurface();
 		}
 		if (SDL_UpdateWindowSurface(ghMainWnd) <= -1) {
 			ErrSdl();
@@ -255,13 +518,51 @@ void RenderPresent()
 		LimitFrameRate();
 	}
 #else
+	SDL_Surface *surface = GetOutputSurface();
 	if (SDL_Flip(surface) <= -1) {
 		ErrSdl();
 	}
+	// After a flip the output surface holds an older frame.
+	if (IsDoubleBuffered())
+		InvalidateOutputSurface();
 	if (RenderDirectlyToOutputSurface)
 		PalSurface = GetOutputSurface();
 	LimitFrameRate();
 #endif
+
+	if (InputLatencyEnabled)
+		MarkInputPresented();
+}
+
+#ifndef USE_SDL1
+void SyncOutputSurface()
+{
+	if (!TextureAheadOfOutputSurface)
+		return;
+	TextureAheadOfOutputSurface = false;
+
+	SDL_Surface *outputSurface = RendererTextureSurface.get();
+	if (outputSurface == nullptr || PresentedPalSurface == nullptr)
+		return;
+	// The surfaces are recreated one after the other when the window is resized, the frame is lost then anyway.
+	const int width = std::min(outputSurface->w, PalSurface->w);
+	const int height = std::min(outputSurface->h, PalSurface->h);
+	ConvertRows(PresentedPalSurface.get(), PalSurface->pitch, static_cast<uint8_t *>(outputSurface->pixels), outputSurface->pitch, width, height);
+}
+#endif
+
+void InvalidateOutputSurface()
+{
+	PresentedPalSurfaceStale = true;
+	OutputFullyDirty = true;
+}
+
+void MarkPaletteColorsChanged(int first, int ncolor)
+{
+	const int last = std::min(first + ncolor, 256);
+	for (int i = std::max(first, 0); i < last; i++)
+		ChangedPaletteColors[i] = true;
+	AnyPaletteColorChanged = true;
 }
 
 void PaletteGetEntries(int dwNumEntries, SDL_Color *lpEntries)
@@ -270,4 +571,23 @@ void PaletteGetEntries(int dwNumEntries, SDL_Color *lpEntries)
 		lpEntries[i] = system_palette[i];
 	}
 }
+
+ThreadPool *GetRenderThreads()
+{
+	const unsigned numThreads = std::max(*sgOptions.Graphics.renderThreads, 1);
+	if (numThreads == 1) {
+		RenderThreads = std::nullopt;
+		return nullptr;
+	}
+	if (!RenderThreads || RenderThreads->concurrency() != numThreads) {
+		RenderThreads = std::nullopt;
+		RenderThreads.emplace(numThreads - 1);
+	}
+	return &*RenderThreads;
+}
+
+void FreeRenderThreads()
+{
+	RenderThreads = std::nullopt;
+}
 } // namespace devilution
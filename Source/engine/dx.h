@@ -6,6 +6,7 @@
 #pragma once
 
 #include "engine.h"
+#include "utils/thread_pool.hpp"
 
 namespace devilution {
 
@@ -19,8 +20,47 @@ void dx_cleanup();
 void CreateBackBuffer();
 void InitPalette();
 void BltFast(SDL_Rect *srcRect, SDL_Rect *dstRect);
+
+/**
+ * @brief Copies an area of the back buffer to the same area of the output surface, skipping the rows that are unchanged since they were last copied.
+ */
+void BltFastIfChanged(SDL_Rect rect);
+
 void Blit(SDL_Surface *src, SDL_Rect *srcRect, SDL_Rect *dstRect);
+
+/**
+ * @brief Forgets what has been copied to the output surface, so that the next frame is copied and presented in full.
+ *
+ * Must be called after the output surface or renderer texture is recreated or written to other than by `Blit`.
+ */
+void InvalidateOutputSurface();
+
+#ifndef USE_SDL1
+/**
+ * @brief Brings the output surface up to date with the renderer texture, which full frames are converted into directly.
+ *
+ * Called by `GetOutputSurface`, so that whoever writes to or presents the output surface sees the current frame.
+ */
+void SyncOutputSurface();
+#endif
+
 void RenderPresent();
+
+/**
+ * @brief Tells the present path that the given palette colors changed, the rows showing them are copied again by `BltFastIfChanged`.
+ */
+void MarkPaletteColorsChanged(int first, int ncolor);
+
 void PaletteGetEntries(int dwNumEntries, SDL_Color *lpEntries);
 
+/**
+ * @brief Returns the threads that share the work of drawing and presenting a frame, or nullptr if the Render Threads option is 1
+ */
+ThreadPool *GetRenderThreads();
+
+/**
+ * @brief Stops the threads used for rendering, they are started again when needed
+ */
+void FreeRenderThreads();
+
 } // namespace devilution
@@ -0,0 +1,169 @@
+#include "engine/frame_timings.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include <fmt/format.h>
+
+namespace devilution {
+
+bool FrameTimingsEnabled = false;
+
+namespace {
+
+constexpr std::array<const char *, NumFrameStages> StageNames = {
+	"Input",
+	"Network",
+	"GameLogic",
+	"DrawView",
+	"DrawGame",
+	"RecordDungeon",
+	"ExecuteDungeon",
+	"RenderPresent",
+	"Audio",
+	"StateHash",
+};
+
+/** Whether the frames are recorded for the percentiles, see StartFrameTimings. */
+bool RecordingFrames;
+/** Number of users of GetLastFrameTimings, see SetLastFrameTimingsEnabled. */
+int LastFrameTimingsUsers;
+
+/** Microseconds spent in each stage during the current frame. */
+FrameStageTimes CurrentFrame;
+/** Microseconds spent in each stage during the previous frame. */
+FrameStageTimes LastFrame;
+/** Heap allocations made in each stage during the current frame. */
+std::array<uint32_t, NumFrameStages> CurrentFrameAllocations;
+bool CurrentFrameHasData;
+
+/** Microseconds spent in each stage, one entry per recorded frame. */
+std::array<std::vector<uint32_t>, NumFrameStages> RecordedFrames;
+/** Heap allocations made in each stage, one entry per recorded frame. */
+std::array<std::vector<uint32_t>, NumFrameStages> RecordedAllocations;
+
+/**
+ * @brief Returns the value at the given percentile using the nearest-rank method.
+ * @param sorted Samples in ascending order, must not be empty.
+ */
+uint32_t Percentile(const std::vector<uint32_t> &sorted, unsigned percent)
+{
+	size_t rank = (sorted.size() * percent + 99) / 100;
+	return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+} // namespace
+
+uint64_t FrameStageTimer::Now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FrameStageTimer::~FrameStageTimer()
+{
+	if (!FrameTimingsEnabled || start_ == 0)
+		return;
+	CurrentFrame[static_cast<size_t>(stage_)] += static_cast<uint32_t>(Now() - start_);
+	CurrentFrameAllocations[static_cast<size_t>(stage_)] += static_cast<uint32_t>(GetThreadAllocationCount() - allocations_);
+	CurrentFrameHasData = true;
+}
+
+void StartFrameTimings()
+{
+	for (auto &samples : RecordedFrames)
+		samples.clear();
+	for (auto &samples : RecordedAllocations)
+		samples.clear();
+	CurrentFrame = {};
+	CurrentFrameAllocations = {};
+	CurrentFrameHasData = false;
+	RecordingFrames = true;
+	FrameTimingsEnabled = true;
+}
+
+void StopFrameTimings()
+{
+	RecordingFrames = false;
+	FrameTimingsEnabled = LastFrameTimingsUsers != 0;
+}
+
+void SetLastFrameTimingsEnabled(bool enabled)
+{
+	LastFrameTimingsUsers += enabled ? 1 : -1;
+	FrameTimingsEnabled = RecordingFrames || LastFrameTimingsUsers != 0;
+	if (LastFrameTimingsUsers == 0 || (enabled && LastFrameTimingsUsers == 1))
+		LastFrame = {};
+}
+
+const FrameStageTimes &GetLastFrameTimings()
+{
+	return LastFrame;
+}
+
+void FinishFrameTimings()
+{
+	if (!FrameTimingsEnabled)
+		return;
+	LastFrame = CurrentFrame;
+	if (!RecordingFrames || !CurrentFrameHasData) {
+		CurrentFrame = {};
+		CurrentFrameAllocations = {};
+		CurrentFrameHasData = false;
+		return;
+	}
+	for (size_t i = 0; i < NumFrameStages; i++) {
+		RecordedFrames[i].push_back(CurrentFrame[i]);
+		RecordedAllocations[i].push_back(CurrentFrameAllocations[i]);
+	}
+	CurrentFrame = {};
+	CurrentFrameAllocations = {};
+	CurrentFrameHasData = false;
+}
+
+size_t GetNumTimedFrames()
+{
+	return RecordedFrames[0].size();
+}
+
+const char *GetFrameStageName(FrameStage stage)
+{
+	return StageNames[static_cast<size_t>(stage)];
+}
+
+std::optional<FrameStagePercentiles> GetFrameStagePercentiles(FrameStage stage)
+{
+	std::vector<uint32_t> sorted = RecordedFrames[static_cast<size_t>(stage)];
+	if (sorted.empty())
+		return std::nullopt;
+	std::sort(sorted.begin(), sorted.end());
+	return FrameStagePercentiles { Percentile(sorted, 50), Percentile(sorted, 95), Percentile(sorted, 99), sorted.back() };
+}
+
+std::string FrameTimingsToJson()
+{
+	std::string out = fmt::format("{{\"frames\":{},\"stages\":{{", GetNumTimedFrames());
+	for (size_t i = 0; i < NumFrameStages; i++) {
+		const auto stage = static_cast<FrameStage>(i);
+		const std::optional<FrameStagePercentiles> percentiles = GetFrameStagePercentiles(stage);
+		if (i != 0)
+			out += ',';
+		if (!percentiles) {
+			out += fmt::format("\"{}\":null", GetFrameStageName(stage));
+			continue;
+		}
+		out += fmt::format("\"{}\":{{\"median_us\":{},\"p95_us\":{},\"p99_us\":{},\"max_us\":{}",
+		    GetFrameStageName(stage), percentiles->medianUs, percentiles->p95Us, percentiles->p99Us, percentiles->maxUs);
+		if (AllocationTrackingEnabled) {
+			std::vector<uint32_t> allocations = RecordedAllocations[i];
+			std::sort(allocations.begin(), allocations.end());
+			out += fmt::format(",\"median_allocs\":{},\"max_allocs\":{}", Percentile(allocations, 50), allocations.back());
+		}
+		out += '}';
+	}
+	out += "}}";
+	return out;
+}
+
+} // namespace devilution
@@ -0,0 +1,128 @@
+/**
+ * @file frame_timings.hpp
+ *
+ * Interface of the per-frame stage timing collector used by the benchmark target.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "utils/allocation_tracking.hpp"
+#include "utils/stdcompat/optional.hpp"
+
+namespace devilution {
+
+/**
+ * @brief The stages of a frame that are timed.
+ *
+ * Stages may nest (DrawView contains DrawGame), so their times are inclusive.
+ */
+enum class FrameStage : uint8_t {
+	/** @brief Handling window messages and the cursor. */
+	Input,
+	Network,
+	GameLogic,
+	DrawView,
+	DrawGame,
+	/** @brief Part of DrawGame: working out which tiles and sprites to draw. */
+	RecordDungeon,
+	/** @brief Part of DrawGame: drawing the tiles and sprites. */
+	ExecuteDungeon,
+	RenderPresent,
+	Audio,
+	/** @brief Hashing the game state after each tick of a demo, see demo::NotifyGameLogicEnd. */
+	StateHash,
+
+	LAST = StateHash
+};
+
+constexpr size_t NumFrameStages = static_cast<size_t>(FrameStage::LAST) + 1;
+
+/** @brief Microseconds spent in each stage of a frame, indexed by FrameStage. */
+using FrameStageTimes = std::array<uint32_t, NumFrameStages>;
+
+/** Whether stage timings are being collected. Always check this before reading the clock. */
+extern bool FrameTimingsEnabled;
+
+/**
+ * @brief Starts collecting stage timings, discarding anything collected so far.
+ */
+void StartFrameTimings();
+
+/**
+ * @brief Stops collecting stage timings. The collected frames are kept until the next `StartFrameTimings`.
+ */
+void StopFrameTimings();
+
+/**
+ * @brief Closes the current frame and stores the time spent in each stage since the previous call.
+ *
+ * Frames in which no stage was entered are not recorded.
+ */
+void FinishFrameTimings();
+
+/**
+ * @brief Keeps the stages timed outside of `StartFrameTimings`/`StopFrameTimings`, without recording the frames.
+ *
+ * Used by the flight recorder and the debug overlay, which only need `GetLastFrameTimings`. Every call with true has
+ * to be matched by one with false, the stages are timed while there is at least one user.
+ */
+void SetLastFrameTimingsEnabled(bool enabled);
+
+/** @brief The stage times of the frame closed by the last `FinishFrameTimings`, all zero if nothing was timed. */
+const FrameStageTimes &GetLastFrameTimings();
+
+/** @brief Number of frames recorded since `StartFrameTimings`. */
+size_t GetNumTimedFrames();
+
+struct FrameStagePercentiles {
+	uint32_t medianUs;
+	uint32_t p95Us;
+	uint32_t p99Us;
+	uint32_t maxUs;
+};
+
+const char *GetFrameStageName(FrameStage stage);
+
+/**
+ * @brief Returns the percentiles of the time spent in the given stage over the recorded frames.
+ * @return The percentiles or nullopt if no frames were recorded
+ */
+std::optional<FrameStagePercentiles> GetFrameStagePercentiles(FrameStage stage);
+
+/**
+ * @brief Formats the recorded frames as a JSON object with the median, p95, p99 and max time of each stage in microseconds.
+ *
+ * When built with DEVILUTIONX_ALLOCATION_TRACKING, the median and max number of heap allocations of each stage are included too.
+ */
+std::string FrameTimingsToJson();
+
+/**
+ * @brief Adds the time spent in its own scope to the given stage of the current frame.
+ */
+class FrameStageTimer {
+public:
+	explicit FrameStageTimer(FrameStage stage)
+	    : stage_(stage)
+	    , start_(FrameTimingsEnabled ? Now() : 0)
+	    , allocations_(FrameTimingsEnabled ? GetThreadAllocationCount() : 0)
+	{
+	}
+
+	~FrameStageTimer();
+
+	FrameStageTimer(const FrameStageTimer &) = delete;
+	FrameStageTimer &operator=(const FrameStageTimer &) = delete;
+
+private:
+	static uint64_t Now();
+
+	FrameStage stage_;
+	uint64_t start_;
+	uint64_t allocations_;
+};
+
+} // namespace devilution
@@ -0,0 +1,202 @@
+#include "engine/input_latency.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+#include "utils/static_vector.hpp"
+#include "utils/stdcompat/optional.hpp"
+
+namespace devilution {
+
+bool InputLatencyEnabled = false;
+
+namespace {
+
+constexpr std::array<const char *, NumInputLatencyTypes> TypeNames = {
+	"keyboard",
+	"mouse_button",
+	"mouse_motion",
+	"controller",
+	"touch",
+};
+
+constexpr std::array<const char *, NumInputLatencyStages> StageNames = {
+	"handled",
+	"ticked",
+	"presented",
+};
+
+constexpr uint32_t HistogramBucketUs = 4000;
+constexpr size_t NumHistogramBuckets = 32;
+
+/**
+ * @brief Inputs waiting for the frame that reflects them. Mouse motion comes in bursts, so once this is full the
+ * inputs of the current frame are no longer sampled.
+ */
+constexpr size_t MaxPendingInputs = 64;
+
+struct PendingInput {
+	InputLatencyType type;
+	bool handled;
+	bool ticked;
+	uint64_t receivedUs;
+};
+
+StaticVector<PendingInput, MaxPendingInputs> PendingInputs;
+/** @brief Whether the last received event got an entry, MarkInputHandled applies to it. */
+bool LastInputPending;
+
+/** Microseconds from receiving each input to each stage, per input type. */
+std::array<std::array<std::vector<uint32_t>, NumInputLatencyStages>, NumInputLatencyTypes> Samples;
+
+uint64_t Now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::optional<InputLatencyType> GetInputLatencyType(const SDL_Event &event)
+{
+	switch (event.type) {
+	case SDL_KEYDOWN:
+	case SDL_KEYUP:
+		return InputLatencyType::Keyboard;
+	case SDL_MOUSEBUTTONDOWN:
+	case SDL_MOUSEBUTTONUP:
+#ifndef USE_SDL1
+	case SDL_MOUSEWHEEL:
+#endif
+		return InputLatencyType::MouseButton;
+	case SDL_MOUSEMOTION:
+		return InputLatencyType::MouseMotion;
+	case SDL_JOYAXISMOTION:
+	case SDL_JOYHATMOTION:
+	case SDL_JOYBUTTONDOWN:
+	case SDL_JOYBUTTONUP:
+#ifndef USE_SDL1
+	case SDL_CONTROLLERAXISMOTION:
+	case SDL_CONTROLLERBUTTONDOWN:
+	case SDL_CONTROLLERBUTTONUP:
+#endif
+		return InputLatencyType::Controller;
+#ifndef USE_SDL1
+	case SDL_FINGERDOWN:
+	case SDL_FINGERUP:
+	case SDL_FINGERMOTION:
+		return InputLatencyType::Touch;
+#endif
+	default:
+		return std::nullopt;
+	}
+}
+
+void AddSample(const PendingInput &input, InputLatencyStage stage, uint64_t now)
+{
+	Samples[static_cast<size_t>(input.type)][static_cast<size_t>(stage)].push_back(static_cast<uint32_t>(now - input.receivedUs));
+}
+
+/**
+ * @brief Returns the value at the given percentile using the nearest-rank method.
+ * @param sorted Samples in ascending order, must not be empty.
+ */
+uint32_t Percentile(const std::vector<uint32_t> &sorted, unsigned percent)
+{
+	size_t rank = (sorted.size() * percent + 99) / 100;
+	return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+} // namespace
+
+void StartInputLatency()
+{
+	for (auto &type : Samples) {
+		for (auto &samples : type)
+			samples.clear();
+	}
+	PendingInputs.clear();
+	LastInputPending = false;
+	InputLatencyEnabled = true;
+}
+
+void MarkInputReceived(const SDL_Event &event)
+{
+	LastInputPending = false;
+	const std::optional<InputLatencyType> type = GetInputLatencyType(event);
+	if (!type || PendingInputs.size() == MaxPendingInputs)
+		return;
+	PendingInputs.emplace_back(PendingInput { *type, false, false, Now() });
+	LastInputPending = true;
+}
+
+void MarkInputHandled()
+{
+	if (!LastInputPending)
+		return;
+	LastInputPending = false;
+	PendingInput &input = PendingInputs.back();
+	input.handled = true;
+	AddSample(input, InputLatencyStage::Handled, Now());
+}
+
+void MarkInputTicked()
+{
+	const uint64_t now = Now();
+	for (PendingInput &input : PendingInputs) {
+		if (!input.handled || input.ticked)
+			continue;
+		input.ticked = true;
+		AddSample(input, InputLatencyStage::Ticked, now);
+	}
+}
+
+void MarkInputPresented()
+{
+	const uint64_t now = Now();
+	size_t kept = 0;
+	for (size_t i = 0; i < PendingInputs.size(); i++) {
+		const PendingInput input = PendingInputs[i];
+		if (input.ticked) {
+			AddSample(input, InputLatencyStage::Presented, now);
+		} else if (input.handled || (LastInputPending && i + 1 == PendingInputs.size())) {
+			PendingInputs[kept++] = input;
+		}
+		// Messages that were never handled, e.g. because a menu loop fetched them, don't reach the game.
+	}
+	while (PendingInputs.size() > kept)
+		PendingInputs.pop_back();
+}
+
+std::string InputLatencyToJson()
+{
+	std::string out = "{";
+	for (size_t type = 0; type < NumInputLatencyTypes; type++) {
+		if (type != 0)
+			out += ',';
+		out += fmt::format("\"{}\":{{", TypeNames[type]);
+		for (size_t stage = 0; stage < NumInputLatencyStages; stage++) {
+			if (stage != 0)
+				out += ',';
+			std::vector<uint32_t> sorted = Samples[type][stage];
+			if (sorted.empty()) {
+				out += fmt::format("\"{}\":null", StageNames[stage]);
+				continue;
+			}
+			std::sort(sorted.begin(), sorted.end());
+			std::array<uint32_t, NumHistogramBuckets> histogram {};
+			for (uint32_t sample : sorted)
+				histogram[std::min<size_t>(sample / HistogramBucketUs, NumHistogramBuckets - 1)]++;
+			out += fmt::format("\"{}\":{{\"samples\":{},\"median_us\":{},\"p95_us\":{},\"p99_us\":{},\"max_us\":{},\"histogram_4ms\":[{}]}}",
+			    StageNames[stage], sorted.size(), Percentile(sorted, 50), Percentile(sorted, 95), Percentile(sorted, 99), sorted.back(),
+			    fmt::join(histogram, ","));
+		}
+		out += '}';
+	}
+	out += '}';
+	return out;
+}
+
+} // namespace devilution
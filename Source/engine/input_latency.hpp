@@ -0,0 +1,69 @@
+/**
+ * @file input_latency.hpp
+ *
+ * Interface of the input-to-photon latency measurement, enabled with --latency.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <SDL.h>
+
+namespace devilution {
+
+enum class InputLatencyType : uint8_t {
+	Keyboard,
+	MouseButton,
+	MouseMotion,
+	Controller,
+	Touch,
+
+	LAST = Touch
+};
+
+constexpr size_t NumInputLatencyTypes = static_cast<size_t>(InputLatencyType::LAST) + 1;
+
+/**
+ * @brief The points an input passes on its way to the screen, each one is measured from the time it was received.
+ */
+enum class InputLatencyStage : uint8_t {
+	/** @brief The message was passed to the event handler. */
+	Handled,
+	/** @brief The first game tick after the message was handled started. */
+	Ticked,
+	/** @brief The first frame drawn after that tick was presented. */
+	Presented,
+
+	LAST = Presented
+};
+
+constexpr size_t NumInputLatencyStages = static_cast<size_t>(InputLatencyStage::LAST) + 1;
+
+/** Whether input latencies are being measured. Always check this before calling the other functions. */
+extern bool InputLatencyEnabled;
+
+void StartInputLatency();
+
+/**
+ * @brief Stamps an SDL event that FetchMessage received, events that aren't input are ignored.
+ */
+void MarkInputReceived(const SDL_Event &event);
+
+/** @brief Called once the message of the last received event has been passed to the event handler. */
+void MarkInputHandled();
+
+/** @brief Called at the start of every game tick. */
+void MarkInputTicked();
+
+/** @brief Called after a frame was presented, completes the inputs that the frame reflects. */
+void MarkInputPresented();
+
+/**
+ * @brief Formats the measured latencies as JSON: per input type and stage, the number of samples, the median, p95,
+ * p99 and max in microseconds and a histogram of 4 ms buckets, the last bucket collecting everything slower.
+ */
+std::string InputLatencyToJson();
+
+} // namespace devilution
@@ -1,5 +1,8 @@
 #include "engine/load_cel.hpp"
 
+#include <algorithm>
+#include <string>
+
 #ifdef DEBUG_CEL_TO_CL2_SIZE
 #include <iostream>
 #endif
@@ -8,26 +11,82 @@
 #include "utils/cel_to_cl2.hpp"
 #include "utils/pointer_value_union.hpp"
 
+#ifdef DEVILUTIONX_CL2_CACHE
+#include "engine/cl2_cache.hpp"
+#include "utils/endian.hpp"
+#include "utils/str_cat.hpp"
+#endif
+
 namespace devilution {
 
-OwnedCelSprite LoadCelAsCl2(const char *pszName, uint16_t width)
+namespace {
+
+#ifdef DEVILUTIONX_CL2_CACHE
+/**
+ * @brief Returns the number of frame widths CelToCl2 reads, i.e. the number of frames in the largest group.
+ */
+uint32_t GetNumFrameWidths(const uint8_t *data, size_t size)
 {
-	size_t size;
-	std::unique_ptr<uint8_t[]> data = LoadFileInMem<uint8_t>(pszName, &size);
-#ifdef DEBUG_CEL_TO_CL2_SIZE
-	std::cout << pszName;
-#endif
-	return CelToCl2(data.get(), size, PointerOrValue<uint16_t> { width });
+	const uint32_t maybeNumFrames = LoadLE32(data);
+	if (LoadLE32(&data[maybeNumFrames * 4 + 4]) == size)
+		return maybeNumFrames;
+	uint32_t numFrames = 0;
+	for (uint32_t group = 0; group < maybeNumFrames / 4; ++group)
+		numFrames = std::max(numFrames, LoadLE32(&data[LoadLE32(&data[4 * group])]));
+	return numFrames;
 }
 
-OwnedCelSprite LoadCelAsCl2(const char *pszName, const uint16_t *widths)
+std::string SerializeWidths(const uint16_t *widths, uint32_t numWidths)
 {
+	std::string result(2 * static_cast<size_t>(numWidths), '\0');
+	for (uint32_t i = 0; i < numWidths; ++i)
+		WriteLE16(&result[2 * i], widths[i]);
+	return result;
+}
+#endif
+
+OwnedCelSprite LoadCelAsCl2(const char *pszName, PointerOrValue<uint16_t> widthOrWidths, size_t *outSize)
+{
+#ifdef DEVILUTIONX_CL2_CACHE
+	// A fixed width is part of the key. Varying widths are stored in the entry instead, because their count is only known from the CEL file.
+	const std::string parameters = widthOrWidths.HoldsPointer() ? std::string("widths") : StrCat("width=", widthOrWidths.AsValue());
+	if (std::optional<Cl2CacheEntry> entry = LoadFromCl2Cache(pszName, parameters)) {
+		if (!widthOrWidths.HoldsPointer() || entry->metadata == SerializeWidths(widthOrWidths.AsPointer(), entry->metadata.size() / 2)) {
+			if (outSize != nullptr)
+				*outSize = entry->size;
+			return OwnedCelSprite { std::move(entry->data), widthOrWidths };
+		}
+	}
+#endif
+
 	size_t size;
 	std::unique_ptr<uint8_t[]> data = LoadFileInMem<uint8_t>(pszName, &size);
 #ifdef DEBUG_CEL_TO_CL2_SIZE
 	std::cout << pszName;
 #endif
-	return CelToCl2(data.get(), size, PointerOrValue<uint16_t> { widths });
+#ifdef DEVILUTIONX_CL2_CACHE
+	size_t cl2Size;
+	OwnedCelSprite result = CelToCl2(data.get(), size, widthOrWidths, &cl2Size, GetAssetLoadingThreads());
+	const std::string metadata = widthOrWidths.HoldsPointer() ? SerializeWidths(widthOrWidths.AsPointer(), GetNumFrameWidths(data.get(), size)) : std::string();
+	StoreInCl2Cache(pszName, parameters, CelSprite { result }.Data(), cl2Size, metadata);
+	if (outSize != nullptr)
+		*outSize = cl2Size;
+	return result;
+#else
+	return CelToCl2(data.get(), size, widthOrWidths, outSize, GetAssetLoadingThreads());
+#endif
+}
+
+} // namespace
+
+OwnedCelSprite LoadCelAsCl2(const char *pszName, uint16_t width, size_t *outSize)
+{
+	return LoadCelAsCl2(pszName, PointerOrValue<uint16_t> { width }, outSize);
+}
+
+OwnedCelSprite LoadCelAsCl2(const char *pszName, const uint16_t *widths, size_t *outSize)
+{
+	return LoadCelAsCl2(pszName, PointerOrValue<uint16_t> { widths }, outSize);
 }
 
 } // namespace devilution
@@ -1,12 +1,17 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 #include "engine/cel_sprite.hpp"
 
 namespace devilution {
 
-OwnedCelSprite LoadCelAsCl2(const char *pszName, uint16_t width);
-OwnedCelSprite LoadCelAsCl2(const char *pszName, const uint16_t *widths);
+/**
+ * @brief Loads a CEL file and converts it to CL2.
+ * @param outSize If not null, receives the size of the CL2 data
+ */
+OwnedCelSprite LoadCelAsCl2(const char *pszName, uint16_t width, size_t *outSize = nullptr);
+OwnedCelSprite LoadCelAsCl2(const char *pszName, const uint16_t *widths, size_t *outSize = nullptr);
 
 } // namespace devilution
@@ -0,0 +1,30 @@
+#include "engine/load_file.hpp"
+
+#include <algorithm>
+
+#include <SDL.h>
+
+#include "utils/stdcompat/optional.hpp"
+
+namespace devilution {
+
+namespace {
+
+/** @brief Reading is mostly bound by storage and decompression, more threads than this don't help. */
+constexpr int MaxAssetLoadingThreads = 4;
+
+std::optional<ThreadPool> AssetLoadingThreads;
+
+} // namespace
+
+ThreadPool *GetAssetLoadingThreads()
+{
+	const int numThreads = std::min(SDL_GetCPUCount(), MaxAssetLoadingThreads);
+	if (numThreads <= 1)
+		return nullptr;
+	if (!AssetLoadingThreads)
+		AssetLoadingThreads.emplace(numThreads - 1);
+	return &*AssetLoadingThreads;
+}
+
+} // namespace devilution
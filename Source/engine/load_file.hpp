@@ -1,26 +1,34 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <type_traits>
 
 #include <fmt/core.h>
 
 #include "appfat.h"
 #include "diablo.h"
+#include "engine/asset_prefetch.hpp"
 #include "engine/assets.hpp"
 #include "utils/static_vector.hpp"
 #include "utils/stdcompat/cstddef.hpp"
 #include "utils/str_cat.hpp"
+#include "utils/thread_pool.hpp"
 
 namespace devilution {
 
 class SFile {
 public:
-	explicit SFile(const char *path)
+	/**
+	 * @param threadsafe Whether the file is going to be read on a different thread, see OpenAsset.
+	 */
+	explicit SFile(const char *path, bool threadsafe = false)
 	{
-		handle_ = OpenAsset(path);
+		handle_ = OpenAsset(path, threadsafe);
 		if (handle_ == nullptr) {
 			if (!HeadlessMode) {
 				app_fatal(StrCat("Failed to open file:\n", path, "\n\n", SDL_GetError()));
@@ -56,6 +64,14 @@ private:
 template <typename T>
 void LoadFileInMem(const char *path, T *data)
 {
+	std::size_t prefetchedSize;
+	if (std::unique_ptr<byte[]> prefetched = TakePrefetchedAsset(path, prefetchedSize)) {
+		if ((prefetchedSize % sizeof(T)) != 0)
+			app_fatal(StrCat("File size does not align with type\n", path));
+		std::memcpy(data, prefetched.get(), prefetchedSize);
+		return;
+	}
+
 	SFile file { path };
 	if (!file.Ok())
 		return;
@@ -68,6 +84,12 @@ void LoadFileInMem(const char *path, T *data)
 template <typename T>
 void LoadFileInMem(const char *path, T *data, std::size_t count)
 {
+	std::size_t prefetchedSize;
+	if (std::unique_ptr<byte[]> prefetched = TakePrefetchedAsset(path, prefetchedSize)) {
+		std::memcpy(data, prefetched.get(), std::min(prefetchedSize, count * sizeof(T)));
+		return;
+	}
+
 	SFile file { path };
 	if (!file.Ok())
 		return;
@@ -89,6 +111,19 @@ void LoadFileInMem(const char *path, std::array<T, N> &data)
 template <typename T = byte>
 std::unique_ptr<T[]> LoadFileInMem(const char *path, std::size_t *numRead = nullptr)
 {
+	std::size_t prefetchedSize;
+	if (std::unique_ptr<byte[]> prefetched = TakePrefetchedAsset(path, prefetchedSize)) {
+		if ((prefetchedSize % sizeof(T)) != 0)
+			app_fatal(StrCat("File size does not align with type\n", path));
+		if (numRead != nullptr)
+			*numRead = prefetchedSize / sizeof(T);
+		if constexpr (std::is_same<T, byte>::value)
+			return prefetched;
+		std::unique_ptr<T[]> buf { new T[prefetchedSize / sizeof(T)] };
+		std::memcpy(buf.get(), prefetched.get(), prefetchedSize);
+		return buf;
+	}
+
 	SFile file { path };
 	if (!file.Ok())
 		return nullptr;
@@ -104,6 +139,11 @@ std::unique_ptr<T[]> LoadFileInMem(const char *path, std::size_t *numRead = null
 	return buf;
 }
 
+/**
+ * @brief Returns the threads that help reading assets, or nullptr if there is only one CPU core.
+ */
+ThreadPool *GetAssetLoadingThreads();
+
 /**
  * @brief Reads multiple files into a single buffer
  *
@@ -111,6 +151,20 @@ std::unique_ptr<T[]> LoadFileInMem(const char *path, std::size_t *numRead = null
  */
 template <size_t MaxFiles>
 struct MultiFileLoader {
+	MultiFileLoader() = default;
+
+	/**
+	 * @brief Creates a loader that reads and decompresses the files in parallel.
+	 *
+	 * Each file is read through its own clone of the MPQ archive.
+	 *
+	 * @param threads Threads to read the files on, nullptr to read them on the calling thread only.
+	 */
+	explicit MultiFileLoader(ThreadPool *threads)
+	    : threads_(threads)
+	{
+	}
+
 	struct DefaultFilterFn {
 		bool operator()(size_t i) const
 		{
@@ -123,11 +177,12 @@ struct MultiFileLoader {
 	 * @param pathFn a function that returns the path for the given index
 	 * @param outOffsets a buffer index for the start of each file will be written here
 	 * @param filterFn a function that returns whether to load a file for the given index
+	 * @param outTotalSize if not nullptr, the size of the buffer will be written here
 	 * @return std::unique_ptr<byte[]> the buffer with all the files
 	 */
 	template <typename PathFn, typename FilterFn = DefaultFilterFn>
 	[[nodiscard]] std::unique_ptr<byte[]> operator()(size_t numFiles, PathFn &&pathFn, uint32_t *outOffsets,
-	    FilterFn filterFn = DefaultFilterFn {})
+	    FilterFn filterFn = DefaultFilterFn {}, size_t *outTotalSize = nullptr)
 	{
 		StaticVector<SFile, MaxFiles> files;
 		StaticVector<uint32_t, MaxFiles> sizes;
@@ -135,21 +190,33 @@ struct MultiFileLoader {
 		for (size_t i = 0; i < numFiles; ++i) {
 			if (!filterFn(i))
 				continue;
-			const size_t size = files.emplace_back(pathFn(i)).Size();
+			const size_t size = files.emplace_back(pathFn(i), /*threadsafe=*/threads_ != nullptr).Size();
 			sizes.emplace_back(static_cast<uint32_t>(size));
 			outOffsets[i] = static_cast<uint32_t>(totalSize);
 			totalSize += size;
 		}
 		std::unique_ptr<byte[]> buf { new byte[totalSize] };
-		size_t j = 0;
+		if (outTotalSize != nullptr)
+			*outTotalSize = totalSize;
+		StaticVector<uint32_t, MaxFiles> bufferOffsets;
 		for (size_t i = 0; i < numFiles; ++i) {
-			if (!filterFn(i))
-				continue;
-			files[j].Read(&buf[outOffsets[i]], sizes[j]);
-			++j;
+			if (filterFn(i))
+				bufferOffsets.emplace_back(outOffsets[i]);
+		}
+		const auto readFile = [&](int j) {
+			files[j].Read(&buf[bufferOffsets[j]], sizes[j]);
+		};
+		if (threads_ != nullptr) {
+			threads_->ParallelFor(static_cast<int>(files.size()), readFile);
+		} else {
+			for (size_t j = 0; j < files.size(); ++j)
+				readFile(static_cast<int>(j));
 		}
 		return buf;
 	}
+
+private:
+	ThreadPool *threads_ = nullptr;
 };
 
 } // namespace devilution
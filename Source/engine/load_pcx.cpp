@@ -15,6 +15,14 @@
 #include "utils/pcx.hpp"
 #include "utils/pcx_to_cl2.hpp"
 
+#ifdef DEVILUTIONX_CL2_CACHE
+#include <string>
+
+#include "engine/cl2_cache.hpp"
+#include "utils/endian.hpp"
+#include "utils/str_cat.hpp"
+#endif
+
 #ifdef USE_SDL1
 #include "utils/sdl2_to_1_2_backports.h"
 #endif
@@ -22,8 +30,66 @@
 namespace devilution {
 
 namespace {
+
+#ifdef DEVILUTIONX_CL2_CACHE
+// Metadata: width and frame height, followed by the RGB palette if it was requested.
+constexpr size_t PcxMetadataSize = 4;
+constexpr size_t PcxPaletteSize = 256 * 3;
+
+std::string GetPcxCacheParameters(int numFramesOrFrameHeight, std::optional<uint8_t> transparentColor, bool withPalette)
+{
+	return StrCat(numFramesOrFrameHeight, ",", transparentColor ? static_cast<int>(*transparentColor) : -1, withPalette ? ",palette" : "");
+}
+
+std::optional<OwnedCelSpriteWithFrameHeight> LoadPcxSpriteFromCache(const std::string &parameters, const char *filename, SDL_Color *outPalette)
+{
+	std::optional<Cl2CacheEntry> entry = LoadFromCl2Cache(filename, parameters);
+	if (!entry || entry->metadata.size() != PcxMetadataSize + (outPalette != nullptr ? PcxPaletteSize : 0))
+		return std::nullopt;
+
+	const char *metadata = entry->metadata.data();
+	if (outPalette != nullptr) {
+		const char *rgb = &metadata[PcxMetadataSize];
+		for (unsigned i = 0; i < 256; ++i) {
+			outPalette[i].r = static_cast<uint8_t>(*rgb++);
+			outPalette[i].g = static_cast<uint8_t>(*rgb++);
+			outPalette[i].b = static_cast<uint8_t>(*rgb++);
+#ifndef USE_SDL1
+			outPalette[i].a = SDL_ALPHA_OPAQUE;
+#endif
+		}
+	}
+	return OwnedCelSpriteWithFrameHeight {
+		OwnedCelSprite { std::move(entry->data), LoadLE16(&metadata[0]) },
+		LoadLE16(&metadata[2])
+	};
+}
+
+void StorePcxSpriteInCache(const std::string &parameters, const char *filename, const OwnedCelSpriteWithFrameHeight &sprite, size_t size, const SDL_Color *palette)
+{
+	const CelSprite celSprite { sprite.ownedSprite };
+	std::string metadata(PcxMetadataSize, '\0');
+	WriteLE16(&metadata[0], celSprite.Width());
+	WriteLE16(&metadata[2], sprite.frameHeight);
+	if (palette != nullptr) {
+		for (unsigned i = 0; i < 256; ++i) {
+			metadata += static_cast<char>(palette[i].r);
+			metadata += static_cast<char>(palette[i].g);
+			metadata += static_cast<char>(palette[i].b);
+		}
+	}
+	StoreInCl2Cache(filename, parameters, celSprite.Data(), size, metadata);
+}
+#endif
+
 std::optional<OwnedCelSpriteWithFrameHeight> LoadPcxSpriteAsCl2(const char *filename, int numFramesOrFrameHeight, std::optional<uint8_t> transparentColor, SDL_Color *outPalette)
 {
+#ifdef DEVILUTIONX_CL2_CACHE
+	const std::string parameters = GetPcxCacheParameters(numFramesOrFrameHeight, transparentColor, outPalette != nullptr);
+	if (std::optional<OwnedCelSpriteWithFrameHeight> cached = LoadPcxSpriteFromCache(parameters, filename, outPalette))
+		return cached;
+#endif
+
 	SDL_RWops *handle = OpenAsset(filename);
 	if (handle == nullptr) {
 		LogError("Missing file: {}", filename);
@@ -32,10 +98,19 @@ std::optional<OwnedCelSpriteWithFrameHeight> LoadPcxSpriteAsCl2(const char *file
 #ifdef DEBUG_PCX_TO_CL2_SIZE
 	std::cout << filename;
 #endif
+#ifdef DEVILUTIONX_CL2_CACHE
+	size_t cl2Size;
+	std::optional<OwnedCelSpriteWithFrameHeight> result = PcxToCl2(handle, numFramesOrFrameHeight, transparentColor, outPalette, &cl2Size);
+	if (!result)
+		return std::nullopt;
+	StorePcxSpriteInCache(parameters, filename, *result, cl2Size, outPalette);
+	return result;
+#else
 	std::optional<OwnedCelSpriteWithFrameHeight> result = PcxToCl2(handle, numFramesOrFrameHeight, transparentColor, outPalette);
 	if (!result)
 		return std::nullopt;
 	return result;
+#endif
 }
 
 } // namespace
@@ -5,6 +5,9 @@
  */
 #include "engine/palette.h"
 
+#include <algorithm>
+#include <array>
+
 #include <fmt/compile.h>
 
 #include "engine/dx.h"
@@ -14,6 +17,7 @@
 #include "options.h"
 #include "utils/display.h"
 #include "utils/sdl_compat.h"
+#include "utils/stdcompat/optional.hpp"
 
 namespace devilution {
 
@@ -31,6 +35,47 @@ namespace {
 /** Specifies whether the palette has max brightness. */
 bool sgbFadedIn = true;
 
+/** @brief Maps a color component to its gamma corrected value, for the gamma setting in GammaTableSetting. */
+std::array<Uint8, 256> GammaTable;
+int GammaTableSetting = -1;
+
+const std::array<Uint8, 256> &GetGammaTable()
+{
+	const int gammaValue = *sgOptions.Graphics.gammaCorrection;
+	if (gammaValue != GammaTableSetting) {
+		const double g = gammaValue / 100.0;
+		for (int i = 0; i < 256; i++)
+			GammaTable[i] = static_cast<Uint8>(pow(i / 256.0, g) * 256.0);
+		GammaTableSetting = gammaValue;
+	}
+	return GammaTable;
+}
+
+static_assert(sizeof(SDL_Color) == sizeof(uint32_t), "SetFadeLevel scales the components of a color as one 32-bit value");
+
+/**
+ * @brief Scales the color components by fadeval / 256, leaving the alpha (or unused) component as it is.
+ *
+ * The components are multiplied two at a time in 16-bit lanes of a 32-bit value, the products can't overflow into the
+ * next lane as fadeval is at most 256. The loop has no dependencies between colors, so compilers vectorize it.
+ */
+void ScalePalette(SDL_Color *dst, const SDL_Color *src, int n, uint32_t fadeval)
+{
+	constexpr Uint8 AlphaBytes[4] = { 0, 0, 0, 0xFF };
+	uint32_t alphaMask;
+	memcpy(&alphaMask, AlphaBytes, sizeof(alphaMask));
+	for (int i = 0; i < n; i++) {
+		uint32_t color;
+		uint32_t previous;
+		memcpy(&color, &src[i], sizeof(color));
+		memcpy(&previous, &dst[i], sizeof(previous));
+		const uint32_t even = (((color & 0x00FF00FF) * fadeval) >> 8) & 0x00FF00FF;
+		const uint32_t odd = (((color >> 8) & 0x00FF00FF) * fadeval) & 0xFF00FF00;
+		const uint32_t scaled = ((even | odd) & ~alphaMask) | (previous & alphaMask);
+		memcpy(&dst[i], &scaled, sizeof(scaled));
+	}
+}
+
 void LoadGamma()
 {
 	int gammaValue = *sgOptions.Graphics.gammaCorrection;
@@ -38,24 +83,93 @@ void LoadGamma()
 	sgOptions.Graphics.gammaCorrection.SetValue(gammaValue - gammaValue % 5);
 }
 
-Uint8 FindBestMatchForColor(SDL_Color *palette, SDL_Color color, int skipFrom, int skipTo)
-{
-	Uint8 best;
-	Uint32 bestDiff = SDL_MAX_UINT32;
-	for (int i = 0; i < 256; i++) {
-		if (i >= skipFrom && i <= skipTo)
-			continue;
-		int diffr = palette[i].r - color.r;
-		int diffg = palette[i].g - color.g;
-		int diffb = palette[i].b - color.b;
-		Uint32 diff = diffr * diffr + diffg * diffg + diffb * diffb;
+/**
+ * @brief Finds the closest color of a palette, picking the lowest index if several are equally close.
+ *
+ * The colors are sorted by their red component and the search walks outwards from the red of the requested color
+ * until the red difference alone is larger than that of the best match, instead of comparing all 256 colors.
+ */
+class NearestColorFinder {
+public:
+	NearestColorFinder(const SDL_Color *palette, int skipFrom, int skipTo)
+	{
+		for (int i = 0; i < 256; i++) {
+			if (i >= skipFrom && i <= skipTo)
+				continue;
+			colors_[count_++] = { palette[i].r, palette[i].g, palette[i].b, static_cast<Uint8>(i) };
+		}
+		std::sort(colors_.begin(), colors_.begin() + count_, [](const Entry &a, const Entry &b) {
+			return a.r < b.r;
+		});
+	}
+
+	Uint8 Find(SDL_Color color) const
+	{
+		int above = static_cast<int>(std::lower_bound(colors_.begin(), colors_.begin() + count_, color.r, [](const Entry &entry, Uint8 r) {
+			return entry.r < r;
+		}) - colors_.begin());
+		int below = above - 1;
+
+		Uint8 best = 0;
+		Uint32 bestDiff = SDL_MAX_UINT32;
+		while (above < count_ || below >= 0) {
+			if (above < count_ && !Consider(colors_[above++], color, best, bestDiff))
+				above = count_;
+			if (below >= 0 && !Consider(colors_[below--], color, best, bestDiff))
+				below = -1;
+		}
+		return best;
+	}
 
-		if (bestDiff > diff) {
-			best = i;
+private:
+	struct Entry {
+		Uint8 r;
+		Uint8 g;
+		Uint8 b;
+		Uint8 index;
+	};
+
+	/** @return false if no color further away in red can be a better match. */
+	static bool Consider(const Entry &entry, SDL_Color color, Uint8 &best, Uint32 &bestDiff)
+	{
+		int diffr = entry.r - color.r;
+		Uint32 diff = diffr * diffr;
+		if (diff > bestDiff)
+			return false;
+		int diffg = entry.g - color.g;
+		int diffb = entry.b - color.b;
+		diff += diffg * diffg + diffb * diffb;
+
+		if (diff < bestDiff || (diff == bestDiff && entry.index < best)) {
+			best = entry.index;
 			bestDiff = diff;
 		}
+		return true;
 	}
-	return best;
+
+	std::array<Entry, 256> colors_;
+	int count_ = 0;
+};
+
+/** @brief The palette and skipped range that paletteTransparencyLookup was generated from, if it hasn't changed since. */
+struct BlendedLookupTableSource {
+	std::array<SDL_Color, 256> palette;
+	int skipFrom;
+	int skipTo;
+};
+
+std::optional<BlendedLookupTableSource> CurrentBlendedLookupTableSource;
+
+bool ColorsEqual(const SDL_Color &a, const SDL_Color &b)
+{
+	return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+bool IsCurrentBlendedLookupTable(const SDL_Color *palette, int skipFrom, int skipTo)
+{
+	if (!CurrentBlendedLookupTableSource || CurrentBlendedLookupTableSource->skipFrom != skipFrom || CurrentBlendedLookupTableSource->skipTo != skipTo)
+		return false;
+	return std::equal(palette, palette + 256, CurrentBlendedLookupTableSource->palette.begin(), ColorsEqual);
 }
 
 /**
@@ -73,6 +187,11 @@ Uint8 FindBestMatchForColor(SDL_Color *palette, SDL_Color color, int skipFrom, i
  */
 void GenerateBlendedLookupTable(SDL_Color *palette, int skipFrom, int skipTo, int toUpdate = 256)
 {
+	// Levels of the same type mostly share their palette, so the table often doesn't need to change.
+	if (toUpdate == 256 && IsCurrentBlendedLookupTable(palette, skipFrom, skipTo))
+		return;
+
+	const NearestColorFinder finder(palette, skipFrom, skipTo);
 	for (int i = 0; i < 256; i++) {
 		for (int j = 0; j < 256; j++) {
 			if (i == j) { // No need to calculate transparency between 2 identical colors
@@ -91,11 +210,15 @@ void GenerateBlendedLookupTable(SDL_Color *palette, int skipFrom, int skipTo, in
 			blendedColor.r = ((int)palette[i].r + (int)palette[j].r) / 2;
 			blendedColor.g = ((int)palette[i].g + (int)palette[j].g) / 2;
 			blendedColor.b = ((int)palette[i].b + (int)palette[j].b) / 2;
-			Uint8 best = FindBestMatchForColor(palette, blendedColor, skipFrom, skipTo);
-			paletteTransparencyLookup[i][j] = best;
+			paletteTransparencyLookup[i][j] = finder.Find(blendedColor);
 		}
 	}
 
+	CurrentBlendedLookupTableSource.emplace();
+	std::copy(palette, palette + 256, CurrentBlendedLookupTableSource->palette.begin());
+	CurrentBlendedLookupTableSource->skipFrom = skipFrom;
+	CurrentBlendedLookupTableSource->skipTo = skipTo;
+
 #if DEVILUTIONX_PALETTE_TRANSPARENCY_BLACK_16_LUT
 	for (unsigned i = 0; i < 256; ++i) {
 		for (unsigned j = 0; j < 256; ++j) {
@@ -117,6 +240,7 @@ void GenerateBlendedLookupTable(SDL_Color *palette, int skipFrom, int skipTo, in
  */
 void CycleColors(int from, int to)
 {
+	CurrentBlendedLookupTableSource = std::nullopt;
 	{
 		SDL_Color col = system_palette[from];
 		for (int i = from; i < to; i++) {
@@ -148,6 +272,7 @@ void CycleColors(int from, int to)
  */
 void CycleColorsReverse(int from, int to)
 {
+	CurrentBlendedLookupTableSource = std::nullopt;
 	{
 		SDL_Color col = system_palette[to];
 		for (int i = to; i > from; i--) {
@@ -183,17 +308,18 @@ void palette_update(int first, int ncolor)
 	if (SDLC_SetSurfaceAndPaletteColors(PalSurface, Palette.get(), system_palette, first, ncolor) < 0) {
 		ErrSdl();
 	}
+	MarkPaletteColorsChanged(first, ncolor);
 	pal_surface_palette_version++;
 }
 
 void ApplyGamma(SDL_Color *dst, const SDL_Color *src, int n)
 {
-	double g = *sgOptions.Graphics.gammaCorrection / 100.0;
+	const std::array<Uint8, 256> &gammaTable = GetGammaTable();
 
 	for (int i = 0; i < n; i++) {
-		dst[i].r = static_cast<Uint8>(pow(src[i].r / 256.0, g) * 256.0);
-		dst[i].g = static_cast<Uint8>(pow(src[i].g / 256.0, g) * 256.0);
-		dst[i].b = static_cast<Uint8>(pow(src[i].b / 256.0, g) * 256.0);
+		dst[i].r = gammaTable[src[i].r];
+		dst[i].g = gammaTable[src[i].g];
+		dst[i].b = gammaTable[src[i].b];
 	}
 	force_redraw = 255;
 }
@@ -305,11 +431,7 @@ void SetFadeLevel(int fadeval)
 	if (HeadlessMode)
 		return;
 
-	for (int i = 0; i < 256; i++) {
-		system_palette[i].r = (fadeval * logical_palette[i].r) / 256;
-		system_palette[i].g = (fadeval * logical_palette[i].g) / 256;
-		system_palette[i].b = (fadeval * logical_palette[i].b) / 256;
-	}
+	ScalePalette(system_palette, logical_palette, 256, static_cast<uint32_t>(fadeval));
 	palette_update();
 	if (IsHardwareCursor()) {
 		ReinitializeHardwareCursor();
@@ -419,6 +541,8 @@ void palette_update_quest_palette(int n)
 	ApplyGamma(system_palette, logical_palette, 32);
 	palette_update(0, 31);
 	// Update blended transparency, but only for the color that was updated
+	CurrentBlendedLookupTableSource = std::nullopt;
+	const NearestColorFinder finder(logical_palette, 1, 31);
 	for (int j = 0; j < 256; j++) {
 		if (i == j) { // No need to calculate transparency between 2 identical colors
 			paletteTransparencyLookup[i][j] = j;
@@ -428,8 +552,7 @@ void palette_update_quest_palette(int n)
 		blendedColor.r = ((int)logical_palette[i].r + (int)logical_palette[j].r) / 2;
 		blendedColor.g = ((int)logical_palette[i].g + (int)logical_palette[j].g) / 2;
 		blendedColor.b = ((int)logical_palette[i].b + (int)logical_palette[j].b) / 2;
-		Uint8 best = FindBestMatchForColor(logical_palette, blendedColor, 1, 31);
-		paletteTransparencyLookup[i][j] = paletteTransparencyLookup[j][i] = best;
+		paletteTransparencyLookup[i][j] = paletteTransparencyLookup[j][i] = finder.Find(blendedColor);
 	}
 }
 
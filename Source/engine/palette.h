@@ -34,7 +34,7 @@ namespace devilution {
 extern SDL_Color logical_palette[256];
 extern SDL_Color system_palette[256];
 extern SDL_Color orig_palette[256];
-/** Lookup table for transparency */
+/** Lookup table for transparency, symmetric as blending a with b gives the same color as blending b with a */
 extern Uint8 paletteTransparencyLookup[256][256];
 
 #if DEVILUTIONX_PALETTE_TRANSPARENCY_BLACK_16_LUT
@@ -50,6 +50,12 @@ extern Uint8 paletteTransparencyLookup[256][256];
 extern uint16_t paletteTransparencyLookupBlack16[65536];
 #endif
 
+/**
+ * @brief Pushes a range of the system palette to SDL
+ *
+ * Only the rows of the next frame that show the updated colors are presented again, so color cycling should pass just
+ * the range it changed.
+ */
 void palette_update(int first = 0, int ncolor = 256);
 void palette_init();
 void LoadPalette(const char *pszFileName, bool blend = true);
@@ -59,6 +65,10 @@ void ApplyGamma(SDL_Color *dst, const SDL_Color *src, int n);
 void DecreaseGamma();
 int UpdateGamma(int gamma);
 void BlackPalette();
+/**
+ * @brief Sets the system palette to the logical palette scaled by fadeval / 256
+ * @param fadeval Brightness from 0 (black) to 256 (full)
+ */
 void SetFadeLevel(int fadeval);
 /**
  * @brief Fade screen from black
@@ -6,156 +6,19 @@
 #include "engine/path.h"
 
 #include <array>
+#include <cstring>
+#include <initializer_list>
 
 #include "levels/gendung.h"
 #include "lighting.h"
 #include "objects.h"
+#include "utils/bitset2d.hpp"
 
 namespace devilution {
 namespace {
 
 constexpr size_t MaxPathNodes = 300;
 
-struct PathNode {
-	static constexpr uint16_t InvalidIndex = std::numeric_limits<uint16_t>::max();
-	static constexpr size_t MaxChildren = 8;
-
-	int16_t x = 0;
-	int16_t y = 0;
-	uint16_t parentIndex = InvalidIndex;
-	uint16_t childIndices[MaxChildren] = { InvalidIndex, InvalidIndex, InvalidIndex, InvalidIndex, InvalidIndex, InvalidIndex, InvalidIndex, InvalidIndex };
-	uint16_t nextNodeIndex = InvalidIndex;
-	uint8_t f = 0;
-	uint8_t h = 0;
-	uint8_t g = 0;
-
-	[[nodiscard]] Point position() const
-	{
-		return Point { x, y };
-	}
-
-	void addChild(uint16_t childIndex)
-	{
-		size_t index = 0;
-		for (; index < MaxChildren; ++index) {
-			if (childIndices[index] == InvalidIndex)
-				break;
-		}
-		assert(index < MaxChildren);
-		childIndices[index] = childIndex;
-	}
-};
-
-PathNode PathNodes[MaxPathNodes];
-
-/** A linked list of the A* frontier, sorted by distance */
-PathNode *Path2Nodes;
-
-/**
- * @brief return a node for a position on the frontier, or NULL if not found
- */
-uint16_t GetNode1(Point targetPosition)
-{
-	uint16_t result = Path2Nodes->nextNodeIndex;
-	while (result != PathNode::InvalidIndex) {
-		if (PathNodes[result].position() == targetPosition)
-			return result;
-		result = PathNodes[result].nextNodeIndex;
-	}
-	return PathNode::InvalidIndex;
-}
-
-/**
- * @brief insert `front` node into the frontier (keeping the frontier sorted by total distance)
- */
-void NextNode(uint16_t front)
-{
-	if (Path2Nodes->nextNodeIndex == PathNode::InvalidIndex) {
-		Path2Nodes->nextNodeIndex = front;
-		return;
-	}
-
-	PathNode *current = Path2Nodes;
-	uint16_t nextIndex = Path2Nodes->nextNodeIndex;
-	const uint8_t maxF = PathNodes[front].f;
-	while (nextIndex != PathNode::InvalidIndex && PathNodes[nextIndex].f < maxF) {
-		current = &PathNodes[nextIndex];
-		nextIndex = current->nextNodeIndex;
-	}
-	PathNodes[front].nextNodeIndex = nextIndex;
-	current->nextNodeIndex = front;
-}
-
-/** A linked list of all visited nodes */
-PathNode *VisitedNodes;
-
-/**
- * @brief return a node for this position if it was visited, or NULL if not found
- */
-uint16_t GetNode2(Point targetPosition)
-{
-	uint16_t result = VisitedNodes->nextNodeIndex;
-	while (result != PathNode::InvalidIndex) {
-		if (PathNodes[result].position() == targetPosition)
-			return result;
-		result = PathNodes[result].nextNodeIndex;
-	}
-	return result;
-}
-
-/**
- * @brief get the next node on the A* frontier to explore (estimated to be closest to the goal), mark it as visited, and return it
- */
-uint16_t GetNextPath()
-{
-	uint16_t result = Path2Nodes->nextNodeIndex;
-	if (result == PathNode::InvalidIndex) {
-		return result;
-	}
-
-	Path2Nodes->nextNodeIndex = PathNodes[result].nextNodeIndex;
-	PathNodes[result].nextNodeIndex = VisitedNodes->nextNodeIndex;
-	VisitedNodes->nextNodeIndex = result;
-	return result;
-}
-
-/** the number of in-use nodes in path_nodes */
-uint32_t gdwCurNodes;
-/**
- * @brief zero one of the preallocated nodes and return a pointer to it, or NULL if none are available
- */
-uint16_t NewStep()
-{
-	if (gdwCurNodes >= MaxPathNodes)
-		return PathNode::InvalidIndex;
-
-	PathNodes[gdwCurNodes] = {};
-	return gdwCurNodes++;
-}
-
-/** A stack for recursively searching nodes */
-uint16_t pnode_tblptr[MaxPathNodes];
-/** size of the pnode_tblptr stack */
-uint32_t gdwCurPathStep;
-/**
- * @brief push pPath onto the pnode_tblptr stack
- */
-void PushActiveStep(uint16_t pPath)
-{
-	assert(gdwCurPathStep < MaxPathNodes);
-	pnode_tblptr[gdwCurPathStep] = pPath;
-	gdwCurPathStep++;
-}
-
-/**
- * @brief pop and return a node from the pnode_tblptr stack
- */
-uint16_t PopActiveStep()
-{
-	gdwCurPathStep--;
-	return pnode_tblptr[gdwCurPathStep];
-}
-
 /**
  * @brief return 2 if pPath is horizontally/vertically aligned with (dx,dy), else 3
  *
@@ -171,33 +34,6 @@ int CheckEqual(Point startPosition, Point destinationPosition)
 	return 3;
 }
 
-/**
- * @brief update all path costs using depth-first search starting at pPath
- */
-void SetCoords(uint16_t pPath)
-{
-	PushActiveStep(pPath);
-	// while there are path nodes to check
-	while (gdwCurPathStep > 0) {
-		uint16_t pathOldIndex = PopActiveStep();
-		const PathNode &pathOld = PathNodes[pathOldIndex];
-		for (uint16_t childIndex : pathOld.childIndices) {
-			if (childIndex == PathNode::InvalidIndex)
-				break;
-			PathNode &pathAct = PathNodes[childIndex];
-
-			if (pathOld.g + CheckEqual(pathOld.position(), pathAct.position()) < pathAct.g) {
-				if (path_solid_pieces(pathOld.position(), pathAct.position())) {
-					pathAct.parentIndex = pathOldIndex;
-					pathAct.g = pathOld.g + CheckEqual(pathOld.position(), pathAct.position());
-					pathAct.f = pathAct.g + pathAct.h;
-					PushActiveStep(childIndex);
-				}
-			}
-		}
-	}
-}
-
 /**
  * Returns a number representing the direction from a starting tile to a neighbouring tile.
  *
@@ -224,40 +60,283 @@ int GetHeuristicCost(Point startPosition, Point destinationPosition)
 	return 2 * startPosition.ManhattanDistance(destinationPosition);
 }
 
+/** Incremented whenever the dungeon layout changes, 0 is used for fields that were never built. */
+uint32_t LayoutVersion = 1;
+
+/** @brief The solid dungeon pieces of the level as of SolidTilesVersion, saves FindPath looking up dPiece and SOLData. */
+Bitset2d<MAXDUNX, MAXDUNY> SolidTiles;
+uint32_t SolidTilesVersion = 0;
+
+void UpdateSolidTiles()
+{
+	if (SolidTilesVersion == LayoutVersion)
+		return;
+	SolidTilesVersion = LayoutVersion;
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++)
+			SolidTiles.set(x, y, TileHasAny(dPiece[x][y], TileProperties::Solid));
+	}
+}
+
 /**
- * @brief add a step from pPath to destination, return 1 if successful, and update the frontier/visited nodes accordingly
- *
- * @param pathIndex index of the current path node
- * @param candidatePosition expected to be a neighbour of the current path node position
- * @param destinationPosition where we hope to end up
- * @return true if step successfully added, false if we ran out of nodes to use
+ * @brief Same as IsTileNotSolid, using SolidTiles
  */
-bool ParentPath(uint16_t pathIndex, Point candidatePosition, Point destinationPosition)
+bool IsSolidTileClear(Point position)
 {
-	PathNode &path = PathNodes[pathIndex];
-	int nextG = path.g + CheckEqual(path.position(), candidatePosition);
-
-	// 3 cases to consider
-	// case 1: (dx,dy) is already on the frontier
-	uint16_t dxdyIndex = GetNode1(candidatePosition);
-	if (dxdyIndex != PathNode::InvalidIndex) {
-		path.addChild(dxdyIndex);
-		PathNode &dxdy = PathNodes[dxdyIndex];
-		if (nextG < dxdy.g) {
-			if (path_solid_pieces(path.position(), candidatePosition)) {
-				// we'll explore it later, just update
-				dxdy.parentIndex = pathIndex;
-				dxdy.g = nextG;
-				dxdy.f = nextG + dxdy.h;
+	return InDungeonBounds(position) && !SolidTiles.test(position.x, position.y);
+}
+
+/**
+ * @brief Same as path_solid_pieces, using SolidTiles
+ */
+bool AreCornersClear(Point startPosition, Point destinationPosition)
+{
+	switch (GetPathDirection(startPosition, destinationPosition)) {
+	case 5: // Stepping north
+		return IsSolidTileClear(destinationPosition + Direction::SouthWest) && IsSolidTileClear(destinationPosition + Direction::SouthEast);
+	case 6: // Stepping east
+		return IsSolidTileClear(destinationPosition + Direction::SouthWest) && IsSolidTileClear(destinationPosition + Direction::NorthWest);
+	case 7: // Stepping south
+		return IsSolidTileClear(destinationPosition + Direction::NorthEast) && IsSolidTileClear(destinationPosition + Direction::NorthWest);
+	case 8: // Stepping west
+		return IsSolidTileClear(destinationPosition + Direction::SouthEast) && IsSolidTileClear(destinationPosition + Direction::NorthEast);
+	default:
+		return true;
+	}
+}
+
+/**
+ * @brief Index of the path node for each tile of the current search.
+ *
+ * Never cleared: an entry is only valid if it refers to an allocated node at the same position.
+ */
+uint16_t NodeIndexAt[MAXDUNX][MAXDUNY];
+
+/**
+ * @brief A* search over a fixed pool of nodes.
+ */
+class PathSearch {
+public:
+	int FindPath(tl::function_ref<bool(Point)> posOk, Point startPosition, Point destinationPosition, int8_t path[MaxPathLength]);
+
+private:
+	struct PathNode {
+		static constexpr uint16_t InvalidIndex = std::numeric_limits<uint16_t>::max();
+		static constexpr size_t MaxChildren = 8;
+
+		int16_t x = 0;
+		int16_t y = 0;
+		uint16_t parentIndex = InvalidIndex;
+		uint16_t childIndices[MaxChildren] = { InvalidIndex, InvalidIndex, InvalidIndex, InvalidIndex, InvalidIndex, InvalidIndex, InvalidIndex, InvalidIndex };
+		uint16_t nextNodeIndex = InvalidIndex;
+		uint8_t f = 0;
+		uint8_t h = 0;
+		uint8_t g = 0;
+		/** Whether the node was moved from the frontier to the visited nodes */
+		bool visited = false;
+
+		[[nodiscard]] Point position() const
+		{
+			return Point { x, y };
+		}
+
+		void addChild(uint16_t childIndex)
+		{
+			size_t index = 0;
+			for (; index < MaxChildren; ++index) {
+				if (childIndices[index] == InvalidIndex)
+					break;
 			}
+			assert(index < MaxChildren);
+			childIndices[index] = childIndex;
+		}
+	};
+
+	static constexpr uint16_t InvalidIndex = PathNode::InvalidIndex;
+	static_assert(MaxPathNodes < InvalidIndex, "Node indices must fit in uint16_t");
+
+	PathNode pathNodes[MaxPathNodes];
+
+	/** A linked list of the A* frontier, sorted by distance */
+	PathNode *path2Nodes;
+	/** A linked list of all visited nodes */
+	PathNode *visitedNodes;
+
+	/** the number of in-use nodes in pathNodes */
+	uint32_t curNodes;
+
+	/** A stack for recursively searching nodes */
+	uint16_t activeSteps[MaxPathNodes];
+	/** size of the activeSteps stack */
+	uint32_t curPathStep;
+
+	/** for reconstructing the path after the A* search is done */
+	int8_t pnodeVals[MaxPathLength];
+
+	/**
+	 * @brief return the node for a position on the frontier or among the visited nodes, or InvalidIndex if not found
+	 */
+	uint16_t GetNode(Point targetPosition) const
+	{
+		if (InDungeonBounds(targetPosition)) {
+			const uint16_t result = NodeIndexAt[targetPosition.x][targetPosition.y];
+			if (result < curNodes && &pathNodes[result] != path2Nodes && &pathNodes[result] != visitedNodes && pathNodes[result].position() == targetPosition)
+				return result;
+			return InvalidIndex;
+		}
+
+		// Searches that are allowed to leave the map fall back to walking both lists.
+		for (const PathNode *list : { path2Nodes, visitedNodes }) {
+			uint16_t result = list->nextNodeIndex;
+			while (result != InvalidIndex) {
+				if (pathNodes[result].position() == targetPosition)
+					return result;
+				result = pathNodes[result].nextNodeIndex;
+			}
+		}
+		return InvalidIndex;
+	}
+
+	/**
+	 * @brief insert `front` node into the frontier (keeping the frontier sorted by total distance)
+	 */
+	void NextNode(uint16_t front)
+	{
+		if (path2Nodes->nextNodeIndex == InvalidIndex) {
+			path2Nodes->nextNodeIndex = front;
+			return;
 		}
-	} else {
-		// case 2: (dx,dy) was already visited
-		dxdyIndex = GetNode2(candidatePosition);
-		if (dxdyIndex != PathNode::InvalidIndex) {
+
+		PathNode *current = path2Nodes;
+		uint16_t nextIndex = path2Nodes->nextNodeIndex;
+		const uint8_t maxF = pathNodes[front].f;
+		while (nextIndex != InvalidIndex && pathNodes[nextIndex].f < maxF) {
+			current = &pathNodes[nextIndex];
+			nextIndex = current->nextNodeIndex;
+		}
+		pathNodes[front].nextNodeIndex = nextIndex;
+		current->nextNodeIndex = front;
+	}
+
+	/**
+	 * @brief get the next node on the A* frontier to explore (estimated to be closest to the goal), mark it as visited, and return it
+	 */
+	uint16_t GetNextPath()
+	{
+		uint16_t result = path2Nodes->nextNodeIndex;
+		if (result == InvalidIndex) {
+			return result;
+		}
+
+		path2Nodes->nextNodeIndex = pathNodes[result].nextNodeIndex;
+		pathNodes[result].nextNodeIndex = visitedNodes->nextNodeIndex;
+		pathNodes[result].visited = true;
+		visitedNodes->nextNodeIndex = result;
+		return result;
+	}
+
+	/**
+	 * @brief zero one of the preallocated nodes and return its index, or InvalidIndex if none are available
+	 */
+	uint16_t NewStep()
+	{
+		if (curNodes >= MaxPathNodes)
+			return InvalidIndex;
+
+		pathNodes[curNodes] = {};
+		return curNodes++;
+	}
+
+	/**
+	 * @brief Sets the position of a new node and makes it findable by GetNode
+	 */
+	void PlaceNode(uint16_t index, Point position)
+	{
+		PathNode &node = pathNodes[index];
+		node.x = static_cast<int16_t>(position.x);
+		node.y = static_cast<int16_t>(position.y);
+		if (InDungeonBounds(position))
+			NodeIndexAt[position.x][position.y] = index;
+	}
+
+	/**
+	 * @brief push pPath onto the activeSteps stack
+	 */
+	void PushActiveStep(uint16_t pPath)
+	{
+		assert(curPathStep < MaxPathNodes);
+		activeSteps[curPathStep] = pPath;
+		curPathStep++;
+	}
+
+	/**
+	 * @brief pop and return a node from the activeSteps stack
+	 */
+	uint16_t PopActiveStep()
+	{
+		curPathStep--;
+		return activeSteps[curPathStep];
+	}
+
+	/**
+	 * @brief update all path costs using depth-first search starting at pPath
+	 */
+	void SetCoords(uint16_t pPath)
+	{
+		PushActiveStep(pPath);
+		// while there are path nodes to check
+		while (curPathStep > 0) {
+			uint16_t pathOldIndex = PopActiveStep();
+			const PathNode &pathOld = pathNodes[pathOldIndex];
+			for (uint16_t childIndex : pathOld.childIndices) {
+				if (childIndex == InvalidIndex)
+					break;
+				PathNode &pathAct = pathNodes[childIndex];
+
+				if (pathOld.g + CheckEqual(pathOld.position(), pathAct.position()) < pathAct.g) {
+					if (AreCornersClear(pathOld.position(), pathAct.position())) {
+						pathAct.parentIndex = pathOldIndex;
+						pathAct.g = pathOld.g + CheckEqual(pathOld.position(), pathAct.position());
+						pathAct.f = pathAct.g + pathAct.h;
+						PushActiveStep(childIndex);
+					}
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief add a step from pPath to destination, return 1 if successful, and update the frontier/visited nodes accordingly
+	 *
+	 * @param pathIndex index of the current path node
+	 * @param candidatePosition expected to be a neighbour of the current path node position
+	 * @param destinationPosition where we hope to end up
+	 * @return true if step successfully added, false if we ran out of nodes to use
+	 */
+	bool ParentPath(uint16_t pathIndex, Point candidatePosition, Point destinationPosition)
+	{
+		PathNode &path = pathNodes[pathIndex];
+		int nextG = path.g + CheckEqual(path.position(), candidatePosition);
+
+		// 3 cases to consider
+		uint16_t dxdyIndex = GetNode(candidatePosition);
+		if (dxdyIndex != InvalidIndex && !pathNodes[dxdyIndex].visited) {
+			// case 1: (dx,dy) is already on the frontier
 			path.addChild(dxdyIndex);
-			PathNode &dxdy = PathNodes[dxdyIndex];
-			if (nextG < dxdy.g && path_solid_pieces(path.position(), candidatePosition)) {
+			PathNode &dxdy = pathNodes[dxdyIndex];
+			if (nextG < dxdy.g) {
+				if (AreCornersClear(path.position(), candidatePosition)) {
+					// we'll explore it later, just update
+					dxdy.parentIndex = pathIndex;
+					dxdy.g = nextG;
+					dxdy.f = nextG + dxdy.h;
+				}
+			}
+		} else if (dxdyIndex != InvalidIndex) {
+			// case 2: (dx,dy) was already visited
+			path.addChild(dxdyIndex);
+			PathNode &dxdy = pathNodes[dxdyIndex];
+			if (nextG < dxdy.g && AreCornersClear(path.position(), candidatePosition)) {
 				// update the node
 				dxdy.parentIndex = pathIndex;
 				dxdy.g = nextG;
@@ -268,41 +347,102 @@ bool ParentPath(uint16_t pathIndex, Point candidatePosition, Point destinationPo
 		} else {
 			// case 3: (dx,dy) is totally new
 			dxdyIndex = NewStep();
-			if (dxdyIndex == PathNode::InvalidIndex)
+			if (dxdyIndex == InvalidIndex)
 				return false;
-			PathNode &dxdy = PathNodes[dxdyIndex];
+			PathNode &dxdy = pathNodes[dxdyIndex];
 			dxdy.parentIndex = pathIndex;
 			dxdy.g = nextG;
 			dxdy.h = GetHeuristicCost(candidatePosition, destinationPosition);
 			dxdy.f = nextG + dxdy.h;
-			dxdy.x = static_cast<int16_t>(candidatePosition.x);
-			dxdy.y = static_cast<int16_t>(candidatePosition.y);
+			PlaceNode(dxdyIndex, candidatePosition);
 			// add it to the frontier
 			NextNode(dxdyIndex);
 			path.addChild(dxdyIndex);
 		}
+		return true;
 	}
-	return true;
-}
 
-/**
- * @brief perform a single step of A* bread-first search by trying to step in every possible direction from pPath with goal (x,y). Check each step with PosOk
- *
- * @return false if we ran out of preallocated nodes to use, else true
- */
-bool GetPath(const std::function<bool(Point)> &posOk, uint16_t pathIndex, Point destination)
+	/**
+	 * @brief perform a single step of A* bread-first search by trying to step in every possible direction from pPath with goal (x,y). Check each step with PosOk
+	 *
+	 * @return false if we ran out of preallocated nodes to use, else true
+	 */
+	bool GetPath(tl::function_ref<bool(Point)> posOk, uint16_t pathIndex, Point destination)
+	{
+		for (Displacement dir : PathDirs) {
+			const PathNode &path = pathNodes[pathIndex];
+			const Point tile = path.position() + dir;
+			// The corners only depend on the dungeon, so they are checked before the callers' occupancy checks
+			const bool cornersClear = AreCornersClear(path.position(), tile);
+			if (!cornersClear && tile != destination)
+				continue;
+			const bool ok = posOk(tile);
+			if ((ok && cornersClear) || (!ok && tile == destination)) {
+				if (!ParentPath(pathIndex, tile, destination))
+					return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+int PathSearch::FindPath(tl::function_ref<bool(Point)> posOk, Point startPosition, Point destinationPosition, int8_t path[MaxPathLength])
 {
-	for (Displacement dir : PathDirs) {
-		const PathNode &path = PathNodes[pathIndex];
-		const Point tile = path.position() + dir;
-		const bool ok = posOk(tile);
-		if ((ok && path_solid_pieces(path.position(), tile)) || (!ok && tile == destination)) {
-			if (!ParentPath(pathIndex, tile, destination))
-				return false;
+	UpdateSolidTiles();
+
+	// clear all nodes, create root nodes for the visited/frontier linked lists
+	curNodes = 0;
+	path2Nodes = &pathNodes[NewStep()];
+	visitedNodes = &pathNodes[NewStep()];
+	curPathStep = 0;
+	const uint16_t pathStartIndex = NewStep();
+	PathNode &pathStart = pathNodes[pathStartIndex];
+	PlaceNode(pathStartIndex, startPosition);
+	pathStart.f = pathStart.h + pathStart.g;
+	pathStart.h = GetHeuristicCost(startPosition, destinationPosition);
+	pathStart.g = 0;
+	path2Nodes->nextNodeIndex = pathStartIndex;
+	// A* search until we find (dx,dy) or fail
+	uint16_t nextNodeIndex;
+	while ((nextNodeIndex = GetNextPath()) != InvalidIndex) {
+		// reached the end, success!
+		if (pathNodes[nextNodeIndex].position() == destinationPosition) {
+			const PathNode *current = &pathNodes[nextNodeIndex];
+			size_t pathLength = 0;
+			while (current->parentIndex != InvalidIndex) {
+				if (pathLength >= MaxPathLength)
+					break;
+				pnodeVals[pathLength++] = GetPathDirection(pathNodes[current->parentIndex].position(), current->position());
+				current = &pathNodes[current->parentIndex];
+			}
+			if (pathLength != MaxPathLength) {
+				size_t i;
+				for (i = 0; i < pathLength; i++)
+					path[i] = pnodeVals[pathLength - i - 1];
+				return static_cast<int>(i);
+			}
+			return 0;
 		}
+		// ran out of nodes, abort!
+		if (!GetPath(posOk, nextNodeIndex, destinationPosition))
+			return 0;
 	}
+	// frontier is empty, no path!
+	return 0;
+}
+
+PathSearch Search;
 
-	return true;
+/**
+ * @brief A relaxed version of the posOk checks used by callers of FindPath, ignoring everything that can block a tile except the dungeon itself.
+ */
+bool IsTilePassable(Point position)
+{
+	if (!IsTileSolid(position))
+		return true;
+	const Object *object = ObjectAtPosition(position, false);
+	return object != nullptr && object->IsDoor();
 }
 
 } // namespace
@@ -362,54 +502,85 @@ bool IsTileOccupied(Point position)
 	return false;
 }
 
-int FindPath(const std::function<bool(Point)> &posOk, Point startPosition, Point destinationPosition, int8_t path[MaxPathLength])
+int FindPath(tl::function_ref<bool(Point)> posOk, Point startPosition, Point destinationPosition, int8_t path[MaxPathLength])
 {
-	/**
-	 * for reconstructing the path after the A* search is done. The longest
-	 * possible path is actually 24 steps, even though we can fit 25
-	 */
-	static int8_t pnodeVals[MaxPathLength];
+	return Search.FindPath(posOk, startPosition, destinationPosition, path);
+}
 
-	// clear all nodes, create root nodes for the visited/frontier linked lists
-	gdwCurNodes = 0;
-	Path2Nodes = &PathNodes[NewStep()];
-	VisitedNodes = &PathNodes[NewStep()];
-	gdwCurPathStep = 0;
-	const uint16_t pathStartIndex = NewStep();
-	PathNode &pathStart = PathNodes[pathStartIndex];
-	pathStart.x = static_cast<int16_t>(startPosition.x);
-	pathStart.y = static_cast<int16_t>(startPosition.y);
-	pathStart.f = pathStart.h + pathStart.g;
-	pathStart.h = GetHeuristicCost(startPosition, destinationPosition);
-	pathStart.g = 0;
-	Path2Nodes->nextNodeIndex = pathStartIndex;
-	// A* search until we find (dx,dy) or fail
-	uint16_t nextNodeIndex;
-	while ((nextNodeIndex = GetNextPath()) != PathNode::InvalidIndex) {
-		// reached the end, success!
-		if (PathNodes[nextNodeIndex].position() == destinationPosition) {
-			const PathNode *current = &PathNodes[nextNodeIndex];
-			size_t pathLength = 0;
-			while (current->parentIndex != PathNode::InvalidIndex) {
-				if (pathLength >= MaxPathLength)
-					break;
-				pnodeVals[pathLength++] = GetPathDirection(PathNodes[current->parentIndex].position(), current->position());
-				current = &PathNodes[current->parentIndex];
-			}
-			if (pathLength != MaxPathLength) {
-				size_t i;
-				for (i = 0; i < pathLength; i++)
-					path[i] = pnodeVals[pathLength - i - 1];
-				return static_cast<int>(i);
-			}
-			return 0;
+void PathDistanceField::Build(Point destination)
+{
+	memset(distances_, Unreached, sizeof(distances_));
+	destination_ = destination;
+	layoutVersion_ = LayoutVersion;
+
+	// Breadth-first search outwards from the destination, the window covers every tile that is close enough to matter
+	Point queue[Size * Size];
+	size_t queueBegin = 0;
+	size_t queueEnd = 0;
+	distances_[Radius][Radius] = 0;
+	queue[queueEnd++] = destination;
+	while (queueBegin < queueEnd) {
+		const Point position = queue[queueBegin++];
+		const uint8_t nextDistance = distanceAt(position) + 1;
+		if (nextDistance >= MaxPathLength)
+			continue;
+		for (Displacement dir : PathDirs) {
+			const Point candidate = position + dir;
+			const Displacement offset = candidate - destination + Displacement { Radius, Radius };
+			if (offset.deltaX < 0 || offset.deltaX >= Size || offset.deltaY < 0 || offset.deltaY >= Size)
+				continue;
+			uint8_t &distance = distances_[offset.deltaX][offset.deltaY];
+			if (distance != Unreached)
+				continue;
+			// FindPath still checks corners when stepping onto an accessible destination, stay lenient here
+			if (!IsTilePassable(candidate) || (position != destination && !path_solid_pieces(candidate, position)))
+				continue;
+			distance = nextDistance;
+			queue[queueEnd++] = candidate;
 		}
-		// ran out of nodes, abort!
-		if (!GetPath(posOk, nextNodeIndex, destinationPosition))
-			return 0;
 	}
-	// frontier is empty, no path!
-	return 0;
+}
+
+bool PathDistanceField::isValid() const
+{
+	return layoutVersion_ == LayoutVersion;
+}
+
+uint8_t PathDistanceField::distanceAt(Point position) const
+{
+	const Displacement offset = position - destination_ + Displacement { Radius, Radius };
+	if (offset.deltaX < 0 || offset.deltaX >= Size || offset.deltaY < 0 || offset.deltaY >= Size)
+		return Unreached;
+	return distances_[offset.deltaX][offset.deltaY];
+}
+
+bool PathDistanceField::MayReach(Point startPosition) const
+{
+	if (startPosition == destination_)
+		return true;
+
+	// The starting tile itself is never checked by FindPath, only the steps taken from it
+	for (Displacement dir : PathDirs) {
+		const Point step = startPosition + dir;
+		if (step == destination_)
+			return true;
+		const uint8_t distance = distanceAt(step);
+		if (distance < MaxPathLength - 1 && path_solid_pieces(startPosition, step))
+			return true;
+	}
+	return false;
+}
+
+void InvalidatePathDistanceFields()
+{
+	LayoutVersion++;
+	if (LayoutVersion == 0)
+		LayoutVersion = 1;
+}
+
+uint32_t GetLayoutVersion()
+{
+	return LayoutVersion;
 }
 
 bool path_solid_pieces(Point startPosition, Point destinationPosition)
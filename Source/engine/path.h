@@ -10,6 +10,7 @@
 #include <limits>
 
 #include <SDL.h>
+#include <function_ref.hpp>
 
 #include "engine/direction.hpp"
 #include "engine/point.hpp"
@@ -36,7 +37,7 @@ bool IsTileOccupied(Point position);
  * @brief Find the shortest path from startPosition to destinationPosition, using PosOk(Point) to check that each step is a valid position.
  * Store the step directions (corresponds to an index in PathDirs) in path, which must have room for 24 steps
  */
-int FindPath(const std::function<bool(Point)> &posOk, Point startPosition, Point destinationPosition, int8_t path[MaxPathLength]);
+int FindPath(tl::function_ref<bool(Point)> posOk, Point startPosition, Point destinationPosition, int8_t path[MaxPathLength]);
 
 /**
  * @brief check if stepping from a given position to a neighbouring tile cuts a corner.
@@ -50,6 +51,58 @@ int FindPath(const std::function<bool(Point)> &posOk, Point startPosition, Point
  */
 bool path_solid_pieces(Point startPosition, Point destinationPosition);
 
+/**
+ * @brief Step counts of the shortest walks to a destination tile, only taking the dungeon layout and doors into account.
+ *
+ * Any step FindPath can take is also a step here (as long as posOk never allows solid tiles other than doors), so
+ * when a position is not reachable in fewer than MaxPathLength steps FindPath can't find a path from it either. This
+ * lets many searches towards the same target be rejected early without changing the paths that are found.
+ */
+class PathDistanceField {
+public:
+	/**
+	 * @brief Computes the step counts for walks ending at the given position.
+	 */
+	void Build(Point destination);
+
+	/**
+	 * @brief Whether the field was built and the dungeon layout didn't change since.
+	 */
+	[[nodiscard]] bool isValid() const;
+
+	[[nodiscard]] Point destination() const
+	{
+		return destination_;
+	}
+
+	/**
+	 * @brief Checks if FindPath could possibly find a path from the given position to the destination.
+	 */
+	[[nodiscard]] bool MayReach(Point startPosition) const;
+
+private:
+	static constexpr int Radius = MaxPathLength - 1;
+	static constexpr int Size = 2 * Radius + 1;
+	static constexpr uint8_t Unreached = std::numeric_limits<uint8_t>::max();
+
+	[[nodiscard]] uint8_t distanceAt(Point position) const;
+
+	uint8_t distances_[Size][Size];
+	Point destination_;
+	uint32_t layoutVersion_ = 0;
+};
+
+/**
+ * @brief Marks all PathDistanceFields and the solid tiles FindPath looks up as outdated, must be called whenever dPiece,
+ * SOLData or the doors on the level change.
+ */
+void InvalidatePathDistanceFields();
+
+/**
+ * @brief Changes whenever InvalidatePathDistanceFields is called, so that other caches of the level layout can tell they are outdated.
+ */
+uint32_t GetLayoutVersion();
+
 /** For iterating over the 8 possible movement directions */
 const Displacement PathDirs[8] = {
 	// clang-format off
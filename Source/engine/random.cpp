@@ -6,8 +6,10 @@
 
 namespace devilution {
 
+namespace {
+
 /** Current game seed */
-uint32_t sglGameSeed;
+DiabloGenerator GameGenerator { 0 };
 
 /**
  * Specifies the increment used in the Borland C/C++ pseudo-random number generator algorithm.
@@ -19,42 +21,82 @@ const uint32_t RndInc = 1;
  */
 const uint32_t RndMult = 0x015A4E35;
 
-void SetRndSeed(uint32_t seed)
+int32_t StateToRndSeed(uint32_t state)
 {
-	sglGameSeed = seed;
+	const int32_t seed = static_cast<int32_t>(state);
+	// since abs(INT_MIN) is undefined behavior, handle this value specially
+	return seed == std::numeric_limits<int32_t>::min() ? std::numeric_limits<int32_t>::min() : abs(seed);
 }
 
-uint32_t GetLCGEngineState()
+} // namespace
+
+int32_t DiabloGenerator::advanceRndSeed()
 {
-	return sglGameSeed;
+	seed_ = (RndMult * seed_) + RndInc;
+	return StateToRndSeed(seed_);
 }
 
-int32_t GetRndSeed()
+int32_t DiabloGenerator::generateRnd(int32_t v)
 {
-	const int32_t seed = static_cast<int32_t>(sglGameSeed);
-	// since abs(INT_MIN) is undefined behavior, handle this value specially
-	return seed == std::numeric_limits<int32_t>::min() ? std::numeric_limits<int32_t>::min() : abs(seed);
+	if (v <= 0)
+		return 0;
+	if (v <= 0x7FFF) // use the high bits to correct for LCG bias
+		return (advanceRndSeed() >> 16) % v;
+	return advanceRndSeed() % v;
+}
+
+bool DiabloGenerator::flipCoin(unsigned frequency)
+{
+	// Casting here because generateRnd takes a signed argument when it should take and yield unsigned.
+	return generateRnd(static_cast<int32_t>(frequency)) == 0;
+}
+
+void DiabloGenerator::discardRandomValues(uint64_t count)
+{
+	// Stepping twice with (mult, inc) is the same as stepping once with (mult * mult, inc * (mult + 1)).
+	uint32_t stepMult = RndMult;
+	uint32_t stepInc = RndInc;
+	uint32_t totalMult = 1;
+	uint32_t totalInc = 0;
+	for (; count != 0; count >>= 1) {
+		if ((count & 1) != 0) {
+			totalMult *= stepMult;
+			totalInc = totalInc * stepMult + stepInc;
+		}
+		stepInc *= stepMult + 1;
+		stepMult *= stepMult;
+	}
+	seed_ = totalMult * seed_ + totalInc;
+}
+
+void SetRndSeed(uint32_t seed)
+{
+	GameGenerator = DiabloGenerator { seed };
+}
+
+uint32_t GetLCGEngineState()
+{
+	return GameGenerator.state();
 }
 
 int32_t AdvanceRndSeed()
 {
-	sglGameSeed = (RndMult * sglGameSeed) + RndInc;
-	return GetRndSeed();
+	return GameGenerator.advanceRndSeed();
 }
 
 int32_t GenerateRnd(int32_t v)
 {
-	if (v <= 0)
-		return 0;
-	if (v <= 0x7FFF) // use the high bits to correct for LCG bias
-		return (AdvanceRndSeed() >> 16) % v;
-	return AdvanceRndSeed() % v;
+	return GameGenerator.generateRnd(v);
 }
 
 bool FlipCoin(unsigned frequency)
 {
-	// Casting here because GenerateRnd takes a signed argument when it should take and yield unsigned.
-	return GenerateRnd(static_cast<int32_t>(frequency)) == 0;
+	return GameGenerator.flipCoin(frequency);
+}
+
+void DiscardRandomValues(uint64_t count)
+{
+	GameGenerator.discardRandomValues(count);
 }
 
 } // namespace devilution
@@ -13,6 +13,46 @@
 
 namespace devilution {
 
+/**
+ * @brief The vanilla RNG, a Borland LCG, as an object of its own
+ *
+ * Produces exactly the same values as the global functions below, which use a global instance. Code that is handed
+ * its own generator doesn't need to save and restore the global state around its work, so it could run alongside
+ * other generators.
+ */
+class DiabloGenerator {
+public:
+	explicit DiabloGenerator(uint32_t seed)
+	    : seed_(seed)
+	{
+	}
+
+	/** @brief Returns the current engine state, see GetLCGEngineState() */
+	[[nodiscard]] uint32_t state() const
+	{
+		return seed_;
+	}
+
+	/** @brief Same as AdvanceRndSeed() */
+	int32_t advanceRndSeed();
+
+	/** @brief Same as GenerateRnd() */
+	int32_t generateRnd(int32_t v);
+
+	/** @brief Same as FlipCoin() */
+	bool flipCoin(unsigned frequency = 2);
+
+	/**
+	 * @brief Advances the engine state as if advanceRndSeed() had been called count times
+	 *
+	 * Takes O(log(count)) steps, the LCG's multiplier and increment for count steps are combined by repeated squaring.
+	 */
+	void discardRandomValues(uint64_t count);
+
+private:
+	uint32_t seed_;
+};
+
 /**
  * @brief Set the state of the RandomNumberEngine used by the base game to the specific seed
  * @param seed New engine state
@@ -70,6 +110,12 @@ int32_t GenerateRnd(int32_t v);
  */
 bool FlipCoin(unsigned frequency = 2);
 
+/**
+ * @brief Advances the state of the vanilla RNG as if AdvanceRndSeed() had been called count times
+ * @see DiabloGenerator::discardRandomValues()
+ */
+void DiscardRandomValues(uint64_t count);
+
 /**
  * @brief Picks one of the elements in the list randomly.
  *
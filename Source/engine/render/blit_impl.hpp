@@ -77,8 +77,32 @@ DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void BlitFillWithMap(uint8_t *dst, unsigned
 	std::memset(dst, colorMap[color], length);
 }
 
+/**
+ * @brief Maps the pixels through `colorMap`.
+ *
+ * Every store to `dst` could alias the map, so the pixels are looked up in groups of 8 that are stored together,
+ * which lets the compiler overlap the lookups instead of waiting for each store.
+ */
 DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void BlitPixelsWithMap(uint8_t *dst, const uint8_t *src, unsigned length, const uint8_t *colorMap)
 {
+	for (; length >= 8; length -= 8, src += 8, dst += 8) {
+		const uint8_t p0 = colorMap[src[0]];
+		const uint8_t p1 = colorMap[src[1]];
+		const uint8_t p2 = colorMap[src[2]];
+		const uint8_t p3 = colorMap[src[3]];
+		const uint8_t p4 = colorMap[src[4]];
+		const uint8_t p5 = colorMap[src[5]];
+		const uint8_t p6 = colorMap[src[6]];
+		const uint8_t p7 = colorMap[src[7]];
+		dst[0] = p0;
+		dst[1] = p1;
+		dst[2] = p2;
+		dst[3] = p3;
+		dst[4] = p4;
+		dst[5] = p5;
+		dst[6] = p6;
+		dst[7] = p7;
+	}
 	while (length-- > 0)
 		*dst++ = colorMap[*src++];
 }
@@ -111,15 +135,29 @@ struct BlitWithMap {
 
 DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void BlitFillBlendedWithMap(uint8_t *dst, unsigned length, uint8_t color, const uint8_t *colorMap)
 {
-	color = colorMap[color];
+	// The blends are symmetric, so the row of the fill color can be used instead of walking down a column.
+	const uint8_t *blends = paletteTransparencyLookup[colorMap[color]];
 	while (length-- > 0) {
-		*dst = paletteTransparencyLookup[*dst][color];
+		*dst = blends[*dst];
 		++dst;
 	}
 }
 
+/**
+ * @brief Blends the mapped pixels with the destination, in groups of 4 for the same reason as `BlitPixelsWithMap`.
+ */
 DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void BlitPixelsBlendedWithMap(uint8_t *dst, const uint8_t *src, unsigned length, const uint8_t *colorMap)
 {
+	for (; length >= 4; length -= 4, src += 4, dst += 4) {
+		const uint8_t p0 = paletteTransparencyLookup[dst[0]][colorMap[src[0]]];
+		const uint8_t p1 = paletteTransparencyLookup[dst[1]][colorMap[src[1]]];
+		const uint8_t p2 = paletteTransparencyLookup[dst[2]][colorMap[src[2]]];
+		const uint8_t p3 = paletteTransparencyLookup[dst[3]][colorMap[src[3]]];
+		dst[0] = p0;
+		dst[1] = p1;
+		dst[2] = p2;
+		dst[3] = p3;
+	}
 	while (length-- > 0) {
 		*dst = paletteTransparencyLookup[*dst][colorMap[*src++]];
 		++dst;
@@ -6,12 +6,27 @@
 #include "cl2_render.hpp"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "engine/cel_header.hpp"
 #include "engine/render/common_impl.h"
 #include "engine/render/scrollrt.h"
 #include "utils/attributes.h"
 
+#ifndef DEVILUTIONX_CL2_LIT_FRAME_CACHE_SIZE
+#define DEVILUTIONX_CL2_LIT_FRAME_CACHE_SIZE (1024 * 1024)
+#endif
+
+#ifndef DEVILUTIONX_CL2_OUTLINE_CACHE_SIZE
+#define DEVILUTIONX_CL2_OUTLINE_CACHE_SIZE (256 * 1024)
+#endif
+
 namespace devilution {
 namespace {
 
@@ -97,6 +112,301 @@ void Cl2BlitBlendedTRN(const Surface &out, Point position, const byte *pRLEBytes
 	    out, position, reinterpret_cast<const uint8_t *>(pRLEBytes), nDataSize, nWidth, BlitBlendedWithMap { pTable });
 }
 
+/**
+ * @brief Copies the pixel stream of a CL2 frame, applying the color map to its pixels
+ */
+void Cl2MapFrame(const uint8_t *src, int nDataSize, const uint8_t *colorMap, uint8_t *dst)
+{
+	const uint8_t *srcEnd = src + nDataSize;
+	while (src < srcEnd) {
+		const uint8_t control = *src++;
+		*dst++ = control;
+		if (!IsCl2Opaque(control))
+			continue;
+		if (IsCl2OpaqueFill(control)) {
+			*dst++ = colorMap[*src++];
+			continue;
+		}
+		const uint8_t width = GetCl2OpaquePixelsWidth(control);
+		BlitPixelsWithMap(dst, src, width, colorMap);
+		src += width;
+		dst += width;
+	}
+}
+
+/**
+ * @brief Least recently used cache of CL2 frames with a color map applied to their pixels.
+ *
+ * Entries are keyed by the address of the frame and of the map. The light tables change on every level load, so the
+ * cache is emptied whenever they change. Sprites can also be freed and reloaded mid-level, e.g. when a player changes
+ * armor, so like OutlineCache every entry keeps a copy of its frame that a hit is checked against.
+ */
+class LitFrameCache {
+public:
+	/**
+	 * @brief Returns the mapped pixel stream of the frame, or nullptr if the frame is too large to be cached.
+	 */
+	const uint8_t *Get(const uint8_t *frame, int nDataSize, const uint8_t *colorMap)
+	{
+		if (lightTablesVersion_ != LightTablesVersion) {
+			EvictUntil(0);
+			lightTablesVersion_ = LightTablesVersion;
+		}
+
+		const auto size = static_cast<size_t>(nDataSize);
+		const Key key { frame, colorMap };
+		auto it = index_.find(key);
+		if (it != index_.end()) {
+			Entry &entry = *it->second;
+			if (entry.frame.size() == size && std::memcmp(entry.frame.data(), frame, size) == 0) {
+				entries_.splice(entries_.begin(), entries_, it->second);
+				return entry.data.get();
+			}
+			usedBytes_ -= entry.Size();
+			entries_.erase(it->second);
+			index_.erase(it);
+		}
+
+		if (2 * size > Capacity)
+			return nullptr;
+		EvictUntil(Capacity - 2 * size);
+
+		std::unique_ptr<uint8_t[]> data { new uint8_t[size] };
+		Cl2MapFrame(frame, nDataSize, colorMap, data.get());
+		entries_.push_front(Entry { key, std::vector<uint8_t>(frame, frame + size), std::move(data) });
+		index_.emplace(key, entries_.begin());
+		usedBytes_ += 2 * size;
+		return entries_.front().data.get();
+	}
+
+	/** @brief Drops the entries of the frames within [begin, end). */
+	void Forget(const uint8_t *begin, const uint8_t *end)
+	{
+		for (auto it = entries_.begin(); it != entries_.end();) {
+			if (it->key.frame < begin || it->key.frame >= end) {
+				++it;
+				continue;
+			}
+			usedBytes_ -= it->Size();
+			index_.erase(it->key);
+			it = entries_.erase(it);
+		}
+	}
+
+private:
+	static constexpr size_t Capacity = DEVILUTIONX_CL2_LIT_FRAME_CACHE_SIZE;
+
+	struct Key {
+		const uint8_t *frame;
+		const uint8_t *colorMap;
+
+		bool operator==(const Key &other) const
+		{
+			return frame == other.frame && colorMap == other.colorMap;
+		}
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key &key) const
+		{
+			return std::hash<const void *> {}(key.frame) ^ (std::hash<const void *> {}(key.colorMap) * 31);
+		}
+	};
+
+	struct Entry {
+		Key key;
+		/** @brief The frame the mapped pixels were made from. */
+		std::vector<uint8_t> frame;
+		std::unique_ptr<uint8_t[]> data;
+
+		size_t Size() const
+		{
+			return 2 * frame.size();
+		}
+	};
+
+	void EvictUntil(size_t maxUsedBytes)
+	{
+		while (usedBytes_ > maxUsedBytes) {
+			const Entry &entry = entries_.back();
+			usedBytes_ -= entry.Size();
+			index_.erase(entry.key);
+			entries_.pop_back();
+		}
+	}
+
+	/** Most recently used frame first */
+	std::list<Entry> entries_;
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+	size_t usedBytes_ = 0;
+	uint32_t lightTablesVersion_ = 0;
+};
+
+LitFrameCache LitFrames;
+
+/** @brief Horizontal run of outline pixels, relative to the bottom-left pixel of the frame. */
+struct OutlineSpan {
+	int16_t y;
+	int16_t x;
+	int16_t width;
+};
+
+/**
+ * @brief Computes the outline of a CL2 frame: every pixel next to one of its pixels that isn't transparent or color 0.
+ */
+std::vector<OutlineSpan> Cl2ComputeOutline(const uint8_t *src, int nDataSize, int width)
+{
+	// Pixels of the frame that cast an outline, from the bottom row up.
+	std::vector<bool> solid;
+	const uint8_t *srcEnd = src + nDataSize;
+	while (src < srcEnd) {
+		const BlitCommand cmd = Cl2GetBlitCommand(src);
+		switch (cmd.type) {
+		case BlitType::Transparent:
+			solid.insert(solid.end(), cmd.length, false);
+			break;
+		case BlitType::Fill:
+			solid.insert(solid.end(), cmd.length, cmd.color != 0);
+			break;
+		case BlitType::Pixels:
+			for (const uint8_t *pixel = cmd.srcEnd - cmd.length; pixel != cmd.srcEnd; pixel++)
+				solid.push_back(*pixel != 0);
+			break;
+		}
+		src = cmd.srcEnd;
+	}
+	const int height = (static_cast<int>(solid.size()) + width - 1) / width;
+
+	// The outline extends one pixel past the frame on every side.
+	const int maskWidth = width + 2;
+	std::vector<bool> mask(static_cast<size_t>(maskWidth) * (height + 2));
+	for (size_t i = 0; i < solid.size(); i++) {
+		if (!solid[i])
+			continue;
+		const size_t center = (i / width + 1) * maskWidth + i % width + 1;
+		mask[center - maskWidth] = true;
+		mask[center - 1] = true;
+		mask[center + 1] = true;
+		mask[center + maskWidth] = true;
+	}
+
+	std::vector<OutlineSpan> spans;
+	for (int row = 0; row < height + 2; row++) {
+		const size_t rowStart = static_cast<size_t>(row) * maskWidth;
+		for (int x = 0; x < maskWidth;) {
+			if (!mask[rowStart + x]) {
+				x++;
+				continue;
+			}
+			const int spanStart = x;
+			while (x < maskWidth && mask[rowStart + x])
+				x++;
+			spans.push_back(OutlineSpan { static_cast<int16_t>(1 - row), static_cast<int16_t>(spanStart - 1), static_cast<int16_t>(x - spanStart) });
+		}
+	}
+	return spans;
+}
+
+void DrawOutlineSpans(const Surface &out, Point position, const std::vector<OutlineSpan> &spans, uint8_t color)
+{
+	const int dstWidth = out.w();
+	const int dstHeight = out.h();
+	for (const OutlineSpan &span : spans) {
+		const int y = position.y + span.y;
+		if (y < 0 || y >= dstHeight)
+			continue;
+		const int begin = std::max(position.x + span.x, 0);
+		const int end = std::min(position.x + span.x + span.width, dstWidth);
+		if (begin < end)
+			std::memset(&out[Point { begin, y }], color, end - begin);
+	}
+}
+
+/**
+ * @brief Least recently used cache of the outlines of CL2 frames.
+ *
+ * Entries are keyed by the address of the frame. Sprites can be freed and reloaded mid-level, e.g. when a player
+ * changes armor, so every entry keeps a copy of its frame that a hit is checked against.
+ */
+class OutlineCache {
+public:
+	/**
+	 * @brief Returns the outline of the frame, or nullptr if the frame is too large to be cached.
+	 */
+	const std::vector<OutlineSpan> *Get(const uint8_t *frame, int nDataSize, int width)
+	{
+		const auto size = static_cast<size_t>(nDataSize);
+		auto it = index_.find(frame);
+		if (it != index_.end()) {
+			Entry &entry = *it->second;
+			if (entry.frame.size() == size && entry.width == width && std::memcmp(entry.frame.data(), frame, size) == 0) {
+				entries_.splice(entries_.begin(), entries_, it->second);
+				return &entry.spans;
+			}
+			usedBytes_ -= entry.Size();
+			entries_.erase(it->second);
+			index_.erase(it);
+		}
+
+		Entry entry { frame, width, std::vector<uint8_t>(frame, frame + size), Cl2ComputeOutline(frame, nDataSize, width) };
+		const size_t entrySize = entry.Size();
+		if (entrySize > Capacity)
+			return nullptr;
+		EvictUntil(Capacity - entrySize);
+
+		entries_.push_front(std::move(entry));
+		index_.emplace(frame, entries_.begin());
+		usedBytes_ += entrySize;
+		return &entries_.front().spans;
+	}
+
+	/** @brief Drops the entries of the frames within [begin, end). */
+	void Forget(const uint8_t *begin, const uint8_t *end)
+	{
+		for (auto it = entries_.begin(); it != entries_.end();) {
+			if (it->key < begin || it->key >= end) {
+				++it;
+				continue;
+			}
+			usedBytes_ -= it->Size();
+			index_.erase(it->key);
+			it = entries_.erase(it);
+		}
+	}
+
+private:
+	static constexpr size_t Capacity = DEVILUTIONX_CL2_OUTLINE_CACHE_SIZE;
+
+	struct Entry {
+		const uint8_t *key;
+		int width;
+		std::vector<uint8_t> frame;
+		std::vector<OutlineSpan> spans;
+
+		size_t Size() const
+		{
+			return frame.size() + spans.size() * sizeof(OutlineSpan);
+		}
+	};
+
+	void EvictUntil(size_t maxUsedBytes)
+	{
+		while (usedBytes_ > maxUsedBytes) {
+			const Entry &entry = entries_.back();
+			usedBytes_ -= entry.Size();
+			index_.erase(entry.key);
+			entries_.pop_back();
+		}
+	}
+
+	/** Most recently used frame first */
+	std::list<Entry> entries_;
+	std::unordered_map<const uint8_t *, std::list<Entry>::iterator> index_;
+	size_t usedBytes_ = 0;
+};
+
+OutlineCache Outlines;
+
 template <bool Fill, bool North, bool West, bool South, bool East, bool SkipColorIndexZero>
 uint8_t *RenderCl2OutlinePixelsCheckFirstColumn(
     uint8_t *dst, int dstPitch, int dstX,
@@ -459,6 +769,16 @@ void RenderCl2Outline(const Surface &out, Point position, const uint8_t *src, st
 	}
 }
 
+void RenderCl2OutlineCached(const Surface &out, Point position, const uint8_t *src, int nDataSize, int srcWidth, uint8_t color)
+{
+	const std::vector<OutlineSpan> *spans = Outlines.Get(src, nDataSize, srcWidth);
+	if (spans == nullptr) {
+		RenderCl2Outline</*SkipColorIndexZero=*/true>(out, position, src, nDataSize, srcWidth, color);
+		return;
+	}
+	DrawOutlineSpans(out, position, *spans, color);
+}
+
 } // namespace
 
 void Cl2ApplyTrans(byte *p, const std::array<uint8_t, 256> &ttbl, int numFrames)
@@ -547,7 +867,7 @@ void Cl2DrawOutline(const Surface &out, uint8_t col, Point position, CelSprite c
 	int nDataSize;
 	const byte *src = CelGetFrameClipped(cel.Data(), frame, &nDataSize);
 
-	RenderCl2Outline</*SkipColorIndexZero=*/true>(out, position, reinterpret_cast<const uint8_t *>(src), nDataSize, cel.Width(frame), col);
+	RenderCl2OutlineCached(out, position, reinterpret_cast<const uint8_t *>(src), nDataSize, cel.Width(frame), col);
 }
 
 void Cl2DrawOutlineSkipColorZero(const Surface &out, uint8_t col, Point position, CelSprite cel, int frame)
@@ -557,7 +877,7 @@ void Cl2DrawOutlineSkipColorZero(const Surface &out, uint8_t col, Point position
 	int nDataSize;
 	const byte *src = CelGetFrameClipped(cel.Data(), frame, &nDataSize);
 
-	RenderCl2Outline</*SkipColorIndexZero=*/true>(out, position, reinterpret_cast<const uint8_t *>(src), nDataSize, cel.Width(frame), col);
+	RenderCl2OutlineCached(out, position, reinterpret_cast<const uint8_t *>(src), nDataSize, cel.Width(frame), col);
 }
 
 void Cl2DrawTRN(const Surface &out, Point position, CelSprite cel, int frame, uint8_t *trn)
@@ -578,4 +898,25 @@ void Cl2DrawBlendedTRN(const Surface &out, Point position, CelSprite cel, int fr
 	Cl2BlitBlendedTRN(out, position, pRLEBytes, nDataSize, cel.Width(frame), trn);
 }
 
+void Cl2DrawTRNCached(const Surface &out, Point position, CelSprite cel, int frame, uint8_t *trn)
+{
+	assert(frame >= 0);
+
+	int nDataSize;
+	const byte *pRLEBytes = CelGetFrameClipped(cel.Data(), frame, &nDataSize);
+	const uint8_t *mapped = LitFrames.Get(reinterpret_cast<const uint8_t *>(pRLEBytes), nDataSize, trn);
+	if (mapped == nullptr) {
+		Cl2BlitTRN(out, position, pRLEBytes, nDataSize, cel.Width(frame), trn);
+		return;
+	}
+	Cl2Blit(out, position, reinterpret_cast<const byte *>(mapped), nDataSize, cel.Width(frame));
+}
+
+void Cl2ForgetCachedFrames(const byte *data, size_t size)
+{
+	const auto *begin = reinterpret_cast<const uint8_t *>(data);
+	LitFrames.Forget(begin, begin + size);
+	Outlines.Forget(begin, begin + size);
+}
+
 } // namespace devilution
@@ -5,6 +5,7 @@
  */
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 #include <array>
@@ -83,6 +84,22 @@ inline void RenderCl2SpriteWithTRN(const Surface &out, CelFrameWithHeight cel, P
 
 void Cl2DrawBlendedTRN(const Surface &out, Point position, CelSprite cel, int frame, uint8_t *trn);
 
+/**
+ * @brief Same as Cl2DrawTRN, but keeps the frame with the TRN applied in a cache so that drawing it again is a plain blit
+ *
+ * Meant for frames that are drawn with the same TRN over and over, like a pack of monsters under the same light.
+ * A frame that changed since it was cached is translated again. The TRN must not change until the light tables change,
+ * which they do on every level load.
+ */
+void Cl2DrawTRNCached(const Surface &out, Point position, CelSprite cel, int frame, uint8_t *trn);
+
+/**
+ * @brief Drops the cached translated frames and outlines of a sprite, call it before the sprite's data is freed.
+ * @param data The sprite's data
+ * @param size Size of the data in bytes
+ */
+void Cl2ForgetCachedFrames(const byte *data, size_t size);
+
 // defined in scrollrt.cpp
 extern int LightTableIndex;
 
@@ -15,6 +15,7 @@
 #endif
 #include "options.h"
 #include "utils/attributes.h"
+#include "utils/stdcompat/bit.hpp"
 
 namespace devilution {
 
@@ -382,41 +383,57 @@ DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void RenderLineOpaque(std::uint8_t *dst, con
 }
 
 template <LightType Light>
-DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void RenderLineBlended(std::uint8_t *dst, const std::uint8_t *src, std::uint_fast8_t n, const std::uint8_t *tbl, std::uint32_t mask)
+DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void RenderLineTransparent(std::uint8_t *dst, const std::uint8_t *src, std::uint_fast8_t n, const std::uint8_t *tbl)
 {
 #ifndef DEBUG_RENDER_COLOR
 	if (Light == LightType::FullyDark) {
-		for (size_t i = 0; i < n; i++, mask <<= 1) {
-			if ((mask & 0x80000000) != 0)
-				dst[i] = 0;
-			else
-				dst[i] = paletteTransparencyLookup[0][dst[i]];
+		for (size_t i = 0; i < n; i++) {
+			dst[i] = paletteTransparencyLookup[0][dst[i]];
 		}
 	} else if (Light == LightType::FullyLit) {
-		for (size_t i = 0; i < n; i++, mask <<= 1) {
-			if ((mask & 0x80000000) != 0)
-				dst[i] = src[i];
-			else
-				dst[i] = paletteTransparencyLookup[dst[i]][src[i]];
+		for (size_t i = 0; i < n; i++) {
+			dst[i] = paletteTransparencyLookup[dst[i]][src[i]];
 		}
 	} else { // Partially lit
-		for (size_t i = 0; i < n; i++, mask <<= 1) {
-			if ((mask & 0x80000000) != 0)
-				dst[i] = tbl[src[i]];
-			else
-				dst[i] = paletteTransparencyLookup[dst[i]][tbl[src[i]]];
+		for (size_t i = 0; i < n; i++) {
+			dst[i] = paletteTransparencyLookup[dst[i]][tbl[src[i]]];
 		}
 	}
 #else
-	for (size_t i = 0; i < n; i++, mask <<= 1) {
-		if ((mask & 0x80000000) != 0)
-			dst[i] = tbl[DBGCOLOR];
-		else
-			dst[i] = paletteTransparencyLookup[dst[i]][tbl[DBGCOLOR]];
+	for (size_t i = 0; i < n; i++) {
+		dst[i] = paletteTransparencyLookup[dst[i]][tbl[DBGCOLOR]];
 	}
 #endif
 }
 
+template <LightType Light>
+DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void RenderLineBlended(std::uint8_t *dst, const std::uint8_t *src, std::uint_fast8_t n, const std::uint8_t *tbl, std::uint32_t mask)
+{
+	// All of the masks are made of at most a few runs of opaque and transparent pixels,
+	// so rather than testing every bit we render each run with a branch-free inner loop.
+	// Every run is clamped to the pixels left, so the bits past `n` don't matter.
+	while (true) {
+		std::uint_fast8_t run = std::min<std::uint_fast8_t>(countl_one(mask), n);
+		if (run != 0) {
+			RenderLineOpaque<Light>(dst, src, run, tbl);
+			n -= run;
+			if (n == 0)
+				return;
+			dst += run;
+			src += run;
+			mask <<= run;
+		}
+		run = std::min<std::uint_fast8_t>(countl_zero(mask), n);
+		RenderLineTransparent<Light>(dst, src, run, tbl);
+		n -= run;
+		if (n == 0)
+			return;
+		dst += run;
+		src += run;
+		mask <<= run;
+	}
+}
+
 template <TransparencyType Transparency, LightType Light>
 DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void RenderLine(std::uint8_t *dst, const std::uint8_t *src, std::uint_fast8_t n, const std::uint8_t *tbl, std::uint32_t mask)
 {
@@ -1083,7 +1100,7 @@ DVL_ATTRIBUTE_HOT void RenderTileType(TileType tile, std::uint8_t *dst, int dstP
 }
 
 /** Returns the mask that defines what parts of the tile are opaque. */
-const std::uint32_t *GetMask(TileType tile)
+const std::uint32_t *GetMask(TileType tile, MaskType maskType)
 {
 #ifdef _DEBUG
 	if ((SDL_GetModState() & KMOD_ALT) != 0) {
@@ -1091,27 +1108,27 @@ const std::uint32_t *GetMask(TileType tile)
 	}
 #endif
 
-	if (cel_transparency_active) {
-		if (arch_draw_type == 0) {
-			return &WallMaskFullyTrasparent[TILE_HEIGHT - 1];
-		}
-		if (arch_draw_type == 1 && tile != TileType::LeftTriangle) {
-			if (TileHasAny(level_piece_id, TileProperties::TransparentLeft)) {
-				return &LeftMaskTransparent[TILE_HEIGHT - 1];
-			}
-		}
-		if (arch_draw_type == 2 && tile != TileType::RightTriangle) {
-			if (TileHasAny(level_piece_id, TileProperties::TransparentRight)) {
-				return &RightMaskTransparent[TILE_HEIGHT - 1];
-			}
-		}
-	} else if (arch_draw_type != 0 && cel_foliage_active) {
+	switch (maskType) {
+	case MaskType::Transparent:
+		return &WallMaskFullyTrasparent[TILE_HEIGHT - 1];
+	case MaskType::Left:
+		if (tile == TileType::LeftTriangle)
+			break;
+		return &LeftMaskTransparent[TILE_HEIGHT - 1];
+	case MaskType::Right:
+		if (tile == TileType::RightTriangle)
+			break;
+		return &RightMaskTransparent[TILE_HEIGHT - 1];
+	case MaskType::LeftFoliage:
 		if (tile != TileType::TransparentSquare)
 			return nullptr;
-		if (arch_draw_type == 1)
-			return &LeftFoliageMask[TILE_HEIGHT - 1];
-		if (arch_draw_type == 2)
-			return &RightFoliageMask[TILE_HEIGHT - 1];
+		return &LeftFoliageMask[TILE_HEIGHT - 1];
+	case MaskType::RightFoliage:
+		if (tile != TileType::TransparentSquare)
+			return nullptr;
+		return &RightFoliageMask[TILE_HEIGHT - 1];
+	case MaskType::Solid:
+		break;
 	}
 	return &SolidMask[TILE_HEIGHT - 1];
 }
@@ -1208,10 +1225,10 @@ void RenderBlackTileFull(std::uint8_t *dst, int dstPitch)
 
 } // namespace
 
-void RenderTile(const Surface &out, Point position)
+void RenderTile(const Surface &out, Point position, uint32_t levelCelBlock, MaskType maskType, int lightTableIndex)
 {
-	const auto tile = static_cast<TileType>((level_cel_block & 0x7000) >> 12);
-	const auto *mask = GetMask(tile);
+	const auto tile = static_cast<TileType>((levelCelBlock & 0x7000) >> 12);
+	const auto *mask = GetMask(tile, maskType);
 	if (mask == nullptr)
 		return;
 
@@ -1229,25 +1246,25 @@ void RenderTile(const Surface &out, Point position)
 	if (clip.width <= 0 || clip.height <= 0)
 		return;
 
-	const std::uint8_t *tbl = &LightTables[256 * LightTableIndex];
+	const std::uint8_t *tbl = &LightTables[256 * lightTableIndex];
 	const auto *pFrameTable = reinterpret_cast<const std::uint32_t *>(pDungeonCels.get());
-	const auto *src = reinterpret_cast<const std::uint8_t *>(&pDungeonCels[SDL_SwapLE32(pFrameTable[level_cel_block & 0xFFF])]);
+	const auto *src = reinterpret_cast<const std::uint8_t *>(&pDungeonCels[SDL_SwapLE32(pFrameTable[levelCelBlock & 0xFFF])]);
 	std::uint8_t *dst = out.at(static_cast<int>(position.x + clip.left), static_cast<int>(position.y - clip.bottom));
 	const auto dstPitch = out.pitch();
 
 	if (mask == &SolidMask[TILE_HEIGHT - 1]) {
-		if (LightTableIndex == LightsMax) {
+		if (lightTableIndex == LightsMax) {
 			RenderTileType<TransparencyType::Solid, LightType::FullyDark>(tile, dst, dstPitch, src, mask, tbl, clip);
-		} else if (LightTableIndex == 0) {
+		} else if (lightTableIndex == 0) {
 			RenderTileType<TransparencyType::Solid, LightType::FullyLit>(tile, dst, dstPitch, src, mask, tbl, clip);
 		} else {
 			RenderTileType<TransparencyType::Solid, LightType::PartiallyLit>(tile, dst, dstPitch, src, mask, tbl, clip);
 		}
 	} else {
 		mask -= clip.bottom;
-		if (LightTableIndex == LightsMax) {
+		if (lightTableIndex == LightsMax) {
 			RenderTileType<TransparencyType::Blended, LightType::FullyDark>(tile, dst, dstPitch, src, mask, tbl, clip);
-		} else if (LightTableIndex == 0) {
+		} else if (lightTableIndex == 0) {
 			RenderTileType<TransparencyType::Blended, LightType::FullyLit>(tile, dst, dstPitch, src, mask, tbl, clip);
 		} else {
 			RenderTileType<TransparencyType::Blended, LightType::PartiallyLit>(tile, dst, dstPitch, src, mask, tbl, clip);
@@ -1255,6 +1272,12 @@ void RenderTile(const Surface &out, Point position)
 	}
 }
 
+bool IsTriangleTile(uint32_t levelCelBlock)
+{
+	const auto tile = static_cast<TileType>((levelCelBlock & 0x7000) >> 12);
+	return tile == TileType::LeftTriangle || tile == TileType::RightTriangle;
+}
+
 void world_draw_black_tile(const Surface &out, int sx, int sy)
 {
 #ifdef DEBUG_RENDER_OFFSET_X
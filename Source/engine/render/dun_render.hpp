@@ -5,16 +5,60 @@
  */
 #pragma once
 
+#include <cstdint>
+
 #include "engine.h"
 
 namespace devilution {
 
 /**
- * @brief Blit current world CEL to the given buffer
+ * @brief Specifies which parts of a micro tile are drawn opaque and which are blended with what is already on screen.
+ */
+enum class MaskType : uint8_t {
+	/** @brief The whole tile is opaque. */
+	Solid,
+	/** @brief The whole tile is blended. */
+	Transparent,
+	/** @brief The transparent variant of the left wall mask. */
+	Left,
+	/** @brief The transparent variant of the right wall mask. */
+	Right,
+	/** @brief Only the foliage overlapping the previous tile on the left is drawn. */
+	LeftFoliage,
+	/** @brief Only the foliage overlapping the previous tile on the right is drawn. */
+	RightFoliage,
+};
+
+/**
+ * @brief Blit a world CEL to the given buffer
  * @param out Target buffer
  * @param position Target buffer coordinates
+ * @param levelCelBlock MIN block of the level CEL file (frameNum := block & 0x0FFF, frameType := block & 0x7000 >> 12)
+ * @param maskType Which parts of the tile are blended
+ * @param lightTableIndex Index of the light table to draw with, as found in dLight
+ */
+void RenderTile(const Surface &out, Point position, uint32_t levelCelBlock, MaskType maskType, int lightTableIndex);
+
+/** @brief Everything RenderTile needs besides the target, so that a tile can be described once and drawn later. */
+struct TileDrawInfo {
+	/** @brief MIN block of the level CEL file, see RenderTile */
+	uint32_t levelCelBlock;
+	MaskType maskType;
+	/** @brief Index of the light table to draw with, as found in dLight */
+	int lightTableIndex;
+};
+
+inline void RenderTile(const Surface &out, Point position, const TileDrawInfo &tile)
+{
+	RenderTile(out, position, tile.levelCelBlock, tile.maskType, tile.lightTableIndex);
+}
+
+/**
+ * @brief Whether the micro tile is a triangle, which only draws within its half of the floor diamond.
+ *
+ * The other types also draw over the corners of the neighbouring tiles.
  */
-void RenderTile(const Surface &out, Point position);
+bool IsTriangleTile(uint32_t levelCelBlock);
 
 /**
  * @brief Render a black 64x31 tile ◆
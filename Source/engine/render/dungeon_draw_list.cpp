@@ -0,0 +1,37 @@
+/**
+ * @file dungeon_draw_list.cpp
+ *
+ * Execution of the recorded draw calls of the dungeon view.
+ */
+#include "engine/render/dungeon_draw_list.hpp"
+
+namespace devilution {
+
+void DungeonDrawList::Execute(const Surface &out) const
+{
+	for (const Command &command : commands_) {
+		const int frame = static_cast<int>(command.frame);
+		switch (command.type) {
+		case CommandType::Tile:
+			RenderTile(out, command.position, command.frame, static_cast<MaskType>(command.param), command.lightTableIndex);
+			break;
+		case CommandType::Sprite:
+			Cl2Draw(out, command.position, command.cel, frame);
+			break;
+		case CommandType::SpriteTRN:
+			Cl2DrawTRN(out, command.position, command.cel, frame, command.trn);
+			break;
+		case CommandType::SpriteTRNCached:
+			Cl2DrawTRNCached(out, command.position, command.cel, frame, command.trn);
+			break;
+		case CommandType::SpriteBlendedTRN:
+			Cl2DrawBlendedTRN(out, command.position, command.cel, frame, command.trn);
+			break;
+		case CommandType::Outline:
+			Cl2DrawOutlineSkipColorZero(out, command.param, command.position, command.cel, frame);
+			break;
+		}
+	}
+}
+
+} // namespace devilution
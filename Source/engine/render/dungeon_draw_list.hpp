@@ -0,0 +1,135 @@
+/**
+ * @file dungeon_draw_list.hpp
+ *
+ * Recorded draw calls of the tiles and sprites that make up the dungeon view.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "engine.h"
+#include "engine/cel_sprite.hpp"
+#include "engine/point.hpp"
+#include "engine/render/cl2_render.hpp"
+#include "engine/render/dun_render.hpp"
+#include "lighting.h"
+
+namespace devilution {
+
+/**
+ * @brief The draw calls of the dungeon view, in the order they have to be drawn in.
+ *
+ * Recording resolves everything that depends on the game state (visibility, lighting, translations), so executing
+ * the list only reads the sprites and writes the output buffer. The commands mostly overlap their neighbours,
+ * so they have to be executed in the order they were recorded in.
+ */
+class DungeonDrawList {
+public:
+	void Clear()
+	{
+		commands_.clear();
+	}
+
+	[[nodiscard]] size_t size() const
+	{
+		return commands_.size();
+	}
+
+	/** @brief Records a `RenderTile` call. */
+	void AddTile(Point position, uint32_t levelCelBlock, MaskType maskType, int lightTableIndex)
+	{
+		commands_.push_back(Command { CommandType::Tile, static_cast<uint8_t>(maskType), static_cast<uint8_t>(lightTableIndex), levelCelBlock,
+		    position, CelSprite { nullptr, uint16_t { 0 } }, nullptr });
+	}
+
+	/** @brief Records a `Cl2Draw` call. */
+	void AddSprite(Point position, CelSprite cel, int frame)
+	{
+		Add(CommandType::Sprite, position, cel, frame, nullptr);
+	}
+
+	/** @brief Records a `Cl2DrawTRN` call. */
+	void AddSpriteTRN(Point position, CelSprite cel, int frame, uint8_t *trn)
+	{
+		Add(CommandType::SpriteTRN, position, cel, frame, trn);
+	}
+
+	/** @brief Records a `Cl2DrawTRNCached` call. */
+	void AddSpriteTRNCached(Point position, CelSprite cel, int frame, uint8_t *trn)
+	{
+		Add(CommandType::SpriteTRNCached, position, cel, frame, trn);
+	}
+
+	/** @brief Records a `Cl2DrawLight` call with the current `LightTableIndex`. */
+	void AddSpriteLight(Point position, CelSprite cel, int frame)
+	{
+		if (LightTableIndex != 0)
+			AddSpriteTRN(position, cel, frame, &LightTables[LightTableIndex * 256]);
+		else
+			AddSprite(position, cel, frame);
+	}
+
+	/**
+	 * @brief Same as AddSpriteLight, but the lit frame is drawn from the cache of `Cl2DrawTRNCached`.
+	 *
+	 * For sprites that stay on screen under the same light for many frames, like corpses.
+	 */
+	void AddSpriteLightCached(Point position, CelSprite cel, int frame)
+	{
+		if (LightTableIndex != 0)
+			AddSpriteTRNCached(position, cel, frame, &LightTables[LightTableIndex * 256]);
+		else
+			AddSprite(position, cel, frame);
+	}
+
+	/** @brief Records a `Cl2DrawLightBlended` call with the current `LightTableIndex`. */
+	void AddSpriteLightBlended(Point position, CelSprite cel, int frame)
+	{
+		Add(CommandType::SpriteBlendedTRN, position, cel, frame, &LightTables[LightTableIndex * 256]);
+	}
+
+	/** @brief Records a `Cl2DrawOutlineSkipColorZero` call. */
+	void AddOutline(uint8_t col, Point position, CelSprite cel, int frame)
+	{
+		commands_.push_back(Command { CommandType::Outline, col, 0, static_cast<uint32_t>(frame), position, cel, nullptr });
+	}
+
+	/**
+	 * @brief Draws the recorded commands in order.
+	 * @param out Target buffer, the recorded positions are relative to it
+	 */
+	void Execute(const Surface &out) const;
+
+private:
+	enum class CommandType : uint8_t {
+		Tile,
+		Sprite,
+		SpriteTRN,
+		SpriteTRNCached,
+		SpriteBlendedTRN,
+		Outline,
+	};
+
+	struct Command {
+		CommandType type;
+		/** @brief The mask type of tiles or the color of outlines. */
+		uint8_t param;
+		uint8_t lightTableIndex;
+		/** @brief The level CEL block of tiles or the frame of sprites. */
+		uint32_t frame;
+		Point position;
+		CelSprite cel;
+		uint8_t *trn;
+	};
+
+	void Add(CommandType type, Point position, CelSprite cel, int frame, uint8_t *trn)
+	{
+		commands_.push_back(Command { type, 0, 0, static_cast<uint32_t>(frame), position, cel, trn });
+	}
+
+	std::vector<Command> commands_;
+};
+
+} // namespace devilution
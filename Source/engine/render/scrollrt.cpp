@@ -5,6 +5,11 @@
  */
 #include "engine/render/scrollrt.h"
 
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
 #include "DiabloUI/ui_flags.hpp"
 #include "automap.h"
 #include "controls/plrctrls.h"
@@ -13,8 +18,10 @@
 #include "dead.h"
 #include "doom.h"
 #include "engine/dx.h"
+#include "engine/frame_timings.hpp"
 #include "engine/render/cl2_render.hpp"
 #include "engine/render/dun_render.hpp"
+#include "engine/render/dungeon_draw_list.hpp"
 #include "engine/render/text_render.hpp"
 #include "engine/trn.hpp"
 #include "error.h"
@@ -29,6 +36,7 @@
 #include "miniwin/misc_msg.h"
 #endif
 #include "missiles.h"
+#include "multi.h"
 #include "nthread.h"
 #include "options.h"
 #include "panels/charpanel.hpp"
@@ -43,8 +51,13 @@
 #include "utils/bitset2d.hpp"
 #include "utils/display.h"
 #include "utils/endian.hpp"
+#include "utils/frame_arena.hpp"
 #include "utils/log.hpp"
+#include "utils/perf_scope.hpp"
+#include "utils/sdl_geometry.h"
+#include "utils/stdcompat/optional.hpp"
 #include "utils/str_cat.hpp"
+#include "utils/thread_pool.hpp"
 
 #ifdef _DEBUG
 #include "debug.h"
@@ -57,37 +70,23 @@ namespace devilution {
  */
 int LightTableIndex;
 
-/**
- * Specifies the current MIN block of the level CEL file, as used during rendering of the level tiles.
- *
- * frameNum  := block & 0x0FFF
- * frameType := block & 0x7000 >> 12
- */
-uint32_t level_cel_block;
 bool AutoMapShowItems;
-/**
- * Specifies the type of arches to render.
- */
-char arch_draw_type;
 /**
  * Specifies whether transparency is active for the current CEL file being decoded.
  */
 bool cel_transparency_active;
-/**
- * Specifies whether foliage (tile has extra content that overlaps previous tile) being rendered.
- */
-bool cel_foliage_active = false;
-/**
- * Specifies the current dungeon piece ID of the level, as used during rendering of the level tiles.
- */
-int level_piece_id;
 
 // DevilutionX extension.
 extern void DrawControllerModifierHints(const Surface &out);
 
 bool frameflag;
+bool ShowNetworkStats;
+bool ShowFrameTimings;
 
 namespace {
+
+/** @brief Set while the dynamic resolution renders the view at half resolution, see UpdateDynamicResolution. */
+bool DynamicZoom;
 /**
  * @brief Hash algorithm for point
  */
@@ -310,12 +309,12 @@ void DrawCursor(const Surface &out)
 
 /**
  * @brief Render a missile sprite
- * @param out Output buffer
+ * @param drawList Draw list to record to
  * @param missile Pointer to Missile struct
  * @param targetBufferPosition Output buffer coordinate
  * @param pre Is the sprite in the background
  */
-void DrawMissilePrivate(const Surface &out, const Missile &missile, Point targetBufferPosition, bool pre)
+void DrawMissilePrivate(DungeonDrawList &drawList, const Missile &missile, Point targetBufferPosition, bool pre)
 {
 	if (missile._miPreFlag != pre || !missile._miDrawFlag)
 		return;
@@ -334,36 +333,36 @@ void DrawMissilePrivate(const Surface &out, const Missile &missile, Point target
 	const Point missileRenderPosition { targetBufferPosition + missile.position.offsetForRendering - Displacement { missile._miAnimWidth2, 0 } };
 	CelSprite cel { missile._miAnimData, missile._miAnimWidth };
 	if (missile._miUniqTrans != 0)
-		Cl2DrawTRN(out, missileRenderPosition, cel, nCel, Monsters[missile._misource].uniqueMonsterTRN.get());
+		drawList.AddSpriteTRNCached(missileRenderPosition, cel, nCel, Monsters[missile._misource].uniqueMonsterTRN.get());
 	else if (missile._miLightFlag)
-		Cl2DrawLight(out, missileRenderPosition, cel, nCel);
+		drawList.AddSpriteLight(missileRenderPosition, cel, nCel);
 	else
-		Cl2Draw(out, missileRenderPosition, cel, nCel);
+		drawList.AddSprite(missileRenderPosition, cel, nCel);
 }
 
 /**
  * @brief Render a missile sprites for a given tile
- * @param out Output buffer
+ * @param drawList Draw list to record to
  * @param tilePosition dPiece coordinates
  * @param targetBufferPosition Output buffer coordinates
  * @param pre Is the sprite in the background
  */
-void DrawMissile(const Surface &out, Point tilePosition, Point targetBufferPosition, bool pre)
+void DrawMissile(DungeonDrawList &drawList, Point tilePosition, Point targetBufferPosition, bool pre)
 {
 	const auto range = MissilesAtRenderingTile.equal_range(tilePosition);
 	for (auto it = range.first; it != range.second; it++) {
-		DrawMissilePrivate(out, *it->second, targetBufferPosition, pre);
+		DrawMissilePrivate(drawList, *it->second, targetBufferPosition, pre);
 	}
 }
 
 /**
  * @brief Render a monster sprite
- * @param out Output buffer
+ * @param drawList Draw list to record to
  * @param tilePosition dPiece coordinates
  * @param targetBufferPosition Output buffer coordinates
  * @param monster Monster reference
  */
-void DrawMonster(const Surface &out, Point tilePosition, Point targetBufferPosition, const Monster &monster)
+void DrawMonster(DungeonDrawList &drawList, Point tilePosition, Point targetBufferPosition, const Monster &monster)
 {
 	if (!monster.animInfo.celSprite) {
 		Log("Draw Monster \"{}\": NULL Cel Buffer", monster.name());
@@ -446,8 +445,9 @@ void DrawMonster(const Surface &out, Point tilePosition, Point targetBufferPosit
 
 	const auto &cel = *monster.animInfo.celSprite;
 
+	// Packs of the same monster are drawn with the same frames and lights, so the lit frames are cached.
 	if (!IsTileLit(tilePosition)) {
-		Cl2DrawTRN(out, targetBufferPosition, cel, nCel, GetInfravisionTRN());
+		drawList.AddSpriteTRNCached(targetBufferPosition, cel, nCel, GetInfravisionTRN());
 		return;
 	}
 	uint8_t *trn = nullptr;
@@ -457,57 +457,59 @@ void DrawMonster(const Surface &out, Point tilePosition, Point targetBufferPosit
 		trn = GetStoneTRN();
 	if (MyPlayer->_pInfraFlag && LightTableIndex > 8)
 		trn = GetInfravisionTRN();
+	if (trn == nullptr && LightTableIndex != 0)
+		trn = &LightTables[LightTableIndex * 256];
 	if (trn != nullptr)
-		Cl2DrawTRN(out, targetBufferPosition, cel, nCel, trn);
+		drawList.AddSpriteTRNCached(targetBufferPosition, cel, nCel, trn);
 	else
-		Cl2DrawLight(out, targetBufferPosition, cel, nCel);
+		drawList.AddSprite(targetBufferPosition, cel, nCel);
 }
 
 /**
  * @brief Helper for rendering a specific player icon (Mana Shield or Reflect)
  */
-void DrawPlayerIconHelper(const Surface &out, missile_graphic_id missileGraphicId, Point position, bool lighting, bool infraVision)
+void DrawPlayerIconHelper(DungeonDrawList &drawList, missile_graphic_id missileGraphicId, Point position, bool lighting, bool infraVision)
 {
 	position.x -= MissileSpriteData[missileGraphicId].animWidth2;
 
 	const CelSprite cel = MissileSpriteData[missileGraphicId].Sprite();
 
 	if (!lighting) {
-		Cl2Draw(out, position, cel, 0);
+		drawList.AddSprite(position, cel, 0);
 		return;
 	}
 
 	if (infraVision) {
-		Cl2DrawTRN(out, position, cel, 0, GetInfravisionTRN());
+		drawList.AddSpriteTRNCached(position, cel, 0, GetInfravisionTRN());
 		return;
 	}
 
-	Cl2DrawLight(out, position, cel, 0);
+	drawList.AddSpriteLight(position, cel, 0);
 }
 
 /**
  * @brief Helper for rendering player icons (Mana Shield and Reflect)
- * @param out Output buffer
+ * @param drawList Draw list to record to
  * @param player Player reference
  * @param position Output buffer coordinates
  * @param infraVision Should infravision be applied
  */
-void DrawPlayerIcons(const Surface &out, const Player &player, Point position, bool infraVision)
+void DrawPlayerIcons(DungeonDrawList &drawList, const Player &player, Point position, bool infraVision)
 {
 	if (player.pManaShield)
-		DrawPlayerIconHelper(out, MFILE_MANASHLD, position, &player != MyPlayer, infraVision);
+		DrawPlayerIconHelper(drawList, MFILE_MANASHLD, position, &player != MyPlayer, infraVision);
 	if (player.wReflections > 0)
-		DrawPlayerIconHelper(out, MFILE_REFLECT, position + Displacement { 0, 16 }, &player != MyPlayer, infraVision);
+		DrawPlayerIconHelper(drawList, MFILE_REFLECT, position + Displacement { 0, 16 }, &player != MyPlayer, infraVision);
 }
 
 /**
  * @brief Render a player sprite
- * @param out Output buffer
+ * @param drawList Draw list to record to
  * @param player Player reference
  * @param tilePosition dPiece coordinates
  * @param targetBufferPosition Output buffer coordinates
  */
-void DrawPlayer(const Surface &out, const Player &player, Point tilePosition, Point targetBufferPosition)
+void DrawPlayer(DungeonDrawList &drawList, const Player &player, Point tilePosition, Point targetBufferPosition)
 {
 	if (!IsTileLit(tilePosition) && !MyPlayer->_pInfraFlag && leveltype != DTYPE_TOWN) {
 		return;
@@ -520,6 +522,14 @@ void DrawPlayer(const Surface &out, const Player &player, Point tilePosition, Po
 		sprite = player.previewCelSprite;
 		nCel = 0;
 	}
+	if (player.predictedWalkDirection) {
+		// UpdatePreviewCelSprite loaded the walk graphics, but the graphics budget may have freed them since.
+		const OptionalCelSprite walkSprite = player.AnimationData[static_cast<size_t>(player_graphic::Walk)].GetCelSpritesForDirection(*player.predictedWalkDirection);
+		if (walkSprite) {
+			sprite = walkSprite;
+			nCel = GetPredictedWalkFrame(player);
+		}
+	}
 
 	if (!sprite) {
 		Log("Drawing player {} \"{}\": NULL CelSprite", std::distance(const_cast<const Player *>(&Players[0]), &player), player._pName);
@@ -545,17 +555,17 @@ void DrawPlayer(const Surface &out, const Player &player, Point tilePosition, Po
 	}
 
 	if (pcursplr >= 0 && pcursplr < MAX_PLRS && &player == &Players[pcursplr])
-		Cl2DrawOutlineSkipColorZero(out, 165, spriteBufferPosition, *sprite, nCel);
+		drawList.AddOutline(165, spriteBufferPosition, *sprite, nCel);
 
 	if (&player == MyPlayer) {
-		Cl2Draw(out, spriteBufferPosition, *sprite, nCel);
-		DrawPlayerIcons(out, player, targetBufferPosition, false);
+		drawList.AddSprite(spriteBufferPosition, *sprite, nCel);
+		DrawPlayerIcons(drawList, player, targetBufferPosition, false);
 		return;
 	}
 
 	if (!IsTileLit(tilePosition) || (MyPlayer->_pInfraFlag && LightTableIndex > 8)) {
-		Cl2DrawTRN(out, spriteBufferPosition, *sprite, nCel, GetInfravisionTRN());
-		DrawPlayerIcons(out, player, targetBufferPosition, true);
+		drawList.AddSpriteTRNCached(spriteBufferPosition, *sprite, nCel, GetInfravisionTRN());
+		DrawPlayerIcons(drawList, player, targetBufferPosition, true);
 		return;
 	}
 
@@ -565,19 +575,19 @@ void DrawPlayer(const Surface &out, const Player &player, Point tilePosition, Po
 	else
 		LightTableIndex -= 5;
 
-	Cl2DrawLight(out, spriteBufferPosition, *sprite, nCel);
-	DrawPlayerIcons(out, player, targetBufferPosition, false);
+	drawList.AddSpriteLight(spriteBufferPosition, *sprite, nCel);
+	DrawPlayerIcons(drawList, player, targetBufferPosition, false);
 
 	LightTableIndex = l;
 }
 
 /**
  * @brief Render a player sprite
- * @param out Output buffer
+ * @param drawList Draw list to record to
  * @param tilePosition dPiece coordinates
  * @param targetBufferPosition Output buffer coordinates
  */
-void DrawDeadPlayer(const Surface &out, Point tilePosition, Point targetBufferPosition)
+void DrawDeadPlayer(DungeonDrawList &drawList, Point tilePosition, Point targetBufferPosition)
 {
 	dFlags[tilePosition.x][tilePosition.y] &= ~DungeonFlag::DeadPlayer;
 
@@ -585,19 +595,19 @@ void DrawDeadPlayer(const Surface &out, Point tilePosition, Point targetBufferPo
 		if (player.plractive && player._pHitPoints == 0 && player.isOnActiveLevel() && player.position.tile == tilePosition) {
 			dFlags[tilePosition.x][tilePosition.y] |= DungeonFlag::DeadPlayer;
 			const Point playerRenderPosition { targetBufferPosition + player.position.offset };
-			DrawPlayer(out, player, tilePosition, playerRenderPosition);
+			DrawPlayer(drawList, player, tilePosition, playerRenderPosition);
 		}
 	}
 }
 
 /**
  * @brief Render an object sprite
- * @param out Output buffer
+ * @param drawList Draw list to record to
  * @param tilePosition dPiece coordinates
  * @param targetBufferPosition Output buffer coordinates
  * @param pre Is the sprite in the background
  */
-void DrawObject(const Surface &out, Point tilePosition, Point targetBufferPosition, bool pre)
+void DrawObject(DungeonDrawList &drawList, Point tilePosition, Point targetBufferPosition, bool pre)
 {
 	if (LightTableIndex >= LightsMax) {
 		return;
@@ -635,43 +645,55 @@ void DrawObject(const Surface &out, Point tilePosition, Point targetBufferPositi
 
 	CelSprite cel { objectToDraw._oAnimData, objectToDraw._oAnimWidth };
 	if (&objectToDraw == ObjectUnderCursor) {
-		Cl2DrawOutlineSkipColorZero(out, 194, screenPosition, cel, nCel);
+		drawList.AddOutline(194, screenPosition, cel, nCel);
 	}
 	if (objectToDraw._oLight) {
-		Cl2DrawLight(out, screenPosition, cel, nCel);
+		drawList.AddSpriteLight(screenPosition, cel, nCel);
 	} else {
-		Cl2Draw(out, screenPosition, cel, nCel);
+		drawList.AddSprite(screenPosition, cel, nCel);
 	}
 }
 
-static void DrawDungeon(const Surface & /*out*/, Point /*tilePosition*/, Point /*targetBufferPosition*/);
+static void DrawDungeon(DungeonDrawList & /*drawList*/, Point /*tilePosition*/, Point /*targetBufferPosition*/);
 
 /**
  * @brief Render a cell
- * @param out Target buffer
+ * @param drawList Draw list to record to
  * @param tilePosition dPiece coordinates
  * @param targetBufferPosition Target buffer coordinates
  */
-void DrawCell(const Surface &out, Point tilePosition, Point targetBufferPosition)
+void DrawCell(DungeonDrawList &drawList, Point tilePosition, Point targetBufferPosition)
 {
-	level_piece_id = dPiece[tilePosition.x][tilePosition.y];
-	MICROS *pMap = &DPieceMicros[level_piece_id];
-	cel_transparency_active = TileHasAny(level_piece_id, TileProperties::Transparent) && TransList[dTransVal[tilePosition.x][tilePosition.y]];
-	cel_foliage_active = !TileHasAny(level_piece_id, TileProperties::Solid);
+	const int pieceId = dPiece[tilePosition.x][tilePosition.y];
+	const MICROS &micros = DPieceMicros[pieceId];
+	const bool transparent = TileHasAny(pieceId, TileProperties::Transparent) && TransList[dTransVal[tilePosition.x][tilePosition.y]];
+	const bool foliage = !TileHasAny(pieceId, TileProperties::Solid);
+
+	// The mask of the bottom pair of micros depends on the piece, the ones above it are either solid or fully transparent.
+	MaskType leftMask = MaskType::Solid;
+	MaskType rightMask = MaskType::Solid;
+	if (transparent) {
+		if (TileHasAny(pieceId, TileProperties::TransparentLeft))
+			leftMask = MaskType::Left;
+		if (TileHasAny(pieceId, TileProperties::TransparentRight))
+			rightMask = MaskType::Right;
+	} else if (foliage) {
+		leftMask = MaskType::LeftFoliage;
+		rightMask = MaskType::RightFoliage;
+	}
+	const MaskType upperMask = transparent ? MaskType::Transparent : MaskType::Solid;
+
 	for (int i = 0; i < (MicroTileLen / 2); i++) {
-		level_cel_block = pMap->mt[2 * i];
-		if (level_cel_block != 0) {
-			arch_draw_type = i == 0 ? 1 : 0;
-			RenderTile(out, targetBufferPosition);
+		const uint32_t levelCelBlockLeft = micros.mt[2 * i];
+		if (levelCelBlockLeft != 0) {
+			drawList.AddTile(targetBufferPosition, levelCelBlockLeft, i == 0 ? leftMask : upperMask, LightTableIndex);
 		}
-		level_cel_block = pMap->mt[2 * i + 1];
-		if (level_cel_block != 0) {
-			arch_draw_type = i == 0 ? 2 : 0;
-			RenderTile(out, targetBufferPosition + Displacement { TILE_WIDTH / 2, 0 });
+		const uint32_t levelCelBlockRight = micros.mt[2 * i + 1];
+		if (levelCelBlockRight != 0) {
+			drawList.AddTile(targetBufferPosition + Displacement { TILE_WIDTH / 2, 0 }, levelCelBlockRight, i == 0 ? rightMask : upperMask, LightTableIndex);
 		}
 		targetBufferPosition.y -= TILE_HEIGHT;
 	}
-	cel_foliage_active = false;
 }
 
 /**
@@ -682,30 +704,28 @@ void DrawCell(const Surface &out, Point tilePosition, Point targetBufferPosition
  */
 void DrawFloor(const Surface &out, Point tilePosition, Point targetBufferPosition)
 {
-	cel_transparency_active = false;
-	LightTableIndex = dLight[tilePosition.x][tilePosition.y];
+	// This may run on the floor threads, so it must not touch the global render state (LightTableIndex).
+	const int lightTableIndex = dLight[tilePosition.x][tilePosition.y];
 
-	arch_draw_type = 1; // Left
-	int pn = dPiece[tilePosition.x][tilePosition.y];
-	level_cel_block = DPieceMicros[pn].mt[0];
-	if (level_cel_block != 0) {
-		RenderTile(out, targetBufferPosition);
+	const MICROS &micros = DPieceMicros[dPiece[tilePosition.x][tilePosition.y]];
+	const TileDrawInfo left { micros.mt[0], MaskType::Solid, lightTableIndex };
+	if (left.levelCelBlock != 0) {
+		RenderTile(out, targetBufferPosition, left);
 	}
-	arch_draw_type = 2; // Right
-	level_cel_block = DPieceMicros[pn].mt[1];
-	if (level_cel_block != 0) {
-		RenderTile(out, targetBufferPosition + Displacement { TILE_WIDTH / 2, 0 });
+	const TileDrawInfo right { micros.mt[1], MaskType::Solid, lightTableIndex };
+	if (right.levelCelBlock != 0) {
+		RenderTile(out, targetBufferPosition + Displacement { TILE_WIDTH / 2, 0 }, right);
 	}
 }
 
 /**
  * @brief Draw item for a given tile
- * @param out Output buffer
+ * @param drawList Draw list to record to
  * @param tilePosition dPiece coordinates
  * @param targetBufferPosition Output buffer coordinates
  * @param pre Is the sprite in the background
  */
-void DrawItem(const Surface &out, Point tilePosition, Point targetBufferPosition, bool pre)
+void DrawItem(DungeonDrawList &drawList, Point tilePosition, Point targetBufferPosition, bool pre)
 {
 	int8_t bItem = dItem[tilePosition.x][tilePosition.y];
 
@@ -732,20 +752,20 @@ void DrawItem(const Surface &out, Point tilePosition, Point targetBufferPosition
 	int px = targetBufferPosition.x - CalculateWidth2(cel->Width());
 	const Point position { px, targetBufferPosition.y };
 	if (bItem - 1 == pcursitem || AutoMapShowItems) {
-		Cl2DrawOutlineSkipColorZero(out, GetOutlineColor(item, false), position, *cel, nCel);
+		drawList.AddOutline(GetOutlineColor(item, false), position, *cel, nCel);
 	}
-	Cl2DrawLight(out, position, *cel, nCel);
+	drawList.AddSpriteLight(position, *cel, nCel);
 	if (item.AnimInfo.currentFrame == item.AnimInfo.numberOfFrames - 1 || item._iCurs == ICURS_MAGIC_ROCK)
 		AddItemToLabelQueue(bItem - 1, px, targetBufferPosition.y);
 }
 
 /**
  * @brief Check if and how a monster should be rendered
- * @param out Output buffer
+ * @param drawList Draw list to record to
  * @param tilePosition dPiece coordinates
  * @param targetBufferPosition Output buffer coordinates
  */
-void DrawMonsterHelper(const Surface &out, Point tilePosition, Point targetBufferPosition)
+void DrawMonsterHelper(DungeonDrawList &drawList, Point tilePosition, Point targetBufferPosition)
 {
 	int mi = abs(dMonster[tilePosition.x][tilePosition.y]) - 1;
 
@@ -755,10 +775,10 @@ void DrawMonsterHelper(const Surface &out, Point tilePosition, Point targetBuffe
 		const Point position { px, targetBufferPosition.y };
 		const CelSprite sprite = towner.Sprite();
 		if (mi == pcursmonst) {
-			Cl2DrawOutlineSkipColorZero(out, 166, position, sprite, towner._tAnimFrame);
+			drawList.AddOutline(166, position, sprite, towner._tAnimFrame);
 		}
 		assert(towner._tAnimData);
-		Cl2Draw(out, position, sprite, towner._tAnimFrame);
+		drawList.AddSprite(position, sprite, towner._tAnimFrame);
 		return;
 	}
 
@@ -784,37 +804,38 @@ void DrawMonsterHelper(const Surface &out, Point tilePosition, Point targetBuffe
 
 	const Point monsterRenderPosition { targetBufferPosition + offset - Displacement { CalculateWidth2(cel.Width()), 0 } };
 	if (mi == pcursmonst) {
-		Cl2DrawOutlineSkipColorZero(out, 233, monsterRenderPosition, cel, monster.animInfo.getFrameToUseForRendering());
+		drawList.AddOutline(233, monsterRenderPosition, cel, monster.animInfo.getFrameToUseForRendering());
 	}
-	DrawMonster(out, tilePosition, monsterRenderPosition, monster);
+	DrawMonster(drawList, tilePosition, monsterRenderPosition, monster);
 }
 
 /**
  * @brief Check if and how a player should be rendered
- * @param out Output buffer
+ * @param drawList Draw list to record to
  * @param player Player reference
  * @param tilePosition dPiece coordinates
  * @param targetBufferPosition Output buffer coordinates
  */
-void DrawPlayerHelper(const Surface &out, const Player &player, Point tilePosition, Point targetBufferPosition)
+void DrawPlayerHelper(DungeonDrawList &drawList, const Player &player, Point tilePosition, Point targetBufferPosition)
 {
 	Displacement offset = player.position.offset;
 	if (player.IsWalking()) {
 		offset = GetOffsetForWalking(player.AnimInfo, player._pdir);
 	}
+	offset += GetPredictedWalkOffset(player);
 
 	const Point playerRenderPosition { targetBufferPosition + offset };
 
-	DrawPlayer(out, player, tilePosition, playerRenderPosition);
+	DrawPlayer(drawList, player, tilePosition, playerRenderPosition);
 }
 
 /**
  * @brief Render object sprites
- * @param out Target buffer
+ * @param drawList Draw list to record to
  * @param tilePosition dPiece coordinates
  * @param targetBufferPosition Target buffer coordinates
  */
-void DrawDungeon(const Surface &out, Point tilePosition, Point targetBufferPosition)
+void DrawDungeon(DungeonDrawList &drawList, Point tilePosition, Point targetBufferPosition)
 {
 	assert(InDungeonBounds(tilePosition));
 
@@ -824,19 +845,19 @@ void DrawDungeon(const Surface &out, Point tilePosition, Point targetBufferPosit
 
 	LightTableIndex = dLight[tilePosition.x][tilePosition.y];
 
-	DrawCell(out, tilePosition, targetBufferPosition);
+	DrawCell(drawList, tilePosition, targetBufferPosition);
 
 	int8_t bDead = dCorpse[tilePosition.x][tilePosition.y];
 	int8_t bMap = dTransVal[tilePosition.x][tilePosition.y];
 
 #ifdef _DEBUG
 	if (DebugVision && IsTileLit(tilePosition)) {
-		Cl2Draw(out, targetBufferPosition, CelSprite { *pSquareCel }, 1);
+		drawList.AddSprite(targetBufferPosition, CelSprite { *pSquareCel }, 1);
 	}
 #endif
 
 	if (MissilePreFlag) {
-		DrawMissile(out, tilePosition, targetBufferPosition, true);
+		DrawMissile(drawList, tilePosition, targetBufferPosition, true);
 	}
 
 	if (LightTableIndex < LightsMax && bDead != 0) {
@@ -853,28 +874,29 @@ void DrawDungeon(const Surface &out, Point tilePosition, Point targetBufferPosit
 			}
 			if (pDeadGuy->translationPaletteIndex != 0) {
 				uint8_t *trn = Monsters[pDeadGuy->translationPaletteIndex - 1].uniqueMonsterTRN.get();
-				Cl2DrawTRN(out, position, CelSprite(pCelBuff, pDeadGuy->width), nCel, trn);
+				drawList.AddSpriteTRNCached(position, CelSprite(pCelBuff, pDeadGuy->width), nCel, trn);
 			} else {
-				Cl2DrawLight(out, position, CelSprite(pCelBuff, pDeadGuy->width), nCel);
+				// Corpses of a type share their last frame, so a level littered with them is drawn from a few cached frames.
+				drawList.AddSpriteLightCached(position, CelSprite(pCelBuff, pDeadGuy->width), nCel);
 			}
 		} while (false);
 	}
-	DrawObject(out, tilePosition, targetBufferPosition, true);
-	DrawItem(out, tilePosition, targetBufferPosition, true);
+	DrawObject(drawList, tilePosition, targetBufferPosition, true);
+	DrawItem(drawList, tilePosition, targetBufferPosition, true);
 
 	if (TileContainsDeadPlayer(tilePosition)) {
-		DrawDeadPlayer(out, tilePosition, targetBufferPosition);
+		DrawDeadPlayer(drawList, tilePosition, targetBufferPosition);
 	}
 	int8_t playerId = dPlayer[tilePosition.x][tilePosition.y];
 	if (playerId > 0 && playerId <= MAX_PLRS) {
-		DrawPlayerHelper(out, Players[playerId - 1], tilePosition, targetBufferPosition);
+		DrawPlayerHelper(drawList, Players[playerId - 1], tilePosition, targetBufferPosition);
 	}
 	if (dMonster[tilePosition.x][tilePosition.y] > 0) {
-		DrawMonsterHelper(out, tilePosition, targetBufferPosition);
+		DrawMonsterHelper(drawList, tilePosition, targetBufferPosition);
 	}
-	DrawMissile(out, tilePosition, targetBufferPosition, false);
-	DrawObject(out, tilePosition, targetBufferPosition, false);
-	DrawItem(out, tilePosition, targetBufferPosition, false);
+	DrawMissile(drawList, tilePosition, targetBufferPosition, false);
+	DrawObject(drawList, tilePosition, targetBufferPosition, false);
+	DrawItem(drawList, tilePosition, targetBufferPosition, false);
 
 	if (leveltype != DTYPE_TOWN) {
 		char bArch = dSpecial[tilePosition.x][tilePosition.y];
@@ -886,9 +908,9 @@ void DrawDungeon(const Surface &out, Point tilePosition, Point targetBufferPosit
 			}
 #endif
 			if (cel_transparency_active) {
-				Cl2DrawLightBlended(out, targetBufferPosition, CelSprite { *pSpecialCels }, bArch - 1);
+				drawList.AddSpriteLightBlended(targetBufferPosition, CelSprite { *pSpecialCels }, bArch - 1);
 			} else {
-				Cl2DrawLight(out, targetBufferPosition, CelSprite { *pSpecialCels }, bArch - 1);
+				drawList.AddSpriteLight(targetBufferPosition, CelSprite { *pSpecialCels }, bArch - 1);
 			}
 #ifdef _DEBUG
 			if ((SDL_GetModState() & KMOD_ALT) != 0) {
@@ -903,51 +925,219 @@ void DrawDungeon(const Surface &out, Point tilePosition, Point targetBufferPosit
 		if (tilePosition.x > 0 && tilePosition.y > 0 && targetBufferPosition.y > TILE_HEIGHT) {
 			char bArch = dSpecial[tilePosition.x - 1][tilePosition.y - 1];
 			if (bArch != 0) {
-				Cl2Draw(out, targetBufferPosition + Displacement { 0, -TILE_HEIGHT }, CelSprite { *pSpecialCels }, bArch - 1);
+				drawList.AddSprite(targetBufferPosition + Displacement { 0, -TILE_HEIGHT }, CelSprite { *pSpecialCels }, bArch - 1);
 			}
 		}
 	}
 }
 
 /**
- * @brief Render a row of tiles
- * @param out Buffer to render to
- * @param tilePosition dPiece coordinates
- * @param targetBufferPosition Target buffer coordinates
- * @param rows Number of rows
- * @param columns Tile in a row
+ * @brief The floor around the view, kept between frames in world space.
+ *
+ * Scrolling shifts the cached pixels along, so only the tiles that came into view or whose piece or light changed are
+ * rendered again, in the same order as a full redraw. Tiles that aren't triangles draw over the corners of their
+ * neighbours, so they and their neighbours are redrawn together whenever any of them is.
  */
-void DrawFloor(const Surface &out, Point tilePosition, Point targetBufferPosition, int rows, int columns)
+class FloorCache {
+public:
+	void Draw(ThreadPool *threads, const Surface &out, Point tilePosition, Point targetBufferPosition, int rows, int columns);
+
+private:
+	/** @brief Large enough that every tile overlapping the view is entirely within the cache. */
+	static constexpr int MarginX = TILE_WIDTH;
+	static constexpr int MarginY = TILE_HEIGHT * 2;
+	/** @brief Below this many tiles to redraw the bands aren't worth waking the render threads for. */
+	static constexpr size_t MinParallelTiles = 64;
+
+	struct Entry {
+		/** @brief Dungeon coordinates, out of bounds for the black tiles around the map. */
+		Point tile;
+		/** @brief Bottom left corner of the tile on the cache surface. */
+		Point position;
+		bool dirty;
+		bool spills;
+	};
+
+	static Point WorldPosition(Point tile)
+	{
+		return { (tile.x - tile.y) * TILE_WIDTH / 2, (tile.x + tile.y) * TILE_HEIGHT / 2 };
+	}
+
+	void Shift(Displacement shift);
+	void Render(const Surface &out, const Entry &entry) const;
+
+	std::optional<OwnedSurface> surface_;
+	/** @brief World pixel coordinates of the top left corner of the surface. */
+	Point origin_;
+	uint32_t lightTablesVersion_ = 0;
+	const byte *dungeonCels_ = nullptr;
+	/** @brief Counts the frames, entries from the previous one are still on the surface. */
+	uint32_t frame_ = 0;
+	uint32_t drawnFrame_[MAXDUNX][MAXDUNY] = {};
+	uint16_t drawnPiece_[MAXDUNX][MAXDUNY] = {};
+	char drawnLight_[MAXDUNX][MAXDUNY] = {};
+	/** @brief Index into entries_ of the tiles drawn in the current frame. */
+	uint16_t entryIndex_[MAXDUNX][MAXDUNY] = {};
+	std::vector<Entry> entries_;
+};
+
+void FloorCache::Shift(Displacement shift)
+{
+	// The pixel that ends up at (x, y) comes from (x, y) + shift.
+	const int width = surface_->w() - std::abs(shift.deltaX);
+	const int height = surface_->h() - std::abs(shift.deltaY);
+	const int dstX = std::max(-shift.deltaX, 0);
+	const int srcX = std::max(shift.deltaX, 0);
+	const auto moveRow = [&](int y) {
+		std::memmove(surface_->at(dstX, y), surface_->at(srcX, y + shift.deltaY), width);
+	};
+	if (shift.deltaY >= 0) {
+		for (int y = 0; y < height; y++)
+			moveRow(y);
+	} else {
+		for (int y = surface_->h() - 1; y >= surface_->h() - height; y--)
+			moveRow(y);
+	}
+}
+
+void FloorCache::Render(const Surface &out, const Entry &entry) const
 {
+	if (InDungeonBounds(entry.tile))
+		DrawFloor(out, entry.tile, entry.position);
+	else
+		world_draw_black_tile(out, entry.position.x, entry.position.y);
+}
+
+void FloorCache::Draw(ThreadPool *threads, const Surface &out, Point tilePosition, Point targetBufferPosition, int rows, int columns)
+{
+	const Size size { out.w() + 2 * MarginX, out.h() + 2 * MarginY };
+	const Point origin = WorldPosition(tilePosition) - Displacement { targetBufferPosition.x + MarginX, targetBufferPosition.y + MarginY };
+	const Displacement shift = origin - origin_;
+	bool keep = surface_ && surface_->w() == size.width && surface_->h() == size.height
+	    && lightTablesVersion_ == LightTablesVersion && dungeonCels_ == pDungeonCels.get()
+	    && std::abs(shift.deltaX) < size.width && std::abs(shift.deltaY) < size.height;
+	if (!surface_ || surface_->w() != size.width || surface_->h() != size.height)
+		surface_.emplace(size);
+	if (keep && shift != Displacement { 0, 0 })
+		Shift(shift);
+	origin_ = origin;
+	lightTablesVersion_ = LightTablesVersion;
+	dungeonCels_ = pDungeonCels.get();
+	frame_++;
+
+	// The part of the surface that holds pixels of the previous frame, in surface coordinates.
+	const int keptLeft = std::max(-shift.deltaX, 0);
+	const int keptTop = std::max(-shift.deltaY, 0);
+	const int keptRight = size.width - std::max(shift.deltaX, 0);
+	const int keptBottom = size.height - std::max(shift.deltaY, 0);
+
+	entries_.clear();
+	Point position = targetBufferPosition + Displacement { MarginX, MarginY };
 	for (int i = 0; i < rows; i++) {
 		for (int j = 0; j < columns; j++) {
-			if (InDungeonBounds(tilePosition)) {
-				if (!TileHasAny(dPiece[tilePosition.x][tilePosition.y], TileProperties::Solid))
-					DrawFloor(out, tilePosition, targetBufferPosition);
-			} else {
-				world_draw_black_tile(out, targetBufferPosition.x, targetBufferPosition.y);
+			// Skip the tiles that don't overlap the view.
+			const bool visible = position.x + TILE_WIDTH > MarginX && position.x < MarginX + out.w()
+			    && position.y >= MarginY && position.y - TILE_HEIGHT < MarginY + out.h();
+			if (!visible) {
+				// Nothing to do
+			} else if (!InDungeonBounds(tilePosition)) {
+				entries_.push_back({ tilePosition, position, true, false });
+			} else if (!TileHasAny(dPiece[tilePosition.x][tilePosition.y], TileProperties::Solid)) {
+				const int x = tilePosition.x;
+				const int y = tilePosition.y;
+				const MICROS &micros = DPieceMicros[dPiece[x][y]];
+				const bool spills = (micros.mt[0] != 0 && !IsTriangleTile(micros.mt[0])) || (micros.mt[1] != 0 && !IsTriangleTile(micros.mt[1]));
+				const bool kept = position.x >= keptLeft && position.x + TILE_WIDTH <= keptRight
+				    && position.y - TILE_HEIGHT >= keptTop && position.y < keptBottom;
+				const bool dirty = !keep || !kept || drawnFrame_[x][y] != frame_ - 1
+				    || drawnPiece_[x][y] != dPiece[x][y] || drawnLight_[x][y] != dLight[x][y];
+				drawnFrame_[x][y] = frame_;
+				drawnPiece_[x][y] = dPiece[x][y];
+				drawnLight_[x][y] = dLight[x][y];
+				entryIndex_[x][y] = static_cast<uint16_t>(entries_.size());
+				entries_.push_back({ tilePosition, position, dirty, spills });
 			}
 			tilePosition += Direction::East;
-			targetBufferPosition.x += TILE_WIDTH;
+			position.x += TILE_WIDTH;
 		}
 		// Return to start of row
 		tilePosition += Displacement(Direction::West) * columns;
-		targetBufferPosition.x -= columns * TILE_WIDTH;
+		position.x -= columns * TILE_WIDTH;
 
 		// Jump to next row
-		targetBufferPosition.y += TILE_HEIGHT / 2;
+		position.y += TILE_HEIGHT / 2;
 		if ((i & 1) != 0) {
 			tilePosition.x++;
 			columns--;
-			targetBufferPosition.x += TILE_WIDTH / 2;
+			position.x += TILE_WIDTH / 2;
 		} else {
 			tilePosition.y++;
 			columns++;
-			targetBufferPosition.x -= TILE_WIDTH / 2;
+			position.x -= TILE_WIDTH / 2;
 		}
 	}
+
+	// A tile that spills is redrawn with all of its neighbours if any of them is, until that settles.
+	for (bool changed = true; changed;) {
+		changed = false;
+		for (const Entry &entry : entries_) {
+			if (!entry.spills)
+				continue;
+			bool anyDirty = false;
+			for (int dx = -1; dx <= 1 && !anyDirty; dx++) {
+				for (int dy = -1; dy <= 1 && !anyDirty; dy++) {
+					const Point neighbour = entry.tile + Displacement { dx, dy };
+					anyDirty = InDungeonBounds(neighbour) && drawnFrame_[neighbour.x][neighbour.y] == frame_ && entries_[entryIndex_[neighbour.x][neighbour.y]].dirty;
+				}
+			}
+			if (!anyDirty)
+				continue;
+			for (int dx = -1; dx <= 1; dx++) {
+				for (int dy = -1; dy <= 1; dy++) {
+					const Point neighbour = entry.tile + Displacement { dx, dy };
+					if (!InDungeonBounds(neighbour) || drawnFrame_[neighbour.x][neighbour.y] != frame_)
+						continue;
+					Entry &neighbourEntry = entries_[entryIndex_[neighbour.x][neighbour.y]];
+					changed = changed || !neighbourEntry.dirty;
+					neighbourEntry.dirty = true;
+				}
+			}
+		}
+	}
+
+	size_t numDirty = 0;
+	for (const Entry &entry : entries_) {
+		if (entry.dirty)
+			numDirty++;
+	}
+	if (threads != nullptr && numDirty >= MinParallelTiles) {
+		const int numBands = static_cast<int>(threads->concurrency());
+		const int bandHeight = (size.height + numBands - 1) / numBands;
+		threads->ParallelFor(numBands, [&](int band) {
+			const int top = band * bandHeight;
+			const int height = std::min(bandHeight, size.height - top);
+			if (height <= 0)
+				return;
+			const Surface bandOut = surface_->subregionY(top, height);
+			for (Entry entry : entries_) {
+				if (!entry.dirty)
+					continue;
+				entry.position.y -= top;
+				Render(bandOut, entry);
+			}
+		});
+	} else {
+		for (const Entry &entry : entries_) {
+			if (entry.dirty)
+				Render(*surface_, entry);
+		}
+	}
+
+	out.BlitFrom(*surface_, MakeSdlRect(MarginX, MarginY, out.w(), out.h()), { 0, 0 });
 }
 
+FloorCache TheFloorCache;
+
 bool IsWall(Point position)
 {
 	return TileHasAny(dPiece[position.x][position.y], TileProperties::Solid) || dSpecial[position.x][position.y] != 0;
@@ -955,13 +1145,13 @@ bool IsWall(Point position)
 
 /**
  * @brief Render a row of tile
- * @param out Output buffer
+ * @param drawList Draw list to record to
  * @param tilePosition dPiece coordinates
  * @param targetBufferPosition Buffer coordinates
  * @param rows Number of rows
  * @param columns Tile in a row
  */
-void DrawTileContent(const Surface &out, Point tilePosition, Point targetBufferPosition, int rows, int columns)
+void DrawTileContent(DungeonDrawList &drawList, Point tilePosition, Point targetBufferPosition, int rows, int columns)
 {
 	// Keep evaluating until MicroTiles can't affect screen
 	rows += MicroTileLen;
@@ -980,11 +1170,11 @@ void DrawTileContent(const Surface &out, Point tilePosition, Point targetBufferP
 					// sprite screen position rather than tile position.
 					if (IsWall(tilePosition) && (IsWall(tilePosition + Displacement { 1, 0 }) || (tilePosition.x > 0 && IsWall(tilePosition + Displacement { -1, 0 })))) { // Part of a wall aligned on the x-axis
 						if (IsTileNotSolid(tilePosition + Displacement { 1, -1 }) && IsTileNotSolid(tilePosition + Displacement { 0, -1 })) {                              // Has walkable area behind it
-							DrawDungeon(out, tilePosition + Direction::East, { targetBufferPosition.x + TILE_WIDTH, targetBufferPosition.y });
+							DrawDungeon(drawList, tilePosition + Direction::East, { targetBufferPosition.x + TILE_WIDTH, targetBufferPosition.y });
 						}
 					}
 				}
-				DrawDungeon(out, tilePosition, targetBufferPosition);
+				DrawDungeon(drawList, tilePosition, targetBufferPosition);
 			}
 			tilePosition += Direction::East;
 			targetBufferPosition.x += TILE_WIDTH;
@@ -1007,6 +1197,18 @@ void DrawTileContent(const Surface &out, Point tilePosition, Point targetBufferP
 	}
 }
 
+/** @brief A zoomed row, the source row can't be doubled in place since it overlaps the first zoomed row. */
+std::vector<uint8_t> ZoomRowBuffer;
+
+void DoublePixels(const uint8_t *src, int count, uint8_t *dst)
+{
+	// Simple enough for the compiler to vectorize.
+	for (int i = 0; i < count; i++) {
+		dst[2 * i] = src[i];
+		dst[2 * i + 1] = src[i];
+	}
+}
+
 /**
  * @brief Scale up the top left part of the buffer 2x.
  */
@@ -1023,45 +1225,32 @@ void Zoom(const Surface &out)
 		}
 	}
 
-	// We round to even for the source width and height.
-	// If the width / height was odd, we copy just one extra pixel / row later on.
-	const int srcWidth = (viewportWidth + 1) / 2;
-	const int doubleableWidth = viewportWidth / 2;
+	// We round up the source width and height.
+	// If the width / height is odd, the first pixel / row is copied just once.
 	const int srcHeight = (out.h() + 1) / 2;
-	const int doubleableHeight = out.h() / 2;
-
-	uint8_t *src = out.at(srcWidth - 1, srcHeight - 1);
-	uint8_t *dst = out.at(viewportOffsetX + viewportWidth - 1, out.h() - 1);
 	const bool oddViewportWidth = (viewportWidth % 2) == 1;
+	const bool oddViewportHeight = (out.h() % 2) == 1;
 
-	for (int hgt = 0; hgt < doubleableHeight; hgt++) {
-		// Double the pixels in the line.
-		for (int i = 0; i < doubleableWidth; i++) {
-			*dst-- = *src;
-			*dst-- = *src;
-			--src;
-		}
-
-		// Copy a single extra pixel if the output width is odd.
-		if (oddViewportWidth) {
-			*dst-- = *src;
-			--src;
-		}
+	ZoomRowBuffer.resize(viewportWidth);
 
-		// Skip the rest of the source line.
-		src -= (out.pitch() - srcWidth);
+	// Bottom up, so that every source row is read before the zoomed rows overwrite it.
+	for (int srcY = srcHeight - 1; srcY >= 0; srcY--) {
+		const uint8_t *src = out.at(0, srcY);
+		uint8_t *row = ZoomRowBuffer.data();
+		if (oddViewportWidth)
+			*row++ = *src++;
+		DoublePixels(src, viewportWidth / 2, row);
 
-		// Double the line.
-		memcpy(dst - out.pitch() + 1, dst + 1, viewportWidth);
-
-		// Skip the rest of the destination line.
-		dst -= 2 * out.pitch() - viewportWidth;
-	}
-	if ((out.h() % 2) == 1) {
-		memcpy(dst - out.pitch() + 1, dst + 1, viewportWidth);
+		const int dstY = 2 * srcY - (oddViewportHeight ? 1 : 0);
+		if (dstY >= 0)
+			memcpy(out.at(viewportOffsetX, dstY), ZoomRowBuffer.data(), viewportWidth);
+		memcpy(out.at(viewportOffsetX, dstY + 1), ZoomRowBuffer.data(), viewportWidth);
 	}
 }
 
+/** @brief The draw calls of the last drawn frame, kept around to reuse the memory. */
+DungeonDrawList DungeonDraws;
+
 Displacement tileOffset;
 Displacement tileShift;
 int tileColums;
@@ -1074,8 +1263,10 @@ int tileRows;
  */
 void DrawGame(const Surface &fullOut, Point position)
 {
+	FrameStageTimer frameStageTimer(FrameStage::DrawGame);
+
 	// Limit rendering to the view area
-	const Surface &out = !*sgOptions.Graphics.zoom
+	const Surface &out = !IsViewZoomed()
 	    ? fullOut.subregionY(0, gnViewportHeight)
 	    : fullOut.subregionY(0, (gnViewportHeight + 1) / 2);
 
@@ -1084,6 +1275,7 @@ void DrawGame(const Surface &fullOut, Point position)
 	Displacement offset = ScrollInfo.offset;
 	if (myPlayer.IsWalking())
 		offset = GetOffsetForWalking(myPlayer.AnimInfo, myPlayer._pdir, true);
+	offset -= GetPredictedWalkOffset(myPlayer);
 	int sx = offset.deltaX + tileOffset.deltaX;
 	int sy = offset.deltaY + tileOffset.deltaY;
 
@@ -1094,7 +1286,7 @@ void DrawGame(const Surface &fullOut, Point position)
 
 	// Skip rendering parts covered by the panels
 	if (CanPanelsCoverView()) {
-		if (!*sgOptions.Graphics.zoom) {
+		if (!IsViewZoomed()) {
 			if (IsLeftPanelOpen()) {
 				position += Displacement(Direction::East) * 2;
 				columns -= 4;
@@ -1166,10 +1358,18 @@ void DrawGame(const Surface &fullOut, Point position)
 		break;
 	}
 
-	DrawFloor(out, position, { sx, sy }, rows, columns);
-	DrawTileContent(out, position, { sx, sy }, rows, columns);
+	TheFloorCache.Draw(GetRenderThreads(), out, position, { sx, sy }, rows, columns);
+	{
+		FrameStageTimer recordTimer(FrameStage::RecordDungeon);
+		DungeonDraws.Clear();
+		DrawTileContent(DungeonDraws, position, { sx, sy }, rows, columns);
+	}
+	{
+		FrameStageTimer executeTimer(FrameStage::ExecuteDungeon);
+		DungeonDraws.Execute(out);
+	}
 
-	if (*sgOptions.Graphics.zoom) {
+	if (IsViewZoomed()) {
 		Zoom(fullOut.subregionY(0, gnViewportHeight));
 	}
 }
@@ -1181,6 +1381,8 @@ void DrawGame(const Surface &fullOut, Point position)
  */
 void DrawView(const Surface &out, Point startPosition)
 {
+	FrameStageTimer frameStageTimer(FrameStage::DrawView);
+
 #ifdef _DEBUG
 	DebugCoordsMap.clear();
 #endif
@@ -1203,11 +1405,11 @@ void DrawView(const Surface &out, Point startPosition)
 			Point pixelCoords = m.second;
 			if (megaTiles)
 				pixelCoords += Displacement { 0, TILE_HEIGHT / 2 };
-			if (*sgOptions.Graphics.zoom)
+			if (IsViewZoomed())
 				pixelCoords *= 2;
 			if (debugGridTextNeeded && GetDebugGridText(dunCoords, debugGridTextBuffer)) {
 				Size tileSize = { TILE_WIDTH, TILE_HEIGHT };
-				if (*sgOptions.Graphics.zoom)
+				if (IsViewZoomed())
 					tileSize *= 2;
 				DrawString(out, debugGridTextBuffer, { pixelCoords - Displacement { 0, tileSize.height }, tileSize }, UiFlags::ColorRed | UiFlags::AlignCenter | UiFlags::VerticalCenter);
 			}
@@ -1233,7 +1435,7 @@ void DrawView(const Surface &out, Point startPosition)
 
 				Displacement hor = { TILE_WIDTH / 2, 0 };
 				Displacement ver = { 0, TILE_HEIGHT / 2 };
-				if (*sgOptions.Graphics.zoom) {
+				if (IsViewZoomed()) {
 					hor *= 2;
 					ver *= 2;
 				}
@@ -1330,13 +1532,66 @@ void DrawFPS(const Surface &out)
 		int framerate = 1000 * framesSinceLastUpdate / msSinceLastUpdate;
 		framesSinceLastUpdate = 0;
 
-		static char buf[12] {};
-		const char *end = BufCopy(buf, framerate, " FPS");
-		formatted = { buf, static_cast<string_view::size_type>(end - buf) };
+		static char buf[16] {};
+		formatted = StrCatTo(buf, framerate, " FPS");
 	};
 	DrawString(out, formatted, Point { 8, 68 }, UiFlags::ColorRed);
 }
 
+void DrawNetworkStats(const Surface &out)
+{
+	static uint32_t lastUpdateInMs = 0;
+	static std::string formatted;
+
+	if (!ShowNetworkStats || !gbActive) {
+		return;
+	}
+
+	// The stats are only updated once a second, so there is no need to format them more often.
+	uint32_t runtimeInMs = SDL_GetTicks();
+	if (runtimeInMs - lastUpdateInMs >= 1000 || formatted.empty()) {
+		lastUpdateInMs = runtimeInMs;
+		formatted = multi_format_network_stats();
+	}
+	DrawString(out, formatted, Point { 8, 88 }, UiFlags::ColorRed);
+}
+
+/**
+ * @brief Display the time spent in each stage of a frame, averaged over 1 sec
+ */
+void DrawFrameTimings(const Surface &out)
+{
+	static uint32_t lastUpdateInMs = 0;
+	static FrameStageTimes sums {};
+	static uint32_t frames = 0;
+	static std::string formatted;
+
+	if (!ShowFrameTimings || !gbActive) {
+		return;
+	}
+
+	const FrameStageTimes &lastFrame = GetLastFrameTimings();
+	for (size_t i = 0; i < NumFrameStages; i++)
+		sums[i] += lastFrame[i];
+	frames++;
+
+	uint32_t runtimeInMs = SDL_GetTicks();
+	uint32_t msSinceLastUpdate = runtimeInMs - lastUpdateInMs;
+	if (msSinceLastUpdate >= 1000 || formatted.empty()) {
+		lastUpdateInMs = runtimeInMs;
+		// Cleared rather than reassigned, so that the string keeps its storage.
+		formatted.clear();
+		StrAppend(formatted, static_cast<int>(1000 * frames / std::max<uint32_t>(msSinceLastUpdate, 1)), " frames/s");
+		for (size_t i = 0; i < NumFrameStages; i++) {
+			const int averageUs = static_cast<int>(sums[i] / frames);
+			StrAppend(formatted, "\n", GetFrameStageName(static_cast<FrameStage>(i)), ": ", averageUs / 1000, ".", averageUs / 100 % 10, " ms");
+		}
+		sums = {};
+		frames = 0;
+	}
+	DrawString(out, formatted, Point { 200, 68 }, UiFlags::ColorRed);
+}
+
 /**
  * @brief Update part of the screen from the back buffer
  * @param dwX Back buffer coordinate
@@ -1353,9 +1608,8 @@ void DoBlitScreen(Sint16 dwX, Sint16 dwY, Uint16 dwWdt, Uint16 dwHgt)
 		static_cast<CoordType>(dwY),
 		dwWdt, dwHgt
 	};
-	SDL_Rect dstRect { dwX, dwY, dwWdt, dwHgt };
 
-	BltFast(&srcRect, &dstRect);
+	BltFastIfChanged(srcRect);
 }
 
 /**
@@ -1433,6 +1687,11 @@ Displacement GetOffsetForWalking(const AnimationInfo &animationInfo, const Direc
 	return offset;
 }
 
+bool IsViewZoomed()
+{
+	return *sgOptions.Graphics.zoom || DynamicZoom;
+}
+
 void ClearCursor() // CODE_FIX: this was supposed to be in cursor.cpp
 {
 	sgdwCursWdt = 0;
@@ -1453,7 +1712,7 @@ int RowsCoveredByPanel()
 	}
 
 	int rows = mainPanelSize.height / TILE_HEIGHT;
-	if (*sgOptions.Graphics.zoom) {
+	if (IsViewZoomed()) {
 		rows /= 2;
 	}
 
@@ -1468,7 +1727,7 @@ void CalcTileOffset(int *offsetX, int *offsetY)
 	int x;
 	int y;
 
-	if (!*sgOptions.Graphics.zoom) {
+	if (!IsViewZoomed()) {
 		x = screenWidth % TILE_WIDTH;
 		y = viewportHeight % TILE_HEIGHT;
 	} else {
@@ -1499,7 +1758,7 @@ void TilesInView(int *rcolumns, int *rrows)
 		rows++;
 	}
 
-	if (*sgOptions.Graphics.zoom) {
+	if (IsViewZoomed()) {
 		// Half the number of tiles, rounded up
 		if ((columns & 1) != 0) {
 			columns++;
@@ -1550,7 +1809,7 @@ void CalcViewportGeometry()
 	}
 
 	// Slightly lower the zoomed view
-	if (*sgOptions.Graphics.zoom) {
+	if (IsViewZoomed()) {
 		tileOffset.deltaY += TILE_HEIGHT / 4;
 		if (yo < TILE_HEIGHT / 4)
 			tileRows++;
@@ -1683,8 +1942,61 @@ void scrollrt_draw_game_screen()
 	}
 }
 
+namespace {
+
+/**
+ * @brief Switches the view to half resolution while drawing a frame takes longer than a refresh and back once it fits
+ *        comfortably again.
+ *
+ * The sprites can't be scaled so the lower resolution is the zoomed view, only the view is affected and the panels
+ * stay at the native resolution.
+ */
+void UpdateDynamicResolution(std::chrono::steady_clock::duration drawTime)
+{
+	// About a quarter of a second at 60 FPS, a single slow frame doesn't change the resolution.
+	constexpr int64_t AveragedFrames = 16;
+	constexpr int MinHoldFrames = 300;
+	constexpr int MaxHoldFrames = 3600;
+	static int64_t averageUs = 0;
+	static int framesSinceSwitch = 0;
+	static int holdFrames = MinHoldFrames;
+
+	if (!*sgOptions.Graphics.dynamicResolution || *sgOptions.Graphics.zoom) {
+		if (DynamicZoom) {
+			DynamicZoom = false;
+			CalcViewportGeometry();
+		}
+		averageUs = 0;
+		framesSinceSwitch = 0;
+		return;
+	}
+
+	averageUs += (std::chrono::duration_cast<std::chrono::microseconds>(drawTime).count() - averageUs) / AveragedFrames;
+	// Keeps counting past the hold so that a long stable stretch resets the back-off below.
+	framesSinceSwitch = std::min(framesSinceSwitch + 1, 2 * MaxHoldFrames);
+	if (framesSinceSwitch <= holdFrames)
+		return;
+
+	// A quarter of the pixels are drawn at half resolution, so switching back waits for a lot of headroom.
+	const bool zoom = DynamicZoom ? averageUs > refreshDelay / 2 : averageUs > refreshDelay;
+	if (zoom == DynamicZoom)
+		return;
+	// Having to switch down again right after switching back means the native resolution doesn't fit, so try it less often.
+	if (zoom && framesSinceSwitch < 2 * holdFrames)
+		holdFrames = std::min(holdFrames * 2, MaxHoldFrames);
+	else if (zoom)
+		holdFrames = MinHoldFrames;
+	DynamicZoom = zoom;
+	framesSinceSwitch = 0;
+	CalcViewportGeometry();
+}
+
+} // namespace
+
 void DrawAndBlit()
 {
+	DVL_PERF_FUNCTION();
+
 	if (!gbRunGame || HeadlessMode) {
 		return;
 	}
@@ -1711,6 +2023,7 @@ void DrawAndBlit()
 
 	force_redraw = 0;
 
+	const auto drawStart = std::chrono::steady_clock::now();
 	const Surface &out = GlobalBackBuffer();
 	UndrawCursor(out);
 
@@ -1718,21 +2031,23 @@ void DrawAndBlit()
 
 	DrawView(out, ViewPosition);
 	if (ctrlPan) {
-		DrawCtrlPan(out);
-	}
-	if (drawhpflag) {
-		DrawLifeFlaskLower(out);
-	}
-	if (drawmanaflag) {
-		DrawManaFlaskLower(out);
-
+		DrawMainPanel(out);
 		DrawSpell(out);
-	}
-	if (drawbtnflag) {
-		DrawCtrlBtns(out);
-	}
-	if (drawsbarflag) {
-		DrawInvBelt(out);
+	} else {
+		if (drawhpflag) {
+			DrawLifeFlaskLower(out);
+		}
+		if (drawmanaflag) {
+			DrawManaFlaskLower(out);
+
+			DrawSpell(out);
+		}
+		if (drawbtnflag) {
+			DrawCtrlBtns(out);
+		}
+		if (drawsbarflag) {
+			DrawInvBelt(out);
+		}
 	}
 	if (talkflag) {
 		DrawTalkPan(out);
@@ -1751,10 +2066,15 @@ void DrawAndBlit()
 	}
 
 	DrawFPS(out);
+	DrawNetworkStats(out);
+	DrawFrameTimings(out);
 
 	DrawMain(hgt, ddsdesc, drawhpflag, drawmanaflag, drawsbarflag, drawbtnflag);
+	// Presenting waits for the frame limiter and v-sync, only the drawing depends on the resolution.
+	UpdateDynamicResolution(std::chrono::steady_clock::now() - drawStart);
 
 	RenderPresent();
+	GetFrameArena().Reset();
 
 	drawhpflag = false;
 	drawmanaflag = false;
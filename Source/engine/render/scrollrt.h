@@ -26,13 +26,13 @@ enum class ScrollDirection : uint8_t {
 };
 
 extern int LightTableIndex;
-extern uint32_t level_cel_block;
-extern char arch_draw_type;
 extern bool cel_transparency_active;
-extern bool cel_foliage_active;
-extern int level_piece_id;
 extern bool AutoMapShowItems;
 extern bool frameflag;
+/** @brief Show the latency and bandwidth of the connection to each player below the FPS. */
+extern bool ShowNetworkStats;
+/** @brief Show the average time spent in each stage of a frame, see frame_timings.hpp. */
+extern bool ShowFrameTimings;
 
 /**
  * @brief Returns the offset for the walking animation
@@ -77,6 +77,12 @@ void CalcTileOffset(int *offsetX, int *offsetY);
 void TilesInView(int *columns, int *rows);
 void CalcViewportGeometry();
 
+/**
+ * @brief Returns whether the game view is drawn at half resolution and magnified, either because zoom is on or
+ *        because the dynamic resolution took over to keep up with the frame rate.
+ */
+bool IsViewZoomed();
+
 /**
  * @brief Render the whole screen black
  */
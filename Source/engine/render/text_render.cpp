@@ -7,8 +7,12 @@
 
 #include <array>
 #include <cstddef>
+#include <functional>
+#include <list>
+#include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <fmt/compile.h>
 
@@ -16,6 +20,7 @@
 #include "DiabloUI/diabloui.h"
 #include "DiabloUI/ui_item.h"
 #include "engine.h"
+#include "engine/cel_header.hpp"
 #include "engine/load_cel.hpp"
 #include "engine/load_file.hpp"
 #include "engine/load_pcx.hpp"
@@ -24,6 +29,7 @@
 #include "engine/render/cl2_render.hpp"
 #include "utils/display.h"
 #include "utils/language.h"
+#include "utils/memory_budget.hpp"
 #include "utils/sdl_compat.h"
 #include "utils/stdcompat/optional.hpp"
 #include "utils/utf8.hpp"
@@ -37,7 +43,102 @@ namespace {
 constexpr char32_t ZWSP = U'\u200B'; // Zero-width space
 
 using Font = const OwnedCelSpriteSheetWithFrameHeight;
-std::unordered_map<uint32_t, std::optional<OwnedCelSpriteSheetWithFrameHeight>> Fonts;
+
+/**
+ * @brief The loaded font sheets, the least recently used ones are unloaded once they take up more than the budget.
+ *
+ * The most recently returned sheet is never unloaded, so a sheet stays valid until the next call of `Get` or `Insert`.
+ * The text drawing functions only ever hold on to the sheet of the current Unicode row, which meets that.
+ */
+class FontCache {
+public:
+	/**
+	 * @brief Returns the sheet with the given id, or nullptr if it isn't loaded (or failed to load) and sets `found` accordingly.
+	 */
+	Font *Get(uint32_t fontId, bool &found)
+	{
+		auto it = index_.find(fontId);
+		found = it != index_.end();
+		if (!found) {
+			++misses_;
+			return nullptr;
+		}
+		++hits_;
+		entries_.splice(entries_.begin(), entries_, it->second);
+		return it->second->sheet ? &*it->second->sheet : nullptr;
+	}
+
+	/**
+	 * @brief Stores a sheet, a failed load is stored too so that it's only attempted (and reported) once.
+	 */
+	Font *Insert(uint32_t fontId, std::optional<OwnedCelSpriteSheetWithFrameHeight> sheet, size_t size)
+	{
+		const size_t capacity = GetMemoryBudget(MemoryTag::Fonts);
+		EvictUntil(size < capacity ? capacity - size : 0);
+		entries_.push_front(Entry { fontId, size, std::move(sheet) });
+		index_[fontId] = entries_.begin();
+		usedBytes_ += size;
+		SetMemoryUsage(MemoryTag::Fonts, usedBytes_);
+		return entries_.front().sheet ? &*entries_.front().sheet : nullptr;
+	}
+
+	template <typename Predicate>
+	void EraseIf(Predicate &&predicate)
+	{
+		for (auto it = entries_.begin(); it != entries_.end();) {
+			if (predicate(it->fontId)) {
+				usedBytes_ -= it->size;
+				index_.erase(it->fontId);
+				it = entries_.erase(it);
+			} else {
+				++it;
+			}
+		}
+		SetMemoryUsage(MemoryTag::Fonts, usedBytes_);
+	}
+
+	void Clear()
+	{
+		entries_.clear();
+		index_.clear();
+		usedBytes_ = 0;
+		SetMemoryUsage(MemoryTag::Fonts, 0);
+	}
+
+	[[nodiscard]] FontCacheStats GetStats() const
+	{
+		return FontCacheStats { entries_.size(), usedBytes_, GetMemoryBudget(MemoryTag::Fonts), hits_, misses_, evictions_ };
+	}
+
+private:
+
+	struct Entry {
+		uint32_t fontId;
+		size_t size;
+		std::optional<OwnedCelSpriteSheetWithFrameHeight> sheet;
+	};
+
+	void EvictUntil(size_t maxUsedBytes)
+	{
+		while (usedBytes_ > maxUsedBytes) {
+			const Entry &entry = entries_.back();
+			usedBytes_ -= entry.size;
+			index_.erase(entry.fontId);
+			entries_.pop_back();
+			++evictions_;
+		}
+	}
+
+	/** Most recently used sheet first */
+	std::list<Entry> entries_;
+	std::unordered_map<uint32_t, std::list<Entry>::iterator> index_;
+	size_t usedBytes_ = 0;
+	uint64_t hits_ = 0;
+	uint64_t misses_ = 0;
+	uint64_t evictions_ = 0;
+};
+
+FontCache Fonts;
 
 std::unordered_map<uint32_t, std::array<uint8_t, 256>> FontKerns;
 std::array<int, 6> FontSizes = { 12, 24, 30, 42, 46, 22 };
@@ -188,23 +289,25 @@ const OwnedCelSpriteSheetWithFrameHeight *LoadFont(GameFontTables size, text_col
 	}
 
 	const uint32_t fontId = GetFontId(size, row);
-	auto hotFont = Fonts.find(fontId);
-	if (hotFont != Fonts.end()) {
-		return &*hotFont->second;
+	bool found;
+	Font *hotFont = Fonts.Get(fontId, found);
+	if (found) {
+		return hotFont;
 	}
 
 	char path[32];
 	GetFontPath(size, row, "pcx", &path[0]);
 
-	std::optional<OwnedCelSpriteSheetWithFrameHeight> &font = Fonts[fontId];
 	constexpr unsigned NumFrames = 256;
-	font = LoadPcxSpriteSheetAsCl2(path, NumFrames, /*transparentColor=*/1);
+	std::optional<OwnedCelSpriteSheetWithFrameHeight> font = LoadPcxSpriteSheetAsCl2(path, NumFrames, /*transparentColor=*/1);
 	if (!font) {
 		LogError("Error loading font: {}", path);
-		return nullptr;
+		return Fonts.Insert(fontId, std::nullopt, 0);
 	}
 
-	return &(*font);
+	// The offset of the end of the last frame is the size of the sheet.
+	const size_t sheetSize = LoadLE32(&CelSprite { font->ownedSprite }.Data()[(NumFrames + 1) * sizeof(uint32_t)]);
+	return Fonts.Insert(fontId, std::move(font), sheetSize);
 }
 
 void DrawFont(const Surface &out, Point position, const OwnedCelSpriteSheetWithFrameHeight *font, text_color color, int frame)
@@ -348,9 +451,13 @@ int GetLineHeight(string_view fmt, DrawStringFormatArg *args, std::size_t argsLe
 	return LineHeights[fontIndex];
 }
 
-int DoDrawString(const Surface &out, string_view text, Rectangle rect, Point &characterPosition,
+/**
+ * @brief Lays out the text, calling `drawGlyph(position, font, unicodeRow, frame)` for every glyph
+ */
+template <typename DrawGlyphFn>
+int DoDrawString(string_view text, Rectangle rect, Point &characterPosition,
     int spacing, int lineHeight, int lineWidth, int rightMargin, int bottomMargin,
-    UiFlags flags, GameFontTables size, text_color color)
+    UiFlags flags, GameFontTables size, text_color color, DrawGlyphFn &&drawGlyph)
 {
 	Font *font = nullptr;
 	std::array<uint8_t, 256> *kerning = nullptr;
@@ -394,12 +501,22 @@ int DoDrawString(const Surface &out, string_view text, Rectangle rect, Point &ch
 				continue;
 		}
 
-		DrawFont(out, characterPosition, font, color, frame);
+		drawGlyph(characterPosition, font, currentUnicodeRow, frame);
 		characterPosition.x += (*kerning)[frame] + spacing;
 	}
 	return text.data() - remaining.data();
 }
 
+int DoDrawString(const Surface &out, string_view text, Rectangle rect, Point &characterPosition,
+    int spacing, int lineHeight, int lineWidth, int rightMargin, int bottomMargin,
+    UiFlags flags, GameFontTables size, text_color color)
+{
+	return DoDrawString(text, rect, characterPosition, spacing, lineHeight, lineWidth, rightMargin, bottomMargin, flags, size, color,
+	    [&](Point position, Font *font, uint32_t /*unicodeRow*/, uint8_t frame) {
+		    DrawFont(out, position, font, color, frame);
+	    });
+}
+
 } // namespace
 
 void LoadSmallSelectionSpinner()
@@ -411,19 +528,14 @@ void UnloadFonts(GameFontTables size, text_color color)
 {
 	uint32_t fontStyle = (color << 24) | (size << 16);
 
-	for (auto font = Fonts.begin(); font != Fonts.end();) {
-		if ((font->first & 0xFFFF0000) == fontStyle) {
-			font = Fonts.erase(font);
-		} else {
-			font++;
-		}
-	}
+	Fonts.EraseIf([&](uint32_t fontId) { return (fontId & 0xFFFF0000) == fontStyle; });
 }
 
 void UnloadFonts()
 {
-	Fonts.clear();
+	Fonts.Clear();
 	FontKerns.clear();
+	ClearTextLayoutCache();
 }
 
 int GetLineWidth(string_view text, GameFontTables size, int spacing, int *charactersInLine)
@@ -435,6 +547,25 @@ int GetLineWidth(string_view text, GameFontTables size, int spacing, int *charac
 	std::array<uint8_t, 256> *kerning = nullptr;
 	char32_t next;
 	while (!text.empty()) {
+		// ASCII runs index the kerning of the first row directly.
+		const std::size_t asciiLength = CountAsciiPrefix(text);
+		if (asciiLength != 0) {
+			const string_view run = text.substr(0, asciiLength);
+			const string_view::size_type newline = run.find('\n');
+			const string_view glyphs = run.substr(0, newline);
+			if (!glyphs.empty() && (currentUnicodeRow != 0 || kerning == nullptr)) {
+				kerning = LoadFontKerning(size, 0);
+				currentUnicodeRow = 0;
+			}
+			for (const char c : glyphs)
+				lineWidth += (*kerning)[static_cast<uint8_t>(c)] + spacing;
+			codepoints += static_cast<uint32_t>(glyphs.size());
+			if (newline != string_view::npos)
+				break;
+			text.remove_prefix(asciiLength);
+			continue;
+		}
+
 		next = ConsumeFirstUtf8CodePoint(&text);
 		if (next == Utf8DecodeError)
 			break;
@@ -530,9 +661,12 @@ int AdjustSpacingToFitHorizontally(int &lineWidth, int maxSpacing, int character
 	return maxSpacing - spacingRedux;
 }
 
-std::string WordWrapString(string_view text, unsigned width, GameFontTables size, int spacing)
+namespace {
+
+template <typename String>
+String WordWrap(string_view text, unsigned width, GameFontTables size, int spacing)
 {
-	std::string output;
+	String output;
 	if (text.empty() || text[0] == '\0')
 		return output;
 
@@ -612,10 +746,70 @@ std::string WordWrapString(string_view text, unsigned width, GameFontTables size
 	return output;
 }
 
+} // namespace
+
+std::string WordWrapString(string_view text, unsigned width, GameFontTables size, int spacing)
+{
+	return WordWrap<std::string>(text, width, size, spacing);
+}
+
+FrameString WordWrapStringForFrame(string_view text, unsigned width, GameFontTables size, int spacing)
+{
+	return WordWrap<FrameString>(text, width, size, spacing);
+}
+
 /**
  * @todo replace Rectangle with cropped Surface
  */
-uint32_t DrawString(const Surface &out, string_view text, const Rectangle &rect, UiFlags flags, int spacing, int lineHeight)
+namespace {
+
+/** @brief A glyph of a laid out string, relative to the top left of the string's rectangle. */
+struct LaidOutGlyph {
+	Displacement offset;
+	uint16_t unicodeRow;
+	uint8_t frame;
+};
+
+/** @brief Everything `DrawString` works out from its arguments before drawing the glyphs. */
+struct TextLayout {
+	// The arguments the layout was made for, the cache is indexed by their hash only.
+	std::string text;
+	UiFlags flags;
+	int spacing;
+	int lineHeightArg;
+	Size rectSize;
+	int bottomMargin;
+
+	std::vector<LaidOutGlyph> glyphs;
+	/** @brief Where the cursor goes, relative to the top left of the rectangle. */
+	Displacement end;
+	int lineHeight;
+	uint32_t bytesDrawn;
+
+	bool Matches(string_view otherText, UiFlags otherFlags, int otherSpacing, int otherLineHeight, Size otherRectSize, int otherBottomMargin) const
+	{
+		return flags == otherFlags && spacing == otherSpacing && lineHeightArg == otherLineHeight && rectSize == otherRectSize
+		    && bottomMargin == otherBottomMargin && string_view(text) == otherText;
+	}
+};
+
+/**
+ * @brief Layouts of the strings drawn recently, most of the UI draws the same strings every frame.
+ *
+ * Emptied when full, when fonts are unloaded and when the language changes.
+ */
+std::unordered_map<size_t, TextLayout> TextLayouts;
+constexpr size_t MaxTextLayouts = 1024;
+
+size_t HashTextLayoutArgs(string_view text, UiFlags flags, int spacing, int lineHeight, Size rectSize, int bottomMargin)
+{
+	size_t hash = std::hash<string_view> {}(text);
+	for (int value : { static_cast<int>(flags), spacing, lineHeight, rectSize.width, rectSize.height, bottomMargin })
+		hash = hash * 31 + std::hash<int> {}(value);
+	return hash;
+}
+
+void LayOutString(TextLayout &layout, string_view text, const Rectangle &rect, UiFlags flags, int spacing, int lineHeight, int bottomMargin)
 {
 	GameFontTables size = GetSizeFromFlags(flags);
 	text_color color = GetColorFromFlags(flags);
@@ -636,7 +830,6 @@ uint32_t DrawString(const Surface &out, string_view text, const Rectangle &rect,
 		characterPosition.x += rect.size.width - lineWidth;
 
 	int rightMargin = rect.position.x + rect.size.width;
-	const int bottomMargin = rect.size.height != 0 ? std::min(rect.position.y + rect.size.height, out.h()) : out.h();
 
 	if (lineHeight == -1)
 		lineHeight = GetLineHeight(text, size);
@@ -648,7 +841,74 @@ uint32_t DrawString(const Surface &out, string_view text, const Rectangle &rect,
 
 	characterPosition.y += BaseLineOffset[size];
 
-	const int bytesDrawn = DoDrawString(out, text, rect, characterPosition, spacing, lineHeight, lineWidth, rightMargin, bottomMargin, flags, size, color);
+	layout.glyphs.clear();
+	layout.bytesDrawn = DoDrawString(text, rect, characterPosition, spacing, lineHeight, lineWidth, rightMargin, bottomMargin, flags, size, color,
+	    [&](Point position, Font * /*font*/, uint32_t unicodeRow, uint8_t frame) {
+		    layout.glyphs.push_back({ position - rect.position, static_cast<uint16_t>(unicodeRow), frame });
+	    });
+	layout.end = characterPosition - rect.position;
+	layout.lineHeight = lineHeight;
+}
+
+const TextLayout &GetTextLayout(const Surface &out, string_view text, const Rectangle &rect, UiFlags flags, int spacing, int lineHeight)
+{
+	const int bottomMargin = rect.size.height != 0 ? std::min(rect.position.y + rect.size.height, out.h()) : out.h();
+	// The layout is relative to the rectangle, so only the distance to the bottom margin matters.
+	const int relativeBottomMargin = bottomMargin - rect.position.y;
+	const size_t hash = HashTextLayoutArgs(text, flags, spacing, lineHeight, rect.size, relativeBottomMargin);
+
+	auto it = TextLayouts.find(hash);
+	if (it != TextLayouts.end() && it->second.Matches(text, flags, spacing, lineHeight, rect.size, relativeBottomMargin))
+		return it->second;
+
+	if (it == TextLayouts.end()) {
+		if (TextLayouts.size() >= MaxTextLayouts)
+			TextLayouts.clear();
+		it = TextLayouts.emplace(hash, TextLayout {}).first;
+	}
+	TextLayout &layout = it->second;
+	layout.text.assign(text.data(), text.size());
+	layout.flags = flags;
+	layout.spacing = spacing;
+	layout.lineHeightArg = lineHeight;
+	layout.rectSize = rect.size;
+	layout.bottomMargin = relativeBottomMargin;
+	// Laid out at the origin, so that the positions are relative to the rectangle.
+	LayOutString(layout, text, Rectangle { { 0, 0 }, rect.size }, flags, spacing, lineHeight, relativeBottomMargin);
+	return layout;
+}
+
+} // namespace
+
+void ClearTextLayoutCache()
+{
+	TextLayouts.clear();
+}
+
+FontCacheStats GetFontCacheStats()
+{
+	return Fonts.GetStats();
+}
+
+uint32_t DrawString(const Surface &out, string_view text, const Rectangle &rect, UiFlags flags, int spacing, int lineHeight)
+{
+	GameFontTables size = GetSizeFromFlags(flags);
+	text_color color = GetColorFromFlags(flags);
+
+	const TextLayout &layout = GetTextLayout(out, text, rect, flags, spacing, lineHeight);
+	Font *font = nullptr;
+	uint16_t currentUnicodeRow = 0;
+	for (const LaidOutGlyph &glyph : layout.glyphs) {
+		if (glyph.unicodeRow != currentUnicodeRow || font == nullptr) {
+			font = LoadFont(size, color, glyph.unicodeRow);
+			currentUnicodeRow = glyph.unicodeRow;
+		}
+		DrawFont(out, rect.position + glyph.offset, font, color, glyph.frame);
+	}
+
+	const Point characterPosition = rect.position + layout.end;
+	lineHeight = layout.lineHeight;
+	const uint32_t bytesDrawn = layout.bytesDrawn;
 
 	if (HasAnyOf(flags, UiFlags::PentaCursor)) {
 		Cl2Draw(out, characterPosition + Displacement { 0, lineHeight - BaseLineOffset[size] }, CelSprite { *pSPentSpn2Cels }, PentSpn2Spin());
@@ -5,6 +5,7 @@
  */
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <utility>
@@ -16,6 +17,7 @@
 #include "engine.h"
 #include "engine/cel_sprite.hpp"
 #include "engine/rectangle.hpp"
+#include "utils/frame_arena.hpp"
 #include "utils/stdcompat/optional.hpp"
 #include "utils/stdcompat/string_view.hpp"
 
@@ -167,6 +169,11 @@ int GetLineHeight(string_view text, GameFontTables fontIndex);
  */
 [[nodiscard]] std::string WordWrapString(string_view text, unsigned width, GameFontTables size = GameFont12, int spacing = 1);
 
+/**
+ * @brief Same as WordWrapString, but the copy is allocated from the frame arena and only valid until the end of the frame.
+ */
+[[nodiscard]] FrameString WordWrapStringForFrame(string_view text, unsigned width, GameFontTables size = GameFont12, int spacing = 1);
+
 /**
  * @brief Draws a line of text within a clipping rectangle (positioned relative to the origin of the output buffer).
  *
@@ -233,4 +240,23 @@ inline void DrawStringWithColors(const Surface &out, string_view fmt, std::vecto
 uint8_t PentSpn2Spin();
 void UnloadFonts();
 
+/**
+ * @brief Forgets the layouts of the strings drawn so far, needed when something other than the arguments of `DrawString` changes their layout
+ */
+void ClearTextLayoutCache();
+
+struct FontCacheStats {
+	size_t fonts;
+	size_t usedBytes;
+	size_t capacity;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+};
+
+/**
+ * @brief Returns how much memory the loaded font sheets use and how often they had to be loaded.
+ */
+FontCacheStats GetFontCacheStats();
+
 } // namespace devilution
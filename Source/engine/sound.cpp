@@ -5,22 +5,25 @@
  */
 #include "engine/sound.h"
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
-#include <list>
 #include <memory>
-#include <mutex>
+#include <utility>
 
 #include <SDL.h>
 
 #include "engine/assets.hpp"
+#include "engine/sound_defs.hpp"
 #include "init.h"
 #include "options.h"
 #include "utils/log.hpp"
 #include "utils/math.h"
-#include "utils/sdl_mutex.h"
+#include "utils/memory_budget.hpp"
+#include "utils/pcm_aulib_decoder.h"
+#include "utils/perf_scope.hpp"
 #include "utils/stdcompat/algorithm.hpp"
-#include "utils/stdcompat/optional.hpp"
-#include "utils/stdcompat/shared_ptr_array.hpp"
 #include "utils/str_cat.hpp"
 #include "utils/stubs.h"
 
@@ -46,14 +49,39 @@ std::string GetMp3Path(const char *path)
 	return mp3Path;
 }
 
-bool LoadAudioFile(const char *path, bool stream, bool errorDialog, SoundSample &result)
+#ifndef STREAM_ALL_AUDIO
+/** @brief Sounds that decode to more than this are played from the encoded file, e.g. the long speeches. */
+constexpr size_t MaxBankedSoundSize = 1024 * 1024;
+
+/**
+ * @brief Decodes a sound effect once, so that playing it doesn't decode it again.
+ * @return The decoded sound or nullptr if it doesn't fit into the sound bank
+ */
+std::shared_ptr<const PcmSamples> DecodeForSoundBank(const SharedAsset &fileData, bool isMp3)
+{
+	const size_t usage = GetMemoryUsage(MemoryTag::SoundBank);
+	const size_t budget = GetMemoryBudget(MemoryTag::SoundBank);
+	if (usage >= budget)
+		return nullptr;
+	std::unique_ptr<PcmSamples> pcm = DecodeToPcm(fileData, isMp3, std::min<size_t>(MaxBankedSoundSize, budget - usage));
+	if (pcm == nullptr)
+		return nullptr;
+	AddMemoryUsage(MemoryTag::SoundBank, pcm->SizeInBytes());
+	return std::shared_ptr<const PcmSamples>(pcm.release(), [](const PcmSamples *samples) {
+		SubtractMemoryUsage(MemoryTag::SoundBank, samples->SizeInBytes());
+		delete samples;
+	});
+}
+#endif
+
+bool LoadAudioFile(const char *path, bool stream, bool errorDialog, SoundSample &result, bool readAhead = false)
 {
 #ifndef STREAM_ALL_AUDIO
 	if (stream) {
 #endif
-		if (result.SetChunkStream(GetMp3Path(path), /*isMp3=*/true, /*logErrors=*/false) != 0) {
+		if (result.SetChunkStream(GetMp3Path(path), /*isMp3=*/true, /*logErrors=*/false, readAhead) != 0) {
 			SDL_ClearError();
-			if (result.SetChunkStream(path, /*isMp3=*/false, /*logErrors=*/true) != 0) {
+			if (result.SetChunkStream(path, /*isMp3=*/false, /*logErrors=*/true, readAhead) != 0) {
 				if (errorDialog)
 					ErrSdl();
 				return false;
@@ -62,27 +90,21 @@ bool LoadAudioFile(const char *path, bool stream, bool errorDialog, SoundSample
 #ifndef STREAM_ALL_AUDIO
 	} else {
 		bool isMp3 = true;
-		SDL_RWops *file = OpenAsset(GetMp3Path(path).c_str());
-		if (file == nullptr) {
+		SharedAsset waveFile = LoadSharedAsset(GetMp3Path(path).c_str());
+		if (!waveFile) {
 			SDL_ClearError();
 			isMp3 = false;
-			file = OpenAsset(path);
-			if (file == nullptr) {
+			waveFile = LoadSharedAsset(path);
+			if (!waveFile) {
 				if (errorDialog)
-					ErrDlg("OpenAsset failed", path, __FILE__, __LINE__);
+					ErrDlg("Failed to load file", StrCat(path, ": ", SDL_GetError()), __FILE__, __LINE__);
 				return false;
 			}
 		}
-		size_t dwBytes = SDL_RWsize(file);
-		auto waveFile = MakeArraySharedPtr<std::uint8_t>(dwBytes);
-		if (SDL_RWread(file, waveFile.get(), dwBytes, 1) == 0) {
-			if (errorDialog)
-				ErrDlg("Failed to read file", StrCat(path, ": ", SDL_GetError()), __FILE__, __LINE__);
-			return false;
-		}
-		int error = result.SetChunk(waveFile, dwBytes, isMp3);
-		SDL_RWclose(file);
-		if (error != 0) {
+		std::shared_ptr<const PcmSamples> pcm = DecodeForSoundBank(waveFile, isMp3);
+		if (pcm != nullptr && result.SetPcm(std::move(pcm)) == 0)
+			return true;
+		if (result.SetChunk(std::move(waveFile), isMp3) != 0) {
 			if (errorDialog)
 				ErrSdl();
 			return false;
@@ -92,27 +114,111 @@ bool LoadAudioFile(const char *path, bool stream, bool errorDialog, SoundSample
 	return true;
 }
 
-std::list<std::unique_ptr<SoundSample>> duplicateSounds;
-std::optional<SdlMutex> duplicateSoundsMutex;
+/**
+ * @brief A voice that plays a sound while the sound's own sample is already playing.
+ *
+ * Voices are only acquired and stopped on the main thread. The audio thread only marks them as finished,
+ * so neither side needs a lock.
+ */
+struct SoundVoice {
+	SoundSample sample;
+	std::atomic<bool> finished { true };
+	/** @brief Volume the voice was started with, quieter (i.e. more distant) voices are stolen first. */
+	int volume;
+	uint32_t startTick;
+};
+
+std::array<SoundVoice, DEVILUTIONX_SOUND_VOICES> SoundVoices;
+
+bool StartedBefore(const SoundVoice &voice, const SoundVoice &other)
+{
+	return static_cast<int32_t>(voice.startTick - other.startTick) < 0;
+}
+
+/**
+ * @brief How many instances of the same sound may play at once, including the sound's own sample.
+ * More instances of a hit or death sound only make the mix louder.
+ */
+constexpr int MaxInstancesPerSound = 4;
 
-SoundSample *DuplicateSound(const SoundSample &sound)
+bool IsQuieter(const SoundVoice &voice, const SoundVoice *other)
 {
-	auto duplicate = std::make_unique<SoundSample>();
-	if (duplicate->DuplicateFrom(sound) != 0)
+	return other == nullptr || voice.volume < other->volume || (voice.volume == other->volume && StartedBefore(voice, *other));
+}
+
+/**
+ * @brief Stops a playing voice so that it can play the new sound, unless it is louder than the new sound.
+ */
+SoundVoice *StealVoice(SoundVoice *voice, int volume)
+{
+	if (voice == nullptr || voice->volume > volume)
+		return nullptr;
+	// Stopping takes the audio lock, so the finish callback can't race with the voice being reused.
+	voice->sample.Stop();
+	voice->finished.store(true, std::memory_order_relaxed);
+	return voice;
+}
+
+/**
+ * @brief Finds a voice to play the given sound with, preferring one that already holds the same audio.
+ *
+ * Otherwise the idle voice that was used the longest ago is reloaded. If every voice is busy, the quietest
+ * one is stolen, unless it is louder than the new sound. The same applies to the instances of the sound
+ * once MaxInstancesPerSound of them are playing.
+ */
+SoundVoice *AcquireVoice(const SoundSample &sound, int volume)
+{
+	SoundVoice *idle = nullptr;
+	SoundVoice *idleSameSound = nullptr;
+	SoundVoice *quietest = nullptr;
+	SoundVoice *quietestInstance = nullptr;
+	// The sound's own sample is playing, otherwise it wouldn't need a voice.
+	int instances = 1;
+	const size_t numVoices = std::min<size_t>(std::max(*sgOptions.Performance.soundVoices, 0), SoundVoices.size());
+	for (size_t i = 0; i < numVoices; i++) {
+		SoundVoice &voice = SoundVoices[i];
+		const bool sameSound = voice.sample.HasSameSourceAs(sound);
+		if (voice.finished.load(std::memory_order_acquire)) {
+			if (sameSound)
+				idleSameSound = &voice;
+			else if (idle == nullptr || !voice.sample.IsLoaded() || (idle->sample.IsLoaded() && StartedBefore(voice, *idle)))
+				idle = &voice;
+			continue;
+		}
+		if (sameSound) {
+			instances++;
+			if (IsQuieter(voice, quietestInstance))
+				quietestInstance = &voice;
+		}
+		if (IsQuieter(voice, quietest))
+			quietest = &voice;
+	}
+	if (instances >= MaxInstancesPerSound)
+		return StealVoice(quietestInstance, volume);
+	if (idleSameSound != nullptr)
+		return idleSameSound;
+	if (idle != nullptr)
+		return idle;
+	return StealVoice(quietest, volume);
+}
+
+SoundVoice *DuplicateSound(const SoundSample &sound, int volume)
+{
+	SoundVoice *voice = AcquireVoice(sound, volume);
+	if (voice == nullptr)
 		return nullptr;
-	auto *result = duplicate.get();
-	decltype(duplicateSounds.begin()) it;
-	{
-		const std::lock_guard<SdlMutex> lock(*duplicateSoundsMutex);
-		duplicateSounds.push_back(std::move(duplicate));
-		it = duplicateSounds.end();
-		--it;
+	if (!voice->sample.HasSameSourceAs(sound)) {
+		voice->sample.Release();
+		if (voice->sample.DuplicateFrom(sound) != 0)
+			return nullptr;
+		voice->sample.SetFinishCallback([voice]([[maybe_unused]] Aulib::Stream &stream) {
+			voice->finished.store(true, std::memory_order_release);
+		});
 	}
-	result->SetFinishCallback([it]([[maybe_unused]] Aulib::Stream &stream) {
-		const std::lock_guard<SdlMutex> lock(*duplicateSoundsMutex);
-		duplicateSounds.erase(it);
-	});
-	return result;
+	voice->volume = volume;
+	voice->startTick = SDL_GetTicks();
+	voice->finished.store(false, std::memory_order_relaxed);
+	return voice;
 }
 
 /** Maps from track ID to track name in spawn. */
@@ -147,8 +253,10 @@ int CapVolume(int volume)
 
 void ClearDuplicateSounds()
 {
-	const std::lock_guard<SdlMutex> lock(*duplicateSoundsMutex);
-	duplicateSounds.clear();
+	for (SoundVoice &voice : SoundVoices) {
+		voice.sample.Release();
+		voice.finished.store(true, std::memory_order_relaxed);
+	}
 }
 
 void snd_play_snd(TSnd *pSnd, int lVolume, int lPan)
@@ -162,14 +270,22 @@ void snd_play_snd(TSnd *pSnd, int lVolume, int lPan)
 		return;
 	}
 
+	// Don't spend a voice on a sound that the user volume attenuates to silence.
+	if (lVolume + *sgOptions.Audio.soundVolume * (ATTENUATION_MIN / VOLUME_MIN) <= ATTENUATION_MIN) {
+		return;
+	}
+
 	SoundSample *sound = &pSnd->DSB;
+	SoundVoice *voice = nullptr;
 	if (sound->IsPlaying()) {
-		sound = DuplicateSound(*sound);
-		if (sound == nullptr)
+		voice = DuplicateSound(*sound, lVolume);
+		if (voice == nullptr)
 			return;
+		sound = &voice->sample;
 	}
 
-	sound->PlayWithVolumeAndPan(lVolume, *sgOptions.Audio.soundVolume, lPan);
+	if (!sound->PlayWithVolumeAndPan(lVolume, *sgOptions.Audio.soundVolume, lPan) && voice != nullptr)
+		voice->finished.store(true, std::memory_order_relaxed);
 	pSnd->start_tc = tc;
 }
 
@@ -192,6 +308,8 @@ TSnd::~TSnd()
 
 void snd_init()
 {
+	DVL_PERF_FUNCTION();
+
 	sgOptions.Audio.soundVolume.SetValue(CapVolume(*sgOptions.Audio.soundVolume));
 	gbSoundOn = *sgOptions.Audio.soundVolume > VOLUME_MIN;
 	sgbSaveSoundOn = gbSoundOn;
@@ -209,15 +327,14 @@ void snd_init()
 	LogVerbose(LogCategory::Audio, "Aulib sampleRate={} channels={} frameSize={} format={:#x}",
 	    Aulib::sampleRate(), Aulib::channelCount(), Aulib::frameSize(), Aulib::sampleFormat());
 
-	duplicateSoundsMutex.emplace();
 	gbSndInited = true;
 }
 
 void snd_deinit()
 {
 	if (gbSndInited) {
+		ClearDuplicateSounds();
 		Aulib::quit();
-		duplicateSoundsMutex = std::nullopt;
 	}
 
 	gbSndInited = false;
@@ -269,7 +386,8 @@ void music_start(_music_id nTrack)
 #else
 	const bool stream = true;
 #endif
-	if (!LoadAudioFile(trackPath, stream, /*errorDialog=*/false, music)) {
+	// Music is read ahead so that decompressing it never holds up the audio callback.
+	if (!LoadAudioFile(trackPath, stream, /*errorDialog=*/false, music, /*readAhead=*/true)) {
 		music_stop();
 		return;
 	}
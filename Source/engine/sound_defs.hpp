@@ -14,6 +14,11 @@
 #define PAN_MIN -6400
 #define PAN_MAX 6400
 
+/** Number of voices that play sounds while the sound's own sample is already playing. */
+#ifndef DEVILUTIONX_SOUND_VOICES
+#define DEVILUTIONX_SOUND_VOICES 32
+#endif
+
 #if SDL_VERSION_ATLEAST(2, 0, 7) && defined(DEVILUTIONX_RESAMPLER_SDL)
 #define DVL_AULIB_SUPPORTS_SDL_RESAMPLER
 #endif
@@ -0,0 +1,200 @@
+#include "engine/state_hash.hpp"
+
+#include "engine/random.hpp"
+#include "items.h"
+#include "missiles.h"
+#include "monster.h"
+#include "objects.h"
+#include "player.h"
+#include "utils/log.hpp"
+
+namespace devilution {
+
+namespace {
+
+constexpr std::array<const char *, NumStateHashCategories> CategoryNames = {
+	"RNG",
+	"Players",
+	"Monsters",
+	"Missiles",
+	"Items",
+	"Objects",
+};
+
+/**
+ * @brief 32-bit FNV-1a over the values added to it, every value is widened to 32 bits first.
+ */
+class StateHasher {
+public:
+	template <typename T>
+	void Add(T value)
+	{
+		auto word = static_cast<uint32_t>(value);
+		for (int i = 0; i < 4; i++) {
+			hash_ = (hash_ ^ (word & 0xFF)) * 16777619U;
+			word >>= 8;
+		}
+	}
+
+	template <typename CoordT>
+	void Add(PointOf<CoordT> point)
+	{
+		Add(point.x);
+		Add(point.y);
+	}
+
+	template <typename DeltaT>
+	void Add(DisplacementOf<DeltaT> displacement)
+	{
+		Add(displacement.deltaX);
+		Add(displacement.deltaY);
+	}
+
+	[[nodiscard]] uint32_t Get() const
+	{
+		return hash_;
+	}
+
+private:
+	uint32_t hash_ = 2166136261U;
+};
+
+uint32_t HashPlayer(const Player &player)
+{
+	StateHasher hasher;
+	hasher.Add(player.plrlevel);
+	hasher.Add(player.position.tile);
+	hasher.Add(player.position.future);
+	hasher.Add(player._pmode);
+	hasher.Add(player._pdir);
+	hasher.Add(player.AnimInfo.currentFrame);
+	hasher.Add(player._pHitPoints);
+	hasher.Add(player._pMana);
+	hasher.Add(player._pExperience);
+	hasher.Add(player._pGold);
+	return hasher.Get();
+}
+
+uint32_t HashMonster(const Monster &monster)
+{
+	StateHasher hasher;
+	hasher.Add(monster.position.tile);
+	hasher.Add(monster.position.future);
+	hasher.Add(monster.mode);
+	hasher.Add(monster.goal);
+	hasher.Add(monster.direction);
+	hasher.Add(monster.animInfo.currentFrame);
+	hasher.Add(monster.hitPoints);
+	hasher.Add(monster.enemy);
+	hasher.Add(monster.flags);
+	hasher.Add(monster.activeForTicks);
+	hasher.Add(monster.var1);
+	hasher.Add(monster.var2);
+	hasher.Add(monster.var3);
+	return hasher.Get();
+}
+
+uint32_t HashMissile(const Missile &missile)
+{
+	StateHasher hasher;
+	hasher.Add(missile._mitype);
+	hasher.Add(missile.position.tile);
+	hasher.Add(missile.position.traveled);
+	hasher.Add(missile._mirange);
+	hasher.Add(missile._midam);
+	hasher.Add(missile._miDelFlag);
+	hasher.Add(missile.var1);
+	hasher.Add(missile.var2);
+	return hasher.Get();
+}
+
+uint32_t HashItem(const Item &item)
+{
+	StateHasher hasher;
+	hasher.Add(item.IDidx);
+	hasher.Add(item._iSeed);
+	hasher.Add(item._iCreateInfo);
+	hasher.Add(item.position);
+	return hasher.Get();
+}
+
+uint32_t HashObject(const Object &object)
+{
+	StateHasher hasher;
+	hasher.Add(object._otype);
+	hasher.Add(object.position);
+	hasher.Add(object._oSelFlag);
+	hasher.Add(object._oAnimFrame);
+	hasher.Add(object._oVar1);
+	hasher.Add(object._oVar2);
+	hasher.Add(object._oVar3);
+	hasher.Add(object._oVar4);
+	return hasher.Get();
+}
+
+/**
+ * @brief Calls visitEntity with the id and hash of every entity of the category, in processing order.
+ */
+template <typename F>
+void VisitEntities(StateHashCategory category, F &&visitEntity)
+{
+	switch (category) {
+	case StateHashCategory::Rng:
+		visitEntity(0, GetLCGEngineState());
+		break;
+	case StateHashCategory::Players:
+		for (int i = 0; i < MAX_PLRS; i++) {
+			if (Players[i].plractive)
+				visitEntity(i, HashPlayer(Players[i]));
+		}
+		break;
+	case StateHashCategory::Monsters:
+		for (size_t i = 0; i < ActiveMonsterCount; i++)
+			visitEntity(ActiveMonsters[i], HashMonster(Monsters[ActiveMonsters[i]]));
+		break;
+	case StateHashCategory::Missiles: {
+		int position = 0;
+		for (const Missile &missile : Missiles)
+			visitEntity(position++, HashMissile(missile));
+	} break;
+	case StateHashCategory::Items:
+		for (uint8_t i = 0; i < ActiveItemCount; i++)
+			visitEntity(ActiveItems[i], HashItem(Items[ActiveItems[i]]));
+		break;
+	case StateHashCategory::Objects:
+		for (int i = 0; i < ActiveObjectCount; i++)
+			visitEntity(ActiveObjects[i], HashObject(Objects[ActiveObjects[i]]));
+		break;
+	}
+}
+
+} // namespace
+
+GameStateHash ComputeGameStateHash()
+{
+	GameStateHash result;
+	for (size_t i = 0; i < NumStateHashCategories; i++) {
+		StateHasher hasher;
+		VisitEntities(static_cast<StateHashCategory>(i), [&hasher](int id, uint32_t entityHash) {
+			hasher.Add(id);
+			hasher.Add(entityHash);
+		});
+		result.categories[i] = hasher.Get();
+	}
+	return result;
+}
+
+const char *GetStateHashCategoryName(StateHashCategory category)
+{
+	return CategoryNames[static_cast<size_t>(category)];
+}
+
+void LogStateHashEntities(StateHashCategory category)
+{
+	const char *name = GetStateHashCategoryName(category);
+	VisitEntities(category, [name](int id, uint32_t entityHash) {
+		Log("{} {}: {:08x}", name, id, entityHash);
+	});
+}
+
+} // namespace devilution
@@ -0,0 +1,59 @@
+/**
+ * @file state_hash.hpp
+ *
+ * Interface of the game state hash that detects when a replay stops following the recording.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace devilution {
+
+/**
+ * @brief The parts of the game state that are hashed separately, so that a divergence can be narrowed down.
+ */
+enum class StateHashCategory : uint8_t {
+	Rng,
+	Players,
+	Monsters,
+	Missiles,
+	Items,
+	Objects,
+
+	LAST = Objects
+};
+
+constexpr size_t NumStateHashCategories = static_cast<size_t>(StateHashCategory::LAST) + 1;
+
+struct GameStateHash {
+	std::array<uint32_t, NumStateHashCategories> categories;
+
+	bool operator==(const GameStateHash &other) const
+	{
+		return categories == other.categories;
+	}
+
+	bool operator!=(const GameStateHash &other) const
+	{
+		return !(*this == other);
+	}
+};
+
+/**
+ * @brief Hashes the simulated state of the active level in processing order.
+ *
+ * Only fields that the game logic carries from one tick to the next are hashed. What only the rendering reads, like
+ * the interpolated offsets, is left out.
+ */
+GameStateHash ComputeGameStateHash();
+
+const char *GetStateHashCategoryName(StateHashCategory category);
+
+/**
+ * @brief Logs every entity of the category with its own hash, to narrow a divergence down to the entities that differ.
+ */
+void LogStateHashEntities(StateHashCategory category);
+
+} // namespace devilution
@@ -1,13 +1,47 @@
 #include "engine/surface.hpp"
 
+#include <cstdint>
 #include <cstring>
 
 namespace devilution {
 
 namespace {
 
-template <bool SkipColorIndexZero>
-void SurfaceBlit(const Surface &src, SDL_Rect srcRect, const Surface &dst, Point dstPosition)
+/**
+ * @brief Copies the pixels of a row that aren't skipColor, checking a machine word at a time.
+ */
+void BlitRowSkipColorIndex(const std::uint8_t *src, std::uint8_t *dst, unsigned width, std::uint8_t skipColor)
+{
+	constexpr std::uint64_t LowBits = 0x7F7F7F7F7F7F7F7F;
+	constexpr std::uint64_t HighBits = 0x8080808080808080;
+	const std::uint64_t skipWord = 0x0101010101010101 * skipColor;
+	unsigned i = 0;
+	for (; i + sizeof(std::uint64_t) <= width; i += sizeof(std::uint64_t)) {
+		std::uint64_t srcWord;
+		std::memcpy(&srcWord, &src[i], sizeof(srcWord));
+		const std::uint64_t diff = srcWord ^ skipWord;
+		// The high bit of every byte that isn't skipColor, adding only the low bits keeps carries from crossing bytes
+		const std::uint64_t keep = (((diff & LowBits) + LowBits) | diff) & HighBits;
+		if (keep == 0)
+			continue;
+		if (keep == HighBits) {
+			std::memcpy(&dst[i], &srcWord, sizeof(srcWord));
+			continue;
+		}
+		const std::uint64_t mask = (keep >> 7) * 0xFF;
+		std::uint64_t dstWord;
+		std::memcpy(&dstWord, &dst[i], sizeof(dstWord));
+		dstWord = (dstWord & ~mask) | (srcWord & mask);
+		std::memcpy(&dst[i], &dstWord, sizeof(dstWord));
+	}
+	for (; i < width; i++) {
+		if (src[i] != skipColor)
+			dst[i] = src[i];
+	}
+}
+
+template <bool SkipColorIndex>
+void SurfaceBlit(const Surface &src, SDL_Rect srcRect, const Surface &dst, Point dstPosition, std::uint8_t skipColor = 0)
 {
 	// We do not use `SDL_BlitSurface` here because the palettes may be different objects
 	// and SDL would attempt to map them.
@@ -22,19 +56,12 @@ void SurfaceBlit(const Surface &src, SDL_Rect srcRect, const Surface &dst, Point
 	const auto dstPitch = dst.pitch();
 
 	for (unsigned h = srcRect.h; h != 0; --h) {
-		if (SkipColorIndexZero) {
-			for (unsigned w = srcRect.w; w != 0; --w) {
-				if (*srcBuf != 0)
-					*dstBuf = *srcBuf;
-				++srcBuf, ++dstBuf;
-			}
-			srcBuf += srcPitch - srcRect.w;
-			dstBuf += dstPitch - srcRect.w;
-		} else {
+		if (SkipColorIndex)
+			BlitRowSkipColorIndex(srcBuf, dstBuf, srcRect.w, skipColor);
+		else
 			std::memcpy(dstBuf, srcBuf, srcRect.w);
-			srcBuf += srcPitch;
-			dstBuf += dstPitch;
-		}
+		srcBuf += srcPitch;
+		dstBuf += dstPitch;
 	}
 }
 
@@ -42,12 +69,17 @@ void SurfaceBlit(const Surface &src, SDL_Rect srcRect, const Surface &dst, Point
 
 void Surface::BlitFrom(const Surface &src, SDL_Rect srcRect, Point targetPosition) const
 {
-	SurfaceBlit</*SkipColorIndexZero=*/false>(src, srcRect, *this, targetPosition);
+	SurfaceBlit</*SkipColorIndex=*/false>(src, srcRect, *this, targetPosition);
 }
 
 void Surface::BlitFromSkipColorIndexZero(const Surface &src, SDL_Rect srcRect, Point targetPosition) const
 {
-	SurfaceBlit</*SkipColorIndexZero=*/true>(src, srcRect, *this, targetPosition);
+	SurfaceBlit</*SkipColorIndex=*/true>(src, srcRect, *this, targetPosition);
+}
+
+void Surface::BlitFromSkipColorIndex(const Surface &src, SDL_Rect srcRect, Point targetPosition, std::uint8_t colorIndex) const
+{
+	SurfaceBlit</*SkipColorIndex=*/true>(src, srcRect, *this, targetPosition, colorIndex);
 }
 
 } // namespace devilution
@@ -1,7 +1,9 @@
 #include "hwcursor.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <tuple>
+#include <vector>
 
 #if SDL_VERSION_ATLEAST(2, 0, 0)
 #include <SDL_mouse.h>
@@ -14,6 +16,8 @@
 #include "appfat.h"
 #include "cursor.h"
 #include "engine.h"
+#include "items.h"
+#include "player.h"
 #include "utils/display.h"
 #include "utils/sdl_bilinear_scale.hpp"
 #include "utils/sdl_wrap.h"
@@ -23,13 +27,43 @@ namespace {
 CursorInfo CurrentCursorInfo;
 
 #if SDL_VERSION_ATLEAST(2, 0, 0)
-SDLCursorUniquePtr CurrentCursor;
-
 enum class HotpointPosition {
 	TopLeft,
 	Center,
 };
 
+/** @brief Everything a cursor is rendered from besides the palette. */
+struct CursorKey {
+	CursorType type;
+	int id;
+	/** @brief Outline color and usability of the held item, the sprite alone doesn't tell them apart. */
+	int itemOutline;
+	bool itemUsable;
+	float scaleX;
+	float scaleY;
+	bool bilinear;
+
+	bool operator==(const CursorKey &other) const
+	{
+		return type == other.type && id == other.id && itemOutline == other.itemOutline && itemUsable == other.itemUsable
+		    && scaleX == other.scaleX && scaleY == other.scaleY && bilinear == other.bilinear;
+	}
+};
+
+struct CachedCursor {
+	CursorKey key;
+	SDLCursorUniquePtr cursor;
+};
+
+/** @brief Switching cursors is frequent while moving items around and creating one can hitch on some platforms. */
+constexpr size_t MaxCachedCursors = 32;
+
+/** @brief Sorted from the least to the most recently used, the last one is the current cursor. */
+std::vector<CachedCursor> CachedCursors;
+
+/** @brief Set when the palette or the window scale changed, the cursors are rendered anew and the old ones dropped. */
+bool CachedCursorsStale = false;
+
 Size ScaledSize(Size size)
 {
 	if (renderer != nullptr) {
@@ -67,7 +101,19 @@ bool ShouldUseBilinearScaling()
 	return *sgOptions.Graphics.scaleQuality != ScalingQuality::NearestPixel;
 }
 
-bool SetHardwareCursor(SDL_Surface *surface, HotpointPosition hotpointPosition)
+CursorKey MakeCursorKey(CursorType type, int id)
+{
+	CursorKey key { type, id, -1, true, 1.F, 1.F, ShouldUseBilinearScaling() };
+	if (renderer != nullptr)
+		SDL_RenderGetScale(renderer, &key.scaleX, &key.scaleY);
+	if (type == CursorType::Game && !MyPlayer->HoldItem.isEmpty()) {
+		key.itemOutline = GetOutlineColor(MyPlayer->HoldItem, true);
+		key.itemUsable = MyPlayer->HoldItem._iStatFlag;
+	}
+	return key;
+}
+
+SDLCursorUniquePtr CreateHardwareCursor(SDL_Surface *surface, HotpointPosition hotpointPosition)
 {
 	SDLCursorUniquePtr newCursor;
 	const Size size { surface->w, surface->h };
@@ -89,13 +135,46 @@ bool SetHardwareCursor(SDL_Surface *surface, HotpointPosition hotpointPosition)
 		const Point hotpoint = GetHotpointPosition(*scaledSurface, hotpointPosition);
 		newCursor = SDLCursorUniquePtr { SDL_CreateColorCursor(scaledSurface.get(), hotpoint.x, hotpoint.y) };
 	}
-	if (newCursor == nullptr)
-		return false;
-	SDL_SetCursor(newCursor.get());
-	CurrentCursor = std::move(newCursor);
+	return newCursor;
+}
+
+/**
+ * @brief Sets the cached cursor for the key, createFn() creates the cursor if it isn't cached.
+ */
+template <typename CreateFn>
+bool SetCachedCursor(const CursorKey &key, CreateFn &&createFn)
+{
+	auto cached = std::find_if(CachedCursors.begin(), CachedCursors.end(), [&key](const CachedCursor &entry) {
+		return entry.key == key;
+	});
+	if (!CachedCursorsStale && cached != CachedCursors.end()) {
+		std::rotate(cached, cached + 1, CachedCursors.end());
+	} else {
+		SDLCursorUniquePtr newCursor = createFn();
+		if (newCursor == nullptr)
+			return false;
+		// The current cursor is the last one, so it is never the one evicted.
+		if (cached != CachedCursors.end())
+			CachedCursors.erase(cached);
+		else if (CachedCursors.size() >= MaxCachedCursors)
+			CachedCursors.erase(CachedCursors.begin());
+		CachedCursors.push_back({ key, std::move(newCursor) });
+	}
+	SDL_SetCursor(CachedCursors.back().cursor.get());
+	if (CachedCursorsStale) {
+		CachedCursors.erase(CachedCursors.begin(), CachedCursors.end() - 1);
+		CachedCursorsStale = false;
+	}
 	return true;
 }
 
+bool SetHardwareCursor(SDL_Surface *surface, HotpointPosition hotpointPosition)
+{
+	return SetCachedCursor(MakeCursorKey(CursorType::UserInterface, 0), [&]() {
+		return CreateHardwareCursor(surface, hotpointPosition);
+	});
+}
+
 bool SetHardwareCursorFromSprite(int pcurs)
 {
 	const bool isItem = !MyPlayer->HoldItem.isEmpty();
@@ -111,18 +190,19 @@ bool SetHardwareCursorFromSprite(int pcurs)
 	if (!IsCursorSizeAllowed(size))
 		return false;
 
-	OwnedSurface out { size };
-	SDL_SetSurfacePalette(out.surface, Palette.get());
+	return SetCachedCursor(MakeCursorKey(CursorType::Game, pcurs), [&]() {
+		OwnedSurface out { size };
+		SDL_SetSurfacePalette(out.surface, Palette.get());
 
-	// Transparent color must not be used in the sprite itself.
-	// Colors 1-127 are outside of the UI palette so are safe to use.
-	constexpr std::uint8_t TransparentColor = 1;
-	SDL_FillRect(out.surface, nullptr, TransparentColor);
-	SDL_SetColorKey(out.surface, 1, TransparentColor);
-	DrawSoftwareCursor(out, { outlineWidth, size.height - outlineWidth }, pcurs);
+		// Transparent color must not be used in the sprite itself.
+		// Colors 1-127 are outside of the UI palette so are safe to use.
+		constexpr std::uint8_t TransparentColor = 1;
+		SDL_FillRect(out.surface, nullptr, TransparentColor);
+		SDL_SetColorKey(out.surface, 1, TransparentColor);
+		DrawSoftwareCursor(out, { outlineWidth, size.height - outlineWidth }, pcurs);
 
-	const bool result = SetHardwareCursor(out.surface, isItem ? HotpointPosition::Center : HotpointPosition::TopLeft);
-	return result;
+		return CreateHardwareCursor(out.surface, isItem ? HotpointPosition::Center : HotpointPosition::TopLeft);
+	});
 }
 #endif
 
@@ -157,4 +237,20 @@ void SetHardwareCursor(CursorInfo cursorInfo)
 #endif
 }
 
+void ReinitializeHardwareCursor()
+{
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	CachedCursorsStale = true;
+#endif
+	SetHardwareCursor(GetCurrentCursorInfo());
+}
+
+void FreeHardwareCursors()
+{
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	CachedCursors.clear();
+	CachedCursorsStale = false;
+#endif
+}
+
 } // namespace devilution
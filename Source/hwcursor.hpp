@@ -111,9 +111,16 @@ inline bool IsHardwareCursor()
 
 void SetHardwareCursor(CursorInfo cursorInfo);
 
-inline void ReinitializeHardwareCursor()
-{
-	SetHardwareCursor(GetCurrentCursorInfo());
-}
+/**
+ * @brief Renders the current cursor anew, for when the palette or the window scale changed.
+ *
+ * The cursors rendered before are dropped from the cache.
+ */
+void ReinitializeHardwareCursor();
+
+/**
+ * @brief Frees the cached cursors, e.g. because the UI cursor they were rendered from was unloaded.
+ */
+void FreeHardwareCursors();
 
 } // namespace devilution
@@ -5,7 +5,9 @@
  */
 #include <SDL.h>
 #include <config.h>
+#include <initializer_list>
 #include <string>
+#include <utility>
 #include <vector>
 
 #if (defined(_WIN64) || defined(_WIN32)) && !defined(__UWP__) && !defined(NXDK)
@@ -13,15 +15,20 @@
 #endif
 
 #include "DiabloUI/diabloui.h"
+#include "capture.h"
+#include "engine/asset_prefetch.hpp"
 #include "engine/assets.hpp"
 #include "engine/dx.h"
+#include "engine/load_file.hpp"
 #include "miniwin/misc_msg.h"
 #include "mpq/mpq_reader.hpp"
 #include "options.h"
 #include "pfile.h"
+#include "utils/job_system.hpp"
 #include "utils/language.h"
 #include "utils/log.hpp"
 #include "utils/paths.h"
+#include "utils/perf_scope.hpp"
 #include "utils/ui_fwd.h"
 #include "utils/utf8.hpp"
 
@@ -83,6 +90,34 @@ std::optional<MpqArchive> LoadMPQ(const std::vector<std::string> &paths, string_
 	return std::nullopt;
 }
 
+/** @brief An archive for LoadMPQs to open, fallbackName is tried if name isn't found. */
+struct ArchiveToLoad {
+	std::optional<MpqArchive> *archive;
+	string_view name;
+	string_view fallbackName = {};
+};
+
+/**
+ * @brief Opens the archives on the asset loading threads, each searching the paths and parsing its tables on its own.
+ *
+ * The order the archives are looked up in is given by the archive variables, so it doesn't depend on which one opens first.
+ */
+void LoadMPQs(const std::vector<std::string> &paths, std::initializer_list<ArchiveToLoad> archives)
+{
+	const auto load = [&](int i) {
+		const ArchiveToLoad &toLoad = archives.begin()[i];
+		*toLoad.archive = LoadMPQ(paths, toLoad.name);
+		if (!*toLoad.archive && !toLoad.fallbackName.empty())
+			*toLoad.archive = LoadMPQ(paths, toLoad.fallbackName);
+	};
+	if (ThreadPool *threads = GetAssetLoadingThreads(); threads != nullptr) {
+		threads->ParallelFor(static_cast<int>(archives.size()), load);
+	} else {
+		for (size_t i = 0; i < archives.size(); i++)
+			load(static_cast<int>(i));
+	}
+}
+
 std::vector<std::string> GetMPQSearchPaths()
 {
 	std::vector<std::string> paths;
@@ -131,6 +166,13 @@ void init_cleanup()
 		pfile_write_hero(/*writeGameData=*/false);
 		sfile_write_stash();
 	}
+	pfile_wait_for_save();
+	WaitForScreenshot();
+	WaitForFlightRecorder();
+
+	// The prefetch thread reads from clones of the archives, and so may the jobs.
+	StopAssetPrefetch();
+	StopJobSystem();
 
 	spawn_mpq = std::nullopt;
 	diabdat_mpq = std::nullopt;
@@ -143,23 +185,31 @@ void init_cleanup()
 	lang_mpq = std::nullopt;
 	font_mpq = std::nullopt;
 	devilutionx_mpq = std::nullopt;
+	ResetAssetIndex();
 
 	NetClose();
 }
 
 void LoadCoreArchives()
 {
+	DVL_PERF_FUNCTION();
+
 	auto paths = GetMPQSearchPaths();
 
+	LoadMPQs(paths, {
 #if !defined(__ANDROID__) && !defined(__APPLE__)
-	// Load devilutionx.mpq first to get the font file for error messages
-	devilutionx_mpq = LoadMPQ(paths, "devilutionx.mpq");
+	                    // Load devilutionx.mpq first to get the font file for error messages
+	                    { &devilutionx_mpq, "devilutionx.mpq" },
 #endif
-	font_mpq = LoadMPQ(paths, "fonts.mpq"); // Extra fonts
+	                    { &font_mpq, "fonts.mpq" }, // Extra fonts
+	                });
+	ResetAssetIndex();
 }
 
 void LoadLanguageArchive()
 {
+	DVL_PERF_FUNCTION();
+
 	lang_mpq = std::nullopt;
 
 	string_view code = *sgOptions.Language.code;
@@ -170,23 +220,36 @@ void LoadLanguageArchive()
 		auto paths = GetMPQSearchPaths();
 		lang_mpq = LoadMPQ(paths, langMpqName);
 	}
+	ResetAssetIndex();
 }
 
 void LoadGameArchives()
 {
-	auto paths = GetMPQSearchPaths();
+	DVL_PERF_FUNCTION();
 
-	diabdat_mpq = LoadMPQ(paths, "DIABDAT.MPQ");
-	if (!diabdat_mpq) {
-		// DIABDAT.MPQ is uppercase on the original CD and the GOG version.
-		diabdat_mpq = LoadMPQ(paths, "diabdat.mpq");
-	}
+	auto paths = GetMPQSearchPaths();
 
-	if (!diabdat_mpq) {
-		spawn_mpq = LoadMPQ(paths, "spawn.mpq");
-		if (spawn_mpq)
-			gbIsSpawn = true;
-	}
+	// spawn.mpq is opened alongside the others and dropped again if the full game is found.
+	LoadMPQs(paths, {
+	                    // DIABDAT.MPQ is uppercase on the original CD and the GOG version.
+	                    { &diabdat_mpq, "DIABDAT.MPQ", "diabdat.mpq" },
+	                    { &spawn_mpq, "spawn.mpq" },
+	                    { &hellfire_mpq, "hellfire.mpq" },
+	                    { &hfmonk_mpq, "hfmonk.mpq" },
+	                    { &hfbard_mpq, "hfbard.mpq" },
+	                    { &hfbarb_mpq, "hfbarb.mpq" },
+	                    { &hfmusic_mpq, "hfmusic.mpq" },
+	                    { &hfvoice_mpq, "hfvoice.mpq" },
+	                });
+
+	if (diabdat_mpq)
+		spawn_mpq = std::nullopt;
+	else if (spawn_mpq)
+		gbIsSpawn = true;
+
+	// The title has to come from the base game, so hellfire.mpq is left out of the check below.
+	std::optional<MpqArchive> hellfireArchive = std::exchange(hellfire_mpq, std::nullopt);
+	ResetAssetIndex();
 	if (!HeadlessMode) {
 		SDL_RWops *handle = OpenAsset("ui_art\\title.pcx");
 		if (handle == nullptr) {
@@ -196,21 +259,17 @@ void LoadGameArchives()
 		SDL_RWclose(handle);
 	}
 
-	hellfire_mpq = LoadMPQ(paths, "hellfire.mpq");
+	hellfire_mpq = std::move(hellfireArchive);
+	ResetAssetIndex();
 	if (hellfire_mpq)
 		gbIsHellfire = true;
 	if (forceHellfire && !hellfire_mpq)
 		InsertCDDlg("hellfire.mpq");
 
-	hfmonk_mpq = LoadMPQ(paths, "hfmonk.mpq");
-	hfbard_mpq = LoadMPQ(paths, "hfbard.mpq");
 	if (hfbard_mpq)
 		gbBard = true;
-	hfbarb_mpq = LoadMPQ(paths, "hfbarb.mpq");
 	if (hfbarb_mpq)
 		gbBarbarian = true;
-	hfmusic_mpq = LoadMPQ(paths, "hfmusic.mpq");
-	hfvoice_mpq = LoadMPQ(paths, "hfvoice.mpq");
 
 	if (gbIsHellfire && (!hfmonk_mpq || !hfmusic_mpq || !hfvoice_mpq)) {
 		UiErrorOkDialog(_("Some Hellfire MPQs are missing"), _("Not all Hellfire MPQs were found.\nPlease copy all the hf*.mpq files."));
@@ -220,6 +279,8 @@ void LoadGameArchives()
 
 void init_create_window()
 {
+	DVL_PERF_FUNCTION();
+
 	if (!SpawnWindow(PROJECT_NAME))
 		app_fatal(_("Unable to create main window"));
 	dx_init();
@@ -4,12 +4,15 @@
  * Implementation of load screens.
  */
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 
 #include <SDL.h>
 
 #include "control.h"
 #include "engine.h"
+#include "engine/asset_prefetch.hpp"
 #include "engine/cel_sprite.hpp"
 #include "engine/dx.h"
 #include "engine/load_cel.hpp"
@@ -30,6 +33,9 @@ namespace devilution {
 namespace {
 
 constexpr uint32_t MaxProgress = 534;
+constexpr uint32_t ProgressStep = 23;
+/** @brief Minimum time between two redraws of the progress bar by ProgressPump. */
+constexpr uint32_t ProgressPumpIntervalMs = 33;
 
 OptionalOwnedCelSprite sgpBackCel;
 
@@ -37,6 +43,17 @@ bool IsProgress;
 uint32_t sgdwProgress;
 int progress_id;
 
+/** @brief Number of the current checkpoint, the bar is at least `ProgressCheckpoint * ProgressStep` long. */
+uint32_t ProgressCheckpoint;
+uint32_t ProgressStepStartTicks;
+uint32_t ProgressLastPumpTicks;
+/**
+ * @brief How long the steps between the checkpoints took in ms, averaged over the previous loads.
+ *
+ * The steps of different transitions differ, but mostly in the dungeon generation and the assets they load.
+ */
+std::array<uint32_t, MaxProgress / ProgressStep + 2> ProgressStepCosts;
+
 /** The color used for the progress bar as an index into the palette. */
 const uint8_t BarColor[3] = { 138, 43, 254 };
 /** The screen position of the top left corner of the progress bar. */
@@ -222,9 +239,35 @@ void IncProgress()
 	interface_msg_pump();
 	if (!IsProgress)
 		return;
-	sgdwProgress += 23;
-	if (sgdwProgress > MaxProgress)
-		sgdwProgress = MaxProgress;
+	const uint32_t now = SDL_GetTicks();
+	if (ProgressCheckpoint < ProgressStepCosts.size()) {
+		uint32_t &cost = ProgressStepCosts[ProgressCheckpoint];
+		const uint32_t elapsed = now - ProgressStepStartTicks;
+		cost = cost == 0 ? elapsed : (cost + elapsed) / 2;
+	}
+	ProgressCheckpoint++;
+	ProgressStepStartTicks = now;
+	ProgressLastPumpTicks = now;
+	sgdwProgress = std::max(sgdwProgress, std::min(ProgressCheckpoint * ProgressStep, MaxProgress));
+	DrawCutsceneForeground();
+}
+
+void ProgressPump()
+{
+	if (HeadlessMode || !IsProgress)
+		return;
+	const uint32_t now = SDL_GetTicks();
+	if (now - ProgressLastPumpTicks < ProgressPumpIntervalMs)
+		return;
+	ProgressLastPumpTicks = now;
+	interface_msg_pump();
+
+	// Never reach the next checkpoint early, the step may take longer than the last time.
+	if (ProgressCheckpoint < ProgressStepCosts.size() && ProgressStepCosts[ProgressCheckpoint] != 0) {
+		const uint32_t elapsed = now - ProgressStepStartTicks;
+		const uint32_t creep = std::min(elapsed, ProgressStepCosts[ProgressCheckpoint]) * (ProgressStep - 1) / ProgressStepCosts[ProgressCheckpoint];
+		sgdwProgress = std::max(sgdwProgress, std::min(ProgressCheckpoint * ProgressStep + creep, MaxProgress));
+	}
 	DrawCutsceneForeground();
 }
 
@@ -241,6 +284,9 @@ void CompleteProgress()
 void ShowProgress(interface_mode uMsg)
 {
 	IsProgress = true;
+	ProgressCheckpoint = 0;
+	ProgressStepStartTicks = SDL_GetTicks();
+	ProgressLastPumpTicks = ProgressStepStartTicks;
 
 	gbSomebodyWonGameKludge = false;
 	plrmsg_delay(true);
@@ -291,7 +337,7 @@ void ShowProgress(interface_mode uMsg)
 	case WM_DIABNEWGAME:
 		myPlayer.pOriginalCathedral = !gbIsHellfire;
 		IncProgress();
-		FreeGameMem();
+		FreeLevelMem();
 		IncProgress();
 		pfile_remove_temp_files();
 		IncProgress();
@@ -306,7 +352,7 @@ void ShowProgress(interface_mode uMsg)
 			DeltaSaveLevel();
 		}
 		IncProgress();
-		FreeGameMem();
+		FreeLevelMem();
 		setlevel = false;
 		currlevel = myPlayer.plrlevel;
 		leveltype = GetLevelType(currlevel);
@@ -322,7 +368,7 @@ void ShowProgress(interface_mode uMsg)
 			DeltaSaveLevel();
 		}
 		IncProgress();
-		FreeGameMem();
+		FreeLevelMem();
 		currlevel--;
 		leveltype = GetLevelType(currlevel);
 		assert(myPlayer.isOnActiveLevel());
@@ -341,7 +387,7 @@ void ShowProgress(interface_mode uMsg)
 		IncProgress();
 		setlevel = true;
 		leveltype = setlvltype;
-		FreeGameMem();
+		FreeLevelMem();
 		IncProgress();
 		LoadGameLevel(false, ENTRY_SETLVL);
 		IncProgress();
@@ -355,7 +401,7 @@ void ShowProgress(interface_mode uMsg)
 		}
 		IncProgress();
 		setlevel = false;
-		FreeGameMem();
+		FreeLevelMem();
 		IncProgress();
 		GetReturnLvlPos();
 		LoadGameLevel(false, ENTRY_RTNLVL);
@@ -369,7 +415,7 @@ void ShowProgress(interface_mode uMsg)
 			DeltaSaveLevel();
 		}
 		IncProgress();
-		FreeGameMem();
+		FreeLevelMem();
 		GetPortalLevel();
 		IncProgress();
 		LoadGameLevel(false, ENTRY_WARPLVL);
@@ -383,7 +429,7 @@ void ShowProgress(interface_mode uMsg)
 			DeltaSaveLevel();
 		}
 		IncProgress();
-		FreeGameMem();
+		FreeLevelMem();
 		setlevel = false;
 		currlevel = myPlayer.plrlevel;
 		leveltype = GetLevelType(currlevel);
@@ -399,7 +445,7 @@ void ShowProgress(interface_mode uMsg)
 			DeltaSaveLevel();
 		}
 		IncProgress();
-		FreeGameMem();
+		FreeLevelMem();
 		currlevel = myPlayer.plrlevel;
 		leveltype = GetLevelType(currlevel);
 		IncProgress();
@@ -414,7 +460,7 @@ void ShowProgress(interface_mode uMsg)
 			DeltaSaveLevel();
 		}
 		IncProgress();
-		FreeGameMem();
+		FreeLevelMem();
 		setlevel = false;
 		currlevel = myPlayer.plrlevel;
 		leveltype = GetLevelType(currlevel);
@@ -424,6 +470,9 @@ void ShowProgress(interface_mode uMsg)
 		break;
 	}
 
+	// Anything that was prefetched for a different destination is no longer needed.
+	DiscardPrefetchedAssets();
+
 	if (!HeadlessMode) {
 		assert(ghMainWnd);
 
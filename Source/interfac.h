@@ -45,6 +45,13 @@ enum Cutscenes : uint8_t {
 
 void interface_msg_pump();
 void IncProgress();
+/**
+ * @brief Keeps the window responsive between the progress checkpoints of a long loading step.
+ *
+ * Events are pumped and the bar creeps towards the next checkpoint, by how long the step took the last time, at most
+ * ~30 times a second. Cheap enough to call from the inner loops of level loading, does nothing outside of it.
+ */
+void ProgressPump();
 void CompleteProgress();
 void ShowProgress(interface_mode uMsg);
 
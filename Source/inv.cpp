@@ -16,12 +16,14 @@
 #include "engine/render/cl2_render.hpp"
 #include "engine/render/text_render.hpp"
 #include "engine/size.hpp"
+#include "engine/trn.hpp"
 #include "hwcursor.hpp"
 #include "inv_iterators.hpp"
 #include "levels/town.h"
 #include "minitext.h"
 #include "miniwin/misc_msg.h"
 #include "options.h"
+#include "panels/cached_panel.hpp"
 #include "panels/ui_panels.hpp"
 #include "plrmsg.h"
 #include "qol/stash.h"
@@ -165,6 +167,36 @@ void AddItemToInvGrid(Player &player, int invGridIndex, int invListIndex, Size i
 	}
 }
 
+/**
+ * @brief Bitmasks of the occupied cells of each inventory row, used to reject slots without visiting their cells.
+ */
+struct InventoryOccupancy {
+	uint16_t rows[InventoryGridCells / 10] = {};
+
+	explicit InventoryOccupancy(const Player &player)
+	{
+		for (int i = 0; i < InventoryGridCells; i++) {
+			if (player.InvGrid[i] != 0)
+				rows[i / 10] |= 1 << (i % 10);
+		}
+	}
+
+	/** @brief Same checks as AutoPlaceItemInInventorySlot, for an item with the given top left slot. */
+	[[nodiscard]] bool fits(int slotIndex, Size itemSize) const
+	{
+		const int x = slotIndex % 10;
+		const int y = slotIndex / 10;
+		if (x + itemSize.width > 10 || y + itemSize.height > InventoryGridCells / 10)
+			return false;
+		const unsigned mask = ((1U << itemSize.width) - 1) << x;
+		for (int j = 0; j < itemSize.height; j++) {
+			if ((rows[y + j] & mask) != 0)
+				return false;
+		}
+		return true;
+	}
+};
+
 /**
  * @brief Checks whether the given item can fit in a belt slot (i.e. the item's size in inventory cells is 1x1).
  * @param item The item to be checked.
@@ -1020,68 +1052,44 @@ int CreateGoldItemInInventorySlot(Player &player, int slotIndex, int value)
 	return value;
 }
 
-} // namespace
-
-void InvDrawSlotBack(const Surface &out, Point targetPosition, Size size)
-{
-	SDL_Rect srcRect = MakeSdlRect(0, 0, size.width, size.height);
-	out.Clip(&srcRect, &targetPosition);
-	if (size.width <= 0 || size.height <= 0)
-		return;
+struct InvPanelContents {
+	std::array<std::optional<InvPanelItem>, NUM_INVLOC> body;
+	bool leftHandTwoHanded;
+	std::array<bool, InventoryGridCells> occupied;
+	/** @brief The items of the inventory grid, at the index of their first cell. */
+	std::array<std::optional<InvPanelItem>, InventoryGridCells> items;
 
-	std::uint8_t *dst = &out[targetPosition];
-	const auto dstPitch = out.pitch();
-
-	for (int hgt = size.height; hgt != 0; hgt--, dst -= dstPitch + size.width) {
-		for (int wdt = size.width; wdt != 0; wdt--) {
-			std::uint8_t pix = *dst;
-			if (pix >= PAL16_BLUE) {
-				if (pix <= PAL16_BLUE + 15)
-					pix -= PAL16_BLUE - PAL16_BEIGE;
-				else if (pix >= PAL16_GRAY)
-					pix -= PAL16_GRAY - PAL16_BEIGE;
-			}
-			*dst++ = pix;
-		}
+	bool operator==(const InvPanelContents &other) const
+	{
+		return body == other.body && leftHandTwoHanded == other.leftHandTwoHanded && occupied == other.occupied && items == other.items;
 	}
-}
+};
 
-bool CanBePlacedOnBelt(const Item &item)
-{
-	return FitsInBeltSlot(item)
-	    && item._itype != ItemType::Gold
-	    && MyPlayer->CanUseItem(item)
-	    && AllItemsList[item.IDidx].iUsable;
-}
+CachedPanel<InvPanelContents> InvPanelCache;
 
-void FreeInvGFX()
+InvPanelItem GetInvPanelItem(const Item &item, bool highlighted)
 {
-	pInvCels = std::nullopt;
+	InvPanelItem panelItem { item._iCurs + CURSOR_FIRSTITEM, item._iStatFlag, std::nullopt };
+	if (highlighted)
+		panelItem.outline = GetOutlineColor(item, true);
+	return panelItem;
 }
 
-void InitInv()
+void DrawInvPanelItem(const Surface &out, const InvPanelItem &item, Point position, const CelSprite &cel, int celFrame)
 {
-	switch (MyPlayer->_pClass) {
-	case HeroClass::Warrior:
-	case HeroClass::Barbarian:
-		pInvCels = LoadCelAsCl2("Data\\Inv\\Inv.CEL", static_cast<uint16_t>(SidePanelSize.width));
-		break;
-	case HeroClass::Rogue:
-	case HeroClass::Bard:
-		pInvCels = LoadCelAsCl2("Data\\Inv\\Inv_rog.CEL", static_cast<uint16_t>(SidePanelSize.width));
-		break;
-	case HeroClass::Sorcerer:
-		pInvCels = LoadCelAsCl2("Data\\Inv\\Inv_Sor.CEL", static_cast<uint16_t>(SidePanelSize.width));
-		break;
-	case HeroClass::Monk:
-		pInvCels = LoadCelAsCl2(!gbIsSpawn ? "Data\\Inv\\Inv_Sor.CEL" : "Data\\Inv\\Inv.CEL", static_cast<uint16_t>(SidePanelSize.width));
-		break;
-	}
+	if (item.outline)
+		Cl2DrawOutline(out, *item.outline, position, cel, celFrame);
+
+	// Same as DrawItem
+	if (item.usable)
+		Cl2Draw(out, position, cel, celFrame);
+	else
+		Cl2DrawTRNCached(out, position, cel, celFrame, GetInfravisionTRN());
 }
 
-void DrawInv(const Surface &out)
+void DrawInvContents(const Surface &out, const InvPanelContents &contents)
 {
-	Cl2Draw(out, GetPanelPosition(UiPanels::Inventory, { 0, 351 }), CelSprite { *pInvCels }, 0);
+	Cl2Draw(out, { 0, 351 }, CelSprite { *pInvCels }, 0);
 
 	Size slotSize[] = {
 		{ 2, 2 }, // head
@@ -1103,17 +1111,14 @@ void DrawInv(const Surface &out)
 		{ 133, 160 }, // chest
 	};
 
-	Player &myPlayer = *MyPlayer;
-
 	for (int slot = INVLOC_HEAD; slot < NUM_INVLOC; slot++) {
-		if (!myPlayer.InvBody[slot].isEmpty()) {
+		if (contents.body[slot]) {
+			const InvPanelItem &item = *contents.body[slot];
 			int screenX = slotPos[slot].x;
 			int screenY = slotPos[slot].y;
-			InvDrawSlotBack(out, GetPanelPosition(UiPanels::Inventory, { screenX, screenY }), { slotSize[slot].width * InventorySlotSizeInPixels.width, slotSize[slot].height * InventorySlotSizeInPixels.height });
-
-			const int cursId = myPlayer.InvBody[slot]._iCurs + CURSOR_FIRSTITEM;
+			InvDrawSlotBack(out, { screenX, screenY }, { slotSize[slot].width * InventorySlotSizeInPixels.width, slotSize[slot].height * InventorySlotSizeInPixels.height });
 
-			auto frameSize = GetInvItemSize(cursId);
+			auto frameSize = GetInvItemSize(item.cursId);
 
 			// calc item offsets for weapons smaller than 2x3 slots
 			if (slot == INVLOC_HAND_LEFT) {
@@ -1124,101 +1129,174 @@ void DrawInv(const Surface &out)
 				screenY += frameSize.height == (3 * InventorySlotSizeInPixels.height) ? 0 : -INV_SLOT_HALF_SIZE_PX;
 			}
 
-			const CelSprite cel { GetInvItemSprite(cursId) };
-			const int celFrame = GetInvItemFrame(cursId);
-			const Point position = GetPanelPosition(UiPanels::Inventory, { screenX, screenY });
-
-			if (pcursinvitem == slot) {
-				Cl2DrawOutline(out, GetOutlineColor(myPlayer.InvBody[slot], true), position, cel, celFrame);
-			}
-
-			DrawItem(myPlayer.InvBody[slot], out, position, cel, celFrame);
+			const CelSprite cel { GetInvItemSprite(item.cursId) };
+			const int celFrame = GetInvItemFrame(item.cursId);
+			DrawInvPanelItem(out, item, { screenX, screenY }, cel, celFrame);
 
-			if (slot == INVLOC_HAND_LEFT) {
-				if (myPlayer.GetItemLocation(myPlayer.InvBody[slot]) == ILOC_TWOHAND) {
-					InvDrawSlotBack(out, GetPanelPosition(UiPanels::Inventory, slotPos[INVLOC_HAND_RIGHT]), { slotSize[INVLOC_HAND_RIGHT].width * InventorySlotSizeInPixels.width, slotSize[INVLOC_HAND_RIGHT].height * InventorySlotSizeInPixels.height });
-					LightTableIndex = 0;
-					cel_transparency_active = true;
+			if (slot == INVLOC_HAND_LEFT && contents.leftHandTwoHanded) {
+				InvDrawSlotBack(out, slotPos[INVLOC_HAND_RIGHT], { slotSize[INVLOC_HAND_RIGHT].width * InventorySlotSizeInPixels.width, slotSize[INVLOC_HAND_RIGHT].height * InventorySlotSizeInPixels.height });
+				LightTableIndex = 0;
+				cel_transparency_active = true;
 
-					const int dstX = GetRightPanel().position.x + slotPos[INVLOC_HAND_RIGHT].x + (frameSize.width == InventorySlotSizeInPixels.width ? INV_SLOT_HALF_SIZE_PX : 0) - 1;
-					const int dstY = GetRightPanel().position.y + slotPos[INVLOC_HAND_RIGHT].y;
-					Cl2DrawLightBlended(out, { dstX, dstY }, cel, celFrame);
+				const int dstX = slotPos[INVLOC_HAND_RIGHT].x + (frameSize.width == InventorySlotSizeInPixels.width ? INV_SLOT_HALF_SIZE_PX : 0) - 1;
+				const int dstY = slotPos[INVLOC_HAND_RIGHT].y;
+				Cl2DrawLightBlended(out, { dstX, dstY }, cel, celFrame);
 
-					cel_transparency_active = false;
-				}
+				cel_transparency_active = false;
 			}
 		}
 	}
 
 	for (int i = 0; i < InventoryGridCells; i++) {
-		if (myPlayer.InvGrid[i] != 0) {
+		if (contents.occupied[i]) {
 			InvDrawSlotBack(
 			    out,
-			    GetPanelPosition(UiPanels::Inventory, InvRect[i + SLOTXY_INV_FIRST]) + Displacement { 0, -1 },
+			    InvRect[i + SLOTXY_INV_FIRST] + Displacement { 0, -1 },
 			    InventorySlotSizeInPixels);
 		}
 	}
 
 	for (int j = 0; j < InventoryGridCells; j++) {
-		if (myPlayer.InvGrid[j] > 0) { // first slot of an item
-			int ii = myPlayer.InvGrid[j] - 1;
-			int cursId = myPlayer.InvList[ii]._iCurs + CURSOR_FIRSTITEM;
-
-			const CelSprite cel { GetInvItemSprite(cursId) };
-			const int celFrame = GetInvItemFrame(cursId);
-			const Point position = GetPanelPosition(UiPanels::Inventory, InvRect[j + SLOTXY_INV_FIRST]) + Displacement { 0, -1 };
-			if (pcursinvitem == ii + INVITEM_INV_FIRST) {
-				Cl2DrawOutline(out, GetOutlineColor(myPlayer.InvList[ii], true), position, cel, celFrame);
-			}
-
-			DrawItem(
-			    myPlayer.InvList[ii],
-			    out,
-			    position,
-			    cel, celFrame);
+		if (contents.items[j]) {
+			const InvPanelItem &item = *contents.items[j];
+			const CelSprite cel { GetInvItemSprite(item.cursId) };
+			const int celFrame = GetInvItemFrame(item.cursId);
+			DrawInvPanelItem(out, item, InvRect[j + SLOTXY_INV_FIRST] + Displacement { 0, -1 }, cel, celFrame);
 		}
 	}
 }
 
-void DrawInvBelt(const Surface &out)
+} // namespace
+
+void InvDrawSlotBack(const Surface &out, Point targetPosition, Size size)
 {
-	if (talkflag) {
+	SDL_Rect srcRect = MakeSdlRect(0, 0, size.width, size.height);
+	out.Clip(&srcRect, &targetPosition);
+	if (size.width <= 0 || size.height <= 0)
 		return;
+
+	std::uint8_t *dst = &out[targetPosition];
+	const auto dstPitch = out.pitch();
+
+	for (int hgt = size.height; hgt != 0; hgt--, dst -= dstPitch + size.width) {
+		for (int wdt = size.width; wdt != 0; wdt--) {
+			std::uint8_t pix = *dst;
+			if (pix >= PAL16_BLUE) {
+				if (pix <= PAL16_BLUE + 15)
+					pix -= PAL16_BLUE - PAL16_BEIGE;
+				else if (pix >= PAL16_GRAY)
+					pix -= PAL16_GRAY - PAL16_BEIGE;
+			}
+			*dst++ = pix;
+		}
 	}
+}
 
-	const Point mainPanelPosition = GetMainPanel().position;
+bool CanBePlacedOnBelt(const Item &item)
+{
+	return FitsInBeltSlot(item)
+	    && item._itype != ItemType::Gold
+	    && MyPlayer->CanUseItem(item)
+	    && AllItemsList[item.IDidx].iUsable;
+}
 
-	DrawPanelBox(out, { 205, 21, 232, 28 }, mainPanelPosition + Displacement { 205, 5 });
+void FreeInvGFX()
+{
+	InvPanelCache.Clear();
+	pInvCels = std::nullopt;
+}
 
+void InitInv()
+{
+	switch (MyPlayer->_pClass) {
+	case HeroClass::Warrior:
+	case HeroClass::Barbarian:
+		pInvCels = LoadCelAsCl2("Data\\Inv\\Inv.CEL", static_cast<uint16_t>(SidePanelSize.width));
+		break;
+	case HeroClass::Rogue:
+	case HeroClass::Bard:
+		pInvCels = LoadCelAsCl2("Data\\Inv\\Inv_rog.CEL", static_cast<uint16_t>(SidePanelSize.width));
+		break;
+	case HeroClass::Sorcerer:
+		pInvCels = LoadCelAsCl2("Data\\Inv\\Inv_Sor.CEL", static_cast<uint16_t>(SidePanelSize.width));
+		break;
+	case HeroClass::Monk:
+		pInvCels = LoadCelAsCl2(!gbIsSpawn ? "Data\\Inv\\Inv_Sor.CEL" : "Data\\Inv\\Inv.CEL", static_cast<uint16_t>(SidePanelSize.width));
+		break;
+	}
+}
+
+void DrawInv(const Surface &out)
+{
 	Player &myPlayer = *MyPlayer;
+	InvPanelContents contents {};
+	for (int slot = INVLOC_HEAD; slot < NUM_INVLOC; slot++) {
+		const Item &item = myPlayer.InvBody[slot];
+		if (!item.isEmpty())
+			contents.body[slot] = GetInvPanelItem(item, pcursinvitem == slot);
+	}
+	contents.leftHandTwoHanded = !myPlayer.InvBody[INVLOC_HAND_LEFT].isEmpty() && myPlayer.GetItemLocation(myPlayer.InvBody[INVLOC_HAND_LEFT]) == ILOC_TWOHAND;
+	for (int i = 0; i < InventoryGridCells; i++) {
+		contents.occupied[i] = myPlayer.InvGrid[i] != 0;
+		if (myPlayer.InvGrid[i] > 0) { // first slot of an item
+			const int ii = myPlayer.InvGrid[i] - 1;
+			contents.items[i] = GetInvPanelItem(myPlayer.InvList[ii], pcursinvitem == ii + INVITEM_INV_FIRST);
+		}
+	}
+
+	InvPanelCache.Draw(out, GetPanelPosition(UiPanels::Inventory, { 0, 0 }), contents, DrawInvContents);
+}
+
+void GetBeltContents(BeltContents &contents)
+{
+	const Player &myPlayer = *MyPlayer;
 
 	for (int i = 0; i < MaxBeltItems; i++) {
-		if (myPlayer.SpdList[i].isEmpty()) {
+		const Item &item = myPlayer.SpdList[i];
+		contents.numbered[i] = false;
+		if (item.isEmpty()) {
+			contents.items[i] = std::nullopt;
 			continue;
 		}
 
-		const Point position { InvRect[i + SLOTXY_BELT_FIRST].x + mainPanelPosition.x, InvRect[i + SLOTXY_BELT_FIRST].y + mainPanelPosition.y - 1 };
-		InvDrawSlotBack(out, position, InventorySlotSizeInPixels);
-		const int cursId = myPlayer.SpdList[i]._iCurs + CURSOR_FIRSTITEM;
+		const bool highlighted = pcursinvitem == i + INVITEM_BELT_FIRST && (ControlMode == ControlTypes::KeyboardAndMouse || invflag);
+		contents.items[i] = GetInvPanelItem(item, highlighted);
+		contents.numbered[i] = AllItemsList[item.IDidx].iUsable && item._itype != ItemType::Gold;
+	}
+}
 
-		const CelSprite cel { GetInvItemSprite(cursId) };
-		const int celFrame = GetInvItemFrame(cursId);
+void DrawBeltContents(const Surface &out, Point panelPosition, const BeltContents &contents)
+{
+	DrawPanelBox(out, { 205, 21, 232, 28 }, panelPosition + Displacement { 205, 5 });
 
-		if (pcursinvitem == i + INVITEM_BELT_FIRST) {
-			if (ControlMode == ControlTypes::KeyboardAndMouse || invflag) {
-				Cl2DrawOutline(out, GetOutlineColor(myPlayer.SpdList[i], true), position, cel, celFrame);
-			}
+	for (int i = 0; i < MaxBeltItems; i++) {
+		if (!contents.items[i]) {
+			continue;
 		}
 
-		DrawItem(myPlayer.SpdList[i], out, position, cel, celFrame);
+		const InvPanelItem &item = *contents.items[i];
+		const Point position { InvRect[i + SLOTXY_BELT_FIRST].x + panelPosition.x, InvRect[i + SLOTXY_BELT_FIRST].y + panelPosition.y - 1 };
+		InvDrawSlotBack(out, position, InventorySlotSizeInPixels);
+
+		DrawInvPanelItem(out, item, position, CelSprite { GetInvItemSprite(item.cursId) }, GetInvItemFrame(item.cursId));
 
-		if (AllItemsList[myPlayer.SpdList[i].IDidx].iUsable
-		    && myPlayer.SpdList[i]._itype != ItemType::Gold) {
+		if (contents.numbered[i]) {
 			DrawString(out, StrCat(i + 1), { position - Displacement { 0, 12 }, InventorySlotSizeInPixels }, UiFlags::ColorWhite | UiFlags::AlignRight);
 		}
 	}
 }
 
+void DrawInvBelt(const Surface &out)
+{
+	if (talkflag) {
+		return;
+	}
+
+	static BeltContents contents;
+	GetBeltContents(contents);
+	DrawBeltContents(out, GetMainPanel().position, contents);
+}
+
 void RemoveEquipment(Player &player, inv_body_loc bodyLocation, bool hiPri)
 {
 	if (&player == MyPlayer) {
@@ -1295,14 +1373,20 @@ bool AutoPlaceItemInInventory(Player &player, const Item &item, bool persistItem
 {
 	Size itemSize = GetInventorySize(item);
 
+	// The grid doesn't change until the item is placed, so the free cells only have to be looked up once
+	const InventoryOccupancy occupancy { player };
+	const auto tryPlace = [&](int slotIndex) {
+		return occupancy.fits(slotIndex, itemSize) && AutoPlaceItemInInventorySlot(player, slotIndex, item, persistItem);
+	};
+
 	if (itemSize.height == 1) {
 		for (int i = 30; i <= 39; i++) {
-			if (AutoPlaceItemInInventorySlot(player, i, item, persistItem))
+			if (tryPlace(i))
 				return true;
 		}
 		for (int x = 9; x >= 0; x--) {
 			for (int y = 2; y >= 0; y--) {
-				if (AutoPlaceItemInInventorySlot(player, 10 * y + x, item, persistItem))
+				if (tryPlace(10 * y + x))
 					return true;
 			}
 		}
@@ -1312,14 +1396,14 @@ bool AutoPlaceItemInInventory(Player &player, const Item &item, bool persistItem
 	if (itemSize.height == 2) {
 		for (int x = 10 - itemSize.width; x >= 0; x -= itemSize.width) {
 			for (int y = 0; y < 3; y++) {
-				if (AutoPlaceItemInInventorySlot(player, 10 * y + x, item, persistItem))
+				if (tryPlace(10 * y + x))
 					return true;
 			}
 		}
 		if (itemSize.width == 2) {
 			for (int x = 7; x >= 0; x -= 2) {
 				for (int y = 0; y < 3; y++) {
-					if (AutoPlaceItemInInventorySlot(player, 10 * y + x, item, persistItem))
+					if (tryPlace(10 * y + x))
 						return true;
 				}
 			}
@@ -1329,7 +1413,7 @@ bool AutoPlaceItemInInventory(Player &player, const Item &item, bool persistItem
 
 	if (itemSize == Size { 1, 3 }) {
 		for (int i = 0; i < 20; i++) {
-			if (AutoPlaceItemInInventorySlot(player, i, item, persistItem))
+			if (tryPlace(i))
 				return true;
 		}
 		return false;
@@ -1337,12 +1421,12 @@ bool AutoPlaceItemInInventory(Player &player, const Item &item, bool persistItem
 
 	if (itemSize == Size { 2, 3 }) {
 		for (int i = 0; i < 9; i++) {
-			if (AutoPlaceItemInInventorySlot(player, i, item, persistItem))
+			if (tryPlace(i))
 				return true;
 		}
 
 		for (int i = 10; i < 19; i++) {
-			if (AutoPlaceItemInInventorySlot(player, i, item, persistItem))
+			if (tryPlace(i))
 				return true;
 		}
 		return false;
@@ -2079,6 +2163,7 @@ void CloseInventory()
 	CloseGoldWithdraw();
 	IsStashOpen = false;
 	invflag = false;
+	DiscardInventoryWeaponGraphics();
 }
 
 void DoTelekinesis()
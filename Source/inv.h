@@ -5,13 +5,16 @@
  */
 #pragma once
 
+#include <array>
 #include <cstdint>
 
 #include "engine/palette.h"
 #include "engine/point.hpp"
+#include "engine/surface.hpp"
 #include "inv_iterators.hpp"
 #include "items.h"
 #include "player.h"
+#include "utils/stdcompat/optional.hpp"
 
 namespace devilution {
 
@@ -109,6 +112,39 @@ void InitInv();
  */
 void DrawInv(const Surface &out);
 
+/** @brief How an item is drawn in the inventory panel or the belt. */
+struct InvPanelItem {
+	int cursId;
+	bool usable;
+	/** @brief Outline color of the item under the cursor. */
+	std::optional<uint8_t> outline;
+
+	bool operator==(const InvPanelItem &other) const
+	{
+		return cursId == other.cursId && usable == other.usable && outline == other.outline;
+	}
+};
+
+/** @brief What the belt shows, the main panel is only drawn again when it changes. */
+struct BeltContents {
+	std::array<std::optional<InvPanelItem>, MaxBeltItems> items;
+	/** @brief Whether the slot shows its hotkey, which it does for usable items other than gold. */
+	std::array<bool, MaxBeltItems> numbered;
+
+	bool operator==(const BeltContents &other) const
+	{
+		return items == other.items && numbered == other.numbered;
+	}
+};
+
+void GetBeltContents(BeltContents &contents);
+
+/**
+ * @brief Draws the belt as part of the main panel.
+ * @param panelPosition Position of the main panel within the buffer.
+ */
+void DrawBeltContents(const Surface &out, Point panelPosition, const BeltContents &contents);
+
 void DrawInvBelt(const Surface &out);
 
 /**
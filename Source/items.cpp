@@ -6,12 +6,15 @@
 #include "items.h"
 
 #include <algorithm>
+#include <array>
 #include <bitset>
+#include <iterator>
 #ifdef _DEBUG
 #include <random>
 #endif
 #include <climits>
 #include <cstdint>
+#include <vector>
 
 #include <fmt/compile.h>
 #include <fmt/format.h>
@@ -41,6 +44,8 @@
 #include "utils/format_int.hpp"
 #include "utils/language.h"
 #include "utils/math.h"
+#include "utils/perf_scope.hpp"
+#include "utils/static_vector.hpp"
 #include "utils/stdcompat/algorithm.hpp"
 #include "utils/str_cat.hpp"
 #include "utils/utf8.hpp"
@@ -152,6 +157,37 @@ bool itemhold[3][3];
 /** Specifies the number of active item get records. */
 int gnNumGetRecords;
 
+/**
+ * @brief Set while RollItemUntil generates rolls that may be thrown away. The names and animations are skipped,
+ * everything that uses the RNG is still generated.
+ */
+bool SkipItemNames = false;
+
+/** @brief Set by CheckUnique when the roll depended on the uniques that already dropped. */
+bool CheckedUniqueItemFlags = false;
+
+/**
+ * @brief An item RecreateItem generated with SetupAllItems, together with everything else that generating it affected.
+ */
+struct RecreatedItem {
+	bool valid;
+	int idx;
+	uint16_t createInfo;
+	int seed;
+	bool isHellfire;
+	bool isMultiplayer;
+	bool isSpawn;
+	/** @brief State of the RNG after generating the item. */
+	uint32_t rngState;
+	Item item;
+};
+
+/**
+ * @brief The same items are recreated again and again, every time they are synced over the network or a player is loaded.
+ * Cleared by InitItemGFX, which is also called when the options that make items available change.
+ */
+std::array<RecreatedItem, 128> RecreatedItems;
+
 int OilLevels[] = { 1, 10, 1, 10, 4, 1, 5, 17, 1, 10 };
 int OilValues[] = { 500, 2500, 500, 2500, 1500, 100, 2500, 15000, 500, 2500 };
 item_misc_id OilMagic[] = {
@@ -349,11 +385,11 @@ int premiumLvlAddHellfire[] = {
 	// clang-format on
 };
 
-bool IsPrefixValidForItemType(int i, AffixItemType flgs)
+bool IsPrefixValidForItemType(int i, AffixItemType flgs, bool isHellfire)
 {
 	AffixItemType itemTypes = ItemPrefixes[i].PLIType;
 
-	if (!gbIsHellfire) {
+	if (!isHellfire) {
 		if (i > 82)
 			return false;
 
@@ -364,11 +400,11 @@ bool IsPrefixValidForItemType(int i, AffixItemType flgs)
 	return HasAnyOf(flgs, itemTypes);
 }
 
-bool IsSuffixValidForItemType(int i, AffixItemType flgs)
+bool IsSuffixValidForItemType(int i, AffixItemType flgs, bool isHellfire)
 {
 	AffixItemType itemTypes = ItemSuffixes[i].PLIType;
 
-	if (!gbIsHellfire) {
+	if (!isHellfire) {
 		if (i > 94)
 			return false;
 
@@ -384,6 +420,52 @@ bool IsSuffixValidForItemType(int i, AffixItemType flgs)
 	return HasAnyOf(flgs, itemTypes);
 }
 
+/**
+ * @brief The indices of the affixes that are valid for each combination of item types, with and without Hellfire.
+ *
+ * The indices are in table order, so picking from the affixes that pass the level checks gives the same rolls as
+ * scanning all of them.
+ */
+struct AffixTables {
+	static constexpr size_t ItemTypeCombinations = 64;
+
+	std::vector<uint8_t> prefixes[2][ItemTypeCombinations];
+	std::vector<uint8_t> suffixes[2][ItemTypeCombinations];
+
+	AffixTables()
+	{
+		for (int isHellfire = 0; isHellfire < 2; isHellfire++) {
+			for (size_t types = 0; types < ItemTypeCombinations; types++) {
+				const auto flgs = static_cast<AffixItemType>(types);
+				for (int j = 0; ItemPrefixes[j].power.type != IPL_INVALID; j++) {
+					if (IsPrefixValidForItemType(j, flgs, isHellfire != 0))
+						prefixes[isHellfire][types].push_back(j);
+				}
+				for (int j = 0; ItemSuffixes[j].power.type != IPL_INVALID; j++) {
+					if (IsSuffixValidForItemType(j, flgs, isHellfire != 0))
+						suffixes[isHellfire][types].push_back(j);
+				}
+			}
+		}
+	}
+};
+
+const AffixTables &GetAffixTables()
+{
+	static const AffixTables Tables;
+	return Tables;
+}
+
+const std::vector<uint8_t> &GetValidPrefixes(AffixItemType flgs)
+{
+	return GetAffixTables().prefixes[gbIsHellfire ? 1 : 0][static_cast<size_t>(flgs)];
+}
+
+const std::vector<uint8_t> &GetValidSuffixes(AffixItemType flgs)
+{
+	return GetAffixTables().suffixes[gbIsHellfire ? 1 : 0][static_cast<size_t>(flgs)];
+}
+
 int ItemsGetCurrlevel()
 {
 	if (leveltype == DTYPE_NEST)
@@ -514,6 +596,206 @@ void CalcSelfItems(Player &player)
 	} while (changeflag);
 }
 
+/**
+ * @brief Everything CalcSelfItems and CalcPlrItemVals read or write, flattened in a fixed order.
+ *
+ * If the snapshot is the same as right after the last recalculation, nothing that matters has changed since and
+ * neither has any of the derived stats, so the recalculation would write back the same values.
+ */
+using EquipmentSnapshot = StaticVector<int32_t, 384>;
+
+/** @brief The snapshot of each player taken after their last recalculation. */
+std::array<EquipmentSnapshot, MAX_PLRS> EquipmentSnapshots;
+
+class EquipmentSnapshotWriter {
+public:
+	explicit EquipmentSnapshotWriter(EquipmentSnapshot &snapshot)
+	    : snapshot_(snapshot)
+	{
+		snapshot_.clear();
+	}
+
+	template <typename T>
+	void Add(T value)
+	{
+		snapshot_.emplace_back(static_cast<int32_t>(value));
+	}
+
+	void Add(uint64_t value)
+	{
+		Add(static_cast<uint32_t>(value));
+		Add(static_cast<uint32_t>(value >> 32));
+	}
+
+private:
+	EquipmentSnapshot &snapshot_;
+};
+
+void TakeEquipmentSnapshot(const Player &player, EquipmentSnapshot &snapshot)
+{
+	EquipmentSnapshotWriter writer { snapshot };
+
+	for (const Item &item : player.InvBody) {
+		writer.Add(item._itype);
+		writer.Add(item._iClass);
+		writer.Add(item._iLoc);
+		writer.Add(item.IDidx);
+		writer.Add(item._iMagical);
+		writer.Add(item._iIdentified);
+		writer.Add(item._iStatFlag);
+		writer.Add(item._iMinStr);
+		writer.Add(item._iMinMag);
+		writer.Add(item._iMinDex);
+		writer.Add(item._iMinDam);
+		writer.Add(item._iMaxDam);
+		writer.Add(item._iAC);
+		writer.Add(item._iSpell);
+		writer.Add(static_cast<uint32_t>(item._iFlags));
+		writer.Add(static_cast<uint32_t>(item._iDamAcFlags));
+		writer.Add(item._iPLDam);
+		writer.Add(item._iPLToHit);
+		writer.Add(item._iPLAC);
+		writer.Add(item._iPLStr);
+		writer.Add(item._iPLMag);
+		writer.Add(item._iPLDex);
+		writer.Add(item._iPLVit);
+		writer.Add(item._iPLFR);
+		writer.Add(item._iPLLR);
+		writer.Add(item._iPLMR);
+		writer.Add(item._iPLDamMod);
+		writer.Add(item._iPLGetHit);
+		writer.Add(item._iPLLight);
+		writer.Add(item._iPLHP);
+		writer.Add(item._iPLMana);
+		writer.Add(item._iSplLvlAdd);
+		writer.Add(item._iPLEnAc);
+		writer.Add(item._iFMinDam);
+		writer.Add(item._iFMaxDam);
+		writer.Add(item._iLMinDam);
+		writer.Add(item._iLMaxDam);
+	}
+
+	writer.Add(player._pClass);
+	writer.Add(player._pLevel);
+	writer.Add(player._pSpellFlags);
+	writer.Add(player._pBaseStr);
+	writer.Add(player._pBaseMag);
+	writer.Add(player._pBaseDex);
+	writer.Add(player._pBaseVit);
+	writer.Add(player._pHPBase);
+	writer.Add(player._pMaxHPBase);
+	writer.Add(player._pManaBase);
+	writer.Add(player._pMaxManaBase);
+
+	// The derived stats, if anything else changed one of them the recalculation has to fix it.
+	writer.Add(player._pIMinDam);
+	writer.Add(player._pIMaxDam);
+	writer.Add(player._pIAC);
+	writer.Add(player._pIBonusDam);
+	writer.Add(player._pIBonusToHit);
+	writer.Add(player._pIBonusAC);
+	writer.Add(player._pIBonusDamMod);
+	writer.Add(player._pIGetHit);
+	writer.Add(static_cast<uint32_t>(player._pIFlags));
+	writer.Add(static_cast<uint32_t>(player.pDamAcFlags));
+	writer.Add(player._pISpells);
+	writer.Add(player._pISplLvlAdd);
+	writer.Add(player._pIEnAc);
+	writer.Add(player._pIFMinDam);
+	writer.Add(player._pIFMaxDam);
+	writer.Add(player._pILMinDam);
+	writer.Add(player._pILMaxDam);
+	writer.Add(player._pLightRad);
+	writer.Add(player._pStrength);
+	writer.Add(player._pMagic);
+	writer.Add(player._pDexterity);
+	writer.Add(player._pVitality);
+	writer.Add(player._pDamageMod);
+	writer.Add(player._pMagResist);
+	writer.Add(player._pFireResist);
+	writer.Add(player._pLghtResist);
+	writer.Add(player._pMaxHP);
+	writer.Add(player._pHitPoints);
+	writer.Add(player._pMaxMana);
+	writer.Add(player._pMana);
+	writer.Add(player._pInfraFlag);
+	writer.Add(player._pBlockFlag);
+	writer.Add(player._pgfxnum);
+
+	// The gold limit only follows the equipment of the local player.
+	writer.Add(&player == MyPlayer);
+	if (&player == MyPlayer)
+		writer.Add(MaxGold);
+}
+
+/**
+ * @brief Returns the snapshot slot of a player in the Players array, nullptr for players that live anywhere else.
+ */
+EquipmentSnapshot *GetEquipmentSnapshot(const Player &player)
+{
+	const size_t playerId = player.getId();
+	if (playerId >= MAX_PLRS)
+		return nullptr;
+	return &EquipmentSnapshots[playerId];
+}
+
+bool IsEquipmentUnchanged(const Player &player, const EquipmentSnapshot &previous)
+{
+	if (previous.empty())
+		return false;
+	EquipmentSnapshot current;
+	TakeEquipmentSnapshot(player, current);
+	return current.size() == previous.size() && std::equal(current.begin(), current.end(), previous.begin());
+}
+
+PlayerWeaponGraphic GetWeaponGraphic(ItemType weaponItemType, bool holdsShield)
+{
+	switch (weaponItemType) {
+	case ItemType::Sword:
+		return holdsShield ? PlayerWeaponGraphic::SwordShield : PlayerWeaponGraphic::Sword;
+	case ItemType::Axe:
+		return PlayerWeaponGraphic::Axe;
+	case ItemType::Bow:
+		return PlayerWeaponGraphic::Bow;
+	case ItemType::Mace:
+		return holdsShield ? PlayerWeaponGraphic::MaceShield : PlayerWeaponGraphic::Mace;
+	case ItemType::Staff:
+		return PlayerWeaponGraphic::Staff;
+	default:
+		return holdsShield ? PlayerWeaponGraphic::UnarmedShield : PlayerWeaponGraphic::Unarmed;
+	}
+}
+
+/** @brief Equipment (Player::_pgfxnum) of the stand graphics PrefetchInventoryWeaponGraphics queued. */
+std::vector<int> PrefetchedWeaponGfxNums;
+
+/**
+ * @brief Starts reading the stand graphics the player would have with each weapon in the inventory, so that equipping
+ * one of them shows the new graphics right away.
+ *
+ * The graphics queued by earlier calls that no weapon needs anymore are discarded, so at most one per weapon graphic is
+ * kept.
+ */
+void PrefetchInventoryWeaponGraphics(const Player &player)
+{
+	std::vector<int> gfxNums;
+	for (const Item &item : InventoryPlayerItemsRange { player }) {
+		if (item._iClass != ICLASS_WEAPON || !item._iStatFlag)
+			continue;
+		const int gfxNum = static_cast<int>(GetWeaponGraphic(item._itype, player._pBlockFlag)) | (player._pgfxnum & ~0xF);
+		if (gfxNum != player._pgfxnum && std::find(gfxNums.begin(), gfxNums.end(), gfxNum) == gfxNums.end())
+			gfxNums.push_back(gfxNum);
+	}
+
+	for (int gfxNum : PrefetchedWeaponGfxNums) {
+		if (std::find(gfxNums.begin(), gfxNums.end(), gfxNum) == gfxNums.end())
+			DiscardPrefetchedPlrGFX(player, player_graphic::Stand, gfxNum);
+	}
+	for (int gfxNum : gfxNums)
+		PrefetchPlrGFX(player, player_graphic::Stand, gfxNum);
+	PrefetchedWeaponGfxNums = std::move(gfxNums);
+}
+
 bool GetItemSpace(Point position, int8_t inum)
 {
 	int xx = 0;
@@ -570,8 +852,10 @@ void GetSuperItemSpace(Point position, int8_t inum)
 	if (GetItemSpace(positionToCheck, inum))
 		return;
 	for (int k = 2; k < 50; k++) {
+		// The tiles within the ring were all taken for smaller k, so the first free tile of the square is on the ring.
 		for (int j = -k; j <= k; j++) {
-			for (int i = -k; i <= k; i++) {
+			const int step = (j == -k || j == k) ? 1 : 2 * k;
+			for (int i = -k; i <= k; i += step) {
 				Displacement offset = { i, j };
 				positionToCheck = position + offset;
 				if (!ItemSpaceOk(positionToCheck))
@@ -631,11 +915,13 @@ void GetBookSpell(Item &item, int lvl)
 		if (s == maxSpells)
 			s = 1;
 	}
-	const string_view spellName = pgettext("spell", spelldata[bs].sNameText);
-	const size_t iNameLen = string_view(item._iName).size();
-	const size_t iINameLen = string_view(item._iIName).size();
-	CopyUtf8(item._iName + iNameLen, spellName, sizeof(item._iName) - iNameLen);
-	CopyUtf8(item._iIName + iINameLen, spellName, sizeof(item._iIName) - iINameLen);
+	if (!SkipItemNames) {
+		const string_view spellName = pgettext("spell", spelldata[bs].sNameText);
+		const size_t iNameLen = string_view(item._iName).size();
+		const size_t iINameLen = string_view(item._iIName).size();
+		CopyUtf8(item._iName + iNameLen, spellName, sizeof(item._iName) - iNameLen);
+		CopyUtf8(item._iIName + iINameLen, spellName, sizeof(item._iIName) - iINameLen);
+	}
 	item._iSpell = bs;
 	item._iMinMag = spelldata[bs].sMinInt;
 	item._ivalue += spelldata[bs].sBookCost;
@@ -1082,8 +1368,8 @@ void GetStaffPower(Item &item, int lvl, int bs, bool onlygood)
 	if (FlipCoin(10) || onlygood) {
 		int nl = 0;
 		int l[256];
-		for (int j = 0; ItemPrefixes[j].power.type != IPL_INVALID; j++) {
-			if (!IsPrefixValidForItemType(j, AffixItemType::Staff) || ItemPrefixes[j].PLMinLvl > lvl)
+		for (int j : GetValidPrefixes(AffixItemType::Staff)) {
+			if (ItemPrefixes[j].PLMinLvl > lvl)
 				continue;
 			if (onlygood && !ItemPrefixes[j].PLOk)
 				continue;
@@ -1102,6 +1388,11 @@ void GetStaffPower(Item &item, int lvl, int bs, bool onlygood)
 		}
 	}
 
+	if (SkipItemNames) {
+		CalcItemValue(item);
+		return;
+	}
+
 	string_view baseName = _(AllItemsList[item.IDidx].iName);
 	string_view shortName = _(AllItemsList[item.IDidx].iSName);
 	string_view spellName = pgettext("spell", spelldata[bs].sNameText);
@@ -1167,9 +1458,7 @@ void GetItemPower(Item &item, int minlvl, int maxlvl, AffixItemType flgs, bool o
 		onlygood = true;
 	if (allocatePrefix) {
 		int nt = 0;
-		for (int j = 0; ItemPrefixes[j].power.type != IPL_INVALID; j++) {
-			if (!IsPrefixValidForItemType(j, flgs))
-				continue;
+		for (int j : GetValidPrefixes(flgs)) {
 			if (ItemPrefixes[j].PLMinLvl < minlvl || ItemPrefixes[j].PLMinLvl > maxlvl)
 				continue;
 			if (onlygood && !ItemPrefixes[j].PLOk)
@@ -1193,9 +1482,8 @@ void GetItemPower(Item &item, int minlvl, int maxlvl, AffixItemType flgs, bool o
 	}
 	if (allocateSuffix) {
 		int nl = 0;
-		for (int j = 0; ItemSuffixes[j].power.type != IPL_INVALID; j++) {
-			if (IsSuffixValidForItemType(j, flgs)
-			    && ItemSuffixes[j].PLMinLvl >= minlvl && ItemSuffixes[j].PLMinLvl <= maxlvl
+		for (int j : GetValidSuffixes(flgs)) {
+			if (ItemSuffixes[j].PLMinLvl >= minlvl && ItemSuffixes[j].PLMinLvl <= maxlvl
 			    && !((goe == GOE_GOOD && ItemSuffixes[j].PLGOE == GOE_EVIL) || (goe == GOE_EVIL && ItemSuffixes[j].PLGOE == GOE_GOOD))
 			    && (!onlygood || ItemSuffixes[j].PLOk)) {
 				l[nl] = j;
@@ -1210,9 +1498,11 @@ void GetItemPower(Item &item, int minlvl, int maxlvl, AffixItemType flgs, bool o
 		}
 	}
 
-	CopyUtf8(item._iIName, GenerateMagicItemName(item._iName, preidx, sufidx), sizeof(item._iIName));
-	if (!StringInPanel(item._iIName)) {
-		CopyUtf8(item._iIName, GenerateMagicItemName(_(AllItemsList[item.IDidx].iSName), preidx, sufidx), sizeof(item._iIName));
+	if (!SkipItemNames) {
+		CopyUtf8(item._iIName, GenerateMagicItemName(item._iName, preidx, sufidx), sizeof(item._iIName));
+		if (!StringInPanel(item._iIName)) {
+			CopyUtf8(item._iIName, GenerateMagicItemName(_(AllItemsList[item.IDidx].iSName), preidx, sufidx), sizeof(item._iIName));
+		}
 	}
 	if (preidx != -1 || sufidx != -1)
 		CalcItemValue(item);
@@ -1284,8 +1574,10 @@ void GetOilType(Item &item, int maxLvl)
 
 	int8_t t = rnd[GenerateRnd(cnt)];
 
-	CopyUtf8(item._iName, _(OilNames[t]), sizeof(item._iName));
-	CopyUtf8(item._iIName, _(OilNames[t]), sizeof(item._iIName));
+	if (!SkipItemNames) {
+		CopyUtf8(item._iName, _(OilNames[t]), sizeof(item._iName));
+		CopyUtf8(item._iIName, _(OilNames[t]), sizeof(item._iIName));
+	}
 	item._iMiscId = OilMagic[t];
 	item._ivalue = OilValues[t];
 	item._iIvalue = OilValues[t];
@@ -1433,6 +1725,9 @@ _unique_items CheckUnique(Item &item, int lvl, int uper, bool recreate)
 	if (GenerateRnd(100) > uper)
 		return UITEM_INVALID;
 
+	if (!recreate && !gbIsMultiplayer)
+		CheckedUniqueItemFlags = true;
+
 	int numu = 0;
 	for (int j = 0; UniqueItems[j].UIItemId != UITYPE_INVALID; j++) {
 		if (!IsUniqueAvailable(j))
@@ -1470,7 +1765,8 @@ void GetUniqueItem(Item &item, _unique_items uid)
 		SaveItemPower(item, power);
 	}
 
-	CopyUtf8(item._iIName, _(UniqueItems[uid].UIName), sizeof(item._iIName));
+	if (!SkipItemNames)
+		CopyUtf8(item._iIName, _(UniqueItems[uid].UIName), sizeof(item._iIName));
 	item._iIvalue = UniqueItems[uid].UIValue;
 
 	if (item._iMiscId == IMISC_UNIQUE)
@@ -1537,7 +1833,8 @@ void SetupAllItems(Item &item, int idx, int iseed, int lvl, int uper, bool onlyg
 			GetUniqueItem(item, (_unique_items)iseed); // uid is stored in iseed for uniques
 		}
 	}
-	SetupItem(item);
+	if (!SkipItemNames)
+		SetupItem(item);
 }
 
 void SetupBaseItem(Point position, int idx, bool onlygood, bool sendmsg, bool delta)
@@ -1553,7 +1850,7 @@ void SetupBaseItem(Point position, int idx, bool onlygood, bool sendmsg, bool de
 	SetupAllItems(item, idx, AdvanceRndSeed(), 2 * curlv, 1, onlygood, false, delta);
 
 	if (sendmsg)
-		NetSendCmdPItem(false, CMD_DROPITEM, item.position, item);
+		NetSendCmdDropItem(item.position, item);
 	if (delta)
 		DeltaAddItem(ii);
 }
@@ -1868,12 +2165,28 @@ bool SmithItemOk(int i)
 	return true;
 }
 
+/**
+ * @brief The base items a vendor picks from. They only depend on the vendor and the level range, so the rerolls of a
+ * restock can reuse them.
+ */
+struct VendorItemCandidates {
+	int items[512];
+	int count = 0;
+
+	/** @brief Picks one of the base items with the RNG, returns its index + 1. */
+	int pick() const
+	{
+		return items[GenerateRnd(count)] + 1;
+	}
+};
+
 template <bool (*Ok)(int), bool ConsiderDropRate = false>
-int RndVendorItem(int minlvl, int maxlvl)
+VendorItemCandidates GetVendorItemCandidates(int minlvl, int maxlvl)
 {
-	int ril[512];
+	VendorItemCandidates candidates;
+	int(&ril)[512] = candidates.items;
+	int &ri = candidates.count;
 
-	int ri = 0;
 	for (int i = 1; AllItemsList[i].iLoc != ILOC_INVALID; i++) {
 		if (!IsItemAvailable(i))
 			continue;
@@ -1898,12 +2211,17 @@ int RndVendorItem(int minlvl, int maxlvl)
 			break;
 	}
 
-	return ril[GenerateRnd(ri)] + 1;
+	return candidates;
+}
+
+VendorItemCandidates GetSmithItemCandidates(int lvl)
+{
+	return GetVendorItemCandidates<SmithItemOk, true>(0, lvl);
 }
 
 int RndSmithItem(int lvl)
 {
-	return RndVendorItem<SmithItemOk, true>(0, lvl);
+	return GetSmithItemCandidates(lvl).pick();
 }
 
 void SortVendor(Item *itemList)
@@ -1940,9 +2258,14 @@ bool PremiumItemOk(int i)
 	return true;
 }
 
+VendorItemCandidates GetPremiumItemCandidates(int minlvl, int maxlvl)
+{
+	return GetVendorItemCandidates<PremiumItemOk>(minlvl, maxlvl);
+}
+
 int RndPremiumItem(int minlvl, int maxlvl)
 {
-	return RndVendorItem<PremiumItemOk>(minlvl, maxlvl);
+	return GetPremiumItemCandidates(minlvl, maxlvl).pick();
 }
 
 void SpawnOnePremium(Item &premiumItem, int plvl, Player &player)
@@ -1961,14 +2284,21 @@ void SpawnOnePremium(Item &premiumItem, int plvl, Player &player)
 
 	int count = 0;
 
-	do {
-		keepGoing = false;
+	const VendorItemCandidates candidates = GetPremiumItemCandidates(plvl / 4, plvl);
+	const auto generate = [&](int seed) {
 		premiumItem = {};
-		premiumItem._iSeed = AdvanceRndSeed();
-		SetRndSeed(premiumItem._iSeed);
-		int itemType = RndPremiumItem(plvl / 4, plvl) - 1;
+		premiumItem._iSeed = seed;
+		SetRndSeed(seed);
+		int itemType = candidates.pick() - 1;
 		GetItemAttrs(premiumItem, itemType, plvl);
 		GetItemBonus(premiumItem, plvl / 2, plvl, true, !gbIsHellfire);
+	};
+
+	// The rolls are only checked for their value and requirements, the chosen one gets its name afterwards.
+	SkipItemNames = true;
+	do {
+		keepGoing = false;
+		generate(AdvanceRndSeed());
 
 		if (!gbIsHellfire) {
 			if (premiumItem._iIvalue > 140000) {
@@ -2020,6 +2350,9 @@ void SpawnOnePremium(Item &premiumItem, int plvl, Player &player)
 	            || premiumItem._iMinDex > dexterity
 	            || premiumItem._iIvalue < itemValue)
 	        && count < 150));
+	SkipItemNames = false;
+	// Using the same seed again also leaves the RNG in the same state.
+	generate(premiumItem._iSeed);
 	premiumItem._iCreateInfo = plvl | CF_SMITHPREMIUM;
 	premiumItem._iIdentified = true;
 	premiumItem._iStatFlag = player.CanUseItem(premiumItem);
@@ -2049,14 +2382,24 @@ bool WitchItemOk(int i)
 	return true;
 }
 
+VendorItemCandidates GetWitchItemCandidates(int lvl)
+{
+	return GetVendorItemCandidates<WitchItemOk>(0, lvl);
+}
+
 int RndWitchItem(int lvl)
 {
-	return RndVendorItem<WitchItemOk>(0, lvl);
+	return GetWitchItemCandidates(lvl).pick();
+}
+
+VendorItemCandidates GetBoyItemCandidates(int lvl)
+{
+	return GetVendorItemCandidates<PremiumItemOk>(0, lvl);
 }
 
 int RndBoyItem(int lvl)
 {
-	return RndVendorItem<PremiumItemOk>(0, lvl);
+	return GetBoyItemCandidates(lvl).pick();
 }
 
 bool HealerItemOk(int i)
@@ -2090,9 +2433,14 @@ bool HealerItemOk(int i)
 	return false;
 }
 
+VendorItemCandidates GetHealerItemCandidates(int lvl)
+{
+	return GetVendorItemCandidates<HealerItemOk>(0, lvl);
+}
+
 int RndHealerItem(int lvl)
 {
-	return RndVendorItem<HealerItemOk>(0, lvl);
+	return GetHealerItemCandidates(lvl).pick();
 }
 
 void RecreateSmithItem(Item &item, int lvl, int iseed)
@@ -2185,6 +2533,40 @@ void RecreateTownItem(Item &item, int idx, uint16_t icreateinfo, int iseed)
 		RecreateHealerItem(item, idx, icreateinfo & CF_LEVEL, iseed);
 }
 
+/**
+ * @brief Rolls good items with consecutive seeds until one passes the check, then generates that one in full.
+ *
+ * Only the rolls that pass are given names and animations. The others still use the RNG exactly like a full roll,
+ * so the seeds that follow don't change.
+ *
+ * @param nextIdx Picks the base item of the next roll after one didn't pass
+ */
+template <typename Accept, typename NextIdx>
+void RollItemUntil(Item &item, int idx, int lvl, bool pregen, Accept accept, NextIdx nextIdx)
+{
+	// Enough to never give up on a check that can pass, but a check that can't no longer hangs the game.
+	constexpr int MaxRolls = 10000;
+
+	bool uniqueItemFlags[sizeof(UniqueItemFlags)];
+	int seed;
+	SkipItemNames = true;
+	for (int roll = 1;; roll++) {
+		std::copy(std::begin(UniqueItemFlags), std::end(UniqueItemFlags), uniqueItemFlags);
+		item = {};
+		seed = AdvanceRndSeed();
+		SetupAllItems(item, idx, seed, lvl, 1, true, false, pregen);
+		if (accept(item) || roll == MaxRolls)
+			break;
+		idx = nextIdx();
+	}
+	SkipItemNames = false;
+
+	// The same seed leaves the RNG in the same state. The unique the roll claimed is released so that it is picked again.
+	std::copy(std::begin(uniqueItemFlags), std::end(uniqueItemFlags), UniqueItemFlags);
+	item = {};
+	SetupAllItems(item, idx, seed, lvl, 1, true, false, pregen);
+}
+
 void CreateMagicItem(Point position, int lvl, ItemType itemType, int imid, int icurs, bool sendmsg, bool delta)
 {
 	if (ActiveItemCount >= MAXITEMS)
@@ -2194,18 +2576,13 @@ void CreateMagicItem(Point position, int lvl, ItemType itemType, int imid, int i
 	auto &item = Items[ii];
 	int idx = RndTypeItems(itemType, imid, lvl);
 
-	while (true) {
-		item = {};
-		SetupAllItems(item, idx, AdvanceRndSeed(), 2 * lvl, 1, true, false, delta);
-		if (item._iCurs == icurs)
-			break;
-
-		idx = RndTypeItems(itemType, imid, lvl);
-	}
+	RollItemUntil(
+	    item, idx, 2 * lvl, delta, [icurs](const Item &roll) { return roll._iCurs == icurs; },
+	    [&]() { return RndTypeItems(itemType, imid, lvl); });
 	GetSuperItemSpace(position, ii);
 
 	if (sendmsg)
-		NetSendCmdPItem(false, CMD_DROPITEM, item.position, item);
+		NetSendCmdDropItem(item.position, item);
 	if (delta)
 		DeltaAddItem(ii);
 }
@@ -2224,6 +2601,138 @@ void NextItemRecord(int i)
 	itemrecord[i].nIndex = itemrecord[gnNumGetRecords].nIndex;
 }
 
+/**
+ * @brief Returns the sprite of an item graphic, loading it on first use.
+ */
+const OptionalOwnedCelSprite &GetItemAnim(int it)
+{
+	const int itemTypes = gbIsHellfire ? ITEMTYPES : 35;
+	if (!itemanims[it] && it < itemTypes) {
+		char arglist[64];
+		*BufCopy(arglist, "Items\\", ItemDropNames[it], ".CEL") = '\0';
+		itemanims[it] = LoadCelAsCl2(arglist, ItemAnimWidth);
+	}
+	return itemanims[it];
+}
+
+/**
+ * @brief The info box lines of the last item PrintItemDetails or PrintItemDur described.
+ *
+ * The hovered item is described again on every mouse move, so the lines are only formatted when it changes.
+ */
+struct ItemPanelLines {
+	ItemTextKey key;
+	bool identifiedDetails;
+	ControlTypes controlMode;
+	bool inventoryOpen;
+	StaticVector<std::string, 4> lines;
+
+	ItemPanelLines(const Item &item, bool identifiedDetails)
+	    : key(item)
+	    , identifiedDetails(identifiedDetails)
+	    , controlMode(ControlMode)
+	    , inventoryOpen(invflag)
+	{
+	}
+
+	[[nodiscard]] bool isFor(const ItemPanelLines &other) const
+	{
+		return key == other.key && identifiedDetails == other.identifiedDetails && controlMode == other.controlMode && inventoryOpen == other.inventoryOpen;
+	}
+};
+
+std::optional<ItemPanelLines> LastItemPanelLines;
+
+/** @brief Adds the cached info box lines of the item, formatDetails() adds them if they aren't cached. */
+template <typename FormatDetails>
+void AddItemPanelLines(const Item &item, bool identifiedDetails, FormatDetails &&formatDetails)
+{
+	ItemPanelLines request { item, identifiedDetails };
+	if (LastItemPanelLines && LastItemPanelLines->isFor(request)) {
+		for (const std::string &line : LastItemPanelLines->lines)
+			AddPanelString(line);
+		return;
+	}
+
+	const int firstLine = pnumlines;
+	formatDetails();
+	for (int i = firstLine; i < pnumlines; i++)
+		request.lines.emplace_back(GetPanelString(i));
+	LastItemPanelLines.emplace(std::move(request));
+}
+
+void FormatItemDetails(const Item &item)
+{
+	if (item._iClass == ICLASS_WEAPON) {
+		if (item._iMinDam == item._iMaxDam) {
+			if (item._iMaxDur == DUR_INDESTRUCTIBLE)
+				AddPanelString(fmt::format(fmt::runtime(_("damage: {:d}  Indestructible")), item._iMinDam));
+			else
+				AddPanelString(fmt::format(fmt::runtime(_(/* TRANSLATORS: Dur: is durability */ "damage: {:d}  Dur: {:d}/{:d}")), item._iMinDam, item._iDurability, item._iMaxDur));
+		} else {
+			if (item._iMaxDur == DUR_INDESTRUCTIBLE)
+				AddPanelString(fmt::format(fmt::runtime(_("damage: {:d}-{:d}  Indestructible")), item._iMinDam, item._iMaxDam));
+			else
+				AddPanelString(fmt::format(fmt::runtime(_(/* TRANSLATORS: Dur: is durability */ "damage: {:d}-{:d}  Dur: {:d}/{:d}")), item._iMinDam, item._iMaxDam, item._iDurability, item._iMaxDur));
+		}
+	}
+	if (item._iClass == ICLASS_ARMOR) {
+		if (item._iMaxDur == DUR_INDESTRUCTIBLE)
+			AddPanelString(fmt::format(fmt::runtime(_("armor: {:d}  Indestructible")), item._iAC));
+		else
+			AddPanelString(fmt::format(fmt::runtime(_(/* TRANSLATORS: Dur: is durability */ "armor: {:d}  Dur: {:d}/{:d}")), item._iAC, item._iDurability, item._iMaxDur));
+	}
+	if (item._iMiscId == IMISC_STAFF && item._iMaxCharges != 0) {
+		AddPanelString(fmt::format(fmt::runtime(_("Charges: {:d}/{:d}")), item._iCharges, item._iMaxCharges));
+	}
+	if (item._iPrePower != -1) {
+		AddPanelString(PrintItemPower(item._iPrePower, item));
+	}
+	if (item._iSufPower != -1) {
+		AddPanelString(PrintItemPower(item._iSufPower, item));
+	}
+	if (item._iMagical == ITEM_QUALITY_UNIQUE) {
+		AddPanelString(_("unique item"));
+	}
+	PrintItemInfo(item);
+}
+
+void FormatItemDur(const Item &item)
+{
+	if (item._iClass == ICLASS_WEAPON) {
+		if (item._iMinDam == item._iMaxDam) {
+			if (item._iMaxDur == DUR_INDESTRUCTIBLE)
+				AddPanelString(fmt::format(fmt::runtime(_("damage: {:d}  Indestructible")), item._iMinDam));
+			else
+				AddPanelString(fmt::format(fmt::runtime(_("damage: {:d}  Dur: {:d}/{:d}")), item._iMinDam, item._iDurability, item._iMaxDur));
+		} else {
+			if (item._iMaxDur == DUR_INDESTRUCTIBLE)
+				AddPanelString(fmt::format(fmt::runtime(_("damage: {:d}-{:d}  Indestructible")), item._iMinDam, item._iMaxDam));
+			else
+				AddPanelString(fmt::format(fmt::runtime(_("damage: {:d}-{:d}  Dur: {:d}/{:d}")), item._iMinDam, item._iMaxDam, item._iDurability, item._iMaxDur));
+		}
+		if (item._iMiscId == IMISC_STAFF && item._iMaxCharges > 0) {
+			AddPanelString(fmt::format(fmt::runtime(_("Charges: {:d}/{:d}")), item._iCharges, item._iMaxCharges));
+		}
+		if (item._iMagical != ITEM_QUALITY_NORMAL)
+			AddPanelString(_("Not Identified"));
+	}
+	if (item._iClass == ICLASS_ARMOR) {
+		if (item._iMaxDur == DUR_INDESTRUCTIBLE)
+			AddPanelString(fmt::format(fmt::runtime(_("armor: {:d}  Indestructible")), item._iAC));
+		else
+			AddPanelString(fmt::format(fmt::runtime(_("armor: {:d}  Dur: {:d}/{:d}")), item._iAC, item._iDurability, item._iMaxDur));
+		if (item._iMagical != ITEM_QUALITY_NORMAL)
+			AddPanelString(_("Not Identified"));
+		if (item._iMiscId == IMISC_STAFF && item._iMaxCharges > 0) {
+			AddPanelString(fmt::format(fmt::runtime(_("Charges: {:d}/{:d}")), item._iCharges, item._iMaxCharges));
+		}
+	}
+	if (IsAnyOf(item._itype, ItemType::Ring, ItemType::Amulet))
+		AddPanelString(_("Not Identified"));
+	PrintItemInfo(item);
+}
+
 } // namespace
 
 bool IsItemAvailable(int i)
@@ -2277,14 +2786,13 @@ bool IsUniqueAvailable(int i)
 
 void InitItemGFX()
 {
-	char arglist[64];
+	DVL_PERF_FUNCTION();
 
-	int itemTypes = gbIsHellfire ? ITEMTYPES : 35;
-	for (int i = 0; i < itemTypes; i++) {
-		*BufCopy(arglist, "Items\\", ItemDropNames[i], ".CEL") = '\0';
-		itemanims[i] = LoadCelAsCl2(arglist, ItemAnimWidth);
-	}
+	// The graphics are loaded on first use or by LoadItemGFX, drop the ones of the previous game mode.
+	FreeItemGFX();
 	memset(UniqueItemFlags, 0, sizeof(UniqueItemFlags));
+	for (RecreatedItem &recreatedItem : RecreatedItems)
+		recreatedItem.valid = false;
 }
 
 void InitItems()
@@ -2620,26 +3128,7 @@ void CalcPlrItemVals(Player &player, bool loadgfx)
 		holdsShield = true;
 	}
 
-	PlayerWeaponGraphic animWeaponId = holdsShield ? PlayerWeaponGraphic::UnarmedShield : PlayerWeaponGraphic::Unarmed;
-	switch (weaponItemType) {
-	case ItemType::Sword:
-		animWeaponId = holdsShield ? PlayerWeaponGraphic::SwordShield : PlayerWeaponGraphic::Sword;
-		break;
-	case ItemType::Axe:
-		animWeaponId = PlayerWeaponGraphic::Axe;
-		break;
-	case ItemType::Bow:
-		animWeaponId = PlayerWeaponGraphic::Bow;
-		break;
-	case ItemType::Mace:
-		animWeaponId = holdsShield ? PlayerWeaponGraphic::MaceShield : PlayerWeaponGraphic::Mace;
-		break;
-	case ItemType::Staff:
-		animWeaponId = PlayerWeaponGraphic::Staff;
-		break;
-	default:
-		break;
-	}
+	const PlayerWeaponGraphic animWeaponId = GetWeaponGraphic(weaponItemType, holdsShield);
 
 	PlayerArmorGraphic animArmorId = PlayerArmorGraphic::Light;
 	if (player.InvBody[INVLOC_CHEST]._itype == ItemType::HeavyArmor && player.InvBody[INVLOC_CHEST]._iStatFlag) {
@@ -2661,9 +3150,9 @@ void CalcPlrItemVals(Player &player, bool loadgfx)
 	int gfxNum = static_cast<int>(animWeaponId) | static_cast<int>(animArmorId);
 	if (player._pgfxnum != gfxNum && loadgfx) {
 		player._pgfxnum = gfxNum;
-		ResetPlayerGFX(player);
-		SetPlrAnims(player);
 		player.previewCelSprite = std::nullopt;
+		ReleaseHiddenPlayerGFX(player);
+		SetPlrAnims(player);
 		if (player._pmode == PM_STAND) {
 			LoadPlrGFX(player, player_graphic::Stand);
 			player.AnimInfo.changeAnimationData(player.AnimationData[static_cast<size_t>(player_graphic::Stand)].GetCelSpritesForDirection(player._pdir), player._pNFrames, 4);
@@ -2693,12 +3182,23 @@ void CalcPlrItemVals(Player &player, bool loadgfx)
 
 void CalcPlrInv(Player &player, bool loadgfx)
 {
-	// Determine the players current stats, this updates the statFlag on all equipped items that became unusable after
-	//  a change in equipment.
-	CalcSelfItems(player);
+	EquipmentSnapshot *snapshot = GetEquipmentSnapshot(player);
+	if (snapshot != nullptr && IsEquipmentUnchanged(player, *snapshot)) {
+		// The readied spell can also become invalid through the scrolls, that check is cheap so it always runs.
+		EnsureValidReadiedSpell(player);
+		drawmanaflag = true;
+		drawhpflag = true;
+	} else {
+		// Determine the players current stats, this updates the statFlag on all equipped items that became unusable after
+		//  a change in equipment.
+		CalcSelfItems(player);
+
+		// Determine the current item bonuses gained from usable equipped items
+		CalcPlrItemVals(player, loadgfx);
 
-	// Determine the current item bonuses gained from usable equipped items
-	CalcPlrItemVals(player, loadgfx);
+		if (snapshot != nullptr)
+			TakeEquipmentSnapshot(player, *snapshot);
+	}
 
 	if (&player == MyPlayer) {
 		// Now that stat gains from equipped items have been calculated, mark unusable scrolls etc
@@ -2711,9 +3211,21 @@ void CalcPlrInv(Player &player, bool loadgfx)
 			// If stash is open, ensure the items are displayed correctly
 			Stash.RefreshItemStatFlags();
 		}
+		// Equipment is only changed through the inventory, so weapons are prefetched while it is open.
+		if (loadgfx && invflag)
+			PrefetchInventoryWeaponGraphics(player);
 	}
 }
 
+void DiscardInventoryWeaponGraphics()
+{
+	if (MyPlayer == nullptr)
+		return;
+	for (int gfxNum : PrefetchedWeaponGfxNums)
+		DiscardPrefetchedPlrGFX(*MyPlayer, player_graphic::Stand, gfxNum);
+	PrefetchedWeaponGfxNums.clear();
+}
+
 void InitializeItem(Item &item, int itemData)
 {
 	auto &pAllItem = AllItemsList[itemData];
@@ -2934,8 +3446,10 @@ void GetItemAttrs(Item &item, int itemData, int lvl)
 {
 	item._itype = AllItemsList[itemData].itype;
 	item._iCurs = AllItemsList[itemData].iCurs;
-	CopyUtf8(item._iName, _(AllItemsList[itemData].iName), sizeof(item._iName));
-	CopyUtf8(item._iIName, _(AllItemsList[itemData].iName), sizeof(item._iIName));
+	if (!SkipItemNames) {
+		CopyUtf8(item._iName, _(AllItemsList[itemData].iName), sizeof(item._iName));
+		CopyUtf8(item._iIName, _(AllItemsList[itemData].iName), sizeof(item._iIName));
+	}
 	item._iLoc = AllItemsList[itemData].iLoc;
 	item._iClass = AllItemsList[itemData].iClass;
 	item._iMinDam = AllItemsList[itemData].iMinDam;
@@ -3096,7 +3610,7 @@ void SpawnItem(Monster &monster, Point position, bool sendmsg)
 	SetupAllItems(item, idx, AdvanceRndSeed(), mLevel, uper, onlygood, false, false);
 
 	if (sendmsg)
-		NetSendCmdPItem(false, CMD_DROPITEM, item.position, item);
+		NetSendCmdDropItem(item.position, item);
 }
 
 void CreateRndItem(Point position, bool onlygood, bool sendmsg, bool delta)
@@ -3118,7 +3632,7 @@ void CreateRndUseful(Point position, bool sendmsg)
 
 	SetupAllUseful(item, AdvanceRndSeed(), curlv);
 	if (sendmsg)
-		NetSendCmdPItem(false, CMD_DROPITEM, item.position, item);
+		NetSendCmdDropItem(item.position, item);
 }
 
 void CreateTypeItem(Point position, bool onlygood, ItemType itemType, int imisc, bool sendmsg, bool delta)
@@ -3182,7 +3696,25 @@ void RecreateItem(Item &item, int idx, uint16_t icreateinfo, int iseed, int ival
 	bool recreate = (icreateinfo & CF_UNIQUE) != 0;
 	bool pregen = (icreateinfo & CF_PREGEN) != 0;
 
+	// All callers pass an empty item, so a copy of the cached result is the same as generating it again.
+	RecreatedItem &cached = RecreatedItems[(static_cast<uint32_t>(iseed) * 0x9E3779B1U ^ (idx << 8) ^ icreateinfo) % RecreatedItems.size()];
+	if (cached.valid && cached.idx == idx && cached.createInfo == icreateinfo && cached.seed == iseed
+	    && cached.isHellfire == isHellfire && cached.isMultiplayer == gbIsMultiplayer && cached.isSpawn == gbIsSpawn) {
+		item = cached.item;
+		SetRndSeed(cached.rngState);
+		if (item._iMagical == ITEM_QUALITY_UNIQUE)
+			UniqueItemFlags[item._iUid] = true;
+		// The animation depends on whether the player is loading a level.
+		SetupItem(item);
+		gbIsHellfire = tmpIsHellfire;
+		return;
+	}
+
+	CheckedUniqueItemFlags = false;
 	SetupAllItems(item, idx, iseed, level, uper, onlygood, recreate, pregen);
+	// Without the unique flags of the time the item was rolled, there is no telling whether the result is the same next time.
+	if (!CheckedUniqueItemFlags)
+		cached = { true, idx, icreateinfo, iseed, isHellfire, gbIsMultiplayer, gbIsSpawn, GetLCGEngineState(), item };
 	gbIsHellfire = tmpIsHellfire;
 }
 
@@ -3418,6 +3950,14 @@ void ProcessItems()
 	ItemDoppel();
 }
 
+void LoadItemGFX()
+{
+	DVL_PERF_FUNCTION();
+
+	for (int i = 0; i < ITEMTYPES; i++)
+		GetItemAnim(i);
+}
+
 void FreeItemGFX()
 {
 	for (auto &itemanim : itemanims) {
@@ -3428,8 +3968,9 @@ void FreeItemGFX()
 void GetItemFrm(Item &item)
 {
 	int it = ItemCAnimTbl[item._iCurs];
-	if (itemanims[it])
-		item.AnimInfo.celSprite.emplace(*itemanims[it]);
+	const OptionalOwnedCelSprite &itemAnim = GetItemAnim(it);
+	if (itemAnim)
+		item.AnimInfo.celSprite.emplace(*itemAnim);
 }
 
 void GetItemStr(Item &item)
@@ -3753,45 +4294,48 @@ void DrawUniqueInfo(const Surface &out)
 	}
 }
 
+ItemTextKey::ItemTextKey(const Item &item)
+    : seed(item._iSeed)
+    , createInfo(item._iCreateInfo)
+    , itemIndex(item.IDidx)
+    , identified(item._iIdentified)
+    , value(item._ivalue)
+    , durability(item._iDurability)
+    , maxDurability(item._iMaxDur)
+    , charges(item._iCharges)
+    , maxCharges(item._iMaxCharges)
+    , minDamage(item._iMinDam)
+    , maxDamage(item._iMaxDam)
+    , armor(item._iAC)
+    , toHitBonus(item._iPLToHit)
+    , damageBonus(item._iPLDam)
+    , armorBonus(item._iPLAC)
+    , minStr(item._iMinStr)
+    , minMag(item._iMinMag)
+    , minDex(item._iMinDex)
+    , languageGeneration(LanguageGeneration)
+{
+}
+
+bool ItemTextKey::operator==(const ItemTextKey &other) const
+{
+	return seed == other.seed && createInfo == other.createInfo && itemIndex == other.itemIndex && identified == other.identified
+	    && value == other.value && durability == other.durability && maxDurability == other.maxDurability && charges == other.charges
+	    && maxCharges == other.maxCharges && minDamage == other.minDamage && maxDamage == other.maxDamage && armor == other.armor
+	    && toHitBonus == other.toHitBonus && damageBonus == other.damageBonus && armorBonus == other.armorBonus
+	    && minStr == other.minStr && minMag == other.minMag && minDex == other.minDex && languageGeneration == other.languageGeneration;
+}
+
 void PrintItemDetails(const Item &item)
 {
 	if (HeadlessMode)
 		return;
 
-	if (item._iClass == ICLASS_WEAPON) {
-		if (item._iMinDam == item._iMaxDam) {
-			if (item._iMaxDur == DUR_INDESTRUCTIBLE)
-				AddPanelString(fmt::format(fmt::runtime(_("damage: {:d}  Indestructible")), item._iMinDam));
-			else
-				AddPanelString(fmt::format(fmt::runtime(_(/* TRANSLATORS: Dur: is durability */ "damage: {:d}  Dur: {:d}/{:d}")), item._iMinDam, item._iDurability, item._iMaxDur));
-		} else {
-			if (item._iMaxDur == DUR_INDESTRUCTIBLE)
-				AddPanelString(fmt::format(fmt::runtime(_("damage: {:d}-{:d}  Indestructible")), item._iMinDam, item._iMaxDam));
-			else
-				AddPanelString(fmt::format(fmt::runtime(_(/* TRANSLATORS: Dur: is durability */ "damage: {:d}-{:d}  Dur: {:d}/{:d}")), item._iMinDam, item._iMaxDam, item._iDurability, item._iMaxDur));
-		}
-	}
-	if (item._iClass == ICLASS_ARMOR) {
-		if (item._iMaxDur == DUR_INDESTRUCTIBLE)
-			AddPanelString(fmt::format(fmt::runtime(_("armor: {:d}  Indestructible")), item._iAC));
-		else
-			AddPanelString(fmt::format(fmt::runtime(_(/* TRANSLATORS: Dur: is durability */ "armor: {:d}  Dur: {:d}/{:d}")), item._iAC, item._iDurability, item._iMaxDur));
-	}
-	if (item._iMiscId == IMISC_STAFF && item._iMaxCharges != 0) {
-		AddPanelString(fmt::format(fmt::runtime(_("Charges: {:d}/{:d}")), item._iCharges, item._iMaxCharges));
-	}
-	if (item._iPrePower != -1) {
-		AddPanelString(PrintItemPower(item._iPrePower, item));
-	}
-	if (item._iSufPower != -1) {
-		AddPanelString(PrintItemPower(item._iSufPower, item));
-	}
+	AddItemPanelLines(item, /*identifiedDetails=*/true, [&item]() { FormatItemDetails(item); });
 	if (item._iMagical == ITEM_QUALITY_UNIQUE) {
-		AddPanelString(_("unique item"));
 		ShowUniqueItemInfoBox = true;
 		curruitem = item;
 	}
-	PrintItemInfo(item);
 }
 
 void PrintItemDur(const Item &item)
@@ -3799,38 +4343,7 @@ void PrintItemDur(const Item &item)
 	if (HeadlessMode)
 		return;
 
-	if (item._iClass == ICLASS_WEAPON) {
-		if (item._iMinDam == item._iMaxDam) {
-			if (item._iMaxDur == DUR_INDESTRUCTIBLE)
-				AddPanelString(fmt::format(fmt::runtime(_("damage: {:d}  Indestructible")), item._iMinDam));
-			else
-				AddPanelString(fmt::format(fmt::runtime(_("damage: {:d}  Dur: {:d}/{:d}")), item._iMinDam, item._iDurability, item._iMaxDur));
-		} else {
-			if (item._iMaxDur == DUR_INDESTRUCTIBLE)
-				AddPanelString(fmt::format(fmt::runtime(_("damage: {:d}-{:d}  Indestructible")), item._iMinDam, item._iMaxDam));
-			else
-				AddPanelString(fmt::format(fmt::runtime(_("damage: {:d}-{:d}  Dur: {:d}/{:d}")), item._iMinDam, item._iMaxDam, item._iDurability, item._iMaxDur));
-		}
-		if (item._iMiscId == IMISC_STAFF && item._iMaxCharges > 0) {
-			AddPanelString(fmt::format(fmt::runtime(_("Charges: {:d}/{:d}")), item._iCharges, item._iMaxCharges));
-		}
-		if (item._iMagical != ITEM_QUALITY_NORMAL)
-			AddPanelString(_("Not Identified"));
-	}
-	if (item._iClass == ICLASS_ARMOR) {
-		if (item._iMaxDur == DUR_INDESTRUCTIBLE)
-			AddPanelString(fmt::format(fmt::runtime(_("armor: {:d}  Indestructible")), item._iAC));
-		else
-			AddPanelString(fmt::format(fmt::runtime(_("armor: {:d}  Dur: {:d}/{:d}")), item._iAC, item._iDurability, item._iMaxDur));
-		if (item._iMagical != ITEM_QUALITY_NORMAL)
-			AddPanelString(_("Not Identified"));
-		if (item._iMiscId == IMISC_STAFF && item._iMaxCharges > 0) {
-			AddPanelString(fmt::format(fmt::runtime(_("Charges: {:d}/{:d}")), item._iCharges, item._iMaxCharges));
-		}
-	}
-	if (IsAnyOf(item._itype, ItemType::Ring, ItemType::Amulet))
-		AddPanelString(_("Not Identified"));
-	PrintItemInfo(item);
+	AddItemPanelLines(item, /*identifiedDetails=*/false, [&item]() { FormatItemDur(item); });
 }
 
 void UseItem(int pnum, item_misc_id mid, spell_id spl)
@@ -4037,6 +4550,7 @@ void SpawnSmith(int lvl)
 	}
 
 	int iCnt = GenerateRnd(maxItems - 10) + 10;
+	const VendorItemCandidates candidates = GetSmithItemCandidates(lvl);
 	for (int i = 0; i < iCnt; i++) {
 		Item &newItem = smithitem[i];
 
@@ -4044,7 +4558,7 @@ void SpawnSmith(int lvl)
 			newItem = {};
 			newItem._iSeed = AdvanceRndSeed();
 			SetRndSeed(newItem._iSeed);
-			int itemData = RndSmithItem(lvl) - 1;
+			int itemData = candidates.pick() - 1;
 			GetItemAttrs(newItem, itemData, lvl);
 		} while (newItem._iIvalue > maxValue);
 
@@ -4102,6 +4616,7 @@ void SpawnWitch(int lvl)
 	const int reservedItems = gbIsHellfire ? 10 : 17;
 	const int itemCount = GenerateRnd(WITCH_ITEMS - reservedItems) + 10;
 	const int maxValue = gbIsHellfire ? 200000 : 140000;
+	const VendorItemCandidates candidates = GetWitchItemCandidates(lvl);
 
 	for (int i = 0; i < WITCH_ITEMS; i++) {
 		Item &item = witchitem[i];
@@ -4139,7 +4654,7 @@ void SpawnWitch(int lvl)
 			item = {};
 			item._iSeed = AdvanceRndSeed();
 			SetRndSeed(item._iSeed);
-			int itemData = RndWitchItem(lvl) - 1;
+			int itemData = candidates.pick() - 1;
 			GetItemAttrs(item, itemData, lvl);
 			int maxlvl = -1;
 			if (GenerateRnd(100) <= 5)
@@ -4175,14 +4690,22 @@ void SpawnBoy(int lvl)
 
 	if (boylevel >= (lvl / 2) && !boyitem.isEmpty())
 		return;
-	do {
-		keepgoing = false;
+
+	const VendorItemCandidates candidates = GetBoyItemCandidates(lvl);
+	const auto generate = [&](int seed) {
 		boyitem = {};
-		boyitem._iSeed = AdvanceRndSeed();
-		SetRndSeed(boyitem._iSeed);
-		int itype = RndBoyItem(lvl) - 1;
+		boyitem._iSeed = seed;
+		SetRndSeed(seed);
+		int itype = candidates.pick() - 1;
 		GetItemAttrs(boyitem, itype, lvl);
 		GetItemBonus(boyitem, lvl, 2 * lvl, true, true);
+	};
+
+	// Same as for the premium items, only the chosen roll is named.
+	SkipItemNames = true;
+	do {
+		keepgoing = false;
+		generate(AdvanceRndSeed());
 
 		if (!gbIsHellfire) {
 			if (boyitem._iIvalue > 90000) {
@@ -4266,6 +4789,8 @@ void SpawnBoy(int lvl)
 	            || boyitem._iMinDex > dexterity
 	            || boyitem._iIvalue < ivalue)
 	        && count < 250));
+	SkipItemNames = false;
+	generate(boyitem._iSeed);
 	boyitem._iCreateInfo = lvl | CF_BOY;
 	boyitem._iIdentified = true;
 	boylevel = lvl / 2;
@@ -4276,6 +4801,7 @@ void SpawnHealer(int lvl)
 	constexpr int PinnedItemCount = 2;
 	constexpr std::array<int, PinnedItemCount + 1> PinnedItemTypes = { IDI_HEAL, IDI_FULLHEAL, IDI_RESURRECT };
 	const int itemCount = GenerateRnd(gbIsHellfire ? 10 : 8) + 10;
+	const VendorItemCandidates candidates = GetHealerItemCandidates(lvl);
 
 	for (int i = 0; i < 20; i++) {
 		Item &item = healitem[i];
@@ -4296,7 +4822,7 @@ void SpawnHealer(int lvl)
 
 		item._iSeed = AdvanceRndSeed();
 		SetRndSeed(item._iSeed);
-		int itype = RndHealerItem(lvl) - 1;
+		int itype = candidates.pick() - 1;
 		GetItemAttrs(item, itype, lvl);
 		item._iCreateInfo = lvl | CF_HEALER;
 		item._iIdentified = true;
@@ -4342,16 +4868,13 @@ void CreateSpellBook(Point position, spell_id ispell, bool sendmsg, bool delta)
 	int ii = AllocateItem();
 	auto &item = Items[ii];
 
-	while (true) {
-		item = {};
-		SetupAllItems(item, idx, AdvanceRndSeed(), 2 * lvl, 1, true, false, delta);
-		if (item._iMiscId == IMISC_BOOK && item._iSpell == ispell)
-			break;
-	}
+	RollItemUntil(
+	    item, idx, 2 * lvl, delta, [ispell](const Item &roll) { return roll._iMiscId == IMISC_BOOK && roll._iSpell == ispell; },
+	    [idx]() { return idx; });
 	GetSuperItemSpace(position, ii);
 
 	if (sendmsg)
-		NetSendCmdPItem(false, CMD_DROPITEM, item.position, item);
+		NetSendCmdDropItem(item.position, item);
 	if (delta)
 		DeltaAddItem(ii);
 }
@@ -4563,7 +5086,8 @@ void Item::setNewAnimation(bool showAnimation)
 {
 	int8_t it = ItemCAnimTbl[_iCurs];
 	int8_t numberOfFrames = ItemAnimLs[it];
-	auto celSprite = itemanims[it] ? OptionalCelSprite { *itemanims[it] } : std::nullopt;
+	const OptionalOwnedCelSprite &itemAnim = GetItemAnim(it);
+	auto celSprite = itemAnim ? OptionalCelSprite { *itemAnim } : std::nullopt;
 	if (_iCurs != ICURS_MAGIC_ROCK)
 		AnimInfo.setNewAnimation(celSprite, numberOfFrames, 1, AnimationDistributionFlags::ProcessAnimationPending, 0, numberOfFrames);
 	else
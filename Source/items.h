@@ -426,6 +426,37 @@ struct Item {
 	void updateRequiredStatsCacheForPlayer(const Player &player);
 };
 
+/**
+ * @brief Everything the texts describing an item are formatted from, to tell when they need to be formatted again.
+ *
+ * Oils, repairs and recharges change an item without changing its seed, so the fields they touch are part of the key.
+ */
+struct ItemTextKey {
+	int32_t seed;
+	uint16_t createInfo;
+	_item_indexes itemIndex;
+	bool identified;
+	int32_t value;
+	int32_t durability;
+	int32_t maxDurability;
+	int32_t charges;
+	int32_t maxCharges;
+	int32_t minDamage;
+	int32_t maxDamage;
+	int32_t armor;
+	int16_t toHitBonus;
+	int16_t damageBonus;
+	int16_t armorBonus;
+	int8_t minStr;
+	uint8_t minMag;
+	int8_t minDex;
+	uint32_t languageGeneration;
+
+	explicit ItemTextKey(const Item &item);
+
+	bool operator==(const ItemTextKey &other) const;
+};
+
 struct ItemGetRecordStruct {
 	int32_t nSeed;
 	uint16_t wCI;
@@ -452,10 +483,15 @@ extern bool UniqueItemFlags[128];
 uint8_t GetOutlineColor(const Item &item, bool checkReq);
 bool IsItemAvailable(int i);
 bool IsUniqueAvailable(int i);
+/**
+ * @brief Resets the item state that outlives a game. The item graphics are loaded on first use, see LoadItemGFX.
+ */
 void InitItemGFX();
 void InitItems();
 void CalcPlrItemVals(Player &player, bool Loadgfx);
 void CalcPlrInv(Player &player, bool Loadgfx);
+/** @brief Frees the weapon graphics CalcPlrInv prefetched while the inventory was open, called when it closes. */
+void DiscardInventoryWeaponGraphics();
 void InitializeItem(Item &item, int itemData);
 void GenerateNewSeed(Item &h);
 int GetGoldCursor(int value);
@@ -489,6 +525,10 @@ void SpawnTheodore(Point position, bool sendmsg);
 void RespawnItem(Item &item, bool FlipFlag);
 void DeleteItem(int i);
 void ProcessItems();
+/**
+ * @brief Loads all item graphics up front, so that no item drop in the game has to wait on the archives.
+ */
+void LoadItemGFX();
 void FreeItemGFX();
 void GetItemFrm(Item &item);
 void GetItemStr(Item &item);
@@ -4,11 +4,13 @@
 #include "engine/point.hpp"
 #include "engine/random.hpp"
 #include "engine/rectangle.hpp"
+#include "interfac.h"
 #include "levels/crypt.h"
 #include "levels/gendung.h"
 #include "player.h"
 #include "quests.h"
 #include "utils/bitset2d.hpp"
+#include "utils/stdcompat/bit.hpp"
 
 namespace devilution {
 
@@ -1165,7 +1167,8 @@ void GenerateLevel(lvl_entry entry)
 
 	LoadQuestSetPieces();
 
-	while (true) {
+	for (;; DungeonRetries++) {
+		ProgressPump();
 		DRLG_InitTrans();
 
 		do {
@@ -1236,18 +1239,20 @@ void Pass3()
 
 void PlaceMiniSetRandom(const Miniset &miniset, int rndper)
 {
-	int sw = miniset.size.width;
 	int sh = miniset.size.height;
 
+	MinisetMatches matches { miniset, false };
 	for (int sy = 0; sy < DMAXY - sh; sy++) {
-		for (int sx = 0; sx < DMAXX - sw; sx++) {
-			if (!miniset.matches({ sx, sy }, false))
-				continue;
+		for (uint64_t row = matches.row(sy); row != 0;) {
+			const int sx = countr_zero(row);
+			row &= row - 1;
 			if (!CanReplaceTile(miniset.replace[0][0], { sx, sy }))
 				continue;
 			if (GenerateRnd(100) >= rndper)
 				continue;
 			miniset.place({ sx, sy });
+			matches.update({ sx, sy });
+			row = matches.row(sy) & (~uint64_t { 0 } << (sx + 1));
 		}
 	}
 }
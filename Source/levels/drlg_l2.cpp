@@ -11,11 +11,13 @@
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
 #include "engine/size.hpp"
+#include "interfac.h"
 #include "levels/gendung.h"
 #include "levels/setmaps.h"
 #include "player.h"
 #include "quests.h"
 #include "utils/stdcompat/algorithm.hpp"
+#include "utils/stdcompat/bit.hpp"
 #include "utils/stdcompat/optional.hpp"
 
 namespace devilution {
@@ -1584,12 +1586,13 @@ void PlaceMiniSetRandom(const Miniset &miniset, int rndper)
 	int sw = miniset.size.width;
 	int sh = miniset.size.height;
 
+	MinisetMatches matches { miniset };
 	for (int sy = 0; sy < DMAXY - sh; sy++) {
-		for (int sx = 0; sx < DMAXX - sw; sx++) {
+		for (uint64_t row = matches.row(sy); row != 0;) {
+			const int sx = countr_zero(row);
+			row &= row - 1;
 			if (SetPieceRoom.contains({ sx, sy }))
 				continue;
-			if (!miniset.matches({ sx, sy }))
-				continue;
 			bool found = true;
 			for (int yy = std::max(sy - sh, 0); yy < std::min(sy + 2 * sh, DMAXY) && found; yy++) {
 				for (int xx = std::max(sx - sw, 0); xx < std::min(sx + 2 * sw, DMAXX); xx++) {
@@ -1604,6 +1607,8 @@ void PlaceMiniSetRandom(const Miniset &miniset, int rndper)
 			if (GenerateRnd(100) >= rndper)
 				continue;
 			miniset.place({ sx, sy });
+			matches.update({ sx, sy });
+			row = matches.row(sy) & (~uint64_t { 0 } << (sx + 1));
 		}
 	}
 }
@@ -2353,7 +2358,9 @@ void FillVoid(bool xf1, bool yf1, bool xf2, bool yf2, int xx, int yy)
 bool FillVoids()
 {
 	int to = 0;
-	while (CountEmptyTiles() > 700 && to < 100) {
+	// Only filling a void changes the count, most random picks aren't next to one.
+	int emptyTiles = CountEmptyTiles();
+	while (emptyTiles > 700 && to < 100) {
 		int xx = GenerateRnd(38) + 1;
 		int yy = GenerateRnd(38) + 1;
 		if (predungeon[xx][yy] != '#') {
@@ -2402,11 +2409,12 @@ bool FillVoids()
 		}
 		if (xf1 || yf1 || xf2 || yf2) {
 			FillVoid(xf1, yf1, xf2, yf2, xx, yy);
+			emptyTiles = CountEmptyTiles();
 		}
 		to++;
 	}
 
-	return CountEmptyTiles() <= 700;
+	return emptyTiles <= 700;
 }
 
 bool CreateDungeon()
@@ -2647,7 +2655,8 @@ void GenerateLevel(lvl_entry entry)
 {
 	LoadQuestSetPieces();
 
-	while (true) {
+	for (;; DungeonRetries++) {
+		ProgressPump();
 		nRoomCnt = 0;
 		InitDungeonFlags();
 		DRLG_InitTrans();
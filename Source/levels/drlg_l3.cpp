@@ -3,6 +3,7 @@
 #include "engine/load_file.hpp"
 #include "engine/points_in_rectangle_range.hpp"
 #include "engine/random.hpp"
+#include "interfac.h"
 #include "levels/gendung.h"
 #include "levels/setmaps.h"
 #include "lighting.h"
@@ -10,13 +11,12 @@
 #include "objdat.h"
 #include "objects.h"
 #include "quests.h"
+#include "utils/stdcompat/bit.hpp"
 
 namespace devilution {
 
 namespace {
 
-int lockoutcnt;
-
 /**
  * A lookup table for the 16 possible patterns of a 2x2 area,
  * where each cell either contains a SW wall or it doesn't.
@@ -879,86 +879,83 @@ void FillSingles()
 	}
 }
 
-void FillStraights()
+/** @brief Bit x is set if dungeon[x][y] is floor. */
+uint64_t GetFloorRow(int y)
 {
-	int xc;
-	int yc;
+	uint64_t row = 0;
+	for (int x = 0; x < DMAXX; x++) {
+		if (dungeon[x][y] != 0)
+			row |= uint64_t { 1 } << x;
+	}
+	return row;
+}
 
-	for (int j = 0; j < DMAXY - 1; j++) {
-		int xs = 0;
-		for (int i = 0; i < 37; i++) {
-			if (dungeon[i][j] == 0 && dungeon[i][j + 1] == 1) {
-				if (xs == 0) {
-					xc = i;
-				}
-				xs++;
-			} else {
-				if (xs > 3 && !FlipCoin()) {
-					for (int k = xc; k < i; k++) {
-						int rv = GenerateRnd(2);
-						dungeon[k][j] = rv;
-					}
-				}
-				xs = 0;
+/** @brief Bit y is set if dungeon[x][y] is floor. */
+uint64_t GetFloorColumn(int x)
+{
+	uint64_t column = 0;
+	for (int y = 0; y < DMAXY; y++) {
+		if (dungeon[x][y] != 0)
+			column |= uint64_t { 1 } << y;
+	}
+	return column;
+}
+
+/**
+ * @brief Randomizes the runs of candidate tiles in a line, in the same order as scanning the line tile by tile.
+ *
+ * Only runs that end before the 37th tile count and each one longer than 3 tiles has an even chance of being randomized.
+ */
+template <typename F>
+void FillStraight(uint64_t candidates, F &&setTile)
+{
+	candidates &= (uint64_t { 1 } << 37) - 1;
+	while (candidates != 0) {
+		const int start = countr_zero(candidates);
+		const int end = start + countr_zero(~(candidates >> start));
+		if (end >= 37)
+			return;
+		if (end - start > 3 && !FlipCoin()) {
+			for (int k = start; k < end; k++) {
+				setTile(k, GenerateRnd(2));
 			}
 		}
+		candidates &= ~uint64_t { 0 } << end;
 	}
+}
+
+void FillStraights()
+{
+	// Only floor (1) and empty (0) tiles exist at this point, so each line of the map fits in a bitmask.
+	// A line only changes after it was scanned, so the masks are kept up to date for the lines scanned next.
+	uint64_t rows[DMAXY];
+	for (int j = 0; j < DMAXY; j++) {
+		rows[j] = GetFloorRow(j);
+	}
+	const auto setRowTile = [&rows](int x, int y, int value) {
+		dungeon[x][y] = value;
+		rows[y] = (rows[y] & ~(uint64_t { 1 } << x)) | (static_cast<uint64_t>(value) << x);
+	};
 	for (int j = 0; j < DMAXY - 1; j++) {
-		int xs = 0;
-		for (int i = 0; i < 37; i++) {
-			if (dungeon[i][j] == 1 && dungeon[i][j + 1] == 0) {
-				if (xs == 0) {
-					xc = i;
-				}
-				xs++;
-			} else {
-				if (xs > 3 && !FlipCoin()) {
-					for (int k = xc; k < i; k++) {
-						int rv = GenerateRnd(2);
-						dungeon[k][j + 1] = rv;
-					}
-				}
-				xs = 0;
-			}
-		}
+		FillStraight(~rows[j] & rows[j + 1], [&](int k, int rv) { setRowTile(k, j, rv); });
+	}
+	for (int j = 0; j < DMAXY - 1; j++) {
+		FillStraight(rows[j] & ~rows[j + 1], [&](int k, int rv) { setRowTile(k, j + 1, rv); });
 	}
+
+	uint64_t columns[DMAXX];
+	for (int i = 0; i < DMAXX; i++) {
+		columns[i] = GetFloorColumn(i);
+	}
+	const auto setColumnTile = [&columns](int x, int y, int value) {
+		dungeon[x][y] = value;
+		columns[x] = (columns[x] & ~(uint64_t { 1 } << y)) | (static_cast<uint64_t>(value) << y);
+	};
 	for (int i = 0; i < DMAXX - 1; i++) {
-		int ys = 0;
-		for (int j = 0; j < 37; j++) {
-			if (dungeon[i][j] == 0 && dungeon[i + 1][j] == 1) {
-				if (ys == 0) {
-					yc = j;
-				}
-				ys++;
-			} else {
-				if (ys > 3 && !FlipCoin()) {
-					for (int k = yc; k < j; k++) {
-						int rv = GenerateRnd(2);
-						dungeon[i][k] = rv;
-					}
-				}
-				ys = 0;
-			}
-		}
+		FillStraight(~columns[i] & columns[i + 1], [&](int k, int rv) { setColumnTile(i, k, rv); });
 	}
 	for (int i = 0; i < DMAXX - 1; i++) {
-		int ys = 0;
-		for (int j = 0; j < 37; j++) {
-			if (dungeon[i][j] == 1 && dungeon[i + 1][j] == 0) {
-				if (ys == 0) {
-					yc = j;
-				}
-				ys++;
-			} else {
-				if (ys > 3 && !FlipCoin()) {
-					for (int k = yc; k < j; k++) {
-						int rv = GenerateRnd(2);
-						dungeon[i + 1][k] = rv;
-					}
-				}
-				ys = 0;
-			}
-		}
+		FillStraight(columns[i] & ~columns[i + 1], [&](int k, int rv) { setColumnTile(i + 1, k, rv); });
 	}
 }
 
@@ -1387,19 +1384,21 @@ bool CanReplaceTile(uint8_t replace, Point tile)
  */
 bool PlaceMiniSetRandom(const Miniset &miniset, int rndper)
 {
-	int sw = miniset.size.width;
 	int sh = miniset.size.height;
 
 	bool placed = false;
+	MinisetMatches matches { miniset };
 	for (int sy = 0; sy < DMAXY - sh; sy++) {
-		for (int sx = 0; sx < DMAXX - sw; sx++) {
-			if (!miniset.matches({ sx, sy }))
-				continue;
+		for (uint64_t row = matches.row(sy); row != 0;) {
+			const int sx = countr_zero(row);
+			row &= row - 1;
 			if (!CanReplaceTile(miniset.replace[0][0], { sx, sy }))
 				continue;
 			if (GenerateRnd(100) >= rndper)
 				continue;
 			miniset.place({ sx, sy });
+			matches.update({ sx, sy });
+			row = matches.row(sy) & (~uint64_t { 0 } << (sx + 1));
 			placed = true;
 		}
 	}
@@ -1884,43 +1883,53 @@ void HallOfHeroes()
 	}
 }
 
-void LockRectangle(int x, int y)
-{
-	if (!DungeonMask.test(x, y)) {
-		return;
-	}
-
-	DungeonMask.reset(x, y);
-	lockoutcnt++;
-	LockRectangle(x, y - 1);
-	LockRectangle(x, y + 1);
-	LockRectangle(x - 1, y);
-	LockRectangle(x + 1, y);
-}
-
+/**
+ * @brief Checks that all floor tiles are connected.
+ */
 bool Lockout()
 {
-	DungeonMask.reset();
-
-	int fx;
-	int fy;
-
-	int t = 0;
+	uint64_t floor[DMAXY];
+	uint64_t reached[DMAXY] = {};
+	int floorTiles = 0;
 	for (int j = 0; j < DMAXY; j++) {
-		for (int i = 0; i < DMAXX; i++) {
-			if (dungeon[i][j] != 0) {
-				DungeonMask.set(i, j);
-				fx = i;
-				fy = j;
-				t++;
+		floor[j] = GetFloorRow(j);
+		floorTiles += popcount(floor[j]);
+	}
+	if (floorTiles == 0)
+		return true;
+
+	// Flood fill from the first floor tile, a row at a time, until no row grows anymore.
+	int first = 0;
+	while (floor[first] == 0)
+		first++;
+	reached[first] = floor[first] & ~(floor[first] - 1);
+	bool grown = true;
+	while (grown) {
+		grown = false;
+		for (int j = first; j < DMAXY; j++) {
+			uint64_t row = reached[j];
+			if (j > 0)
+				row |= reached[j - 1];
+			if (j < DMAXY - 1)
+				row |= reached[j + 1];
+			row &= floor[j];
+			// Spread along the runs of floor in the row
+			for (uint64_t previous = 0; row != previous;) {
+				previous = row;
+				row |= ((row << 1) | (row >> 1)) & floor[j];
+			}
+			if (row != reached[j]) {
+				reached[j] = row;
+				grown = true;
 			}
 		}
 	}
 
-	lockoutcnt = 0;
-	LockRectangle(fx, fy);
-
-	return t == lockoutcnt;
+	int reachedTiles = 0;
+	for (uint64_t row : reached) {
+		reachedTiles += popcount(row);
+	}
+	return reachedTiles == floorTiles;
 }
 
 bool PlaceCaveStairs(lvl_entry entry)
@@ -1989,7 +1998,8 @@ void GenerateLevel(lvl_entry entry)
 {
 	LoadQuestSetPieces();
 
-	while (true) {
+	for (;; DungeonRetries++) {
+		ProgressPump();
 		InitDungeonFlags();
 		int x1 = GenerateRnd(20) + 10;
 		int y1 = GenerateRnd(20) + 10;
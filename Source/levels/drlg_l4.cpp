@@ -7,6 +7,7 @@
 
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
+#include "interfac.h"
 #include "levels/gendung.h"
 #include "monster.h"
 #include "multi.h"
@@ -1121,7 +1122,8 @@ void GenerateLevel(lvl_entry entry)
 {
 	LoadQuestSetPieces();
 
-	while (true) {
+	for (;; DungeonRetries++) {
+		ProgressPump();
 		DRLG_InitTrans();
 
 		constexpr size_t Minarea = 692;
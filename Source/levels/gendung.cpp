@@ -1,7 +1,11 @@
+#include <algorithm>
+#include <cstring>
 #include <stack>
 
 #include "levels/gendung.h"
 
+#include "engine/asset_prefetch.hpp"
+#include "engine/load_cel.hpp"
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
 #include "init.h"
@@ -11,15 +15,25 @@
 #include "levels/drlg_l4.h"
 #include "levels/town.h"
 #include "lighting.h"
+#include "objects.h"
 #include "options.h"
+#include "utils/memory_budget.hpp"
+#include "utils/stdcompat/string_view.hpp"
+#include "utils/str_cat.hpp"
+
+#ifndef DEVILUTIONX_RETAINED_TILESETS
+#define DEVILUTIONX_RETAINED_TILESETS 2
+#endif
 
 namespace devilution {
 
-Bitset2d<DMAXX, DMAXY> DungeonMask;
-uint8_t dungeon[DMAXX][DMAXY];
-uint8_t pdungeon[DMAXX][DMAXY];
-Bitset2d<DMAXX, DMAXY> Protected;
-Rectangle SetPieceRoom;
+DungeonContext DefaultDungeonContext;
+Bitset2d<DMAXX, DMAXY> &DungeonMask = DefaultDungeonContext.DungeonMask;
+uint8_t (&dungeon)[DMAXX][DMAXY] = DefaultDungeonContext.dungeon;
+uint8_t (&pdungeon)[DMAXX][DMAXY] = DefaultDungeonContext.pdungeon;
+Bitset2d<DMAXX, DMAXY> &Protected = DefaultDungeonContext.Protected;
+Rectangle &SetPieceRoom = DefaultDungeonContext.SetPieceRoom;
+int DungeonRetries;
 Rectangle SetPiece;
 std::unique_ptr<uint16_t[]> pSetPiece;
 OptionalOwnedCelSprite pSpecialCels;
@@ -40,7 +54,7 @@ char TransVal;
 bool TransList[256];
 uint16_t dPiece[MAXDUNX][MAXDUNY];
 MICROS DPieceMicros[MAXTILES];
-int8_t dTransVal[MAXDUNX][MAXDUNY];
+int8_t (&dTransVal)[MAXDUNX][MAXDUNY] = DefaultDungeonContext.dTransVal;
 char dLight[MAXDUNX][MAXDUNY];
 char dPreLight[MAXDUNX][MAXDUNY];
 DungeonFlag dFlags[MAXDUNX][MAXDUNY];
@@ -54,28 +68,119 @@ THEME_LOC themeLoc[MAXTHEMES];
 
 namespace {
 
-std::unique_ptr<uint16_t[]> LoadMinData(size_t &tileCount)
+/** @brief How many tilesets are kept besides the one of the current level type, to switch between them without reading the archive. */
+constexpr size_t MaxRetainedTilesets = DEVILUTIONX_RETAINED_TILESETS;
+
+struct TilesetPaths {
+	/** @brief Path of the CEL, TIL, MIN and SOL files without the extension. */
+	const char *basePath;
+	const char *specialCels;
+};
+
+std::optional<TilesetPaths> GetTilesetPaths(dungeon_type levelType)
 {
-	switch (leveltype) {
+	switch (levelType) {
 	case DTYPE_TOWN:
-		if (gbIsHellfire)
-			return LoadFileInMem<uint16_t>("NLevels\\TownData\\Town.MIN", &tileCount);
-		return LoadFileInMem<uint16_t>("Levels\\TownData\\Town.MIN", &tileCount);
+		return TilesetPaths { gbIsHellfire ? "NLevels\\TownData\\Town" : "Levels\\TownData\\Town", "Levels\\TownData\\TownS.CEL" };
 	case DTYPE_CATHEDRAL:
-		return LoadFileInMem<uint16_t>("Levels\\L1Data\\L1.MIN", &tileCount);
+		return TilesetPaths { "Levels\\L1Data\\L1", "Levels\\L1Data\\L1S.CEL" };
 	case DTYPE_CATACOMBS:
-		return LoadFileInMem<uint16_t>("Levels\\L2Data\\L2.MIN", &tileCount);
+		return TilesetPaths { "Levels\\L2Data\\L2", "Levels\\L2Data\\L2S.CEL" };
 	case DTYPE_CAVES:
-		return LoadFileInMem<uint16_t>("Levels\\L3Data\\L3.MIN", &tileCount);
+		return TilesetPaths { "Levels\\L3Data\\L3", "Levels\\L1Data\\L1S.CEL" };
 	case DTYPE_HELL:
-		return LoadFileInMem<uint16_t>("Levels\\L4Data\\L4.MIN", &tileCount);
+		return TilesetPaths { "Levels\\L4Data\\L4", "Levels\\L2Data\\L2S.CEL" };
 	case DTYPE_NEST:
-		return LoadFileInMem<uint16_t>("NLevels\\L6Data\\L6.MIN", &tileCount);
+		return TilesetPaths { "NLevels\\L6Data\\L6", "Levels\\L1Data\\L1S.CEL" };
 	case DTYPE_CRYPT:
-		return LoadFileInMem<uint16_t>("NLevels\\L5Data\\L5.MIN", &tileCount);
+		return TilesetPaths { "NLevels\\L5Data\\L5", "NLevels\\L5Data\\L5S.CEL" };
 	default:
-		app_fatal("LoadMinData");
+		return std::nullopt;
+	}
+}
+
+/**
+ * @brief The files of a level type, as read from the archive.
+ *
+ * While a level of the type is loaded, the graphics are moved out to pDungeonCels, pMegaTiles and pSpecialCels.
+ */
+struct Tileset {
+	const char *basePath = nullptr;
+	std::unique_ptr<byte[]> dungeonCels;
+	std::unique_ptr<MegaTile[]> megaTiles;
+	OptionalOwnedCelSprite specialCels;
+	std::unique_ptr<uint16_t[]> minData;
+	size_t minDataCount = 0;
+	std::unique_ptr<byte[]> solData;
+	size_t solDataSize = 0;
+	/** @brief Bytes read from the archive, the converted special cels are small enough to be left out. */
+	size_t size = 0;
+};
+
+/** @brief The tileset of the current level type. */
+Tileset CurrentTileset;
+/** @brief Tilesets of earlier level types, the least recently used first. */
+std::vector<Tileset> RetainedTilesets;
+
+void UpdateTilesetUsage()
+{
+	size_t usage = CurrentTileset.size;
+	for (const Tileset &tileset : RetainedTilesets)
+		usage += tileset.size;
+	SetMemoryUsage(MemoryTag::Tilesets, usage);
+}
+
+/**
+ * @brief Makes CurrentTileset the one of the current level type, retaining the previous one if it fits the budget.
+ */
+Tileset &UseTileset()
+{
+	const std::optional<TilesetPaths> paths = GetTilesetPaths(leveltype);
+	if (!paths)
+		app_fatal("UseTileset");
+	if (CurrentTileset.basePath != nullptr && string_view(CurrentTileset.basePath) == paths->basePath)
+		return CurrentTileset;
+
+	Tileset next;
+	auto retained = std::find_if(RetainedTilesets.begin(), RetainedTilesets.end(), [&paths](const Tileset &tileset) {
+		return string_view(tileset.basePath) == paths->basePath;
+	});
+	if (retained != RetainedTilesets.end()) {
+		next = std::move(*retained);
+		RetainedTilesets.erase(retained);
+	} else {
+		next.basePath = paths->basePath;
+	}
+
+	// The graphics of the previous type have to be given back by ReleaseTileset first.
+	if (CurrentTileset.basePath != nullptr && pDungeonCels == nullptr) {
+		RetainedTilesets.push_back(std::move(CurrentTileset));
+		// The kept tilesets may take this many bytes, the least recently used ones are freed first.
+		size_t budget = GetMemoryBudget(MemoryTag::Tilesets);
+		size_t kept = 0;
+		for (auto it = RetainedTilesets.rbegin(); it != RetainedTilesets.rend(); ++it) {
+			if (kept == MaxRetainedTilesets || it->size > budget)
+				break;
+			budget -= it->size;
+			kept++;
+		}
+		RetainedTilesets.erase(RetainedTilesets.begin(), RetainedTilesets.end() - kept);
 	}
+	CurrentTileset = std::move(next);
+	UpdateTilesetUsage();
+	return CurrentTileset;
+}
+
+const uint16_t *LoadMinData(size_t &tileCount)
+{
+	Tileset &tileset = UseTileset();
+	if (tileset.minData == nullptr) {
+		tileset.minData = LoadFileInMem<uint16_t>(StrCat(tileset.basePath, ".MIN").c_str(), &tileset.minDataCount);
+		tileset.size += tileset.minDataCount * sizeof(uint16_t);
+		UpdateTilesetUsage();
+	}
+	tileCount = tileset.minDataCount;
+	return tileset.minData.get();
 }
 
 /**
@@ -347,6 +452,7 @@ void InitGlobals()
 	dmaxPosition = Point(40, 40).megaToWorld();
 	SetPieceRoom = { { -1, -1 }, { -1, -1 } };
 	SetPiece = { { 0, 0 }, { 0, 0 } };
+	DungeonRetries = 0;
 }
 
 } // namespace
@@ -414,35 +520,84 @@ bool TileHasAny(int tileId, TileProperties property)
 
 void LoadLevelSOLData()
 {
-	switch (leveltype) {
-	case DTYPE_TOWN:
-		if (gbIsHellfire)
-			LoadFileInMem("NLevels\\TownData\\Town.SOL", SOLData);
-		else
-			LoadFileInMem("Levels\\TownData\\Town.SOL", SOLData);
-		break;
-	case DTYPE_CATHEDRAL:
-		LoadFileInMem("Levels\\L1Data\\L1.SOL", SOLData);
-		break;
-	case DTYPE_CATACOMBS:
-		LoadFileInMem("Levels\\L2Data\\L2.SOL", SOLData);
-		break;
-	case DTYPE_CAVES:
-		LoadFileInMem("Levels\\L3Data\\L3.SOL", SOLData);
-		break;
-	case DTYPE_HELL:
-		LoadFileInMem("Levels\\L4Data\\L4.SOL", SOLData);
+	Tileset &tileset = UseTileset();
+	if (tileset.solData == nullptr) {
+		tileset.solData = LoadFileInMem(StrCat(tileset.basePath, ".SOL").c_str(), &tileset.solDataSize);
+		tileset.size += tileset.solDataSize;
+		UpdateTilesetUsage();
+	}
+	SOLData = {};
+	std::memcpy(SOLData.data(), tileset.solData.get(), std::min(tileset.solDataSize, sizeof(SOLData)));
+	if (leveltype == DTYPE_HELL)
 		SOLData[210] = TileProperties::None; // Tile is incorrectly marked as being solid
-		break;
-	case DTYPE_NEST:
-		LoadFileInMem("NLevels\\L6Data\\L6.SOL", SOLData);
-		break;
-	case DTYPE_CRYPT:
-		LoadFileInMem("NLevels\\L5Data\\L5.SOL", SOLData);
-		break;
-	default:
-		app_fatal("LoadLevelSOLData");
+}
+
+void LoadLvlGFX()
+{
+	constexpr int SpecialCelWidth = 64;
+
+	Tileset &tileset = UseTileset();
+	if (tileset.dungeonCels == nullptr) {
+		size_t celSize;
+		tileset.dungeonCels = LoadFileInMem(StrCat(tileset.basePath, ".CEL").c_str(), &celSize);
+		size_t numMegaTiles;
+		tileset.megaTiles = LoadFileInMem<MegaTile>(StrCat(tileset.basePath, ".TIL").c_str(), &numMegaTiles);
+		tileset.specialCels = LoadCelAsCl2(GetTilesetPaths(leveltype)->specialCels, SpecialCelWidth);
+		tileset.size += celSize + numMegaTiles * sizeof(MegaTile);
+		UpdateTilesetUsage();
 	}
+	pDungeonCels = std::move(tileset.dungeonCels);
+	pMegaTiles = std::move(tileset.megaTiles);
+	pSpecialCels = std::move(tileset.specialCels);
+	tileset.specialCels = std::nullopt;
+}
+
+void ReleaseLvlGFX()
+{
+	if (pDungeonCels == nullptr)
+		return;
+	CurrentTileset.dungeonCels = std::move(pDungeonCels);
+	CurrentTileset.megaTiles = std::move(pMegaTiles);
+	CurrentTileset.specialCels = std::move(pSpecialCels);
+	pSpecialCels = std::nullopt;
+}
+
+void FreeTilesets()
+{
+	pDungeonCels = nullptr;
+	pMegaTiles = nullptr;
+	pSpecialCels = std::nullopt;
+	CurrentTileset = {};
+	RetainedTilesets.clear();
+	UpdateTilesetUsage();
+}
+
+bool IsTilesetRetained(dungeon_type levelType)
+{
+	const std::optional<TilesetPaths> paths = GetTilesetPaths(levelType);
+	if (!paths)
+		return false;
+	if (CurrentTileset.basePath != nullptr && string_view(CurrentTileset.basePath) == paths->basePath)
+		return true;
+	return std::any_of(RetainedTilesets.begin(), RetainedTilesets.end(), [&paths](const Tileset &tileset) {
+		return string_view(tileset.basePath) == paths->basePath;
+	});
+}
+
+void PrefetchLevelAssets(int level)
+{
+	const dungeon_type levelType = GetLevelType(level);
+
+	const std::optional<TilesetPaths> paths = GetTilesetPaths(levelType);
+	if (!paths)
+		return;
+	std::vector<std::string> files;
+	// The same files as loaded by LoadLvlGFX, LoadMinData and LoadLevelSOLData
+	if (!IsTilesetRetained(levelType))
+		files = { StrCat(paths->basePath, ".CEL"), StrCat(paths->basePath, ".TIL"), StrCat(paths->basePath, ".MIN"), StrCat(paths->basePath, ".SOL"), paths->specialCels };
+	// Generating the level and its monsters depends on the RNG state, but most of its objects only depend on the level.
+	AddLevelObjectFiles(level, levelType, files);
+	PrefetchAssets(files);
 }
 
 void SetDungeonMicros()
@@ -459,10 +614,10 @@ void SetDungeonMicros()
 	}
 
 	size_t tileCount;
-	std::unique_ptr<uint16_t[]> levelPieces = LoadMinData(tileCount);
+	const uint16_t *levelPieces = LoadMinData(tileCount);
 
 	for (size_t i = 0; i < tileCount / blocks; i++) {
-		uint16_t *pieces = &levelPieces[blocks * i];
+		const uint16_t *pieces = &levelPieces[blocks * i];
 		for (size_t block = 0; block < blocks; block++) {
 			DPieceMicros[i].mt[block] = SDL_SwapLE16(pieces[blocks - 2 + (block & 1) - (block & 0xE)]);
 		}
@@ -557,6 +712,63 @@ void Make_SetPC(Rectangle area)
 	}
 }
 
+MinisetMatches::MinisetMatches(const Miniset &miniset, bool respectProtected)
+    : size_(miniset.size)
+    , respectProtected_(respectProtected)
+{
+	std::fill_n(valueIndices_, 256, NoValue);
+	std::fill_n(valueRows_[NoValue], DMAXY, 0);
+	for (int yy = 0; yy < size_.height; yy++) {
+		for (int xx = 0; xx < size_.width; xx++) {
+			const uint8_t value = miniset.search[yy][xx];
+			if (value == 0)
+				continue;
+			if (valueIndices_[value] == NoValue)
+				valueIndices_[value] = numValues_++;
+			searchTiles_[numSearchTiles_++] = { static_cast<uint8_t>(xx), static_cast<uint8_t>(yy), valueIndices_[value] };
+		}
+	}
+	readRows(0, DMAXY - 1);
+}
+
+uint64_t MinisetMatches::row(int y) const
+{
+	uint64_t matches = (uint64_t { 1 } << (DMAXX - size_.width)) - 1;
+	for (int i = 0; i < numSearchTiles_; i++) {
+		const SearchTile &tile = searchTiles_[i];
+		matches &= valueRows_[tile.valueIndex][y + tile.y] >> tile.x;
+	}
+	if (respectProtected_ && matches != 0) {
+		uint64_t protectedTiles = 0;
+		for (int yy = 0; yy < size_.height; yy++)
+			protectedTiles |= protectedRows_[y + yy];
+		for (int xx = 0; xx < size_.width; xx++)
+			matches &= ~(protectedTiles >> xx);
+	}
+	return matches;
+}
+
+void MinisetMatches::update(Point position)
+{
+	readRows(position.y, std::min(position.y + size_.height, DMAXY) - 1);
+}
+
+void MinisetMatches::readRows(int firstRow, int lastRow)
+{
+	for (int i = 0; i < numValues_; i++)
+		std::fill(&valueRows_[i][firstRow], &valueRows_[i][lastRow + 1], 0);
+	// Every tile is read once whatever the number of values. Tiles that aren't searched for go to the
+	// spare masks at NoValue, which avoids a hard to predict branch.
+	for (int x = 0; x < DMAXX; x++) {
+		for (int y = firstRow; y <= lastRow; y++)
+			valueRows_[valueIndices_[dungeon[x][y]]][y] |= uint64_t { 1 } << x;
+	}
+	if (!respectProtected_)
+		return;
+	for (int y = firstRow; y <= lastRow; y++)
+		protectedRows_[y] = Protected.rowWord(y);
+}
+
 std::optional<Point> PlaceMiniSet(const Miniset &miniset, int tries, bool drlg1Quirk)
 {
 	int sw = miniset.size.width;
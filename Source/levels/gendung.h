@@ -137,15 +137,33 @@ struct ShadowStruct {
 	uint8_t nv3;
 };
 
-/** Reprecents what tiles are being utilized in the generated map. */
-extern Bitset2d<DMAXX, DMAXY> DungeonMask;
-/** Contains the tile IDs of the map. */
-extern DVL_API_FOR_TEST uint8_t dungeon[DMAXX][DMAXY];
-/** Contains a backup of the tile IDs of the map. */
-extern uint8_t pdungeon[DMAXX][DMAXY];
-/** Tile that may not be overwritten by the level generator */
-extern Bitset2d<DMAXX, DMAXY> Protected;
-extern Rectangle SetPieceRoom;
+/**
+ * @brief The map a level generator builds a level in.
+ *
+ * The generators use the default instance through the globals below, which are references to its members.
+ */
+struct DungeonContext {
+	/** Reprecents what tiles are being utilized in the generated map. */
+	Bitset2d<DMAXX, DMAXY> DungeonMask;
+	/** Contains the tile IDs of the map. */
+	uint8_t dungeon[DMAXX][DMAXY];
+	/** Contains a backup of the tile IDs of the map. */
+	uint8_t pdungeon[DMAXX][DMAXY];
+	/** Tile that may not be overwritten by the level generator */
+	Bitset2d<DMAXX, DMAXY> Protected;
+	Rectangle SetPieceRoom;
+	/** Specifies the transparency at each coordinate of the map. */
+	int8_t dTransVal[MAXDUNX][MAXDUNY];
+};
+
+extern DVL_API_FOR_TEST DungeonContext DefaultDungeonContext;
+extern Bitset2d<DMAXX, DMAXY> &DungeonMask;
+extern DVL_API_FOR_TEST uint8_t (&dungeon)[DMAXX][DMAXY];
+extern uint8_t (&pdungeon)[DMAXX][DMAXY];
+extern Bitset2d<DMAXX, DMAXY> &Protected;
+extern Rectangle &SetPieceRoom;
+/** Number of times the generator of the current level threw away a finished layout and started over. */
+extern int DungeonRetries;
 /** Specifies the active set quest piece in coordinate. */
 extern Rectangle SetPiece;
 /** Contains the contents of the single player quest DUN file. */
@@ -182,8 +200,7 @@ extern bool TransList[256];
 extern DVL_API_FOR_TEST uint16_t dPiece[MAXDUNX][MAXDUNY];
 /** Map of micros that comprises a full tile for any given dungeon piece. */
 extern MICROS DPieceMicros[MAXTILES];
-/** Specifies the transparency at each coordinate of the map. */
-extern DVL_API_FOR_TEST int8_t dTransVal[MAXDUNX][MAXDUNY];
+extern DVL_API_FOR_TEST int8_t (&dTransVal)[MAXDUNX][MAXDUNY];
 extern char dLight[MAXDUNX][MAXDUNY];
 extern char dPreLight[MAXDUNX][MAXDUNY];
 /** Holds various information about dungeon tiles, @see DungeonFlag */
@@ -320,8 +337,80 @@ struct Miniset {
 	}
 };
 
+/**
+ * @brief Finds the positions at which a miniset matches a row at a time, using bitmasks of the tiles it searches for.
+ *
+ * The masks are built once, so changes to the map have to be reported through update().
+ */
+class MinisetMatches {
+public:
+	/**
+	 * @param respectProtected Same as for Miniset::matches
+	 */
+	MinisetMatches(const Miniset &miniset, bool respectProtected = true);
+
+	/**
+	 * @brief Returns the positions in the given row at which Miniset::matches is true.
+	 * @return Bit x is set for position { x, y }, only positions with x < DMAXX - width are included.
+	 */
+	[[nodiscard]] uint64_t row(int y) const;
+
+	/**
+	 * @brief Rereads the tiles that the miniset covers at the given position, e.g. after placing it there.
+	 */
+	void update(Point position);
+
+private:
+	struct SearchTile {
+		uint8_t x;
+		uint8_t y;
+		uint8_t valueIndex;
+	};
+
+	static constexpr uint8_t NoValue = 36;
+
+	void readRows(int firstRow, int lastRow);
+
+	Size size_;
+	bool respectProtected_;
+	int numSearchTiles_ = 0;
+	int numValues_ = 0;
+	SearchTile searchTiles_[36];
+	/** @brief Index into valueRows_ of each tile value, NoValue if the miniset doesn't search for it. */
+	uint8_t valueIndices_[256];
+	/** @brief Bit x of valueRows_[i][y] is set if dungeon[x][y] is the value with index i. */
+	uint64_t valueRows_[NoValue + 1][DMAXY];
+	uint64_t protectedRows_[DMAXY];
+};
+
 bool TileHasAny(int tileId, TileProperties property);
 void LoadLevelSOLData();
+
+/**
+ * @brief Loads pDungeonCels, pMegaTiles and pSpecialCels for the current level type.
+ *
+ * The files of the last few level types are kept in memory, so going back and forth between them skips the archive.
+ */
+void LoadLvlGFX();
+
+/**
+ * @brief Takes back the tileset graphics of the current level, the next level may reuse them if it is of the same type.
+ */
+void ReleaseLvlGFX();
+
+/**
+ * @brief Frees the tileset of the current level and all the ones kept for later levels.
+ */
+void FreeTilesets();
+
+/**
+ * @brief Whether the files of the given level type's tileset are in memory, so reading them ahead is pointless.
+ */
+bool IsTilesetRetained(dungeon_type levelType);
+/**
+ * @brief Starts reading the tileset and the object sprites of the given level in the background, see PrefetchAssets.
+ */
+void PrefetchLevelAssets(int level);
 void SetDungeonMicros();
 void DRLG_InitTrans();
 void DRLG_MRectTrans(Point origin, Point extent);
@@ -5,6 +5,10 @@
  */
 #include "levels/themes.h"
 
+#include <algorithm>
+#include <array>
+#include <limits>
+
 #include <fmt/core.h>
 
 #include "engine/path.h"
@@ -19,6 +23,45 @@
 
 namespace devilution {
 
+namespace {
+
+/** @brief Inclusive bounds of the tiles of a transparency region, empty if minX > maxX. */
+struct RegionBounds {
+	int minX;
+	int minY;
+	int maxX;
+	int maxY;
+};
+
+constexpr RegionBounds EmptyRegion { MAXDUNX, MAXDUNY, -1, -1 };
+
+/** @brief Bounds of every dTransVal region indexed by the value as uint8_t, lets the theme fitting skip the rest of the level. */
+std::array<RegionBounds, 256> RegionIndex;
+
+void BuildRegionIndex()
+{
+	RegionIndex.fill(EmptyRegion);
+	for (int y = 0; y < MAXDUNY; y++) {
+		for (int x = 0; x < MAXDUNX; x++) {
+			RegionBounds &bounds = RegionIndex[static_cast<uint8_t>(dTransVal[x][y])];
+			bounds.minX = std::min(bounds.minX, x);
+			bounds.minY = std::min(bounds.minY, y);
+			bounds.maxX = std::max(bounds.maxX, x);
+			bounds.maxY = std::max(bounds.maxY, y);
+		}
+	}
+}
+
+const RegionBounds &GetRegionBounds(int regionId)
+{
+	// dTransVal is signed, values outside of its range never match a tile.
+	if (regionId < std::numeric_limits<int8_t>::min() || regionId > std::numeric_limits<int8_t>::max())
+		return EmptyRegion;
+	return RegionIndex[static_cast<uint8_t>(regionId)];
+}
+
+} // namespace
+
 int numthemes;
 bool armorFlag;
 bool weaponFlag;
@@ -54,13 +97,13 @@ int trm5y[] = {
 };
 bool TFit_Shrine(int i)
 {
-	int xp = 0;
-	int yp = 0;
-	int found = 0;
-
-	while (found == 0) {
-		Point testPosition { xp, yp };
-		if (dTransVal[xp][yp] == themes[i].ttval) {
+	const RegionBounds &bounds = GetRegionBounds(themes[i].ttval);
+	for (int yp = bounds.minY; yp <= bounds.maxY; yp++) {
+		for (int xp = bounds.minX; xp <= bounds.maxX; xp++) {
+			if (dTransVal[xp][yp] != themes[i].ttval)
+				continue;
+			Point testPosition { xp, yp };
+			int found = 0;
 			if (TileHasAny(dPiece[xp][yp - 1], TileProperties::Trap)
 			    && IsTileNotSolid(testPosition + Direction::NorthWest)
 			    && IsTileNotSolid(testPosition + Direction::SouthEast)
@@ -80,34 +123,29 @@ bool TFit_Shrine(int i)
 			    && !IsObjectAtPosition(testPosition + Direction::West)) {
 				found = 2;
 			}
-		}
-		if (found == 0) {
-			xp++;
-			if (xp == MAXDUNX) {
-				xp = 0;
-				yp++;
-				if (yp == MAXDUNY)
-					return false;
+			if (found != 0) {
+				themex = xp;
+				themey = yp;
+				themeVar1 = found;
+				return true;
 			}
 		}
 	}
-	themex = xp;
-	themey = yp;
-	themeVar1 = found;
-	return true;
+	return false;
 }
 
 bool TFit_Obj5(int t)
 {
-	int xp = 0;
-	int yp = 0;
-	int r = GenerateRnd(5) + 1;
-	int rs = r;
-
-	while (r > 0) {
-		bool found = false;
-		if (dTransVal[xp][yp] == themes[t].ttval && IsTileNotSolid({ xp, yp })) {
-			found = true;
+	// This roll used to pick which fitting tile to use, but the search never got past the first one.
+	// It is kept so that a seed still generates the same level.
+	DiscardRandomValues(1);
+
+	const RegionBounds &bounds = GetRegionBounds(themes[t].ttval);
+	for (int yp = bounds.minY; yp <= bounds.maxY; yp++) {
+		for (int xp = bounds.minX; xp <= bounds.maxX; xp++) {
+			if (dTransVal[xp][yp] != themes[t].ttval || !IsTileNotSolid({ xp, yp }))
+				continue;
+			bool found = true;
 			for (int i = 0; found && i < 25; i++) {
 				if (TileHasAny(dPiece[xp + trm5x[i]][yp + trm5y[i]], TileProperties::Solid)) {
 					found = false;
@@ -116,30 +154,15 @@ bool TFit_Obj5(int t)
 					found = false;
 				}
 			}
-		}
-
-		if (!found) {
-			xp++;
-			if (xp == MAXDUNX) {
-				xp = 0;
-				yp++;
-				if (yp == MAXDUNY) {
-					if (r == rs) {
-						return false;
-					}
-					yp = 0;
-				}
+			if (found) {
+				themex = xp;
+				themey = yp;
+				return true;
 			}
-			continue;
 		}
-
-		r--;
 	}
 
-	themex = xp;
-	themey = yp;
-
-	return true;
+	return false;
 }
 
 bool TFit_SkelRoom(int t)
@@ -198,8 +221,14 @@ bool TFit_Obj3(int8_t regionId)
 {
 	constexpr unsigned objrnd[4] = { 4, 4, 3, 5 };
 
-	for (int yp = 1; yp < MAXDUNY - 1; yp++) {
-		for (int xp = 1; xp < MAXDUNX - 1; xp++) {
+	// Origins next to the region use up rolls without fitting, so the search covers them as well.
+	const RegionBounds &bounds = GetRegionBounds(regionId);
+	const int minX = std::max(bounds.minX - 1, 1);
+	const int minY = std::max(bounds.minY - 1, 1);
+	const int maxX = std::min(bounds.maxX + 1, MAXDUNX - 2);
+	const int maxY = std::min(bounds.maxY + 1, MAXDUNY - 2);
+	for (int yp = minY; yp <= maxY; yp++) {
+		for (int xp = minX; xp <= maxX; xp++) {
 			if (CheckThemeObj3({ xp, yp }, regionId, objrnd[leveltype - 1])) {
 				themex = xp;
 				themey = yp;
@@ -354,9 +383,10 @@ bool CheckThemeRoom(int tv)
 			return false;
 	}
 
+	const RegionBounds &bounds = GetRegionBounds(tv);
 	int tarea = 0;
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) {
+	for (int j = bounds.minY; j <= bounds.maxY; j++) {
+		for (int i = bounds.minX; i <= bounds.maxX; i++) {
 			if (dTransVal[i][j] != tv)
 				continue;
 			if (TileContainsSetPiece({ i, j }))
@@ -369,8 +399,8 @@ bool CheckThemeRoom(int tv)
 	if (leveltype == DTYPE_CATHEDRAL && (tarea < 9 || tarea > 100))
 		return false;
 
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) {
+	for (int j = bounds.minY; j <= bounds.maxY; j++) {
+		for (int i = bounds.minX; i <= bounds.maxX; i++) {
 			if (dTransVal[i][j] != tv || TileHasAny(dPiece[i][j], TileProperties::Solid))
 				continue;
 			if (dTransVal[i - 1][j] != tv && IsTileNotSolid({ i - 1, j }))
@@ -404,6 +434,8 @@ void InitThemes()
 		return;
 	}
 
+	BuildRegionIndex();
+
 	if (leveltype == DTYPE_CATHEDRAL) {
 		for (size_t i = 0; i < 256 && numthemes < MAXTHEMES; i++) {
 			if (CheckThemeRoom(i)) {
@@ -955,6 +987,7 @@ void CreateThemeRooms()
 		return;
 	}
 
+	BuildRegionIndex();
 	ApplyObjectLighting = true;
 	for (int i = 0; i < numthemes; i++) {
 		themex = 0;
@@ -1,10 +1,12 @@
 #include "levels/town.h"
 
 #include "engine/load_file.hpp"
+#include "engine/path.h"
 #include "engine/random.hpp"
 #include "init.h"
 #include "levels/drlg_l1.h"
 #include "levels/trigs.h"
+#include "lighting.h"
 #include "player.h"
 #include "quests.h"
 
@@ -295,6 +297,8 @@ void TownOpenHive()
 	dPiece[86][61] = 0x17;
 	dPiece[85][62] = 0x12;
 	dPiece[84][64] = 0x117;
+	InvalidatePathDistanceFields();
+	InvalidateVisionCache();
 }
 
 void TownOpenGrave()
@@ -309,6 +313,8 @@ void TownOpenGrave()
 	dPiece[37][24] = 0x539;
 	dPiece[35][21] = 0x53a;
 	dPiece[34][21] = 0x53b;
+	InvalidatePathDistanceFields();
+	InvalidateVisionCache();
 }
 
 void CreateTown(lvl_entry entry)
@@ -339,7 +345,6 @@ void CreateTown(lvl_entry entry)
 	}
 
 	DrlgTPass3();
-	pMegaTiles = nullptr;
 }
 
 } // namespace devilution
@@ -10,8 +10,10 @@
 #include "control.h"
 #include "controls/plrctrls.h"
 #include "cursor.h"
+#include "engine/asset_prefetch.hpp"
 #include "error.h"
 #include "init.h"
+#include "quests.h"
 #include "utils/language.h"
 #include "utils/utf8.hpp"
 
@@ -816,10 +818,97 @@ void CheckTrigForce()
 	}
 }
 
+namespace {
+
+/** Walking distance to a trigger at which the files of the level it leads to start being read in the background. */
+constexpr int TriggerPrefetchDistance = 8;
+
+struct NearbyTrigger {
+	int level;
+	bool isSetLevel;
+	Point position;
+	int distance;
+	bool prefetched;
+
+	[[nodiscard]] bool isSameTrigger(const NearbyTrigger &other) const
+	{
+		return level == other.level && isSetLevel == other.isSetLevel && position == other.position;
+	}
+};
+
+std::optional<NearbyTrigger> ApproachedTrigger;
+
+/**
+ * @return The level the trigger leads to, or -1 if there is nothing to read for it.
+ */
+int GetTriggerDestinationLevel(const TriggerStruct &trigger)
+{
+	switch (trigger._tmsg) {
+	case WM_DIABNEXTLVL:
+		if (gbIsSpawn && currlevel >= 2)
+			return -1;
+		return currlevel + 1;
+	case WM_DIABPREVLVL:
+		return currlevel - 1;
+	case WM_DIABRTNLVL:
+		return ReturnLevel;
+	case WM_DIABTOWNWARP:
+		return trigger._tlvl;
+	case WM_DIABTWARPUP:
+		return 0;
+	default:
+		return -1;
+	}
+}
+
+/**
+ * @brief Reads the files of the level behind the nearest trigger while the player walks up to it.
+ *
+ * Nothing is read until the player gets closer, so that arriving next to the stairs on a new level doesn't read
+ * the level that was just left.
+ */
+void PrefetchNearbyTrigger(Point position)
+{
+	const TriggerStruct *nearest = nullptr;
+	int nearestDistance = TriggerPrefetchDistance + 1;
+	for (int i = 0; i < numtrigs; i++) {
+		const int distance = position.WalkingDistance(trigs[i].position);
+		if (distance < nearestDistance) {
+			nearest = &trigs[i];
+			nearestDistance = distance;
+		}
+	}
+
+	NearbyTrigger trigger { currlevel, setlevel, nearest != nullptr ? nearest->position : Point {}, nearestDistance, false };
+	if (ApproachedTrigger && (nearest == nullptr || !ApproachedTrigger->isSameTrigger(trigger))) {
+		if (ApproachedTrigger->prefetched)
+			DiscardPrefetchedAssets();
+		ApproachedTrigger = std::nullopt;
+	}
+	if (nearest == nullptr)
+		return;
+
+	if (!ApproachedTrigger) {
+		ApproachedTrigger = trigger;
+		return;
+	}
+	if (!ApproachedTrigger->prefetched && nearestDistance < ApproachedTrigger->distance) {
+		const int level = GetTriggerDestinationLevel(*nearest);
+		if (level >= 0)
+			PrefetchLevelAssets(level);
+		ApproachedTrigger->prefetched = true;
+	}
+	ApproachedTrigger->distance = nearestDistance;
+}
+
+} // namespace
+
 void CheckTriggers()
 {
 	Player &myPlayer = *MyPlayer;
 
+	PrefetchNearbyTrigger(myPlayer.position.tile);
+
 	if (myPlayer._pmode != PM_STAND)
 		return;
 
@@ -6,11 +6,20 @@
 #include "lighting.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 
 #include "automap.h"
 #include "diablo.h"
+#include "engine/demomode.h"
 #include "engine/load_file.hpp"
+#include "engine/rectangle.hpp"
+#include "multi.h"
+#include "options.h"
 #include "player.h"
+#include "utils/perf_scope.hpp"
 
 namespace devilution {
 
@@ -21,6 +30,7 @@ Light Lights[MAXLIGHTS];
 uint8_t ActiveLights[MAXLIGHTS];
 int ActiveLightCount;
 std::array<uint8_t, LIGHTSIZE> LightTables;
+uint32_t LightTablesVersion;
 bool DisableLighting;
 bool UpdateLighting;
 
@@ -62,6 +72,17 @@ uint8_t lightradius[16][128];
 bool dovision;
 uint8_t lightblock[64][16][16];
 
+/** @brief The distance the quadrants of a light reach from its tile. */
+constexpr int LightStampRadius = 14;
+constexpr int LightStampSize = 2 * LightStampRadius + 1;
+constexpr uint8_t NoLightBlock = 0xFF;
+
+/**
+ * @brief The lightradius index of every tile around a light for each sub-tile offset, the four rotated quadrants of
+ * lightblock combined. Indexed by [offset][x][y], NoLightBlock where the light doesn't reach.
+ */
+uint8_t lightstamps[64][LightStampSize][LightStampSize];
+
 /** RadiusAdj maps from VisionCrawlTable index to lighting vision radius adjustment. */
 const uint8_t RadiusAdj[23] = { 0, 0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 4, 3, 2, 2, 2, 1, 1, 1, 0, 0, 0, 0 };
 
@@ -106,24 +127,185 @@ char GetLight(Point position)
 	return dLight[position.x][position.y];
 }
 
-void DoUnLight(int nXPos, int nYPos, int nRadius)
+/**
+ * @brief The tiles that a light at the given tile can reach, regardless of its radius and offset.
+ */
+Rectangle GetLightArea(Point tile)
 {
-	nRadius++;
+	// A negative offset moves the light to the previous tile, see ApplyLight.
+	return { tile - Displacement { 16 }, Size { 32 } };
+}
+
+bool AreasOverlap(const Rectangle &a, const Rectangle &b)
+{
+	return a.position.x < b.position.x + b.size.width && b.position.x < a.position.x + a.size.width
+	    && a.position.y < b.position.y + b.size.height && b.position.y < a.position.y + a.size.height;
+}
+
+Rectangle GetBoundingArea(const Rectangle &a, const Rectangle &b)
+{
+	const Point topLeft { std::min(a.position.x, b.position.x), std::min(a.position.y, b.position.y) };
+	const Point bottomRight {
+		std::max(a.position.x + a.size.width, b.position.x + b.size.width),
+		std::max(a.position.y + a.size.height, b.position.y + b.size.height),
+	};
+	return { topLeft, Size { bottomRight.x - topLeft.x, bottomRight.y - topLeft.y } };
+}
+
+/**
+ * @brief Areas that have to be relit, overlapping areas are merged so that no tile is relit twice.
+ */
+struct DirtyLightAreas {
+	/** Every light can add its current and its previous area. */
+	std::array<Rectangle, 2 * MAXLIGHTS> areas;
+	size_t count = 0;
+
+	void Add(Rectangle area)
+	{
+		for (size_t i = 0; i < count;) {
+			if (!AreasOverlap(areas[i], area)) {
+				i++;
+				continue;
+			}
+			area = GetBoundingArea(areas[i], area);
+			areas[i] = areas[--count];
+			i = 0;
+		}
+		areas[count++] = area;
+	}
+};
+
+/**
+ * @brief Checks if a light that is part of dLight already lights every tile the given light would.
+ *
+ * Only lights at the exact same spot are merged, the one with the larger radius is at least as bright everywhere, so
+ * leaving out the other one doesn't change the result.
+ */
+bool IsLightCovered(int lid, const bool *applied)
+{
+	const Light &light = Lights[lid];
+	for (int i = 0; i < ActiveLightCount; i++) {
+		const int other = ActiveLights[i];
+		if (other == lid || !applied[other])
+			continue;
+		const Light &otherLight = Lights[other];
+		if (otherLight.position.tile != light.position.tile || otherLight.position.offset != light.position.offset)
+			continue;
+		if (otherLight._lradius > light._lradius || (otherLight._lradius == light._lradius && other < lid))
+			return true;
+	}
+	return false;
+}
 
-	int minX = nXPos - nRadius;
-	int maxX = nXPos + nRadius;
-	int minY = nYPos - nRadius;
-	int maxY = nYPos + nRadius;
+/**
+ * @brief How many new or moved lights are stamped per update, the others follow in the next updates.
+ *
+ * Monster AI reads dLight, so the budget only applies where nobody else has to compute the same lighting.
+ */
+int GetLightBudget()
+{
+	if (gbIsMultiplayer || demo::IsRunning() || demo::IsRecording())
+		return MAXLIGHTS;
+	return *sgOptions.Performance.lightBudget;
+}
 
-	minX = std::max(minX, 0);
-	maxX = std::max(maxX, MAXDUNX);
-	minY = std::max(minY, 0);
-	maxY = std::max(maxY, MAXDUNY);
+/**
+ * @brief Remembers where the light was when the lights were last processed, that's the area it has to be removed from.
+ */
+void MarkLightMoved(Light &light)
+{
+	if (light._lunflag)
+		return;
+	light._lunflag = true;
+	light.position.old = light.position.tile;
+	light.oldRadius = light._lradius;
+}
 
-	for (int y = minY; y < maxY; y++) {
-		for (int x = minX; x < maxX; x++) {
-			if (InDungeonBounds({ x, y }))
-				dLight[x][y] = dPreLight[x][y];
+/**
+ * @brief Combines the quadrants of lightblock the same way ApplyLight walks them.
+ */
+void MakeLightStamps()
+{
+	memset(lightstamps, NoLightBlock, sizeof(lightstamps));
+	for (int offset = 0; offset < 64; offset++) {
+		int xoff = offset % 8;
+		int yoff = offset / 8;
+		int distX = xoff;
+		int distY = yoff;
+		int lightX = 0;
+		int lightY = 0;
+		int blockX = 0;
+		int blockY = 0;
+		for (int i = 0; i < 4; i++) {
+			int mult = xoff + 8 * yoff;
+			for (int y = 0; y <= LightStampRadius; y++) {
+				for (int x = 1; x <= LightStampRadius; x++) {
+					int radiusBlock = lightblock[mult][y + blockY][x + blockX];
+					if (radiusBlock >= 128)
+						continue;
+					Displacement tile = (Displacement { x, y }).Rotate(-i);
+					lightstamps[offset][tile.deltaX + LightStampRadius][tile.deltaY + LightStampRadius] = radiusBlock;
+				}
+			}
+			RotateRadius(&xoff, &yoff, &distX, &distY, &lightX, &lightY, &blockX, &blockY);
+		}
+	}
+}
+
+/**
+ * @brief Fills lightradius, lightblock and the stamps made from them, the part of MakeLightTable that needs no files.
+ */
+void MakeLightRadiusTables()
+{
+	for (int j = 0; j < 16; j++) {
+		for (int i = 0; i < 128; i++) {
+			if (i > (j + 1) * 8) {
+				lightradius[j][i] = 15;
+			} else {
+				double fs = (double)15 * i / ((double)8 * (j + 1));
+				lightradius[j][i] = static_cast<uint8_t>(fs + 0.5);
+			}
+		}
+	}
+
+	if (IsAnyOf(leveltype, DTYPE_NEST, DTYPE_CRYPT)) {
+		for (int j = 0; j < 16; j++) {
+			double fa = (sqrt((double)(16 - j))) / 128;
+			fa *= fa;
+			for (int i = 0; i < 128; i++) {
+				lightradius[15 - j][i] = 15 - static_cast<uint8_t>(fa * (double)((128 - i) * (128 - i)));
+				if (lightradius[15 - j][i] > 15)
+					lightradius[15 - j][i] = 0;
+				lightradius[15 - j][i] = lightradius[15 - j][i] - static_cast<uint8_t>((15 - j) / 2);
+				if (lightradius[15 - j][i] > 15)
+					lightradius[15 - j][i] = 0;
+			}
+		}
+	}
+	for (int j = 0; j < 8; j++) {
+		for (int i = 0; i < 8; i++) {
+			for (int k = 0; k < 16; k++) {
+				for (int l = 0; l < 16; l++) {
+					int a = (8 * l - j);
+					int b = (8 * k - i);
+					lightblock[j * 8 + i][k][l] = static_cast<uint8_t>(sqrt(a * a + b * b));
+				}
+			}
+		}
+	}
+	MakeLightStamps();
+}
+
+void ResetLightArea(const Rectangle &area)
+{
+	const int minX = std::max(area.position.x, 0);
+	const int maxX = std::min(area.position.x + area.size.width, MAXDUNX);
+	const int minY = std::max(area.position.y, 0);
+	const int maxY = std::min(area.position.y + area.size.height, MAXDUNY);
+
+	for (int x = minX; x < maxX; x++) {
+		for (int y = minY; y < maxY; y++) {
+			dLight[x][y] = dPreLight[x][y];
 		}
 	}
 }
@@ -209,7 +391,87 @@ bool DoCrawl(unsigned minRadius, unsigned maxRadius, tl::function_ref<bool(Displ
 	return true;
 }
 
-void DoLighting(Point position, int nRadius, int lnum)
+namespace {
+
+struct CrawlIndexTable {
+	int16_t indices[2 * MaxCrawlIndexRadius + 1][2 * MaxCrawlIndexRadius + 1];
+	int16_t ringStarts[MaxCrawlIndexRadius + 2];
+
+	CrawlIndexTable()
+	{
+		std::fill(&indices[0][0], &indices[0][0] + sizeof(indices) / sizeof(indices[0][0]), -1);
+		int16_t index = 0;
+		for (int radius = 0; radius <= MaxCrawlIndexRadius; radius++) {
+			ringStarts[radius] = index;
+			DoCrawl(radius, [&](Displacement displacement) {
+				int16_t &entry = indices[displacement.deltaX + MaxCrawlIndexRadius][displacement.deltaY + MaxCrawlIndexRadius];
+				if (entry == -1)
+					entry = index;
+				index++;
+				return true;
+			});
+		}
+		ringStarts[MaxCrawlIndexRadius + 1] = index;
+	}
+};
+
+const CrawlIndexTable &GetCrawlIndexTable()
+{
+	static const CrawlIndexTable Table;
+	return Table;
+}
+
+} // namespace
+
+int GetCrawlIndex(Displacement displacement)
+{
+	if (std::abs(displacement.deltaX) > MaxCrawlIndexRadius || std::abs(displacement.deltaY) > MaxCrawlIndexRadius)
+		return -1;
+	return GetCrawlIndexTable().indices[displacement.deltaX + MaxCrawlIndexRadius][displacement.deltaY + MaxCrawlIndexRadius];
+}
+
+int GetCrawlRingStart(unsigned radius)
+{
+	return GetCrawlIndexTable().ringStarts[std::min<unsigned>(radius, MaxCrawlIndexRadius + 1)];
+}
+
+namespace {
+
+/**
+ * @brief Darkens the tiles around a light that isn't near the edge of the map, a column at a time.
+ */
+void ApplyLightStamp(Point position, int nRadius, int offset, const Rectangle &area)
+{
+	char(&lights)[MAXDUNX][MAXDUNY] = LoadingMapObjects ? dPreLight : dLight;
+	const uint8_t *radius = lightradius[nRadius];
+
+	const int minX = std::max(-LightStampRadius, area.position.x - position.x);
+	const int maxX = std::min(LightStampRadius, area.position.x + area.size.width - 1 - position.x);
+	const int minY = std::max(-LightStampRadius, area.position.y - position.y);
+	const int maxY = std::min(LightStampRadius, area.position.y + area.size.height - 1 - position.y);
+	const int count = maxY - minY + 1;
+
+	for (int x = minX; x <= maxX; x++) {
+		const uint8_t *blocks = &lightstamps[offset][x + LightStampRadius][minY + LightStampRadius];
+		char values[LightStampSize];
+		for (int i = 0; i < count; i++)
+			values[i] = blocks[i] == NoLightBlock ? std::numeric_limits<char>::max() : static_cast<char>(radius[blocks[i]]);
+
+		// Kept separate from the lookups so that it's vectorized.
+		char *column = &lights[position.x + x][position.y + minY];
+		for (int i = 0; i < count; i++)
+			column[i] = std::min(column[i], values[i]);
+	}
+}
+
+/**
+ * @brief Darkens the tiles within the given area that the light reaches.
+ *
+ * Lights only ever lower the light level of a tile, so the result doesn't depend on the order the lights are applied in.
+ *
+ * @param useStamp Lights away from the edge of the map are applied through lightstamps unless this is false
+ */
+void ApplyLight(Point position, int nRadius, int lnum, const Rectangle &area, bool useStamp = true)
 {
 	int xoff = 0;
 	int yoff = 0;
@@ -252,7 +514,7 @@ void DoLighting(Point position, int nRadius, int lnum)
 		maxY = MAXDUNY - position.y;
 	}
 
-	if (InDungeonBounds(position)) {
+	if (InDungeonBounds(position) && area.contains(position)) {
 		if (IsNoneOf(leveltype, DTYPE_NEST, DTYPE_CRYPT)) {
 			SetLight(position, 0);
 		} else if (GetLight(position) > lightradius[nRadius][0]) {
@@ -260,6 +522,11 @@ void DoLighting(Point position, int nRadius, int lnum)
 		}
 	}
 
+	if (useStamp && minX == 15 && maxX == 15 && minY == 15 && maxY == 15) {
+		ApplyLightStamp(position, nRadius, xoff + 8 * yoff, area);
+		return;
+	}
+
 	for (int i = 0; i < 4; i++) {
 		int mult = xoff + 8 * yoff;
 		int yBound = i > 0 && i < 3 ? maxY : minY;
@@ -271,7 +538,7 @@ void DoLighting(Point position, int nRadius, int lnum)
 					continue;
 				Point temp = position + (Displacement { x, y }).Rotate(-i);
 				int8_t v = lightradius[nRadius][radiusBlock];
-				if (!InDungeonBounds(temp))
+				if (!InDungeonBounds(temp) || !area.contains(temp))
 					continue;
 				if (v < GetLight(temp))
 					SetLight(temp, v);
@@ -281,6 +548,13 @@ void DoLighting(Point position, int nRadius, int lnum)
 	}
 }
 
+} // namespace
+
+void DoLighting(Point position, int nRadius, int lnum)
+{
+	ApplyLight(position, nRadius, lnum, { { 0, 0 }, Size { MAXDUNX, MAXDUNY } });
+}
+
 void DoUnVision(Point position, int nRadius)
 {
 	nRadius++;
@@ -297,9 +571,18 @@ void DoUnVision(Point position, int nRadius)
 	}
 }
 
-void DoVision(Point position, int radius, MapExplorationType doAutomap, bool visible)
+namespace {
+
+/**
+ * @brief Calls visitTile with every tile that can be seen from the position, after the position itself.
+ *
+ * The second argument is the transparency value of the tile, 0 for tiles that block the light.
+ * Tiles can be visited more than once.
+ */
+template <typename F>
+void CrawlVision(Point position, int radius, F &&visitTile)
 {
-	DoVisionFlags(position, doAutomap, visible);
+	visitTile(position, 0);
 
 	static const Displacement factors[] = { { 1, 1 }, { -1, 1 }, { 1, -1 }, { -1, -1 } };
 	for (auto factor : factors) {
@@ -320,21 +603,109 @@ void DoVision(Point position, int radius, MapExplorationType doAutomap, bool vis
 				if (!tileOK)
 					break;
 
-				DoVisionFlags(crawl, doAutomap, visible);
-
-				if (blockerFlag)
+				if (blockerFlag) {
+					visitTile(crawl, 0);
 					break;
+				}
 
-				int8_t trans = dTransVal[crawl.x][crawl.y];
-				if (trans != 0)
-					TransList[trans] = true;
+				visitTile(crawl, dTransVal[crawl.x][crawl.y]);
 			}
 		}
 	}
 }
 
+struct VisibleTile {
+	uint8_t x;
+	uint8_t y;
+	int8_t trans;
+	/** @brief Whether more than one ray reached the tile. The automap is only updated from the second visit on. */
+	bool repeated;
+};
+
+/** @brief The tiles that were visible from a position, valid until the layout of the level changes. */
+struct VisionCacheEntry {
+	Point position;
+	int radius;
+	uint32_t layoutVersion = 0;
+	uint32_t lastUsed = 0;
+	std::vector<VisibleTile> tiles;
+};
+
+/** @brief Enough for every player and golem, plus a few of the positions they were at recently. */
+std::array<VisionCacheEntry, 16> VisionCache;
+uint32_t VisionCacheClock;
+/** @brief Incremented whenever dPiece changes, 0 is never used so that new entries are never valid. */
+uint32_t VisionLayoutVersion = 1;
+
+const std::vector<VisibleTile> &GetVisibleTiles(Point position, int radius)
+{
+	VisionCacheClock++;
+	VisionCacheEntry *oldest = &VisionCache[0];
+	for (VisionCacheEntry &entry : VisionCache) {
+		if (entry.layoutVersion == VisionLayoutVersion && entry.position == position && entry.radius == radius) {
+			entry.lastUsed = VisionCacheClock;
+			return entry.tiles;
+		}
+		if (entry.layoutVersion != VisionLayoutVersion || entry.lastUsed < oldest->lastUsed)
+			oldest = &entry;
+	}
+
+	VisionCacheEntry &entry = *oldest;
+	entry.position = position;
+	entry.radius = radius;
+	entry.layoutVersion = VisionLayoutVersion;
+	entry.lastUsed = VisionCacheClock;
+	entry.tiles.clear();
+
+	// The rays overlap a lot, so every tile is stored once. Holds the index of the tile plus one.
+	static uint16_t visited[MAXDUNX][MAXDUNY];
+	CrawlVision(position, radius, [&entry](Point tile, int8_t trans) {
+		uint16_t &index = visited[tile.x][tile.y];
+		if (index != 0) {
+			entry.tiles[index - 1].repeated = true;
+			return;
+		}
+		entry.tiles.push_back({ static_cast<uint8_t>(tile.x), static_cast<uint8_t>(tile.y), trans, false });
+		index = static_cast<uint16_t>(entry.tiles.size());
+	});
+	for (const VisibleTile &tile : entry.tiles)
+		visited[tile.x][tile.y] = 0;
+
+	return entry.tiles;
+}
+
+void DoCachedVision(Point position, int radius, MapExplorationType doAutomap, bool visible)
+{
+	for (const VisibleTile &tile : GetVisibleTiles(position, radius)) {
+		DoVisionFlags({ tile.x, tile.y }, doAutomap, visible);
+		if (tile.repeated)
+			DoVisionFlags({ tile.x, tile.y }, doAutomap, visible);
+		if (tile.trans != 0)
+			TransList[tile.trans] = true;
+	}
+}
+
+} // namespace
+
+void DoVision(Point position, int radius, MapExplorationType doAutomap, bool visible)
+{
+	CrawlVision(position, radius, [&](Point tile, int8_t trans) {
+		DoVisionFlags(tile, doAutomap, visible);
+		if (trans != 0)
+			TransList[trans] = true;
+	});
+}
+
+void InvalidateVisionCache()
+{
+	VisionLayoutVersion++;
+	if (VisionLayoutVersion == 0)
+		VisionLayoutVersion = 1;
+}
+
 void MakeLightTable()
 {
+	LightTablesVersion++;
 	uint8_t *tbl = LightTables.data();
 	int shade = 0;
 	int lights = 15;
@@ -480,42 +851,7 @@ void MakeLightTable()
 		*tbl++ = 0;
 	}
 
-	for (int j = 0; j < 16; j++) {
-		for (int i = 0; i < 128; i++) {
-			if (i > (j + 1) * 8) {
-				lightradius[j][i] = 15;
-			} else {
-				double fs = (double)15 * i / ((double)8 * (j + 1));
-				lightradius[j][i] = static_cast<uint8_t>(fs + 0.5);
-			}
-		}
-	}
-
-	if (IsAnyOf(leveltype, DTYPE_NEST, DTYPE_CRYPT)) {
-		for (int j = 0; j < 16; j++) {
-			double fa = (sqrt((double)(16 - j))) / 128;
-			fa *= fa;
-			for (int i = 0; i < 128; i++) {
-				lightradius[15 - j][i] = 15 - static_cast<uint8_t>(fa * (double)((128 - i) * (128 - i)));
-				if (lightradius[15 - j][i] > 15)
-					lightradius[15 - j][i] = 0;
-				lightradius[15 - j][i] = lightradius[15 - j][i] - static_cast<uint8_t>((15 - j) / 2);
-				if (lightradius[15 - j][i] > 15)
-					lightradius[15 - j][i] = 0;
-			}
-		}
-	}
-	for (int j = 0; j < 8; j++) {
-		for (int i = 0; i < 8; i++) {
-			for (int k = 0; k < 16; k++) {
-				for (int l = 0; l < 16; l++) {
-					int a = (8 * l - j);
-					int b = (8 * k - i);
-					lightblock[j * 8 + i][k][l] = static_cast<uint8_t>(sqrt(a * a + b * b));
-				}
-			}
-		}
-	}
+	MakeLightRadiusTables();
 }
 
 #ifdef _DEBUG
@@ -559,6 +895,12 @@ int AddLight(Point position, int r)
 	lid = NO_LIGHT;
 
 	if (ActiveLightCount < MAXLIGHTS) {
+		for (int i = ActiveLightCount; i < MAXLIGHTS; i++) {
+			if (ActiveLights[i] < MAXSAVEDLIGHTS) {
+				std::swap(ActiveLights[i], ActiveLights[ActiveLightCount]);
+				break;
+			}
+		}
 		lid = ActiveLights[ActiveLightCount++];
 		Light &light = Lights[lid];
 		light.position.tile = position;
@@ -566,6 +908,7 @@ int AddLight(Point position, int r)
 		light.position.offset = { 0, 0 };
 		light._ldel = false;
 		light._lunflag = false;
+		light.isNew = true;
 		UpdateLighting = true;
 	}
 
@@ -589,9 +932,7 @@ void ChangeLightRadius(int i, int r)
 	}
 
 	Light &light = Lights[i];
-	light._lunflag = true;
-	light.position.old = light.position.tile;
-	light.oldRadius = light._lradius;
+	MarkLightMoved(light);
 	light._lradius = r;
 	UpdateLighting = true;
 }
@@ -603,9 +944,7 @@ void ChangeLightXY(int i, Point position)
 	}
 
 	Light &light = Lights[i];
-	light._lunflag = true;
-	light.position.old = light.position.tile;
-	light.oldRadius = light._lradius;
+	MarkLightMoved(light);
 	light.position.tile = position;
 	UpdateLighting = true;
 }
@@ -617,9 +956,7 @@ void ChangeLightOffset(int i, Displacement offset)
 	}
 
 	Light &light = Lights[i];
-	light._lunflag = true;
-	light.position.old = light.position.tile;
-	light.oldRadius = light._lradius;
+	MarkLightMoved(light);
 	light.position.offset = offset;
 	UpdateLighting = true;
 }
@@ -631,9 +968,7 @@ void ChangeLight(int i, Point position, int r)
 	}
 
 	Light &light = Lights[i];
-	light._lunflag = true;
-	light.position.old = light.position.tile;
-	light.oldRadius = light._lradius;
+	MarkLightMoved(light);
 	light.position.tile = position;
 	light._lradius = r;
 	UpdateLighting = true;
@@ -641,27 +976,56 @@ void ChangeLight(int i, Point position, int r)
 
 void ProcessLightList()
 {
+	DVL_PERF_FUNCTION();
+
 	if (DisableLighting) {
 		return;
 	}
 
+	bool deferred = false;
 	if (UpdateLighting) {
+		// Only the areas that removed or moved lights used to reach are recomputed from the lights that overlap them,
+		// every other tile keeps its light level. New and moved lights are then applied to their whole area.
+		DirtyLightAreas dirtyAreas;
+		bool applied[MAXLIGHTS] = {};
 		for (int i = 0; i < ActiveLightCount; i++) {
-			Light &light = Lights[ActiveLights[i]];
+			const int j = ActiveLights[i];
+			Light &light = Lights[j];
 			if (light._ldel) {
-				DoUnLight(light.position.tile.x, light.position.tile.y, light._lradius);
+				dirtyAreas.Add(GetLightArea(light.position.tile));
 			}
 			if (light._lunflag) {
-				DoUnLight(light.position.old.x, light.position.old.y, light.oldRadius);
-				light._lunflag = false;
+				dirtyAreas.Add(GetLightArea(light.position.old));
 			}
+			applied[j] = !light._ldel && !light._lunflag && !light.isNew;
 		}
+		for (size_t k = 0; k < dirtyAreas.count; k++) {
+			const Rectangle &area = dirtyAreas.areas[k];
+			ResetLightArea(area);
+			for (int i = 0; i < ActiveLightCount; i++) {
+				int j = ActiveLights[i];
+				Light &light = Lights[j];
+				if (applied[j] && AreasOverlap(area, GetLightArea(light.position.tile)) && !IsLightCovered(j, applied)) {
+					ApplyLight(light.position.tile, light._lradius, j, area);
+				}
+			}
+		}
+		const int budget = GetLightBudget();
+		int stamps = 0;
 		for (int i = 0; i < ActiveLightCount; i++) {
 			int j = ActiveLights[i];
 			Light &light = Lights[j];
-			if (!light._ldel) {
+			if (!light._ldel && (light._lunflag || light.isNew) && !IsLightCovered(j, applied)) {
+				if (stamps >= budget && j != MyPlayer->_plid) {
+					deferred = true;
+					continue;
+				}
 				DoLighting(light.position.tile, light._lradius, j);
+				applied[j] = true;
+				stamps++;
 			}
+			light._lunflag = false;
+			light.isNew = false;
 		}
 		int i = 0;
 		while (i < ActiveLightCount) {
@@ -674,7 +1038,7 @@ void ProcessLightList()
 		}
 	}
 
-	UpdateLighting = false;
+	UpdateLighting = deferred;
 }
 
 void SavePreLighting()
@@ -745,6 +1109,8 @@ void ChangeVisionXY(int id, Point position)
 
 void ProcessVisionList()
 {
+	DVL_PERF_FUNCTION();
+
 	if (!dovision)
 		return;
 
@@ -779,7 +1145,7 @@ void ProcessVisionList()
 				break;
 			}
 		}
-		DoVision(
+		DoCachedVision(
 		    vision.position.tile,
 		    vision._lradius,
 		    doautomap,
@@ -810,6 +1176,7 @@ void lighting_color_cycling()
 		return;
 	}
 
+	LightTablesVersion++;
 	uint8_t *tbl = LightTables.data();
 
 	for (int j = 0; j < 16; j++) {
@@ -824,4 +1191,16 @@ void lighting_color_cycling()
 	}
 }
 
+#ifdef BUILD_TESTING
+void TestLightingMakeRadiusTables()
+{
+	MakeLightRadiusTables();
+}
+
+void TestLightingApplyLightPerTile(Point position, int nRadius, int lnum)
+{
+	ApplyLight(position, nRadius, lnum, { { 0, 0 }, Size { MAXDUNX, MAXDUNY } }, false);
+}
+#endif
+
 } // namespace devilution
@@ -19,7 +19,9 @@
 
 namespace devilution {
 
-#define MAXLIGHTS 32
+#define MAXLIGHTS 128
+/** Lights with an id below this are kept in save games, they are handed out first. */
+#define MAXSAVEDLIGHTS 32
 #define MAXVISION 32
 /** 16 light levels + infravision + stone curse + red for pause/death screen */
 #define LIGHTSIZE (19 * 256)
@@ -41,6 +43,8 @@ struct Light {
 	bool _lunflag;
 	int oldRadius;
 	bool _lflags;
+	/** Added since the lights were last processed, so it isn't part of dLight yet. */
+	bool isNew;
 };
 
 extern Light VisionList[MAXVISION];
@@ -51,12 +55,18 @@ extern uint8_t ActiveLights[MAXLIGHTS];
 extern int ActiveLightCount;
 constexpr char LightsMax = 15;
 extern std::array<uint8_t, LIGHTSIZE> LightTables;
+/** @brief Incremented whenever the contents of `LightTables` change, including on every level load. */
+extern uint32_t LightTablesVersion;
 extern bool DisableLighting;
 extern bool UpdateLighting;
 
 void DoLighting(Point position, int nRadius, int Lnum);
 void DoUnVision(Point position, int nRadius);
 void DoVision(Point position, int radius, MapExplorationType doAutomap, bool visible);
+/**
+ * @brief Forgets the tiles that were visible from the vision sources, must be called whenever dPiece changes.
+ */
+void InvalidateVisionCache();
 void MakeLightTable();
 #ifdef _DEBUG
 void ToggleLighting();
@@ -106,6 +116,23 @@ constexpr int MaxCrawlRadius = 18;
 bool DoCrawl(unsigned radius, tl::function_ref<bool(Displacement)> function);
 bool DoCrawl(unsigned minRadius, unsigned maxRadius, tl::function_ref<bool(Displacement)> function);
 
+/** @brief Largest radius GetCrawlIndex knows about, the same as the limit of FindClosestValidPosition. */
+constexpr int MaxCrawlIndexRadius = 50;
+
+/**
+ * @brief Returns the position of the displacement in the order Crawl(0, MaxCrawlIndexRadius) visits it, -1 if it doesn't.
+ *
+ * Lets callers that already know the tiles they are interested in sort them the way a crawl would find them.
+ */
+int GetCrawlIndex(Displacement displacement);
+
+/**
+ * @brief Returns the crawl index of the first displacement with the given radius, a radius of MaxCrawlIndexRadius + 1 gives the total.
+ *
+ * Crawl(minRadius, maxRadius) visits the indices from GetCrawlRingStart(minRadius) up to but excluding GetCrawlRingStart(maxRadius + 1).
+ */
+int GetCrawlRingStart(unsigned radius);
+
 template <typename F>
 auto Crawl(unsigned radius, F function) -> invoke_result_t<decltype(function), Displacement>
 {
@@ -5,10 +5,10 @@
  */
 #include "loadsave.h"
 
+#include <algorithm>
 #include <climits>
 #include <cstring>
 #include <numeric>
-#include <unordered_map>
 
 #include <SDL.h>
 #include <fmt/compile.h>
@@ -33,6 +33,8 @@
 #include "stores.h"
 #include "utils/endian.hpp"
 #include "utils/language.h"
+#include "utils/static_flat_map.hpp"
+#include "utils/str_cat.hpp"
 
 namespace devilution {
 
@@ -43,6 +45,12 @@ namespace {
 
 constexpr size_t MaxMissilesForSaveGame = 125;
 
+/** @brief Lights beyond MAXSAVEDLIGHTS aren't saved, whatever had one of them is loaded without a light. */
+int GetSavedLightId(int lid)
+{
+	return lid < MAXSAVEDLIGHTS ? lid : NO_LIGHT;
+}
+
 uint8_t giNumberQuests;
 uint8_t giNumberOfSmithPremiumItems;
 
@@ -95,6 +103,30 @@ class LoadHelper {
 		return value;
 	}
 
+	template <class T, typename Cell, size_t Width, size_t Height, typename Decode>
+	void NextGrid(Cell (&grid)[Width][Height], Decode decode)
+	{
+		constexpr size_t Size = sizeof(T) * Width * Height;
+		if (!IsValid(Size)) {
+			for (auto &column : grid) {
+				for (Cell &cell : column)
+					cell = decode(0);
+			}
+			return;
+		}
+
+		const byte *data = &m_buffer_[m_cur_];
+		for (size_t y = 0; y < Height; y++) {
+			for (size_t x = 0; x < Width; x++) {
+				T value;
+				memcpy(&value, data, sizeof(T));
+				data += sizeof(T);
+				grid[x][y] = decode(value);
+			}
+		}
+		m_cur_ += Size;
+	}
+
 public:
 	LoadHelper(std::optional<MpqArchive> archive, const char *szFileName)
 	{
@@ -104,6 +136,11 @@ public:
 			m_buffer_ = nullptr;
 	}
 
+	LoadHelper(MpqArchive &archive, const char *szFileName)
+	    : m_buffer_(ReadArchive(archive, szFileName, &m_size_))
+	{
+	}
+
 	bool IsValid(size_t size = 1)
 	{
 		return m_buffer_ != nullptr
@@ -160,18 +197,70 @@ public:
 	{
 		return Next<uint32_t>() != 0;
 	}
+
+	/**
+	 * @brief Reads a grid that is saved one row after the other into an array indexed by [x][y].
+	 *
+	 * The size of the file is checked once for the whole grid instead of for every cell.
+	 * @param convert Turns the value read for a cell into the one that is stored in the grid.
+	 */
+	template <class T, typename Cell, size_t Width, size_t Height, typename Convert>
+	void NextGridLE(Cell (&grid)[Width][Height], Convert convert)
+	{
+		NextGrid<T>(grid, [&](T value) { return convert(SwapLE(value)); });
+	}
+
+	template <class T, typename Cell, size_t Width, size_t Height>
+	void NextGridLE(Cell (&grid)[Width][Height])
+	{
+		NextGrid<T>(grid, [](T value) { return static_cast<Cell>(SwapLE(value)); });
+	}
+
+	template <class T, typename Cell, size_t Width, size_t Height>
+	void NextGridBE(Cell (&grid)[Width][Height])
+	{
+		NextGrid<T>(grid, [](T value) { return static_cast<Cell>(SwapBE(value)); });
+	}
 };
 
 class SaveHelper {
-	MpqWriter &m_mpqWriter;
+	MpqWriter *m_mpqWriter = nullptr;
+	PendingSaveFiles *m_pendingFiles = nullptr;
 	const char *m_szFileName_;
 	std::unique_ptr<byte[]> m_buffer_;
 	size_t m_cur_ = 0;
 	size_t m_capacity_;
 
+	template <class T, typename Cell, size_t Width, size_t Height, typename Encode>
+	void WriteGrid(const Cell (&grid)[Width][Height], Encode encode)
+	{
+		constexpr size_t Size = sizeof(T) * Width * Height;
+		if (!IsValid(Size))
+			return;
+
+		byte *data = &m_buffer_[m_cur_];
+		for (size_t y = 0; y < Height; y++) {
+			for (size_t x = 0; x < Width; x++) {
+				const T value = encode(grid[x][y]);
+				memcpy(data, &value, sizeof(T));
+				data += sizeof(T);
+			}
+		}
+		m_cur_ += Size;
+	}
+
 public:
 	SaveHelper(MpqWriter &mpqWriter, const char *szFileName, size_t bufferLen)
-	    : m_mpqWriter(mpqWriter)
+	    : m_mpqWriter(&mpqWriter)
+	    , m_szFileName_(szFileName)
+	    , m_buffer_(new byte[codec_get_encoded_len(bufferLen)])
+	    , m_capacity_(bufferLen)
+	{
+	}
+
+	/** @brief Hands the file over to pendingFiles instead of encoding and writing it. */
+	SaveHelper(PendingSaveFiles &pendingFiles, const char *szFileName, size_t bufferLen)
+	    : m_pendingFiles(&pendingFiles)
 	    , m_szFileName_(szFileName)
 	    , m_buffer_(new byte[codec_get_encoded_len(bufferLen)])
 	    , m_capacity_(bufferLen)
@@ -219,12 +308,39 @@ public:
 		WriteBytes(&value, sizeof(value));
 	}
 
+	/**
+	 * @brief Writes a grid indexed by [x][y] one row after the other, the counterpart of LoadHelper::NextGridLE.
+	 * @param convert Turns the value of a cell into the one that is saved.
+	 */
+	template <class T, typename Cell, size_t Width, size_t Height, typename Convert>
+	void WriteGridLE(const Cell (&grid)[Width][Height], Convert convert)
+	{
+		WriteGrid<T>(grid, [&](const Cell &cell) { return SwapLE(static_cast<T>(convert(cell))); });
+	}
+
+	template <class T, typename Cell, size_t Width, size_t Height>
+	void WriteGridLE(const Cell (&grid)[Width][Height])
+	{
+		WriteGrid<T>(grid, [](const Cell &cell) { return SwapLE(static_cast<T>(cell)); });
+	}
+
+	template <class T, typename Cell, size_t Width, size_t Height>
+	void WriteGridBE(const Cell (&grid)[Width][Height])
+	{
+		WriteGrid<T>(grid, [](const Cell &cell) { return SwapBE(static_cast<T>(cell)); });
+	}
+
 	~SaveHelper()
 	{
+		if (m_pendingFiles != nullptr) {
+			m_pendingFiles->push_back({ m_szFileName_, std::move(m_buffer_), m_cur_ });
+			return;
+		}
+
 		const auto encodedLen = codec_get_encoded_len(m_cur_);
 		const char *const password = pfile_get_password();
 		codec_encode(m_buffer_.get(), m_cur_, encodedLen, password);
-		m_mpqWriter.WriteFile(m_szFileName_, m_buffer_.get(), encodedLen);
+		m_mpqWriter->WriteFile(m_szFileName_, m_buffer_.get(), encodedLen);
 	}
 };
 
@@ -881,6 +997,8 @@ void LoadLighting(LoadHelper *file, Light *pLight)
 	pLight->position.offset.deltaX = file->NextLE<int32_t>();
 	pLight->position.offset.deltaY = file->NextLE<int32_t>();
 	pLight->_lflags = file->NextBool32();
+	// dLight is restored from the save as well, so the light is already part of it.
+	pLight->isNew = false;
 }
 
 void LoadPortal(LoadHelper *file, int i)
@@ -1125,7 +1243,7 @@ void SavePlayer(SaveHelper &file, const Player &player)
 	// write _pAnimWidth2 for vanilla compatibility
 	file.WriteLE<int32_t>(CalculateWidth2(animWidth));
 	file.Skip<uint32_t>(); // Skip _peflag
-	file.WriteLE<int32_t>(player._plid);
+	file.WriteLE<int32_t>(GetSavedLightId(player._plid));
 	file.WriteLE<int32_t>(player._pvid);
 
 	file.WriteLE<int32_t>(player._pSpell);
@@ -1406,7 +1524,7 @@ void SaveMonster(SaveHelper *file, Monster &monster)
 	file->WriteLE<uint8_t>(static_cast<std::uint8_t>(monster.leaderRelation));
 	file->WriteLE<uint8_t>(monster.packSize);
 	// vanilla compatibility
-	if (monster.lightId == NO_LIGHT)
+	if (GetSavedLightId(monster.lightId) == NO_LIGHT)
 		file->WriteLE<int8_t>(0);
 	else
 		file->WriteLE<int8_t>(monster.lightId);
@@ -1451,7 +1569,7 @@ void SaveMissile(SaveHelper *file, const Missile &missile)
 	file->WriteLE<int32_t>(missile._midam);
 	file->WriteLE<uint32_t>(missile._miHitFlag ? 1 : 0);
 	file->WriteLE<int32_t>(missile._midist);
-	file->WriteLE<int32_t>(missile._mlid);
+	file->WriteLE<int32_t>(GetSavedLightId(missile._mlid));
 	file->WriteLE<int32_t>(missile._mirnd);
 	file->WriteLE<int32_t>(missile.var1);
 	file->WriteLE<int32_t>(missile.var2);
@@ -1527,7 +1645,7 @@ void SaveObject(SaveHelper &file, const Object &object)
 	file.WriteLE<uint32_t>(object._oPreFlag ? 1 : 0);
 	file.WriteLE<uint32_t>(object._oTrapFlag ? 1 : 0);
 	file.WriteLE<uint32_t>(object._oDoorFlag ? 1 : 0);
-	file.WriteLE<int32_t>(object._olid);
+	file.WriteLE<int32_t>(GetSavedLightId(object._olid));
 	file.WriteLE<uint32_t>(object._oRndSeed);
 	file.WriteLE<int32_t>(object._oVar1);
 	file.WriteLE<int32_t>(object._oVar2);
@@ -1600,13 +1718,16 @@ void SavePortal(SaveHelper *file, int i)
 	file->WriteLE<uint32_t>(pPortal->setlvl ? 1 : 0);
 }
 
+/** @brief Maps from runtime item indexes plus one to the position in the save file, 0 is no item. */
+using DroppedItemIndexes = StaticFlatMap<uint8_t, uint8_t, MAXITEMS + 1>;
+
 /**
  * @brief Saves items on the current dungeon floor
  * @param file interface to the save file
  * @return a map converting from runtime item indexes to the relative position in the save file, used by SaveDroppedItemLocations
  * @see SaveDroppedItemLocations
  */
-std::unordered_map<uint8_t, uint8_t> SaveDroppedItems(SaveHelper &file)
+DroppedItemIndexes SaveDroppedItems(SaveHelper &file)
 {
 	// Vanilla Diablo/Hellfire initialise the ActiveItems and AvailableItems arrays based on saved data, so write valid values for compatibility
 	for (uint8_t i = 0; i < MAXITEMS; i++)
@@ -1614,7 +1735,8 @@ std::unordered_map<uint8_t, uint8_t> SaveDroppedItems(SaveHelper &file)
 	for (uint8_t i = 0; i < MAXITEMS; i++)
 		file.WriteLE<uint8_t>((i + ActiveItemCount) % MAXITEMS);
 
-	std::unordered_map<uint8_t, uint8_t> itemIndexes = { { 0, 0 } };
+	DroppedItemIndexes itemIndexes;
+	itemIndexes[0] = 0;
 	for (uint8_t i = 0; i < ActiveItemCount; i++) {
 		itemIndexes[ActiveItems[i] + 1] = i + 1;
 		SaveItem(file, Items[ActiveItems[i]]);
@@ -1627,7 +1749,7 @@ std::unordered_map<uint8_t, uint8_t> SaveDroppedItems(SaveHelper &file)
  * @param file interface to the save file
  * @param itemIndexes a map converting from runtime item indexes to the relative position in the save file
  */
-void SaveDroppedItemLocations(SaveHelper &file, const std::unordered_map<uint8_t, uint8_t> &itemIndexes)
+void SaveDroppedItemLocations(SaveHelper &file, const DroppedItemIndexes &itemIndexes)
 {
 	for (int j = 0; j < MAXDUNY; j++) {
 		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
@@ -1637,18 +1759,18 @@ void SaveDroppedItemLocations(SaveHelper &file, const std::unordered_map<uint8_t
 
 constexpr uint32_t VersionAdditionalMissiles = 0;
 
-void SaveAdditionalMissiles(MpqWriter &saveWriter)
+void SaveAdditionalMissiles(PendingSaveFiles &saveFiles)
 {
 	constexpr size_t BytesWrittenBySaveMissile = 180;
 	uint32_t missileCountAdditional = (Missiles.size() > MaxMissilesForSaveGame) ? static_cast<uint32_t>(Missiles.size() - MaxMissilesForSaveGame) : 0;
-	SaveHelper file(saveWriter, "additionalMissiles", sizeof(uint32_t) + sizeof(uint32_t) + (missileCountAdditional * BytesWrittenBySaveMissile));
+	SaveHelper file(saveFiles, "additionalMissiles", sizeof(uint32_t) + sizeof(uint32_t) + (missileCountAdditional * BytesWrittenBySaveMissile));
 
 	file.WriteLE<uint32_t>(VersionAdditionalMissiles);
 	file.WriteLE<uint32_t>(missileCountAdditional);
 
 	if (missileCountAdditional > 0) {
 		auto it = Missiles.cbegin();
-		// std::list::const_iterator doesn't provide operator+() :/ using std::advance to get past the missiles we've already saved
+		// PooledList::const_iterator doesn't provide operator+() :/ using std::advance to get past the missiles we've already saved
 		std::advance(it, MaxMissilesForSaveGame);
 		for (; it != Missiles.cend(); it++) {
 			SaveMissile(&file, *it);
@@ -1924,11 +2046,11 @@ void LoadHotkeys()
 	myPlayer._pRSplType = static_cast<spell_type>(file.NextLE<uint8_t>());
 }
 
-void SaveHotkeys(MpqWriter &saveWriter)
+void SaveHotkeys(PendingSaveFiles &saveFiles)
 {
 	Player &myPlayer = *MyPlayer;
 
-	SaveHelper file(saveWriter, "hotkeys", HotkeysSize());
+	SaveHelper file(saveFiles, "hotkeys", HotkeysSize());
 
 	// Write the number of spell hotkeys
 	file.WriteLE<uint8_t>(static_cast<uint8_t>(NumHotkeys));
@@ -1961,45 +2083,209 @@ void LoadHeroItems(Player &player)
 	gbIsHellfireSaveGame = gbIsHellfire;
 }
 
-constexpr uint8_t StashVersion = 0;
+/**
+ * Version 0 stores the whole stash in one file, version 1 only stores the list of pages and every page is a
+ * separate file with its own items. That way saving only has to write the pages that changed.
+ *
+ * Version 1 uses another file name for the list of pages than version 0. Older builds don't find a stash they can't
+ * read, so they start with an empty one and their saves don't replace the pages.
+ */
+constexpr uint8_t StashVersion = 1;
 
-void LoadStash()
-{
-	const char *filename;
-	if (!gbIsMultiplayer)
-		filename = "spstashitems";
-	else
-		filename = "mpstashitems";
+namespace {
 
-	Stash = {};
+/** @brief Set while the archive holds a version 0 stash file that SaveStash still has to remove. */
+bool HasLegacyStashFile;
 
-	LoadHelper file(OpenStashArchive(), filename);
-	if (!file.IsValid())
-		return;
+const char *GetLegacyStashFileName()
+{
+	return gbIsMultiplayer ? "mpstashitems" : "spstashitems";
+}
 
-	auto version = file.NextLE<uint8_t>();
-	if (version > StashVersion)
-		return;
+const char *GetStashFileName()
+{
+	return gbIsMultiplayer ? "mpstashindex" : "spstashindex";
+}
 
-	Stash.gold = file.NextLE<uint32_t>();
+std::string GetStashPageFileName(unsigned page)
+{
+	return StrCat(gbIsMultiplayer ? "mp" : "sp", "stashpage", page);
+}
 
+/**
+ * @brief Loads a version 0 stash file on top of the pages that are already loaded.
+ *
+ * The pages keep their numbers if the stash is empty so far, otherwise they are moved to the first unused pages.
+ */
+void LoadStashV0(LoadHelper &file)
+{
+	const bool keepPageNumbers = Stash.stashGrids.empty();
+	const size_t firstItem = Stash.stashList.size();
+	Stash.gold += file.NextLE<uint32_t>();
+
+	unsigned unusedPage = 0;
 	auto pages = file.NextLE<uint32_t>();
 	for (unsigned i = 0; i < pages; i++) {
-		auto page = file.NextLE<uint32_t>();
+		unsigned page = file.NextLE<uint32_t>();
+		if (!keepPageNumbers) {
+			while (Stash.stashGrids.count(unusedPage) != 0)
+				unusedPage++;
+			page = unusedPage;
+		}
 		for (auto &row : Stash.stashGrids[page]) {
 			for (uint16_t &cell : row) {
-				cell = file.NextLE<uint16_t>();
+				const uint16_t item = file.NextLE<uint16_t>();
+				cell = item != 0 ? static_cast<uint16_t>(firstItem + item) : 0;
 			}
 		}
+		// The next save switches to the paged format, so all pages have to be written
+		Stash.MarkPageDirty(page);
 	}
 
 	auto itemCount = file.NextLE<uint32_t>();
-	Stash.stashList.resize(itemCount);
+	Stash.stashList.resize(firstItem + itemCount);
 	for (unsigned i = 0; i < itemCount; i++) {
-		LoadItemData(file, Stash.stashList[i]);
+		LoadItemData(file, Stash.stashList[firstItem + i]);
+	}
+}
+
+/**
+ * @brief Loads a page file, the page's item indices are converted to indices into the combined stash list.
+ */
+void LoadStashPage(MpqArchive &archive, unsigned page)
+{
+	LoadHelper file(archive, GetStashPageFileName(page).c_str());
+	if (!file.IsValid())
+		return;
+
+	const size_t firstItem = Stash.stashList.size();
+	const auto itemCount = file.NextLE<uint32_t>();
+	for (auto &row : Stash.stashGrids[page]) {
+		for (uint16_t &cell : row) {
+			const uint16_t pageItem = file.NextLE<uint16_t>();
+			cell = pageItem != 0 && pageItem <= itemCount ? static_cast<uint16_t>(firstItem + pageItem) : 0;
+		}
+	}
+
+	Stash.stashList.resize(firstItem + itemCount);
+	for (unsigned i = 0; i < itemCount; i++) {
+		LoadItemData(file, Stash.stashList[firstItem + i]);
+	}
+}
+
+void SaveStashPage(PendingSaveFiles &saveFiles, unsigned page, const StashStruct::StashGrid &grid)
+{
+	// Items are numbered in the order they are first found on the page
+	std::vector<uint16_t> pageItems;
+	StashStruct::StashGrid pageGrid {};
+	for (size_t x = 0; x < grid.size(); x++) {
+		for (size_t y = 0; y < grid[x].size(); y++) {
+			const uint16_t cell = grid[x][y];
+			if (cell == 0)
+				continue;
+			auto it = std::find(pageItems.begin(), pageItems.end(), cell);
+			if (it == pageItems.end())
+				it = pageItems.insert(pageItems.end(), cell);
+			pageGrid[x][y] = static_cast<uint16_t>(it - pageItems.begin() + 1);
+		}
+	}
+
+	if (pageItems.empty()) {
+		saveFiles.push_back({ GetStashPageFileName(page), nullptr, 0 });
+		return;
+	}
+
+	const int itemSize = (gbIsHellfire ? HellfireItemSaveSize : DiabloItemSaveSize);
+	const std::string filename = GetStashPageFileName(page);
+	SaveHelper file(
+	    saveFiles,
+	    filename.c_str(),
+	    sizeof(uint32_t)
+	        + 10 * 10 * sizeof(uint16_t)
+	        + itemSize * pageItems.size());
+
+	file.WriteLE<uint32_t>(static_cast<uint32_t>(pageItems.size()));
+	for (const auto &row : pageGrid) {
+		for (uint16_t cell : row) {
+			file.WriteLE<uint16_t>(cell);
+		}
+	}
+	for (uint16_t cell : pageItems) {
+		SaveItem(file, Stash.stashList[cell - 1]);
+	}
+}
+
+void SaveStashIndex(PendingSaveFiles &saveFiles)
+{
+	SaveHelper file(
+	    saveFiles,
+	    GetStashFileName(),
+	    sizeof(uint8_t)
+	        + sizeof(uint32_t)
+	        + sizeof(uint32_t)
+	        + sizeof(uint32_t) * Stash.stashGrids.size()
+	        + sizeof(uint32_t));
+
+	file.WriteLE<uint8_t>(StashVersion);
+
+	file.WriteLE<uint32_t>(Stash.gold);
+
+	std::vector<unsigned> pagesToSave;
+	for (const auto &stashPage : Stash.stashGrids) {
+		if (std::any_of(stashPage.second.cbegin(), stashPage.second.cend(), [](const auto &row) {
+			    return std::any_of(row.cbegin(), row.cend(), [](auto cell) {
+				    return cell > 0;
+			    });
+		    })) {
+			// found a page that contains at least one item
+			pagesToSave.push_back(stashPage.first);
+		}
+	};
+
+	// Current stash size is 100 pages. Will definitely fit in a 32 bit value.
+	file.WriteLE<uint32_t>(static_cast<uint32_t>(pagesToSave.size()));
+	for (const auto &page : pagesToSave) {
+		file.WriteLE<uint32_t>(page);
+	}
+
+	file.WriteLE<uint32_t>(static_cast<uint32_t>(Stash.GetPage()));
+}
+
+} // namespace
+
+void LoadStash()
+{
+	Stash = {};
+
+	std::optional<MpqArchive> archive = OpenStashArchive();
+	if (!archive)
+		return;
+
+	unsigned currentPage = 0;
+	LoadHelper file(*archive, GetStashFileName());
+	if (file.IsValid()) {
+		auto version = file.NextLE<uint8_t>();
+		if (version != StashVersion)
+			return;
+
+		Stash.gold = file.NextLE<uint32_t>();
+		auto pages = file.NextLE<uint32_t>();
+		for (unsigned i = 0; i < pages; i++) {
+			LoadStashPage(*archive, file.NextLE<uint32_t>());
+		}
+		currentPage = file.NextLE<uint32_t>();
 	}
 
-	Stash.SetPage(file.NextLE<uint32_t>());
+	// Either the stash predates the paged format, or an older build stashed items in the meantime.
+	LoadHelper legacyFile(*archive, GetLegacyStashFileName());
+	HasLegacyStashFile = legacyFile.IsValid();
+	if (HasLegacyStashFile && legacyFile.NextLE<uint8_t>() == 0) {
+		LoadStashV0(legacyFile);
+		if (!file.IsValid())
+			currentPage = legacyFile.NextLE<uint32_t>();
+	}
+
+	Stash.SetPage(currentPage);
 }
 
 void RemoveEmptyInventory(Player &player)
@@ -2014,7 +2300,7 @@ void RemoveEmptyInventory(Player &player)
 
 void LoadGame(bool firstflag)
 {
-	FreeGameMem();
+	FreeLevelMem();
 
 	LoadHelper file(OpenSaveArchive(gSaveNumber), "game");
 	if (!file.IsValid())
@@ -2084,6 +2370,7 @@ void LoadGame(bool firstflag)
 	ViewPosition = { viewX, viewY };
 	ActiveMonsterCount = tmpNummonsters;
 	ActiveObjectCount = tmpNobjects;
+	InvalidateTickingObjects();
 
 	for (int &monstkill : MonsterKillCounts)
 		monstkill = file.NextBE<int32_t>();
@@ -2095,6 +2382,7 @@ void LoadGame(bool firstflag)
 			LoadMonster(&file, Monsters[ActiveMonsters[i]]);
 		for (size_t i = 0; i < ActiveMonsterCount; i++)
 			SyncPackSize(Monsters[ActiveMonsters[i]]);
+		RebuildLeashedMinions();
 		// Skip ActiveMissiles
 		file.Skip<int8_t>(MaxMissilesForSaveGame);
 		// Skip AvailableMissiles
@@ -2112,8 +2400,10 @@ void LoadGame(bool firstflag)
 
 		ActiveLightCount = file.NextBE<int32_t>();
 
-		for (uint8_t &lightId : ActiveLights)
-			lightId = file.NextLE<uint8_t>();
+		for (int i = 0; i < MAXSAVEDLIGHTS; i++)
+			ActiveLights[i] = file.NextLE<uint8_t>();
+		for (int i = MAXSAVEDLIGHTS; i < MAXLIGHTS; i++)
+			ActiveLights[i] = i;
 		for (int i = 0; i < ActiveLightCount; i++)
 			LoadLighting(&file, &Lights[ActiveLights[i]]);
 
@@ -2131,47 +2421,20 @@ void LoadGame(bool firstflag)
 	for (bool &uniqueItemFlag : UniqueItemFlags)
 		uniqueItemFlag = file.NextBool8();
 
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			dLight[i][j] = file.NextLE<int8_t>();
-	}
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			dFlags[i][j] = static_cast<DungeonFlag>(file.NextLE<uint8_t>()) & DungeonFlag::LoadedFlags;
-	}
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			dPlayer[i][j] = file.NextLE<int8_t>();
-	}
+	file.NextGridLE<int8_t>(dLight);
+	file.NextGridLE<uint8_t>(dFlags, [](uint8_t flags) { return static_cast<DungeonFlag>(flags) & DungeonFlag::LoadedFlags; });
+	file.NextGridLE<int8_t>(dPlayer);
 
 	// skip dItem indexes, this gets populated in LoadDroppedItems
 	file.Skip<uint8_t>(MAXDUNX * MAXDUNY);
 
 	if (leveltype != DTYPE_TOWN) {
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dMonster[i][j] = file.NextBE<int32_t>();
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dCorpse[i][j] = file.NextLE<int8_t>();
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dObject[i][j] = file.NextLE<int8_t>();
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dLight[i][j] = file.NextLE<int8_t>();
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dPreLight[i][j] = file.NextLE<int8_t>();
-		}
-		for (int j = 0; j < DMAXY; j++) {
-			for (int i = 0; i < DMAXX; i++) // NOLINT(modernize-loop-convert)
-				AutomapView[i][j] = file.NextLE<uint8_t>();
-		}
+		file.NextGridBE<int32_t>(dMonster);
+		file.NextGridLE<int8_t>(dCorpse);
+		file.NextGridLE<int8_t>(dObject);
+		file.NextGridLE<int8_t>(dLight);
+		file.NextGridLE<int8_t>(dPreLight);
+		file.NextGridLE<uint8_t>(AutomapView);
 		file.Skip(MAXDUNX * MAXDUNY); // dMissile
 	}
 
@@ -2213,10 +2476,10 @@ void LoadGame(bool firstflag)
 	gbIsHellfireSaveGame = gbIsHellfire;
 }
 
-void SaveHeroItems(MpqWriter &saveWriter, Player &player)
+void SaveHeroItems(PendingSaveFiles &saveFiles, Player &player)
 {
 	size_t itemCount = static_cast<size_t>(NUM_INVLOC) + InventoryGridCells + MaxBeltItems;
-	SaveHelper file(saveWriter, "heroitems", itemCount * (gbIsHellfire ? HellfireItemSaveSize : DiabloItemSaveSize) + sizeof(uint8_t));
+	SaveHelper file(saveFiles, "heroitems", itemCount * (gbIsHellfire ? HellfireItemSaveSize : DiabloItemSaveSize) + sizeof(uint8_t));
 
 	file.WriteLE<uint8_t>(gbIsHellfire ? 1 : 0);
 
@@ -2228,66 +2491,29 @@ void SaveHeroItems(MpqWriter &saveWriter, Player &player)
 		SaveItem(file, item);
 }
 
-void SaveStash(MpqWriter &stashWriter)
+void SaveStash(PendingSaveFiles &saveFiles)
 {
-	const char *filename;
-	if (!gbIsMultiplayer)
-		filename = "spstashitems";
-	else
-		filename = "mpstashitems";
-
-	const int itemSize = (gbIsHellfire ? HellfireItemSaveSize : DiabloItemSaveSize);
-
-	SaveHelper file(
-	    stashWriter,
-	    filename,
-	    sizeof(uint8_t)
-	        + sizeof(uint32_t)
-	        + sizeof(uint32_t)
-	        + (sizeof(uint32_t) + 10 * 10 * sizeof(uint16_t)) * Stash.stashGrids.size()
-	        + sizeof(uint32_t)
-	        + itemSize * Stash.stashList.size()
-	        + sizeof(uint32_t));
-
-	file.WriteLE<uint8_t>(StashVersion);
-
-	file.WriteLE<uint32_t>(Stash.gold);
-
-	std::vector<unsigned> pagesToSave;
-	for (const auto &stashPage : Stash.stashGrids) {
-		if (std::any_of(stashPage.second.cbegin(), stashPage.second.cend(), [](const auto &row) {
-			    return std::any_of(row.cbegin(), row.cend(), [](auto cell) {
-				    return cell > 0;
-			    });
-		    })) {
-			// found a page that contains at least one item
-			pagesToSave.push_back(stashPage.first);
-		}
-	};
-
-	// Current stash size is 100 pages. Will definitely fit in a 32 bit value.
-	file.WriteLE<uint32_t>(static_cast<uint32_t>(pagesToSave.size()));
-	for (const auto &page : pagesToSave) {
-		file.WriteLE<uint32_t>(page);
-		for (const auto &row : Stash.stashGrids[page]) {
-			for (uint16_t cell : row) {
-				file.WriteLE<uint16_t>(cell);
-			}
-		}
+	// The page files are written first, so that the list of pages never refers to a page that doesn't exist yet
+	for (unsigned page : Stash.dirtyPages) {
+		auto pageIt = Stash.stashGrids.find(page);
+		if (pageIt != Stash.stashGrids.end())
+			SaveStashPage(saveFiles, page, pageIt->second);
+		else
+			saveFiles.push_back({ GetStashPageFileName(page), nullptr, 0 });
 	}
 
-	// 100 pages of 100 items is still only 10 000, as with the page count will definitely fit in 32 bits even in the worst case.
-	file.WriteLE<uint32_t>(static_cast<uint32_t>(Stash.stashList.size()));
-	for (const Item &item : Stash.stashList) {
-		SaveItem(file, item);
-	}
+	SaveStashIndex(saveFiles);
 
-	file.WriteLE<uint32_t>(static_cast<uint32_t>(Stash.GetPage()));
+	// Its items are part of the pages now.
+	if (HasLegacyStashFile) {
+		saveFiles.push_back({ GetLegacyStashFileName(), nullptr, 0 });
+		HasLegacyStashFile = false;
+	}
 }
 
-void SaveGameData(MpqWriter &saveWriter)
+void SaveGameData(PendingSaveFiles &saveFiles)
 {
-	SaveHelper file(saveWriter, "game", 320 * 1024);
+	SaveHelper file(saveFiles, "game", 320 * 1024);
 
 	if (gbIsSpawn && !gbIsHellfire)
 		file.WriteLE<uint32_t>(LoadLE32("SHAR"));
@@ -2372,12 +2598,24 @@ void SaveGameData(MpqWriter &saveWriter)
 		for (int i = 0; i < ActiveObjectCount; i++)
 			SaveObject(file, Objects[ActiveObjects[i]]);
 
-		file.WriteBE<int32_t>(ActiveLightCount);
+		// Only the saved lights are written, in the same order: the active ones first, then the free ones.
+		uint8_t savedLights[MAXSAVEDLIGHTS];
+		int savedLightCount = 0;
+		for (int i = 0; i < ActiveLightCount; i++) {
+			if (ActiveLights[i] < MAXSAVEDLIGHTS)
+				savedLights[savedLightCount++] = ActiveLights[i];
+		}
+		int freeLightIndex = savedLightCount;
+		for (int i = ActiveLightCount; i < MAXLIGHTS; i++) {
+			if (ActiveLights[i] < MAXSAVEDLIGHTS)
+				savedLights[freeLightIndex++] = ActiveLights[i];
+		}
+		file.WriteBE<int32_t>(savedLightCount);
 
-		for (uint8_t lightId : ActiveLights)
+		for (uint8_t lightId : savedLights)
 			file.WriteLE<uint8_t>(lightId);
-		for (int i = 0; i < ActiveLightCount; i++)
-			SaveLighting(&file, &Lights[ActiveLights[i]]);
+		for (int i = 0; i < savedLightCount; i++)
+			SaveLighting(&file, &Lights[savedLights[i]]);
 
 		file.WriteBE<int32_t>(VisionId);
 		file.WriteBE<int32_t>(VisionCount);
@@ -2391,46 +2629,19 @@ void SaveGameData(MpqWriter &saveWriter)
 	for (bool uniqueItemFlag : UniqueItemFlags)
 		file.WriteLE<uint8_t>(uniqueItemFlag ? 1 : 0);
 
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			file.WriteLE<int8_t>(dLight[i][j]);
-	}
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			file.WriteLE<uint8_t>(static_cast<uint8_t>(dFlags[i][j] & DungeonFlag::SavedFlags));
-	}
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			file.WriteLE<int8_t>(dPlayer[i][j]);
-	}
+	file.WriteGridLE<int8_t>(dLight);
+	file.WriteGridLE<uint8_t>(dFlags, [](DungeonFlag flags) { return static_cast<uint8_t>(flags & DungeonFlag::SavedFlags); });
+	file.WriteGridLE<int8_t>(dPlayer);
 
 	SaveDroppedItemLocations(file, itemIndexes);
 
 	if (leveltype != DTYPE_TOWN) {
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteBE<int32_t>(dMonster[i][j]);
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<int8_t>(dCorpse[i][j]);
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<int8_t>(dObject[i][j]);
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<int8_t>(dLight[i][j]);
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<int8_t>(dPreLight[i][j]);
-		}
-		for (int j = 0; j < DMAXY; j++) {
-			for (int i = 0; i < DMAXX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<uint8_t>(AutomapView[i][j]);
-		}
+		file.WriteGridBE<int32_t>(dMonster);
+		file.WriteGridLE<int8_t>(dCorpse);
+		file.WriteGridLE<int8_t>(dObject);
+		file.WriteGridLE<int8_t>(dLight);
+		file.WriteGridLE<int8_t>(dPreLight);
+		file.WriteGridLE<uint8_t>(AutomapView);
 		for (int j = 0; j < MAXDUNY; j++) {
 			for (int i = 0; i < MAXDUNX; i++)                                 // NOLINT(modernize-loop-convert)
 				file.WriteLE<int8_t>(TileContainsMissile({ i, j }) ? -1 : 0); // For backwards compatability
@@ -2446,7 +2657,21 @@ void SaveGameData(MpqWriter &saveWriter)
 	file.WriteLE<uint8_t>(AutomapActive ? 1 : 0);
 	file.WriteBE<int32_t>(AutoMapScale);
 
-	SaveAdditionalMissiles(saveWriter);
+	SaveAdditionalMissiles(saveFiles);
+}
+
+void WritePendingSaveFiles(MpqWriter &saveWriter, PendingSaveFiles &saveFiles, const char *password)
+{
+	for (PendingSaveFile &saveFile : saveFiles) {
+		if (saveFile.data == nullptr) {
+			saveWriter.RemoveHashEntry(saveFile.name.c_str());
+			continue;
+		}
+		const auto encodedLen = codec_get_encoded_len(saveFile.size);
+		codec_encode(saveFile.data.get(), saveFile.size, encodedLen, password);
+		saveWriter.WriteFile(saveFile.name.c_str(), saveFile.data.get(), encodedLen);
+	}
+	saveFiles.clear();
 }
 
 void SaveGame()
@@ -2470,10 +2695,7 @@ void SaveLevel(MpqWriter &saveWriter)
 	SaveHelper file(saveWriter, szName, 256 * 1024);
 
 	if (leveltype != DTYPE_TOWN) {
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<int8_t>(dCorpse[i][j]);
-		}
+		file.WriteGridLE<int8_t>(dCorpse);
 	}
 
 	file.WriteBE<int32_t>(ActiveMonsterCount);
@@ -2495,33 +2717,15 @@ void SaveLevel(MpqWriter &saveWriter)
 
 	auto itemIndexes = SaveDroppedItems(file);
 
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			file.WriteLE<uint8_t>(static_cast<uint8_t>(dFlags[i][j] & DungeonFlag::SavedFlags));
-	}
+	file.WriteGridLE<uint8_t>(dFlags, [](DungeonFlag flags) { return static_cast<uint8_t>(flags & DungeonFlag::SavedFlags); });
 	SaveDroppedItemLocations(file, itemIndexes);
 
 	if (leveltype != DTYPE_TOWN) {
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteBE<int32_t>(dMonster[i][j]);
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<int8_t>(dObject[i][j]);
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<int8_t>(dLight[i][j]);
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<int8_t>(dPreLight[i][j]);
-		}
-		for (int j = 0; j < DMAXY; j++) {
-			for (int i = 0; i < DMAXX; i++) // NOLINT(modernize-loop-convert)
-				file.WriteLE<uint8_t>(AutomapView[i][j]);
-		}
+		file.WriteGridBE<int32_t>(dMonster);
+		file.WriteGridLE<int8_t>(dObject);
+		file.WriteGridLE<int8_t>(dLight);
+		file.WriteGridLE<int8_t>(dPreLight);
+		file.WriteGridLE<uint8_t>(AutomapView);
 	}
 
 	if (!setlevel)
@@ -2542,22 +2746,21 @@ void LoadLevel()
 		app_fatal(_("Unable to open save file archive"));
 
 	if (leveltype != DTYPE_TOWN) {
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dCorpse[i][j] = file.NextLE<int8_t>();
-		}
+		file.NextGridLE<int8_t>(dCorpse);
 		SyncUniqDead();
 	}
 
 	ActiveMonsterCount = file.NextBE<int32_t>();
 	auto savedItemCount = file.NextBE<uint32_t>();
 	ActiveObjectCount = file.NextBE<int32_t>();
+	InvalidateTickingObjects();
 
 	if (leveltype != DTYPE_TOWN) {
 		for (int &monsterId : ActiveMonsters)
 			monsterId = file.NextBE<int32_t>();
 		for (size_t i = 0; i < ActiveMonsterCount; i++)
 			LoadMonster(&file, Monsters[ActiveMonsters[i]]);
+		RebuildLeashedMinions();
 		for (int &objectId : ActiveObjects)
 			objectId = file.NextLE<int8_t>();
 		for (int &objectId : AvailableObjects)
@@ -2572,37 +2775,19 @@ void LoadLevel()
 
 	LoadDroppedItems(file, savedItemCount);
 
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-			dFlags[i][j] = static_cast<DungeonFlag>(file.NextLE<uint8_t>()) & DungeonFlag::LoadedFlags;
-	}
+	file.NextGridLE<uint8_t>(dFlags, [](uint8_t flags) { return static_cast<DungeonFlag>(flags) & DungeonFlag::LoadedFlags; });
 
 	// skip dItem indexes, this gets populated in LoadDroppedItems
 	file.Skip<uint8_t>(MAXDUNX * MAXDUNY);
 
 	if (leveltype != DTYPE_TOWN) {
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dMonster[i][j] = file.NextBE<int32_t>();
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dObject[i][j] = file.NextLE<int8_t>();
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dLight[i][j] = file.NextLE<int8_t>();
-		}
-		for (int j = 0; j < MAXDUNY; j++) {
-			for (int i = 0; i < MAXDUNX; i++) // NOLINT(modernize-loop-convert)
-				dPreLight[i][j] = file.NextLE<int8_t>();
-		}
-		for (int j = 0; j < DMAXY; j++) {
-			for (int i = 0; i < DMAXX; i++) { // NOLINT(modernize-loop-convert)
-				const auto automapView = static_cast<MapExplorationType>(file.NextLE<uint8_t>());
-				AutomapView[i][j] = automapView == MAP_EXP_OLD ? MAP_EXP_SELF : automapView;
-			}
-		}
+		file.NextGridBE<int32_t>(dMonster);
+		file.NextGridLE<int8_t>(dObject);
+		file.NextGridLE<int8_t>(dLight);
+		file.NextGridLE<int8_t>(dPreLight);
+		file.NextGridLE<uint8_t>(AutomapView, [](uint8_t automapView) -> uint8_t {
+			return automapView == MAP_EXP_OLD ? MAP_EXP_SELF : automapView;
+		});
 	}
 
 	if (!gbSkipSync) {
@@ -2613,7 +2798,7 @@ void LoadLevel()
 	}
 
 	for (Player &player : Players) {
-		if (player.plractive && player.isOnActiveLevel())
+		if (player.plractive && player.isOnActiveLevel() && player._plid != NO_LIGHT)
 			Lights[player._plid]._lunflag = true;
 	}
 }
@@ -5,12 +5,31 @@
  */
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "mpq/mpq_writer.hpp"
 #include "player.h"
 #include "utils/attributes.h"
+#include "utils/stdcompat/cstddef.hpp"
 
 namespace devilution {
 
+/** @brief A save file that was serialized but not encoded and written yet. */
+struct PendingSaveFile {
+	std::string name;
+	/**
+	 * @brief Unencoded contents, the buffer has room for the encoded ones (see codec_get_encoded_len).
+	 *
+	 * nullptr if the file is to be removed from the archive instead.
+	 */
+	std::unique_ptr<byte[]> data;
+	size_t size;
+};
+
+using PendingSaveFiles = std::vector<PendingSaveFile>;
+
 extern DVL_API_FOR_TEST bool gbIsHellfireSaveGame;
 extern DVL_API_FOR_TEST uint8_t giNumberOfLevels;
 
@@ -33,14 +52,20 @@ void RemoveEmptyInventory(Player &player);
  * @param firstflag Can be set to false if we are simply reloading the current game
  */
 void LoadGame(bool firstflag);
-void SaveHotkeys(MpqWriter &saveWriter);
-void SaveHeroItems(MpqWriter &saveWriter, Player &player);
-void SaveGameData(MpqWriter &saveWriter);
+void SaveHotkeys(PendingSaveFiles &saveFiles);
+void SaveHeroItems(PendingSaveFiles &saveFiles, Player &player);
+void SaveGameData(PendingSaveFiles &saveFiles);
+/**
+ * @brief Encodes the files with the given password and writes them into the archive, files without data are removed.
+ *
+ * Only touches the files and the writer, so it can run on a different thread than the one that serialized them.
+ */
+void WritePendingSaveFiles(MpqWriter &saveWriter, PendingSaveFiles &saveFiles, const char *password);
 void SaveGame();
 void SaveLevel(MpqWriter &saveWriter);
 void LoadLevel();
 void ConvertLevels(MpqWriter &saveWriter);
 void LoadStash();
-void SaveStash(MpqWriter &stashWriter);
+void SaveStash(PendingSaveFiles &saveFiles);
 
 } // namespace devilution
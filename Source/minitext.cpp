@@ -3,6 +3,8 @@
  *
  * Implementation of scrolling dialog text.
  */
+#include <array>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -14,6 +16,7 @@
 #include "engine/load_cel.hpp"
 #include "engine/render/cl2_render.hpp"
 #include "engine/render/text_render.hpp"
+#include "engine/surface.hpp"
 #include "textdat.h"
 #include "utils/language.h"
 #include "utils/stdcompat/optional.hpp"
@@ -35,11 +38,70 @@ OptionalOwnedCelSprite pTextBoxCels;
 /** Pixels for a line of text and the empty space under it. */
 const int LineHeight = 38;
 
+/** Width of the text, the strip is a line height wider and taller on each side for glyphs that stick out. */
+const int TextWidth = 543;
+
 std::vector<std::string> TextLines;
 
+/** @brief The whole text drawn once, the pixels around the glyphs are set to a color the glyphs don't use. */
+struct TextStrip {
+	OwnedSurface surface;
+	uint8_t transparentColor;
+};
+
+std::optional<TextStrip> CurrentTextStrip;
+
+OwnedSurface RenderTextLines(uint8_t background)
+{
+	OwnedSurface strip { TextWidth + 2 * LineHeight, static_cast<int>(TextLines.size() + 2) * LineHeight };
+	for (int y = 0; y < strip.h(); y++)
+		memset(strip.at(0, y), background, strip.w());
+	for (size_t i = 0; i < TextLines.size(); i++) {
+		if (!TextLines[i].empty())
+			DrawString(strip, TextLines[i], { { LineHeight, static_cast<int>(i + 1) * LineHeight }, { TextWidth, LineHeight } }, UiFlags::FontSize30 | UiFlags::ColorGold);
+	}
+	return strip;
+}
+
+/**
+ * @brief Draws the text into a strip that scrolling only has to blit
+ *
+ * The text is drawn over two different backgrounds, the pixels that differ are background. Any color that no glyph
+ * pixel uses can then stand in for the background.
+ */
+void RenderTextStrip()
+{
+	OwnedSurface strip = RenderTextLines(0);
+	const OwnedSurface other = RenderTextLines(1);
+
+	std::array<bool, 256> used {};
+	for (int y = 0; y < strip.h(); y++) {
+		const uint8_t *pixels = strip.at(0, y);
+		const uint8_t *otherPixels = other.at(0, y);
+		for (int x = 0; x < strip.w(); x++) {
+			if (pixels[x] == otherPixels[x])
+				used[pixels[x]] = true;
+		}
+	}
+	uint8_t transparentColor = 0;
+	while (transparentColor < 255 && used[transparentColor])
+		transparentColor++;
+
+	for (int y = 0; y < strip.h(); y++) {
+		uint8_t *pixels = strip.at(0, y);
+		const uint8_t *otherPixels = other.at(0, y);
+		for (int x = 0; x < strip.w(); x++) {
+			if (pixels[x] != otherPixels[x])
+				pixels[x] = transparentColor;
+		}
+	}
+	CurrentTextStrip.emplace(TextStrip { std::move(strip), transparentColor });
+}
+
 void LoadText(string_view text)
 {
 	TextLines.clear();
+	CurrentTextStrip = std::nullopt;
 
 	const std::string paragraphs = WordWrapString(text, 543, GameFont30);
 
@@ -95,26 +157,15 @@ int CalculateTextPosition()
  */
 void DrawQTextContent(const Surface &out)
 {
-	int y = CalculateTextPosition();
-
-	const int sx = GetUIRectangle().position.x + 48;
-	const int sy = 0 - (y % LineHeight);
+	const int y = CalculateTextPosition();
 
-	const unsigned int skipLines = y / LineHeight;
+	if (!CurrentTextStrip)
+		RenderTextStrip();
+	const Surface &strip = CurrentTextStrip->surface;
 
-	for (int i = 0; i < 8; i++) {
-		const unsigned int lineNumber = skipLines + i;
-		if (lineNumber >= TextLines.size()) {
-			continue;
-		}
-
-		const std::string &line = TextLines[lineNumber];
-		if (line.empty()) {
-			continue;
-		}
-
-		DrawString(out, line, { { sx, sy + i * LineHeight }, { 543, LineHeight } }, UiFlags::FontSize30 | UiFlags::ColorGold);
-	}
+	// Line n of the text is at n * LineHeight - y, and after a line of padding in the strip.
+	const int sx = GetUIRectangle().position.x + 48;
+	out.BlitFromSkipColorIndex(strip, MakeSdlRect(0, 0, strip.w(), strip.h()), { sx - LineHeight, -y - LineHeight }, CurrentTextStrip->transparentColor);
 }
 
 } // namespace
@@ -122,6 +173,7 @@ void DrawQTextContent(const Surface &out)
 void FreeQuestText()
 {
 	pTextBoxCels = std::nullopt;
+	CurrentTextStrip = std::nullopt;
 }
 
 void InitQuestText()
@@ -18,6 +18,7 @@
 #endif
 #include "cursor.h"
 #include "engine/demomode.h"
+#include "engine/input_latency.hpp"
 #include "engine/rectangle.hpp"
 #include "hwcursor.hpp"
 #include "inv.h"
@@ -108,6 +109,50 @@ bool FalseAvail(const char *name, int value)
 	return true;
 }
 
+#ifndef USE_SDL1
+/**
+ * @brief Whether the next event only updates the state that the given event reports, so the given one can be dropped.
+ */
+bool IsSupersededBy(const SDL_Event &event, const SDL_Event &next)
+{
+	if (next.type != event.type)
+		return false;
+	switch (event.type) {
+	case SDL_MOUSEMOTION:
+		return next.motion.which == event.motion.which && next.motion.state == event.motion.state;
+	case SDL_CONTROLLERAXISMOTION:
+		return next.caxis.which == event.caxis.which && next.caxis.axis == event.caxis.axis;
+	case SDL_JOYAXISMOTION:
+		return next.jaxis.which == event.jaxis.which && next.jaxis.axis == event.jaxis.axis;
+	default:
+		return false;
+	}
+}
+
+/**
+ * @brief Replaces a motion event with the newest of the same motion events directly after it in the queue.
+ *
+ * A 1000 Hz mouse or an analog stick queues many of these per frame, only where they end up matters.
+ * Events are only merged while nothing else is queued between them, so the order of everything else is kept.
+ */
+void CoalesceMotionEvents(SDL_Event &event)
+{
+	if (!IsAnyOf(event.type, SDL_MOUSEMOTION, SDL_CONTROLLERAXISMOTION, SDL_JOYAXISMOTION))
+		return;
+	SDL_Event next;
+	while (SDL_PeepEvents(&next, 1, SDL_PEEKEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) == 1 && IsSupersededBy(event, next)) {
+		if (SDL_PeepEvents(&next, 1, SDL_GETEVENT, next.type, next.type) != 1)
+			break;
+		UnlockControllerState(next);
+		if (event.type == SDL_MOUSEMOTION) {
+			next.motion.xrel += event.motion.xrel;
+			next.motion.yrel += event.motion.yrel;
+		}
+		event = next;
+	}
+}
+#endif
+
 /**
  * @brief Try to clean the inventory related cursor states.
  * @return True if it is safe to close the inventory
@@ -233,6 +278,11 @@ bool FetchMessage_Real(tagMSG *lpMsg)
 	if (PollEvent(&e) == 0) {
 		return false;
 	}
+#ifndef USE_SDL1
+	CoalesceMotionEvents(e);
+#endif
+	if (InputLatencyEnabled)
+		MarkInputReceived(e);
 
 	lpMsg->message = 0;
 	lpMsg->wParam = 0;
@@ -508,6 +558,8 @@ void PushMessage(const tagMSG *lpMsg)
 	assert(CurrentEventHandler != nullptr);
 
 	CurrentEventHandler(lpMsg->message, lpMsg->wParam, lpMsg->lParam);
+	if (InputLatencyEnabled)
+		MarkInputHandled();
 }
 
 void PostMessage(uint32_t type, uint32_t wParam, uint16_t lParam)
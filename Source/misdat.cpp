@@ -242,7 +242,7 @@ void MissileFileData::LoadGFX()
 		animData = LoadFileInMem(pathGenerator());
 		frameOffsets[0] = 0;
 	} else {
-		animData = MultiFileLoader<16> {}(animFAmt, pathGenerator, &frameOffsets[0]);
+		animData = MultiFileLoader<16> { GetAssetLoadingThreads() }(animFAmt, pathGenerator, &frameOffsets[0]);
 	}
 }
 
@@ -5,7 +5,10 @@
  */
 #include "missiles.h"
 
+#include <algorithm>
+#include <array>
 #include <climits>
+#include <cstdint>
 
 #include "control.h"
 #include "controls/plrctrls.h"
@@ -23,11 +26,12 @@
 #include "lighting.h"
 #include "monster.h"
 #include "spells.h"
+#include "utils/perf_scope.hpp"
 #include "utils/str_cat.hpp"
 
 namespace devilution {
 
-std::list<Missile> Missiles;
+PooledList<Missile> Missiles;
 bool MissilePreFlag;
 
 namespace {
@@ -77,14 +81,62 @@ bool CheckBlock(Point from, Point to)
 	return false;
 }
 
+/**
+ * @brief Calls the function for the tiles around the position that hold a monster, in the order Crawl(minRadius, maxRadius)
+ * would reach them, until it returns true.
+ *
+ * Reads dMonster directly instead of crawling, so that the tiles without a monster (nearly all of them) only cost a compare.
+ *
+ * @return The tile the function returned true for
+ */
+std::optional<Point> FindMonsterTileInCrawlOrder(Point position, unsigned minRadius, unsigned maxRadius, tl::function_ref<bool(Point)> function)
+{
+	struct MonsterTile {
+		int crawlIndex;
+		Point position;
+	};
+
+	const int firstIndex = GetCrawlRingStart(minRadius);
+	const int endIndex = GetCrawlRingStart(maxRadius + 1);
+	const int radius = static_cast<int>(maxRadius);
+
+	// Every monster is on at most one tile with a positive dMonster value.
+	std::array<MonsterTile, MaxMonsters> tiles;
+	size_t numTiles = 0;
+	for (int x = std::max(position.x - radius, 0); x <= std::min(position.x + radius, MAXDUNX - 1); x++) {
+		for (int y = std::max(position.y - radius, 0); y <= std::min(position.y + radius, MAXDUNY - 1); y++) {
+			if (dMonster[x][y] <= 0)
+				continue;
+			const int crawlIndex = GetCrawlIndex(Point { x, y } - position);
+			if (crawlIndex < firstIndex || crawlIndex >= endIndex)
+				continue;
+			if (numTiles == tiles.size()) {
+				// Only possible with a broken map, crawl instead of dropping any of the tiles.
+				return Crawl(minRadius, maxRadius, [&](Displacement displacement) -> std::optional<Point> {
+					const Point target = position + displacement;
+					if (InDungeonBounds(target) && dMonster[target.x][target.y] > 0 && function(target))
+						return target;
+					return {};
+				});
+			}
+			tiles[numTiles++] = { crawlIndex, { x, y } };
+		}
+	}
+
+	std::sort(tiles.begin(), tiles.begin() + numTiles, [](const MonsterTile &a, const MonsterTile &b) { return a.crawlIndex < b.crawlIndex; });
+	for (size_t i = 0; i < numTiles; i++) {
+		if (function(tiles[i].position))
+			return tiles[i].position;
+	}
+	return {};
+}
+
 Monster *FindClosest(Point source, int rad)
 {
-	std::optional<Point> monsterPosition = FindClosestValidPosition(
-	    [&source](Point target) {
-		    // search for a monster with clear line of sight
-		    return InDungeonBounds(target) && dMonster[target.x][target.y] > 0 && !CheckBlock(source, target);
-	    },
-	    source, 1, rad);
+	// search for a monster with clear line of sight
+	std::optional<Point> monsterPosition = FindMonsterTileInCrawlOrder(source, 1, rad, [&source](Point target) {
+		return !CheckBlock(source, target);
+	});
 
 	if (monsterPosition) {
 		int mid = dMonster[monsterPosition->x][monsterPosition->y];
@@ -450,6 +502,22 @@ void CheckMissileCol(Missile &missile, int minDamage, int maxDamage, bool isDama
 		PlaySfxLoc(MissilesData[missile._mitype].miSFX, missile.position.tile);
 }
 
+/**
+ * @brief Number of steps it takes a 16.16 fixed point coordinate to reach the next pixel.
+ */
+int StepsToNextPixel(int value, int step)
+{
+	if (step == 0)
+		return INT_MAX;
+	const int64_t pixel = value >> 16;
+	if (step > 0) {
+		const int64_t distance = (pixel + 1) * 65536 - value;
+		return static_cast<int>((distance + step - 1) / step);
+	}
+	const int64_t distance = value - (pixel * 65536 - 1);
+	return static_cast<int>((distance - step - 1) / -step);
+}
+
 void MoveMissileAndCheckMissileCol(Missile &missile, int mindam, int maxdam, bool ignoreStart, bool ifCollidesDontMoveToHitTile)
 {
 	Point prevTile = missile.position.tile;
@@ -476,8 +544,13 @@ void MoveMissileAndCheckMissileCol(Missile &missile, int mindam, int maxdam, boo
 		// Implementation note: If someone knows the correct math to calculate this without this step for step increase loop, I would really appreciate it.
 		auto incVelocity = missile.position.velocity * (0.01f / (float)(possibleVisitTiles - 1));
 		auto traveled = missile.position.traveled - missile.position.velocity;
+		int steps = 1;
 		do {
-			traveled += incVelocity;
+			traveled += incVelocity * steps;
+			// The tile only depends on the pixel position, so the steps that stay on the same pixel can be skipped.
+			steps = std::min(StepsToNextPixel(traveled.deltaX, incVelocity.deltaX), StepsToNextPixel(traveled.deltaY, incVelocity.deltaY));
+			if (steps == INT_MAX)
+				break;
 
 			// calculate in-between tile
 			int mx = traveled.deltaX >> 16;
@@ -1063,8 +1136,8 @@ void InitMissiles()
 	}
 
 	Missiles.clear();
-	for (int j = 0; j < MAXDUNY; j++) {
-		for (int i = 0; i < MAXDUNX; i++) { // NOLINT(modernize-loop-convert)
+	for (int i = 0; i < MAXDUNX; i++) { // NOLINT(modernize-loop-convert)
+		for (int j = 0; j < MAXDUNY; j++) {
 			dFlags[i][j] &= ~DungeonFlag::Missile;
 		}
 	}
@@ -3397,12 +3470,9 @@ void MI_Chain(Missile &missile)
 	Direction dir = GetDirection(position, dst);
 	AddMissile(position, dst, dir, MIS_LIGHTCTRL, TARGET_MONSTERS, id, 1, missile._mispllvl);
 	int rad = std::min<int>(missile._mispllvl + 3, MaxCrawlRadius);
-	Crawl(1, rad, [&](Displacement displacement) {
-		Point target = position + displacement;
-		if (InDungeonBounds(target) && dMonster[target.x][target.y] > 0) {
-			dir = GetDirection(position, target);
-			AddMissile(position, target, dir, MIS_LIGHTCTRL, TARGET_MONSTERS, id, 1, missile._mispllvl);
-		}
+	FindMonsterTileInCrawlOrder(position, 1, rad, [&](Point target) {
+		dir = GetDirection(position, target);
+		AddMissile(position, target, dir, MIS_LIGHTCTRL, TARGET_MONSTERS, id, 1, missile._mispllvl);
 		return false;
 	});
 	missile._mirange--;
@@ -3989,6 +4059,8 @@ void ProcessManaShield()
 
 void ProcessMissiles()
 {
+	DVL_PERF_FUNCTION();
+
 	for (auto &missile : Missiles) {
 		const auto &position = missile.position.tile;
 		if (InDungeonBounds(position)) {
@@ -6,7 +6,6 @@
 #pragma once
 
 #include <cstdint>
-#include <list>
 
 #include "engine.h"
 #include "engine/point.hpp"
@@ -14,6 +13,7 @@
 #include "monster.h"
 #include "player.h"
 #include "spelldat.h"
+#include "utils/pooled_list.hpp"
 
 namespace devilution {
 
@@ -168,7 +168,7 @@ struct Missile {
 	}
 };
 
-extern std::list<Missile> Missiles;
+extern PooledList<Missile> Missiles;
 extern bool MissilePreFlag;
 
 void GetDamageAmt(spell_id i, int *mind, int *maxd);
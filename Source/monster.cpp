@@ -7,7 +7,9 @@
 
 #include <algorithm>
 #include <array>
+#include <bitset>
 #include <climits>
+#include <vector>
 
 #include <fmt/compile.h>
 #include <fmt/format.h>
@@ -17,11 +19,13 @@
 #include "dead.h"
 #include "engine/cel_header.hpp"
 #include "engine/load_file.hpp"
+#include "engine/path.h"
 #include "engine/points_in_rectangle_range.hpp"
 #include "engine/random.hpp"
 #include "engine/render/cl2_render.hpp"
 #include "engine/world_tile.hpp"
 #include "init.h"
+#include "interfac.h"
 #include "levels/crypt.h"
 #include "levels/drlg_l4.h"
 #include "levels/themes.h"
@@ -35,7 +39,11 @@
 #include "storm/storm_net.hpp"
 #include "towners.h"
 #include "utils/file_name_generator.hpp"
+#include "utils/bitset2d.hpp"
 #include "utils/language.h"
+#include "utils/memory_budget.hpp"
+#include "utils/perf_scope.hpp"
+#include "utils/static_vector.hpp"
 #include "utils/stdcompat/string_view.hpp"
 #include "utils/str_cat.hpp"
 #include "utils/utf8.hpp"
@@ -69,6 +77,45 @@ size_t totalmonsters;
 int monstimgtot;
 int uniquetrans;
 
+static_assert(MaxMonsters <= UINT8_MAX + 1, "LeashedMinions stores monster ids as uint8_t");
+
+/**
+ * @brief Ids of the monsters that were leashed to each leader.
+ *
+ * Entries are added whenever a monster gets leashed but only dropped lazily, so users have to check that the
+ * monster is still leashed to the leader.
+ */
+std::array<std::vector<uint8_t>, MaxMonsters> LeashedMinions;
+
+void AddLeashedMinion(const Monster &minion)
+{
+	std::vector<uint8_t> &minions = LeashedMinions[minion.leader];
+	const auto minionId = static_cast<uint8_t>(minion.getId());
+	if (std::find(minions.begin(), minions.end(), minionId) == minions.end())
+		minions.push_back(minionId);
+}
+
+/** @brief The dungeon pieces of the level that block missiles as of MissileBlockingTilesVersion, saves LineClearMissile looking up dPiece and SOLData. */
+Bitset2d<MAXDUNX, MAXDUNY> MissileBlockingTiles;
+uint32_t MissileBlockingTilesVersion = 0;
+
+void UpdateMissileBlockingTiles()
+{
+	if (MissileBlockingTilesVersion == GetLayoutVersion())
+		return;
+	MissileBlockingTilesVersion = GetLayoutVersion();
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++)
+			MissileBlockingTiles.set(x, y, !PosOkMissile({ x, y }));
+	}
+}
+
+/** @brief Whether the tile holds the monster itself, as opposed to being cleared or only reserved for a move. */
+bool IsTileOfMonster(const Monster &monster, Point position)
+{
+	return dMonster[position.x][position.y] == static_cast<int>(monster.getId() + 1);
+}
+
 constexpr const std::array<_monster_id, 12> SkeletonTypes {
 	MT_WSKELAX,
 	MT_TSKELAX,
@@ -150,6 +197,69 @@ constexpr int MWVel[24][3] = {
 };
 /** Maps from monster action to monster animation letter. */
 constexpr char Animletter[7] = "nwahds";
+constexpr size_t MaxMonsterAnims = sizeof(Animletter) / sizeof(Animletter[0]) - 1;
+
+/** @brief Where the animations start in the buffer of a monster type, the buffer itself is owned by CMonster::animData. */
+struct MonsterGfxLayout {
+	std::array<uint32_t, MaxMonsterAnims> animOffsets;
+	size_t size;
+};
+
+/** @brief Layout of the graphics of each entry of LevelMonsterTypes. */
+MonsterGfxLayout LevelMonsterGfxLayouts[MaxLvlMTypes];
+
+/**
+ * @brief Graphics of a monster type that left the level, with the TRN of the type already applied.
+ *
+ * A monster type is on the level at most once, so its graphics are either used by one LevelMonsterTypes entry or
+ * kept here, never both.
+ */
+struct RetainedMonsterGfx {
+	_monster_id type;
+	std::unique_ptr<byte[]> animData;
+	MonsterGfxLayout layout;
+};
+
+/** @brief Sorted from the least to the most recently released. */
+std::vector<RetainedMonsterGfx> RetainedMonsterGfxs;
+
+/**
+ * @brief Moves the retained graphics of the monster type into the given entry.
+ * @return Whether the type had graphics retained
+ */
+bool TakeRetainedMonsterGfx(CMonster &monsterType, MonsterGfxLayout &layout)
+{
+	auto retained = std::find_if(RetainedMonsterGfxs.begin(), RetainedMonsterGfxs.end(), [&monsterType](const RetainedMonsterGfx &gfx) {
+		return gfx.type == monsterType.type;
+	});
+	if (retained == RetainedMonsterGfxs.end())
+		return false;
+	monsterType.animData = std::move(retained->animData);
+	layout = retained->layout;
+	RetainedMonsterGfxs.erase(retained);
+	return true;
+}
+
+void UpdateMonsterGfxUsage()
+{
+	const MonsterGfxStats stats = GetMonsterGfxStats();
+	SetMemoryUsage(MemoryTag::MonsterGraphics, stats.levelBytes + stats.retainedBytes);
+}
+
+/** @brief Frees the least recently released graphics until the rest fit in the budget. */
+void TrimRetainedMonsterGfx()
+{
+	size_t budget = GetMemoryBudget(MemoryTag::MonsterGraphics);
+	size_t kept = 0;
+	for (auto it = RetainedMonsterGfxs.rbegin(); it != RetainedMonsterGfxs.rend(); ++it) {
+		if (it->layout.size > budget)
+			break;
+		budget -= it->layout.size;
+		kept++;
+	}
+	RetainedMonsterGfxs.erase(RetainedMonsterGfxs.begin(), RetainedMonsterGfxs.end() - kept);
+	UpdateMonsterGfxUsage();
+}
 
 size_t GetNumAnims(const MonsterData &monsterData)
 {
@@ -170,6 +280,12 @@ void InitMonsterTRN(CMonster &monst)
 
 	std::replace(colorTranslations.begin(), colorTranslations.end(), 255, 0);
 
+	// Collect the sprites of every direction first, they don't share any frames and are translated in parallel.
+	struct SpriteToTranslate {
+		byte *sprite;
+		int numFrames;
+	};
+	StaticVector<SpriteToTranslate, MaxMonsterAnims * 8> sprites;
 	const size_t numAnims = GetNumAnims(*monst.data);
 	for (size_t i = 0; i < numAnims; i++) {
 		if (i == 1 && IsAnyOf(monst.type, MT_COUNSLR, MT_MAGISTR, MT_CABALIST, MT_ADVOCATE)) {
@@ -179,16 +295,26 @@ void InitMonsterTRN(CMonster &monst)
 		AnimStruct &anim = monst.anims[i];
 		if (IsDirectionalAnim(monst, i)) {
 			for (size_t i = 0; i < 8; i++) {
-				Cl2ApplyTrans(anim.celSpritesForDirections[i], colorTranslations, anim.frames);
+				sprites.emplace_back(SpriteToTranslate { anim.celSpritesForDirections[i], anim.frames });
 			}
 		} else {
 			byte *frames[8];
 			CelGetDirectionFrames(anim.celSpritesForDirections[0], frames);
 			for (byte *frame : frames) {
-				Cl2ApplyTrans(frame, colorTranslations, anim.frames);
+				sprites.emplace_back(SpriteToTranslate { frame, anim.frames });
 			}
 		}
 	}
+
+	const auto translate = [&](int i) {
+		Cl2ApplyTrans(sprites[i].sprite, colorTranslations, sprites[i].numFrames);
+	};
+	if (ThreadPool *threads = GetAssetLoadingThreads(); threads != nullptr) {
+		threads->ParallelFor(static_cast<int>(sprites.size()), translate);
+	} else {
+		for (size_t i = 0; i < sprites.size(); i++)
+			translate(static_cast<int>(i));
+	}
 }
 
 void InitMonster(Monster &monster, Direction rd, size_t typeIndex, Point position)
@@ -693,6 +819,26 @@ bool IsRanged(Monster &monster)
 	return IsAnyOf(monster.ai, AI_SKELBOW, AI_GOATBOW, AI_SUCC, AI_LAZHELP);
 }
 
+/**
+ * @brief The active monsters that are golems, in ActiveMonsters order. Berserked monsters are not part of it.
+ *
+ * Only valid while ProcessMonsters runs. Monsters are no longer deleted at that point and none of the monsters'
+ * actions can turn another monster into a golem, so the list can't go stale during the tick.
+ */
+StaticVector<int, MaxMonsters> ActiveGolems;
+bool ActiveGolemsValid = false;
+
+void UpdateActiveGolems()
+{
+	ActiveGolems.clear();
+	for (size_t i = 0; i < ActiveMonsterCount; i++) {
+		int monsterId = ActiveMonsters[i];
+		if ((Monsters[monsterId].flags & MFLAG_GOLEM) != 0)
+			ActiveGolems.emplace_back(monsterId);
+	}
+	ActiveGolemsValid = true;
+}
+
 void UpdateEnemy(Monster &monster)
 {
 	Point target;
@@ -719,9 +865,15 @@ void UpdateEnemy(Monster &monster)
 			}
 		}
 	}
-	for (size_t i = 0; i < ActiveMonsterCount; i++) {
-		int monsterId = ActiveMonsters[i];
+	// Monsters that are neither golems nor berserk only ever target golems, skip the rest before looking at them closely.
+	const bool targetsOnlyGolems = (monster.flags & (MFLAG_GOLEM | MFLAG_BERSERK)) == 0;
+	const bool useGolemList = targetsOnlyGolems && ActiveGolemsValid;
+	const size_t candidateCount = useGolemList ? ActiveGolems.size() : ActiveMonsterCount;
+	for (size_t i = 0; i < candidateCount; i++) {
+		int monsterId = useGolemList ? ActiveGolems[i] : ActiveMonsters[i];
 		auto &otherMonster = Monsters[monsterId];
+		if (targetsOnlyGolems && (otherMonster.flags & MFLAG_GOLEM) == 0)
+			continue;
 		if (&otherMonster == &monster)
 			continue;
 		if ((otherMonster.hitPoints >> 6) <= 0)
@@ -1749,6 +1901,7 @@ void GroupUnity(Monster &monster)
 			// Reunite the separated monster with the pack
 			leader.packSize++;
 			monster.leaderRelation = LeaderRelation::Leashed;
+			AddLeashedMinion(monster);
 		}
 	} else if (monster.leaderRelation == LeaderRelation::Leashed) {
 		leader.packSize--;
@@ -1864,6 +2017,26 @@ bool IsTileAccessible(const Monster &monster, Point position)
 	return IsTileSafe(monster, position);
 }
 
+/** Distances to the players, shared by all monsters chasing the same player. */
+PathDistanceField PlayerPathFields[MAX_PLRS];
+
+/**
+ * @brief Checks if it's worth looking for a path to the monster's enemy, without affecting what path is found.
+ */
+bool MayReachEnemy(const Monster &monster)
+{
+	for (size_t i = 0; i < MAX_PLRS; i++) {
+		const Player &player = Players[i];
+		if (!player.plractive || !player.isOnActiveLevel() || player.position.tile != monster.enemyPosition)
+			continue;
+		PathDistanceField &field = PlayerPathFields[i];
+		if (!field.isValid() || field.destination() != monster.enemyPosition)
+			field.Build(monster.enemyPosition);
+		return field.MayReach(monster.position.tile);
+	}
+	return true;
+}
+
 bool AiPlanWalk(Monster &monster)
 {
 	int8_t path[MaxPathLength];
@@ -1871,6 +2044,9 @@ bool AiPlanWalk(Monster &monster)
 	/** Maps from walking path step to facing direction. */
 	const Direction plr2monst[9] = { Direction::South, Direction::NorthEast, Direction::NorthWest, Direction::SouthEast, Direction::SouthWest, Direction::North, Direction::East, Direction::South, Direction::West };
 
+	if (!MayReachEnemy(monster))
+		return false;
+
 	if (FindPath([&monster](Point position) { return IsTileAccessible(monster, position); }, monster.position.tile, monster.enemyPosition, path) == 0) {
 		return false;
 	}
@@ -3233,6 +3409,58 @@ void (*AiProc[])(int i) = {
 	/*AI_BONEDEMON*/ &AiRangedAvoidance
 };
 
+/**
+ * @brief Whether the AI returns straight away for a monster that stands still, hasn't been active for a while and is
+ * out of sight, without touching the monster or the RNG.
+ */
+bool IsIdleWhenDormant(_mai_id ai)
+{
+	switch (ai) {
+	case AI_ZOMBIE:
+	case AI_FAT:
+	case AI_SKELSD:
+	case AI_SKELBOW:
+	case AI_RHINO:
+	case AI_GOATMC:
+	case AI_GOATBOW:
+	case AI_MAGMA:
+	case AI_SKELKING:
+	case AI_BAT:
+	case AI_CLEAVER:
+	case AI_SUCC:
+	case AI_STORM:
+	case AI_ACID:
+	case AI_ACIDUNIQ:
+	case AI_SNAKE:
+	case AI_COUNSLR:
+	case AI_DIABLO:
+	case AI_FIREBAT:
+	case AI_TORCHANT:
+	case AI_HORKDMN:
+	case AI_LICH:
+	case AI_ARCHLICH:
+	case AI_PSYCHORB:
+	case AI_NECROMORB:
+	case AI_BONEDEMON:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * @brief Dormant monsters only play their stand animation and look for an enemy at the end of it, so their AI isn't
+ * called. Everything that could wake them up is checked every tick, which keeps the game state and the RNG the same.
+ */
+bool IsDormant(const Monster &monster, bool isVisible)
+{
+	return monster.mode == MonsterMode::Stand
+	    && monster.activeForTicks == 0
+	    && !isVisible
+	    && (monster.flags & MFLAG_TARGETS_MONSTER) == 0
+	    && IsIdleWhenDormant(monster.ai);
+}
+
 bool IsRelativeMoveOK(const Monster &monster, Point position, Direction mdir)
 {
 	Point futurePosition = position + mdir;
@@ -3429,6 +3657,8 @@ void PrepareUniqueMonst(Monster &monster, UniqueMonsterType monsterType, size_t
 
 void InitLevelMonsters()
 {
+	InvalidatePathDistanceFields();
+
 	LevelMonsterTypeCount = 0;
 	monstimgtot = 0;
 
@@ -3445,6 +3675,20 @@ void InitLevelMonsters()
 	}
 
 	uniquetrans = 0;
+
+	for (std::vector<uint8_t> &minions : LeashedMinions)
+		minions.clear();
+}
+
+void RebuildLeashedMinions()
+{
+	for (std::vector<uint8_t> &minions : LeashedMinions)
+		minions.clear();
+	for (size_t i = 0; i < ActiveMonsterCount; i++) {
+		const Monster &monster = Monsters[ActiveMonsters[i]];
+		if (monster.leaderRelation == LeaderRelation::Leashed && monster.getLeader() != nullptr)
+			AddLeashedMinion(monster);
+	}
 }
 
 void GetLevelMTypes()
@@ -3562,23 +3806,30 @@ void InitMonsterSND(CMonster &monsterType)
 
 void InitMonsterGFX(CMonster &monsterType)
 {
+	ProgressPump();
 	const _monster_id mtype = monsterType.type;
 	const MonsterData &monsterData = MonstersData[mtype];
 	const int width = monsterData.width;
-	constexpr size_t MaxAnims = sizeof(Animletter) / sizeof(Animletter[0]) - 1;
 	const size_t numAnims = GetNumAnims(monsterData);
 
 	const auto hasAnim = [&monsterData](size_t i) {
 		return monsterData.frames[i] != 0;
 	};
 
-	std::array<uint32_t, MaxAnims> animOffsets;
+	MonsterGfxLayout &layout = LevelMonsterGfxLayouts[&monsterType - LevelMonsterTypes];
+	const std::array<uint32_t, MaxMonsterAnims> &animOffsets = layout.animOffsets;
+	bool translated = false;
 	if (!HeadlessMode) {
-		monsterType.animData = MultiFileLoader<MaxAnims> {}(
-		    numAnims,
-		    FileNameWithCharAffixGenerator({ "Monsters\\", monsterData.assetsSuffix }, ".CL2", Animletter),
-		    animOffsets.data(),
-		    hasAnim);
+		translated = TakeRetainedMonsterGfx(monsterType, layout);
+		if (!translated) {
+			monsterType.animData = MultiFileLoader<MaxMonsterAnims> { GetAssetLoadingThreads() }(
+			    numAnims,
+			    FileNameWithCharAffixGenerator({ "Monsters\\", monsterData.assetsSuffix }, ".CL2", Animletter),
+			    layout.animOffsets.data(),
+			    hasAnim,
+			    &layout.size);
+		}
+		UpdateMonsterGfxUsage();
 	}
 
 	for (unsigned animIndex = 0; animIndex < numAnims; animIndex++) {
@@ -3611,7 +3862,7 @@ void InitMonsterGFX(CMonster &monsterType)
 	if (HeadlessMode)
 		return;
 
-	if (monsterData.trnFile != nullptr) {
+	if (monsterData.trnFile != nullptr && !translated) {
 		InitMonsterTRN(monsterType);
 	}
 
@@ -4153,9 +4404,20 @@ void DeleteMonsterList()
 	}
 }
 
+/*
+ * The monsters are processed one after the other in ActiveMonsters order and this can't be split into a parallel
+ * decide phase and a serial apply phase. The AI functions draw from the shared RNG in between reading the world, so
+ * how many values a monster draws depends on what the monsters before it did this tick. Walk claims dMonster
+ * tiles that the next monster's DirOK and pathfinding read, and UpdateEnemy and GroupUnity read the positions and
+ * activity of monsters that already moved. Deciding from a snapshot of the start of the tick would change the
+ * results, and with them demos and multiplayer sync.
+ */
 void ProcessMonsters()
 {
+	DVL_PERF_FUNCTION();
+
 	DeleteMonsterList();
+	UpdateActiveGolems();
 
 	assert(ActiveMonsterCount <= MaxMonsters);
 	for (size_t i = 0; i < ActiveMonsterCount; i++) {
@@ -4175,7 +4437,8 @@ void ProcessMonsters()
 			monster.hitPoints = std::min(monster.hitPoints, monster.maxHitPoints); // prevent going over max HP with part of a single regen tick
 		}
 
-		if (IsTileVisible(monster.position.tile) && monster.activeForTicks == 0) {
+		const bool isVisible = IsTileVisible(monster.position.tile);
+		if (isVisible && monster.activeForTicks == 0) {
 			if (monster.type().type == MT_CLEAVER) {
 				PlaySFX(USFX_CLEAVER);
 			}
@@ -4202,35 +4465,42 @@ void ProcessMonsters()
 			assert(monster.enemy >= 0 && monster.enemy < MAX_PLRS);
 			Player &player = Players[monster.enemy];
 			monster.enemyPosition = player.position.future;
-			if (IsTileVisible(monster.position.tile)) {
+			if (isVisible) {
 				monster.activeForTicks = UINT8_MAX;
 				monster.position.last = player.position.future;
 			} else if (monster.activeForTicks != 0 && monster.type().type != MT_DIABLO) {
 				monster.activeForTicks--;
 			}
 		}
-		while (true) {
-			if ((monster.flags & MFLAG_SEARCH) == 0 || !AiPlanPath(monsterId)) {
-				AiProc[monster.ai](monsterId);
-			}
+		if (IsDormant(monster, isVisible)) {
+			MonsterIdle(monster);
+		} else {
+			while (true) {
+				if ((monster.flags & MFLAG_SEARCH) == 0 || !AiPlanPath(monsterId)) {
+					AiProc[monster.ai](monsterId);
+				}
 
-			if (!UpdateModeStance(monsterId))
-				break;
+				if (!UpdateModeStance(monsterId))
+					break;
 
-			GroupUnity(monster);
+				GroupUnity(monster);
+			}
 		}
 		if (monster.mode != MonsterMode::Petrified && (monster.flags & MFLAG_ALLOW_SPECIAL) == 0) {
 			monster.animInfo.processAnimation((monster.flags & MFLAG_LOCK_ANIMATION) != 0);
 		}
 	}
 
+	ActiveGolemsValid = false;
 	DeleteMonsterList();
 }
 
 void FreeMonsters()
 {
-	for (CMonster &monsterType : LevelMonsterTypes) {
-		monsterType.animData = nullptr;
+	for (size_t i = 0; i < MaxLvlMTypes; i++) {
+		CMonster &monsterType = LevelMonsterTypes[i];
+		if (monsterType.animData != nullptr)
+			RetainedMonsterGfxs.push_back({ monsterType.type, std::move(monsterType.animData), LevelMonsterGfxLayouts[i] });
 
 		for (auto &variants : monsterType.sounds) {
 			for (auto &sound : variants) {
@@ -4238,6 +4508,30 @@ void FreeMonsters()
 			}
 		}
 	}
+	TrimRetainedMonsterGfx();
+}
+
+void FreeRetainedMonsterGFX()
+{
+	RetainedMonsterGfxs.clear();
+	RetainedMonsterGfxs.shrink_to_fit();
+	UpdateMonsterGfxUsage();
+}
+
+MonsterGfxStats GetMonsterGfxStats()
+{
+	MonsterGfxStats stats {};
+	for (size_t i = 0; i < MaxLvlMTypes; i++) {
+		if (LevelMonsterTypes[i].animData == nullptr)
+			continue;
+		stats.levelTypes++;
+		stats.levelBytes += LevelMonsterGfxLayouts[i].size;
+	}
+	for (const RetainedMonsterGfx &gfx : RetainedMonsterGfxs) {
+		stats.retainedTypes++;
+		stats.retainedBytes += gfx.layout.size;
+	}
+	return stats;
 }
 
 bool DirOK(const Monster &monster, Direction mdir)
@@ -4251,20 +4545,26 @@ bool DirOK(const Monster &monster, Direction mdir)
 	}
 	if (!monster.hasLeashedMinions())
 		return true;
-	int mcount = 0;
-	for (int x = futurePosition.x - 3; x <= futurePosition.x + 3; x++) {
-		for (int y = futurePosition.y - 3; y <= futurePosition.y + 3; y++) {
-			if (!InDungeonBounds({ x, y }))
-				continue;
-			int mi = dMonster[x][y];
-			if (mi <= 0)
-				continue;
 
-			auto &minion = Monsters[mi - 1];
-			if (minion.leaderRelation == LeaderRelation::Leashed && minion.getLeader() == &monster) {
-				mcount++;
-			}
-		}
+	// Count the tiles within 3 of the destination that hold a minion, a walking minion holds either its tile or its future one
+	const auto isNear = [&](Point tile) {
+		return abs(tile.x - futurePosition.x) <= 3 && abs(tile.y - futurePosition.y) <= 3;
+	};
+	std::vector<uint8_t> &minions = LeashedMinions[monster.getId()];
+	minions.erase(std::remove_if(minions.begin(), minions.end(), [&](uint8_t minionId) {
+		const Monster &minion = Monsters[minionId];
+		return minion.leaderRelation != LeaderRelation::Leashed || minion.getLeader() != &monster;
+	}),
+	    minions.end());
+	int mcount = 0;
+	for (uint8_t minionId : minions) {
+		const Monster &minion = Monsters[minionId];
+		const Point tile = minion.position.tile;
+		const Point future = minion.position.future;
+		if (isNear(tile) && IsTileOfMonster(minion, tile))
+			mcount++;
+		if (future != tile && InDungeonBounds(future) && isNear(future) && IsTileOfMonster(minion, future))
+			mcount++;
 	}
 	return mcount == monster.packSize;
 }
@@ -4276,81 +4576,8 @@ bool PosOkMissile(Point position)
 
 bool LineClearMissile(Point startPoint, Point endPoint)
 {
-	return LineClear(PosOkMissile, startPoint, endPoint);
-}
-
-bool LineClear(const std::function<bool(Point)> &clear, Point startPoint, Point endPoint)
-{
-	Point position = startPoint;
-
-	int dx = endPoint.x - position.x;
-	int dy = endPoint.y - position.y;
-	if (abs(dx) > abs(dy)) {
-		if (dx < 0) {
-			std::swap(position, endPoint);
-			dx = -dx;
-			dy = -dy;
-		}
-		int d;
-		int yincD;
-		int dincD;
-		int dincH;
-		if (dy > 0) {
-			d = 2 * dy - dx;
-			dincD = 2 * dy;
-			dincH = 2 * (dy - dx);
-			yincD = 1;
-		} else {
-			d = 2 * dy + dx;
-			dincD = 2 * dy;
-			dincH = 2 * (dx + dy);
-			yincD = -1;
-		}
-		bool done = false;
-		while (!done && position != endPoint) {
-			if ((d <= 0) ^ (yincD < 0)) {
-				d += dincD;
-			} else {
-				d += dincH;
-				position.y += yincD;
-			}
-			position.x++;
-			done = position != startPoint && !clear(position);
-		}
-	} else {
-		if (dy < 0) {
-			std::swap(position, endPoint);
-			dy = -dy;
-			dx = -dx;
-		}
-		int d;
-		int xincD;
-		int dincD;
-		int dincH;
-		if (dx > 0) {
-			d = 2 * dx - dy;
-			dincD = 2 * dx;
-			dincH = 2 * (dx - dy);
-			xincD = 1;
-		} else {
-			d = 2 * dx + dy;
-			dincD = 2 * dx;
-			dincH = 2 * (dy + dx);
-			xincD = -1;
-		}
-		bool done = false;
-		while (!done && position != endPoint) {
-			if ((d <= 0) ^ (xincD < 0)) {
-				d += dincD;
-			} else {
-				d += dincH;
-				position.x += xincD;
-			}
-			position.y++;
-			done = position != startPoint && !clear(position);
-		}
-	}
-	return position == endPoint;
+	UpdateMissileBlockingTiles();
+	return LineClear([](Point position) { return !MissileBlockingTiles.test(position.x, position.y); }, startPoint, endPoint);
 }
 
 void SyncMonsterAnim(Monster &monster)
@@ -4726,6 +4953,7 @@ void SpawnGolem(Player &player, Monster &golem, Point position, Missile &missile
 	golem.minDamage = 2 * (missile._mispllvl + 4);
 	golem.maxDamage = 2 * (missile._mispllvl + 8);
 	golem.flags |= MFLAG_GOLEM;
+	ActiveGolemsValid = false;
 	StartSpecialStand(golem, Direction::South);
 	UpdateEnemy(golem);
 	if (&player == MyPlayer) {
@@ -4792,6 +5020,7 @@ void Monster::setLeader(const Monster *leader)
 	this->leader = leader->getId();
 	leaderRelation = LeaderRelation::Leashed;
 	ai = leader->ai;
+	AddLeashedMinion(*this);
 }
 
 [[nodiscard]] unsigned Monster::distanceToEnemy() const
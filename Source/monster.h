@@ -7,9 +7,11 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 
 #include <array>
 #include <functional>
+#include <utility>
 
 #include "engine.h"
 #include "engine/actor_position.hpp"
@@ -173,23 +175,40 @@ struct CMonster {
 extern CMonster LevelMonsterTypes[MaxLvlMTypes];
 
 struct Monster { // note: missing field _mAFNum
-	std::unique_ptr<uint8_t[]> uniqueMonsterTRN;
-	/**
-	 * @brief Contains information for current animation
-	 */
-	AnimationInfo animInfo;
+	// The members read by ProcessMonsters and the AI routines on every game tick come first, so that updating a
+	// monster mostly touches the start of the struct instead of pulling in the rarely used data further down.
+
+	ActorPosition position;
+	uint32_t flags;
 	int maxHitPoints;
 	int hitPoints;
-	uint32_t flags;
-	/** Seed used to determine item drops on death */
-	uint32_t rndItemSeed;
 	/** Seed used to determine AI behaviour/sync sounds in multiplayer games? */
 	uint32_t aiSeed;
-	uint16_t exp;
-	uint16_t toHit;
-	uint16_t toHitSpecial;
-	uint16_t resistance;
-	_speech_id talkMsg;
+
+	/** Usually corresponds to the enemy's future position */
+	WorldTilePosition enemyPosition;
+
+	/** Specifies current goal of the monster */
+	MonsterGoal goal;
+	MonsterMode mode;
+	_mai_id ai;
+	uint8_t levelType;
+	/** Stores information for how many ticks the monster will remain active */
+	uint8_t activeForTicks;
+	/** The current target of the monster. An index in to either the player or monster array based on the _meflag value. */
+	uint8_t enemy;
+	/** Direction faced by monster (direction enum) */
+	Direction direction;
+	uint8_t pathCount;
+	int8_t level;
+	uint8_t leader;
+	LeaderRelation leaderRelation;
+	/**
+	 * @brief Specifies monster's behaviour across various actions.
+	 * Generally, when monster thinks it decides what to do based on this value, among other things.
+	 * Higher values should result in more aggressive behaviour (e.g. some monsters use this to calculate the @p AiDelay).
+	 */
+	uint8_t intelligence;
 
 	/** @brief Specifies monster's behaviour regarding moving and changing goals. */
 	int16_t goalVar1;
@@ -210,42 +229,29 @@ struct Monster { // note: missing field _mAFNum
 	int16_t var2;
 	int8_t var3;
 
-	ActorPosition position;
-
-	/** Specifies current goal of the monster */
-	MonsterGoal goal;
-
-	/** Usually corresponds to the enemy's future position */
-	WorldTilePosition enemyPosition;
-	uint8_t levelType;
-	MonsterMode mode;
-	uint8_t pathCount;
-	/** Direction faced by monster (direction enum) */
-	Direction direction;
-	/** The current target of the monster. An index in to either the player or monster array based on the _meflag value. */
-	uint8_t enemy;
-	bool isInvalid;
-	_mai_id ai;
 	/**
-	 * @brief Specifies monster's behaviour across various actions.
-	 * Generally, when monster thinks it decides what to do based on this value, among other things.
-	 * Higher values should result in more aggressive behaviour (e.g. some monsters use this to calculate the @p AiDelay).
+	 * @brief Contains information for current animation
 	 */
-	uint8_t intelligence;
-	/** Stores information for how many ticks the monster will remain active */
-	uint8_t activeForTicks;
+	AnimationInfo animInfo;
+
+	std::unique_ptr<uint8_t[]> uniqueMonsterTRN;
+	/** Seed used to determine item drops on death */
+	uint32_t rndItemSeed;
+	uint16_t exp;
+	uint16_t toHit;
+	uint16_t toHitSpecial;
+	uint16_t resistance;
+	_speech_id talkMsg;
+	bool isInvalid;
 	UniqueMonsterType uniqueType;
 	uint8_t uniqTrans;
 	int8_t corpseId;
 	int8_t whoHit;
-	int8_t level;
 	uint8_t minDamage;
 	uint8_t maxDamage;
 	uint8_t minDamageSpecial;
 	uint8_t maxDamageSpecial;
 	uint8_t armorClass;
-	uint8_t leader;
-	LeaderRelation leaderRelation;
 	uint8_t packSize;
 	int8_t lightId;
 
@@ -357,6 +363,10 @@ extern bool sgbSaveSoundOn;
 
 void PrepareUniqueMonst(Monster &monster, UniqueMonsterType monsterType, size_t miniontype, int bosspacksize, const UniqueMonsterData &uniqueMonsterData);
 void InitLevelMonsters();
+/**
+ * @brief Rebuilds the minion lists of the pack leaders, needed after monsters were restored without Monster::setLeader.
+ */
+void RebuildLeashedMinions();
 void GetLevelMTypes();
 void InitMonsterSND(CMonster &monsterType);
 void InitMonsterGFX(CMonster &monsterType);
@@ -383,11 +393,107 @@ bool Walk(Monster &monster, Direction md);
 void GolumAi(int monsterId);
 void DeleteMonsterList();
 void ProcessMonsters();
+/**
+ * @brief Frees what the monster types of the level use, their graphics are kept for the next levels if they fit the budget.
+ */
 void FreeMonsters();
+/**
+ * @brief Frees the graphics FreeMonsters kept, for when the game ends.
+ */
+void FreeRetainedMonsterGFX();
+
+struct MonsterGfxStats {
+	size_t levelTypes;
+	size_t levelBytes;
+	size_t retainedTypes;
+	size_t retainedBytes;
+};
+
+/**
+ * @brief Returns how much memory the graphics of the monster types on the level and the retained ones use.
+ */
+MonsterGfxStats GetMonsterGfxStats();
 bool DirOK(const Monster &monster, Direction mdir);
 bool PosOkMissile(Point position);
 bool LineClearMissile(Point startPoint, Point endPoint);
-bool LineClear(const std::function<bool(Point)> &clear, Point startPoint, Point endPoint);
+/**
+ * @brief Walks the line from startPoint towards endPoint until clear rejects a tile.
+ * @return Whether every tile up to endPoint was clear
+ */
+template <typename F>
+bool LineClear(F &&clear, Point startPoint, Point endPoint)
+{
+	Point position = startPoint;
+
+	int dx = endPoint.x - position.x;
+	int dy = endPoint.y - position.y;
+	if (std::abs(dx) > std::abs(dy)) {
+		if (dx < 0) {
+			std::swap(position, endPoint);
+			dx = -dx;
+			dy = -dy;
+		}
+		int d;
+		int yincD;
+		int dincD;
+		int dincH;
+		if (dy > 0) {
+			d = 2 * dy - dx;
+			dincD = 2 * dy;
+			dincH = 2 * (dy - dx);
+			yincD = 1;
+		} else {
+			d = 2 * dy + dx;
+			dincD = 2 * dy;
+			dincH = 2 * (dx + dy);
+			yincD = -1;
+		}
+		bool done = false;
+		while (!done && position != endPoint) {
+			if ((d <= 0) ^ (yincD < 0)) {
+				d += dincD;
+			} else {
+				d += dincH;
+				position.y += yincD;
+			}
+			position.x++;
+			done = position != startPoint && !clear(position);
+		}
+	} else {
+		if (dy < 0) {
+			std::swap(position, endPoint);
+			dy = -dy;
+			dx = -dx;
+		}
+		int d;
+		int xincD;
+		int dincD;
+		int dincH;
+		if (dx > 0) {
+			d = 2 * dx - dy;
+			dincD = 2 * dx;
+			dincH = 2 * (dx - dy);
+			xincD = 1;
+		} else {
+			d = 2 * dx + dy;
+			dincD = 2 * dx;
+			dincH = 2 * (dy + dx);
+			xincD = -1;
+		}
+		bool done = false;
+		while (!done && position != endPoint) {
+			if ((d <= 0) ^ (xincD < 0)) {
+				d += dincD;
+			} else {
+				d += dincH;
+				position.x += xincD;
+			}
+			position.y++;
+			done = position != startPoint && !clear(position);
+		}
+	}
+	return position == endPoint;
+}
 void SyncMonsterAnim(Monster &monster);
 void M_FallenFear(Point position);
 void PrintMonstHistory(int mt);
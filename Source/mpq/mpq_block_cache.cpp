@@ -0,0 +1,77 @@
+#include "mpq/mpq_block_cache.hpp"
+
+#include <cstring>
+#include <mutex>
+
+namespace devilution {
+
+MpqBlockCache::MpqBlockCache(size_t capacity)
+    : capacity_(capacity)
+{
+}
+
+bool MpqBlockCache::Read(uint32_t fileNumber, uint32_t blockNumber, uint8_t *out, uint32_t size)
+{
+	std::lock_guard<SdlMutex> lock(mutex_);
+	if (capacity_ == 0)
+		return false;
+
+	auto it = index_.find(Key(fileNumber, blockNumber));
+	if (it == index_.end() || it->second->size != size) {
+		misses_++;
+		return false;
+	}
+	entries_.splice(entries_.begin(), entries_, it->second);
+	std::memcpy(out, it->second->data.get(), size);
+	hits_++;
+	return true;
+}
+
+void MpqBlockCache::Insert(uint32_t fileNumber, uint32_t blockNumber, const uint8_t *data, uint32_t size)
+{
+	std::lock_guard<SdlMutex> lock(mutex_);
+	// The old entry goes even if the new one doesn't fit, it no longer matches the block.
+	const uint64_t key = Key(fileNumber, blockNumber);
+	auto it = index_.find(key);
+	if (it != index_.end()) {
+		usedBytes_ -= it->second->size;
+		entries_.erase(it->second);
+		index_.erase(it);
+	}
+
+	if (size > capacity_)
+		return;
+
+	EvictUntil(capacity_ - size);
+
+	std::unique_ptr<uint8_t[]> buffer { new uint8_t[size] };
+	std::memcpy(buffer.get(), data, size);
+	entries_.push_front(Entry { key, size, std::move(buffer) });
+	index_.emplace(key, entries_.begin());
+	usedBytes_ += size;
+}
+
+void MpqBlockCache::SetCapacity(size_t capacity)
+{
+	std::lock_guard<SdlMutex> lock(mutex_);
+	EvictUntil(0);
+	capacity_ = capacity;
+}
+
+MpqBlockCache::Stats MpqBlockCache::GetStats() const
+{
+	std::lock_guard<SdlMutex> lock(mutex_);
+	return { hits_, misses_ };
+}
+
+void MpqBlockCache::EvictUntil(size_t maxUsedBytes)
+{
+	while (usedBytes_ > maxUsedBytes) {
+		const Entry &entry = entries_.back();
+		usedBytes_ -= entry.size;
+		index_.erase(entry.key);
+		entries_.pop_back();
+	}
+}
+
+} // namespace devilution
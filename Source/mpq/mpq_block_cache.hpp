@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include "utils/sdl_mutex.h"
+
+#ifndef DEVILUTIONX_MPQ_BLOCK_CACHE_SIZE
+#define DEVILUTIONX_MPQ_BLOCK_CACHE_SIZE (256 * 1024)
+#endif
+
+namespace devilution {
+
+/**
+ * @brief Least recently used cache of decompressed MPQ file blocks.
+ *
+ * Shared between an MpqArchive and its clones, so access is synchronised.
+ */
+class MpqBlockCache {
+public:
+	/**
+	 * @param capacity Maximum number of bytes of block data to keep, 0 disables the cache.
+	 */
+	explicit MpqBlockCache(size_t capacity);
+
+	MpqBlockCache(const MpqBlockCache &) = delete;
+	MpqBlockCache &operator=(const MpqBlockCache &) = delete;
+
+	/**
+	 * @brief Copies a cached block to `out`.
+	 * @return false if the block is not in the cache, `out` is left unchanged in that case.
+	 */
+	bool Read(uint32_t fileNumber, uint32_t blockNumber, uint8_t *out, uint32_t size);
+
+	/**
+	 * @brief Adds a block, evicting the least recently used ones if there isn't enough room.
+	 */
+	void Insert(uint32_t fileNumber, uint32_t blockNumber, const uint8_t *data, uint32_t size);
+
+	/**
+	 * @brief Throws away all cached blocks and changes the capacity.
+	 */
+	void SetCapacity(size_t capacity);
+
+	struct Stats {
+		uint64_t hits;
+		uint64_t misses;
+	};
+
+	/**
+	 * @brief Returns how often blocks were found in the cache.
+	 */
+	[[nodiscard]] Stats GetStats() const;
+
+private:
+	struct Entry {
+		uint64_t key;
+		uint32_t size;
+		std::unique_ptr<uint8_t[]> data;
+	};
+
+	static uint64_t Key(uint32_t fileNumber, uint32_t blockNumber)
+	{
+		return (static_cast<uint64_t>(fileNumber) << 32) | blockNumber;
+	}
+
+	void EvictUntil(size_t maxUsedBytes);
+
+	mutable SdlMutex mutex_;
+	/** Most recently used block first */
+	std::list<Entry> entries_;
+	std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+	size_t capacity_;
+	size_t usedBytes_ = 0;
+	uint64_t hits_ = 0;
+	uint64_t misses_ = 0;
+};
+
+} // namespace devilution
@@ -1,5 +1,7 @@
 #include "mpq/mpq_reader.hpp"
 
+#include <cstring>
+
 #include <libmpq/mpq.h>
 
 #include "utils/stdcompat/optional.hpp"
@@ -15,7 +17,12 @@ std::optional<MpqArchive> MpqArchive::Open(const char *path, int32_t &error)
 			error = 0;
 		return std::nullopt;
 	}
-	return MpqArchive { std::string(path), archive };
+	std::shared_ptr<const MappedFile> mapping;
+#ifdef DEVILUTIONX_MMAP_MPQ
+	// libmpq still reads the tables and compressed files through its own file handle.
+	mapping = MappedFile::Open(path);
+#endif
+	return MpqArchive { std::string(path), archive, std::make_shared<MpqBlockCache>(DEVILUTIONX_MPQ_BLOCK_CACHE_SIZE), std::move(mapping) };
 }
 
 std::optional<MpqArchive> MpqArchive::Clone(int32_t &error)
@@ -24,7 +31,7 @@ std::optional<MpqArchive> MpqArchive::Clone(int32_t &error)
 	error = libmpq__archive_dup(archive_, path_.c_str(), &copy);
 	if (error != 0)
 		return std::nullopt;
-	return MpqArchive { path_, copy };
+	return MpqArchive { path_, copy, blockCache_, mapping_ };
 }
 
 const char *MpqArchive::ErrorMessage(int32_t errorCode)
@@ -46,6 +53,8 @@ MpqArchive &MpqArchive::operator=(MpqArchive &&other) noexcept
 		libmpq__archive_close(archive_);
 	archive_ = other.archive_;
 	tmp_buf_ = std::move(other.tmp_buf_);
+	blockCache_ = std::move(other.blockCache_);
+	mapping_ = std::move(other.mapping_);
 	return *this;
 }
 
@@ -68,6 +77,14 @@ std::unique_ptr<byte[]> MpqArchive::ReadFile(const char *filename, std::size_t &
 	if (error != 0)
 		return result;
 
+	std::size_t mappedSize;
+	if (const byte *mappedData = GetMappedFileData(fileNumber, mappedSize)) {
+		result = std::make_unique<byte[]>(mappedSize);
+		std::memcpy(result.get(), mappedData, mappedSize);
+		fileSize = mappedSize;
+		return result;
+	}
+
 	libmpq__off_t unpackedSize;
 	error = libmpq__file_size_unpacked(archive_, fileNumber, &unpackedSize);
 	if (error != 0)
@@ -103,11 +120,17 @@ std::unique_ptr<byte[]> MpqArchive::ReadFile(const char *filename, std::size_t &
 
 int32_t MpqArchive::ReadBlock(uint32_t fileNumber, uint32_t blockNumber, uint8_t *out, uint32_t outSize)
 {
+	if (blockCache_->Read(fileNumber, blockNumber, out, outSize))
+		return 0;
+
 	std::vector<std::uint8_t> &tmpBuf = GetTemporaryBuffer(outSize);
-	return libmpq__block_read_with_temporary_buffer(
+	const int32_t error = libmpq__block_read_with_temporary_buffer(
 	    archive_, fileNumber, blockNumber, out, static_cast<libmpq__off_t>(outSize),
 	    tmpBuf.data(), outSize,
 	    /*transferred=*/nullptr);
+	if (error == 0)
+		blockCache_->Insert(fileNumber, blockNumber, out, outSize);
+	return error;
 }
 
 std::size_t MpqArchive::GetUnpackedFileSize(uint32_t fileNumber, int32_t &error)
@@ -149,4 +172,41 @@ bool MpqArchive::HasFile(const char *filename) const
 	return error == 0;
 }
 
+const byte *MpqArchive::GetMappedFileData(uint32_t fileNumber, std::size_t &fileSize) const
+{
+	if (mapping_ == nullptr)
+		return nullptr;
+
+	uint32_t flag;
+	if (libmpq__file_compressed(archive_, fileNumber, &flag) != 0 || flag != 0)
+		return nullptr;
+	if (libmpq__file_imploded(archive_, fileNumber, &flag) != 0 || flag != 0)
+		return nullptr;
+	if (libmpq__file_encrypted(archive_, fileNumber, &flag) != 0 || flag != 0)
+		return nullptr;
+
+	libmpq__off_t offset;
+	libmpq__off_t packedSize;
+	libmpq__off_t unpackedSize;
+	if (libmpq__file_offset(archive_, fileNumber, &offset) != 0
+	    || libmpq__file_size_packed(archive_, fileNumber, &packedSize) != 0
+	    || libmpq__file_size_unpacked(archive_, fileNumber, &unpackedSize) != 0)
+		return nullptr;
+	if (packedSize != unpackedSize || offset < 0 || static_cast<uint64_t>(offset) + static_cast<uint64_t>(unpackedSize) > mapping_->size())
+		return nullptr;
+
+	fileSize = static_cast<std::size_t>(unpackedSize);
+	return mapping_->data() + offset;
+}
+
+MpqBlockCache::Stats MpqArchive::GetBlockCacheStats() const
+{
+	return blockCache_->GetStats();
+}
+
+void MpqArchive::SetBlockCacheCapacity(std::size_t capacity)
+{
+	blockCache_->SetCapacity(capacity);
+}
+
 } // namespace devilution
@@ -7,6 +7,8 @@
 #include <string>
 #include <vector>
 
+#include "mpq/mpq_block_cache.hpp"
+#include "utils/mapped_file.hpp"
 #include "utils/stdcompat/cstddef.hpp"
 #include "utils/stdcompat/optional.hpp"
 
@@ -32,6 +34,8 @@ public:
 	    : path_(std::move(other.path_))
 	    , archive_(other.archive_)
 	    , tmp_buf_(std::move(other.tmp_buf_))
+	    , blockCache_(std::move(other.blockCache_))
+	    , mapping_(std::move(other.mapping_))
 	{
 		other.archive_ = nullptr;
 	}
@@ -45,7 +49,7 @@ public:
 
 	std::unique_ptr<byte[]> ReadFile(const char *filename, std::size_t &fileSize, int32_t &error);
 
-	// Returns error code.
+	// Returns error code. Blocks are served from the decompressed block cache if possible.
 	int32_t ReadBlock(uint32_t fileNumber, uint32_t blockNumber, uint8_t *out, uint32_t outSize);
 
 	std::size_t GetUnpackedFileSize(uint32_t fileNumber, int32_t &error);
@@ -61,10 +65,26 @@ public:
 
 	bool HasFile(const char *filename) const;
 
+	const std::string &GetPath() const
+	{
+		return path_;
+	}
+
+	// Returns the contents of a file that is stored without compression or encryption straight from the memory
+	// mapped archive, or nullptr if the archive isn't mapped or the file needs decoding.
+	// The data remains valid for the lifetime of the archive.
+	const byte *GetMappedFileData(uint32_t fileNumber, std::size_t &fileSize) const;
+
+	// The block cache is shared with all clones of this archive.
+	MpqBlockCache::Stats GetBlockCacheStats() const;
+	void SetBlockCacheCapacity(std::size_t capacity);
+
 private:
-	MpqArchive(std::string path, mpq_archive_s *archive)
+	MpqArchive(std::string path, mpq_archive_s *archive, std::shared_ptr<MpqBlockCache> blockCache, std::shared_ptr<const MappedFile> mapping)
 	    : path_(std::move(path))
 	    , archive_(archive)
+	    , blockCache_(std::move(blockCache))
+	    , mapping_(std::move(mapping))
 	{
 	}
 
@@ -78,6 +98,9 @@ private:
 	std::string path_;
 	mpq_archive_s *archive_;
 	std::vector<std::uint8_t> tmp_buf_;
+	std::shared_ptr<MpqBlockCache> blockCache_;
+	// Shared with the clones of this archive, nullptr unless built with DEVILUTIONX_MMAP_MPQ.
+	std::shared_ptr<const MappedFile> mapping_;
 };
 
 } // namespace devilution
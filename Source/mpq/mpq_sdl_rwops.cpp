@@ -1,5 +1,6 @@
 #include "mpq/mpq_sdl_rwops.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 #include <vector>
@@ -17,6 +18,8 @@ struct Data {
 	uint32_t lastBlockSize;
 	uint32_t numBlocks;
 	uint32_t size;
+	/** The file contents if they can be read straight from the memory mapped archive, the block fields are unused in that case. */
+	const uint8_t *mappedData;
 
 	// State:
 	uint32_t position;
@@ -82,7 +85,7 @@ static OffsetType MpqFileRwSeek(struct SDL_RWops *context, OffsetType offset, in
 		return -1;
 	}
 
-	if (data.position / data.blockSize != newPosition / data.blockSize)
+	if (data.mappedData == nullptr && data.position / data.blockSize != newPosition / data.blockSize)
 		data.blockRead = false;
 
 	data.position = newPosition;
@@ -98,6 +101,13 @@ static SizeType MpqFileRwRead(struct SDL_RWops *context, void *ptr, SizeType siz
 
 	auto *out = static_cast<uint8_t *>(ptr);
 
+	if (data.mappedData != nullptr) {
+		const uint32_t readSize = std::min(remainingSize, data.size - data.position);
+		std::memcpy(out, data.mappedData + data.position, readSize);
+		data.position += readSize;
+		return readSize / size;
+	}
+
 	if (data.blockData == nullptr) {
 		data.blockData = std::unique_ptr<uint8_t[]> { new uint8_t[data.blockSize] };
 	}
@@ -142,7 +152,8 @@ static SizeType MpqFileRwRead(struct SDL_RWops *context, void *ptr, SizeType siz
 static int MpqFileRwClose(struct SDL_RWops *context)
 {
 	Data *data = GetData(context);
-	data->mpqArchive->CloseBlockOffsetTable(data->fileNumber);
+	if (data->mappedData == nullptr)
+		data->mpqArchive->CloseBlockOffsetTable(data->fileNumber);
 	delete data;
 	delete context;
 	return 0;
@@ -184,6 +195,16 @@ SDL_RWops *SDL_RWops_FromMpqFile(MpqArchive &mpqArchive, uint32_t fileNumber, co
 	}
 	data->fileNumber = fileNumber;
 	MpqArchive &archive = *data->mpqArchive;
+	data->position = 0;
+
+	std::size_t mappedSize;
+	if (const byte *mappedData = archive.GetMappedFileData(fileNumber, mappedSize)) {
+		data->mappedData = reinterpret_cast<const uint8_t *>(mappedData);
+		data->size = static_cast<uint32_t>(mappedSize);
+		SetData(result.get(), data.release());
+		return result.release();
+	}
+	data->mappedData = nullptr;
 
 	error = archive.OpenBlockOffsetTable(fileNumber, filename);
 	if (error != 0) {
@@ -221,7 +242,6 @@ SDL_RWops *SDL_RWops_FromMpqFile(MpqArchive &mpqArchive, uint32_t fileNumber, co
 		data->lastBlockSize = blockSize;
 	}
 
-	data->position = 0;
 	data->blockRead = false;
 
 	SetData(result.get(), data.release());
@@ -2,9 +2,11 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <algorithm>
 #include <cstring>
 #include <memory>
 #include <type_traits>
+#include <vector>
 
 #include "appfat.h"
 #include "encrypt.h"
@@ -60,6 +62,11 @@ constexpr uint32_t BlockSize = 512 << BlockSizeFactor; // 4096
 // Sometimes we can end up with smaller blocks.
 constexpr uint32_t MinBlockSize = 1024;
 
+// The files are moved together once free space makes up this share of the file data, and at least MinCompactFreeSize.
+// Below that, rewriting the files costs more than the holes do.
+constexpr uint32_t CompactFreePercent = 25;
+constexpr uint32_t MinCompactFreeSize = 64 * 1024;
+
 void ByteSwapHdr(MpqFileHeader *hdr)
 {
 	hdr->signature = SDL_SwapLE32(hdr->signature);
@@ -83,6 +90,43 @@ bool IsUnallocatedBlock(const MpqBlockEntry *block)
 	return block->offset == 0 && block->packedSize == 0 && block->unpackedSize == 0 && block->flags == 0;
 }
 
+/**
+ * @brief Compresses a file into the layout it has in the archive: the table of sector offsets followed by the sectors.
+ *
+ * @param packedSize Receives the size of the result.
+ * @param maxPackedSize Receives the most space the file can take up, sectors that can't be compressed are stored as is.
+ */
+std::unique_ptr<byte[]> PackFile(const byte *fileData, size_t fileSize, uint32_t &packedSize, uint32_t &maxPackedSize)
+{
+	const uint32_t numSectors = (fileSize + (BlockSize - 1)) / BlockSize;
+	const uint32_t offsetTableByteSize = sizeof(uint32_t) * (numSectors + 1);
+	maxPackedSize = fileSize + offsetTableByteSize;
+	std::unique_ptr<byte[]> packed { new byte[maxPackedSize] };
+
+	// First offset is the start of the first sector, last offset is the end of the last sector.
+	auto *offsetTable = reinterpret_cast<uint32_t *>(packed.get());
+	uint32_t destSize = offsetTableByteSize;
+	byte mpqBuf[BlockSize];
+	size_t curSector = 0;
+	while (true) {
+		uint32_t len = std::min<uint32_t>(fileSize, BlockSize);
+		memcpy(mpqBuf, fileData, len);
+		fileData += len;
+		len = PkwareCompress(mpqBuf, len);
+		memcpy(&packed[destSize], mpqBuf, len);
+		offsetTable[curSector++] = SDL_SwapLE32(destSize);
+		destSize += len; // compressed length
+		if (fileSize <= BlockSize)
+			break;
+
+		fileSize -= BlockSize;
+	}
+	offsetTable[numSectors] = SDL_SwapLE32(destSize);
+
+	packedSize = destSize;
+	return packed;
+}
+
 } // namespace
 
 MpqWriter::MpqWriter(const char *path)
@@ -91,8 +135,9 @@ MpqWriter::MpqWriter(const char *path)
 	std::string error;
 	bool exists = FileExists(path);
 	std::ios::openmode mode = std::ios::out | std::ios::binary;
+	// Reading is needed for the existing tables and for moving files around in Compact.
+	mode |= std::ios::in;
 	if (exists) {
-		mode |= std::ios::in;
 		if (!GetFileSize(path, &size_)) {
 			error = R"(GetFileSize failed: "{}")";
 			LogError(error, path, std::strerror(errno));
@@ -101,6 +146,7 @@ MpqWriter::MpqWriter(const char *path)
 		LogVerbose("GetFileSize(\"{}\") = {}", path, size_);
 	} else {
 		mode |= std::ios::trunc;
+		dirty_ = true;
 	}
 	if (!stream_.Open(path, mode)) {
 		stream_.Close();
@@ -166,6 +212,13 @@ MpqWriter::~MpqWriter()
 	if (!stream_.IsOpen())
 		return;
 	LogVerbose("Closing {}", name_);
+	if (!dirty_) {
+		// Nothing was changed, so the header and tables on disk are still up to date.
+		stream_.Close();
+		return;
+	}
+
+	Compact();
 
 	bool result = true;
 	if (!(stream_.Seekp(0, std::ios::beg) && WriteHeaderAndTables()))
@@ -217,6 +270,7 @@ bool MpqWriter::ReadMPQHeader(MpqFileHeader *hdr)
 	}
 	if (!hasHdr || !IsValidMpqHeader(hdr)) {
 		InitDefaultMpqHeader(hdr);
+		dirty_ = true;
 	}
 	return true;
 }
@@ -305,6 +359,57 @@ uint32_t MpqWriter::FindFreeBlock(uint32_t size)
 	return result;
 }
 
+void MpqWriter::Compact()
+{
+	// A lookup stops at the first empty hash entry, so the deleted entries right before one are never stepped over.
+	for (uint32_t i = 0; i < HashEntriesCount; ++i) {
+		if (hashTable_[i].block != MpqHashEntry::NullBlock)
+			continue;
+		for (uint32_t j = (i - 1) & 0x7FF; hashTable_[j].block == MpqHashEntry::DeletedBlock; j = (j - 1) & 0x7FF)
+			std::memset(&hashTable_[j], 0xFF, sizeof(hashTable_[j]));
+	}
+
+	constexpr uint32_t DataOffset = MpqHashEntryOffset + HashEntrySize;
+	uint32_t freeSize = 0;
+	std::vector<MpqBlockEntry *> files;
+	for (unsigned i = 0; i < BlockEntriesCount; ++i) {
+		MpqBlockEntry &block = blockTable_[i];
+		if (IsAllocatedUnusedBlock(&block))
+			freeSize += block.packedSize;
+		else if (!IsUnallocatedBlock(&block))
+			files.push_back(&block);
+	}
+	if (freeSize < MinCompactFreeSize || static_cast<uint64_t>(freeSize) * 100 < (size_ - DataOffset) * CompactFreePercent)
+		return;
+
+	LogVerbose("Compacting {}, {} of {} bytes are free", name_, freeSize, size_);
+	// The free blocks are forgotten before anything is moved. Should moving fail, their space is lost but never handed out twice.
+	for (unsigned i = 0; i < BlockEntriesCount; ++i) {
+		if (IsAllocatedUnusedBlock(&blockTable_[i]))
+			std::memset(&blockTable_[i], 0, sizeof(MpqBlockEntry));
+	}
+
+	std::sort(files.begin(), files.end(), [](const MpqBlockEntry *a, const MpqBlockEntry *b) {
+		return a->offset < b->offset;
+	});
+	std::vector<byte> contents;
+	uint32_t offset = DataOffset;
+	for (MpqBlockEntry *block : files) {
+		if (block->offset != offset) {
+			contents.resize(block->packedSize);
+			if (!stream_.Seekg(block->offset)
+			    || !stream_.Read(reinterpret_cast<char *>(contents.data()), block->packedSize)
+			    || !WriteFileContents(contents.data(), block->packedSize, offset)) {
+				LogError("Failed to compact {}", name_);
+				return;
+			}
+			block->offset = offset;
+		}
+		offset += block->packedSize;
+	}
+	size_ = offset;
+}
+
 uint32_t MpqWriter::GetHashIndex(uint32_t index, uint32_t hashA, uint32_t hashB) const // NOLINT(bugprone-easily-swappable-parameters)
 {
 	uint32_t i = HashEntriesCount;
@@ -362,30 +467,10 @@ MpqBlockEntry *MpqWriter::AddFile(const char *filename, MpqBlockEntry *block, ui
 	return block;
 }
 
-bool MpqWriter::WriteFileContents(const char *filename, const byte *fileData, size_t fileSize, MpqBlockEntry *block)
+bool MpqWriter::WriteFileContents(const byte *packedData, uint32_t packedSize, uint32_t offset)
 {
-	const char *tmp;
-	while ((tmp = strchr(filename, ':')) != nullptr)
-		filename = tmp + 1;
-	while ((tmp = strchr(filename, '\\')) != nullptr)
-		filename = tmp + 1;
-	Hash(filename, 3);
-
-	const uint32_t numSectors = (fileSize + (BlockSize - 1)) / BlockSize;
-	const uint32_t offsetTableByteSize = sizeof(uint32_t) * (numSectors + 1);
-	block->offset = FindFreeBlock(fileSize + offsetTableByteSize);
-	// `packedSize` is reduced at the end of the function if it turns out to be smaller.
-	block->packedSize = fileSize + offsetTableByteSize;
-	block->unpackedSize = fileSize;
-	block->flags = MpqBlockEntry::FlagExists | MpqBlockEntry::CompressPkZip;
-
-	// We populate the table of sector offsets while we write the data.
-	// We can't pre-populate it because we don't know the compressed sector sizes yet.
-	// First offset is the start of the first sector, last offset is the end of the last sector.
-	std::unique_ptr<uint32_t[]> offsetTable { new uint32_t[numSectors + 1] };
-
 #ifdef CAN_SEEKP_BEYOND_EOF
-	if (!stream_.Seekp(block->offset + offsetTableByteSize, std::ios::beg))
+	if (!stream_.Seekp(offset, std::ios::beg))
 		return false;
 #else
 	// Ensure we do not Seekp beyond EOF by filling the missing space.
@@ -393,55 +478,16 @@ bool MpqWriter::WriteFileContents(const char *filename, const byte *fileData, si
 	if (!stream_.Seekp(0, std::ios::end) || !stream_.Tellp(&stream_end))
 		return false;
 	const std::uintmax_t cur_size = stream_end - streamBegin_;
-	if (cur_size < block->offset + offsetTableByteSize) {
-		if (cur_size < block->offset) {
-			std::unique_ptr<char[]> filler { new char[block->offset - cur_size] };
-			if (!stream_.Write(filler.get(), block->offset - cur_size))
-				return false;
-		}
-		if (!stream_.Write(reinterpret_cast<const char *>(offsetTable.get()), offsetTableByteSize))
+	if (cur_size < offset) {
+		std::unique_ptr<char[]> filler { new char[offset - cur_size] };
+		if (!stream_.Write(filler.get(), offset - cur_size))
 			return false;
 	} else {
-		if (!stream_.Seekp(block->offset + offsetTableByteSize, std::ios::beg))
+		if (!stream_.Seekp(offset, std::ios::beg))
 			return false;
 	}
 #endif
-
-	uint32_t destSize = offsetTableByteSize;
-	byte mpqBuf[BlockSize];
-	size_t curSector = 0;
-	while (true) {
-		uint32_t len = std::min<uint32_t>(fileSize, BlockSize);
-		memcpy(mpqBuf, fileData, len);
-		fileData += len;
-		len = PkwareCompress(mpqBuf, len);
-		if (!stream_.Write(reinterpret_cast<const char *>(&mpqBuf[0]), len))
-			return false;
-		offsetTable[curSector++] = SDL_SwapLE32(destSize);
-		destSize += len; // compressed length
-		if (fileSize <= BlockSize)
-			break;
-
-		fileSize -= BlockSize;
-	}
-
-	offsetTable[numSectors] = SDL_SwapLE32(destSize);
-	if (!stream_.Seekp(block->offset, std::ios::beg))
-		return false;
-	if (!stream_.Write(reinterpret_cast<const char *>(offsetTable.get()), offsetTableByteSize))
-		return false;
-	if (!stream_.Seekp(destSize - offsetTableByteSize, std::ios::cur))
-		return false;
-
-	if (destSize < block->packedSize) {
-		const uint32_t remainingBlockSize = block->packedSize - destSize;
-		if (remainingBlockSize >= MinBlockSize) {
-			// Allocate another block if we didn't use all of this one.
-			block->packedSize = destSize;
-			AllocBlock(block->packedSize + block->offset, remainingBlockSize);
-		}
-	}
-	return true;
+	return stream_.Write(reinterpret_cast<const char *>(packedData), packedSize);
 }
 
 bool MpqWriter::WriteHeader()
@@ -489,6 +535,7 @@ void MpqWriter::RemoveHashEntry(const char *filename)
 	MpqHashEntry *hashEntry = &hashTable_[hIdx];
 	MpqBlockEntry *block = &blockTable_[hashEntry->block];
 	hashEntry->block = MpqHashEntry::DeletedBlock;
+	dirty_ = true;
 	const uint32_t blockOffset = block->offset;
 	const uint32_t blockSize = block->packedSize;
 	memset(block, 0, sizeof(*block));
@@ -506,11 +553,37 @@ void MpqWriter::RemoveHashEntries(bool (*fnGetName)(uint8_t, char *))
 
 bool MpqWriter::WriteFile(const char *filename, const byte *data, size_t size)
 {
-	MpqBlockEntry *blockEntry;
+	// The file is compressed up front, so that it can be written with a single call and we know whether it fits in its old place.
+	uint32_t packedSize;
+	uint32_t maxPackedSize;
+	const std::unique_ptr<byte[]> packed = PackFile(data, size, packedSize, maxPackedSize);
+
+	MpqBlockEntry *blockEntry = nullptr;
+	const uint32_t hIdx = FetchHandle(filename);
+	if (hIdx != HashEntryNotFound) {
+		MpqBlockEntry *oldBlock = &blockTable_[hashTable_[hIdx].block];
+		// Overwrite the previous version in place instead of moving the file elsewhere and leaving a hole.
+		if (oldBlock->packedSize >= packedSize)
+			blockEntry = oldBlock;
+	}
+	if (blockEntry == nullptr) {
+		RemoveHashEntry(filename);
+		blockEntry = AddFile(filename, nullptr, 0);
+		// Space for the uncompressed file is reserved like before, so new archives keep the same layout.
+		blockEntry->offset = FindFreeBlock(maxPackedSize);
+		blockEntry->packedSize = maxPackedSize;
+	}
+	// Allocate another block if we didn't use all of this one.
+	const uint32_t remainingBlockSize = blockEntry->packedSize - packedSize;
+	if (remainingBlockSize >= MinBlockSize) {
+		blockEntry->packedSize = packedSize;
+		AllocBlock(blockEntry->offset + packedSize, remainingBlockSize);
+	}
+	blockEntry->unpackedSize = size;
+	blockEntry->flags = MpqBlockEntry::FlagExists | MpqBlockEntry::CompressPkZip;
+	dirty_ = true;
 
-	RemoveHashEntry(filename);
-	blockEntry = AddFile(filename, nullptr, 0);
-	if (!WriteFileContents(filename, data, size, blockEntry)) {
+	if (!WriteFileContents(packed.get(), packedSize, blockEntry->offset)) {
 		RemoveHashEntry(filename);
 		return false;
 	}
@@ -529,6 +602,7 @@ void MpqWriter::RenameFile(const char *name, const char *newName) // NOLINT(bugp
 	MpqBlockEntry *blockEntry = &blockTable_[block];
 	hashEntry->block = MpqHashEntry::DeletedBlock;
 	AddFile(newName, blockEntry, block);
+	dirty_ = true;
 }
 
 bool MpqWriter::HasFile(const char *name) const
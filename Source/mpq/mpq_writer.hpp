@@ -33,7 +33,7 @@ private:
 
 	bool ReadMPQHeader(MpqFileHeader *hdr);
 	MpqBlockEntry *AddFile(const char *filename, MpqBlockEntry *block, uint32_t blockIndex);
-	bool WriteFileContents(const char *filename, const byte *fileData, size_t fileSize, MpqBlockEntry *block);
+	bool WriteFileContents(const byte *packedData, uint32_t packedSize, uint32_t offset);
 
 	// Returns an unused entry in the block entry table.
 	MpqBlockEntry *NewBlock(uint32_t *blockIndex = nullptr);
@@ -44,6 +44,12 @@ private:
 	// Returns the file offset that is followed by empty space of at least the given size.
 	uint32_t FindFreeBlock(uint32_t size);
 
+	/**
+	 * @brief Drops the deleted hash entries that lookups no longer have to step over, and moves the files to the
+	 * front of the archive if the free space has grown too large.
+	 */
+	void Compact();
+
 	bool WriteHeaderAndTables();
 	bool WriteHeader();
 	bool WriteBlockTable();
@@ -55,6 +61,8 @@ private:
 	std::uintmax_t size_ {};
 	std::unique_ptr<MpqHashEntry[]> hashTable_;
 	std::unique_ptr<MpqBlockEntry[]> blockTable_;
+	/** @brief Whether the header and tables have to be written back when closing. */
+	bool dirty_ = false;
 
 // Amiga cannot Seekp beyond EOF.
 // See https://github.com/bebbo/libnix/issues/30
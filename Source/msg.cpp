@@ -4,9 +4,12 @@
  * Implementation of function for sending and reciving network messages.
  */
 #include <climits>
+#include <cstddef>
+#include <algorithm>
 #include <list>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -71,12 +74,6 @@ struct DObjectStr {
 	_cmd_id bCmd;
 };
 
-struct DLevel {
-	TCmdPItem item[MAXITEMS];
-	DObjectStr object[MAXOBJECTS];
-	DMonsterStr monster[MaxMonsters];
-};
-
 struct LocalLevel {
 	LocalLevel(const uint8_t (&other)[DMAXX][DMAXY])
 	{
@@ -105,6 +102,115 @@ struct DJunk {
 };
 #pragma pack(pop)
 
+/**
+ * @brief Entries of a level delta, only the ones that have been written are stored.
+ *
+ * An entry that isn't stored reads as all 0xFF bytes, which is what the wire format and DeltaLoadLevel treat as
+ * unchanged. Entries are kept sorted by index so that they are exported in the same order as the dense arrays were.
+ */
+template <typename T, size_t N>
+class SparseDeltas {
+	static_assert(N <= 256, "Indices are stored as uint8_t");
+
+public:
+	struct Entry {
+		uint8_t index;
+		T value;
+	};
+
+	/** @brief Returns the entry, storing an unchanged one first if there is none. */
+	T &operator[](size_t index)
+	{
+		assert(index < N);
+		auto it = LowerBound(index);
+		if (it == entries_.end() || it->index != index) {
+			Entry entry;
+			entry.index = static_cast<uint8_t>(index);
+			memset(&entry.value, 0xFF, sizeof(T));
+			it = entries_.insert(it, entry);
+		}
+		return it->value;
+	}
+
+	/** @brief Returns the entry or nullptr if it hasn't been written. */
+	T *Find(size_t index)
+	{
+		auto it = LowerBound(index);
+		if (it == entries_.end() || it->index != index)
+			return nullptr;
+		return &it->value;
+	}
+
+	void Erase(size_t index)
+	{
+		auto it = LowerBound(index);
+		if (it != entries_.end() && it->index == index)
+			entries_.erase(it);
+	}
+
+	/** @brief Returns the lowest index without an entry, N if all of them have one. */
+	size_t FirstUnused() const
+	{
+		size_t index = 0;
+		while (index < entries_.size() && entries_[index].index == index)
+			index++;
+		return index;
+	}
+
+	bool empty() const
+	{
+		return entries_.empty();
+	}
+
+	void clear()
+	{
+		entries_.clear();
+	}
+
+	typename std::vector<Entry>::iterator begin()
+	{
+		return entries_.begin();
+	}
+
+	typename std::vector<Entry>::iterator end()
+	{
+		return entries_.end();
+	}
+
+	typename std::vector<Entry>::const_iterator begin() const
+	{
+		return entries_.begin();
+	}
+
+	typename std::vector<Entry>::const_iterator end() const
+	{
+		return entries_.end();
+	}
+
+private:
+	typename std::vector<Entry>::iterator LowerBound(size_t index)
+	{
+		return std::lower_bound(entries_.begin(), entries_.end(), index, [](const Entry &entry, size_t i) { return entry.index < i; });
+	}
+
+	std::vector<Entry> entries_;
+};
+
+/** @brief Changes to the items, objects and monsters of a level, the entries are in the same order as the arrays they apply to. */
+struct DLevel {
+	SparseDeltas<TCmdPItem, MAXITEMS> item;
+	SparseDeltas<DObjectStr, MAXOBJECTS> object;
+	SparseDeltas<DMonsterStr, MaxMonsters> monster;
+
+	bool empty() const
+	{
+		return item.empty() && object.empty() && monster.empty();
+	}
+};
+
+/** @brief Size of a level delta on the wire when every entry has changed. */
+constexpr size_t MaxDeltaLevelSize = sizeof(TCmdPItem) * MAXITEMS + sizeof(DObjectStr) * MAXOBJECTS + sizeof(DMonsterStr) * MaxMonsters;
+
 constexpr size_t MAX_MULTIPLAYERLEVELS = NUMLEVELS + SL_LAST;
 constexpr size_t MAX_CHUNKS = MAX_MULTIPLAYERLEVELS + 4;
 
@@ -113,7 +219,7 @@ uint32_t sgdwRecvOffset;
 int sgnCurrMegaPlayer;
 std::unordered_map<uint8_t, DLevel> DeltaLevels;
 uint8_t sbLastCmd;
-byte sgRecvBuf[sizeof(DLevel) + 1];
+byte sgRecvBuf[MaxDeltaLevelSize + 1];
 _cmd_id sgbRecvCmd;
 std::unordered_map<uint8_t, LocalLevel> LocalLevels;
 DJunk sgJunk;
@@ -125,6 +231,10 @@ Item ItemLimbo;
 /** @brief Last sent player command for the local player. */
 TCmdLocParam4 lastSentPlayerCmd;
 
+/** @brief Drops that NetSendDroppedItems hasn't sent yet. */
+TCmdPItem PendingDrops[MaxDropItemsPerCmd];
+size_t NumPendingDrops;
+
 uint8_t GetLevelForMultiplayer(uint8_t level, bool isSetLevel)
 {
 	if (isSetLevel)
@@ -140,9 +250,7 @@ DLevel &GetDeltaLevel(uint8_t level)
 		return keyIt->second;
 	auto emplaceRet = DeltaLevels.emplace(level, DLevel {});
 	assert(emplaceRet.second);
-	DLevel &deltaLevel = emplaceRet.first->second;
-	memset(&deltaLevel, 0xFF, sizeof(DLevel));
-	return deltaLevel;
+	return emplaceRet.first->second;
 }
 
 /** @brief Gets a delta level. */
@@ -302,74 +410,61 @@ int WaitForTurns()
 	return 100 * sgbDeltaChunks / MAX_CHUNKS;
 }
 
-byte *DeltaExportItem(byte *dst, const TCmdPItem *src)
+/**
+ * @brief Exports item or monster deltas, an unchanged entry is a single 0xFF byte.
+ *
+ * Both start with a byte that is 0xFF if the entry is unchanged: the command of an item and the x position of a monster.
+ */
+template <typename T, size_t N>
+byte *DeltaExportEntries(byte *dst, const SparseDeltas<T, N> &src)
 {
-	for (int i = 0; i < MAXITEMS; i++, src++) {
-		if (src->bCmd == CMD_INVALID) {
+	auto it = src.begin();
+	for (size_t i = 0; i < N; i++) {
+		if (it == src.end() || it->index != i) {
 			*dst++ = byte { 0xFF };
-		} else {
-			memcpy(dst, src, sizeof(TCmdPItem));
-			dst += sizeof(TCmdPItem);
+			continue;
 		}
+		memcpy(dst, &it->value, sizeof(T));
+		++it;
+		dst += *dst == byte { 0xFF } ? 1 : sizeof(T);
 	}
 
 	return dst;
 }
 
-size_t DeltaImportItem(const byte *src, TCmdPItem *dst)
+template <typename T, size_t N>
+size_t DeltaImportEntries(const byte *src, SparseDeltas<T, N> &dst)
 {
+	dst.clear();
 	size_t size = 0;
-	for (int i = 0; i < MAXITEMS; i++, dst++) {
+	for (size_t i = 0; i < N; i++) {
 		if (src[size] == byte { 0xFF }) {
-			memset(dst, 0xFF, sizeof(TCmdPItem));
 			size++;
 		} else {
-			memcpy(dst, &src[size], sizeof(TCmdPItem));
-			size += sizeof(TCmdPItem);
+			memcpy(&dst[i], &src[size], sizeof(T));
+			size += sizeof(T);
 		}
 	}
 
 	return size;
 }
 
-byte *DeltaExportObject(byte *dst, const DObjectStr *src)
+byte *DeltaExportObject(byte *dst, const SparseDeltas<DObjectStr, MAXOBJECTS> &src)
 {
-	memcpy(dst, src, sizeof(DObjectStr) * MAXOBJECTS);
+	memset(dst, 0xFF, sizeof(DObjectStr) * MAXOBJECTS);
+	for (const auto &entry : src)
+		memcpy(&dst[sizeof(DObjectStr) * entry.index], &entry.value, sizeof(DObjectStr));
 	return dst + sizeof(DObjectStr) * MAXOBJECTS;
 }
 
-size_t DeltaImportObject(const byte *src, DObjectStr *dst)
+size_t DeltaImportObject(const byte *src, SparseDeltas<DObjectStr, MAXOBJECTS> &dst)
 {
-	memcpy(dst, src, sizeof(DObjectStr) * MAXOBJECTS);
-	return sizeof(DObjectStr) * MAXOBJECTS;
-}
-
-byte *DeltaExportMonster(byte *dst, const DMonsterStr *src)
-{
-	for (size_t i = 0; i < MaxMonsters; i++, src++) {
-		if (src->position.x == 0xFF) {
-			*dst++ = byte { 0xFF };
-		} else {
-			memcpy(dst, src, sizeof(DMonsterStr));
-			dst += sizeof(DMonsterStr);
-		}
-	}
-
-	return dst;
-}
-
-void DeltaImportMonster(const byte *src, DMonsterStr *dst)
-{
-	size_t size = 0;
-	for (size_t i = 0; i < MaxMonsters; i++, dst++) {
-		if (src[size] == byte { 0xFF }) {
-			memset(dst, 0xFF, sizeof(DMonsterStr));
-			size++;
-		} else {
-			memcpy(dst, &src[size], sizeof(DMonsterStr));
-			size += sizeof(DMonsterStr);
-		}
+	dst.clear();
+	for (size_t i = 0; i < MAXOBJECTS; i++) {
+		if (src[sizeof(DObjectStr) * i] != byte { 0xFF })
+			memcpy(&dst[i], &src[sizeof(DObjectStr) * i], sizeof(DObjectStr));
 	}
+	return sizeof(DObjectStr) * MAXOBJECTS;
 }
 
 byte *DeltaExportJunk(byte *dst)
@@ -420,16 +515,6 @@ void DeltaImportJunk(const byte *src)
 	}
 }
 
-uint32_t CompressData(byte *buffer, byte *end)
-{
-	const auto size = static_cast<uint32_t>(end - buffer - 1);
-	const uint32_t pkSize = PkwareCompress(buffer + 1, size);
-
-	*buffer = size != pkSize ? byte { 1 } : byte { 0 };
-
-	return pkSize + 1;
-}
-
 void DeltaImportData(_cmd_id cmd, uint32_t recvOffset)
 {
 	if (sgRecvBuf[0] != byte { 0 })
@@ -442,9 +527,9 @@ void DeltaImportData(_cmd_id cmd, uint32_t recvOffset)
 		uint8_t i = static_cast<uint8_t>(src[0]);
 		src += sizeof(uint8_t);
 		DLevel &deltaLevel = GetDeltaLevel(i);
-		src += DeltaImportItem(src, deltaLevel.item);
+		src += DeltaImportEntries(src, deltaLevel.item);
 		src += DeltaImportObject(src, deltaLevel.object);
-		DeltaImportMonster(src, deltaLevel.monster);
+		DeltaImportEntries(src, deltaLevel.monster);
 	} else {
 		app_fatal(StrCat("Unkown network message type: ", cmd));
 	}
@@ -556,7 +641,8 @@ bool DeltaGetItem(const TCmdGItem &message, uint8_t bLevel)
 
 	DLevel &deltaLevel = GetDeltaLevel(bLevel);
 
-	for (TCmdPItem &item : deltaLevel.item) {
+	for (auto &entry : deltaLevel.item) {
+		TCmdPItem &item = entry.value;
 		if (item.bCmd == CMD_INVALID || item.wIndx != message.wIndx || item.wCI != message.wCI || item.dwSeed != message.dwSeed)
 			continue;
 
@@ -570,7 +656,7 @@ bool DeltaGetItem(const TCmdGItem &message, uint8_t bLevel)
 		}
 		if (item.bCmd == TCmdPItem::DroppedItem) {
 			sgbDeltaChanged = true;
-			item.bCmd = CMD_INVALID;
+			deltaLevel.item.Erase(entry.index);
 			return true;
 		}
 
@@ -580,65 +666,128 @@ bool DeltaGetItem(const TCmdGItem &message, uint8_t bLevel)
 	if ((message.wCI & CF_PREGEN) == 0)
 		return false;
 
-	for (TCmdPItem &item : deltaLevel.item) {
-		if (item.bCmd == CMD_INVALID) {
-			sgbDeltaChanged = true;
-			item.bCmd = TCmdPItem::PickedUpItem;
-			item.x = message.x;
-			item.y = message.y;
-			item.wIndx = message.wIndx;
-			item.wCI = message.wCI;
-			item.dwSeed = message.dwSeed;
-			item.bId = message.bId;
-			item.bDur = message.bDur;
-			item.bMDur = message.bMDur;
-			item.bCh = message.bCh;
-			item.bMCh = message.bMCh;
-			item.wValue = message.wValue;
-			item.dwBuff = message.dwBuff;
-			item.wToHit = message.wToHit;
-			item.wMaxDam = message.wMaxDam;
-			item.bMinStr = message.bMinStr;
-			item.bMinMag = message.bMinMag;
-			item.bMinDex = message.bMinDex;
-			item.bAC = message.bAC;
-			break;
-		}
+	const size_t slot = deltaLevel.item.FirstUnused();
+	if (slot < MAXITEMS) {
+		sgbDeltaChanged = true;
+		TCmdPItem &item = deltaLevel.item[slot];
+		item.bCmd = TCmdPItem::PickedUpItem;
+		item.x = message.x;
+		item.y = message.y;
+		item.wIndx = message.wIndx;
+		item.wCI = message.wCI;
+		item.dwSeed = message.dwSeed;
+		item.bId = message.bId;
+		item.bDur = message.bDur;
+		item.bMDur = message.bMDur;
+		item.bCh = message.bCh;
+		item.bMCh = message.bMCh;
+		item.wValue = message.wValue;
+		item.dwBuff = message.dwBuff;
+		item.wToHit = message.wToHit;
+		item.wMaxDam = message.wMaxDam;
+		item.bMinStr = message.bMinStr;
+		item.bMinMag = message.bMinMag;
+		item.bMinDex = message.bMinDex;
+		item.bAC = message.bAC;
 	}
 	return true;
 }
 
-void DeltaPutItem(const TCmdPItem &message, Point position, const Player &player)
+TCmdPItem PrepareItemForNetwork(_cmd_id bCmd, Point position, const Item &item)
+{
+	TCmdPItem cmd {};
+
+	cmd.bCmd = bCmd;
+	cmd.x = position.x;
+	cmd.y = position.y;
+	cmd.wIndx = item.IDidx;
+
+	if (item.IDidx == IDI_EAR) {
+		cmd.wCI = item._iIName[1] | (item._iIName[0] << 8);
+		cmd.dwSeed = item._iIName[5] | ((item._iIName[4] | ((item._iIName[3] | (item._iIName[2] << 8)) << 8)) << 8);
+		cmd.bId = item._iIName[6];
+		cmd.bDur = item._iIName[7];
+		cmd.bMDur = item._iIName[8];
+		cmd.bCh = item._iIName[9];
+		cmd.bMCh = item._iIName[10];
+		cmd.wValue = item._ivalue | (item._iIName[11] << 8) | ((item._iCurs - ICURS_EAR_SORCERER) << 6);
+		cmd.dwBuff = item._iIName[15] | ((item._iIName[14] | ((item._iIName[13] | (item._iIName[12] << 8)) << 8)) << 8);
+	} else {
+		cmd.wCI = item._iCreateInfo;
+		cmd.dwSeed = item._iSeed;
+		cmd.bId = item._iIdentified ? 1 : 0;
+		cmd.bDur = item._iDurability;
+		cmd.bMDur = item._iMaxDur;
+		cmd.bCh = item._iCharges;
+		cmd.bMCh = item._iMaxCharges;
+		cmd.wValue = item._ivalue;
+		cmd.wToHit = item._iPLToHit;
+		cmd.wMaxDam = item._iMaxDam;
+		cmd.bMinStr = item._iMinStr;
+		cmd.bMinMag = item._iMinMag;
+		cmd.bMinDex = item._iMinDex;
+		cmd.bAC = item._iAC;
+		cmd.dwBuff = item.dwBuff;
+	}
+
+	return cmd;
+}
+
+bool IsSameItem(const TCmdPItem &a, const TCmdPItem &b)
+{
+	return a.wIndx == b.wIndx && a.wCI == b.wCI && a.dwSeed == b.dwSeed;
+}
+
+/**
+ * @brief Records items dropped at their own positions, the existing entries of the level are only scanned once.
+ */
+void DeltaPutItems(const TCmdPItem *messages, size_t count, const Player &player)
 {
 	if (!gbIsMultiplayer)
 		return;
 
 	DLevel &deltaLevel = GetDeltaLevel(player);
 
-	for (const TCmdPItem &item : deltaLevel.item) {
-		if (item.bCmd != TCmdPItem::PickedUpItem
-		    && item.bCmd != CMD_INVALID
-		    && item.wIndx == message.wIndx
-		    && item.wCI == message.wCI
-		    && item.dwSeed == message.dwSeed) {
-			if (item.bCmd == TCmdPItem::DroppedItem)
-				return;
-			app_fatal(_("Trying to drop a floor item?"));
+	bool known[MaxDropItemsPerCmd] = {};
+	for (const auto &entry : deltaLevel.item) {
+		const TCmdPItem &item = entry.value;
+		if (item.bCmd == TCmdPItem::PickedUpItem || item.bCmd == CMD_INVALID)
+			continue;
+		for (size_t i = 0; i < count; i++) {
+			if (known[i] || !IsSameItem(item, messages[i]))
+				continue;
+			if (item.bCmd != TCmdPItem::DroppedItem)
+				app_fatal(_("Trying to drop a floor item?"));
+			known[i] = true;
 		}
 	}
 
-	for (TCmdPItem &item : deltaLevel.item) {
-		if (item.bCmd == CMD_INVALID) {
-			sgbDeltaChanged = true;
-			memcpy(&item, &message, sizeof(TCmdPItem));
-			item.bCmd = TCmdPItem::DroppedItem;
-			item.x = position.x;
-			item.y = position.y;
+	for (size_t i = 0; i < count; i++) {
+		if (known[i])
+			continue;
+		const size_t slot = deltaLevel.item.FirstUnused();
+		if (slot >= MAXITEMS)
 			return;
+		sgbDeltaChanged = true;
+		TCmdPItem &item = deltaLevel.item[slot];
+		memcpy(&item, &messages[i], sizeof(TCmdPItem));
+		item.bCmd = TCmdPItem::DroppedItem;
+		// A batch can carry the same item twice, only the first one is recorded.
+		for (size_t j = i + 1; j < count; j++) {
+			if (IsSameItem(messages[i], messages[j]))
+				known[j] = true;
 		}
 	}
 }
 
+void DeltaPutItem(const TCmdPItem &message, Point position, const Player &player)
+{
+	TCmdPItem item = message;
+	item.x = position.x;
+	item.y = position.y;
+	DeltaPutItems(&item, 1, player);
+}
+
 bool IOwnLevel(const Player &player)
 {
 	for (const Player &other : Players) {
@@ -1736,6 +1885,33 @@ size_t OnDropItem(const TCmd *pCmd, int pnum)
 	return sizeof(message);
 }
 
+size_t OnDropItems(const TCmd *pCmd, int pnum)
+{
+	const auto &message = *reinterpret_cast<const TCmdDropItems *>(pCmd);
+	// The size of the message depends on the count, the rest of the packet can't be parsed without it.
+	if (message.bCount == 0 || message.bCount > MaxDropItemsPerCmd)
+		return 0;
+	const size_t count = message.bCount;
+	const size_t size = offsetof(TCmdDropItems, items) + count * sizeof(message.items[0]);
+
+	if (gbBufferMsgs == 1) {
+		SendPacket(pnum, &message, size);
+	} else {
+		TCmdPItem items[MaxDropItemsPerCmd];
+		size_t numItems = 0;
+		for (size_t i = 0; i < count; i++) {
+			TCmdPItem &item = items[numItems];
+			item.bCmd = CMD_DROPITEM;
+			memcpy(reinterpret_cast<byte *>(&item) + 1, message.items[i], sizeof(message.items[i]));
+			if (IsPItemValid(item))
+				numItems++;
+		}
+		DeltaPutItems(items, numItems, Players[pnum]);
+	}
+
+	return size;
+}
+
 size_t OnSpawnItem(const TCmd *pCmd, int pnum)
 {
 	const auto &message = *reinterpret_cast<const TCmdPItem *>(pCmd);
@@ -2157,25 +2333,30 @@ void run_delta_info()
 
 void DeltaExportData(int pnum)
 {
+	// Exporting is cheap, so it's done here to take a consistent snapshot. The expensive compression is left to the
+	// dthread, which sends each level as soon as it's compressed instead of waiting for all of them.
 	if (sgbDeltaChanged) {
 		for (auto &it : DeltaLevels) {
-			std::unique_ptr<byte[]> dst { new byte[sizeof(DLevel) + 1 + sizeof(uint8_t)] };
+			const DLevel &deltaLevel = it.second;
+			// A level that isn't sent reads as unchanged on the receiving end as well.
+			if (deltaLevel.empty())
+				continue;
+			std::unique_ptr<byte[]> dst { new byte[MaxDeltaLevelSize + 1 + sizeof(uint8_t)] };
 			byte *dstEnd = &dst.get()[1];
-			DLevel &deltaLevel = it.second;
 			*dstEnd = static_cast<byte>(it.first);
 			dstEnd += sizeof(uint8_t);
-			dstEnd = DeltaExportItem(dstEnd, deltaLevel.item);
+			dstEnd = DeltaExportEntries(dstEnd, deltaLevel.item);
 			dstEnd = DeltaExportObject(dstEnd, deltaLevel.object);
-			dstEnd = DeltaExportMonster(dstEnd, deltaLevel.monster);
-			uint32_t size = CompressData(dst.get(), dstEnd);
-			dthread_send_delta(pnum, CMD_DLEVEL, std::move(dst), size);
+			dstEnd = DeltaExportEntries(dstEnd, deltaLevel.monster);
+			const auto size = static_cast<uint32_t>(dstEnd - dst.get());
+			dthread_send_delta(pnum, CMD_DLEVEL, std::move(dst), size, /*compress=*/true);
 		}
 
 		std::unique_ptr<byte[]> dst { new byte[sizeof(DJunk) + 1] };
 		byte *dstEnd = &dst.get()[1];
 		dstEnd = DeltaExportJunk(dstEnd);
-		uint32_t size = CompressData(dst.get(), dstEnd);
-		dthread_send_delta(pnum, CMD_DLEVEL_JUNK, std::move(dst), size);
+		const auto size = static_cast<uint32_t>(dstEnd - dst.get());
+		dthread_send_delta(pnum, CMD_DLEVEL_JUNK, std::move(dst), size, /*compress=*/true);
 	}
 
 	std::unique_ptr<byte[]> src { new byte[1] { static_cast<byte>(0) } };
@@ -2189,6 +2370,7 @@ void delta_init()
 	DeltaLevels.clear();
 	LocalLevels.clear();
 	deltaload = false;
+	NumPendingDrops = 0;
 }
 
 void delta_kill_monster(const Monster &monster, Point position, const Player &player)
@@ -2209,8 +2391,9 @@ void delta_monster_hp(const Monster &monster, const Player &player)
 		return;
 
 	sgbDeltaChanged = true;
-	DMonsterStr *pD = &GetDeltaLevel(player).monster[monster.getId()];
-	if (pD->hitPoints > monster.hitPoints)
+	// An unchanged monster reads as -1 hit points, which never goes down.
+	DMonsterStr *pD = GetDeltaLevel(player).monster.Find(monster.getId());
+	if (pD != nullptr && pD->hitPoints > monster.hitPoints)
 		pD->hitPoints = monster.hitPoints;
 }
 
@@ -2273,7 +2456,8 @@ void DeltaAddItem(int ii)
 	uint8_t localLevel = GetLevelForMultiplayer(*MyPlayer);
 	DLevel &deltaLevel = GetDeltaLevel(localLevel);
 
-	for (const TCmdPItem &item : deltaLevel.item) {
+	for (const auto &entry : deltaLevel.item) {
+		const TCmdPItem &item = entry.value;
 		if (item.bCmd != CMD_INVALID
 		    && item.wIndx == Items[ii].IDidx
 		    && item.wCI == Items[ii]._iCreateInfo
@@ -2283,32 +2467,31 @@ void DeltaAddItem(int ii)
 		}
 	}
 
-	for (TCmdPItem &item : deltaLevel.item) {
-		if (item.bCmd != CMD_INVALID)
-			continue;
-
-		sgbDeltaChanged = true;
-		item.bCmd = TCmdPItem::FloorItem;
-		item.x = Items[ii].position.x;
-		item.y = Items[ii].position.y;
-		item.wIndx = Items[ii].IDidx;
-		item.wCI = Items[ii]._iCreateInfo;
-		item.dwSeed = Items[ii]._iSeed;
-		item.bId = Items[ii]._iIdentified ? 1 : 0;
-		item.bDur = Items[ii]._iDurability;
-		item.bMDur = Items[ii]._iMaxDur;
-		item.bCh = Items[ii]._iCharges;
-		item.bMCh = Items[ii]._iMaxCharges;
-		item.wValue = Items[ii]._ivalue;
-		item.wToHit = Items[ii]._iPLToHit;
-		item.wMaxDam = Items[ii]._iMaxDam;
-		item.bMinStr = Items[ii]._iMinStr;
-		item.bMinMag = Items[ii]._iMinMag;
-		item.bMinDex = Items[ii]._iMinDex;
-		item.bAC = Items[ii]._iAC;
-		item.dwBuff = Items[ii].dwBuff;
+	const size_t slot = deltaLevel.item.FirstUnused();
+	if (slot == MAXITEMS)
 		return;
-	}
+
+	sgbDeltaChanged = true;
+	TCmdPItem &item = deltaLevel.item[slot];
+	item.bCmd = TCmdPItem::FloorItem;
+	item.x = Items[ii].position.x;
+	item.y = Items[ii].position.y;
+	item.wIndx = Items[ii].IDidx;
+	item.wCI = Items[ii]._iCreateInfo;
+	item.dwSeed = Items[ii]._iSeed;
+	item.bId = Items[ii]._iIdentified ? 1 : 0;
+	item.bDur = Items[ii]._iDurability;
+	item.bMDur = Items[ii]._iMaxDur;
+	item.bCh = Items[ii]._iCharges;
+	item.bMCh = Items[ii]._iMaxCharges;
+	item.wValue = Items[ii]._ivalue;
+	item.wToHit = Items[ii]._iPLToHit;
+	item.wMaxDam = Items[ii]._iMaxDam;
+	item.bMinStr = Items[ii]._iMinStr;
+	item.bMinMag = Items[ii]._iMinMag;
+	item.bMinDex = Items[ii]._iMinDex;
+	item.bAC = Items[ii]._iAC;
+	item.dwBuff = Items[ii].dwBuff;
 }
 
 void DeltaSaveLevel()
@@ -2339,9 +2522,11 @@ Point GetItemPosition(Point position)
 		return position;
 
 	for (int k = 1; k < 50; k++) {
+		// The tiles within the ring were all taken for smaller k, so the first free tile of the square is on the ring.
 		for (int j = -k; j <= k; j++) {
 			int yy = position.y + j;
-			for (int l = -k; l <= k; l++) {
+			const int step = (j == -k || j == k) ? 1 : 2 * k;
+			for (int l = -k; l <= k; l += step) {
 				int xx = position.x + l;
 				if (CanPut({ xx, yy }))
 					return { xx, yy };
@@ -2380,23 +2565,26 @@ void DeltaLoadLevel()
 	uint8_t localLevel = GetLevelForMultiplayer(*MyPlayer);
 	DLevel &deltaLevel = GetDeltaLevel(localLevel);
 	if (leveltype != DTYPE_TOWN) {
-		for (size_t i = 0; i < MaxMonsters; i++) {
-			if (deltaLevel.monster[i].position.x == 0xFF)
+		for (const auto &entry : deltaLevel.monster) {
+			const DMonsterStr &delta = entry.value;
+			if (delta.position.x == 0xFF)
 				continue;
 
+			const size_t i = entry.index;
+
 			auto &monster = Monsters[i];
 			M_ClearSquares(monster);
 			{
-				const WorldTilePosition position = deltaLevel.monster[i].position;
+				const WorldTilePosition position = delta.position;
 				monster.position.tile = position;
 				monster.position.old = position;
 				monster.position.future = position;
 			}
-			if (deltaLevel.monster[i].hitPoints != -1) {
-				monster.hitPoints = deltaLevel.monster[i].hitPoints;
-				monster.whoHit = deltaLevel.monster[i].mWhoHit;
+			if (delta.hitPoints != -1) {
+				monster.hitPoints = delta.hitPoints;
+				monster.whoHit = delta.mWhoHit;
 			}
-			if (deltaLevel.monster[i].hitPoints == 0) {
+			if (delta.hitPoints == 0) {
 				M_ClearSquares(monster);
 				if (monster.ai != AI_DIABLO) {
 					if (monster.isUnique()) {
@@ -2408,7 +2596,7 @@ void DeltaLoadLevel()
 				monster.isInvalid = true;
 				M_UpdateRelations(monster);
 			} else {
-				decode_enemy(monster, deltaLevel.monster[i]._menemy);
+				decode_enemy(monster, delta._menemy);
 				if (monster.position.tile != Point { 0, 0 } && monster.position.tile != GolemHoldingCell)
 					dMonster[monster.position.tile.x][monster.position.tile.y] = i + 1;
 				if (monster.type().type == MT_GOLEM) {
@@ -2417,7 +2605,7 @@ void DeltaLoadLevel()
 				} else {
 					M_StartStand(monster, monster.direction);
 				}
-				monster.activeForTicks = deltaLevel.monster[i]._mactive;
+				monster.activeForTicks = delta._mactive;
 			}
 		}
 		auto localLevelIt = LocalLevels.find(localLevel);
@@ -2427,15 +2615,16 @@ void DeltaLoadLevel()
 			memset(AutomapView, 0, sizeof(AutomapView));
 	}
 
-	for (int i = 0; i < MAXITEMS; i++) {
-		if (deltaLevel.item[i].bCmd == CMD_INVALID)
+	for (const auto &entry : deltaLevel.item) {
+		const TCmdPItem &deltaItem = entry.value;
+		if (deltaItem.bCmd == CMD_INVALID)
 			continue;
 
-		if (deltaLevel.item[i].bCmd == TCmdPItem::PickedUpItem) {
+		if (deltaItem.bCmd == TCmdPItem::PickedUpItem) {
 			int activeItemIndex = FindGetItem(
-			    deltaLevel.item[i].dwSeed,
-			    deltaLevel.item[i].wIndx,
-			    deltaLevel.item[i].wCI);
+			    deltaItem.dwSeed,
+			    deltaItem.wIndx,
+			    deltaItem.wCI);
 			if (activeItemIndex != -1) {
 				const auto &position = Items[ActiveItems[activeItemIndex]].position;
 				if (dItem[position.x][position.y] == ActiveItems[activeItemIndex] + 1)
@@ -2443,46 +2632,46 @@ void DeltaLoadLevel()
 				DeleteItem(activeItemIndex);
 			}
 		}
-		if (deltaLevel.item[i].bCmd == TCmdPItem::DroppedItem) {
+		if (deltaItem.bCmd == TCmdPItem::DroppedItem) {
 			int ii = AllocateItem();
 			auto &item = Items[ii];
 
-			if (deltaLevel.item[i].wIndx == IDI_EAR) {
+			if (deltaItem.wIndx == IDI_EAR) {
 				RecreateEar(
 				    item,
-				    deltaLevel.item[i].wCI,
-				    deltaLevel.item[i].dwSeed,
-				    deltaLevel.item[i].bId,
-				    deltaLevel.item[i].bDur,
-				    deltaLevel.item[i].bMDur,
-				    deltaLevel.item[i].bCh,
-				    deltaLevel.item[i].bMCh,
-				    deltaLevel.item[i].wValue,
-				    deltaLevel.item[i].dwBuff);
+				    deltaItem.wCI,
+				    deltaItem.dwSeed,
+				    deltaItem.bId,
+				    deltaItem.bDur,
+				    deltaItem.bMDur,
+				    deltaItem.bCh,
+				    deltaItem.bMCh,
+				    deltaItem.wValue,
+				    deltaItem.dwBuff);
 			} else {
 				RecreateItem(
 				    item,
-				    deltaLevel.item[i].wIndx,
-				    deltaLevel.item[i].wCI,
-				    deltaLevel.item[i].dwSeed,
-				    deltaLevel.item[i].wValue,
-				    (deltaLevel.item[i].dwBuff & CF_HELLFIRE) != 0);
-				if (deltaLevel.item[i].bId != 0)
+				    deltaItem.wIndx,
+				    deltaItem.wCI,
+				    deltaItem.dwSeed,
+				    deltaItem.wValue,
+				    (deltaItem.dwBuff & CF_HELLFIRE) != 0);
+				if (deltaItem.bId != 0)
 					item._iIdentified = true;
-				item._iDurability = deltaLevel.item[i].bDur;
-				item._iMaxDur = deltaLevel.item[i].bMDur;
-				item._iCharges = deltaLevel.item[i].bCh;
-				item._iMaxCharges = deltaLevel.item[i].bMCh;
-				item._iPLToHit = deltaLevel.item[i].wToHit;
-				item._iMaxDam = deltaLevel.item[i].wMaxDam;
-				item._iMinStr = deltaLevel.item[i].bMinStr;
-				item._iMinMag = deltaLevel.item[i].bMinMag;
-				item._iMinDex = deltaLevel.item[i].bMinDex;
-				item._iAC = deltaLevel.item[i].bAC;
-				item.dwBuff = deltaLevel.item[i].dwBuff;
+				item._iDurability = deltaItem.bDur;
+				item._iMaxDur = deltaItem.bMDur;
+				item._iCharges = deltaItem.bCh;
+				item._iMaxCharges = deltaItem.bMCh;
+				item._iPLToHit = deltaItem.wToHit;
+				item._iMaxDam = deltaItem.wMaxDam;
+				item._iMinStr = deltaItem.bMinStr;
+				item._iMinMag = deltaItem.bMinMag;
+				item._iMinDex = deltaItem.bMinDex;
+				item._iAC = deltaItem.bAC;
+				item.dwBuff = deltaItem.dwBuff;
 			}
-			int x = deltaLevel.item[i].x;
-			int y = deltaLevel.item[i].y;
+			int x = deltaItem.x;
+			int y = deltaItem.y;
 			item.position = GetItemPosition({ x, y });
 			dItem[item.position.x][item.position.y] = ii + 1;
 			RespawnItem(Items[ii], false);
@@ -2490,13 +2679,14 @@ void DeltaLoadLevel()
 	}
 
 	if (leveltype != DTYPE_TOWN) {
-		for (int i = 0; i < MAXOBJECTS; i++) {
-			switch (deltaLevel.object[i].bCmd) {
+		for (const auto &entry : deltaLevel.object) {
+			const int i = entry.index;
+			switch (entry.value.bCmd) {
 			case CMD_OPENDOOR:
 			case CMD_CLOSEDOOR:
 			case CMD_OPERATEOBJ:
 			case CMD_PLROPOBJ:
-				DeltaSyncOpObject(deltaLevel.object[i].bCmd, i);
+				DeltaSyncOpObject(entry.value.bCmd, i);
 				break;
 			case CMD_BREAKOBJ:
 				DeltaSyncBreakObj(Objects[i]);
@@ -2774,40 +2964,7 @@ void NetSendCmdGItem(bool bHiPri, _cmd_id bCmd, uint8_t pnum, uint8_t ii)
 
 void NetSendCmdPItem(bool bHiPri, _cmd_id bCmd, Point position, const Item &item)
 {
-	TCmdPItem cmd {};
-
-	cmd.bCmd = bCmd;
-	cmd.x = position.x;
-	cmd.y = position.y;
-	cmd.wIndx = item.IDidx;
-
-	if (item.IDidx == IDI_EAR) {
-		cmd.wCI = item._iIName[1] | (item._iIName[0] << 8);
-		cmd.dwSeed = item._iIName[5] | ((item._iIName[4] | ((item._iIName[3] | (item._iIName[2] << 8)) << 8)) << 8);
-		cmd.bId = item._iIName[6];
-		cmd.bDur = item._iIName[7];
-		cmd.bMDur = item._iIName[8];
-		cmd.bCh = item._iIName[9];
-		cmd.bMCh = item._iIName[10];
-		cmd.wValue = item._ivalue | (item._iIName[11] << 8) | ((item._iCurs - ICURS_EAR_SORCERER) << 6);
-		cmd.dwBuff = item._iIName[15] | ((item._iIName[14] | ((item._iIName[13] | (item._iIName[12] << 8)) << 8)) << 8);
-	} else {
-		cmd.wCI = item._iCreateInfo;
-		cmd.dwSeed = item._iSeed;
-		cmd.bId = item._iIdentified ? 1 : 0;
-		cmd.bDur = item._iDurability;
-		cmd.bMDur = item._iMaxDur;
-		cmd.bCh = item._iCharges;
-		cmd.bMCh = item._iMaxCharges;
-		cmd.wValue = item._ivalue;
-		cmd.wToHit = item._iPLToHit;
-		cmd.wMaxDam = item._iMaxDam;
-		cmd.bMinStr = item._iMinStr;
-		cmd.bMinMag = item._iMinMag;
-		cmd.bMinDex = item._iMinDex;
-		cmd.bAC = item._iAC;
-		cmd.dwBuff = item.dwBuff;
-	}
+	const TCmdPItem cmd = PrepareItemForNetwork(bCmd, position, item);
 
 	ItemLimbo = item;
 
@@ -2817,6 +2974,34 @@ void NetSendCmdPItem(bool bHiPri, _cmd_id bCmd, Point position, const Item &item
 		NetSendLoPri(MyPlayerId, (byte *)&cmd, sizeof(cmd));
 }
 
+void NetSendCmdDropItem(Point position, const Item &item)
+{
+	if (NumPendingDrops == MaxDropItemsPerCmd)
+		NetSendDroppedItems();
+	PendingDrops[NumPendingDrops++] = PrepareItemForNetwork(CMD_DROPITEM, position, item);
+	ItemLimbo = item;
+}
+
+void NetSendDroppedItems()
+{
+	// Cleared first, NetSendLoPri sends the pending drops before anything else.
+	const size_t count = NumPendingDrops;
+	NumPendingDrops = 0;
+	if (count == 0)
+		return;
+
+	if (count == 1) {
+		NetSendLoPri(MyPlayerId, (byte *)&PendingDrops[0], sizeof(PendingDrops[0]));
+	} else {
+		TCmdDropItems cmd;
+		cmd.bCmd = CMD_DROPITEMS;
+		cmd.bCount = static_cast<uint8_t>(count);
+		for (size_t i = 0; i < count; i++)
+			memcpy(cmd.items[i], reinterpret_cast<const byte *>(&PendingDrops[i]) + 1, sizeof(cmd.items[i]));
+		NetSendLoPri(MyPlayerId, (byte *)&cmd, offsetof(TCmdDropItems, items) + count * sizeof(cmd.items[0]));
+	}
+}
+
 void NetSendCmdChItem(bool bHiPri, uint8_t bLoc)
 {
 	TCmdChItem cmd;
@@ -3051,6 +3236,8 @@ size_t ParseCmd(int pnum, const TCmd *pCmd)
 		return OnOpenHive(pCmd, pnum);
 	case CMD_OPENCRYPT:
 		return OnOpenCrypt(pCmd);
+	case CMD_DROPITEMS:
+		return OnDropItems(pCmd, pnum);
 	default:
 		break;
 	}
@@ -433,6 +433,10 @@ enum _cmd_id : uint8_t {
 	//
 	// body (TFakeDropPlr)
 	FAKE_CMD_DROPID,
+	// Drop items that were spawned in the same game tick, sent instead of a burst of CMD_DROPITEM.
+	//
+	// body (TCmdDropItems)
+	CMD_DROPITEMS,
 	NUM_CMDS,
 	CMD_INVALID = 0xFF,
 };
@@ -600,6 +604,23 @@ struct TCmdPItem {
 	static constexpr _cmd_id DroppedItem = CMD_ACK_PLRINFO;
 };
 
+/**
+ * Most items a TCmdDropItems can hold, the network buffers store the size of a message in a single byte
+ */
+constexpr size_t MaxDropItemsPerCmd = (UINT8_MAX - 2) / (sizeof(TCmdPItem) - 1);
+
+/**
+ * Represents several items being dropped onto the ground, e.g. the loot of a boss
+ */
+struct TCmdDropItems {
+	_cmd_id bCmd;
+	uint8_t bCount;
+	/**
+	 * The items as TCmdPItem without their bCmd, only the first bCount are sent
+	 */
+	byte items[MaxDropItemsPerCmd][sizeof(TCmdPItem) - 1];
+};
+
 struct TCmdChItem {
 	_cmd_id bCmd;
 	uint8_t bLoc;
@@ -745,6 +766,15 @@ void NetSendCmdParam4(bool bHiPri, _cmd_id bCmd, uint16_t wParam1, uint16_t wPar
 void NetSendCmdQuest(bool bHiPri, const Quest &quest);
 void NetSendCmdGItem(bool bHiPri, _cmd_id bCmd, uint8_t pnum, uint8_t ii);
 void NetSendCmdPItem(bool bHiPri, _cmd_id bCmd, Point position, const Item &item);
+/**
+ * @brief Like NetSendCmdPItem(false, CMD_DROPITEM, ...), but the drops are sent together by NetSendDroppedItems.
+ */
+void NetSendCmdDropItem(Point position, const Item &item);
+/**
+ * @brief Sends the drops queued by NetSendCmdDropItem, called at the end of every game tick and before any other
+ * command is sent so that the drops keep their place in the order of the commands.
+ */
+void NetSendDroppedItems();
 void NetSendCmdChItem(bool bHiPri, uint8_t bLoc);
 void NetSendCmdDelItem(bool bHiPri, uint8_t bLoc);
 void NetSendCmdDamage(bool bHiPri, uint8_t bPlr, uint32_t dwDam);
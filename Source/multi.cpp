@@ -4,6 +4,8 @@
  * Implementation of functions for keeping multiplaye games in sync.
  */
 
+#include <algorithm>
+
 #include <SDL.h>
 #include <config.h>
 
@@ -75,6 +77,18 @@ namespace {
 
 uint32_t sgbSentThisCycle;
 
+/**
+ * @brief Messages to a single player that are sent together once the destination changes, the packet is full or the
+ * packets are processed. Saves a packet for every message when many commands are issued in one tick.
+ */
+struct PendingPacket {
+	TPkt pkt;
+	int playerId;
+	size_t bodySize;
+};
+
+PendingPacket sgPendingPacket;
+
 void BufferInit(TBuffer *pBuf)
 {
 	pBuf->dwNextWriteOffset = 0;
@@ -179,17 +193,30 @@ void CheckPlayerInfoTimeouts()
 	}
 }
 
-void SendPacket(int playerId, const byte *packet, size_t size)
+void FlushPendingPacket()
 {
-	TPkt pkt;
+	if (sgPendingPacket.bodySize == 0)
+		return;
 
+	TPkt &pkt = sgPendingPacket.pkt;
 	NetReceivePlayerData(&pkt);
-	pkt.hdr.wLen = static_cast<uint16_t>(size + sizeof(pkt.hdr));
-	memcpy(pkt.body, packet, size);
-	if (!SNetSendMessage(playerId, &pkt.hdr, pkt.hdr.wLen))
+	pkt.hdr.wLen = static_cast<uint16_t>(sgPendingPacket.bodySize + sizeof(pkt.hdr));
+	sgPendingPacket.bodySize = 0;
+	if (!SNetSendMessage(sgPendingPacket.playerId, &pkt.hdr, pkt.hdr.wLen))
 		nthread_terminate_game("SNetSendMessage0");
 }
 
+void SendPacket(int playerId, const byte *packet, size_t size)
+{
+	const size_t maxBodySize = std::min<size_t>(gdwLargestMsgSize - sizeof(TPktHdr), sizeof(TPkt::body));
+	if (sgPendingPacket.playerId != playerId || sgPendingPacket.bodySize + size > maxBodySize)
+		FlushPendingPacket();
+
+	sgPendingPacket.playerId = playerId;
+	memcpy(&sgPendingPacket.pkt.body[sgPendingPacket.bodySize], packet, size);
+	sgPendingPacket.bodySize += size;
+}
+
 void MonsterSeeds()
 {
 	sgdwGameLoops++;
@@ -476,10 +503,12 @@ void InitGameInfo()
 	sgGameInitInfo.bTheoQuest = *sgOptions.Gameplay.theoQuest ? 1 : 0;
 	sgGameInitInfo.bCowQuest = *sgOptions.Gameplay.cowQuest ? 1 : 0;
 	sgGameInitInfo.bFriendlyFire = *sgOptions.Gameplay.friendlyFire ? 1 : 0;
+	sgGameInitInfo.protocolVersion = NetworkProtocolVersion;
 }
 
 void NetSendLoPri(int playerId, const byte *data, size_t size)
 {
+	NetSendDroppedItems();
 	if (data != nullptr && size != 0) {
 		CopyPacket(&sgLoPriBuf, data, size);
 		SendPacket(playerId, data, size);
@@ -488,12 +517,14 @@ void NetSendLoPri(int playerId, const byte *data, size_t size)
 
 void NetSendHiPri(int playerId, const byte *data, size_t size)
 {
+	NetSendDroppedItems();
 	if (data != nullptr && size != 0) {
 		CopyPacket(&sgHiPriBuf, data, size);
 		SendPacket(playerId, data, size);
 	}
 	if (!gbShouldValidatePackage) {
 		gbShouldValidatePackage = true;
+		FlushPendingPacket();
 		TPkt pkt;
 		NetReceivePlayerData(&pkt);
 		size_t msgSize = gdwNormalMsgSize - sizeof(TPktHdr);
@@ -509,6 +540,8 @@ void NetSendHiPri(int playerId, const byte *data, size_t size)
 
 void multi_send_msg_packet(uint32_t pmask, const byte *data, size_t size)
 {
+	NetSendDroppedItems();
+	FlushPendingPacket();
 	TPkt pkt;
 	NetReceivePlayerData(&pkt);
 	size_t len = size + sizeof(pkt.hdr);
@@ -548,6 +581,24 @@ void multi_net_ping()
 	sglTimeoutStart = SDL_GetTicks();
 }
 
+std::string multi_format_network_stats()
+{
+	NetworkStats stats;
+	if (!gbIsMultiplayer || !DvlNet_GetNetworkStats(stats))
+		return {};
+
+	std::string text;
+	for (int i = 0; i < MAX_PLRS; i++) {
+		const PeerNetworkStats &peer = stats.peers[i];
+		if (!peer.connected)
+			continue;
+		StrAppend(text, "Player ", i, ": ", peer.roundTripLatency, " ms, jitter ", peer.jitter, " ms, loss ", peer.packetLoss, "%, ",
+		    peer.bytesReceivedPerSecond, " B/s in\n");
+	}
+	StrAppend(text, "Sent: ", stats.bytesSentPerSecond, " B/s");
+	return text;
+}
+
 bool multi_handle_delta()
 {
 	if (gbGameDestroyed) {
@@ -562,6 +613,7 @@ bool multi_handle_delta()
 		}
 	}
 
+	FlushPendingPacket();
 	sgbSentThisCycle = nthread_send_and_recv_turn(sgbSentThisCycle, 1);
 	bool received;
 	if (!nthread_recv_turns(&received)) {
@@ -593,7 +645,12 @@ void multi_process_network_packets()
 	int dwID = -1;
 	TPktHdr *pkt;
 	uint32_t dwMsgSize = 0;
-	while (SNetReceiveMessage(&dwID, (void **)&pkt, &dwMsgSize)) {
+	// Flushing before every message lets the commands issued while handling one arrive in the same call, as they did
+	// before they were batched.
+	while (true) {
+		FlushPendingPacket();
+		if (!SNetReceiveMessage(&dwID, (void **)&pkt, &dwMsgSize))
+			break;
 		dwRecCount++;
 		ClearPlayerLeftState();
 		if (dwMsgSize < sizeof(TPktHdr))
@@ -657,38 +714,37 @@ void multi_process_network_packets()
 	CheckPlayerInfoTimeouts();
 }
 
-void multi_send_zero_packet(int pnum, _cmd_id bCmd, const byte *data, size_t size)
+size_t multi_send_zero_packet(int pnum, _cmd_id bCmd, const byte *data, size_t size, size_t offset)
 {
 	assert(pnum != MyPlayerId);
 	assert(data != nullptr);
 	assert(size <= 0x0ffff);
+	assert(offset < size);
 
-	for (size_t offset = 0; offset < size;) {
-		TPkt pkt {};
-		pkt.hdr.wCheck = LoadBE32("\0\0ip");
-		auto &message = *reinterpret_cast<TCmdPlrInfoHdr *>(pkt.body);
-		message.bCmd = bCmd;
-		message.wOffset = offset;
+	TPkt pkt {};
+	pkt.hdr.wCheck = LoadBE32("\0\0ip");
+	auto &message = *reinterpret_cast<TCmdPlrInfoHdr *>(pkt.body);
+	message.bCmd = bCmd;
+	message.wOffset = offset;
 
-		size_t dwBody = gdwLargestMsgSize - sizeof(pkt.hdr) - sizeof(message);
-		dwBody = std::min(dwBody, size - offset);
-		assert(dwBody <= 0x0ffff);
-		message.wBytes = dwBody;
+	size_t dwBody = gdwLargestMsgSize - sizeof(pkt.hdr) - sizeof(message);
+	dwBody = std::min(dwBody, size - offset);
+	assert(dwBody <= 0x0ffff);
+	message.wBytes = dwBody;
 
-		memcpy(&pkt.body[sizeof(message)], &data[offset], message.wBytes);
+	memcpy(&pkt.body[sizeof(message)], &data[offset], message.wBytes);
 
-		size_t dwMsg = sizeof(pkt.hdr);
-		dwMsg += sizeof(message);
-		dwMsg += message.wBytes;
-		pkt.hdr.wLen = dwMsg;
+	size_t dwMsg = sizeof(pkt.hdr);
+	dwMsg += sizeof(message);
+	dwMsg += message.wBytes;
+	pkt.hdr.wLen = dwMsg;
 
-		if (!SNetSendMessage(pnum, &pkt, dwMsg)) {
-			nthread_terminate_game("SNetSendMessage2");
-			return;
-		}
-
-		offset += message.wBytes;
+	if (!SNetSendMessage(pnum, &pkt, dwMsg)) {
+		nthread_terminate_game("SNetSendMessage2");
+		return 0;
 	}
+
+	return message.wBytes;
 }
 
 void NetClose()
@@ -698,6 +754,7 @@ void NetClose()
 	}
 
 	sgbNetInited = false;
+	sgPendingPacket.bodySize = 0;
 	nthread_cleanup();
 	DThreadCleanup();
 	tmsg_cleanup();
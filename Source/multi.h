@@ -17,6 +17,12 @@ namespace devilution {
 // must be unsigned to generate unsigned comparisons with pnum
 #define MAX_PLRS 4
 
+/**
+ * @brief Version of the game messages, increased whenever a command is added or changed so that builds reporting the
+ * same project version (e.g. untagged builds) don't join games they can't talk to.
+ */
+constexpr uint8_t NetworkProtocolVersion = 1;
+
 struct GameData {
 	int32_t size;
 	/** Used to initialise the seed table for dungeon levels so players in multiplayer games generate the same layout */
@@ -31,6 +37,8 @@ struct GameData {
 	uint8_t bTheoQuest;
 	uint8_t bCowQuest;
 	uint8_t bFriendlyFire;
+	/** Takes the place of the padding, older builds leave this at 0. See NetworkProtocolVersion */
+	uint8_t protocolVersion;
 };
 
 /* @brief Contains info of running public game (for game list browsing) */
@@ -61,12 +69,22 @@ void multi_msg_countdown();
 void multi_player_left(int pnum, int reason);
 void multi_net_ping();
 
+/**
+ * @brief Describes the latency and bandwidth of the connection to each player, one player per line.
+ * @return An empty string if there aren't any stats, e.g. in single player games.
+ */
+std::string multi_format_network_stats();
+
 /**
  * @return Always true for singleplayer
  */
 bool multi_handle_delta();
 void multi_process_network_packets();
-void multi_send_zero_packet(int pnum, _cmd_id bCmd, const byte *data, size_t size);
+/**
+ * @brief Sends the chunk of data starting at offset that fits into one message.
+ * @return The size of the chunk that was sent, 0 if sending failed.
+ */
+size_t multi_send_zero_packet(int pnum, _cmd_id bCmd, const byte *data, size_t size, size_t offset);
 void NetClose();
 bool NetInit(bool bSinglePlayer);
 void recv_plrinfo(int pnum, const TCmdPlrInfoHdr &header, bool recv);
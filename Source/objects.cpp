@@ -19,10 +19,12 @@
 #endif
 #include "engine/load_cel.hpp"
 #include "engine/load_file.hpp"
+#include "engine/path.h"
 #include "engine/points_in_rectangle_range.hpp"
 #include "engine/random.hpp"
 #include "error.h"
 #include "init.h"
+#include "interfac.h"
 #include "inv.h"
 #include "inv_iterators.hpp"
 #include "levels/crypt.h"
@@ -53,6 +55,13 @@ bool LoadingMapObjects;
 
 namespace {
 
+/** @brief Positions in ActiveObjects of the objects that ProcessObjects has to update, in ascending order. */
+int TickingObjects[MAXOBJECTS];
+int TickingObjectCount;
+bool TickingObjectsValid;
+/** @brief Whether a loaded object is flagged for deletion, nothing else ever sets _oDelFlag. */
+bool ObjectsPendingDeletion;
+
 enum shrine_type : uint8_t {
 	ShrineMysterious,
 	ShrineHidden,
@@ -413,6 +422,7 @@ void ClrAllObjects()
 		AvailableObjects[i] = i;
 	}
 	memset(ActiveObjects, 0, sizeof(ActiveObjects));
+	InvalidateTickingObjects();
 	trapdir = 0;
 	trapid = 1;
 	leverid = 1;
@@ -815,6 +825,7 @@ void AddCryptBook(_object_id ot, int v2, Point position)
 	SetupObject(object, position, ot);
 	AddCryptObject(object, v2);
 	ActiveObjectCount++;
+	InvalidateTickingObjects();
 }
 
 void AddCryptStoryBook(int s)
@@ -983,6 +994,7 @@ void DeleteObject(int oi, int i)
 		ObjectUnderCursor = nullptr;
 	if (ActiveObjectCount > 0 && i != ActiveObjectCount)
 		ActiveObjects[i] = ActiveObjects[ActiveObjectCount];
+	InvalidateTickingObjects();
 }
 
 void AddChest(Object &chest, _object_id type)
@@ -1024,6 +1036,8 @@ void AddChest(Object &chest, _object_id type)
 void ObjSetMicro(Point position, int pn)
 {
 	dPiece[position.x][position.y] = pn;
+	InvalidatePathDistanceFields();
+	InvalidateVisionCache();
 }
 
 void InitializeL1Door(Object &door)
@@ -1456,6 +1470,7 @@ void ActivateTrapLine(int ttype, int tid)
 			Objects[oi]._oAnimFlag = true;
 			Objects[oi]._oAnimDelay = 1;
 			Objects[oi]._olid = AddLight(Objects[oi].position, 1);
+			InvalidateTickingObjects();
 		}
 	}
 }
@@ -2487,6 +2502,7 @@ void OperateTrapLever(Object &flameLever)
 			target._oVar2 = 0;
 			if (target._oVar4 != 0) {
 				target._oAnimFlag = true;
+				InvalidateTickingObjects();
 			}
 		}
 	}
@@ -4001,8 +4017,99 @@ void UpdateState(Object &object, int frame)
 	object._oAnimFlag = false;
 }
 
+void MarkLevelObjectFiles(int level, dungeon_type levelType, uint16_t filesWidths[65])
+{
+	if (IsAnyOf(level, 4, 8, 12)) {
+		filesWidths[OFILE_BKSLBRNT] = AllObjects[OBJ_STORYBOOK].oAnimWidth;
+		filesWidths[OFILE_CANDLE2] = AllObjects[OBJ_STORYCANDLE].oAnimWidth;
+	}
+
+	for (const ObjectData objectData : AllObjects) {
+		if (objectData.ominlvl != 0 && level >= objectData.ominlvl && level <= objectData.omaxlvl) {
+			if (IsAnyOf(objectData.ofindex, OFILE_TRAPHOLE, OFILE_TRAPHOLE) && levelType == DTYPE_HELL) {
+				continue;
+			}
+
+			filesWidths[objectData.ofindex] = objectData.oAnimWidth;
+		}
+	}
+}
+
+/**
+ * @brief Whether ProcessObjects updates objects of this type even when they aren't animated, keep in sync with the
+ * switch there.
+ */
+bool HasPerTickUpdate(_object_id type)
+{
+	switch (type) {
+	case OBJ_L1LIGHT:
+	case OBJ_SKFIRE:
+	case OBJ_CANDLE2:
+	case OBJ_BOOKCANDLE:
+	case OBJ_STORYCANDLE:
+	case OBJ_L5CANDLE:
+	case OBJ_CRUX1:
+	case OBJ_CRUX2:
+	case OBJ_CRUX3:
+	case OBJ_BARREL:
+	case OBJ_BARRELEX:
+	case OBJ_POD:
+	case OBJ_PODEX:
+	case OBJ_URN:
+	case OBJ_URNEX:
+	case OBJ_SHRINEL:
+	case OBJ_SHRINER:
+	case OBJ_L1LDOOR:
+	case OBJ_L1RDOOR:
+	case OBJ_L2LDOOR:
+	case OBJ_L2RDOOR:
+	case OBJ_L3LDOOR:
+	case OBJ_L3RDOOR:
+	case OBJ_L5LDOOR:
+	case OBJ_L5RDOOR:
+	case OBJ_TORCHL:
+	case OBJ_TORCHR:
+	case OBJ_TORCHL2:
+	case OBJ_TORCHR2:
+	case OBJ_SARC:
+	case OBJ_L5SARC:
+	case OBJ_FLAMEHOLE:
+	case OBJ_TRAPL:
+	case OBJ_TRAPR:
+	case OBJ_MCIRCLE1:
+	case OBJ_MCIRCLE2:
+	case OBJ_BCROSS:
+	case OBJ_TBCROSS:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * @brief Collects the objects that ProcessObjects has to visit, the others neither have a per-tick update nor are
+ * animated, and only start animating through the functions that invalidate the list.
+ */
+void UpdateTickingObjects()
+{
+	TickingObjectCount = 0;
+	for (int i = 0; i < ActiveObjectCount; i++) {
+		const Object &object = Objects[ActiveObjects[i]];
+		if (object._oAnimFlag || HasPerTickUpdate(object._otype))
+			TickingObjects[TickingObjectCount++] = i;
+		if (object._oDelFlag)
+			ObjectsPendingDeletion = true;
+	}
+	TickingObjectsValid = true;
+}
+
 } // namespace
 
+void InvalidateTickingObjects()
+{
+	TickingObjectsValid = false;
+}
+
 unsigned int Object::GetId() const
 {
 	return abs(dObject[position.x][position.y]) - 1;
@@ -4080,6 +4187,7 @@ void LoadLevelObjects(uint16_t filesWidths[65])
 			continue;
 		}
 
+		ProgressPump();
 		ObjFileList[numobjfiles] = static_cast<object_graphic_id>(i);
 		char filestr[32];
 		*BufCopy(filestr, "Objects\\", ObjMasterLoadList[i], ".CEL") = '\0';
@@ -4092,19 +4200,9 @@ void InitObjectGFX()
 {
 	uint16_t filesWidths[65] = {};
 
-	if (IsAnyOf(currlevel, 4, 8, 12)) {
-		filesWidths[OFILE_BKSLBRNT] = AllObjects[OBJ_STORYBOOK].oAnimWidth;
-		filesWidths[OFILE_CANDLE2] = AllObjects[OBJ_STORYCANDLE].oAnimWidth;
-	}
+	MarkLevelObjectFiles(currlevel, leveltype, filesWidths);
 
 	for (const ObjectData objectData : AllObjects) {
-		if (objectData.ominlvl != 0 && currlevel >= objectData.ominlvl && currlevel <= objectData.omaxlvl) {
-			if (IsAnyOf(objectData.ofindex, OFILE_TRAPHOLE, OFILE_TRAPHOLE) && leveltype == DTYPE_HELL) {
-				continue;
-			}
-
-			filesWidths[objectData.ofindex] = objectData.oAnimWidth;
-		}
 		if (objectData.otheme != THEME_NONE) {
 			for (int j = 0; j < numthemes; j++) {
 				if (themes[j].ttype == objectData.otheme) {
@@ -4121,6 +4219,22 @@ void InitObjectGFX()
 	LoadLevelObjects(filesWidths);
 }
 
+void AddLevelObjectFiles(int level, dungeon_type levelType, std::vector<std::string> &files)
+{
+	uint16_t filesWidths[65] = {};
+	MarkLevelObjectFiles(level, levelType, filesWidths);
+	// The same files as loaded by LoadLevelObjects
+	for (const ObjectData objectData : AllObjects) {
+		if (levelType == objectData.olvltype) {
+			filesWidths[objectData.ofindex] = objectData.oAnimWidth;
+		}
+	}
+	for (int i = OFILE_L1BRAZ; i <= OFILE_L5BOOKS; i++) {
+		if (filesWidths[i] != 0)
+			files.push_back(StrCat("Objects\\", ObjMasterLoadList[i], ".CEL"));
+	}
+}
+
 void FreeObjectGFX()
 {
 	for (int i = 0; i < numobjfiles; i++) {
@@ -4546,6 +4660,7 @@ void AddObject(_object_id objType, Point objPos)
 		break;
 	}
 	ActiveObjectCount++;
+	InvalidateTickingObjects();
 }
 
 void OperateTrap(Object &trap)
@@ -4602,7 +4717,17 @@ void OperateTrap(Object &trap)
 
 void ProcessObjects()
 {
-	for (int i = 0; i < ActiveObjectCount; ++i) {
+	int previous = -1;
+	for (int t = 0;; ++t) {
+		if (!TickingObjectsValid) {
+			// Objects were added or started animating, carry on with the ones after the last object that was updated.
+			UpdateTickingObjects();
+			t = static_cast<int>(std::upper_bound(TickingObjects, TickingObjects + TickingObjectCount, previous) - TickingObjects);
+		}
+		if (t >= TickingObjectCount)
+			break;
+		const int i = TickingObjects[t];
+		previous = i;
 		Object &object = Objects[ActiveObjects[i]];
 		switch (object._otype) {
 		case OBJ_L1LIGHT:
@@ -4683,6 +4808,8 @@ void ProcessObjects()
 			object._oAnimFrame = 1;
 	}
 
+	if (!ObjectsPendingDeletion)
+		return;
 	for (int i = 0; i < ActiveObjectCount;) {
 		int oi = ActiveObjects[i];
 		if (Objects[oi]._oDelFlag) {
@@ -4691,6 +4818,7 @@ void ProcessObjects()
 			i++;
 		}
 	}
+	ObjectsPendingDeletion = false;
 }
 
 void RedoPlayerVision()
@@ -5389,6 +5517,8 @@ void SyncNakrulRoom()
 	dPiece[UberRow][UberCol - 1] = 300;
 	dPiece[UberRow][UberCol - 2] = 299;
 	dPiece[UberRow][UberCol + 1] = 298;
+	InvalidatePathDistanceFields();
+	InvalidateVisionCache();
 }
 
 void AddNakrulLeaver()
@@ -6,6 +6,8 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
+#include <vector>
 
 #include "engine/point.hpp"
 #include "engine/rectangle.hpp"
@@ -285,6 +287,10 @@ inline bool IsObjectAtPosition(Point position)
 bool IsItemBlockingObjectAtPosition(Point position);
 
 void InitObjectGFX();
+/**
+ * @brief Adds the object sprites that the given level loads regardless of its themes and quests.
+ */
+void AddLevelObjectFiles(int level, dungeon_type levelType, std::vector<std::string> &files);
 void FreeObjectGFX();
 void AddL1Objs(int x1, int y1, int x2, int y2);
 void AddL2Objs(int x1, int y1, int x2, int y2);
@@ -299,6 +305,11 @@ void SetMapObjects(const uint16_t *dunData, int startx, int starty);
  */
 void AddObject(_object_id objType, Point objPos);
 void OperateTrap(Object &trap);
+/**
+ * @brief Has to be called when ActiveObjects changes or an object that was neither animated nor updated every tick
+ * starts animating, so that ProcessObjects visits it.
+ */
+void InvalidateTickingObjects();
 void ProcessObjects();
 void RedoPlayerVision();
 void MonstCheckDoors(Monster &monster);
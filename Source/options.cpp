@@ -4,8 +4,11 @@
  * Load and save options from the diablo.ini file.
  */
 
+#include <array>
+#include <chrono>
 #include <cstdint>
 #include <fstream>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -16,17 +19,23 @@
 #include "control.h"
 #include "discord/discord.h"
 #include "engine/demomode.h"
+#include "engine/render/text_render.hpp"
 #include "engine/sound_defs.hpp"
 #include "hwcursor.hpp"
+#include "items.h"
+#include "lighting.h"
 #include "options.h"
 #include "platform/locale.hpp"
 #include "qol/monhealthbar.h"
 #include "qol/xpbar.h"
 #include "utils/display.h"
 #include "utils/file_util.h"
+#include "utils/job_system.hpp"
 #include "utils/language.h"
 #include "utils/log.hpp"
+#include "utils/memory_budget.hpp"
 #include "utils/paths.h"
+#include "utils/perf_scope.hpp"
 #include "utils/stdcompat/algorithm.hpp"
 #include "utils/str_cat.hpp"
 #include "utils/utf8.hpp"
@@ -290,6 +299,8 @@ void OptionLanguageCodeChanged()
 {
 	LanguageInitialize();
 	LoadLanguageArchive();
+	// The line height of the small font depends on the language.
+	ClearTextLayoutCache();
 }
 
 void OptionGameModeChanged()
@@ -316,6 +327,106 @@ void OptionAudioChanged()
 		ui_sound_init();
 }
 
+/** @brief Set while a profile changes the options it controls, so that they don't switch the profile to Custom. */
+bool ApplyingPerformanceProfile = false;
+
+struct PerformanceTier {
+	int renderThreads;
+	int fontCache;
+	int monsterGraphics;
+	int tilesets;
+	int townerGraphics;
+	int soundBank;
+	int soundVoices;
+	int itemLabels;
+	int lightBudget;
+	int workerThreads;
+};
+
+PerformanceTier GetPerformanceTier(PerformanceProfile profile)
+{
+	constexpr int MiB = 1024 * 1024;
+	switch (profile) {
+	case PerformanceProfile::Low:
+		return { 1, DEVILUTIONX_FONT_CACHE_SIZE / MiB / 2, 0, 0, 0, DEVILUTIONX_SOUND_BANK_SIZE / MiB / 4, DEVILUTIONX_SOUND_VOICES / 4, 32, 16, 0 };
+	case PerformanceProfile::High:
+		return { clamp(SDL_GetCPUCount(), 1, 4), DEVILUTIONX_FONT_CACHE_SIZE / MiB * 2, DEVILUTIONX_MONSTER_GFX_RETENTION_BUDGET / MiB * 2,
+			DEVILUTIONX_TILESET_RETENTION_BUDGET / MiB * 2, DEVILUTIONX_TOWNER_GFX_RETENTION_BUDGET / MiB * 2, DEVILUTIONX_SOUND_BANK_SIZE / MiB * 2, DEVILUTIONX_SOUND_VOICES, MAXITEMS, MAXLIGHTS,
+			clamp(SDL_GetCPUCount() - 1, 0, 4) };
+	default:
+		return { 1, DEVILUTIONX_FONT_CACHE_SIZE / MiB, DEVILUTIONX_MONSTER_GFX_RETENTION_BUDGET / MiB, DEVILUTIONX_TILESET_RETENTION_BUDGET / MiB,
+			DEVILUTIONX_TOWNER_GFX_RETENTION_BUDGET / MiB, DEVILUTIONX_SOUND_BANK_SIZE / MiB, DEVILUTIONX_SOUND_VOICES, MAXITEMS, 64,
+			clamp(SDL_GetCPUCount() - 1, 0, 2) };
+	}
+}
+
+void ApplyPerformanceProfile()
+{
+	const PerformanceProfile profile = *sgOptions.Performance.profile;
+	if (profile == PerformanceProfile::Custom)
+		return;
+	const PerformanceTier tier = GetPerformanceTier(profile);
+	ApplyingPerformanceProfile = true;
+	sgOptions.Graphics.renderThreads.SetValue(tier.renderThreads);
+	sgOptions.Memory.fontCache.SetValue(tier.fontCache);
+	sgOptions.Memory.monsterGraphics.SetValue(tier.monsterGraphics);
+	sgOptions.Memory.tilesets.SetValue(tier.tilesets);
+	sgOptions.Memory.townerGraphics.SetValue(tier.townerGraphics);
+	sgOptions.Memory.soundBank.SetValue(tier.soundBank);
+	sgOptions.Performance.soundVoices.SetValue(tier.soundVoices);
+	sgOptions.Performance.itemLabels.SetValue(tier.itemLabels);
+	sgOptions.Performance.lightBudget.SetValue(tier.lightBudget);
+	sgOptions.Performance.workerThreads.SetValue(tier.workerThreads);
+	ApplyingPerformanceProfile = false;
+}
+
+void OptionPerformanceValueChanged()
+{
+	if (!ApplyingPerformanceProfile)
+		sgOptions.Performance.profile.SetValue(PerformanceProfile::Custom);
+}
+
+void OptionWorkerThreadsChanged()
+{
+	// Started again with the new number of workers when it is next needed.
+	StopJobSystem();
+	OptionPerformanceValueChanged();
+}
+
+/**
+ * @brief Picks a profile from the number of CPUs and how long translating a few frames through a color table takes,
+ * which is most of what drawing the dungeon does.
+ */
+PerformanceProfile DetectPerformanceProfile()
+{
+	constexpr size_t FramePixels = 640 * 480;
+	constexpr int Passes = 8;
+	std::vector<uint8_t> frame(FramePixels);
+	std::array<uint8_t, 256> table;
+	for (size_t i = 0; i < FramePixels; i++)
+		frame[i] = static_cast<uint8_t>(i * 7);
+	for (size_t i = 0; i < table.size(); i++)
+		table[i] = static_cast<uint8_t>(255 - i);
+
+	const auto start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < Passes; pass++) {
+		for (uint8_t &pixel : frame)
+			pixel = table[pixel];
+	}
+	const auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+	const int cpus = SDL_GetCPUCount();
+	PerformanceProfile profile = PerformanceProfile::Balanced;
+	if (elapsedUs > 8000 || cpus <= 1)
+		profile = PerformanceProfile::Low;
+	else if (elapsedUs < 2000 && cpus >= 4)
+		profile = PerformanceProfile::High;
+	// The first pixel keeps the translation from being optimized away.
+	LogVerbose("Picked performance profile {} after translating {} frames in {} us on {} CPUs ({})",
+	    static_cast<int>(profile), Passes, elapsedUs, cpus, frame[0]);
+	return profile;
+}
+
 } // namespace
 
 /** Game options */
@@ -336,17 +447,22 @@ bool HardwareCursorSupported()
 
 void LoadOptions()
 {
+	DVL_PERF_FUNCTION();
+
 	for (OptionCategoryBase *pCategory : sgOptions.GetCategories()) {
 		for (OptionEntryBase *pEntry : pCategory->GetEntries()) {
 			pEntry->LoadFromIni(pCategory->GetKey());
 		}
 	}
+	if (GetIni().GetValue("Performance", "Profile") == nullptr)
+		sgOptions.Performance.profile.SetValue(DetectPerformanceProfile());
 
 	GetIniValue("Hellfire", "SItem", sgOptions.Hellfire.szItem, sizeof(sgOptions.Hellfire.szItem), "");
 
 	GetIniValue("Network", "Bind Address", sgOptions.Network.szBindAddress, sizeof(sgOptions.Network.szBindAddress), "0.0.0.0");
 	GetIniValue("Network", "Previous Game ID", sgOptions.Network.szPreviousZTGame, sizeof(sgOptions.Network.szPreviousZTGame), "");
 	GetIniValue("Network", "Previous Host", sgOptions.Network.szPreviousHost, sizeof(sgOptions.Network.szPreviousHost), "");
+	GetIniValue("Network", "Relay Host", sgOptions.Network.szRelayHost, sizeof(sgOptions.Network.szRelayHost), "");
 
 	for (size_t i = 0; i < QUICK_MESSAGE_OPTIONS; i++)
 		GetIniStringVector("NetMsg", QuickMessages[i].key, sgOptions.Chat.szHotKeyMsgs[i]);
@@ -379,6 +495,7 @@ void SaveOptions()
 	SetIniValue("Network", "Bind Address", sgOptions.Network.szBindAddress);
 	SetIniValue("Network", "Previous Game ID", sgOptions.Network.szPreviousZTGame);
 	SetIniValue("Network", "Previous Host", sgOptions.Network.szPreviousHost);
+	SetIniValue("Network", "Relay Host", sgOptions.Network.szRelayHost);
 
 	for (size_t i = 0; i < QUICK_MESSAGE_OPTIONS; i++)
 		SetIniValue("NetMsg", QuickMessages[i].key, sgOptions.Chat.szHotKeyMsgs[i]);
@@ -920,6 +1037,7 @@ GraphicsOptions::GraphicsOptions()
 #endif
     , gammaCorrection("Gamma Correction", OptionEntryFlags::Invisible, "Gamma Correction", "Gamma correction level.", 100)
     , zoom("Zoom", OptionEntryFlags::None, N_("Zoom"), N_("Zoom on when enabled."), false)
+    , dynamicResolution("Dynamic Resolution", OptionEntryFlags::None, N_("Dynamic Resolution"), N_("The game view is drawn at half resolution and zoomed in while drawing it at full resolution can't keep up with the refresh rate. The panels are not affected."), false)
     , colorCycling("Color Cycling", OptionEntryFlags::None, N_("Color Cycling"), N_("Color cycling effect used for water, lava, and acid animation."), true)
     , alternateNestArt("Alternate nest art", OptionEntryFlags::OnlyHellfire | OptionEntryFlags::CantChangeInGame, N_("Alternate nest art"), N_("The game will use an alternative palette for Hellfire’s nest tileset."), false)
 #if SDL_VERSION_ATLEAST(2, 0, 0)
@@ -931,6 +1049,9 @@ GraphicsOptions::GraphicsOptions()
     , showFPS("Show FPS", OptionEntryFlags::None, N_("Show FPS"), N_("Displays the FPS in the upper left corner of the screen."), false)
     , showHealthValues("Show health values", OptionEntryFlags::None, N_("Show health values"), N_("Displays current / max health value on health globe."), false)
     , showManaValues("Show mana values", OptionEntryFlags::None, N_("Show mana values"), N_("Displays current / max mana value on mana globe."), false)
+    , renderThreads("Render Threads", OptionEntryFlags::None, N_("Render Threads"), N_("Number of threads used to draw the dungeon floor and to convert full frames for presenting. More threads can help at high resolutions on multi-core devices."), 1, { 1, 2, 3, 4 })
+    , screenshotFlash("Screenshot Flash", OptionEntryFlags::None, N_("Screenshot Flash"), N_("The screen flashes red for a moment when a screenshot is taken."), true)
+    , flightRecorder("Flight Recorder", OptionEntryFlags::None, N_("Flight Recorder"), N_("Keeps the last seconds of frames and their timings. They are saved to a folder next to the save files when a frame takes unusually long or with the Save flight recording key."), false)
 {
 	resolution.SetValueChangedCallback(ResizeWindow);
 	fullscreen.SetValueChangedCallback(SetFullscreenMode);
@@ -944,6 +1065,7 @@ GraphicsOptions::GraphicsOptions()
 	vSync.SetValueChangedCallback(ReinitializeRenderer);
 #endif
 	showFPS.SetValueChangedCallback(OptionShowFPSChanged);
+	renderThreads.SetValueChangedCallback(OptionPerformanceValueChanged);
 }
 std::vector<OptionEntryBase *> GraphicsOptions::GetEntries()
 {
@@ -964,10 +1086,14 @@ std::vector<OptionEntryBase *> GraphicsOptions::GetEntries()
 #endif
 		&gammaCorrection,
 		&zoom,
+		&dynamicResolution,
 		&limitFPS,
 		&showFPS,
 		&showHealthValues,
 		&showManaValues,
+		&renderThreads,
+		&screenshotFlash,
+		&flightRecorder,
 		&colorCycling,
 		&alternateNestArt,
 #if SDL_VERSION_ATLEAST(2, 0, 0)
@@ -1066,12 +1192,72 @@ std::vector<OptionEntryBase *> ControllerOptions::GetEntries()
 NetworkOptions::NetworkOptions()
     : OptionCategoryBase("Network", N_("Network"), N_("Network Settings"))
     , port("Port", OptionEntryFlags::Invisible, "Port", "What network port to use.", 6112)
+    , serverThread("Server Thread", OptionEntryFlags::Invisible, "Server Thread", "Run the server of hosted TCP games on its own thread.", true)
+    , predictMovement("Predict Movement", OptionEntryFlags::None, N_("Predict Movement"), N_("Your character starts walking on screen right away in multiplayer games instead of waiting for the other players to confirm the step."), false)
 {
 }
 std::vector<OptionEntryBase *> NetworkOptions::GetEntries()
 {
 	return {
 		&port,
+		&serverThread,
+		&predictMovement,
+	};
+}
+
+PerformanceOptions::PerformanceOptions()
+    : OptionCategoryBase("Performance", N_("Performance"), N_("Performance Settings"))
+    , profile("Profile", OptionEntryFlags::None, N_("Profile"), N_("Sets the options below and the render threads for slower or faster devices. Changing any of them switches to Custom."), PerformanceProfile::Balanced,
+          {
+              { PerformanceProfile::Low, N_("Low") },
+              { PerformanceProfile::Balanced, N_("Balanced") },
+              { PerformanceProfile::High, N_("High") },
+              { PerformanceProfile::Custom, N_("Custom") },
+          })
+    , soundVoices("Sound Voices", OptionEntryFlags::None, N_("Sound Voices"), N_("How many sounds may play in addition to the first instance of each sound effect."), DEVILUTIONX_SOUND_VOICES, { 4, 8, 16, DEVILUTIONX_SOUND_VOICES })
+    , itemLabels("Item Labels", OptionEntryFlags::None, N_("Item Labels"), N_("How many item labels are shown at once."), MAXITEMS, { 16, 32, 64, MAXITEMS })
+    , lightBudget("Light Budget", OptionEntryFlags::None, N_("Light Budget"), N_("How many new or moving lights are updated at once in single player games. The others follow right after, spells can light up a moment late."), 64, { 16, 32, 64, MAXLIGHTS })
+    , workerThreads("Worker Threads", OptionEntryFlags::None, N_("Worker Threads"), N_("Number of threads that run background work. With 0 it runs on the main thread, which suits single-core devices."), 2, { 0, 1, 2, 3, 4 })
+{
+	profile.SetValueChangedCallback(ApplyPerformanceProfile);
+	soundVoices.SetValueChangedCallback(OptionPerformanceValueChanged);
+	itemLabels.SetValueChangedCallback(OptionPerformanceValueChanged);
+	lightBudget.SetValueChangedCallback(OptionPerformanceValueChanged);
+	workerThreads.SetValueChangedCallback(OptionWorkerThreadsChanged);
+}
+std::vector<OptionEntryBase *> PerformanceOptions::GetEntries()
+{
+	return {
+		&profile,
+		&soundVoices,
+		&itemLabels,
+		&lightBudget,
+		&workerThreads,
+	};
+}
+
+MemoryOptions::MemoryOptions()
+    : OptionCategoryBase("Memory", N_("Memory"), N_("Memory Settings"))
+    , fontCache("Font Cache", OptionEntryFlags::Invisible, "Font Cache", "How many MiB the loaded font sheets may take.", DEVILUTIONX_FONT_CACHE_SIZE / (1024 * 1024))
+    , monsterGraphics("Monster Graphics", OptionEntryFlags::Invisible, "Monster Graphics", "How many MiB the graphics of monster types that left the level may take.", DEVILUTIONX_MONSTER_GFX_RETENTION_BUDGET / (1024 * 1024))
+    , tilesets("Tilesets", OptionEntryFlags::Invisible, "Tilesets", "How many MiB the tilesets of other level types may take.", DEVILUTIONX_TILESET_RETENTION_BUDGET / (1024 * 1024))
+    , townerGraphics("Towner Graphics", OptionEntryFlags::Invisible, "Towner Graphics", "How many MiB the towner sprites may take while the player is away from town.", DEVILUTIONX_TOWNER_GFX_RETENTION_BUDGET / (1024 * 1024))
+    , soundBank("Sound Bank", OptionEntryFlags::Invisible, "Sound Bank", "How many MiB the decoded sound effects may take.", DEVILUTIONX_SOUND_BANK_SIZE / (1024 * 1024))
+{
+	fontCache.SetValueChangedCallback(OptionPerformanceValueChanged);
+	monsterGraphics.SetValueChangedCallback(OptionPerformanceValueChanged);
+	tilesets.SetValueChangedCallback(OptionPerformanceValueChanged);
+	townerGraphics.SetValueChangedCallback(OptionPerformanceValueChanged);
+	soundBank.SetValueChangedCallback(OptionPerformanceValueChanged);
+}
+std::vector<OptionEntryBase *> MemoryOptions::GetEntries()
+{
+	return {
+		&fontCache,
+		&monsterGraphics,
+		&tilesets,
+		&townerGraphics,
+		&soundBank,
 	};
 }
 
@@ -44,6 +44,15 @@ enum class ScalingQuality {
 	AnisotropicFiltering,
 };
 
+/** @brief A set of values for the options that trade quality and memory for speed. */
+enum class PerformanceProfile {
+	Low,
+	Balanced,
+	High,
+	/** @brief The options keep the values they were set to one by one. */
+	Custom,
+};
+
 enum class Resampler {
 #ifdef DEVILUTIONX_RESAMPLER_SPEEX
 	Speex = 0,
@@ -477,6 +486,8 @@ struct GraphicsOptions : OptionCategoryBase {
 	OptionEntryInt<int> gammaCorrection;
 	/** @brief Zoom on start. */
 	OptionEntryBoolean zoom;
+	/** @brief Zoom in while drawing a frame takes longer than a screen refresh. */
+	OptionEntryBoolean dynamicResolution;
 	/** @brief Enable color cycling animations. */
 	OptionEntryBoolean colorCycling;
 	/** @brief Use alternate nest palette. */
@@ -497,6 +508,12 @@ struct GraphicsOptions : OptionCategoryBase {
 	OptionEntryBoolean showHealthValues;
 	/** @brief Display current/max mana values on mana globe. */
 	OptionEntryBoolean showManaValues;
+	/** @brief Number of threads drawing the dungeon floor, 1 draws it on the main thread only. */
+	OptionEntryInt<int> renderThreads;
+	/** @brief Flash the screen red when taking a screenshot. */
+	OptionEntryBoolean screenshotFlash;
+	/** @brief Keep the last seconds of frames and their timings to save them when a frame takes unusually long. */
+	OptionEntryBoolean flightRecorder;
 };
 
 struct GameplayOptions : OptionCategoryBase {
@@ -595,8 +612,50 @@ struct NetworkOptions : OptionCategoryBase {
 	char szPreviousZTGame[129];
 	/** @brief Most recently entered Hostname in join dialog. */
 	char szPreviousHost[129];
+	/** @brief Optionally host TCP games on a devilutionx-relay server instead of locally. */
+	char szRelayHost[129];
 	/** @brief What network port to use. */
 	OptionEntryInt<uint16_t> port;
+	/** @brief Run the server of hosted TCP games on its own thread instead of the game loop. */
+	OptionEntryBoolean serverThread;
+	/** @brief Start showing the local player's walks before the other players confirmed them. */
+	OptionEntryBoolean predictMovement;
+};
+
+struct PerformanceOptions : OptionCategoryBase {
+	PerformanceOptions();
+	std::vector<OptionEntryBase *> GetEntries() override;
+
+	/**
+	 * @brief Sets the render threads, the memory budgets and the limits below, changing any of them switches to Custom.
+	 *
+	 * Without a profile in the ini one is picked from a short benchmark on startup.
+	 */
+	OptionEntryEnum<PerformanceProfile> profile;
+	/** @brief How many sounds may play in addition to the first instance of each sound effect. */
+	OptionEntryInt<int> soundVoices;
+	/** @brief How many item labels are shown at once, the items drawn first get theirs. */
+	OptionEntryInt<int> itemLabels;
+	/** @brief How many new or moved lights are applied per game tick in single player games, the others follow a tick later. */
+	OptionEntryInt<int> lightBudget;
+	/** @brief How many threads the job system starts, with 0 the jobs run on the thread that submits them. */
+	OptionEntryInt<int> workerThreads;
+};
+
+struct MemoryOptions : OptionCategoryBase {
+	MemoryOptions();
+	std::vector<OptionEntryBase *> GetEntries() override;
+
+	/** @brief How many MiB the loaded font sheets may take. */
+	OptionEntryInt<int> fontCache;
+	/** @brief How many MiB the graphics of monster types that left the level may take. */
+	OptionEntryInt<int> monsterGraphics;
+	/** @brief How many MiB the tilesets of other level types may take. */
+	OptionEntryInt<int> tilesets;
+	/** @brief How many MiB the towner sprites may take while the player is away from town. */
+	OptionEntryInt<int> townerGraphics;
+	/** @brief How many MiB the decoded sound effects may take, the rest are played from the encoded files. */
+	OptionEntryInt<int> soundBank;
 };
 
 struct ChatOptions : OptionCategoryBase {
@@ -679,8 +738,10 @@ struct Options {
 	AudioOptions Audio;
 	GameplayOptions Gameplay;
 	GraphicsOptions Graphics;
+	PerformanceOptions Performance;
 	ControllerOptions Controller;
 	NetworkOptions Network;
+	MemoryOptions Memory;
 	ChatOptions Chat;
 	LanguageOptions Language;
 	KeymapperOptions Keymapper;
@@ -691,12 +752,14 @@ struct Options {
 			&Language,
 			&StartUp,
 			&Graphics,
+			&Performance,
 			&Audio,
 			&Diablo,
 			&Hellfire,
 			&Gameplay,
 			&Controller,
 			&Network,
+			&Memory,
 			&Chat,
 			&Keymapper,
 		};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <utility>
+
+#include "control.h"
+#include "engine/point.hpp"
+#include "engine/size.hpp"
+#include "engine/surface.hpp"
+#include "utils/sdl_geometry.h"
+#include "utils/stdcompat/optional.hpp"
+
+namespace devilution {
+
+/**
+ * @brief A panel rendered offscreen, it is only drawn again when what it shows changes.
+ *
+ * The panel is drawn with its top left corner at the origin of the cached surface and copied opaquely to the screen,
+ * which suits the panels as their backgrounds cover the whole panel.
+ *
+ * @tparam Contents everything the panel's drawing depends on, needs to be equality comparable.
+ */
+template <typename Contents>
+class CachedPanel {
+public:
+	explicit CachedPanel(Size size = SidePanelSize)
+	    : size_(size)
+	{
+	}
+
+	/**
+	 * @brief Blits the panel to the given position, drawFn(const Surface &, const Contents &) redraws it first if the
+	 * contents differ from the cached ones.
+	 */
+	template <typename DrawFn>
+	void Draw(const Surface &out, Point position, const Contents &contents, DrawFn &&drawFn)
+	{
+		if (!surface_ || !contents_ || !(*contents_ == contents)) {
+			if (!surface_)
+				surface_.emplace(size_);
+			drawFn(static_cast<const Surface &>(*surface_), contents);
+			// Assigned rather than emplaced, so that contents with storage keep theirs.
+			if (contents_)
+				*contents_ = contents;
+			else
+				contents_.emplace(contents);
+		}
+		out.BlitFrom(*surface_, MakeSdlRect(0, 0, size_.width, size_.height), position);
+	}
+
+	/** @brief Frees the cached surface, e.g. because the graphics the panel is drawn with change. */
+	void Clear()
+	{
+		surface_ = std::nullopt;
+		contents_ = std::nullopt;
+	}
+
+private:
+	Size size_;
+	std::optional<OwnedSurface> surface_;
+	std::optional<Contents> contents_;
+};
+
+} // namespace devilution
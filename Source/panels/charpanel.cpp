@@ -1,6 +1,9 @@
 #include "panels/charpanel.hpp"
 
+#include <cstring>
+#include <iterator>
 #include <string>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -9,12 +12,14 @@
 #include "control.h"
 #include "engine/render/cl2_render.hpp"
 #include "engine/render/text_render.hpp"
+#include "panels/cached_panel.hpp"
 #include "panels/ui_panels.hpp"
 #include "player.h"
 #include "utils/display.h"
 #include "utils/format_int.hpp"
 #include "utils/language.h"
 #include "utils/str_cat.hpp"
+#include "utils/utf8.hpp"
 
 namespace devilution {
 
@@ -33,9 +38,24 @@ const char *const ClassStrTbl[] = {
 namespace {
 
 struct StyledText {
-	UiFlags style;
-	std::string text;
+	UiFlags style = UiFlags::None;
+	/** @brief Stored in place, so that building the values of the panel every frame doesn't allocate. */
+	char text[48] = {};
 	int spacing = 1;
+
+	StyledText() = default;
+
+	StyledText(UiFlags style, string_view str, int spacing = 1)
+	    : style(style)
+	    , spacing(spacing)
+	{
+		CopyUtf8(text, str, sizeof(text));
+	}
+
+	bool operator==(const StyledText &other) const
+	{
+		return style == other.style && std::strcmp(text, other.text) == 0 && spacing == other.spacing;
+	}
 };
 
 struct PanelEntry {
@@ -127,22 +147,24 @@ PanelEntry panelEntries[] = {
 	{ "", { 9, 14 }, 150, 0,
 	    []() { return StyledText { UiFlags::ColorWhite, MyPlayer->_pName }; } },
 	{ "", { 161, 14 }, 149, 0,
-	    []() { return StyledText { UiFlags::ColorWhite, std::string(_(ClassStrTbl[static_cast<std::size_t>(MyPlayer->_pClass)])) }; } },
+	    []() { return StyledText { UiFlags::ColorWhite, _(ClassStrTbl[static_cast<std::size_t>(MyPlayer->_pClass)]) }; } },
 
 	{ N_("Level"), { 57, 52 }, 57, 45,
 	    []() { return StyledText { UiFlags::ColorWhite, StrCat(MyPlayer->_pLevel) }; } },
 	{ N_("Experience"), { TopRightLabelX, 52 }, 99, 91,
 	    []() {
 	        int spacing = ((MyPlayer->_pExperience >= 1000000000) ? 0 : 1);
-	        return StyledText { UiFlags::ColorWhite, FormatInteger(MyPlayer->_pExperience), spacing };
+	        char value[FormatIntegerBufferSize];
+	        return StyledText { UiFlags::ColorWhite, FormatIntegerTo(value, MyPlayer->_pExperience), spacing };
 	    } },
 	{ N_("Next level"), { TopRightLabelX, 80 }, 99, 198,
 	    []() {
 	        if (MyPlayer->_pLevel == MaxCharacterLevel) {
-		        return StyledText { UiFlags::ColorWhitegold, std::string(_("None")) };
+		        return StyledText { UiFlags::ColorWhitegold, _("None") };
 	        }
 	        int spacing = ((MyPlayer->_pNextExper >= 1000000000) ? 0 : 1);
-	        return StyledText { UiFlags::ColorWhite, FormatInteger(MyPlayer->_pNextExper), spacing };
+	        char value[FormatIntegerBufferSize];
+	        return StyledText { UiFlags::ColorWhite, FormatIntegerTo(value, MyPlayer->_pNextExper), spacing };
 	    } },
 
 	{ N_("Base"), { LeftColumnLabelX, /* set dynamically */ 0 }, 0, 44 },
@@ -169,7 +191,10 @@ PanelEntry panelEntries[] = {
 
 	{ N_("Gold"), { TopRightLabelX, /* set dynamically */ 0 }, 0, 98 },
 	{ "", { TopRightLabelX, 127 }, 99, 0,
-	    []() { return StyledText { UiFlags::ColorWhite, FormatInteger(MyPlayer->_pGold) }; } },
+	    []() {
+	        char value[FormatIntegerBufferSize];
+	        return StyledText { UiFlags::ColorWhite, FormatIntegerTo(value, MyPlayer->_pGold) };
+	    } },
 
 	{ N_("Armor class"), { RightColumnLabelX, 163 }, 57, RightColumnLabelWidth,
 	    []() { return StyledText { GetValueColor(MyPlayer->_pIBonusAC), StrCat(MyPlayer->GetArmor()) }; } },
@@ -204,6 +229,9 @@ Art PanelBoxMiddle;
 Art PanelBoxRight;
 Art PanelFull;
 
+/** @brief The panel with the stat values of every entry, in the order of panelEntries. */
+CachedPanel<std::vector<StyledText>> CharPanelCache;
+
 constexpr int PanelFieldHeight = 24;
 constexpr int PanelFieldPaddingTop = 3;
 constexpr int PanelFieldPaddingBottom = 3;
@@ -227,9 +255,9 @@ void DrawShadowString(const Surface &out, const PanelEntry &entry)
 	constexpr int Spacing = 0;
 	const string_view textStr = LanguageTranslate(entry.label);
 	string_view text;
-	std::string wrapped;
+	FrameString wrapped;
 	if (entry.labelLength > 0) {
-		wrapped = WordWrapString(textStr, entry.labelLength, GameFont12, Spacing);
+		wrapped = WordWrapStringForFrame(textStr, entry.labelLength, GameFont12, Spacing);
 		text = wrapped;
 	} else {
 		text = textStr;
@@ -298,23 +326,31 @@ void LoadCharPanel()
 
 void FreeCharPanel()
 {
+	CharPanelCache.Clear();
 	PanelFull.Unload();
 }
 
 void DrawChr(const Surface &out)
 {
-	Point pos = GetPanelPosition(UiPanels::Character, { 0, 0 });
-	DrawArt(out, pos, &PanelFull);
-	for (auto &entry : panelEntries) {
-		if (entry.statDisplayFunc != nullptr) {
-			StyledText tmp = entry.statDisplayFunc();
+	// Reused from frame to frame, the entries are overwritten in place.
+	static std::vector<StyledText> stats(std::size(panelEntries));
+	for (size_t i = 0; i < std::size(panelEntries); i++)
+		stats[i] = panelEntries[i].statDisplayFunc != nullptr ? panelEntries[i].statDisplayFunc() : StyledText {};
+
+	CharPanelCache.Draw(out, GetPanelPosition(UiPanels::Character, { 0, 0 }), stats, [](const Surface &panel, const std::vector<StyledText> &stats) {
+		// PanelFull already uses the game palette, so it is copied as is.
+		panel.BlitFrom(Surface(PanelFull.surface.get()), MakeSdlRect(0, 0, PanelFull.w(), PanelFull.h()), { 0, 0 });
+		for (size_t i = 0; i < std::size(panelEntries); i++) {
+			const PanelEntry &entry = panelEntries[i];
+			if (entry.statDisplayFunc == nullptr)
+				continue;
 			DrawString(
-			    out,
-			    tmp.text,
-			    { entry.position + Displacement { pos.x, pos.y + PanelFieldPaddingTop }, { entry.length, PanelFieldInnerHeight } },
-			    UiFlags::AlignCenter | UiFlags::VerticalCenter | tmp.style, tmp.spacing);
+			    panel,
+			    stats[i].text,
+			    { entry.position + Displacement { 0, PanelFieldPaddingTop }, { entry.length, PanelFieldInnerHeight } },
+			    UiFlags::AlignCenter | UiFlags::VerticalCenter | stats[i].style, stats[i].spacing);
 		}
-	}
+	});
 	DrawStatButtons(out);
 }
 
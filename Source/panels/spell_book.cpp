@@ -1,5 +1,8 @@
 #include "panels/spell_book.hpp"
 
+#include <array>
+#include <cstdint>
+
 #include <fmt/format.h>
 
 #include "control.h"
@@ -10,6 +13,7 @@
 #include "engine/render/text_render.hpp"
 #include "init.h"
 #include "missiles.h"
+#include "panels/cached_panel.hpp"
 #include "panels/spell_icons.hpp"
 #include "panels/ui_panels.hpp"
 #include "player.h"
@@ -41,10 +45,11 @@ spell_id SpellPages[6][7] = {
 constexpr Size SpellBookDescription { 250, 43 };
 constexpr int SpellBookDescriptionPaddingHorizontal = 2;
 
+/** @brief Prints a line of a spell description, the position is relative to the panel. */
 void PrintSBookStr(const Surface &out, Point position, string_view text, UiFlags flags = UiFlags::None)
 {
 	DrawString(out, text,
-	    Rectangle(GetPanelPosition(UiPanels::Spell, position + Displacement { SPLICONLENGTH, 0 }),
+	    Rectangle(position + Displacement { SPLICONLENGTH, 0 },
 	        SpellBookDescription)
 	        .inset({ SpellBookDescriptionPaddingHorizontal, 0 }),
 	    UiFlags::ColorWhite | flags);
@@ -77,65 +82,88 @@ spell_type GetSBookTrans(spell_id ii, bool townok)
 	return st;
 }
 
-} // namespace
+/** @brief What the description of a spell shows, the fields that don't apply to its type are left at 0. */
+struct SpellBookLine {
+	spell_id spell;
+	spell_type iconType;
+	bool readied;
+	spell_type type;
+	int charges;
+	int mana;
+	int level;
+	int minDamage;
+	int maxDamage;
 
-void InitSpellBook()
-{
-	pSpellBkCel = LoadCelAsCl2("Data\\SpellBk.CEL", static_cast<uint16_t>(SidePanelSize.width));
-	pSBkBtnCel = LoadCelAsCl2("Data\\SpellBkB.CEL", gbIsHellfire ? 61 : 76);
-	pSBkIconCels = LoadCelAsCl2("Data\\SpellI2.CEL", 37);
+	bool operator==(const SpellBookLine &other) const
+	{
+		return spell == other.spell && iconType == other.iconType && readied == other.readied && type == other.type
+		    && charges == other.charges && mana == other.mana && level == other.level
+		    && minDamage == other.minDamage && maxDamage == other.maxDamage;
+	}
+};
 
-	Player &player = *MyPlayer;
-	if (player._pClass == HeroClass::Warrior) {
-		SpellPages[0][0] = SPL_REPAIR;
-	} else if (player._pClass == HeroClass::Rogue) {
-		SpellPages[0][0] = SPL_DISARM;
-	} else if (player._pClass == HeroClass::Sorcerer) {
-		SpellPages[0][0] = SPL_RECHARGE;
-	} else if (player._pClass == HeroClass::Monk) {
-		SpellPages[0][0] = SPL_SEARCH;
-	} else if (player._pClass == HeroClass::Bard) {
-		SpellPages[0][0] = SPL_IDENTIFY;
-	} else if (player._pClass == HeroClass::Barbarian) {
-		SpellPages[0][0] = SPL_BLODBOIL;
+struct SpellBookContents {
+	int tab;
+	uint32_t languageGeneration;
+	/** @brief One line per spell of the page, empty for the spells the player doesn't have. */
+	std::array<std::optional<SpellBookLine>, 7> lines;
+
+	bool operator==(const SpellBookContents &other) const
+	{
+		return tab == other.tab && languageGeneration == other.languageGeneration && lines == other.lines;
 	}
-}
+};
 
-void FreeSpellBook()
+CachedPanel<SpellBookContents> SpellBookCache;
+
+SpellBookLine GetSpellBookLine(const Player &player, spell_id sn)
 {
-	pSpellBkCel = std::nullopt;
-	pSBkBtnCel = std::nullopt;
-	pSBkIconCels = std::nullopt;
+	SpellBookLine line {};
+	line.spell = sn;
+	line.iconType = GetSBookTrans(sn, true);
+	line.readied = sn == player._pRSpell && line.iconType == player._pRSplType;
+	line.type = GetSBookTrans(sn, false);
+	switch (line.type) {
+	case RSPLTYPE_SKILL:
+		break;
+	case RSPLTYPE_CHARGES:
+		line.charges = player.InvBody[INVLOC_HAND_LEFT]._iCharges;
+		break;
+	default:
+		line.mana = GetManaAmount(player, sn) >> 6;
+		line.level = player.GetSpellLevel(sn);
+		if (line.level != 0 && sn != SPL_BONESPIRIT)
+			GetDamageAmt(sn, &line.minDamage, &line.maxDamage);
+		break;
+	}
+	return line;
 }
 
-void DrawSpellBook(const Surface &out)
+void DrawSpellBookContents(const Surface &out, const SpellBookContents &contents)
 {
-	Cl2Draw(out, GetPanelPosition(UiPanels::Spell, { 0, 351 }), CelSprite { *pSpellBkCel }, 0);
-	if (gbIsHellfire && sbooktab < 5) {
-		Cl2Draw(out, GetPanelPosition(UiPanels::Spell, { 61 * sbooktab + 7, 348 }), CelSprite { *pSBkBtnCel }, sbooktab);
+	Cl2Draw(out, { 0, 351 }, CelSprite { *pSpellBkCel }, 0);
+	if (gbIsHellfire && contents.tab < 5) {
+		Cl2Draw(out, { 61 * contents.tab + 7, 348 }, CelSprite { *pSBkBtnCel }, contents.tab);
 	} else {
 		// BUGFIX: rendering of page 3 and page 4 buttons are both off-by-one pixel (fixed).
-		int sx = 76 * sbooktab + 7;
-		if (sbooktab == 2 || sbooktab == 3) {
+		int sx = 76 * contents.tab + 7;
+		if (contents.tab == 2 || contents.tab == 3) {
 			sx++;
 		}
-		Cl2Draw(out, GetPanelPosition(UiPanels::Spell, { sx, 348 }), CelSprite { *pSBkBtnCel }, sbooktab);
+		Cl2Draw(out, { sx, 348 }, CelSprite { *pSBkBtnCel }, contents.tab);
 	}
-	Player &player = *MyPlayer;
-	uint64_t spl = player._pMemSpells | player._pISpells | player._pAblSpells;
 
 	const int lineHeight = 18;
 
 	int yp = 12;
 	const int textPaddingTop = 7;
-	for (int i = 1; i < 8; i++) {
-		spell_id sn = SpellPages[sbooktab][i - 1];
-		if (IsValidSpell(sn) && (spl & GetSpellBitmask(sn)) != 0) {
-			spell_type st = GetSBookTrans(sn, true);
-			SetSpellTrans(st);
-			const Point spellCellPosition = GetPanelPosition(UiPanels::Spell, { 11, yp + SpellBookDescription.height });
+	for (const std::optional<SpellBookLine> &line : contents.lines) {
+		if (line) {
+			const spell_id sn = line->spell;
+			SetSpellTrans(line->iconType);
+			const Point spellCellPosition { 11, yp + SpellBookDescription.height };
 			DrawSpellCel(out, spellCellPosition, *pSBkIconCels, SpellITbl[sn]);
-			if (sn == player._pRSpell && st == player._pRSplType) {
+			if (line->readied) {
 				SetSpellTrans(RSPLTYPE_SKILL);
 				DrawSpellCel(out, spellCellPosition, *pSBkIconCels, SPLICONLAST);
 			}
@@ -143,44 +171,86 @@ void DrawSpellBook(const Surface &out)
 			const Point line0 { 0, yp + textPaddingTop };
 			const Point line1 { 0, yp + textPaddingTop + lineHeight };
 			PrintSBookStr(out, line0, pgettext("spell", spelldata[sn].sNameText));
-			switch (GetSBookTrans(sn, false)) {
+			switch (line->type) {
 			case RSPLTYPE_SKILL:
 				PrintSBookStr(out, line1, _("Skill"));
 				break;
-			case RSPLTYPE_CHARGES: {
-				int charges = player.InvBody[INVLOC_HAND_LEFT]._iCharges;
-				PrintSBookStr(out, line1, fmt::format(fmt::runtime(ngettext("Staff ({:d} charge)", "Staff ({:d} charges)", charges)), charges));
-			} break;
-			default: {
-				int mana = GetManaAmount(player, sn) >> 6;
-				int lvl = player.GetSpellLevel(sn);
-				PrintSBookStr(out, line0, fmt::format(fmt::runtime(pgettext(/* TRANSLATORS: UI constraints, keep short please.*/ "spellbook", "Level {:d}")), lvl), UiFlags::AlignRight);
-				if (lvl == 0) {
+			case RSPLTYPE_CHARGES:
+				PrintSBookStr(out, line1, fmt::format(fmt::runtime(ngettext("Staff ({:d} charge)", "Staff ({:d} charges)", line->charges)), line->charges));
+				break;
+			default:
+				PrintSBookStr(out, line0, fmt::format(fmt::runtime(pgettext(/* TRANSLATORS: UI constraints, keep short please.*/ "spellbook", "Level {:d}")), line->level), UiFlags::AlignRight);
+				if (line->level == 0) {
 					PrintSBookStr(out, line1, _("Unusable"), UiFlags::AlignRight);
 				} else {
 					if (sn != SPL_BONESPIRIT) {
-						int min;
-						int max;
-						GetDamageAmt(sn, &min, &max);
-						if (min != -1) {
+						if (line->minDamage != -1) {
 							if (sn == SPL_HEAL || sn == SPL_HEALOTHER) {
-								PrintSBookStr(out, line1, fmt::format(fmt::runtime(_(/* TRANSLATORS: UI constraints, keep short please.*/ "Heals: {:d} - {:d}")), min, max), UiFlags::AlignRight);
+								PrintSBookStr(out, line1, fmt::format(fmt::runtime(_(/* TRANSLATORS: UI constraints, keep short please.*/ "Heals: {:d} - {:d}")), line->minDamage, line->maxDamage), UiFlags::AlignRight);
 							} else {
-								PrintSBookStr(out, line1, fmt::format(fmt::runtime(_(/* TRANSLATORS: UI constraints, keep short please.*/ "Damage: {:d} - {:d}")), min, max), UiFlags::AlignRight);
+								PrintSBookStr(out, line1, fmt::format(fmt::runtime(_(/* TRANSLATORS: UI constraints, keep short please.*/ "Damage: {:d} - {:d}")), line->minDamage, line->maxDamage), UiFlags::AlignRight);
 							}
 						}
 					} else {
 						PrintSBookStr(out, line1, _(/* TRANSLATORS: UI constraints, keep short please.*/ "Dmg: 1/3 target hp"), UiFlags::AlignRight);
 					}
-					PrintSBookStr(out, line1, fmt::format(fmt::runtime(pgettext(/* TRANSLATORS: UI constraints, keep short please.*/ "spellbook", "Mana: {:d}")), mana));
+					PrintSBookStr(out, line1, fmt::format(fmt::runtime(pgettext(/* TRANSLATORS: UI constraints, keep short please.*/ "spellbook", "Mana: {:d}")), line->mana));
 				}
-			} break;
+				break;
 			}
 		}
 		yp += SpellBookDescription.height;
 	}
 }
 
+} // namespace
+
+void InitSpellBook()
+{
+	pSpellBkCel = LoadCelAsCl2("Data\\SpellBk.CEL", static_cast<uint16_t>(SidePanelSize.width));
+	pSBkBtnCel = LoadCelAsCl2("Data\\SpellBkB.CEL", gbIsHellfire ? 61 : 76);
+	pSBkIconCels = LoadCelAsCl2("Data\\SpellI2.CEL", 37);
+
+	Player &player = *MyPlayer;
+	if (player._pClass == HeroClass::Warrior) {
+		SpellPages[0][0] = SPL_REPAIR;
+	} else if (player._pClass == HeroClass::Rogue) {
+		SpellPages[0][0] = SPL_DISARM;
+	} else if (player._pClass == HeroClass::Sorcerer) {
+		SpellPages[0][0] = SPL_RECHARGE;
+	} else if (player._pClass == HeroClass::Monk) {
+		SpellPages[0][0] = SPL_SEARCH;
+	} else if (player._pClass == HeroClass::Bard) {
+		SpellPages[0][0] = SPL_IDENTIFY;
+	} else if (player._pClass == HeroClass::Barbarian) {
+		SpellPages[0][0] = SPL_BLODBOIL;
+	}
+}
+
+void FreeSpellBook()
+{
+	SpellBookCache.Clear();
+	pSpellBkCel = std::nullopt;
+	pSBkBtnCel = std::nullopt;
+	pSBkIconCels = std::nullopt;
+}
+
+void DrawSpellBook(const Surface &out)
+{
+	SpellBookContents contents;
+	contents.tab = sbooktab;
+	contents.languageGeneration = LanguageGeneration;
+	Player &player = *MyPlayer;
+	uint64_t spl = player._pMemSpells | player._pISpells | player._pAblSpells;
+	for (int i = 0; i < 7; i++) {
+		spell_id sn = SpellPages[sbooktab][i];
+		if (IsValidSpell(sn) && (spl & GetSpellBitmask(sn)) != 0)
+			contents.lines[i] = GetSpellBookLine(player, sn);
+	}
+
+	SpellBookCache.Draw(out, GetPanelPosition(UiPanels::Spell, { 0, 0 }), contents, DrawSpellBookContents);
+}
+
 void CheckSBook()
 {
 	// Icons are drawn in a column near the left side of the panel and aligned with the spell book description entries
@@ -5,7 +5,11 @@
  */
 #include "pfile.h"
 
+#include <array>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include <fmt/compile.h>
 
@@ -21,6 +25,7 @@
 #include "utils/file_util.h"
 #include "utils/language.h"
 #include "utils/paths.h"
+#include "utils/sdl_thread.h"
 #include "utils/stdcompat/string_view.hpp"
 #include "utils/str_cat.hpp"
 #include "utils/utf8.hpp"
@@ -39,13 +44,22 @@ namespace {
 /** List of character names for the character selection screen. */
 char hero_names[MAX_CHARACTERS][PlayerNameLength];
 
+string_view GetSaveTypePrefix()
+{
+	if (gbIsSpawn)
+		return gbIsMultiplayer ? "share_" : "spawn_";
+	return gbIsMultiplayer ? "multi_" : "single_";
+}
+
 std::string GetSavePath(uint32_t saveNum, string_view savePrefix = {})
 {
-	return StrCat(paths::PrefPath(), savePrefix,
-	    gbIsSpawn
-	        ? (gbIsMultiplayer ? "share_" : "spawn_")
-	        : (gbIsMultiplayer ? "multi_" : "single_"),
-	    saveNum, gbIsHellfire ? ".hsv" : ".sv");
+	return StrCat(paths::PrefPath(), savePrefix, GetSaveTypePrefix(), saveNum, gbIsHellfire ? ".hsv" : ".sv");
+}
+
+/** @brief The hero index lists what the hero selection shows of every save of the same type, see HeroSummary. */
+std::string GetHeroIndexPath()
+{
+	return StrCat(paths::PrefPath(), GetSaveTypePrefix(), "heroes", gbIsHellfire ? ".hix" : ".ix");
 }
 
 std::string GetStashSavePath()
@@ -117,24 +131,83 @@ bool ReadHero(MpqArchive &archive, PlayerPack *pPack)
 	return ret;
 }
 
-void EncodeHero(MpqWriter &saveWriter, const PlayerPack *pack)
+void SaveHero(PendingSaveFiles &saveFiles, const PlayerPack *pack)
 {
-	size_t packedLen = codec_get_encoded_len(sizeof(*pack));
-	std::unique_ptr<byte[]> packed { new byte[packedLen] };
-
+	std::unique_ptr<byte[]> packed { new byte[codec_get_encoded_len(sizeof(*pack))] };
 	memcpy(packed.get(), pack, sizeof(*pack));
-	codec_encode(packed.get(), sizeof(*pack), packedLen, pfile_get_password());
-	saveWriter.WriteFile("hero", packed.get(), packedLen);
+	saveFiles.push_back({ "hero", std::move(packed), sizeof(*pack) });
 }
 
-MpqWriter GetSaveWriter(uint32_t saveNum)
+/**
+ * @brief The serialized files of a hero. The game files are written before the temporary levels are made permanent
+ * and the hero files afterwards, as when they were written one by one.
+ */
+struct HeroSave {
+	PendingSaveFiles gameFiles;
+	PendingSaveFiles heroFiles;
+	bool writeGameData;
+	const char *password;
+};
+
+HeroSave SerializeHero(bool writeGameData)
 {
-	return MpqWriter(GetSavePath(saveNum).c_str());
+	HeroSave save;
+	save.writeGameData = writeGameData;
+	save.password = pfile_get_password();
+
+	if (writeGameData)
+		SaveGameData(save.gameFiles);
+	PlayerPack pkplr;
+	Player &myPlayer = *MyPlayer;
+
+	PackPlayer(&pkplr, myPlayer, !gbIsMultiplayer, false);
+	SaveHero(save.heroFiles, &pkplr);
+	if (!gbVanilla) {
+		SaveHotkeys(save.heroFiles);
+		SaveHeroItems(save.heroFiles, myPlayer);
+	}
+	return save;
+}
+
+void WriteHeroSave(MpqWriter &saveWriter, HeroSave &save)
+{
+	WritePendingSaveFiles(saveWriter, save.gameFiles, save.password);
+	if (save.writeGameData)
+		RenameTempToPerm(saveWriter);
+	WritePendingSaveFiles(saveWriter, save.heroFiles, save.password);
 }
 
-MpqWriter GetStashWriter()
+/** @brief Files written by BackgroundSaveThread, either the hero or the stash part may be empty. */
+struct BackgroundSave {
+	std::string path;
+	std::optional<HeroSave> save;
+	std::string stashPath;
+	const char *stashPassword;
+	PendingSaveFiles stashFiles;
+};
+
+/** @brief Save that is written by BackgroundSaveThread, the main thread only touches it after joining the thread. */
+std::unique_ptr<BackgroundSave> CurrentBackgroundSave;
+SdlThread BackgroundSaveThread;
+
+int SDLCALL RunBackgroundSave(void *data)
 {
-	return MpqWriter(GetStashSavePath().c_str());
+	auto &backgroundSave = *static_cast<BackgroundSave *>(data);
+	if (backgroundSave.save) {
+		MpqWriter saveWriter(backgroundSave.path.c_str());
+		WriteHeroSave(saveWriter, *backgroundSave.save);
+	}
+	if (!backgroundSave.stashFiles.empty()) {
+		MpqWriter stashWriter(backgroundSave.stashPath.c_str());
+		WritePendingSaveFiles(stashWriter, backgroundSave.stashFiles, backgroundSave.stashPassword);
+	}
+	return 0;
+}
+
+MpqWriter GetSaveWriter(uint32_t saveNum)
+{
+	pfile_wait_for_save();
+	return MpqWriter(GetSavePath(saveNum).c_str());
 }
 
 void Game2UiPlayer(const Player &player, _uiheroinfo *heroinfo, bool bHasSaveFile)
@@ -223,33 +296,227 @@ bool CompareSaves(const std::string &actualSavePath, const std::string &referenc
 	return compareResult;
 }
 
-void pfile_write_hero(MpqWriter &saveWriter, bool writeGameData)
+/**
+ * @brief What the hero selection shows of a save, so that it doesn't have to load every hero to list them.
+ *
+ * A summary is only used while the size and modification time of its save match, anything that rewrites the save
+ * outside of the game makes the next listing load that hero again.
+ */
+struct HeroSummary {
+	std::uintmax_t saveSize;
+	std::uint64_t saveTime;
+	char name[PlayerNameLength];
+	/** @brief False if the hero couldn't be unpacked, the name still reserves the slot but the hero isn't listed. */
+	bool listed;
+	uint8_t level;
+	HeroClass heroClass;
+	uint8_t rank;
+	uint16_t strength;
+	uint16_t magic;
+	uint16_t dexterity;
+	uint16_t vitality;
+	bool hasSaveGame;
+};
+
+constexpr uint8_t HeroIndexVersion = 0;
+constexpr size_t HeroSummarySize = 1 + 8 + 8 + PlayerNameLength + 1 + 1 + 1 + 1 + 4 * 2 + 1;
+
+std::array<std::optional<HeroSummary>, MAX_CHARACTERS> HeroIndex;
+/** @brief Path of the index in HeroIndex, single and multiplayer heroes have separate indexes. */
+std::string HeroIndexPath;
+
+void LoadHeroIndex()
+{
+	HeroIndexPath = GetHeroIndexPath();
+	HeroIndex = {};
+
+	std::optional<std::fstream> stream = CreateFileStream(HeroIndexPath.c_str(), std::fstream::in | std::fstream::binary);
+	if (!stream)
+		return;
+	char version;
+	if (!stream->read(&version, 1) || static_cast<uint8_t>(version) != HeroIndexVersion)
+		return;
+
+	char entry[HeroSummarySize];
+	while (stream->read(entry, HeroSummarySize)) {
+		const auto saveNum = static_cast<uint8_t>(entry[0]);
+		const auto heroClass = static_cast<uint8_t>(entry[1 + 8 + 8 + PlayerNameLength + 2]);
+		if (saveNum >= MAX_CHARACTERS || heroClass > static_cast<uint8_t>(HeroClass::LAST))
+			continue;
+		HeroSummary summary;
+		const char *src = &entry[1];
+		summary.saveSize = static_cast<std::uintmax_t>(LoadLE32(src + 4)) << 32 | LoadLE32(src);
+		src += 8;
+		summary.saveTime = static_cast<std::uint64_t>(LoadLE32(src + 4)) << 32 | LoadLE32(src);
+		src += 8;
+		memcpy(summary.name, src, PlayerNameLength);
+		summary.name[PlayerNameLength - 1] = '\0';
+		src += PlayerNameLength;
+		summary.listed = *src++ != 0;
+		summary.level = static_cast<uint8_t>(*src++);
+		summary.heroClass = static_cast<HeroClass>(heroClass);
+		src++;
+		summary.rank = static_cast<uint8_t>(*src++);
+		summary.strength = LoadLE16(src);
+		summary.magic = LoadLE16(src + 2);
+		summary.dexterity = LoadLE16(src + 4);
+		summary.vitality = LoadLE16(src + 6);
+		src += 8;
+		summary.hasSaveGame = *src != 0;
+		HeroIndex[saveNum] = summary;
+	}
+}
+
+void WriteHeroIndex()
 {
-	if (writeGameData) {
-		SaveGameData(saveWriter);
-		RenameTempToPerm(saveWriter);
+	std::string data;
+	data.push_back(static_cast<char>(HeroIndexVersion));
+	for (uint32_t i = 0; i < MAX_CHARACTERS; i++) {
+		if (!HeroIndex[i])
+			continue;
+		const HeroSummary &summary = *HeroIndex[i];
+		char entry[HeroSummarySize];
+		char *dst = entry;
+		*dst++ = static_cast<char>(i);
+		WriteLE32(dst, static_cast<uint32_t>(summary.saveSize));
+		WriteLE32(dst + 4, static_cast<uint32_t>(static_cast<std::uint64_t>(summary.saveSize) >> 32));
+		dst += 8;
+		WriteLE32(dst, static_cast<uint32_t>(summary.saveTime));
+		WriteLE32(dst + 4, static_cast<uint32_t>(summary.saveTime >> 32));
+		dst += 8;
+		memcpy(dst, summary.name, PlayerNameLength);
+		dst += PlayerNameLength;
+		*dst++ = summary.listed ? 1 : 0;
+		*dst++ = static_cast<char>(summary.level);
+		*dst++ = static_cast<char>(summary.heroClass);
+		*dst++ = static_cast<char>(summary.rank);
+		WriteLE16(dst, summary.strength);
+		WriteLE16(dst + 2, summary.magic);
+		WriteLE16(dst + 4, summary.dexterity);
+		WriteLE16(dst + 6, summary.vitality);
+		dst += 8;
+		*dst = summary.hasSaveGame ? 1 : 0;
+		data.append(entry, HeroSummarySize);
 	}
+
+	std::optional<std::fstream> stream = CreateFileStream(HeroIndexPath.c_str(), std::fstream::out | std::fstream::trunc | std::fstream::binary);
+	if (stream)
+		stream->write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+/**
+ * @brief Drops the summary of a save that the game is about to rewrite.
+ *
+ * The modification time alone can miss a rewrite within the same second on some platforms.
+ */
+void ForgetHeroSummary(uint32_t saveNum)
+{
+	if (saveNum < MAX_CHARACTERS && HeroIndexPath == GetHeroIndexPath())
+		HeroIndex[saveNum] = std::nullopt;
+}
+
+/**
+ * @brief Loads the hero from the save, the way the game does it, to summarize it.
+ */
+std::optional<HeroSummary> SummarizeHero(uint32_t saveNum)
+{
+	std::optional<MpqArchive> archive = OpenSaveArchive(saveNum);
+	if (!archive)
+		return std::nullopt;
 	PlayerPack pkplr;
-	Player &myPlayer = *MyPlayer;
+	if (!ReadHero(*archive, &pkplr))
+		return std::nullopt;
 
-	PackPlayer(&pkplr, myPlayer, !gbIsMultiplayer, false);
-	EncodeHero(saveWriter, &pkplr);
-	if (!gbVanilla) {
-		SaveHotkeys(saveWriter);
-		SaveHeroItems(saveWriter, myPlayer);
+	HeroSummary summary {};
+	CopyUtf8(summary.name, pkplr.pName, sizeof(summary.name));
+	summary.hasSaveGame = ArchiveContainsGame(*archive);
+	if (summary.hasSaveGame)
+		pkplr.bIsHellfire = gbIsHellfireSaveGame ? 1 : 0;
+
+	Player &player = Players[0];
+
+	player = {};
+
+	summary.listed = UnPackPlayer(&pkplr, player, false);
+	if (summary.listed) {
+		LoadHeroItems(player);
+		RemoveEmptyInventory(player);
+		CalcPlrInv(player, false);
+
+		summary.level = player._pLevel;
+		summary.heroClass = player._pClass;
+		summary.rank = player.pDiabloKillLevel;
+		summary.strength = static_cast<uint16_t>(player._pStrength);
+		summary.magic = static_cast<uint16_t>(player._pMagic);
+		summary.dexterity = static_cast<uint16_t>(player._pDexterity);
+		summary.vitality = static_cast<uint16_t>(player._pVitality);
+	}
+	return summary;
+}
+
+void pfile_write_hero(MpqWriter &saveWriter, bool writeGameData)
+{
+	HeroSave save = SerializeHero(writeGameData);
+	WriteHeroSave(saveWriter, save);
+}
+
+/** @brief Unencoded hero files of the last save, the periodic multiplayer save is skipped while they are the same. */
+std::vector<byte> LastSavedHeroFiles;
+
+std::vector<byte> ConcatSaveFiles(const PendingSaveFiles &saveFiles)
+{
+	std::vector<byte> result;
+	for (const PendingSaveFile &saveFile : saveFiles) {
+		const auto *name = reinterpret_cast<const byte *>(saveFile.name.c_str());
+		result.insert(result.end(), name, name + saveFile.name.size() + 1);
+		result.insert(result.end(), saveFile.data.get(), saveFile.data.get() + saveFile.size);
+	}
+	return result;
+}
+
+/** @brief Serializes the stash if it changed since it was last saved. */
+PendingSaveFiles SerializeStash()
+{
+	PendingSaveFiles stashFiles;
+	if (!Stash.dirty)
+		return stashFiles;
+
+	SaveStash(stashFiles);
+	Stash.dirty = false;
+	Stash.dirtyPages.clear();
+	return stashFiles;
+}
+
+/**
+ * @brief Hands the serialized files to the save thread, after waiting for the previous save.
+ */
+void StartBackgroundSave(std::optional<HeroSave> save, PendingSaveFiles stashFiles)
+{
+	if (!save && stashFiles.empty())
+		return;
+
+	pfile_wait_for_save();
+	if (save) {
+		ForgetHeroSummary(gSaveNumber);
+		LastSavedHeroFiles = ConcatSaveFiles(save->heroFiles);
 	}
+	CurrentBackgroundSave = std::make_unique<BackgroundSave>(BackgroundSave {
+	    GetSavePath(gSaveNumber), std::move(save), GetStashSavePath(), pfile_get_password(), std::move(stashFiles) });
+	BackgroundSaveThread = SdlThread { RunBackgroundSave, CurrentBackgroundSave.get() };
 }
 
 } // namespace
 
 std::optional<MpqArchive> OpenSaveArchive(uint32_t saveNum)
 {
+	pfile_wait_for_save();
 	std::int32_t error;
 	return MpqArchive::Open(GetSavePath(saveNum).c_str(), error);
 }
 
 std::optional<MpqArchive> OpenStashArchive()
 {
+	pfile_wait_for_save();
 	std::int32_t error;
 	return MpqArchive::Open(GetStashSavePath().c_str(), error);
 }
@@ -282,8 +549,14 @@ const char *pfile_get_password()
 
 void pfile_write_hero(bool writeGameData)
 {
-	MpqWriter saveWriter = GetSaveWriter(gSaveNumber);
-	pfile_write_hero(saveWriter, writeGameData);
+	// Only serializing has to happen right away, encoding and writing the archive is left to the save thread
+	StartBackgroundSave(SerializeHero(writeGameData), {});
+}
+
+void pfile_wait_for_save()
+{
+	BackgroundSaveThread.join();
+	CurrentBackgroundSave = nullptr;
 }
 
 void pfile_write_hero_demo(int demo)
@@ -312,48 +585,62 @@ HeroCompareResult pfile_compare_hero_demo(int demo)
 
 void sfile_write_stash()
 {
-	if (!Stash.dirty)
-		return;
-
-	MpqWriter stashWriter = GetStashWriter();
-
-	SaveStash(stashWriter);
-
-	Stash.dirty = false;
+	StartBackgroundSave(std::nullopt, SerializeStash());
 }
 
 bool pfile_ui_set_hero_infos(bool (*uiAddHeroInfo)(_uiheroinfo *))
 {
 	memset(hero_names, 0, sizeof(hero_names));
 
+	pfile_wait_for_save();
+	if (HeroIndexPath != GetHeroIndexPath())
+		LoadHeroIndex();
+
+	bool indexChanged = false;
 	for (uint32_t i = 0; i < MAX_CHARACTERS; i++) {
-		std::optional<MpqArchive> archive = OpenSaveArchive(i);
-		if (archive) {
-			PlayerPack pkplr;
-			if (ReadHero(*archive, &pkplr)) {
-				_uiheroinfo uihero;
-				uihero.saveNumber = i;
-				strcpy(hero_names[i], pkplr.pName);
-				bool hasSaveGame = ArchiveContainsGame(*archive);
-				if (hasSaveGame)
-					pkplr.bIsHellfire = gbIsHellfireSaveGame ? 1 : 0;
-
-				Player &player = Players[0];
-
-				player = {};
-
-				if (UnPackPlayer(&pkplr, player, false)) {
-					LoadHeroItems(player);
-					RemoveEmptyInventory(player);
-					CalcPlrInv(player, false);
-
-					Game2UiPlayer(player, &uihero, hasSaveGame);
-					uiAddHeroInfo(&uihero);
-				}
+		const std::string savePath = GetSavePath(i);
+		std::uintmax_t saveSize;
+		std::uint64_t saveTime;
+		if (!GetFileSize(savePath.c_str(), &saveSize) || !GetFileModificationTime(savePath.c_str(), &saveTime)) {
+			if (HeroIndex[i]) {
+				HeroIndex[i] = std::nullopt;
+				indexChanged = true;
 			}
+			continue;
 		}
+
+		std::optional<HeroSummary> &summary = HeroIndex[i];
+		if (!summary || summary->saveSize != saveSize || summary->saveTime != saveTime) {
+			summary = SummarizeHero(i);
+			indexChanged = true;
+			if (!summary)
+				continue;
+			summary->saveSize = saveSize;
+			summary->saveTime = saveTime;
+		}
+
+		CopyUtf8(hero_names[i], summary->name, sizeof(hero_names[i]));
+		if (!summary->listed)
+			continue;
+
+		_uiheroinfo uihero;
+		uihero.saveNumber = i;
+		CopyUtf8(uihero.name, summary->name, sizeof(uihero.name));
+		uihero.level = summary->level;
+		uihero.heroclass = summary->heroClass;
+		uihero.strength = summary->strength;
+		uihero.magic = summary->magic;
+		uihero.dexterity = summary->dexterity;
+		uihero.vitality = summary->vitality;
+		uihero.hassaved = summary->hasSaveGame;
+		uihero.herorank = summary->rank;
+		uihero.spawned = gbIsSpawn;
+		uiAddHeroInfo(&uihero);
 	}
 
+	if (indexChanged)
+		WriteHeroIndex();
+
 	return true;
 }
 
@@ -387,6 +674,7 @@ bool pfile_ui_save_create(_uiheroinfo *heroinfo)
 	giNumberOfLevels = gbIsHellfire ? 25 : 17;
 
 	MpqWriter saveWriter = GetSaveWriter(saveNum);
+	ForgetHeroSummary(saveNum);
 	saveWriter.RemoveHashEntries(GetFileName);
 	CopyUtf8(hero_names[saveNum], heroinfo->name, sizeof(hero_names[saveNum]));
 
@@ -394,12 +682,14 @@ bool pfile_ui_save_create(_uiheroinfo *heroinfo)
 	CreatePlayer(player, heroinfo->heroclass);
 	CopyUtf8(player._pName, heroinfo->name, PlayerNameLength);
 	PackPlayer(&pkplr, player, true, false);
-	EncodeHero(saveWriter, &pkplr);
+	PendingSaveFiles saveFiles;
+	SaveHero(saveFiles, &pkplr);
 	Game2UiPlayer(player, heroinfo, false);
 	if (!gbVanilla) {
-		SaveHotkeys(saveWriter);
-		SaveHeroItems(saveWriter, player);
+		SaveHotkeys(saveFiles);
+		SaveHeroItems(saveFiles, player);
 	}
+	WritePendingSaveFiles(saveWriter, saveFiles, pfile_get_password());
 
 	return true;
 }
@@ -409,6 +699,7 @@ bool pfile_delete_save(_uiheroinfo *heroInfo)
 	uint32_t saveNum = heroInfo->saveNumber;
 	if (saveNum < MAX_CHARACTERS) {
 		hero_names[saveNum][0] = '\0';
+		pfile_wait_for_save();
 		RemoveFile(GetSavePath(saveNum).c_str());
 	}
 	return true;
@@ -473,8 +764,12 @@ void pfile_update(bool forceSave)
 		return;
 
 	prevTick = tick;
-	pfile_write_hero();
-	sfile_write_stash();
+	HeroSave save = SerializeHero(/*writeGameData=*/false);
+	std::optional<HeroSave> changedSave;
+	if (ConcatSaveFiles(save.heroFiles) != LastSavedHeroFiles)
+		changedSave = std::move(save);
+	// The hero and the stash go to the save thread together, so that the stash doesn't wait for the hero to be written.
+	StartBackgroundSave(std::move(changedSave), SerializeStash());
 }
 
 } // namespace devilution
@@ -27,7 +27,19 @@ std::optional<MpqArchive> OpenSaveArchive(uint32_t saveNum);
 std::optional<MpqArchive> OpenStashArchive();
 const char *pfile_get_password();
 std::unique_ptr<byte[]> ReadArchive(MpqArchive &archive, const char *pszName, size_t *pdwLen = nullptr);
+/**
+ * @brief Saves the hero of the current save slot, and the game too if writeGameData is set.
+ *
+ * The state is serialized right away but encoded and written on a background thread, call
+ * pfile_wait_for_save to make sure it reached the disk.
+ */
 void pfile_write_hero(bool writeGameData = false);
+/**
+ * @brief Blocks until the save started by pfile_write_hero or sfile_write_stash has been written.
+ *
+ * Called by everything that opens the save archives, so only needed before touching the files directly.
+ */
+void pfile_wait_for_save();
 /**
  * @brief Save a reference game-state (save game) for the demo recording
  * @param demo that is recorded
@@ -39,6 +51,9 @@ void pfile_write_hero_demo(int demo);
  * @return The comparsion result.
  */
 HeroCompareResult pfile_compare_hero_demo(int demo);
+/**
+ * @brief Saves the stash if it changed, written on the background thread like pfile_write_hero.
+ */
 void sfile_write_stash();
 bool pfile_ui_set_hero_infos(bool (*uiAddHeroInfo)(_uiheroinfo *));
 void pfile_ui_set_class_stats(unsigned int playerClass, _uidefaultstats *classStats);
@@ -16,10 +16,13 @@
 #ifdef _DEBUG
 #include "debug.h"
 #endif
+#include "engine/asset_prefetch.hpp"
 #include "engine/cel_header.hpp"
 #include "engine/load_file.hpp"
 #include "engine/points_in_rectangle_range.hpp"
 #include "engine/random.hpp"
+#include "engine/render/cl2_render.hpp"
+#include "engine/render/scrollrt.h"
 #include "engine/world_tile.hpp"
 #include "gamemenu.h"
 #include "init.h"
@@ -42,6 +45,10 @@
 #include "utils/str_cat.hpp"
 #include "utils/utf8.hpp"
 
+#ifndef DEVILUTIONX_PLAYER_GRAPHICS_BUDGET
+#define DEVILUTIONX_PLAYER_GRAPHICS_BUDGET 0
+#endif
+
 namespace devilution {
 
 int MyPlayerId;
@@ -284,7 +291,7 @@ void ScrollViewPort(const Player &player, ScrollDirection dir)
 {
 	ScrollInfo.tile = Point { 0, 0 } + (player.position.tile - ViewPosition);
 
-	if (!*sgOptions.Graphics.zoom) {
+	if (!IsViewZoomed()) {
 		if (abs(ScrollInfo.tile.x) >= 3 || abs(ScrollInfo.tile.y) >= 3) {
 			ScrollInfo._sdir = ScrollDirection::None;
 		} else {
@@ -366,12 +373,18 @@ void StartWalk(Player &player, Displacement vel, Direction dir, bool pmWillBeCal
 	StartWalkAnimation(player, dir, pmWillBeCalled);
 }
 
-void SetPlayerGPtrs(const char *path, std::unique_ptr<byte[]> &data, std::array<OptionalCelSprite, 8> &anim, int width)
+void SetPlayerGPtrs(const char *path, std::unique_ptr<byte[]> &data, size_t &size, std::array<OptionalCelSprite, 8> &anim, int width)
 {
 	data = nullptr;
-	data = LoadFileInMem(path);
+	size = 0;
+	data = TakePrefetchedAsset(path, size);
 	if (data == nullptr)
+		data = LoadFileInMem(path, &size);
+	if (data == nullptr) {
+		for (OptionalCelSprite &celSprite : anim)
+			celSprite = std::nullopt;
 		return;
+	}
 
 	const byte *directionFrames[8];
 	CelGetDirectionFrames(data.get(), directionFrames);
@@ -380,6 +393,205 @@ void SetPlayerGPtrs(const char *path, std::unique_ptr<byte[]> &data, std::array<
 	}
 }
 
+/** @brief Incremented whenever a player graphic is requested, see PlayerAnimationData::LastUse. */
+uint32_t PlayerGraphicsUseCounter;
+
+void FreePlayerAnimationData(PlayerAnimationData &animationData)
+{
+	for (auto &celSprite : animationData.CelSpritesForDirections)
+		celSprite = std::nullopt;
+	// Another graphic may be loaded to the same address mid-level.
+	if (animationData.RawData != nullptr)
+		Cl2ForgetCachedFrames(animationData.RawData.get(), animationData.RawDataSize);
+	animationData.RawData = nullptr;
+	animationData.RawDataSize = 0;
+}
+
+bool IsPlayerGraphicShown(const Player &player, const PlayerAnimationData &animationData)
+{
+	for (const OptionalCelSprite &celSprite : animationData.CelSpritesForDirections) {
+		if (celSprite && (celSprite == player.AnimInfo.celSprite || celSprite == player.previewCelSprite))
+			return true;
+	}
+	return false;
+}
+
+#if DEVILUTIONX_PLAYER_GRAPHICS_BUDGET > 0
+/**
+ * @brief Frees the least recently used player graphics until the loaded ones fit into DEVILUTIONX_PLAYER_GRAPHICS_BUDGET
+ *
+ * Graphics that are being shown and the stand graphics are never freed, so they can always be drawn.
+ *
+ * @param keep A graphic that was just loaded and is about to be shown
+ */
+void EnforcePlayerGraphicsBudget(const PlayerAnimationData &keep)
+{
+	while (true) {
+		size_t totalSize = 0;
+		PlayerAnimationData *leastRecentlyUsed = nullptr;
+		for (Player &player : Players) {
+			for (size_t i = 0; i < player.AnimationData.size(); i++) {
+				PlayerAnimationData &animationData = player.AnimationData[i];
+				if (animationData.RawData == nullptr)
+					continue;
+				totalSize += animationData.RawDataSize;
+				if (&animationData == &keep || static_cast<player_graphic>(i) == player_graphic::Stand || IsPlayerGraphicShown(player, animationData))
+					continue;
+				if (leastRecentlyUsed == nullptr || animationData.LastUse < leastRecentlyUsed->LastUse)
+					leastRecentlyUsed = &animationData;
+			}
+		}
+		if (totalSize <= DEVILUTIONX_PLAYER_GRAPHICS_BUDGET || leastRecentlyUsed == nullptr)
+			return;
+		FreePlayerAnimationData(*leastRecentlyUsed);
+	}
+}
+#endif
+
+/**
+ * @brief Writes the path of the CL2 file of a player graphic.
+ * @param gfxNum The equipment to look up the graphic for, see Player::_pgfxnum
+ * @return The width of the frames, 0 if the player has no such graphic with this equipment on the current level
+ */
+int GetPlrGFXPath(const Player &player, player_graphic graphic, int gfxNum, char (&pszName)[256])
+{
+	HeroClass c = player._pClass;
+	if (c == HeroClass::Bard && !hfbard_mpq) {
+		c = HeroClass::Rogue;
+	} else if (c == HeroClass::Barbarian && !hfbarb_mpq) {
+		c = HeroClass::Warrior;
+	}
+
+	auto animWeaponId = static_cast<PlayerWeaponGraphic>(gfxNum & 0xF);
+	int animationWidth = 96;
+	bool useUnarmedAnimationInTown = false;
+
+	const char *cs = ClassPathTbl[static_cast<std::size_t>(c)];
+
+	const char *szCel;
+	switch (graphic) {
+	case player_graphic::Stand:
+		szCel = "AS";
+		if (leveltype == DTYPE_TOWN)
+			szCel = "ST";
+		if (c == HeroClass::Monk)
+			animationWidth = 112;
+		break;
+	case player_graphic::Walk:
+		szCel = "AW";
+		if (leveltype == DTYPE_TOWN)
+			szCel = "WL";
+		if (c == HeroClass::Monk)
+			animationWidth = 112;
+		break;
+	case player_graphic::Attack:
+		if (leveltype == DTYPE_TOWN)
+			return 0;
+		szCel = "AT";
+		if (c == HeroClass::Monk)
+			animationWidth = 130;
+		else if (animWeaponId != PlayerWeaponGraphic::Bow || !(c == HeroClass::Warrior || c == HeroClass::Barbarian))
+			animationWidth = 128;
+		break;
+	case player_graphic::Hit:
+		if (leveltype == DTYPE_TOWN)
+			return 0;
+		szCel = "HT";
+		if (c == HeroClass::Monk)
+			animationWidth = 98;
+		break;
+	case player_graphic::Lightning:
+		szCel = "LM";
+		useUnarmedAnimationInTown = true;
+		if (c == HeroClass::Monk)
+			animationWidth = 114;
+		else if (c == HeroClass::Sorcerer)
+			animationWidth = 128;
+		break;
+	case player_graphic::Fire:
+		szCel = "FM";
+		useUnarmedAnimationInTown = true;
+		if (c == HeroClass::Monk)
+			animationWidth = 114;
+		else if (c == HeroClass::Sorcerer)
+			animationWidth = 128;
+		break;
+	case player_graphic::Magic:
+		szCel = "QM";
+		useUnarmedAnimationInTown = true;
+		if (c == HeroClass::Monk)
+			animationWidth = 114;
+		else if (c == HeroClass::Sorcerer)
+			animationWidth = 128;
+		break;
+	case player_graphic::Death:
+		if (animWeaponId != PlayerWeaponGraphic::Unarmed)
+			return 0;
+		szCel = "DT";
+		animationWidth = (c == HeroClass::Monk) ? 160 : 128;
+		break;
+	case player_graphic::Block:
+		if (leveltype == DTYPE_TOWN)
+			return 0;
+		if (!player._pBlockFlag)
+			return 0;
+		szCel = "BL";
+		if (c == HeroClass::Monk)
+			animationWidth = 98;
+		break;
+	default:
+		app_fatal("PLR:2");
+	}
+
+	if (leveltype == DTYPE_TOWN && useUnarmedAnimationInTown) {
+		// If the hero doesn't hold the weapon in town then we should use the unarmed animation for casting
+		switch (animWeaponId) {
+		case PlayerWeaponGraphic::Mace:
+		case PlayerWeaponGraphic::Sword:
+			animWeaponId = PlayerWeaponGraphic::Unarmed;
+			break;
+		case PlayerWeaponGraphic::SwordShield:
+		case PlayerWeaponGraphic::MaceShield:
+			animWeaponId = PlayerWeaponGraphic::UnarmedShield;
+			break;
+		default:
+			break;
+		}
+	}
+
+	char prefix[3] = { CharChar[static_cast<std::size_t>(c)], ArmourChar[gfxNum >> 4], WepChar[static_cast<std::size_t>(animWeaponId)] };
+	*fmt::format_to(pszName, FMT_COMPILE(R"(PlrGFX\{0}\{1}\{1}{2}.CL2)"), cs, string_view(prefix, 3), szCel) = 0;
+	return animationWidth;
+}
+
+/**
+ * @brief Swaps a graphic of the previous equipment for the one of the current equipment.
+ *
+ * The frame counts only depend on the class, so an animation that is being shown continues with the same frame.
+ */
+void ReplacePlayerGraphic(Player &player, PlayerAnimationData &animationData, const char *path, int width)
+{
+	const std::array<OptionalCelSprite, 8> previous = animationData.CelSpritesForDirections;
+	// Freed at the end, the animation and the preview may still point into it until then.
+	const std::unique_ptr<byte[]> previousData = std::move(animationData.RawData);
+	const size_t previousDataSize = animationData.RawDataSize;
+	SetPlayerGPtrs(path, animationData.RawData, animationData.RawDataSize, animationData.CelSpritesForDirections, width);
+	animationData.GfxNum = player._pgfxnum;
+	for (size_t i = 0; i < previous.size(); i++) {
+		if (!previous[i])
+			continue;
+		if (player.AnimInfo.celSprite == previous[i])
+			player.AnimInfo.celSprite = animationData.CelSpritesForDirections[i];
+		if (player.previewCelSprite == previous[i])
+			player.previewCelSprite = animationData.CelSpritesForDirections[i];
+	}
+	if (previousData != nullptr)
+		Cl2ForgetCachedFrames(previousData.get(), previousDataSize);
+#if DEVILUTIONX_PLAYER_GRAPHICS_BUDGET > 0
+	EnforcePlayerGraphicsBudget(animationData);
+#endif
+}
+
 void ClearStateVariables(Player &player)
 {
 	player.position.temp = { 0, 0 };
@@ -1771,6 +1983,43 @@ void CheckCheatStats(Player &player)
 	}
 }
 
+/** @brief The prediction is dropped if the game logic hasn't started the walk by then, e.g. because the command was lost */
+constexpr uint32_t MaxPredictionTicks = 1000;
+/** @brief How long a prediction that ended is blended out */
+constexpr uint32_t PredictionCorrectionTicks = 100;
+
+/** @brief Part of a step the predicted walk has covered, it stops at half a step so that correcting a wrong guess doesn't jump far */
+float GetPredictedWalkProgress(const Player &player)
+{
+	const uint32_t walkTicks = std::max<uint32_t>(player._pWFrames, 1) * gnTickDelay;
+	return std::min(static_cast<float>(SDL_GetTicks() - player.predictedWalkStartTicks) / walkTicks, 0.5F);
+}
+
+Displacement GetPredictedWalkDisplacement(const Player &player)
+{
+	if (!player.predictedWalkDirection)
+		return { 0, 0 };
+	return -Displacement(*player.predictedWalkDirection).worldToScreen() * GetPredictedWalkProgress(player);
+}
+
+/**
+ * @brief Ends the prediction of the local player's walk once the game logic caught up with it
+ *
+ * Only render state is predicted, so the game logic is never corrected. If the walk started the way it was
+ * predicted the sprite ahead of it is blended back onto it, if it didn't or never started it's blended back from the
+ * wrong direction.
+ */
+void UpdateWalkPrediction(Player &player)
+{
+	if (!player.predictedWalkDirection)
+		return;
+	if (player._pmode == PM_STAND && SDL_GetTicks() - player.predictedWalkStartTicks < MaxPredictionTicks)
+		return;
+	player.predictionCorrection = GetPredictedWalkOffset(player);
+	player.predictionCorrectionStartTicks = SDL_GetTicks();
+	player.predictedWalkDirection = std::nullopt;
+}
+
 } // namespace
 
 void Player::CalcScrolls()
@@ -2119,6 +2368,14 @@ void Player::UpdatePreviewCelSprite(_cmd_id cmdId, Point point, uint16_t wParam1
 		previewCelSprite = celSprites;
 		progressToNextGameTickWhenPreviewWasSet = gfProgressToNextGameTick;
 	}
+
+	// Commands of multiplayer games take a few game ticks to come back, walks are shown ahead of them.
+	if (gbIsMultiplayer && *sgOptions.Network.predictMovement && *graphic == player_graphic::Walk && predictedWalkDirection != dir) {
+		if (predictedWalkDirection)
+			UpdateWalkPrediction(*this);
+		predictedWalkDirection = dir;
+		predictedWalkStartTicks = SDL_GetTicks();
+	}
 }
 
 Player *PlayerAtPosition(Point position)
@@ -2139,117 +2396,20 @@ void LoadPlrGFX(Player &player, player_graphic graphic)
 		return;
 
 	auto &animationData = player.AnimationData[static_cast<size_t>(graphic)];
+	animationData.LastUse = ++PlayerGraphicsUseCounter;
+	// Graphics of the previous equipment are still used until UpdatePlayerGraphics replaces them.
 	if (animationData.RawData != nullptr)
 		return;
 
-	HeroClass c = player._pClass;
-	if (c == HeroClass::Bard && !hfbard_mpq) {
-		c = HeroClass::Rogue;
-	} else if (c == HeroClass::Barbarian && !hfbarb_mpq) {
-		c = HeroClass::Warrior;
-	}
-
-	auto animWeaponId = static_cast<PlayerWeaponGraphic>(player._pgfxnum & 0xF);
-	int animationWidth = 96;
-	bool useUnarmedAnimationInTown = false;
-
-	const char *cs = ClassPathTbl[static_cast<std::size_t>(c)];
-
-	const char *szCel;
-	switch (graphic) {
-	case player_graphic::Stand:
-		szCel = "AS";
-		if (leveltype == DTYPE_TOWN)
-			szCel = "ST";
-		if (c == HeroClass::Monk)
-			animationWidth = 112;
-		break;
-	case player_graphic::Walk:
-		szCel = "AW";
-		if (leveltype == DTYPE_TOWN)
-			szCel = "WL";
-		if (c == HeroClass::Monk)
-			animationWidth = 112;
-		break;
-	case player_graphic::Attack:
-		if (leveltype == DTYPE_TOWN)
-			return;
-		szCel = "AT";
-		if (c == HeroClass::Monk)
-			animationWidth = 130;
-		else if (animWeaponId != PlayerWeaponGraphic::Bow || !(c == HeroClass::Warrior || c == HeroClass::Barbarian))
-			animationWidth = 128;
-		break;
-	case player_graphic::Hit:
-		if (leveltype == DTYPE_TOWN)
-			return;
-		szCel = "HT";
-		if (c == HeroClass::Monk)
-			animationWidth = 98;
-		break;
-	case player_graphic::Lightning:
-		szCel = "LM";
-		useUnarmedAnimationInTown = true;
-		if (c == HeroClass::Monk)
-			animationWidth = 114;
-		else if (c == HeroClass::Sorcerer)
-			animationWidth = 128;
-		break;
-	case player_graphic::Fire:
-		szCel = "FM";
-		useUnarmedAnimationInTown = true;
-		if (c == HeroClass::Monk)
-			animationWidth = 114;
-		else if (c == HeroClass::Sorcerer)
-			animationWidth = 128;
-		break;
-	case player_graphic::Magic:
-		szCel = "QM";
-		useUnarmedAnimationInTown = true;
-		if (c == HeroClass::Monk)
-			animationWidth = 114;
-		else if (c == HeroClass::Sorcerer)
-			animationWidth = 128;
-		break;
-	case player_graphic::Death:
-		if (animWeaponId != PlayerWeaponGraphic::Unarmed)
-			return;
-		szCel = "DT";
-		animationWidth = (c == HeroClass::Monk) ? 160 : 128;
-		break;
-	case player_graphic::Block:
-		if (leveltype == DTYPE_TOWN)
-			return;
-		if (!player._pBlockFlag)
-			return;
-		szCel = "BL";
-		if (c == HeroClass::Monk)
-			animationWidth = 98;
-		break;
-	default:
-		app_fatal("PLR:2");
-	}
-
-	if (leveltype == DTYPE_TOWN && useUnarmedAnimationInTown) {
-		// If the hero doesn't hold the weapon in town then we should use the unarmed animation for casting
-		switch (animWeaponId) {
-		case PlayerWeaponGraphic::Mace:
-		case PlayerWeaponGraphic::Sword:
-			animWeaponId = PlayerWeaponGraphic::Unarmed;
-			break;
-		case PlayerWeaponGraphic::SwordShield:
-		case PlayerWeaponGraphic::MaceShield:
-			animWeaponId = PlayerWeaponGraphic::UnarmedShield;
-			break;
-		default:
-			break;
-		}
-	}
-
-	char prefix[3] = { CharChar[static_cast<std::size_t>(c)], ArmourChar[player._pgfxnum >> 4], WepChar[static_cast<std::size_t>(animWeaponId)] };
 	char pszName[256];
-	*fmt::format_to(pszName, FMT_COMPILE(R"(PlrGFX\{0}\{1}\{1}{2}.CL2)"), cs, string_view(prefix, 3), szCel) = 0;
-	SetPlayerGPtrs(pszName, animationData.RawData, animationData.CelSpritesForDirections, animationWidth);
+	const int animationWidth = GetPlrGFXPath(player, graphic, player._pgfxnum, pszName);
+	if (animationWidth == 0)
+		return;
+	SetPlayerGPtrs(pszName, animationData.RawData, animationData.RawDataSize, animationData.CelSpritesForDirections, animationWidth);
+	animationData.GfxNum = player._pgfxnum;
+#if DEVILUTIONX_PLAYER_GRAPHICS_BUDGET > 0
+	EnforcePlayerGraphicsBudget(animationData);
+#endif
 }
 
 void InitPlayerGFX(Player &player)
@@ -2265,21 +2425,81 @@ void InitPlayerGFX(Player &player)
 		return;
 	}
 
+#if DEVILUTIONX_PLAYER_GRAPHICS_BUDGET > 0
+	// The other graphics are loaded by NewPlrAnim when they are first needed.
+	LoadPlrGFX(player, player_graphic::Stand);
+#else
 	for (size_t i = 0; i < enum_size<player_graphic>::value; i++) {
 		auto graphic = static_cast<player_graphic>(i);
 		if (graphic == player_graphic::Death)
 			continue;
 		LoadPlrGFX(player, graphic);
 	}
+#endif
 }
 
 void ResetPlayerGFX(Player &player)
 {
 	player.AnimInfo.celSprite = std::nullopt;
-	for (auto &animData : player.AnimationData) {
-		for (auto &celSprite : animData.CelSpritesForDirections)
-			celSprite = std::nullopt;
-		animData.RawData = nullptr;
+	for (auto &animData : player.AnimationData)
+		FreePlayerAnimationData(animData);
+}
+
+void ReleaseHiddenPlayerGFX(Player &player)
+{
+	for (size_t i = 0; i < player.AnimationData.size(); i++) {
+		const auto graphic = static_cast<player_graphic>(i);
+		PlayerAnimationData &animationData = player.AnimationData[i];
+		if (graphic != player_graphic::Stand && graphic != player_graphic::Walk && !IsPlayerGraphicShown(player, animationData))
+			FreePlayerAnimationData(animationData);
+	}
+}
+
+void PrefetchPlrGFX(const Player &player, player_graphic graphic, int gfxNum)
+{
+	if (HeadlessMode)
+		return;
+
+	char pszName[256];
+	if (GetPlrGFXPath(player, graphic, gfxNum, pszName) != 0)
+		PrefetchAsset(pszName);
+}
+
+void DiscardPrefetchedPlrGFX(const Player &player, player_graphic graphic, int gfxNum)
+{
+	if (HeadlessMode)
+		return;
+
+	char pszName[256];
+	if (GetPlrGFXPath(player, graphic, gfxNum, pszName) != 0)
+		DiscardPrefetchedAsset(pszName);
+}
+
+void UpdatePlayerGraphics()
+{
+	if (HeadlessMode)
+		return;
+
+	for (Player &player : Players) {
+		for (size_t i = 0; i < player.AnimationData.size(); i++) {
+			PlayerAnimationData &animationData = player.AnimationData[i];
+			if (animationData.RawData == nullptr || animationData.GfxNum == player._pgfxnum)
+				continue;
+			char pszName[256];
+			const int width = GetPlrGFXPath(player, static_cast<player_graphic>(i), player._pgfxnum, pszName);
+			if (width == 0) {
+				// There is no such graphic with the new equipment, the old one stays for as long as it is shown.
+				if (IsPlayerGraphicShown(player, animationData))
+					animationData.GfxNum = player._pgfxnum;
+				else
+					FreePlayerAnimationData(animationData);
+				continue;
+			}
+			const PrefetchStatus status = GetPrefetchStatus(pszName);
+			if (status == PrefetchStatus::Loading || (status == PrefetchStatus::NotQueued && PrefetchAsset(pszName)))
+				continue;
+			ReplacePlayerGraphic(player, animationData, pszName, width);
+		}
 	}
 }
 
@@ -3189,6 +3409,8 @@ void ProcessPlayers()
 	assert(MyPlayer != nullptr);
 	Player &myPlayer = *MyPlayer;
 
+	UpdatePlayerGraphics();
+
 	if (myPlayer.pLvlLoad > 0) {
 		myPlayer.pLvlLoad--;
 	}
@@ -3273,12 +3495,27 @@ void ProcessPlayers()
 			} while (tplayer);
 
 			player.previewCelSprite = std::nullopt;
+			UpdateWalkPrediction(player);
 			if (player._pmode != PM_DEATH || player.AnimInfo.tickCounterOfCurrentFrame != 40)
 				player.AnimInfo.processAnimation();
 		}
 	}
 }
 
+Displacement GetPredictedWalkOffset(const Player &player)
+{
+	Displacement offset = GetPredictedWalkDisplacement(player);
+	const uint32_t correctionTicks = SDL_GetTicks() - player.predictionCorrectionStartTicks;
+	if (correctionTicks < PredictionCorrectionTicks)
+		offset += player.predictionCorrection * (static_cast<float>(PredictionCorrectionTicks - correctionTicks) / PredictionCorrectionTicks);
+	return offset;
+}
+
+int GetPredictedWalkFrame(const Player &player)
+{
+	return std::min(static_cast<int>(GetPredictedWalkProgress(player) * player._pWFrames), player._pWFrames - 1);
+}
+
 void ClrPlrPath(Player &player)
 {
 	memset(player.walkpath, WALK_NONE, sizeof(player.walkpath));
@@ -3485,6 +3722,7 @@ void SyncPlrAnim(Player &player)
 		app_fatal("SyncPlrAnim");
 	}
 
+	LoadPlrGFX(player, graphic);
 	player.AnimInfo.celSprite = player.AnimationData[static_cast<size_t>(graphic)].GetCelSpritesForDirection(player._pdir);
 	// Ensure ScrollInfo is initialized correctly
 	ScrollViewPort(player, WalkSettings[static_cast<size_t>(player._pdir)].scrollDir);
@@ -25,6 +25,7 @@
 #include "utils/attributes.h"
 #include "utils/enum_traits.h"
 #include "utils/stdcompat/algorithm.hpp"
+#include "utils/stdcompat/optional.hpp"
 
 namespace devilution {
 
@@ -203,6 +204,18 @@ struct PlayerAnimationData {
 	 *        Is referenced from CelSprite in celSpritesForDirections
 	 */
 	std::unique_ptr<byte[]> RawData;
+	/**
+	 * @brief Size of RawData in bytes
+	 */
+	size_t RawDataSize = 0;
+	/**
+	 * @brief When the graphic was last requested, used to free the least recently used graphics first
+	 */
+	uint32_t LastUse = 0;
+	/**
+	 * @brief The equipment (Player::_pgfxnum) the graphic was loaded for
+	 */
+	int GfxNum = 0;
 
 	[[nodiscard]] OptionalCelSprite GetCelSpritesForDirection(Direction direction) const
 	{
@@ -240,6 +253,18 @@ struct Player {
 	 * @brief Contains the progress to next game tick when previewCelSprite was set
 	 */
 	float progressToNextGameTickWhenPreviewWasSet;
+	/**
+	 * @brief Direction of a walk that is shown before the game logic starts it, only set for the local player in multiplayer games
+	 *
+	 * The walk only moves the sprite and the camera, the player stays on its tile until the command comes back from the other players.
+	 */
+	std::optional<Direction> predictedWalkDirection = std::nullopt;
+	/** @brief SDL ticks when predictedWalkDirection was set */
+	uint32_t predictedWalkStartTicks = 0;
+	/** @brief Offset the prediction was shown at when it ended, it is blended out to hide the correction */
+	Displacement predictionCorrection = { 0, 0 };
+	/** @brief SDL ticks when the prediction ended */
+	uint32_t predictionCorrectionStartTicks = 0;
 	int _plid;
 	int _pvid;
 	spell_id _pSpell;
@@ -749,6 +774,27 @@ void LoadPlrGFX(Player &player, player_graphic graphic);
 void InitPlayerGFX(Player &player);
 void ResetPlayerGFX(Player &player);
 
+/**
+ * @brief Frees the graphics of the player after an equipment change, except for the ones being shown and the stand and
+ * walk graphics.
+ *
+ * The graphics that are kept are swapped for the ones of the new equipment by UpdatePlayerGraphics once those were read
+ * in the background, so changing equipment doesn't stall on reading the MPQ.
+ */
+void ReleaseHiddenPlayerGFX(Player &player);
+
+/** @brief Starts reading a graphic of the player with the given equipment (see Player::_pgfxnum) in the background. */
+void PrefetchPlrGFX(const Player &player, player_graphic graphic, int gfxNum);
+
+/** @brief Frees a graphic queued by PrefetchPlrGFX if it hasn't been taken yet. */
+void DiscardPrefetchedPlrGFX(const Player &player, player_graphic graphic, int gfxNum);
+
+/**
+ * @brief Swaps the graphics of the previous equipment that are still loaded for the ones of the current equipment once
+ * those were read.
+ */
+void UpdatePlayerGraphics();
+
 /**
  * @brief Sets the new Player Animation with all relevant information for rendering
  * @param player The player to set the animation for
@@ -791,6 +837,14 @@ void StartNewLvl(Player &player, interface_mode fom, int lvl);
 void RestartTownLvl(Player &player);
 void StartWarpLvl(Player &player, int pidx);
 void ProcessPlayers();
+/**
+ * @brief Returns the screen offset by which the local player is drawn ahead of its position while its walk is predicted, see Player::predictedWalkDirection
+ */
+Displacement GetPredictedWalkOffset(const Player &player);
+/**
+ * @brief Returns the frame of the walk animation to draw while the walk is predicted
+ */
+int GetPredictedWalkFrame(const Player &player);
 void ClrPlrPath(Player &player);
 bool PosOkPlayer(const Player &player, Point position);
 void MakePlrPath(Player &player, Point targetPosition, bool endspace);
@@ -15,6 +15,7 @@
 #include "qol/chatlog.h"
 #include "qol/stash.h"
 #include "utils/language.h"
+#include "utils/static_ring_buffer.hpp"
 #include "utils/utf8.hpp"
 
 namespace devilution {
@@ -32,9 +33,16 @@ struct PlayerMessage {
 	string_view from;
 	/** The line height of the text */
 	int lineHeight;
+	/** The text word wrapped to wrappedWidth, empty until the message is drawn */
+	std::string wrappedText;
+	int wrappedWidth;
+	int wrappedLines;
+	/** The translations and fonts the text was wrapped with */
+	uint32_t languageGeneration;
 };
 
-std::array<PlayerMessage, 8> Messages;
+/** @brief The most recent messages, the newest one is at the back. */
+StaticRingBuffer<PlayerMessage, 8> Messages;
 
 int CountLinesOfText(string_view text)
 {
@@ -43,9 +51,19 @@ int CountLinesOfText(string_view text)
 
 PlayerMessage &GetNextMessage()
 {
-	std::move_backward(Messages.begin(), Messages.end() - 1, Messages.end()); // Push back older messages
+	return Messages.emplace_back(); // Replaces the oldest message once the buffer is full
+}
 
-	return Messages.front();
+/** @brief Word wraps the message, unless it was wrapped to the same width and with the same language already. */
+const std::string &GetWrappedText(PlayerMessage &message, int width)
+{
+	if (message.languageGeneration != LanguageGeneration || message.wrappedWidth != width) {
+		message.wrappedText = WordWrapString(message.text, width);
+		message.wrappedWidth = width;
+		message.wrappedLines = CountLinesOfText(message.wrappedText);
+		message.languageGeneration = LanguageGeneration;
+	}
+	return message.wrappedText;
 }
 
 } // namespace
@@ -60,8 +78,8 @@ void plrmsg_delay(bool delay)
 	}
 
 	plrmsgTicks += SDL_GetTicks();
-	for (PlayerMessage &message : Messages)
-		message.time += plrmsgTicks;
+	for (size_t i = 0; i < Messages.size(); i++)
+		Messages[i].time += plrmsgTicks;
 }
 
 void EventPlrMsg(string_view text, UiFlags style)
@@ -92,7 +110,7 @@ void SendPlrMsg(Player &player, string_view text)
 
 void InitPlrMsg()
 {
-	Messages = {};
+	Messages.clear();
 }
 
 void DrawPlrMsg(const Surface &out)
@@ -116,14 +134,15 @@ void DrawPlrMsg(const Surface &out)
 
 	width = std::min(540, width);
 
-	for (PlayerMessage &message : Messages) {
+	for (size_t i = Messages.size(); i-- > 0;) {
+		PlayerMessage &message = Messages[i];
 		if (message.text.empty())
 			break;
 		if (!talkflag && SDL_GetTicks() - message.time >= 10000)
 			break;
 
-		std::string text = WordWrapString(message.text, width);
-		int chatlines = CountLinesOfText(text);
+		const std::string &text = GetWrappedText(message, width);
+		const int chatlines = message.wrappedLines;
 		y -= message.lineHeight * chatlines;
 
 		DrawHalfTransparentRectTo(out, x - 3, y, width + 6, message.lineHeight * chatlines);
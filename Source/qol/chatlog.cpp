@@ -3,6 +3,7 @@
  *
  * Implementation of the in-game chat log.
  */
+#include <algorithm>
 #include <ctime>
 
 #include <string>
@@ -24,8 +25,14 @@
 #include "minitext.h"
 #include "stores.h"
 #include "utils/language.h"
+#include "utils/static_ring_buffer.hpp"
+#include "utils/static_vector.hpp"
 #include "utils/stdcompat/string_view.hpp"
 
+#ifndef DEVILUTIONX_CHAT_LOG_MESSAGES
+#define DEVILUTIONX_CHAT_LOG_MESSAGES 512
+#endif
+
 namespace devilution {
 
 namespace {
@@ -35,23 +42,89 @@ struct ColoredText {
 	UiFlags color;
 };
 
+/** @brief A chat log line is at most a timestamp and a message. */
+constexpr size_t MaxColoredTextParts = 2;
+
 struct MultiColoredText {
 	std::string text;
 	std::vector<ColoredText> colors;
 	int offset = 0;
 };
 
+constexpr int PaddingTop = 32;
+constexpr int PaddingLeft = 32;
+
+constexpr int PanelHeight = 297;
+constexpr int ContentTextWidth = 577;
+
+/** @brief Indent of the text of messages sent by players. */
+constexpr int PlayerMessageOffset = 20;
+
+struct ChatLogMessage {
+	std::string timestamp;
+	/** @brief Name and level of the player that sent the message, empty for messages from the game. */
+	std::string playerInfo;
+	/** @brief Color of the text, or of the player's name for messages sent by players. */
+	UiFlags color;
+	std::string text;
+
+	/** @brief The message word wrapped into lines, from the top to the bottom. */
+	std::vector<MultiColoredText> lines;
+	/** @brief The translations and fonts the lines were wrapped with. */
+	uint32_t languageGeneration = 0;
+};
+
 bool UnreadFlag = false;
 unsigned int SkipLines;
 unsigned int MessageCounter = 0;
 
-std::vector<MultiColoredText> ChatLogLines;
+/** @brief The newest messages are at the back, the oldest ones are dropped once the log is full. */
+StaticRingBuffer<ChatLogMessage, DEVILUTIONX_CHAT_LOG_MESSAGES> ChatLogMessages;
 
-constexpr int PaddingTop = 32;
-constexpr int PaddingLeft = 32;
+void SplitLines(string_view text, std::vector<string_view> &lines)
+{
+	lines.clear();
+	size_t start = 0;
+	for (size_t end; (end = text.find('\n', start)) != string_view::npos; start = end + 1)
+		lines.push_back(text.substr(start, end - start));
+	lines.push_back(text.substr(start));
+}
 
-constexpr int PanelHeight = 297;
-constexpr int ContentTextWidth = 577;
+/** @brief Word wraps the message unless it was wrapped with the current language already. */
+const std::vector<MultiColoredText> &GetLines(ChatLogMessage &message)
+{
+	if (message.languageGeneration == LanguageGeneration)
+		return message.lines;
+	message.languageGeneration = LanguageGeneration;
+	message.lines.clear();
+
+	std::vector<string_view> wrapped;
+	if (message.playerInfo.empty()) {
+		const std::string text = WordWrapString(message.timestamp + " " + message.text, ContentTextWidth);
+		SplitLines(text, wrapped);
+		// The timestamp has no spaces and fits the width, so it can't be split.
+		const size_t prefixLength = std::min(message.timestamp.size() + 1, wrapped[0].size());
+		message.lines.push_back(MultiColoredText { "{0} {1}", { { message.timestamp, UiFlags::ColorRed }, { std::string(wrapped[0].substr(prefixLength)), message.color } } });
+		for (size_t i = 1; i < wrapped.size(); i++)
+			message.lines.push_back(MultiColoredText { "{0}", { { std::string(wrapped[i]), message.color } } });
+	} else {
+		message.lines.push_back(MultiColoredText { "{0} - {1}", { { message.timestamp, UiFlags::ColorRed }, { message.playerInfo, message.color } } });
+		const std::string text = WordWrapString(message.text, ContentTextWidth - PlayerMessageOffset * 2);
+		SplitLines(text, wrapped);
+		for (string_view line : wrapped)
+			message.lines.push_back(MultiColoredText { std::string(line), { {} }, PlayerMessageOffset });
+	}
+	message.lines.push_back(MultiColoredText { "", { {} } });
+	return message.lines;
+}
+
+size_t CountChatLogLines()
+{
+	size_t count = 0;
+	for (size_t i = 0; i < ChatLogMessages.size(); i++)
+		count += GetLines(ChatLogMessages[i]).size();
+	return count;
+}
 
 int LineHeight()
 {
@@ -123,21 +196,19 @@ void AddMessageToChatLog(string_view message, Player *player, UiFlags flags)
 	const std::tm *localtimeResult = localtime(&timeResult);
 	std::string timestamp = localtimeResult != nullptr ? fmt::format("[#{:d}] {:02}:{:02}:{:02}", MessageCounter, localtimeResult->tm_hour, localtimeResult->tm_min, localtimeResult->tm_sec)
 	                                                   : fmt::format("[#{:d}] ", MessageCounter);
-	int oldSize = ChatLogLines.size();
-	ChatLogLines.emplace_back(MultiColoredText { "", { {} } });
+	ChatLogMessage &entry = ChatLogMessages.emplace_back();
+	entry.timestamp = std::move(timestamp);
+	entry.text = std::string(message);
 	if (player == nullptr) {
-		ChatLogLines.emplace_back(MultiColoredText { "{0} {1}", { { timestamp, UiFlags::ColorRed }, { std::string(message), flags } } });
+		entry.color = flags;
 	} else {
-		std::string playerInfo = fmt::format(fmt::runtime(_("{:s} (lvl {:d}): ")), player->_pName, player->_pLevel);
-		ChatLogLines.emplace_back(MultiColoredText { std::string(message), { {} }, 20 });
-		UiFlags nameColor = player == MyPlayer ? UiFlags::ColorWhitegold : UiFlags::ColorBlue;
-		ChatLogLines.emplace_back(MultiColoredText { "{0} - {1}", { { timestamp, UiFlags::ColorRed }, { playerInfo, nameColor } } });
+		entry.playerInfo = fmt::format(fmt::runtime(_("{:s} (lvl {:d}): ")), player->_pName, player->_pLevel);
+		entry.color = player == MyPlayer ? UiFlags::ColorWhitegold : UiFlags::ColorBlue;
 	}
 
-	unsigned int diff = ChatLogLines.size() - oldSize;
 	// only autoscroll when on top of the log
 	if (SkipLines != 0) {
-		SkipLines += diff;
+		SkipLines += GetLines(entry).size();
 		UnreadFlag = true;
 	}
 }
@@ -173,17 +244,26 @@ void DrawChatLog(const Surface &out)
 
 	const int numLines = NumVisibleLines();
 	const int contentY = titleBottom + DividerLineMarginY() + ContentPaddingY();
-	for (int i = 0; i < numLines; i++) {
-		if (i + SkipLines >= ChatLogLines.size())
-			break;
-		MultiColoredText &text = ChatLogLines[ChatLogLines.size() - (i + SkipLines + 1)];
-		const string_view line = text.text;
-
-		std::vector<DrawStringFormatArg> args;
-		for (auto &x : text.colors) {
-			args.emplace_back(DrawStringFormatArg { x.text, x.color });
+	// Only the messages above the visible ones are walked, their lines are counted but not wrapped again.
+	size_t skip = SkipLines;
+	int i = 0;
+	for (size_t messageIndex = ChatLogMessages.size(); messageIndex-- > 0 && i < numLines;) {
+		const std::vector<MultiColoredText> &lines = GetLines(ChatLogMessages[messageIndex]);
+		if (skip >= lines.size()) {
+			skip -= lines.size();
+			continue;
+		}
+		for (size_t lineIndex = skip; lineIndex < lines.size() && i < numLines; lineIndex++, i++) {
+			const MultiColoredText &text = lines[lineIndex];
+			const string_view line = text.text;
+
+			StaticVector<DrawStringFormatArg, MaxColoredTextParts> args;
+			for (auto &x : text.colors) {
+				args.emplace_back(DrawStringFormatArg { x.text, x.color });
+			}
+			DrawStringWithColors(out, line, args.data(), args.size(), { { (sx + text.offset), contentY + i * lineHeight }, { ContentTextWidth - text.offset * 2, lineHeight } }, UiFlags::ColorWhite, /*spacing=*/1, lineHeight);
 		}
-		DrawStringWithColors(out, line, args, { { (sx + text.offset), contentY + i * lineHeight }, { ContentTextWidth - text.offset * 2, lineHeight } }, UiFlags::ColorWhite, /*spacing=*/1, lineHeight);
+		skip = 0;
 	}
 
 	DrawString(out, _("Press ESC to end or the arrow keys to scroll."),
@@ -199,7 +279,7 @@ void ChatLogScrollUp()
 
 void ChatLogScrollDown()
 {
-	if (SkipLines + NumVisibleLines() < ChatLogLines.size())
+	if (SkipLines + NumVisibleLines() < CountChatLogLines())
 		SkipLines++;
 }
 
@@ -210,7 +290,7 @@ void ChatLogScrollTop()
 
 void ChatLogScrollBottom()
 {
-	SkipLines = ChatLogLines.size() - NumVisibleLines();
+	SkipLines = CountChatLogLines() - NumVisibleLines();
 }
 
 } // namespace devilution
@@ -1,8 +1,11 @@
 #include "itemlabels.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
 #include <string>
-#include <unordered_set>
-#include <vector>
+#include <utility>
 
 #include <fmt/format.h>
 
@@ -10,6 +13,7 @@
 #include "cursor.h"
 #include "engine/point.hpp"
 #include "engine/render/cl2_render.hpp"
+#include "engine/render/scrollrt.h"
 #include "gmenu.h"
 #include "inv.h"
 #include "itemlabels.h"
@@ -17,6 +21,7 @@
 #include "qol/stash.h"
 #include "utils/format_int.hpp"
 #include "utils/language.h"
+#include "utils/static_vector.hpp"
 #include "utils/stdcompat/string_view.hpp"
 
 namespace devilution {
@@ -26,10 +31,35 @@ namespace {
 struct ItemLabel {
 	int id, width;
 	Point pos;
+
+	bool operator==(const ItemLabel &other) const
+	{
+		return id == other.id && width == other.width && pos == other.pos;
+	}
+};
+
+/** @brief Text of the label of an item together with what it was built from. */
+struct ItemLabelText {
+	int32_t seed;
+	uint16_t createInfo;
+	bool identified;
+	int value;
+	int width;
 	std::string text;
+
+	[[nodiscard]] bool IsFor(const Item &item) const
+	{
+		return seed == item._iSeed && createInfo == item._iCreateInfo && identified == item._iIdentified && value == item._ivalue;
+	}
 };
 
-std::vector<ItemLabel> labelQueue;
+/** @brief Every item is drawn at most once per frame. */
+StaticVector<ItemLabel, MAXITEMS> labelQueue;
+/** @brief The labels queued last frame before and after the layout, which is reused while the queue doesn't change. */
+StaticVector<ItemLabel, MAXITEMS> previousQueue;
+StaticVector<ItemLabel, MAXITEMS> previousLayout;
+/** @brief Formatting and measuring the names every frame is expensive, so they are kept per item index until the item changes. */
+std::array<std::optional<ItemLabelText>, MAXITEMS> labelTexts;
 
 bool altPressed = false;
 bool isLabelHighlighted = false;
@@ -65,19 +95,24 @@ bool IsHighlightingLabelsEnabled()
 
 void AddItemToLabelQueue(int id, int x, int y)
 {
-	if (!IsHighlightingLabelsEnabled())
+	if (!IsHighlightingLabelsEnabled() || labelQueue.size() >= static_cast<size_t>(std::max(*sgOptions.Performance.itemLabels, 0)) || labelQueue.full())
 		return;
 	Item &item = Items[id];
 
-	std::string textOnGround;
-	if (item._itype == ItemType::Gold) {
-		textOnGround = fmt::format(fmt::runtime(_("{:s} gold")), FormatInteger(item._ivalue));
-	} else {
-		textOnGround = item._iIdentified ? item._iIName : item._iName;
+	std::optional<ItemLabelText> &labelText = labelTexts[id];
+	if (!labelText || !labelText->IsFor(item)) {
+		std::string textOnGround;
+		if (item._itype == ItemType::Gold) {
+			char value[FormatIntegerBufferSize];
+			textOnGround = fmt::format(fmt::runtime(_("{:s} gold")), FormatIntegerTo(value, item._ivalue));
+		} else {
+			textOnGround = item._iIdentified ? item._iIName : item._iName;
+		}
+		const int width = GetLineWidth(textOnGround);
+		labelText = ItemLabelText { item._iSeed, item._iCreateInfo, item._iIdentified, item._ivalue, width, std::move(textOnGround) };
 	}
 
-	int nameWidth = GetLineWidth(textOnGround);
-	nameWidth += MarginX * 2;
+	const int nameWidth = labelText->width + MarginX * 2;
 	int index = ItemCAnimTbl[item._iCurs];
 	if (!labelCenterOffsets[index]) {
 		std::pair<int, int> itemBounds = Cl2MeasureSolidHorizontalBounds(*item.AnimInfo.celSprite, item.AnimInfo.currentFrame);
@@ -86,12 +121,12 @@ void AddItemToLabelQueue(int id, int x, int y)
 
 	x += *labelCenterOffsets[index];
 	y -= TILE_HEIGHT;
-	if (*sgOptions.Graphics.zoom) {
+	if (IsViewZoomed()) {
 		x *= 2;
 		y *= 2;
 	}
 	x -= nameWidth / 2;
-	labelQueue.push_back(ItemLabel { id, nameWidth, { x, y - Height }, textOnGround });
+	labelQueue.emplace_back(ItemLabel { id, nameWidth, { x, y - Height } });
 }
 
 bool IsMouseOverGameArea()
@@ -113,40 +148,87 @@ void FillRect(const Surface &out, int x, int y, int width, int height, Uint8 col
 	}
 }
 
-void DrawItemNameLabels(const Surface &out)
+namespace {
+
+/**
+ * @brief Moves the labels sideways until they don't overlap, each label only moves away from the labels before it.
+ *
+ * Labels never move vertically, so only the labels in the same band of rows can collide. The labels are swept in
+ * the order of their rows to find those, the rest of the queue is never looked at.
+ */
+void LayoutItemLabels(StaticVector<ItemLabel, MAXITEMS> &labels)
 {
-	isLabelHighlighted = false;
+	StaticVector<std::pair<int, unsigned>, MAXITEMS> rows;
+	for (unsigned i = 0; i < labels.size(); ++i)
+		rows.emplace_back(labels[i].pos.y, i);
+	std::sort(rows.begin(), rows.end());
+
+	StaticVector<unsigned, MAXITEMS> neighbours;
+	for (unsigned i = 0; i < labels.size(); ++i) {
+		const int y = labels[i].pos.y;
+		neighbours.clear();
+		auto it = std::lower_bound(rows.begin(), rows.end(), std::pair<int, unsigned> { y - (Height + BorderY) + 1, 0 });
+		for (; it != rows.end() && it->first < y + Height + BorderY; ++it) {
+			if (it->second < i)
+				neighbours.emplace_back(it->second);
+		}
+		// The earlier labels are visited in queue order, the same order the labels are placed in.
+		std::sort(neighbours.begin(), neighbours.end());
 
-	for (unsigned int i = 0; i < labelQueue.size(); ++i) {
-		std::unordered_set<int> backtrace;
+		// A label only moves next to one of the labels before it, so there are at most two positions per label.
+		StaticVector<int, 2 * MAXITEMS> backtrace;
+		const auto isInBacktrace = [&backtrace](int pos) {
+			return std::find(backtrace.begin(), backtrace.end(), pos) != backtrace.end();
+		};
 
 		bool canShow;
 		do {
 			canShow = true;
-			for (unsigned int j = 0; j < i; ++j) {
-				ItemLabel &a = labelQueue[i];
-				ItemLabel &b = labelQueue[j];
-				if (abs(b.pos.y - a.pos.y) < Height + BorderY) {
-					int widthA = a.width + BorderX + MarginX * 2;
-					int widthB = b.width + BorderX + MarginX * 2;
-					int newpos = b.pos.x;
-					if (b.pos.x >= a.pos.x && b.pos.x - a.pos.x < widthA) {
-						newpos -= widthA;
-						if (backtrace.find(newpos) != backtrace.end())
-							newpos = b.pos.x + widthB;
-					} else if (b.pos.x < a.pos.x && a.pos.x - b.pos.x < widthB) {
-						newpos += widthB;
-						if (backtrace.find(newpos) != backtrace.end())
-							newpos = b.pos.x - widthA;
-					} else
-						continue;
-					canShow = false;
-					a.pos.x = newpos;
-					backtrace.insert(newpos);
-				}
+			for (unsigned j : neighbours) {
+				ItemLabel &a = labels[i];
+				ItemLabel &b = labels[j];
+				int widthA = a.width + BorderX + MarginX * 2;
+				int widthB = b.width + BorderX + MarginX * 2;
+				int newpos = b.pos.x;
+				if (b.pos.x >= a.pos.x && b.pos.x - a.pos.x < widthA) {
+					newpos -= widthA;
+					if (isInBacktrace(newpos))
+						newpos = b.pos.x + widthB;
+				} else if (b.pos.x < a.pos.x && a.pos.x - b.pos.x < widthB) {
+					newpos += widthB;
+					if (isInBacktrace(newpos))
+						newpos = b.pos.x - widthA;
+				} else
+					continue;
+				canShow = false;
+				a.pos.x = newpos;
+				if (!isInBacktrace(newpos))
+					backtrace.emplace_back(newpos);
 			}
 		} while (!canShow);
 	}
+}
+
+} // namespace
+
+void DrawItemNameLabels(const Surface &out)
+{
+	isLabelHighlighted = false;
+
+	// Unless the camera moved or the items changed, the labels end up where they were last frame.
+	if (labelQueue.size() == previousQueue.size() && std::equal(labelQueue.begin(), labelQueue.end(), previousQueue.begin())) {
+		labelQueue.clear();
+		for (const ItemLabel &label : previousLayout)
+			labelQueue.emplace_back(label);
+	} else {
+		previousQueue.clear();
+		for (const ItemLabel &label : labelQueue)
+			previousQueue.emplace_back(label);
+		LayoutItemLabels(labelQueue);
+		previousLayout.clear();
+		for (const ItemLabel &label : labelQueue)
+			previousLayout.emplace_back(label);
+	}
 
 	for (const ItemLabel &label : labelQueue) {
 		Item &item = Items[label.id];
@@ -162,7 +244,7 @@ void DrawItemNameLabels(const Surface &out)
 			FillRect(out, label.pos.x, label.pos.y + MarginY, label.width, Height, PAL8_BLUE + 6);
 		else
 			DrawHalfTransparentRectTo(out, label.pos.x, label.pos.y + MarginY, label.width, Height);
-		DrawString(out, label.text, { { label.pos.x + MarginX, label.pos.y }, { label.width, Height } }, item.getTextColor());
+		DrawString(out, labelTexts[label.id]->text, { { label.pos.x + MarginX, label.pos.y }, { label.width, Height } }, item.getTextColor());
 	}
 	labelQueue.clear();
 }
@@ -142,8 +142,10 @@ void DrawMonsterHealthBar(const Surface &out)
 		style |= UiFlags::ColorWhite;
 	DrawString(out, monster.name(), { position, { width, height } }, style);
 
-	if (multiplier > 0)
-		DrawString(out, StrCat("x", multiplier), { position, { width - 2, height } }, UiFlags::ColorWhite | UiFlags::AlignRight | UiFlags::VerticalCenter);
+	if (multiplier > 0) {
+		char multiplierText[16];
+		DrawString(out, StrCatTo(multiplierText, "x", multiplier), { position, { width - 2, height } }, UiFlags::ColorWhite | UiFlags::AlignRight | UiFlags::VerticalCenter);
+	}
 	if (monster.isUnique() || MonsterKillCounts[monster.type().type] >= 15) {
 		monster_resistance immunes[] = { IMMUNE_MAGIC, IMMUNE_FIRE, IMMUNE_LIGHTNING };
 		monster_resistance resists[] = { RESIST_MAGIC, RESIST_FIRE, RESIST_LIGHTNING };
@@ -18,6 +18,7 @@
 #include "miniwin/misc_msg.h"
 #include "stores.h"
 #include "utils/format_int.hpp"
+#include "utils/stdcompat/bit.hpp"
 #include "utils/language.h"
 #include "utils/str_cat.hpp"
 #include "utils/utf8.hpp"
@@ -66,6 +67,38 @@ void AddItemToStashGrid(unsigned page, Point position, uint16_t stashListIndex,
 	}
 }
 
+/**
+ * @brief Finds the first free area of the given size on a stash page, in the same order as StashGridRange.
+ *
+ * Each row of the page is turned into a bitmask of free cells, so the rows an item would cover can be checked
+ * for all columns at once.
+ * @return The top left cell of the free area or InvalidStashPoint if the item doesn't fit.
+ */
+Point FindFreeStashArea(const StashStruct::StashGrid &grid, Size itemSize)
+{
+	uint16_t freeRows[10];
+	for (int y = 0; y < 10; y++) {
+		freeRows[y] = 0;
+		for (int x = 0; x < 10; x++) {
+			if (grid[x][y] == 0)
+				freeRows[y] |= 1 << x;
+		}
+	}
+
+	for (int y = 0; y + itemSize.height <= 10; y++) {
+		unsigned freeColumns = 0x3FF;
+		for (int j = 0; j < itemSize.height; j++)
+			freeColumns &= freeRows[y + j];
+		// Afterwards bit x is set if the columns x up to x + width - 1 are all free.
+		for (int i = 1; i < itemSize.width; i++)
+			freeColumns &= freeColumns >> 1;
+		if (freeColumns != 0)
+			return { countr_zero(freeColumns), y };
+	}
+
+	return InvalidStashPoint;
+}
+
 Point FindSlotUnderCursor(Point cursorPosition)
 {
 	for (auto point : StashGridRange) {
@@ -151,7 +184,7 @@ void CheckStashPaste(Point cursorPosition)
 
 	AddItemToStashGrid(Stash.GetPage(), firstSlot, stashIndex, itemSize);
 
-	Stash.dirty = true;
+	Stash.MarkPageDirty(Stash.GetPage());
 
 	if (player.HoldItem.isEmpty() && !IsHardwareCursor()) {
 		// To make software cursors behave like hardware cursors we need to adjust the hand cursor position manually
@@ -537,7 +570,8 @@ void StashStruct::RemoveStashItem(StashStruct::StashCell iv)
 		}
 	}
 	stashList.pop_back();
-	Stash.dirty = true;
+	// Pages are saved with their own item indices, so renumbering the last item doesn't change the page it is on
+	MarkPageDirty(GetPage());
 }
 
 void StashStruct::SetPage(unsigned newPage)
@@ -624,7 +658,7 @@ void DrawGoldWithdraw(const Surface &out, int amount)
 	Cl2Draw(out, GetPanelPosition(UiPanels::Stash, { dialogX, 178 }), CelSprite { *pGBoxBuff }, 0);
 
 	// Pre-wrap the string at spaces, otherwise DrawString would hard wrap in the middle of words
-	const std::string wrapped = WordWrapString(_("How many gold pieces do you want to withdraw?"), 200);
+	const FrameString wrapped = WordWrapStringForFrame(_("How many gold pieces do you want to withdraw?"), 200);
 
 	// The split gold dialog is roughly 4 lines high, but we need at least one line for the player to input an amount.
 	// Using a clipping region 50 units high (approx 3 lines with a lineheight of 17) to ensure there is enough room left
@@ -681,28 +715,19 @@ bool AutoPlaceItemInStash(Player &player, const Item &item, bool persistItem)
 		// Wrap around if needed
 		if (pageIndex >= CountStashPages)
 			pageIndex -= CountStashPages;
-		// Search all possible position in stash grid
-		for (auto stashPosition : PointsInRectangleRange({ { 0, 0 }, Size { 10 - (itemSize.width - 1), 10 - (itemSize.height - 1) } })) {
-			// Check that all needed slots are free
-			bool isSpaceFree = true;
-			for (auto itemPoint : PointsInRectangleRange({ stashPosition, itemSize })) {
-				uint16_t iv = Stash.stashGrids[pageIndex][itemPoint.x][itemPoint.y];
-				if (iv != 0) {
-					isSpaceFree = false;
-					break;
-				}
-			}
-			if (!isSpaceFree)
-				continue;
-			if (persistItem) {
-				Stash.stashList.push_back(item);
-				uint16_t stashIndex = static_cast<uint16_t>(Stash.stashList.size() - 1);
-				Stash.stashList[stashIndex].position = stashPosition + Displacement { 0, itemSize.height - 1 };
-				AddItemToStashGrid(pageIndex, stashPosition, stashIndex, itemSize);
-				Stash.dirty = true;
-			}
-			return true;
+		// Pages that were never used are empty, there's no need to create them just to look at them
+		auto pageIt = Stash.stashGrids.find(pageIndex);
+		const Point stashPosition = pageIt != Stash.stashGrids.end() ? FindFreeStashArea(pageIt->second, itemSize) : Point { 0, 0 };
+		if (stashPosition == InvalidStashPoint)
+			continue;
+		if (persistItem) {
+			Stash.stashList.push_back(item);
+			uint16_t stashIndex = static_cast<uint16_t>(Stash.stashList.size() - 1);
+			Stash.stashList[stashIndex].position = stashPosition + Displacement { 0, itemSize.height - 1 };
+			AddItemToStashGrid(pageIndex, stashPosition, stashIndex, itemSize);
+			Stash.MarkPageDirty(pageIndex);
 		}
+		return true;
 	}
 
 	return false;
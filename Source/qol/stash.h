@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <map>
+#include <set>
 #include <vector>
 
 #include "engine/point.hpp"
@@ -25,6 +26,15 @@ public:
 	std::vector<Item> stashList;
 	int gold;
 	bool dirty = false;
+	/** @brief Pages whose items changed since the stash was saved, only these pages are written when saving. */
+	std::set<unsigned> dirtyPages;
+
+	/** @brief Flags a page to be written with the next save, e.g. after an item was added to or removed from it. */
+	void MarkPageDirty(unsigned pageIndex)
+	{
+		dirtyPages.insert(pageIndex);
+		dirty = true;
+	}
 
 	unsigned GetPage() const
 	{
@@ -5,6 +5,7 @@
  */
 #include "xpbar.h"
 
+#include <algorithm>
 #include <array>
 
 #include <fmt/core.h>
@@ -31,6 +32,15 @@ constexpr int BackHeight = 9;
 
 Art xpbarArt;
 
+/** @brief Formats a line of the tooltip on the stack, the panel strings are fixed-size buffers anyway. */
+template <typename... Args>
+void AddPanelStringFormatted(string_view format, Args &&...args)
+{
+	char buf[64];
+	const auto result = fmt::format_to_n(buf, sizeof(buf), fmt::runtime(format), std::forward<Args>(args)...);
+	AddPanelString({ buf, std::min(result.size, sizeof(buf)) });
+}
+
 void DrawBar(const Surface &out, Point screenPosition, int width, const ColorGradient &gradient)
 {
 	UnsafeDrawHorizontalLine(out, screenPosition + Displacement { 0, 1 }, width, gradient[gradient.size() * 3 / 4 - 1]);
@@ -124,13 +134,14 @@ bool CheckXPBarInfo()
 
 	const int8_t charLevel = player._pLevel;
 
-	AddPanelString(fmt::format(fmt::runtime(_("Level {:d}")), charLevel));
+	AddPanelStringFormatted(_("Level {:d}"), charLevel);
 
 	if (charLevel == MaxCharacterLevel) {
 		// Show a maximum level indicator for max level players.
 		InfoColor = UiFlags::ColorWhitegold;
 
-		AddPanelString(fmt::format(fmt::runtime(_("Experience: {:s}")), FormatInteger(ExpLvlsTbl[charLevel - 1])));
+		char value[FormatIntegerBufferSize];
+		AddPanelStringFormatted(_("Experience: {:s}"), FormatIntegerTo(value, ExpLvlsTbl[charLevel - 1]));
 		AddPanelString(_("Maximum Level"));
 
 		return true;
@@ -138,9 +149,10 @@ bool CheckXPBarInfo()
 
 	InfoColor = UiFlags::ColorWhite;
 
-	AddPanelString(fmt::format(fmt::runtime(_("Experience: {:s}")), FormatInteger(player._pExperience)));
-	AddPanelString(fmt::format(fmt::runtime(_("Next Level: {:s}")), FormatInteger(ExpLvlsTbl[charLevel])));
-	AddPanelString(fmt::format(fmt::runtime(_("{:s} to Level {:d}")), FormatInteger(ExpLvlsTbl[charLevel] - player._pExperience), charLevel + 1));
+	char value[FormatIntegerBufferSize];
+	AddPanelStringFormatted(_("Experience: {:s}"), FormatIntegerTo(value, player._pExperience));
+	AddPanelStringFormatted(_("Next Level: {:s}"), FormatIntegerTo(value, ExpLvlsTbl[charLevel]));
+	AddPanelStringFormatted(_("{:s} to Level {:d}"), FormatIntegerTo(value, ExpLvlsTbl[charLevel] - player._pExperience), charLevel + 1);
 
 	return true;
 }
@@ -0,0 +1,202 @@
+/**
+ * @file relay/main.cpp
+ *
+ * Entry point of devilutionx-relay, a headless server that hosts TCP games so that no player has to.
+ */
+#define SDL_MAIN_HANDLED
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <asio/steady_timer.hpp>
+#include <asio/ts/io_context.hpp>
+
+#include "appfat.h"
+#include "dvlnet/packet.h"
+#include "dvlnet/tcp_server.h"
+#include "utils/log.hpp"
+#include "utils/sdl_thread.h"
+#include "utils/str_cat.hpp"
+
+namespace devilution {
+
+// The relay doesn't include the game, so fatal errors are only logged.
+
+void app_fatal(string_view str)
+{
+	LogCritical("{}", str);
+	std::exit(1);
+}
+
+#ifdef _DEBUG
+void assert_fail(int nLineNo, const char *pszFile, const char *pszFail)
+{
+	app_fatal(StrCat("assertion failed (", pszFile, ":", nLineNo, ")\n", pszFail));
+}
+#endif
+
+void ErrDlg(const char *title, string_view error, string_view logFilePath, int logLineNr)
+{
+	app_fatal(StrCat(title, ": ", error, " (", logFilePath, ":", logLineNr, ")"));
+}
+
+namespace {
+
+struct RelayOptions {
+	std::string bindAddress = "0.0.0.0";
+	unsigned short firstPort = 6112;
+	unsigned games = 1;
+	unsigned threads = 1;
+	/** @brief Games are public if this is empty, all games hosted on the relay share the password. */
+	std::string password;
+	/** @brief Seconds between stats being logged, 0 disables it. */
+	unsigned statsInterval = 60;
+};
+
+/**
+ * @brief Runs the games of one thread. Each game is only ever touched from its worker's thread,
+ * so the servers don't need any locking.
+ */
+struct RelayWorker {
+	asio::io_context ioc;
+	std::unique_ptr<net::packet_factory> pktfty;
+	std::vector<std::unique_ptr<net::tcp_server>> servers;
+	std::vector<unsigned short> ports;
+	asio::steady_timer statsTimer { ioc };
+	unsigned statsInterval = 0;
+	SdlThread thread;
+
+	void StartStatsTimer()
+	{
+		statsTimer.expires_after(std::chrono::seconds(statsInterval));
+		statsTimer.async_wait([this](const asio::error_code &ec) {
+			if (ec)
+				return;
+			for (size_t i = 0; i < servers.size(); i++) {
+				const net::tcp_server::stats stats = servers[i]->GetStats();
+				Log("Game on port {}: {} players, {} spectators, {} packets received, {} bytes sent", ports[i], stats.players, stats.spectators, stats.packets_received, stats.bytes_sent);
+			}
+			StartStatsTimer();
+		});
+	}
+
+	static int SDLCALL Run(void *data)
+	{
+		auto &worker = *static_cast<RelayWorker *>(data);
+		if (worker.statsInterval != 0)
+			worker.StartStatsTimer();
+		worker.ioc.run();
+		return 0;
+	}
+};
+
+void PrintHelp()
+{
+	std::puts("Usage: devilutionx-relay [options]");
+	std::puts("  --bind <address>        Address to listen on (default 0.0.0.0)");
+	std::puts("  --port <port>           Port of the first game (default 6112)");
+	std::puts("  --games <count>         Number of games, hosted on consecutive ports (default 1)");
+	std::puts("  --threads <count>       Number of network threads the games are spread over (default 1)");
+	std::puts("  --password <password>   Password of the games (default none, the games are public)");
+	std::puts("  --stats-interval <s>    Seconds between logging stats, 0 to disable (default 60)");
+}
+
+bool ParseNumber(const char *arg, unsigned long min, unsigned long max, unsigned long &out)
+{
+	char *end;
+	out = std::strtoul(arg, &end, 10);
+	return *arg != '\0' && *end == '\0' && out >= min && out <= max;
+}
+
+bool ParseOptions(int argc, char **argv, RelayOptions &options)
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		if (std::strcmp(arg, "-h") == 0 || std::strcmp(arg, "--help") == 0) {
+			PrintHelp();
+			std::exit(0);
+		}
+		if (i + 1 == argc) {
+			std::fprintf(stderr, "Missing value for %s\n", arg);
+			return false;
+		}
+		const char *value = argv[++i];
+		unsigned long number;
+		if (std::strcmp(arg, "--bind") == 0) {
+			options.bindAddress = value;
+		} else if (std::strcmp(arg, "--password") == 0) {
+			options.password = value;
+		} else if (std::strcmp(arg, "--port") == 0 && ParseNumber(value, 1, 0xFFFF, number)) {
+			options.firstPort = static_cast<unsigned short>(number);
+		} else if (std::strcmp(arg, "--games") == 0 && ParseNumber(value, 1, 0xFFFF, number)) {
+			options.games = static_cast<unsigned>(number);
+		} else if (std::strcmp(arg, "--threads") == 0 && ParseNumber(value, 1, 256, number)) {
+			options.threads = static_cast<unsigned>(number);
+		} else if (std::strcmp(arg, "--stats-interval") == 0 && ParseNumber(value, 0, 86400, number)) {
+			options.statsInterval = static_cast<unsigned>(number);
+		} else {
+			std::fprintf(stderr, "Invalid option %s %s\n", arg, value);
+			return false;
+		}
+	}
+	if (options.firstPort + options.games - 1 > 0xFFFF) {
+		std::fputs("Not enough ports for all games\n", stderr);
+		return false;
+	}
+	return true;
+}
+
+int RunRelay(const RelayOptions &options)
+{
+	const unsigned threads = std::min(options.threads, options.games);
+	std::vector<std::unique_ptr<RelayWorker>> workers;
+	for (unsigned i = 0; i < threads; i++) {
+		auto worker = std::make_unique<RelayWorker>();
+		// Deriving the key is expensive, but it keeps the workers from sharing any state.
+		if (options.password.empty())
+			worker->pktfty = std::make_unique<net::packet_factory>();
+		else
+			worker->pktfty = std::make_unique<net::packet_factory>(options.password);
+		worker->statsInterval = options.statsInterval;
+		workers.push_back(std::move(worker));
+	}
+
+	for (unsigned i = 0; i < options.games; i++) {
+		RelayWorker &worker = *workers[i % threads];
+		const auto port = static_cast<unsigned short>(options.firstPort + i);
+		try {
+			worker.servers.push_back(std::make_unique<net::tcp_server>(worker.ioc, options.bindAddress, port, *worker.pktfty));
+		} catch (std::exception &e) {
+			LogError("Failed to host a game on port {}: {}", port, e.what());
+			return 1;
+		}
+		worker.ports.push_back(port);
+	}
+
+	Log("Hosting {} {} games on {} ports {}-{}", options.games, options.password.empty() ? "public" : "private", options.bindAddress,
+	    options.firstPort, options.firstPort + options.games - 1);
+
+	for (std::unique_ptr<RelayWorker> &worker : workers)
+		worker->thread = SdlThread { RelayWorker::Run, worker.get() };
+	for (std::unique_ptr<RelayWorker> &worker : workers)
+		worker->thread.join();
+	return 0;
+}
+
+} // namespace
+
+} // namespace devilution
+
+int main(int argc, char **argv)
+{
+	devilution::RelayOptions options;
+	if (!devilution::ParseOptions(argc, argv, options)) {
+		devilution::PrintHelp();
+		return 1;
+	}
+	return devilution::RunRelay(options);
+}
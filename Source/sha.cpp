@@ -11,73 +11,96 @@ namespace devilution {
 namespace {
 
 /**
- * Diablo-"SHA1" circular left shift, portable version.
+ * Diablo-"SHA1" circular left shift.
  */
-uint32_t SHA1CircularShift(uint32_t word, size_t bits)
+constexpr uint32_t SHA1CircularShift(uint32_t word, size_t bits)
 {
 	// The SHA-like algorithm as originally implemented treated word as a signed value and used arithmetic right shifts
-	//  (sign-extending). This results in the high 32-`bits` bits being set to 1.
-	if ((word & (1 << 31)) != 0)
-		return (0xFFFFFFFF << bits) | (word >> (32 - bits));
-	return (word << bits) | (word >> (32 - bits));
+	//  (sign-extending). This results in the high 32-`bits` bits being set to 1 if the sign bit was set.
+	// Shifting the signed value does exactly that without a branch, all supported compilers use arithmetic shifts
+	//  for signed values.
+	return (word << bits) | static_cast<uint32_t>(static_cast<int32_t>(word) >> (32 - bits));
 }
 
-void SHA1ProcessMessageBlock(SHA1Context *context)
-{
-	std::uint32_t w[80];
+static_assert(SHA1CircularShift(0x80000001, 5) == 0xFFFFFFF0, "Sign bits have to be shifted in");
+static_assert(SHA1CircularShift(0x40000001, 5) == 0x00000028, "Only the sign bit is extended");
 
-	memcpy(w, context->buffer, BlockSize * sizeof(uint32_t));
-	for (int i = 16; i < 80; i++) {
-		w[i] = w[i - 16] ^ w[i - 14] ^ w[i - 8] ^ w[i - 3];
+struct SHA1Choose {
+	static constexpr uint32_t F(uint32_t b, uint32_t c, uint32_t d)
+	{
+		return d ^ (b & (c ^ d));
 	}
+};
 
-	std::uint32_t a = context->state[0];
-	std::uint32_t b = context->state[1];
-	std::uint32_t c = context->state[2];
-	std::uint32_t d = context->state[3];
-	std::uint32_t e = context->state[4];
-
-	for (int i = 0; i < 20; i++) {
-		std::uint32_t temp = SHA1CircularShift(a, 5) + ((b & c) | ((~b) & d)) + e + w[i] + 0x5A827999;
-		e = d;
-		d = c;
-		c = SHA1CircularShift(b, 30);
-		b = a;
-		a = temp;
+struct SHA1Parity {
+	static constexpr uint32_t F(uint32_t b, uint32_t c, uint32_t d)
+	{
+		return b ^ c ^ d;
 	}
+};
 
-	for (int i = 20; i < 40; i++) {
-		std::uint32_t temp = SHA1CircularShift(a, 5) + (b ^ c ^ d) + e + w[i] + 0x6ED9EBA1;
-		e = d;
-		d = c;
-		c = SHA1CircularShift(b, 30);
-		b = a;
-		a = temp;
+struct SHA1Majority {
+	static constexpr uint32_t F(uint32_t b, uint32_t c, uint32_t d)
+	{
+		return (b & c) | (d & (b | c));
 	}
+};
 
-	for (int i = 40; i < 60; i++) {
-		std::uint32_t temp = SHA1CircularShift(a, 5) + ((b & c) | (b & d) | (c & d)) + e + w[i] + 0x8F1BBCDC;
-		e = d;
-		d = c;
-		c = SHA1CircularShift(b, 30);
-		b = a;
-		a = temp;
-	}
+/**
+ * @brief One round, the caller rotates the roles of the variables instead of moving the values around.
+ */
+template <typename Function, uint32_t K>
+void SHA1Round(uint32_t a, uint32_t &b, uint32_t c, uint32_t d, uint32_t &e, uint32_t w)
+{
+	e += SHA1CircularShift(a, 5) + Function::F(b, c, d) + w + K;
+	b = SHA1CircularShift(b, 30);
+}
 
-	for (int i = 60; i < 80; i++) {
-		std::uint32_t temp = SHA1CircularShift(a, 5) + (b ^ c ^ d) + e + w[i] + 0xCA62C1D6;
-		e = d;
-		d = c;
-		c = SHA1CircularShift(b, 30);
-		b = a;
-		a = temp;
+/**
+ * @brief Twenty rounds of the same kind that use the words [first, first + 20) of the message schedule.
+ *
+ * The schedule only needs the last 16 words, so it is kept in a ring buffer that is extended as the rounds go.
+ */
+template <typename Function, uint32_t K>
+void SHA1Rounds(uint32_t &a, uint32_t &b, uint32_t &c, uint32_t &d, uint32_t &e, uint32_t w[BlockSize], int first)
+{
+	for (int i = first; i < first + 20; i += 5) {
+		uint32_t words[5];
+		for (int j = 0; j < 5; j++) {
+			const int k = (i + j) % BlockSize;
+			if (i + j >= BlockSize)
+				w[k] = w[k] ^ w[(k + 2) % BlockSize] ^ w[(k + 8) % BlockSize] ^ w[(k + 13) % BlockSize];
+			words[j] = w[k];
+		}
+		SHA1Round<Function, K>(a, b, c, d, e, words[0]);
+		SHA1Round<Function, K>(e, a, b, c, d, words[1]);
+		SHA1Round<Function, K>(d, e, a, b, c, words[2]);
+		SHA1Round<Function, K>(c, d, e, a, b, words[3]);
+		SHA1Round<Function, K>(b, c, d, e, a, words[4]);
 	}
+}
 
-	context->state[0] += a;
-	context->state[1] += b;
-	context->state[2] += c;
-	context->state[3] += d;
-	context->state[4] += e;
+void SHA1ProcessMessageBlock(SHA1Context &context, const uint32_t data[BlockSize])
+{
+	std::uint32_t w[BlockSize];
+	memcpy(w, data, sizeof(w));
+
+	std::uint32_t a = context.state[0];
+	std::uint32_t b = context.state[1];
+	std::uint32_t c = context.state[2];
+	std::uint32_t d = context.state[3];
+	std::uint32_t e = context.state[4];
+
+	SHA1Rounds<SHA1Choose, 0x5A827999>(a, b, c, d, e, w, 0);
+	SHA1Rounds<SHA1Parity, 0x6ED9EBA1>(a, b, c, d, e, w, 20);
+	SHA1Rounds<SHA1Majority, 0x8F1BBCDC>(a, b, c, d, e, w, 40);
+	SHA1Rounds<SHA1Parity, 0xCA62C1D6>(a, b, c, d, e, w, 60);
+
+	context.state[0] += a;
+	context.state[1] += b;
+	context.state[2] += c;
+	context.state[3] += d;
+	context.state[4] += e;
 }
 
 } // namespace
@@ -89,8 +112,7 @@ void SHA1Result(SHA1Context &context, uint32_t messageDigest[SHA1HashSize])
 
 void SHA1Calculate(SHA1Context &context, const uint32_t data[BlockSize])
 {
-	memcpy(&context.buffer[0], data, BlockSize * sizeof(uint32_t));
-	SHA1ProcessMessageBlock(&context);
+	SHA1ProcessMessageBlock(context, data);
 }
 
 } // namespace devilution
@@ -6,6 +6,8 @@
 #include "stores.h"
 
 #include <algorithm>
+#include <string>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -235,7 +237,6 @@ void AddSLine(size_t y)
 	stext[y]._sx = 0;
 	stext[y]._syoff = 0;
 	stext[y].text.clear();
-	stext[y].text.shrink_to_fit();
 	stext[y].type = STextStruct::Divider;
 }
 
@@ -274,9 +275,24 @@ void AddItemListBackButton(bool selectable = false)
 	}
 }
 
-void PrintStoreItem(const Item &item, int l, UiFlags flags)
+/** @brief The detail lines of an item in a store list, formatted once per item instead of on every scroll step. */
+struct StoreItemDetails {
+	ItemTextKey key;
+	/** @brief The affixes and charges, empty if the item has none. */
+	std::string powers;
+	/** @brief Damage or armor, durability and required attributes. */
+	std::string stats;
+};
+
+/** @brief More than the largest store list, so that scrolling through one never formats an item twice. */
+constexpr size_t MaxStoreItemDetails = 128;
+
+/** @brief Cleared when a store opens, and when it's full. */
+std::vector<StoreItemDetails> StoreItemDetailsCache;
+
+void FormatStoreItemDetails(const Item &item, StoreItemDetails &details)
 {
-	std::string productLine;
+	std::string &productLine = details.powers;
 
 	if (item._iIdentified) {
 		if (item._iMagical != ITEM_QUALITY_UNIQUE) {
@@ -295,21 +311,17 @@ void PrintStoreItem(const Item &item, int l, UiFlags flags)
 			AppendStrView(productLine, _(",  "));
 		productLine.append(fmt::format(fmt::runtime(_("Charges: {:d}/{:d}")), item._iCharges, item._iMaxCharges));
 	}
-	if (!productLine.empty()) {
-		AddSText(40, l, productLine, flags, false);
-		l++;
-		productLine.clear();
-	}
 
+	std::string &statsLine = details.stats;
 	if (item._itype != ItemType::Misc) {
 		if (item._iClass == ICLASS_WEAPON)
-			productLine = fmt::format(fmt::runtime(_("Damage: {:d}-{:d}  ")), item._iMinDam, item._iMaxDam);
+			statsLine = fmt::format(fmt::runtime(_("Damage: {:d}-{:d}  ")), item._iMinDam, item._iMaxDam);
 		else if (item._iClass == ICLASS_ARMOR)
-			productLine = fmt::format(fmt::runtime(_("Armor: {:d}  ")), item._iAC);
+			statsLine = fmt::format(fmt::runtime(_("Armor: {:d}  ")), item._iAC);
 		if (item._iMaxDur != DUR_INDESTRUCTIBLE && item._iMaxDur != 0)
-			productLine += fmt::format(fmt::runtime(_("Dur: {:d}/{:d},  ")), item._iDurability, item._iMaxDur);
+			statsLine += fmt::format(fmt::runtime(_("Dur: {:d}/{:d},  ")), item._iDurability, item._iMaxDur);
 		else
-			AppendStrView(productLine, _("Indestructible,  "));
+			AppendStrView(statsLine, _("Indestructible,  "));
 	}
 
 	int8_t str = item._iMinStr;
@@ -317,17 +329,40 @@ void PrintStoreItem(const Item &item, int l, UiFlags flags)
 	int8_t dex = item._iMinDex;
 
 	if (str == 0 && mag == 0 && dex == 0) {
-		AppendStrView(productLine, _("No required attributes"));
+		AppendStrView(statsLine, _("No required attributes"));
 	} else {
-		AppendStrView(productLine, _("Required:"));
+		AppendStrView(statsLine, _("Required:"));
 		if (str != 0)
-			productLine.append(fmt::format(fmt::runtime(_(" {:d} Str")), str));
+			statsLine.append(fmt::format(fmt::runtime(_(" {:d} Str")), str));
 		if (mag != 0)
-			productLine.append(fmt::format(fmt::runtime(_(" {:d} Mag")), mag));
+			statsLine.append(fmt::format(fmt::runtime(_(" {:d} Mag")), mag));
 		if (dex != 0)
-			productLine.append(fmt::format(fmt::runtime(_(" {:d} Dex")), dex));
+			statsLine.append(fmt::format(fmt::runtime(_(" {:d} Dex")), dex));
+	}
+}
+
+const StoreItemDetails &GetStoreItemDetails(const Item &item)
+{
+	const ItemTextKey key { item };
+	for (const StoreItemDetails &details : StoreItemDetailsCache) {
+		if (details.key == key)
+			return details;
+	}
+	if (StoreItemDetailsCache.size() >= MaxStoreItemDetails)
+		StoreItemDetailsCache.clear();
+	StoreItemDetails &details = StoreItemDetailsCache.emplace_back(StoreItemDetails { key, {}, {} });
+	FormatStoreItemDetails(item, details);
+	return details;
+}
+
+void PrintStoreItem(const Item &item, int l, UiFlags flags)
+{
+	const StoreItemDetails &details = GetStoreItemDetails(item);
+	if (!details.powers.empty()) {
+		AddSText(40, l, details.powers, flags, false);
+		l++;
 	}
-	AddSText(40, l++, productLine, flags, false);
+	AddSText(40, l++, details.stats, flags, false);
 }
 
 bool StoreAutoPlace(Item &item, bool persistItem)
@@ -2311,8 +2346,8 @@ void ClearSText(int s, int e)
 	for (int i = s; i < e; i++) {
 		stext[i]._sx = 0;
 		stext[i]._syoff = 0;
+		// The lines keep their buffers, scrolling refills the same lines over and over.
 		stext[i].text.clear();
-		stext[i].text.shrink_to_fit();
 		stext[i].flags = UiFlags::None;
 		stext[i].type = STextStruct::Label;
 		stext[i]._sval = 0;
@@ -2327,6 +2362,7 @@ void StartStore(talk_id s)
 	RenderGold = false;
 	QuestLogIsOpen = false;
 	CloseGoldDrop();
+	StoreItemDetailsCache.clear();
 	ClearSText(0, STORE_LINES);
 	ReleaseStoreBtn();
 	switch (s) {
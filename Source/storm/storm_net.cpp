@@ -250,4 +250,12 @@ bool DvlNet_IsPublicGame()
 	return GameIsPublic;
 }
 
+bool DvlNet_GetNetworkStats(NetworkStats &stats)
+{
+#ifndef NONET
+	std::lock_guard<SdlMutex> lg(storm_net_mutex);
+#endif
+	return dvlnet_inst != nullptr && dvlnet_inst->get_network_stats(stats);
+}
+
 } // namespace devilution
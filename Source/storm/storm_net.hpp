@@ -35,6 +35,22 @@ struct _SNETCAPS {
 	uint32_t defaultturnsintransit;
 };
 
+struct PeerNetworkStats {
+	bool connected;
+	/** @brief Round trip time of the latest echo in milliseconds. */
+	uint32_t roundTripLatency;
+	/** @brief Smoothed variation of the round trip time in milliseconds. */
+	uint32_t jitter;
+	/** @brief Percentage of the recent echo requests that went unanswered. */
+	uint8_t packetLoss;
+	uint32_t bytesReceivedPerSecond;
+};
+
+struct NetworkStats {
+	PeerNetworkStats peers[MAX_PLRS];
+	uint32_t bytesSentPerSecond;
+};
+
 struct _SNETEVENT {
 	uint32_t eventid;
 	uint32_t playerid;
@@ -149,4 +165,10 @@ void DvlNet_SetPassword(std::string pw);
 void DvlNet_ClearPassword();
 bool DvlNet_IsPublicGame();
 
+/**
+ * @brief Gets the latency and bandwidth of the connections to the other players.
+ * @return false if the provider doesn't keep stats, e.g. in single player games.
+ */
+bool DvlNet_GetNetworkStats(NetworkStats &stats);
+
 } // namespace devilution
@@ -1,8 +1,10 @@
 #include "storm/storm_svid.h"
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <mutex>
 
 #include <SmackerDecoder.h>
 
@@ -18,17 +20,29 @@
 #include "utils/display.h"
 #include "utils/log.hpp"
 #include "utils/sdl_compat.h"
+#include "utils/sdl_cond.h"
+#include "utils/sdl_mutex.h"
+#include "utils/sdl_thread.h"
 #include "utils/sdl_wrap.h"
 #include "utils/stdcompat/optional.hpp"
 
+#ifndef DEVILUTIONX_SVID_QUEUE_SIZE
+#define DEVILUTIONX_SVID_QUEUE_SIZE 3
+#endif
+
 namespace devilution {
 namespace {
 
+constexpr size_t NumColors = 256;
+
+/** @brief How many decoded frames the decoder thread may be ahead of the presented one. */
+constexpr size_t SVidQueueSize = DEVILUTIONX_SVID_QUEUE_SIZE;
+
 #ifndef NOSOUND
 std::optional<Aulib::Stream> SVidAudioStream;
 PushAulibDecoder *SVidAudioDecoder;
 std::uint8_t SVidAudioDepth;
-std::unique_ptr<int16_t[]> SVidAudioBuffer;
+std::uint32_t SVidAudioBufferSize;
 #endif
 
 uint32_t SVidWidth, SVidHeight;
@@ -40,6 +54,40 @@ std::unique_ptr<uint8_t[]> SVidFrameBuffer;
 SDLPaletteUniquePtr SVidPalette;
 SDLSurfaceUniquePtr SVidSurface;
 
+struct SVidDecodedFrame {
+	std::unique_ptr<uint8_t[]> pixels;
+	/** @brief Only filled in when paletteChanged is set. */
+	uint8_t palette[NumColors * 3];
+	bool paletteChanged;
+#ifndef NOSOUND
+	std::unique_ptr<int16_t[]> audio;
+	/** @brief Size of the audio in bytes. */
+	std::uint32_t audioLength;
+#endif
+};
+
+/**
+ * @brief Frames decoded by the decoder thread, waiting to be presented on the main thread.
+ *
+ * The slots from front to front + count - 1 belong to the main thread, the others to the decoder thread.
+ * Only the indices and flags need the mutex.
+ */
+struct SVidFrameQueue {
+	std::array<SVidDecodedFrame, SVidQueueSize> frames;
+	size_t front = 0;
+	size_t count = 0;
+	/** @brief Set by the decoder thread after the last frame of a video that doesn't loop. */
+	bool done = false;
+	/** @brief Set by the main thread to make the decoder thread exit early. */
+	bool stop = false;
+	SdlMutex mutex;
+	SdlCond frameDecoded;
+	SdlCond framePresented;
+	SdlThread thread;
+};
+
+std::unique_ptr<SVidFrameQueue> SVidQueue;
+
 bool IsLandscapeFit(unsigned long srcW, unsigned long srcH, unsigned long dstW, unsigned long dstH)
 {
 	return srcW * dstH > dstW * srcH;
@@ -116,30 +164,99 @@ bool HasAudio()
 }
 #endif
 
-bool SVidLoadNextFrame()
+/**
+ * @brief Decodes the video into the queue until it ends or SVidPlayEnd stops it.
+ *
+ * Owns SVidHandle while it runs, the main thread only touches the decoded frames.
+ */
+int SDLCALL SVidDecodeFrames(void *data)
 {
-	if (Smacker_GetCurrentFrameNum(SVidHandle) >= Smacker_GetNumFrames(SVidHandle)) {
-		if (!SVidLoop) {
-			return false;
+	SVidFrameQueue &queue = *static_cast<SVidFrameQueue *>(data);
+	bool firstFrame = true;
+	while (true) {
+		size_t slot;
+		{
+			std::lock_guard<SdlMutex> lock(queue.mutex);
+			while (queue.count == SVidQueueSize && !queue.stop)
+				queue.framePresented.wait(queue.mutex);
+			if (queue.stop)
+				break;
+			slot = (queue.front + queue.count) % SVidQueueSize;
 		}
 
-		Smacker_Rewind(SVidHandle);
+		if (!firstFrame && Smacker_GetCurrentFrameNum(SVidHandle) >= Smacker_GetNumFrames(SVidHandle)) {
+			if (!SVidLoop) {
+				std::lock_guard<SdlMutex> lock(queue.mutex);
+				queue.done = true;
+				queue.frameDecoded.signal();
+				break;
+			}
+
+			Smacker_Rewind(SVidHandle);
+		}
+
+		SVidDecodedFrame &frame = queue.frames[slot];
+		Smacker_GetNextFrame(SVidHandle);
+		Smacker_GetFrame(SVidHandle, frame.pixels.get());
+		frame.paletteChanged = firstFrame || Smacker_DidPaletteChange(SVidHandle);
+		if (frame.paletteChanged)
+			Smacker_GetPalette(SVidHandle, frame.palette);
+#ifndef NOSOUND
+		frame.audioLength = frame.audio != nullptr ? Smacker_GetAudioData(SVidHandle, 0, frame.audio.get()) : 0;
+#endif
+		firstFrame = false;
+
+		std::lock_guard<SdlMutex> lock(queue.mutex);
+		queue.count++;
+		queue.frameDecoded.signal();
 	}
+	return 0;
+}
 
-	SVidFrameEnd += SVidFrameLength;
+/**
+ * @brief Waits for the decoder thread to deliver the next frame.
+ * @return The oldest frame that hasn't been presented yet, or nullptr once the video has ended
+ */
+SVidDecodedFrame *WaitForDecodedFrame()
+{
+	std::lock_guard<SdlMutex> lock(SVidQueue->mutex);
+	while (SVidQueue->count == 0 && !SVidQueue->done)
+		SVidQueue->frameDecoded.wait(SVidQueue->mutex);
+	if (SVidQueue->count == 0)
+		return nullptr;
+	return &SVidQueue->frames[SVidQueue->front];
+}
 
-	Smacker_GetNextFrame(SVidHandle);
-	Smacker_GetFrame(SVidHandle, SVidFrameBuffer.get());
+/**
+ * @brief Hands the oldest frame back to the decoder thread and moves on to the next one.
+ */
+bool SVidNextFrame()
+{
+	SVidFrameEnd += SVidFrameLength;
 
+	std::lock_guard<SdlMutex> lock(SVidQueue->mutex);
+	SVidQueue->front = (SVidQueue->front + 1) % SVidQueueSize;
+	SVidQueue->count--;
+	SVidQueue->framePresented.signal();
 	return true;
 }
 
-void UpdatePalette()
+void StopDecoding()
 {
-	constexpr size_t NumColors = 256;
-	uint8_t paletteData[NumColors * 3];
-	Smacker_GetPalette(SVidHandle, paletteData);
+	if (SVidQueue == nullptr)
+		return;
+
+	{
+		std::lock_guard<SdlMutex> lock(SVidQueue->mutex);
+		SVidQueue->stop = true;
+		SVidQueue->framePresented.signal();
+	}
+	SVidQueue->thread.join();
+	SVidQueue = nullptr;
+}
 
+void UpdatePalette(const uint8_t *paletteData)
+{
 	SDL_Color *colors = SVidPalette->colors;
 	for (unsigned i = 0; i < NumColors; ++i) {
 		colors[i].r = paletteData[i * 3];
@@ -219,6 +336,7 @@ bool BlitFrame()
 		}
 	}
 
+	InvalidateOutputSurface();
 	RenderPresent();
 	return true;
 }
@@ -241,7 +359,8 @@ bool SVidPlayBegin(const char *filename, int flags)
 	// 0x800000 // Edge detection
 	// 0x200800 // Clear FB
 
-	SDL_RWops *videoStream = OpenAsset(filename);
+	// The stream is read on the decoder thread.
+	SDL_RWops *videoStream = OpenAsset(filename, /*threadsafe=*/true);
 	SVidHandle = Smacker_Open(videoStream);
 	if (!SVidHandle.isValid) {
 		return false;
@@ -257,7 +376,7 @@ bool SVidPlayBegin(const char *filename, int flags)
 		sound_stop(); // Stop in-progress music and sound effects
 
 		SVidAudioDepth = audioInfo.bitsPerSample;
-		SVidAudioBuffer = std::unique_ptr<int16_t[]> { new int16_t[audioInfo.idealBufferSize] };
+		SVidAudioBufferSize = audioInfo.idealBufferSize;
 		auto decoder = std::make_unique<PushAulibDecoder>(audioInfo.nChannels, audioInfo.sampleRate);
 		SVidAudioDecoder = decoder.get();
 		SVidAudioStream.emplace(/*rwops=*/nullptr, std::move(decoder), CreateAulibResampler(), /*closeRw=*/false);
@@ -298,15 +417,11 @@ bool SVidPlayBegin(const char *filename, int flags)
 	SDL_FillRect(GetOutputSurface(), nullptr, 0x000000);
 
 	// The buffer for the frame. It is not the same as the SDL surface because the SDL surface also has pitch padding.
-	SVidFrameBuffer = std::unique_ptr<uint8_t[]> { new uint8_t[static_cast<size_t>(SVidWidth * SVidHeight)] };
-
-	// Decode first frame.
-	Smacker_GetNextFrame(SVidHandle);
-	Smacker_GetFrame(SVidHandle, SVidFrameBuffer.get());
+	const auto frameSize = static_cast<size_t>(SVidWidth * SVidHeight);
+	SVidFrameBuffer = std::unique_ptr<uint8_t[]> { new uint8_t[frameSize] };
 
 	// Create the surface from the frame buffer data.
-	// It will be rendered in `SVidPlayContinue`, called immediately after this function.
-	// Subsequents frames will also be copied to this surface.
+	// The decoded frames are copied to the buffer in `SVidPlayContinue`, called immediately after this function.
 	SVidSurface = SDLWrap::CreateRGBSurfaceWithFormatFrom(
 	    reinterpret_cast<void *>(SVidFrameBuffer.get()),
 	    static_cast<int>(SVidWidth),
@@ -316,7 +431,18 @@ bool SVidPlayBegin(const char *filename, int flags)
 	    SDL_PIXELFORMAT_INDEX8);
 
 	SVidPalette = SDLWrap::AllocPalette();
-	UpdatePalette();
+
+	SVidQueue = std::make_unique<SVidFrameQueue>();
+	for (SVidDecodedFrame &frame : SVidQueue->frames) {
+		frame.pixels = std::unique_ptr<uint8_t[]> { new uint8_t[frameSize] };
+#ifndef NOSOUND
+		if (SVidAudioDecoder != nullptr)
+			frame.audio = std::unique_ptr<int16_t[]> { new int16_t[SVidAudioBufferSize] };
+#endif
+	}
+	// Wait for the first frame, which is always decoded, so that its decoding time isn't counted against it.
+	SVidQueue->thread = SdlThread { SVidDecodeFrames, SVidQueue.get() };
+	WaitForDecodedFrame();
 
 	SVidFrameEnd = SDL_GetTicks() * 1000.0 + SVidFrameLength;
 
@@ -325,18 +451,23 @@ bool SVidPlayBegin(const char *filename, int flags)
 
 bool SVidPlayContinue()
 {
-	if (Smacker_DidPaletteChange(SVidHandle)) {
-		UpdatePalette();
+	SVidDecodedFrame *frame = WaitForDecodedFrame();
+	if (frame == nullptr)
+		return false;
+
+	// Skipped frames can still change the palette of the following ones.
+	if (frame->paletteChanged) {
+		UpdatePalette(frame->palette);
 	}
 
 	if (SDL_GetTicks() * 1000.0 >= SVidFrameEnd) {
-		return SVidLoadNextFrame(); // Skip video and audio if the system is to slow
+		return SVidNextFrame(); // Skip video and audio if the system is to slow
 	}
 
 #ifndef NOSOUND
 	if (HasAudio()) {
-		std::int16_t *buf = SVidAudioBuffer.get();
-		const auto len = Smacker_GetAudioData(SVidHandle, 0, buf);
+		const std::int16_t *buf = frame->audio.get();
+		const auto len = frame->audioLength;
 		if (SVidAudioDepth == 16) {
 			SVidAudioDecoder->PushSamples(buf, len / 2);
 		} else {
@@ -346,9 +477,10 @@ bool SVidPlayContinue()
 #endif
 
 	if (SDL_GetTicks() * 1000.0 >= SVidFrameEnd) {
-		return SVidLoadNextFrame(); // Skip video if the system is to slow
+		return SVidNextFrame(); // Skip video if the system is to slow
 	}
 
+	std::memcpy(SVidFrameBuffer.get(), frame->pixels.get(), static_cast<size_t>(SVidWidth * SVidHeight));
 	if (!BlitFrame())
 		return false;
 
@@ -357,16 +489,17 @@ bool SVidPlayContinue()
 		SDL_Delay(static_cast<Uint32>((SVidFrameEnd - now) / 1000.0)); // wait with next frame if the system is too fast
 	}
 
-	return SVidLoadNextFrame();
+	return SVidNextFrame();
 }
 
 void SVidPlayEnd()
 {
+	StopDecoding();
+
 #ifndef NOSOUND
 	if (HasAudio()) {
 		SVidAudioStream = std::nullopt;
 		SVidAudioDecoder = nullptr;
-		SVidAudioBuffer = nullptr;
 	}
 #endif
 
@@ -390,6 +523,7 @@ void SVidPlayEnd()
 		IsSVidVideoMode = false;
 	}
 #endif
+	InvalidateOutputSurface();
 }
 
 void SVidMute()
@@ -16,9 +16,29 @@ namespace {
 uint16_t sgnMonsterPriority[MaxMonsters];
 size_t sgnMonsters;
 uint16_t sgwLRU[MaxMonsters];
+/** @brief What was last sent for each monster, _mndx is 0xFF for monsters that haven't been sent since sync_init. */
+TSyncMonster sgLastSynced[MaxMonsters];
 int sgnSyncItem;
 int sgnSyncPInv;
 
+/**
+ * Added to the priority of monsters whose position, enemy and hit points haven't changed since they were last sent,
+ * so that the slots go to monsters other players are more likely to be out of date on. It is lower than the penalty
+ * for inactive monsters, and the round robin slots still refresh unchanged monsters from time to time.
+ */
+constexpr uint32_t UnchangedPriorityPenalty = 0x800;
+
+bool HasChangedSinceLastSync(size_t ndx)
+{
+	const TSyncMonster &last = sgLastSynced[ndx];
+	Monster &monster = Monsters[ndx];
+	return last._mndx != ndx
+	    || last._mx != monster.position.tile.x
+	    || last._my != monster.position.tile.y
+	    || last._menemy != static_cast<uint8_t>(encode_enemy(monster))
+	    || last._mhitpoints != monster.hitPoints;
+}
+
 void SyncOneMonster()
 {
 	for (size_t i = 0; i < ActiveMonsterCount; i++) {
@@ -43,6 +63,7 @@ void SyncMonsterPos(TSyncMonster &monsterSync, int ndx)
 	monsterSync._mdelta = sgnMonsterPriority[ndx] > 255 ? 255 : sgnMonsterPriority[ndx];
 	monsterSync.mWhoHit = monster.whoHit;
 	monsterSync._mhitpoints = monster.hitPoints;
+	sgLastSynced[ndx] = monsterSync;
 
 	sgnMonsterPriority[ndx] = 0xFFFF;
 	sgwLRU[ndx] = monster.activeForTicks == 0 ? 0xFFFF : 0xFFFE;
@@ -55,8 +76,13 @@ bool SyncMonsterActive(TSyncMonster &monsterSync)
 
 	for (size_t i = 0; i < ActiveMonsterCount; i++) {
 		int m = ActiveMonsters[i];
-		if (sgnMonsterPriority[m] < lru && sgwLRU[m] < 0xFFFE) {
-			lru = sgnMonsterPriority[m];
+		if (sgwLRU[m] >= 0xFFFE)
+			continue;
+		uint32_t priority = sgnMonsterPriority[m];
+		if (!HasChangedSinceLastSync(m))
+			priority += UnchangedPriorityPenalty;
+		if (priority < lru) {
+			lru = priority;
 			ndx = ActiveMonsters[i];
 		}
 	}
@@ -326,6 +352,7 @@ void sync_init()
 {
 	sgnMonsters = 16 * MyPlayerId;
 	memset(sgwLRU, 255, sizeof(sgwLRU));
+	memset(sgLastSynced, 0xFF, sizeof(sgLastSynced));
 }
 
 } // namespace devilution
@@ -1,5 +1,8 @@
 #include "towners.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "cursor.h"
 #include "engine/cel_header.hpp"
 #include "engine/load_cel.hpp"
@@ -10,11 +13,22 @@
 #include "stores.h"
 #include "utils/cel_to_cl2.hpp"
 #include "utils/language.h"
+#include "utils/memory_budget.hpp"
 
 namespace devilution {
 namespace {
 
-std::unique_ptr<byte[]> CowCels;
+/** @brief A towner sprite, kept after leaving town so that the next visit doesn't have to convert it again. */
+struct TownerGfx {
+	string_view path;
+	std::unique_ptr<byte[]> data;
+	size_t size;
+};
+
+/** @brief Sorted from the least to the most recently used. */
+std::vector<TownerGfx> TownerGfxs;
+
+byte *CowCels;
 int CowMsg;
 int CowClicks;
 
@@ -52,10 +66,35 @@ void InitTownerInfo(int i, const TownerData &townerData)
 	townerData.init(towner, townerData);
 }
 
+void UpdateTownerGfxUsage()
+{
+	size_t bytes = 0;
+	for (const TownerGfx &gfx : TownerGfxs)
+		bytes += gfx.size;
+	SetMemoryUsage(MemoryTag::TownerGraphics, bytes);
+}
+
+/** @brief Returns the sprite at the given path, loading it unless it was kept from an earlier visit. */
+byte *GetTownerGfx(const char *path, uint16_t width)
+{
+	auto gfx = std::find_if(TownerGfxs.begin(), TownerGfxs.end(), [path](const TownerGfx &gfx) {
+		return gfx.path == path;
+	});
+	if (gfx != TownerGfxs.end()) {
+		std::rotate(gfx, gfx + 1, TownerGfxs.end());
+		return TownerGfxs.back().data.get();
+	}
+
+	size_t size;
+	std::unique_ptr<byte[]> data = LoadCelAsCl2(path, width, &size).data();
+	TownerGfxs.push_back({ path, std::move(data), size });
+	UpdateTownerGfxUsage();
+	return TownerGfxs.back().data.get();
+}
+
 void LoadTownerAnimations(Towner &towner, const char *path, int frames, int delay)
 {
-	towner.data = LoadCelAsCl2(path, towner._tAnimWidth).data();
-	NewTownerAnim(towner, towner.data.get(), frames, delay);
+	NewTownerAnim(towner, GetTownerGfx(path, towner._tAnimWidth), frames, delay);
 }
 
 /**
@@ -212,7 +251,7 @@ void InitCows(Towner &towner, const TownerData &townerData)
 	towner._tAnimWidth = 128;
 	towner.animOrder = nullptr;
 	towner.animOrderSize = 0;
-	CelGetDirectionFrames(CowCels.get(), towner._tNAnim);
+	CelGetDirectionFrames(CowCels, towner._tNAnim);
 	NewTownerAnim(towner, towner._tNAnim[static_cast<size_t>(townerData.dir)], 12, 3);
 	towner._tAnimFrame = GenerateRnd(11);
 	towner.name = _("Cow");
@@ -779,6 +818,7 @@ const TownerData TownersData[] = {
 } // namespace
 
 Towner Towners[NUM_TOWNERS];
+int NumTowners;
 
 /** Contains the data related to quest gossip for each towner ID. */
 _speech_id QuestDialogTable[NUM_TOWNER_TYPES][MAXQUESTS] = {
@@ -820,7 +860,7 @@ void InitTowners()
 {
 	assert(CowCels == nullptr);
 
-	CowCels = LoadCelAsCl2("Towners\\Animals\\Cow.CEL", 128).data();
+	CowCels = GetTownerGfx("Towners\\Animals\\Cow.CEL", 128);
 
 	int i = 0;
 	for (const auto &townerData : TownersData) {
@@ -830,21 +870,41 @@ void InitTowners()
 		InitTownerInfo(i, townerData);
 		i++;
 	}
+	NumTowners = i;
 }
 
 void FreeTownerGFX()
 {
 	for (auto &towner : Towners) {
-		towner.data = nullptr;
+		towner._tAnimData = nullptr;
 	}
 
 	CowCels = nullptr;
+
+	size_t budget = GetMemoryBudget(MemoryTag::TownerGraphics);
+	size_t kept = 0;
+	for (auto it = TownerGfxs.rbegin(); it != TownerGfxs.rend(); ++it) {
+		if (it->size > budget)
+			break;
+		budget -= it->size;
+		kept++;
+	}
+	TownerGfxs.erase(TownerGfxs.begin(), TownerGfxs.end() - kept);
+	UpdateTownerGfxUsage();
+}
+
+void FreeRetainedTownerGFX()
+{
+	TownerGfxs.clear();
+	TownerGfxs.shrink_to_fit();
+	UpdateTownerGfxUsage();
 }
 
 void ProcessTowners()
 {
-	// BUGFIX: should be `i < numtowners`, was `i < NUM_TOWNERS`
-	for (auto &towner : Towners) {
+	// Only the towners in town are animated, the rest of the array isn't drawn.
+	for (int i = 0; i < NumTowners; i++) {
+		Towner &towner = Towners[i];
 		if (towner._ttype == TOWN_DEADGUY) {
 			TownDead(towner);
 		}
@@ -37,7 +37,7 @@ enum _talker_id : uint8_t {
 
 struct Towner {
 	byte *_tNAnim[8];
-	std::unique_ptr<byte[]> data;
+	/** Unowned, the sprites are kept in towners.cpp */
 	byte *_tAnimData;
 	/** Used to get a voice line and text related to active quests when the player speaks to a town npc */
 	int16_t seed;
@@ -67,9 +67,16 @@ struct Towner {
 };
 
 extern Towner Towners[NUM_TOWNERS];
+/** @brief Number of towners InitTowners placed in town, the entries past it are left over from earlier visits. */
+extern int NumTowners;
 
 void InitTowners();
+
+/** @brief Releases the towner sprites, keeping the most recently used ones that fit in the budget for the next visit. */
 void FreeTownerGFX();
+
+/** @brief Frees the towner sprites kept by FreeTownerGFX. */
+void FreeRetainedTownerGFX();
 void ProcessTowners();
 void TalkToTowner(Player &player, int t);
 
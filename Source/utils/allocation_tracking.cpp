@@ -0,0 +1,102 @@
+#include "utils/allocation_tracking.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace devilution {
+
+#ifdef DEVILUTIONX_ALLOCATION_TRACKING
+
+namespace {
+
+// Only the calling thread's allocations are counted, so that the audio and worker threads don't show up in the frame
+// stages of the main thread.
+thread_local uint64_t ThreadAllocationCount;
+
+void *CountedAlloc(std::size_t size)
+{
+	ThreadAllocationCount++;
+	return std::malloc(size != 0 ? size : 1);
+}
+
+} // namespace
+
+uint64_t GetThreadAllocationCount()
+{
+	return ThreadAllocationCount;
+}
+
+#else
+
+uint64_t GetThreadAllocationCount()
+{
+	return 0;
+}
+
+#endif
+
+} // namespace devilution
+
+#ifdef DEVILUTIONX_ALLOCATION_TRACKING
+
+// Aligned allocations keep using the default operators and aren't counted.
+
+void *operator new(std::size_t size)
+{
+	void *ptr = devilution::CountedAlloc(size);
+	if (ptr == nullptr) {
+#ifdef __cpp_exceptions
+		throw std::bad_alloc();
+#else
+		std::abort();
+#endif
+	}
+	return ptr;
+}
+
+void *operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	return devilution::CountedAlloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+	return devilution::CountedAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+	std::free(ptr);
+}
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * @file allocation_tracking.hpp
+ *
+ * Counts heap allocations when built with DEVILUTIONX_ALLOCATION_TRACKING.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace devilution {
+
+#ifdef DEVILUTIONX_ALLOCATION_TRACKING
+constexpr bool AllocationTrackingEnabled = true;
+#else
+constexpr bool AllocationTrackingEnabled = false;
+#endif
+
+/**
+ * @brief Number of times the calling thread called operator new, always 0 unless allocation tracking is enabled.
+ */
+uint64_t GetThreadAllocationCount();
+
+} // namespace devilution
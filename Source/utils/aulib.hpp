@@ -3,6 +3,8 @@
 
 #include <memory>
 
+#include <Aulib/DecoderDrmp3.h>
+#include <Aulib/DecoderDrwav.h>
 #include <Aulib/Stream.h>
 
 #ifdef DEVILUTIONX_RESAMPLER_SPEEX
@@ -17,6 +19,13 @@
 
 namespace devilution {
 
+inline std::unique_ptr<Aulib::Decoder> CreateAulibDecoder(bool isMp3)
+{
+	if (isMp3)
+		return std::make_unique<Aulib::DecoderDrmp3>();
+	return std::make_unique<Aulib::DecoderDrwav>();
+}
+
 inline std::unique_ptr<Aulib::Resampler> CreateAulibResampler()
 {
 	switch (*sgOptions.Audio.resampler) {
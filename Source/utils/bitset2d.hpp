@@ -1,14 +1,24 @@
 #pragma once
 
-#include <bitset>
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
+
+#include "engine/point.hpp"
+#include "engine/rectangle.hpp"
+#include "utils/stdcompat/bit.hpp"
+#include "utils/stdcompat/optional.hpp"
 
 namespace devilution {
 
 /**
  * @brief A 2D variant of std::bitset.
  *
- * For function documentation, see `std::bitset`
+ * For the documentation of the single bit functions, see `std::bitset`.
+ *
+ * Every row starts at a new 64-bit word, so that the bulk operations work on whole words. The loops over the words
+ * are simple enough for the compiler to vectorize them.
  *
  * @tparam Width
  * @tparam Height
@@ -16,38 +26,223 @@ namespace devilution {
 template <size_t Width, size_t Height>
 class Bitset2d {
 public:
+	using Word = uint64_t;
+	static constexpr size_t WordBits = 64;
+	static constexpr size_t WordsPerRow = (Width + WordBits - 1) / WordBits;
+
 	bool test(size_t x, size_t y) const
 	{
-		return data_.test(index(x, y));
+		return (words_[wordIndex(x, y)] & bit(x)) != 0;
 	}
 
 	void set(size_t x, size_t y, bool value = true)
 	{
-		data_.set(index(x, y), value);
+		if (value)
+			words_[wordIndex(x, y)] |= bit(x);
+		else
+			reset(x, y);
 	}
 
 	void reset(size_t x, size_t y)
 	{
-		data_.reset(index(x, y));
+		words_[wordIndex(x, y)] &= ~bit(x);
 	}
 
 	void reset()
 	{
-		data_.reset();
+		words_.fill(0);
 	}
 
 	[[nodiscard]] size_t count() const
 	{
-		return data_.count();
+		size_t result = 0;
+		for (Word word : words_)
+			result += popcount(word);
+		return result;
+	}
+
+	[[nodiscard]] bool any() const
+	{
+		Word result = 0;
+		for (Word word : words_)
+			result |= word;
+		return result != 0;
+	}
+
+	/**
+	 * @brief Returns bits [64 * index, 64 * index + 64) of the row, bit i being x = 64 * index + i.
+	 */
+	[[nodiscard]] Word rowWord(size_t y, size_t index = 0) const
+	{
+		return words_[y * WordsPerRow + index];
+	}
+
+	Bitset2d &operator&=(const Bitset2d &other)
+	{
+		for (size_t i = 0; i < words_.size(); i++)
+			words_[i] &= other.words_[i];
+		return *this;
+	}
+
+	Bitset2d &operator|=(const Bitset2d &other)
+	{
+		for (size_t i = 0; i < words_.size(); i++)
+			words_[i] |= other.words_[i];
+		return *this;
+	}
+
+	/** @brief Resets the bits that are set in the other bitset. */
+	Bitset2d &andNot(const Bitset2d &other)
+	{
+		for (size_t i = 0; i < words_.size(); i++)
+			words_[i] &= ~other.words_[i];
+		return *this;
+	}
+
+	friend Bitset2d operator&(Bitset2d lhs, const Bitset2d &rhs)
+	{
+		return lhs &= rhs;
+	}
+
+	friend Bitset2d operator|(Bitset2d lhs, const Bitset2d &rhs)
+	{
+		return lhs |= rhs;
+	}
+
+	bool operator==(const Bitset2d &other) const
+	{
+		return words_ == other.words_;
+	}
+
+	bool operator!=(const Bitset2d &other) const
+	{
+		return words_ != other.words_;
+	}
+
+	/**
+	 * @brief Returns the bitset moved by the given displacement, bits moved past an edge are lost.
+	 *
+	 * E.g. `b | b.shifted({ 1, 0 }) | b.shifted({ -1, 0 })` grows every set bit by one tile to each side.
+	 */
+	[[nodiscard]] Bitset2d shifted(Displacement offset) const
+	{
+		Bitset2d result;
+		for (size_t y = 0; y < Height; y++) {
+			const auto sourceY = static_cast<int>(y) - offset.deltaY;
+			if (sourceY < 0 || sourceY >= static_cast<int>(Height))
+				continue;
+			result.shiftRow(y, &words_[sourceY * WordsPerRow], offset.deltaX);
+		}
+		return result;
+	}
+
+	/** @brief Returns whether any bit within the rectangle is set, the parts outside of the bitset are ignored. */
+	[[nodiscard]] bool anyInRect(Rectangle rect) const
+	{
+		bool result = false;
+		forEachRectWord(rect, [&](size_t, size_t, Word word) {
+			result = word != 0;
+			return result;
+		});
+		return result;
+	}
+
+	/** @brief Counts the set bits within the rectangle, the parts outside of the bitset are ignored. */
+	[[nodiscard]] size_t countInRect(Rectangle rect) const
+	{
+		size_t result = 0;
+		forEachRectWord(rect, [&](size_t, size_t, Word word) {
+			result += popcount(word);
+			return false;
+		});
+		return result;
+	}
+
+	/** @brief Returns the first set bit within the rectangle, going row by row from the top left. */
+	[[nodiscard]] std::optional<Point> findFirstInRect(Rectangle rect) const
+	{
+		std::optional<Point> result;
+		forEachRectWord(rect, [&](size_t y, size_t index, Word word) {
+			if (word == 0)
+				return false;
+			result = Point { static_cast<int>(index * WordBits) + countr_zero(word), static_cast<int>(y) };
+			return true;
+		});
+		return result;
 	}
 
 private:
-	static size_t index(size_t x, size_t y)
+	static size_t wordIndex(size_t x, size_t y)
+	{
+		return y * WordsPerRow + x / WordBits;
+	}
+
+	static Word bit(size_t x)
+	{
+		return Word { 1 } << (x % WordBits);
+	}
+
+	/** @brief Mask of bits [begin, end) of the word with the given index, relative to the start of the row. */
+	static Word rangeMask(size_t index, size_t begin, size_t end)
+	{
+		const size_t wordBegin = index * WordBits;
+		const size_t from = std::max(begin, wordBegin) - wordBegin;
+		const size_t to = std::min(end, wordBegin + WordBits) - wordBegin;
+		if (from >= to)
+			return 0;
+		const Word upTo = to == WordBits ? ~Word { 0 } : (Word { 1 } << to) - 1;
+		return upTo & ~((Word { 1 } << from) - 1);
+	}
+
+	/** @brief Sets row y to the source row moved by dx, the bits past the width stay cleared. */
+	void shiftRow(size_t y, const Word *source, int dx)
+	{
+		Word *row = &words_[y * WordsPerRow];
+		const auto distance = static_cast<size_t>(dx < 0 ? -dx : dx);
+		if (distance >= Width)
+			return;
+		const size_t wordShift = distance / WordBits;
+		const size_t bitShift = distance % WordBits;
+		for (size_t i = 0; i < WordsPerRow; i++) {
+			Word word = 0;
+			if (dx >= 0) {
+				if (i >= wordShift) {
+					word = source[i - wordShift] << bitShift;
+					if (bitShift != 0 && i > wordShift)
+						word |= source[i - wordShift - 1] >> (WordBits - bitShift);
+				}
+			} else if (i + wordShift < WordsPerRow) {
+				word = source[i + wordShift] >> bitShift;
+				if (bitShift != 0 && i + wordShift + 1 < WordsPerRow)
+					word |= source[i + wordShift + 1] << (WordBits - bitShift);
+			}
+			row[i] = word;
+		}
+		row[WordsPerRow - 1] &= rangeMask(WordsPerRow - 1, 0, Width);
+	}
+
+	/**
+	 * @brief Calls `visit(y, index, word)` with the bits of every word that lie within the rectangle, row by row.
+	 * Stops once visit returns true.
+	 */
+	template <typename Visitor>
+	void forEachRectWord(Rectangle rect, Visitor &&visit) const
 	{
-		return y * Width + x;
+		const auto left = static_cast<size_t>(std::max(rect.position.x, 0));
+		const auto top = static_cast<size_t>(std::max(rect.position.y, 0));
+		const auto right = static_cast<size_t>(std::clamp(rect.position.x + rect.size.width, 0, static_cast<int>(Width)));
+		const auto bottom = static_cast<size_t>(std::clamp(rect.position.y + rect.size.height, 0, static_cast<int>(Height)));
+		if (left >= right)
+			return;
+		for (size_t y = top; y < bottom; y++) {
+			for (size_t index = left / WordBits; index * WordBits < right; index++) {
+				if (visit(y, index, words_[y * WordsPerRow + index] & rangeMask(index, left, right)))
+					return;
+			}
+		}
 	}
 
-	std::bitset<Width * Height> data_;
+	std::array<Word, WordsPerRow * Height> words_ {};
 };
 
 } // namespace devilution
@@ -55,16 +55,14 @@ void AppendCl2PixelsRun(const uint8_t *src, unsigned width, std::vector<uint8_t>
 {
 	while (width >= 0x41) {
 		out.push_back(0xBF);
-		for (size_t i = 0; i < 0x41; ++i)
-			out.push_back(src[i]);
+		out.insert(out.end(), src, src + 0x41);
 		width -= 0x41;
 		src += 0x41;
 	}
 	if (width == 0)
 		return;
 	out.push_back(256 - width);
-	for (size_t i = 0; i < width; ++i)
-		out.push_back(src[i]);
+	out.insert(out.end(), src, src + width);
 }
 
 void AppendCl2PixelsOrFillRun(const uint8_t *src, unsigned length, std::vector<uint8_t> &out)
@@ -96,9 +94,74 @@ void AppendCl2PixelsOrFillRun(const uint8_t *src, unsigned length, std::vector<u
 	AppendCl2FillRun(prevColor, prevColorRunLength, out);
 }
 
+/** @brief A CEL frame to convert, located ahead of the conversion so that the frames can be converted in any order. */
+struct CelFrame {
+	const uint8_t *src;
+	const uint8_t *srcEnd;
+	unsigned width;
+};
+
+/**
+ * @brief Appends the CL2 frame for the given CEL frame, including its header of offsets to 32-pixel height blocks.
+ */
+void AppendCl2Frame(const CelFrame &frame, std::vector<uint8_t> &out)
+{
+	const uint8_t *src = frame.src;
+
+	// Skip CEL frame header if there is one.
+	constexpr size_t CelFrameHeaderSize = 10;
+	const bool celFrameHasHeader = LoadLE16(src) == CelFrameHeaderSize;
+	if (celFrameHasHeader)
+		src += CelFrameHeaderSize;
+
+	// Frame header: 5 16-bit offsets to 32-pixel height blocks.
+	const size_t frameHeaderPos = out.size();
+	constexpr size_t FrameHeaderSize = 10;
+	out.resize(out.size() + FrameHeaderSize);
+
+	// Frame header offset (first of five):
+	WriteLE16(&out[frameHeaderPos], FrameHeaderSize);
+
+	unsigned transparentRunWidth = 0;
+	size_t line = 0;
+	while (src != frame.srcEnd) {
+		// Process line:
+		for (unsigned remainingCelWidth = frame.width; remainingCelWidth != 0;) {
+			uint8_t val = *src++;
+			if (IsCelTransparent(val)) {
+				val = GetCelTransparentWidth(val);
+				transparentRunWidth += val;
+			} else {
+				AppendCl2TransparentRun(transparentRunWidth, out);
+				transparentRunWidth = 0;
+				AppendCl2PixelsOrFillRun(src, val, out);
+				src += val;
+			}
+			remainingCelWidth -= val;
+		}
+
+		// Frame header offset:
+		switch (++line) {
+		case 32:
+		case 64:
+		case 96:
+		case 128:
+			// Finish any active transparent run to not allow it to go over an offset line boundary.
+			AppendCl2TransparentRun(transparentRunWidth, out);
+			transparentRunWidth = 0;
+			WriteLE16(&out[frameHeaderPos + line / 16], static_cast<uint16_t>(out.size() - frameHeaderPos));
+			break;
+		}
+	}
+	AppendCl2TransparentRun(transparentRunWidth, out);
+}
+
+/** @brief Files with less CEL data than this are converted on the calling thread, handing out the frames costs more than it saves. */
+constexpr size_t MinParallelCelSize = 64 * 1024;
+
 } // namespace
 
-OwnedCelSprite CelToCl2(const uint8_t *data, size_t size, PointerOrValue<uint16_t> widthOrWidths)
+OwnedCelSprite CelToCl2(const uint8_t *data, size_t size, PointerOrValue<uint16_t> widthOrWidths, size_t *outSize, ThreadPool *threads)
 {
 	// A CEL file either begins with:
 	// 1. A CEL header.
@@ -107,98 +170,79 @@ OwnedCelSprite CelToCl2(const uint8_t *data, size_t size, PointerOrValue<uint16_
 	uint32_t numGroups = 1;
 	const uint32_t maybeNumFrames = LoadLE32(data);
 
-	std::vector<uint8_t> cl2Data;
-
-	// Most files become smaller with CL2. Allocate exactly enough bytes to avoid reallocation.
-	// The only file that becomes larger is Data\hf_logo3.CEL, by exactly 4445 bytes.
-	cl2Data.reserve(size + 4445);
-
 	// If it is a number of frames, then the last frame offset will be equal to the size of the file.
 	if (LoadLE32(&data[maybeNumFrames * 4 + 4]) != size) {
 		// maybeNumFrames is the address of the first group, right after
 		// the list of group offsets.
 		numGroups = maybeNumFrames / 4;
 		groupsHeaderSize = maybeNumFrames;
-		data += groupsHeaderSize;
-		cl2Data.resize(groupsHeaderSize);
 	}
 
+	// Locate the frames of all groups, group g holds the frames in [groupFrames[g], groupFrames[g + 1]).
+	std::vector<CelFrame> frames;
+	std::vector<size_t> groupFrames;
+	const uint8_t *groupData = data + groupsHeaderSize;
 	for (size_t group = 0; group < numGroups; ++group) {
-		uint32_t numFrames;
-		if (numGroups == 1) {
-			numFrames = maybeNumFrames;
-		} else {
-			numFrames = LoadLE32(data);
-			WriteLE32(&cl2Data[4 * group], cl2Data.size());
+		const uint32_t numFrames = numGroups == 1 ? maybeNumFrames : LoadLE32(groupData);
+		groupFrames.push_back(frames.size());
+		const uint8_t *srcEnd = &groupData[LoadLE32(&groupData[4])];
+		for (size_t frame = 1; frame <= numFrames; ++frame) {
+			const uint8_t *src = srcEnd;
+			srcEnd = &groupData[LoadLE32(&groupData[4 * (frame + 1)])];
+			const unsigned frameWidth = widthOrWidths.HoldsPointer() ? widthOrWidths.AsPointer()[frame - 1] : widthOrWidths.AsValue();
+			frames.push_back(CelFrame { src, srcEnd, frameWidth });
 		}
+		groupData = srcEnd;
+	}
+	groupFrames.push_back(frames.size());
+
+	// Frames don't depend on each other, so large files convert them in parallel and concatenate the results.
+	std::vector<std::vector<uint8_t>> convertedFrames;
+	if (threads != nullptr && frames.size() > 1 && size >= MinParallelCelSize) {
+		convertedFrames.resize(frames.size());
+		threads->ParallelFor(static_cast<int>(frames.size()), [&](int i) {
+			const CelFrame &frame = frames[i];
+			convertedFrames[i].reserve(static_cast<size_t>(frame.srcEnd - frame.src) + 64);
+			AppendCl2Frame(frame, convertedFrames[i]);
+		});
+	}
+
+	std::vector<uint8_t> cl2Data;
+
+	// Most files become smaller with CL2. Allocate exactly enough bytes to avoid reallocation.
+	// The only file that becomes larger is Data\hf_logo3.CEL, by exactly 4445 bytes.
+	cl2Data.reserve(size + 4445);
+	cl2Data.resize(groupsHeaderSize);
+
+	for (size_t group = 0; group < numGroups; ++group) {
+		const size_t firstFrame = groupFrames[group];
+		const auto numFrames = static_cast<uint32_t>(groupFrames[group + 1] - firstFrame);
+		if (numGroups != 1)
+			WriteLE32(&cl2Data[4 * group], cl2Data.size());
 
 		// CL2 header: frame count, frame offset for each frame, file size
 		const size_t cl2DataOffset = cl2Data.size();
 		cl2Data.resize(cl2Data.size() + 4 * (2 + static_cast<size_t>(numFrames)));
 		WriteLE32(cl2Data.data(), numFrames);
 
-		const uint8_t *srcEnd = &data[LoadLE32(&data[4])];
 		for (size_t frame = 1; frame <= numFrames; ++frame) {
-			const uint8_t *src = srcEnd;
-			srcEnd = &data[LoadLE32(&data[4 * (frame + 1)])];
 			WriteLE32(&cl2Data[cl2DataOffset + 4 * frame], static_cast<uint32_t>(cl2Data.size() - cl2DataOffset));
-
-			// Skip CEL frame header if there is one.
-			constexpr size_t CelFrameHeaderSize = 10;
-			const bool celFrameHasHeader = LoadLE16(src) == CelFrameHeaderSize;
-			if (celFrameHasHeader)
-				src += CelFrameHeaderSize;
-
-			const unsigned frameWidth = widthOrWidths.HoldsPointer() ? widthOrWidths.AsPointer()[frame - 1] : widthOrWidths.AsValue();
-
-			// Frame header: 5 16-bit offsets to 32-pixel height blocks.
-			const size_t frameHeaderPos = cl2Data.size();
-			constexpr size_t FrameHeaderSize = 10;
-			cl2Data.resize(cl2Data.size() + FrameHeaderSize);
-
-			// Frame header offset (first of five):
-			WriteLE16(&cl2Data[frameHeaderPos], FrameHeaderSize);
-
-			unsigned transparentRunWidth = 0;
-			size_t line = 0;
-			while (src != srcEnd) {
-				// Process line:
-				for (unsigned remainingCelWidth = frameWidth; remainingCelWidth != 0;) {
-					uint8_t val = *src++;
-					if (IsCelTransparent(val)) {
-						val = GetCelTransparentWidth(val);
-						transparentRunWidth += val;
-					} else {
-						AppendCl2TransparentRun(transparentRunWidth, cl2Data);
-						transparentRunWidth = 0;
-						AppendCl2PixelsOrFillRun(src, val, cl2Data);
-						src += val;
-					}
-					remainingCelWidth -= val;
-				}
-
-				// Frame header offset:
-				switch (++line) {
-				case 32:
-				case 64:
-				case 96:
-				case 128:
-					// Finish any active transparent run to not allow it to go over an offset line boundary.
-					AppendCl2TransparentRun(transparentRunWidth, cl2Data);
-					transparentRunWidth = 0;
-					WriteLE16(&cl2Data[frameHeaderPos + line / 16], static_cast<uint16_t>(cl2Data.size() - frameHeaderPos));
-					break;
-				}
+			const size_t frameIndex = firstFrame + frame - 1;
+			if (convertedFrames.empty()) {
+				AppendCl2Frame(frames[frameIndex], cl2Data);
+			} else {
+				const std::vector<uint8_t> &converted = convertedFrames[frameIndex];
+				cl2Data.insert(cl2Data.end(), converted.begin(), converted.end());
 			}
-			AppendCl2TransparentRun(transparentRunWidth, cl2Data);
 		}
 
 		WriteLE32(&cl2Data[cl2DataOffset + 4 * (1 + static_cast<size_t>(numFrames))], static_cast<uint32_t>(cl2Data.size() - cl2DataOffset));
-		data = srcEnd;
 	}
 
 	auto out = std::unique_ptr<byte[]>(new byte[cl2Data.size()]);
 	memcpy(&out[0], cl2Data.data(), cl2Data.size());
+	if (outSize != nullptr)
+		*outSize = cl2Data.size();
 #ifdef DEBUG_CEL_TO_CL2_SIZE
 	std::cout << "\t" << size << "\t" << cl2Data.size() << "\t" << std::setprecision(1) << std::fixed << (static_cast<int>(cl2Data.size()) - static_cast<int>(size)) / ((float)size) * 100 << "%" << std::endl;
 #endif
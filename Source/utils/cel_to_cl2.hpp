@@ -5,9 +5,16 @@
 
 #include "engine/cel_sprite.hpp"
 #include "utils/pointer_value_union.hpp"
+#include "utils/thread_pool.hpp"
 
 namespace devilution {
 
-OwnedCelSprite CelToCl2(const uint8_t *data, size_t size, PointerOrValue<uint16_t> widthOrWidths);
+/**
+ * @brief Converts a CEL file to CL2.
+ *
+ * @param outSize If not null, receives the size of the CL2 data.
+ * @param threads Threads to convert the frames of large files on, nullptr to convert them on the calling thread only.
+ */
+OwnedCelSprite CelToCl2(const uint8_t *data, size_t size, PointerOrValue<uint16_t> widthOrWidths, size_t *outSize = nullptr, ThreadPool *threads = nullptr);
 
 } // namespace devilution
@@ -355,6 +355,7 @@ void ReinitializeTexture()
 	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, quality.c_str());
 
 	texture = SDLWrap::CreateTexture(renderer, SDL_PIXELFORMAT_RGB888, SDL_TEXTUREACCESS_STREAMING, gnScreenWidth, gnScreenHeight);
+	InvalidateOutputSurface();
 }
 
 void ReinitializeIntegerScale()
@@ -417,6 +418,7 @@ void ReinitializeRenderer()
 		AdjustToScreenGeometry(windowSize);
 	}
 #endif
+	InvalidateOutputSurface();
 }
 
 void SetFullscreenMode()
@@ -480,8 +482,10 @@ SDL_Surface *GetOutputSurface()
 		ErrSdl();
 	return ret;
 #else
-	if (renderer != nullptr)
+	if (renderer != nullptr) {
+		SyncOutputSurface();
 		return RendererTextureSurface.get();
+	}
 	SDL_Surface *ret = SDL_GetWindowSurface(ghMainWnd);
 	if (ret == nullptr)
 		ErrSdl();
@@ -15,7 +15,7 @@
 
 namespace devilution {
 
-extern int refreshDelay; // Screen refresh rate in nanoseconds
+extern int refreshDelay; // Screen refresh rate in microseconds
 extern SDL_Window *window;
 extern SDL_Window *ghMainWnd;
 extern SDL_Renderer *renderer;
@@ -1,6 +1,7 @@
 #include "utils/file_util.h"
 
 #include <algorithm>
+#include <cerrno>
 #include <string>
 
 #include <SDL.h>
@@ -152,6 +153,35 @@ bool GetFileSize(const char *path, std::uintmax_t *size)
 #endif
 }
 
+bool GetFileModificationTime(const char *path, std::uint64_t *time)
+{
+#if defined(_WIN64) || defined(_WIN32)
+	WIN32_FILE_ATTRIBUTE_DATA attr;
+#if defined(NXDK)
+	if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attr)) {
+		return false;
+	}
+#else
+	const auto pathUtf16 = ToWideChar(path);
+	if (pathUtf16 == nullptr) {
+		LogError("UTF-8 -> UTF-16 conversion error code {}", ::GetLastError());
+		return false;
+	}
+	if (!GetFileAttributesExW(&pathUtf16[0], GetFileExInfoStandard, &attr)) {
+		return false;
+	}
+#endif
+	*time = static_cast<std::uint64_t>(attr.ftLastWriteTime.dwHighDateTime) << 32 | attr.ftLastWriteTime.dwLowDateTime;
+	return true;
+#else
+	struct ::stat statResult;
+	if (::stat(path, &statResult) == -1)
+		return false;
+	*time = static_cast<std::uint64_t>(statResult.st_mtime);
+	return true;
+#endif
+}
+
 bool ResizeFile(const char *path, std::uintmax_t size)
 {
 #if defined(_WIN64) || defined(_WIN32)
@@ -211,6 +241,24 @@ void RemoveFile(const char *path)
 #endif
 }
 
+bool CreateDir(const char *path)
+{
+#if defined(NXDK)
+	return ::CreateDirectoryA(path, nullptr) != FALSE || ::GetLastError() == ERROR_ALREADY_EXISTS;
+#elif defined(_WIN64) || defined(_WIN32)
+	const auto pathUtf16 = ToWideChar(path);
+	if (pathUtf16 == nullptr) {
+		LogError("UTF-8 -> UTF-16 conversion error code {}", ::GetLastError());
+		return false;
+	}
+	return ::CreateDirectoryW(&pathUtf16[0], nullptr) != FALSE || ::GetLastError() == ERROR_ALREADY_EXISTS;
+#elif _POSIX_C_SOURCE >= 200112L || defined(_BSD_SOURCE) || defined(__APPLE__)
+	return ::mkdir(path, 0700) == 0 || errno == EEXIST;
+#else
+	return false;
+#endif
+}
+
 std::optional<std::fstream> CreateFileStream(const char *path, std::ios::openmode mode)
 {
 #if (defined(_WIN64) || defined(_WIN32)) && !defined(NXDK)
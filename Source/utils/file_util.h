@@ -14,8 +14,17 @@ namespace devilution {
 bool FileExists(const char *path);
 bool FileExistsAndIsWriteable(const char *path);
 bool GetFileSize(const char *path, std::uintmax_t *size);
+/**
+ * @brief Reads when the file was last written to, in a platform specific unit that is only good for comparisons.
+ */
+bool GetFileModificationTime(const char *path, std::uint64_t *time);
 bool ResizeFile(const char *path, std::uintmax_t size);
 void RemoveFile(const char *path);
+/**
+ * @brief Creates a directory unless it exists already. The parent directory must exist.
+ * @return true if the directory exists afterwards.
+ */
+bool CreateDir(const char *path);
 std::optional<std::fstream> CreateFileStream(const char *path, std::ios::openmode mode);
 FILE *FOpen(const char *path, const char *mode);
 
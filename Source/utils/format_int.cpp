@@ -10,40 +10,46 @@
 namespace devilution {
 
 std::string FormatInteger(int n)
+{
+	char buf[FormatIntegerBufferSize];
+	return std::string(FormatIntegerTo(buf, n));
+}
+
+string_view FormatIntegerTo(char *out, size_t size, int n)
 {
 	constexpr size_t GroupSize = 3;
 
 	char buf[40];
-	char *begin = buf;
+	const char *begin = buf;
 	const char *end = BufCopy(buf, n);
 	const size_t len = end - begin;
 
-	std::string out;
+	char *outPos = out;
+	char *const outEnd = out + size - 1;
 	const size_t prefixLen = n < 0 ? 1 : 0;
 	const size_t numLen = len - prefixLen;
 	if (numLen <= GroupSize) {
-		out.append(begin, len);
-		return out;
+		outPos = BufCopyTruncated(outPos, outEnd, string_view(begin, len));
+		*outPos = '\0';
+		return { out, static_cast<size_t>(outPos - out) };
 	}
 
 	const string_view separator = _(/* TRANSLATORS: Thousands separator */ ",");
-	out.reserve(len + separator.size() * (numLen - 1) / GroupSize);
 	if (n < 0) {
-		out += '-';
+		outPos = BufCopyTruncated(outPos, outEnd, "-");
 		++begin;
 	}
 
 	size_t mlen = numLen % GroupSize;
 	if (mlen == 0)
 		mlen = GroupSize;
-	out.append(begin, mlen);
+	outPos = BufCopyTruncated(outPos, outEnd, string_view(begin, mlen));
 	begin += mlen;
-	for (; begin != end; begin += GroupSize) {
-		AppendStrView(out, separator);
-		out.append(begin, GroupSize);
-	}
+	for (; begin != end; begin += GroupSize)
+		outPos = BufCopyTruncated(outPos, outEnd, separator, string_view(begin, GroupSize));
 
-	return out;
+	*outPos = '\0';
+	return { out, static_cast<size_t>(outPos - out) };
 }
 
 } // namespace devilution
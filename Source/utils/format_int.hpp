@@ -1,12 +1,34 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
+#include "utils/stdcompat/string_view.hpp"
+
 namespace devilution {
 
+/**
+ * @brief Fits any result of FormatIntegerTo, unless the translated thousands separator is longer than 6 bytes.
+ */
+constexpr size_t FormatIntegerBufferSize = 32;
+
 /**
  * @brief Formats integer with thousands separator.
  */
 std::string FormatInteger(int n);
 
+/**
+ * @brief Formats integer with thousands separator into the buffer, without allocating.
+ *
+ * Whatever doesn't fit is cut off, the buffer is null-terminated.
+ * @return The text in the buffer
+ */
+string_view FormatIntegerTo(char *out, size_t size, int n);
+
+template <size_t N>
+string_view FormatIntegerTo(char (&out)[N], int n)
+{
+	return FormatIntegerTo(out, N, n);
+}
+
 } // namespace devilution
@@ -0,0 +1,79 @@
+#include "utils/frame_arena.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace devilution {
+
+namespace {
+
+size_t AlignUp(size_t value, size_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+FrameArena::FrameArena(size_t initialSize)
+{
+	AddChunk(initialSize);
+}
+
+void *FrameArena::Allocate(size_t size, size_t alignment)
+{
+	Chunk *chunk = &chunks_.back();
+	// Chunks are allocated with new[], so aligning the offset only works up to the default new alignment.
+	alignment = std::min<size_t>(alignment, alignof(std::max_align_t));
+	size_t offset = AlignUp(offset_, alignment);
+	if (offset + size > chunk->size) {
+		AddChunk(size);
+		chunk = &chunks_.back();
+		offset = 0;
+	}
+	offset_ = offset + size;
+	return chunk->data.get() + offset;
+}
+
+void FrameArena::Deallocate(void *ptr, size_t size)
+{
+	const Chunk &chunk = chunks_.back();
+	if (static_cast<byte *>(ptr) + size == chunk.data.get() + offset_)
+		offset_ -= size;
+}
+
+void FrameArena::Reset()
+{
+	if (chunks_.size() > 1) {
+		const size_t capacity = Capacity();
+		chunks_.clear();
+		AddChunk(capacity);
+	}
+	offset_ = 0;
+	committed_ = 0;
+}
+
+size_t FrameArena::Capacity() const
+{
+	size_t capacity = 0;
+	for (const Chunk &chunk : chunks_)
+		capacity += chunk.size;
+	return capacity;
+}
+
+void FrameArena::AddChunk(size_t minSize)
+{
+	if (!chunks_.empty())
+		committed_ += offset_;
+	// Doubling keeps the number of chunks down when a frame needs a lot more than usual.
+	const size_t size = std::max(minSize, chunks_.empty() ? size_t { 0 } : chunks_.back().size * 2);
+	chunks_.push_back({ std::unique_ptr<byte[]> { new byte[size] }, size });
+	offset_ = 0;
+}
+
+FrameArena &GetFrameArena()
+{
+	static FrameArena arena;
+	return arena;
+}
+
+} // namespace devilution
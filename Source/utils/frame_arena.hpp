@@ -0,0 +1,116 @@
+/**
+ * @file frame_arena.hpp
+ *
+ * Bump allocator for temporaries that only live until the end of the frame.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "utils/stdcompat/cstddef.hpp"
+
+/** Initial size of the frame arena in bytes, it grows when a frame needs more. */
+#ifndef DEVILUTIONX_FRAME_ARENA_SIZE
+#define DEVILUTIONX_FRAME_ARENA_SIZE (64 * 1024)
+#endif
+
+namespace devilution {
+
+/**
+ * @brief Hands out memory from large chunks and frees all of it at once.
+ *
+ * When an allocation doesn't fit, another chunk is added. On Reset the chunks are replaced by a single one large
+ * enough for everything the arena held, so that after the first few frames a frame doesn't touch the heap at all.
+ */
+class FrameArena {
+public:
+	explicit FrameArena(size_t initialSize = DEVILUTIONX_FRAME_ARENA_SIZE);
+
+	FrameArena(const FrameArena &) = delete;
+	FrameArena &operator=(const FrameArena &) = delete;
+
+	void *Allocate(size_t size, size_t alignment);
+
+	/**
+	 * @brief Gives the memory back if it was the latest allocation, so that a growing container can reuse it.
+	 */
+	void Deallocate(void *ptr, size_t size);
+
+	/** @brief Invalidates everything allocated from the arena. */
+	void Reset();
+
+	/** @brief Number of bytes allocated since the last reset, including alignment padding. */
+	[[nodiscard]] size_t BytesUsed() const
+	{
+		return committed_ + offset_;
+	}
+
+	/** @brief Total size of the chunks. */
+	[[nodiscard]] size_t Capacity() const;
+
+private:
+	struct Chunk {
+		std::unique_ptr<byte[]> data;
+		size_t size;
+	};
+
+	void AddChunk(size_t minSize);
+
+	std::vector<Chunk> chunks_;
+	/** @brief Offset of the next allocation in the last chunk. */
+	size_t offset_ = 0;
+	/** @brief Bytes used in all chunks but the last one. */
+	size_t committed_ = 0;
+};
+
+/**
+ * @brief The arena of the main thread, reset at the end of every game tick and every drawn frame.
+ *
+ * Nothing allocated from it may be kept across frames or used from another thread.
+ */
+FrameArena &GetFrameArena();
+
+/** @brief STL allocator that allocates from the frame arena. */
+template <typename T>
+struct FrameAllocator {
+	using value_type = T;
+
+	FrameAllocator() = default;
+
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U> &) noexcept // NOLINT(google-explicit-constructor)
+	{
+	}
+
+	T *allocate(size_t n)
+	{
+		return static_cast<T *>(GetFrameArena().Allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T *ptr, size_t n) noexcept
+	{
+		GetFrameArena().Deallocate(ptr, n * sizeof(T));
+	}
+
+	template <typename U>
+	bool operator==(const FrameAllocator<U> &) const noexcept
+	{
+		return true;
+	}
+
+	template <typename U>
+	bool operator!=(const FrameAllocator<U> &) const noexcept
+	{
+		return false;
+	}
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
+
+} // namespace devilution
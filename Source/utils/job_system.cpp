@@ -0,0 +1,254 @@
+#include "utils/job_system.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+#include "options.h"
+#include "utils/stdcompat/optional.hpp"
+
+namespace devilution {
+
+namespace {
+
+/** @brief The job system whose worker the current thread is, if any. */
+thread_local const JobSystem *CurrentJobSystem = nullptr;
+thread_local int CurrentWorker = -1;
+
+std::optional<JobSystem> TheJobSystem;
+
+} // namespace
+
+JobSystem::JobSystem(unsigned numWorkers)
+    : mainThreadId_(this_sdl_thread::get_id())
+{
+	queues_.reserve(numWorkers);
+	workerStarts_.reserve(numWorkers);
+	for (unsigned i = 0; i < numWorkers; i++) {
+		queues_.push_back(std::make_unique<WorkQueue>());
+		workerStarts_.push_back({ this, i });
+	}
+	workers_.reserve(numWorkers);
+	for (WorkerStart &start : workerStarts_)
+		workers_.emplace_back(WorkerMain, &start);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<SdlMutex> lock(sleepMutex_);
+		stopping_ = true;
+		changed_.broadcast();
+	}
+	for (SdlThread &worker : workers_)
+		worker.join();
+	while (RunMainThreadJob()) { }
+}
+
+int SDLCALL JobSystem::WorkerMain(void *data)
+{
+	const WorkerStart &start = *static_cast<const WorkerStart *>(data);
+	JobSystem &jobSystem = *start.jobSystem;
+	CurrentJobSystem = &jobSystem;
+	CurrentWorker = static_cast<int>(start.index);
+
+	Job job;
+	while (true) {
+		if (jobSystem.TakeJob(start.index, job)) {
+			jobSystem.Finish(job);
+			continue;
+		}
+		std::lock_guard<SdlMutex> lock(jobSystem.sleepMutex_);
+		// Queued jobs are finished before stopping.
+		if (jobSystem.queued_.load(std::memory_order_acquire) != 0)
+			continue;
+		if (jobSystem.stopping_)
+			return 0;
+		jobSystem.changed_.wait(jobSystem.sleepMutex_);
+	}
+}
+
+bool JobSystem::IsMainThread() const
+{
+	return this_sdl_thread::get_id() == mainThreadId_;
+}
+
+bool JobSystem::TakeJob(unsigned preferredQueue, Job &job)
+{
+	if (queued_.load(std::memory_order_acquire) == 0)
+		return false;
+
+	const auto numQueues = static_cast<unsigned>(queues_.size());
+	for (unsigned i = 0; i < numQueues; i++) {
+		const unsigned queueIndex = (preferredQueue + i) % numQueues;
+		WorkQueue &queue = *queues_[queueIndex];
+		std::lock_guard<SdlMutex> lock(queue.mutex);
+		if (queue.jobs.empty())
+			continue;
+		// A worker takes its newest job, its data is most likely still in the cache. Others steal the oldest one.
+		if (i == 0 && CurrentJobSystem == this && CurrentWorker == static_cast<int>(queueIndex)) {
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+		} else {
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+		}
+		queued_.fetch_sub(1, std::memory_order_acq_rel);
+		return true;
+	}
+	return false;
+}
+
+bool JobSystem::RunQueuedJob()
+{
+	const unsigned preferredQueue = CurrentJobSystem == this ? static_cast<unsigned>(CurrentWorker) : 0;
+	Job job;
+	if (!TakeJob(preferredQueue, job))
+		return false;
+	Finish(job);
+	return true;
+}
+
+bool JobSystem::RunMainThreadJob()
+{
+	Job job;
+	{
+		std::lock_guard<SdlMutex> lock(mainThreadMutex_);
+		if (mainThreadJobs_.empty())
+			return false;
+		job = std::move(mainThreadJobs_.front());
+		mainThreadJobs_.pop_front();
+	}
+	Finish(job);
+	return true;
+}
+
+void JobSystem::Finish(Job &job)
+{
+	job.run();
+	// Whatever the job captured is released before the waiting thread can go on.
+	job.run = nullptr;
+	job.counter->pending_.fetch_sub(1, std::memory_order_acq_rel);
+	std::lock_guard<SdlMutex> lock(sleepMutex_);
+	changed_.broadcast();
+}
+
+void JobSystem::Submit(JobCounter &counter, std::function<void()> job)
+{
+	if (workers_.empty()) {
+		job();
+		return;
+	}
+
+	counter.pending_.fetch_add(1, std::memory_order_acq_rel);
+	const unsigned queueIndex = CurrentJobSystem == this
+	    ? static_cast<unsigned>(CurrentWorker)
+	    : nextQueue_.fetch_add(1, std::memory_order_relaxed) % static_cast<unsigned>(queues_.size());
+	// Counted first, so that a worker never sleeps while the job is in a queue.
+	queued_.fetch_add(1, std::memory_order_acq_rel);
+	{
+		WorkQueue &queue = *queues_[queueIndex];
+		std::lock_guard<SdlMutex> lock(queue.mutex);
+		queue.jobs.push_back({ std::move(job), &counter });
+	}
+	std::lock_guard<SdlMutex> lock(sleepMutex_);
+	changed_.broadcast();
+}
+
+void JobSystem::SubmitToMainThread(JobCounter &counter, std::function<void()> job)
+{
+	counter.pending_.fetch_add(1, std::memory_order_acq_rel);
+	{
+		std::lock_guard<SdlMutex> lock(mainThreadMutex_);
+		mainThreadJobs_.push_back({ std::move(job), &counter });
+	}
+	std::lock_guard<SdlMutex> lock(sleepMutex_);
+	changed_.broadcast();
+}
+
+void JobSystem::Wait(JobCounter &counter)
+{
+	const bool isMainThread = IsMainThread();
+	while (!counter.IsDone()) {
+		if (isMainThread && RunMainThreadJob())
+			continue;
+		if (RunQueuedJob())
+			continue;
+		std::lock_guard<SdlMutex> lock(sleepMutex_);
+		if (counter.IsDone() || queued_.load(std::memory_order_acquire) != 0)
+			continue;
+		if (isMainThread) {
+			std::lock_guard<SdlMutex> mainThreadLock(mainThreadMutex_);
+			if (!mainThreadJobs_.empty())
+				continue;
+		}
+		changed_.wait(sleepMutex_);
+	}
+}
+
+void JobSystem::RunMainThreadJobs()
+{
+	while (RunMainThreadJob()) { }
+}
+
+void JobSystem::ParallelFor(int count, tl::function_ref<void(int)> job)
+{
+	ParallelForInOrder(count, job, [](int) {});
+}
+
+void JobSystem::ParallelForInOrder(int count, tl::function_ref<void(int)> job, tl::function_ref<void(int)> join)
+{
+	if (workers_.empty() || count <= 1) {
+		for (int i = 0; i < count; i++) {
+			job(i);
+			join(i);
+		}
+		return;
+	}
+
+	std::unique_ptr<std::atomic<bool>[]> done { new std::atomic<bool>[count] };
+	for (int i = 0; i < count; i++)
+		done[i].store(false, std::memory_order_relaxed);
+	std::atomic<int> next { 0 };
+	const auto runJobs = [&]() {
+		for (int i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed)) {
+			job(i);
+			done[i].store(true, std::memory_order_release);
+		}
+	};
+
+	JobCounter helpers;
+	const unsigned numHelpers = std::min(numWorkers(), static_cast<unsigned>(count - 1));
+	for (unsigned i = 0; i < numHelpers; i++)
+		Submit(helpers, runJobs);
+
+	int joined = 0;
+	for (int i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed)) {
+		job(i);
+		done[i].store(true, std::memory_order_release);
+		for (; joined < count && done[joined].load(std::memory_order_acquire); joined++)
+			join(joined);
+	}
+	Wait(helpers);
+	for (; joined < count; joined++)
+		join(joined);
+}
+
+JobSystem &GetJobSystem()
+{
+	if (!TheJobSystem)
+		TheJobSystem.emplace(static_cast<unsigned>(std::max(*sgOptions.Performance.workerThreads, 0)));
+	return *TheJobSystem;
+}
+
+void RunMainThreadJobs()
+{
+	if (TheJobSystem)
+		TheJobSystem->RunMainThreadJobs();
+}
+
+void StopJobSystem()
+{
+	TheJobSystem = std::nullopt;
+}
+
+} // namespace devilution
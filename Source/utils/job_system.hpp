@@ -0,0 +1,162 @@
+/**
+ * @file job_system.hpp
+ *
+ * Interface of the engine-wide worker threads that run queued jobs.
+ */
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <SDL.h>
+#include <function_ref.hpp>
+
+#include "utils/sdl_cond.h"
+#include "utils/sdl_mutex.h"
+#include "utils/sdl_thread.h"
+
+namespace devilution {
+
+/**
+ * @brief Counts the jobs of a group that haven't finished yet, see JobSystem::Wait.
+ *
+ * A counter can be reused once it is done. It must outlive the jobs submitted with it.
+ */
+class JobCounter final {
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter &) = delete;
+	JobCounter &operator=(const JobCounter &) = delete;
+
+	[[nodiscard]] bool IsDone() const
+	{
+		return pending_.load(std::memory_order_acquire) == 0;
+	}
+
+private:
+	friend class JobSystem;
+	std::atomic<int> pending_ { 0 };
+};
+
+/**
+ * @brief Worker threads with a queue each, idle workers steal the oldest jobs of the others.
+ *
+ * Unlike ThreadPool, jobs can be submitted and waited for from within jobs, so a job can split up its own work.
+ * Jobs that have to run on the main thread, e.g. because they call SDL, are kept apart and run by RunMainThreadJobs
+ * or while the main thread waits.
+ */
+class JobSystem final {
+public:
+	/**
+	 * @param numWorkers Number of threads started, with 0 every job runs on the thread that submits it.
+	 *
+	 * Must be constructed on the main thread.
+	 */
+	explicit JobSystem(unsigned numWorkers);
+	/** @brief Runs the jobs that are still queued and stops the workers. */
+	~JobSystem();
+
+	JobSystem(const JobSystem &) = delete;
+	JobSystem(JobSystem &&) = delete;
+	JobSystem &operator=(const JobSystem &) = delete;
+	JobSystem &operator=(JobSystem &&) = delete;
+
+	[[nodiscard]] unsigned numWorkers() const
+	{
+		return static_cast<unsigned>(workers_.size());
+	}
+
+	/** @brief Queues a job for the workers, it is counted by the counter until it has finished. */
+	void Submit(JobCounter &counter, std::function<void()> job);
+
+	/** @brief Queues a job that only runs on the main thread. */
+	void SubmitToMainThread(JobCounter &counter, std::function<void()> job);
+
+	/**
+	 * @brief Returns once all jobs of the counter have finished.
+	 *
+	 * The waiting thread runs queued jobs in the meantime, the main thread also runs its own ones.
+	 */
+	void Wait(JobCounter &counter);
+
+	/** @brief Runs the queued main thread jobs, must be called from the main thread. */
+	void RunMainThreadJobs();
+
+	/**
+	 * @brief Calls `job(i)` for every `i` in [0, count) on the workers and the calling thread and returns once all of the
+	 * calls have finished. May be called from within a job.
+	 */
+	void ParallelFor(int count, tl::function_ref<void(int)> job);
+
+	/**
+	 * @brief Like ParallelFor, additionally calls `join(i)` on the calling thread in increasing order of `i`.
+	 *
+	 * Each join call follows the matching job as soon as all of the earlier ones were joined. Combining per-job results in
+	 * the joins gives the same outcome however the jobs were scheduled.
+	 */
+	void ParallelForInOrder(int count, tl::function_ref<void(int)> job, tl::function_ref<void(int)> join);
+
+private:
+	struct Job {
+		std::function<void()> run;
+		JobCounter *counter;
+	};
+
+	struct WorkQueue {
+		SdlMutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	struct WorkerStart {
+		JobSystem *jobSystem;
+		unsigned index;
+	};
+
+	static int SDLCALL WorkerMain(void *data);
+
+	[[nodiscard]] bool IsMainThread() const;
+
+	/** @brief Takes a job from the queue of the given worker, or steals one from the others. */
+	bool TakeJob(unsigned preferredQueue, Job &job);
+
+	/** @brief Runs a queued job if there is one. */
+	bool RunQueuedJob();
+
+	bool RunMainThreadJob();
+
+	void Finish(Job &job);
+
+	std::vector<std::unique_ptr<WorkQueue>> queues_;
+	std::vector<WorkerStart> workerStarts_;
+	std::vector<SdlThread> workers_;
+	/** @brief Jobs in the worker queues, read without locking to decide whether to sleep. */
+	std::atomic<int> queued_ { 0 };
+	std::atomic<unsigned> nextQueue_ { 0 };
+
+	SdlMutex mainThreadMutex_;
+	std::deque<Job> mainThreadJobs_;
+	SDL_threadID mainThreadId_;
+
+	/** @brief Guards sleeping, changed_ is broadcast whenever jobs are queued or finish. */
+	SdlMutex sleepMutex_;
+	SdlCond changed_;
+	bool stopping_ = false;
+};
+
+/**
+ * @brief Returns the engine-wide job system, started with the number of workers of the Worker Threads option.
+ *
+ * The first call must be made from the main thread.
+ */
+JobSystem &GetJobSystem();
+
+/** @brief Runs the queued main thread jobs of the engine-wide job system, if it was started. */
+void RunMainThreadJobs();
+
+/** @brief Finishes the queued jobs and stops the workers, the next GetJobSystem call starts them again. */
+void StopJobSystem();
+
+} // namespace devilution
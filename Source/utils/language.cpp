@@ -1,8 +1,9 @@
 #include "utils/language.h"
 
+#include <cstring>
 #include <functional>
 #include <memory>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "engine/assets.hpp"
@@ -10,7 +11,9 @@
 #include "utils/file_util.h"
 #include "utils/log.hpp"
 #include "utils/paths.h"
+#include "utils/perf_scope.hpp"
 #include "utils/stdcompat/string_view.hpp"
+#include "utils/string_perfect_hash.hpp"
 
 #define MO_MAGIC 0x950412de
 
@@ -18,40 +21,11 @@ namespace {
 
 using namespace devilution;
 
-std::unique_ptr<char[]> translationKeys;
-std::unique_ptr<char[]> translationValues;
+/** @brief The whole .mo file, the keys and translations point into it. */
+std::unique_ptr<char[]> translationCatalog;
 
-using TranslationRef = uint32_t;
-
-struct StringHash {
-	size_t operator()(const char *str) const noexcept
-	{
-		return std::hash<string_view> {}(str);
-	}
-};
-
-struct StringEq {
-	bool operator()(const char *lhs, const char *rhs) const noexcept
-	{
-		return string_view(lhs) == string_view(rhs);
-	}
-};
-
-std::vector<std::unordered_map<const char *, TranslationRef, StringHash, StringEq>> translation = { {}, {} };
-
-constexpr uint32_t TranslationRefOffsetBits = 19;
-constexpr uint32_t TranslationRefSizeBits = 32 - TranslationRefOffsetBits; // 13
-constexpr uint32_t TranslationRefSizeMask = (1 << TranslationRefSizeBits) - 1;
-
-TranslationRef EncodeTranslationRef(uint32_t offset, uint32_t size)
-{
-	return (offset << TranslationRefSizeBits) | size;
-}
-
-string_view GetTranslation(TranslationRef ref)
-{
-	return { &translationValues[ref >> TranslationRefSizeBits], ref & TranslationRefSizeMask };
-}
+/** @brief One table per plural form, the catalog never changes after loading so the keys are perfectly hashed. */
+std::vector<StringPerfectHash<string_view>> translation = { {}, {} };
 
 } // namespace
 
@@ -244,16 +218,37 @@ void ParseMetadata(string_view metadata)
 	}
 }
 
-bool ReadEntry(SDL_RWops *rw, const MoEntry &e, char *result)
+/**
+ * @brief Returns the entry's string within the catalog, the .mo format terminates every string with a \0.
+ * @return nullptr if the entry doesn't fit the catalog
+ */
+const char *GetEntry(const char *catalog, size_t catalogSize, const MoEntry &e)
 {
-	if (SDL_RWseek(rw, e.offset, RW_SEEK_SET) == -1)
-		return false;
-	result[e.length] = '\0';
-	return static_cast<uint32_t>(SDL_RWread(rw, result, sizeof(char), e.length)) == e.length;
+	if (e.offset >= catalogSize || e.length >= catalogSize - e.offset || catalog[e.offset + e.length] != '\0')
+		return nullptr;
+	return &catalog[e.offset];
+}
+
+/**
+ * @brief Reads the .mo file with a single read, seeking to every string of an MPQ stream decompresses the same blocks
+ * over and over.
+ */
+std::unique_ptr<char[]> ReadCatalog(SDL_RWops *rw, size_t &size)
+{
+	const Sint64 rwSize = SDL_RWsize(rw);
+	if (rwSize < static_cast<Sint64>(sizeof(MoHead)))
+		return nullptr;
+	size = static_cast<size_t>(rwSize);
+	std::unique_ptr<char[]> catalog { new char[size] };
+	if (SDL_RWread(rw, catalog.get(), size, 1) != 1)
+		return nullptr;
+	return catalog;
 }
 
 } // namespace
 
+uint32_t LanguageGeneration = 1;
+
 string_view LanguageParticularTranslate(string_view context, string_view message)
 {
 	constexpr const char Glue = '\004';
@@ -263,36 +258,36 @@ string_view LanguageParticularTranslate(string_view context, string_view message
 	key += Glue;
 	AppendStrView(key, message);
 
-	auto it = translation[0].find(key.c_str());
-	if (it == translation[0].end()) {
+	const string_view *value = translation[0].Find(key);
+	if (value == nullptr) {
 		return message;
 	}
 
-	return GetTranslation(it->second);
+	return *value;
 }
 
 string_view LanguagePluralTranslate(const char *singular, string_view plural, int count)
 {
 	int n = GetLocalPluralId(count);
 
-	auto it = translation[n].find(singular);
-	if (it == translation[n].end()) {
+	const string_view *value = translation[n].Find(singular);
+	if (value == nullptr) {
 		if (count != 1)
 			return plural;
 		return singular;
 	}
 
-	return GetTranslation(it->second);
+	return *value;
 }
 
 string_view LanguageTranslate(const char *key)
 {
-	auto it = translation[0].find(key);
-	if (it == translation[0].end()) {
+	const string_view *value = translation[0].Find(key);
+	if (value == nullptr) {
 		return key;
 	}
 
-	return GetTranslation(it->second);
+	return *value;
 }
 
 bool HasTranslation(const std::string &locale)
@@ -322,9 +317,12 @@ bool IsSmallFontTall()
 
 void LanguageInitialize()
 {
+	DVL_PERF_FUNCTION();
+
+	// Whatever the call sites cached points into the buffers freed below.
+	LanguageGeneration++;
 	translation = { {}, {} };
-	translationKeys = nullptr;
-	translationValues = nullptr;
+	translationCatalog = nullptr;
 
 	const std::string lang(*sgOptions.Language.code);
 	SDL_RWops *rw;
@@ -342,97 +340,77 @@ void LanguageInitialize()
 		return;
 	}
 
+	size_t catalogSize;
+	std::unique_ptr<char[]> catalog = ReadCatalog(rw, catalogSize);
+	SDL_RWclose(rw);
+	if (catalog == nullptr)
+		return;
+
 	// Read header and do sanity checks
 	MoHead head;
-	if (SDL_RWread(rw, &head, sizeof(MoHead), 1) != 1) {
-		SDL_RWclose(rw);
-		return;
-	}
+	memcpy(&head, catalog.get(), sizeof(MoHead));
 	SwapLE(head);
 
 	if (head.magic != MO_MAGIC) {
-		SDL_RWclose(rw);
 		return; // not a MO file
 	}
 
 	if (head.revision.major > 1 || head.revision.minor > 1) {
-		SDL_RWclose(rw);
 		return; // unsupported revision
 	}
 
-	// Read entries of source strings
-	std::unique_ptr<MoEntry[]> src { new MoEntry[head.nbMappings] };
-	if (SDL_RWseek(rw, head.srcOffset, RW_SEEK_SET) == -1) {
-		SDL_RWclose(rw);
+	// Read entries of source and target strings
+	const size_t tableSize = static_cast<size_t>(head.nbMappings) * sizeof(MoEntry);
+	if (head.nbMappings == 0 || head.srcOffset > catalogSize || tableSize > catalogSize - head.srcOffset
+	    || head.dstOffset > catalogSize || tableSize > catalogSize - head.dstOffset)
 		return;
-	}
-	if (static_cast<uint32_t>(SDL_RWread(rw, src.get(), sizeof(MoEntry), head.nbMappings)) != head.nbMappings) {
-		SDL_RWclose(rw);
-		return;
-	}
-	for (size_t i = 0; i < head.nbMappings; ++i) {
-		SwapLE(src[i]);
-	}
-
-	// Read entries of target strings
+	std::unique_ptr<MoEntry[]> src { new MoEntry[head.nbMappings] };
 	std::unique_ptr<MoEntry[]> dst { new MoEntry[head.nbMappings] };
-	if (SDL_RWseek(rw, head.dstOffset, RW_SEEK_SET) == -1) {
-		SDL_RWclose(rw);
-		return;
-	}
-	if (static_cast<uint32_t>(SDL_RWread(rw, dst.get(), sizeof(MoEntry), head.nbMappings)) != head.nbMappings) {
-		SDL_RWclose(rw);
-		return;
-	}
+	memcpy(src.get(), &catalog[head.srcOffset], tableSize);
+	memcpy(dst.get(), &catalog[head.dstOffset], tableSize);
 	for (size_t i = 0; i < head.nbMappings; ++i) {
+		SwapLE(src[i]);
 		SwapLE(dst[i]);
 	}
 
 	// MO header
 	if (src[0].length != 0) {
-		SDL_RWclose(rw);
 		return;
 	}
 	{
-		auto headerValue = std::unique_ptr<char[]> { new char[dst[0].length + 1] };
-		if (!ReadEntry(rw, dst[0], &headerValue[0])) {
-			SDL_RWclose(rw);
+		const char *headerValue = GetEntry(catalog.get(), catalogSize, dst[0]);
+		if (headerValue == nullptr) {
 			return;
 		}
-		ParseMetadata(&headerValue[0]);
+		ParseMetadata(headerValue);
 	}
 
 	translation.resize(PluralForms);
 	for (unsigned i = 0; i < PluralForms; i++)
-		translation[i] = {};
+		translation[i].Clear();
+	std::vector<std::vector<std::pair<const char *, string_view>>> entries(PluralForms);
+	entries[0].reserve(head.nbMappings);
 
-	// Read strings described by entries
-	size_t keysSize = 0;
-	size_t valuesSize = 0;
+	// The strings are used where they are in the catalog
 	for (uint32_t i = 1; i < head.nbMappings; i++) {
-		keysSize += src[i].length + 1;
-		valuesSize += dst[i].length + 1;
-	}
-	translationKeys = std::unique_ptr<char[]> { new char[keysSize] };
-	translationValues = std::unique_ptr<char[]> { new char[valuesSize] };
-
-	char *keyPtr = &translationKeys[0];
-	char *valuePtr = &translationValues[0];
-	for (uint32_t i = 1; i < head.nbMappings; i++) {
-		if (ReadEntry(rw, src[i], keyPtr) && ReadEntry(rw, dst[i], valuePtr)) {
-			// Plural keys also have a plural form but it does not participate in lookup.
-			// Plural values are \0-terminated.
-			string_view value { valuePtr, dst[i].length + 1 };
-			for (size_t j = 0; j < PluralForms && !value.empty(); j++) {
-				const size_t formValueEnd = value.find('\0');
-				translation[j].emplace(keyPtr, EncodeTranslationRef(value.data() - &translationValues[0], formValueEnd));
-				value.remove_prefix(formValueEnd + 1);
-			}
-
-			keyPtr += src[i].length + 1;
-			valuePtr += dst[i].length + 1;
+		const char *key = GetEntry(catalog.get(), catalogSize, src[i]);
+		const char *valuePtr = GetEntry(catalog.get(), catalogSize, dst[i]);
+		if (key == nullptr || valuePtr == nullptr)
+			continue;
+		// Plural keys also have a plural form but it does not participate in lookup.
+		// Plural values are \0-terminated.
+		string_view value { valuePtr, dst[i].length + 1 };
+		for (size_t j = 0; j < PluralForms && !value.empty(); j++) {
+			const size_t formValueEnd = value.find('\0');
+			entries[j].emplace_back(key, value.substr(0, formValueEnd));
+			value.remove_prefix(formValueEnd + 1);
 		}
 	}
 
-	SDL_RWclose(rw);
+	translationCatalog = std::move(catalog);
+
+	for (unsigned i = 0; i < PluralForms; i++) {
+		if (!translation[i].Build(std::move(entries[i])))
+			LogError("Failed to index the translations of plural form {}", i);
+	}
 }
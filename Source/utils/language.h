@@ -1,10 +1,12 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 #include "utils/stdcompat/string_view.hpp"
 
-#define _(x) LanguageTranslate(x)
+#define _(x) LanguageTranslateCached([]() -> LanguageCacheSlot & { static LanguageCacheSlot slot; return slot; }(), x)
 #define ngettext(x, y, z) LanguagePluralTranslate(x, y, z)
 #define pgettext(context, x) LanguageParticularTranslate(context, x)
 #define N_(x) (x)
@@ -24,6 +26,44 @@ inline devilution::string_view LanguageTranslate(const std::string &key)
 	return LanguageTranslate(key.c_str());
 }
 
+/** @brief Changes whenever the translations are reloaded, which invalidates every LanguageCacheSlot. */
+extern uint32_t LanguageGeneration;
+
+/** @brief The translation a call site of `_()` last looked up. */
+struct LanguageCacheSlot {
+	uint32_t generation = 0;
+	devilution::string_view translation;
+};
+
+/**
+ * @brief Returns the translation for a constant key, it is only looked up once per call site and language.
+ *
+ * Only constant arrays are cached this way, their contents can't change while the call site keeps them in its slot.
+ */
+template <size_t N>
+devilution::string_view LanguageTranslateCached(LanguageCacheSlot &slot, const char (&key)[N])
+{
+	if (slot.generation != LanguageGeneration) {
+		slot.translation = LanguageTranslate(key);
+		slot.generation = LanguageGeneration;
+	}
+	return slot.translation;
+}
+
+/** @brief Keys in mutable buffers are looked up every time. */
+template <size_t N>
+devilution::string_view LanguageTranslateCached(LanguageCacheSlot & /*slot*/, char (&key)[N])
+{
+	return LanguageTranslate(key);
+}
+
+/** @brief Pointers and strings are looked up every time, what they point to isn't known to be constant. */
+template <typename T>
+devilution::string_view LanguageTranslateCached(LanguageCacheSlot & /*slot*/, const T &key)
+{
+	return LanguageTranslate(key);
+}
+
 /**
  * @brief Returns a singular or plural translation for the given keys and count.
  *
@@ -42,6 +42,12 @@ public:
 		return CheckError("seekp({}, {})", pos, DirToString(dir));
 	}
 
+	bool Seekg(std::streampos pos)
+	{
+		s_->seekg(pos);
+		return CheckError("seekg({})", pos);
+	}
+
 	bool Tellp(std::streampos *result)
 	{
 		*result = s_->tellp();
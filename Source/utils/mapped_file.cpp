@@ -0,0 +1,87 @@
+#include "utils/mapped_file.hpp"
+
+#include <cstdint>
+#include <limits>
+
+#include "utils/file_util.h"
+#include "utils/log.hpp"
+
+#if (defined(_WIN64) || defined(_WIN32)) && !defined(NXDK)
+// Suppress definitions of `min` and `max` macros by <windows.h>:
+#define NOMINMAX 1
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define DEVILUTIONX_MAPPED_FILE_WINDOWS
+#elif defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) || defined(__HAIKU__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DEVILUTIONX_MAPPED_FILE_POSIX
+#endif
+
+namespace devilution {
+
+std::unique_ptr<MappedFile> MappedFile::Open(const char *path)
+{
+#if defined(DEVILUTIONX_MAPPED_FILE_WINDOWS)
+	const auto pathUtf16 = ToWideChar(path);
+	if (pathUtf16 == nullptr) {
+		LogError("UTF-8 -> UTF-16 conversion error code {}", ::GetLastError());
+		return nullptr;
+	}
+	HANDLE file = ::CreateFileW(&pathUtf16[0], GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+	LARGE_INTEGER fileSize;
+	if (::GetFileSizeEx(file, &fileSize) == 0 || fileSize.QuadPart <= 0 || static_cast<uint64_t>(fileSize.QuadPart) > std::numeric_limits<std::size_t>::max()) {
+		::CloseHandle(file);
+		return nullptr;
+	}
+	HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	::CloseHandle(file);
+	if (mapping == nullptr) {
+		LogVerbose("CreateFileMapping failed for {}: error code {}", path, ::GetLastError());
+		return nullptr;
+	}
+	const void *data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	// The view keeps the mapping alive
+	::CloseHandle(mapping);
+	if (data == nullptr) {
+		LogVerbose("MapViewOfFile failed for {}: error code {}", path, ::GetLastError());
+		return nullptr;
+	}
+	return std::unique_ptr<MappedFile>(new MappedFile(static_cast<const byte *>(data), static_cast<std::size_t>(fileSize.QuadPart)));
+#elif defined(DEVILUTIONX_MAPPED_FILE_POSIX)
+	const int fd = ::open(path, O_RDONLY);
+	if (fd == -1)
+		return nullptr;
+	struct stat statResult;
+	if (::fstat(fd, &statResult) != 0 || statResult.st_size <= 0 || static_cast<uintmax_t>(statResult.st_size) > std::numeric_limits<std::size_t>::max()) {
+		::close(fd);
+		return nullptr;
+	}
+	const auto size = static_cast<std::size_t>(statResult.st_size);
+	void *data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	// The mapping stays valid after the file is closed
+	::close(fd);
+	if (data == MAP_FAILED) {
+		LogVerbose("mmap failed for {}", path);
+		return nullptr;
+	}
+	return std::unique_ptr<MappedFile>(new MappedFile(static_cast<const byte *>(data), size));
+#else
+	return nullptr;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#if defined(DEVILUTIONX_MAPPED_FILE_WINDOWS)
+	::UnmapViewOfFile(data_);
+#elif defined(DEVILUTIONX_MAPPED_FILE_POSIX)
+	::munmap(const_cast<byte *>(data_), size_);
+#endif
+}
+
+} // namespace devilution
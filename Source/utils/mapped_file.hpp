@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "utils/stdcompat/cstddef.hpp"
+
+namespace devilution {
+
+/**
+ * @brief A read-only memory mapping of a whole file.
+ */
+class MappedFile {
+public:
+	/**
+	 * @brief Maps the given file into memory.
+	 * @return nullptr if the file can't be mapped or mapping isn't supported on this platform.
+	 */
+	static std::unique_ptr<MappedFile> Open(const char *path);
+
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	[[nodiscard]] const byte *data() const
+	{
+		return data_;
+	}
+
+	[[nodiscard]] std::size_t size() const
+	{
+		return size_;
+	}
+
+private:
+	MappedFile(const byte *data, std::size_t size)
+	    : data_(data)
+	    , size_(size)
+	{
+	}
+
+	const byte *data_;
+	std::size_t size_;
+};
+
+} // namespace devilution
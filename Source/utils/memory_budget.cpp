@@ -0,0 +1,73 @@
+#include "utils/memory_budget.hpp"
+
+#include <array>
+#include <atomic>
+
+#include "options.h"
+
+namespace devilution {
+
+namespace {
+
+constexpr std::array<const char *, NumMemoryTags> MemoryTagNames = {
+	"Fonts",
+	"MonsterGraphics",
+	"Tilesets",
+	"TownerGraphics",
+	"SoundBank",
+};
+
+std::array<std::atomic<size_t>, NumMemoryTags> MemoryUsage;
+
+std::atomic<size_t> &GetUsage(MemoryTag tag)
+{
+	return MemoryUsage[static_cast<size_t>(tag)];
+}
+
+} // namespace
+
+const char *GetMemoryTagName(MemoryTag tag)
+{
+	return MemoryTagNames[static_cast<size_t>(tag)];
+}
+
+void SetMemoryUsage(MemoryTag tag, size_t bytes)
+{
+	GetUsage(tag).store(bytes, std::memory_order_relaxed);
+}
+
+void AddMemoryUsage(MemoryTag tag, size_t bytes)
+{
+	GetUsage(tag).fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void SubtractMemoryUsage(MemoryTag tag, size_t bytes)
+{
+	GetUsage(tag).fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+size_t GetMemoryUsage(MemoryTag tag)
+{
+	return GetUsage(tag).load(std::memory_order_relaxed);
+}
+
+size_t GetMemoryBudget(MemoryTag tag)
+{
+	constexpr size_t MiB = 1024 * 1024;
+	const MemoryOptions &options = sgOptions.Memory;
+	switch (tag) {
+	case MemoryTag::Fonts:
+		return static_cast<size_t>(*options.fontCache) * MiB;
+	case MemoryTag::MonsterGraphics:
+		return static_cast<size_t>(*options.monsterGraphics) * MiB;
+	case MemoryTag::Tilesets:
+		return static_cast<size_t>(*options.tilesets) * MiB;
+	case MemoryTag::TownerGraphics:
+		return static_cast<size_t>(*options.townerGraphics) * MiB;
+	case MemoryTag::SoundBank:
+		return static_cast<size_t>(*options.soundBank) * MiB;
+	}
+	return 0;
+}
+
+} // namespace devilution
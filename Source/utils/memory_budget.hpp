@@ -0,0 +1,76 @@
+/**
+ * @file memory_budget.hpp
+ *
+ * How much memory the large caches use and how much they may use.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/** Default budget of the font sheets, CJK text can touch hundreds of them. */
+#ifndef DEVILUTIONX_FONT_CACHE_SIZE
+#define DEVILUTIONX_FONT_CACHE_SIZE (4 * 1024 * 1024)
+#endif
+
+/** Default budget of the graphics of monster types that are no longer on the level. */
+#ifndef DEVILUTIONX_MONSTER_GFX_RETENTION_BUDGET
+#define DEVILUTIONX_MONSTER_GFX_RETENTION_BUDGET (24 * 1024 * 1024)
+#endif
+
+/** Default budget of the tilesets of other level types. */
+#ifndef DEVILUTIONX_TILESET_RETENTION_BUDGET
+#define DEVILUTIONX_TILESET_RETENTION_BUDGET (16 * 1024 * 1024)
+#endif
+
+/** Default budget of the towner sprites kept while the player is away from town. */
+#ifndef DEVILUTIONX_TOWNER_GFX_RETENTION_BUDGET
+#define DEVILUTIONX_TOWNER_GFX_RETENTION_BUDGET (4 * 1024 * 1024)
+#endif
+
+/** Default budget of the decoded sound effects. */
+#ifndef DEVILUTIONX_SOUND_BANK_SIZE
+#define DEVILUTIONX_SOUND_BANK_SIZE (32 * 1024 * 1024)
+#endif
+
+namespace devilution {
+
+/**
+ * @brief The subsystems whose memory is accounted for.
+ *
+ * The monster graphics, the tilesets and the towner sprites of the current level are always loaded, their budget only
+ * limits what is kept for later levels. The font sheets and the sound bank have to fit the budget as a whole.
+ */
+enum class MemoryTag : uint8_t {
+	Fonts,
+	MonsterGraphics,
+	Tilesets,
+	TownerGraphics,
+	SoundBank,
+
+	LAST = SoundBank
+};
+
+constexpr size_t NumMemoryTags = static_cast<size_t>(MemoryTag::LAST) + 1;
+
+const char *GetMemoryTagName(MemoryTag tag);
+
+/** @brief Replaces the number of bytes the subsystem uses, for the ones that keep track of it themselves. */
+void SetMemoryUsage(MemoryTag tag, size_t bytes);
+
+/** @brief Adds to the number of bytes the subsystem uses, may be called from any thread. */
+void AddMemoryUsage(MemoryTag tag, size_t bytes);
+
+/** @brief Subtracts from the number of bytes the subsystem uses, may be called from any thread. */
+void SubtractMemoryUsage(MemoryTag tag, size_t bytes);
+
+[[nodiscard]] size_t GetMemoryUsage(MemoryTag tag);
+
+/**
+ * @brief Returns how many bytes the subsystem may use, see MemoryOptions.
+ *
+ * The caches evict their least recently used entries to stay below it instead of growing further.
+ */
+[[nodiscard]] size_t GetMemoryBudget(MemoryTag tag);
+
+} // namespace devilution
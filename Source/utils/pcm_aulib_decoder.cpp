@@ -0,0 +1,75 @@
+#include "pcm_aulib_decoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "appfat.h"
+#include "utils/aulib.hpp"
+
+namespace devilution {
+
+std::unique_ptr<PcmSamples> DecodeToPcm(SharedAsset fileData, bool isMp3, size_t maxBytes)
+{
+	SDL_RWops *handle = SDL_RWops_FromSharedAsset(std::move(fileData));
+	if (handle == nullptr)
+		return nullptr;
+
+	std::unique_ptr<PcmSamples> result;
+	std::unique_ptr<Aulib::Decoder> decoder = CreateAulibDecoder(isMp3);
+	if (decoder->open(handle)) {
+		const int numChannels = decoder->getChannels();
+		const int sampleRate = decoder->getRate();
+		// The decoders only estimate the duration, one frame of slack makes sure that the end of the file is reached.
+		const size_t capacity = static_cast<size_t>((decoder->duration().count() * sampleRate / 1000000 + 1) * numChannels);
+		if (numChannels > 0 && capacity * sizeof(float) <= maxBytes) {
+			std::unique_ptr<float[]> data { new float[capacity] };
+			size_t size = 0;
+			bool callAgain = false;
+			int decoded;
+			while (size < capacity && (decoded = decoder->decode(&data[size], static_cast<int>(capacity - size), callAgain)) > 0)
+				size += static_cast<size_t>(decoded);
+			// A file that is longer than it claimed can't be decoded ahead of time.
+			float overflow[16];
+			if (size != 0 && (size < capacity || decoder->decode(overflow, 16, callAgain) == 0))
+				result.reset(new PcmSamples { std::move(data), size, numChannels, sampleRate });
+		}
+	}
+	SDL_RWclose(handle);
+	return result;
+}
+
+bool PcmAulibDecoder::open([[maybe_unused]] SDL_RWops *rwops)
+{
+	assert(rwops == nullptr);
+	return true;
+}
+
+bool PcmAulibDecoder::rewind()
+{
+	pos_ = 0;
+	return true;
+}
+
+std::chrono::microseconds PcmAulibDecoder::duration() const
+{
+	const auto frames = static_cast<long long>(samples_->size / samples_->numChannels);
+	return std::chrono::microseconds { frames * 1000000 / samples_->sampleRate };
+}
+
+bool PcmAulibDecoder::seekToTime(std::chrono::microseconds pos)
+{
+	const auto frame = static_cast<size_t>(std::max<long long>(pos.count(), 0) * samples_->sampleRate / 1000000);
+	pos_ = std::min(frame * samples_->numChannels, samples_->size);
+	return true;
+}
+
+int PcmAulibDecoder::doDecoding(float buf[], int len, bool &callAgain)
+{
+	callAgain = false;
+	const size_t count = std::min(static_cast<size_t>(len), samples_->size - pos_);
+	std::memcpy(buf, &samples_->data[pos_], count * sizeof(buf[0]));
+	pos_ += count;
+	return static_cast<int>(count);
+}
+
+} // namespace devilution
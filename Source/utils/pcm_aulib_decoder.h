@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+#include <Aulib/Decoder.h>
+
+#include "engine/assets.hpp"
+
+namespace devilution {
+
+/**
+ * @brief A sound decoded ahead of time, shared by every stream that plays it.
+ */
+struct PcmSamples {
+	/** @brief Interleaved samples of all channels. */
+	std::unique_ptr<float[]> data;
+	/** @brief Number of samples, i.e. frames times channels. */
+	size_t size;
+	int numChannels;
+	int sampleRate;
+
+	[[nodiscard]] size_t SizeInBytes() const
+	{
+		return size * sizeof(float);
+	}
+};
+
+/**
+ * @brief Decodes a whole WAV or MP3 file.
+ * @param maxBytes Files that decode to more than this many bytes are not decoded.
+ * @return The samples or nullptr if the file failed to decode or is too large
+ */
+std::unique_ptr<PcmSamples> DecodeToPcm(SharedAsset fileData, bool isMp3, size_t maxBytes);
+
+/**
+ * @brief A Decoder interface implementation that plays samples that were decoded ahead of time.
+ */
+class PcmAulibDecoder final : public ::Aulib::Decoder {
+public:
+	explicit PcmAulibDecoder(std::shared_ptr<const PcmSamples> samples)
+	    : samples_(std::move(samples))
+	{
+	}
+
+	bool open(SDL_RWops *rwops) override;
+
+	[[nodiscard]] int getChannels() const override
+	{
+		return samples_->numChannels;
+	}
+
+	[[nodiscard]] int getRate() const override
+	{
+		return samples_->sampleRate;
+	}
+
+	bool rewind() override;
+	[[nodiscard]] std::chrono::microseconds duration() const override;
+	bool seekToTime(std::chrono::microseconds pos) override;
+
+protected:
+	int doDecoding(float buf[], int len, bool &callAgain) override;
+
+private:
+	std::shared_ptr<const PcmSamples> samples_;
+	size_t pos_ = 0;
+};
+
+} // namespace devilution
@@ -110,7 +110,7 @@ size_t GetReservationSize(size_t pcxSize)
 
 } // namespace
 
-std::optional<OwnedCelSpriteWithFrameHeight> PcxToCl2(SDL_RWops *handle, int numFramesOrFrameHeight, std::optional<uint8_t> transparentColor, SDL_Color *outPalette)
+std::optional<OwnedCelSpriteWithFrameHeight> PcxToCl2(SDL_RWops *handle, int numFramesOrFrameHeight, std::optional<uint8_t> transparentColor, SDL_Color *outPalette, size_t *outSize)
 {
 	int width;
 	int height;
@@ -254,6 +254,8 @@ std::optional<OwnedCelSpriteWithFrameHeight> PcxToCl2(SDL_RWops *handle, int num
 
 	auto out = std::unique_ptr<byte[]>(new byte[cl2Data.size()]);
 	memcpy(&out[0], cl2Data.data(), cl2Data.size());
+	if (outSize != nullptr)
+		*outSize = cl2Data.size();
 #ifdef DEBUG_PCX_TO_CL2_SIZE
 	std::cout << "\t" << pixelDataSize << "\t" << cl2Data.size() << "\t" << std::setprecision(1) << std::fixed << (static_cast<int>(cl2Data.size()) - static_cast<int>(pixelDataSize)) / ((float)pixelDataSize) * 100 << "%" << std::endl;
 #endif
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 #include <SDL.h>
@@ -15,7 +16,8 @@ namespace devilution {
  * @param handle A non-null SDL_RWops handle. Closed by this function.
  * @param numFramesOrFrameHeight Pass a positive value with the number of frames, or the frame height as a negative value.
  * @param transparentColorIndex The PCX palette index of the transparent color.
+ * @param outSize If not null, receives the size of the CL2 data.
  */
-std::optional<OwnedCelSpriteWithFrameHeight> PcxToCl2(SDL_RWops *handle, int numFramesOrFrameHeight = 1, std::optional<uint8_t> transparentColor = std::nullopt, SDL_Color *outPalette = nullptr);
+std::optional<OwnedCelSpriteWithFrameHeight> PcxToCl2(SDL_RWops *handle, int numFramesOrFrameHeight = 1, std::optional<uint8_t> transparentColor = std::nullopt, SDL_Color *outPalette = nullptr, size_t *outSize = nullptr);
 
 } // namespace devilution
@@ -0,0 +1,92 @@
+#include "utils/perf_scope.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "utils/file_util.h"
+#include "utils/log.hpp"
+#include "utils/paths.h"
+#include "utils/sdl_mutex.h"
+#include "utils/sdl_thread.h"
+
+namespace devilution {
+
+namespace {
+
+struct TraceEvent {
+	const char *name;
+	uint64_t start;
+	uint64_t duration;
+	SDL_threadID threadId;
+};
+
+/** Events are written out once this many have been buffered. */
+constexpr size_t MaxBufferedEvents = 16384;
+
+SdlMutex TraceMutex;
+std::vector<TraceEvent> TraceEvents;
+FILE *TraceFile;
+
+uint64_t Now()
+{
+	static const auto Epoch = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Epoch).count();
+}
+
+/**
+ * @brief Writes the buffered events using the JSON array format, which viewers accept without the closing bracket.
+ */
+void WriteTraceEvents()
+{
+	if (TraceEvents.empty())
+		return;
+
+	if (TraceFile == nullptr) {
+		std::string path = paths::PrefPath() + "trace.json";
+		TraceFile = FOpen(path.c_str(), "wb");
+		if (TraceFile == nullptr) {
+			LogError("Failed to open {} for writing", path);
+			TraceEvents.clear();
+			return;
+		}
+		std::fputs("[\n", TraceFile);
+	}
+
+	for (const TraceEvent &event : TraceEvents) {
+		std::string line = fmt::format(R"({{"name":"{}","ph":"X","pid":0,"tid":{},"ts":{},"dur":{}}},)"
+		                               "\n",
+		    event.name, event.threadId, event.start, event.duration);
+		std::fwrite(line.data(), line.size(), 1, TraceFile);
+	}
+	std::fflush(TraceFile);
+	TraceEvents.clear();
+}
+
+} // namespace
+
+PerfScope::PerfScope(const char *name)
+    : name_(name)
+    , start_(Now())
+{
+}
+
+PerfScope::~PerfScope()
+{
+	const uint64_t end = Now();
+	std::lock_guard<SdlMutex> lock(TraceMutex);
+	TraceEvents.push_back(TraceEvent { name_, start_, end - start_, this_sdl_thread::get_id() });
+	if (TraceEvents.size() >= MaxBufferedEvents)
+		WriteTraceEvents();
+}
+
+void FlushPerfTrace()
+{
+	std::lock_guard<SdlMutex> lock(TraceMutex);
+	WriteTraceEvents();
+}
+
+} // namespace devilution
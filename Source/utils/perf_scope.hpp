@@ -0,0 +1,54 @@
+/**
+ * @file perf_scope.hpp
+ *
+ * Scoped instrumentation zones that are written to a Chrome trace file (chrome://tracing, Perfetto).
+ *
+ * The zones are compiled out unless the `PERF_TRACE` CMake option is enabled.
+ */
+#pragma once
+
+#ifdef PERF_TRACE
+#include <cstdint>
+#endif
+
+namespace devilution {
+
+#ifdef PERF_TRACE
+
+/**
+ * @brief Records the time spent in its own scope as a complete ("X") trace event.
+ */
+class PerfScope {
+public:
+	/** @param name Zone name, must outlive the trace (usually a string literal). */
+	explicit PerfScope(const char *name);
+	~PerfScope();
+
+	PerfScope(const PerfScope &) = delete;
+	PerfScope &operator=(const PerfScope &) = delete;
+
+private:
+	const char *name_;
+	uint64_t start_;
+};
+
+/**
+ * @brief Writes all buffered trace events to `trace.json` in the pref path.
+ */
+void FlushPerfTrace();
+
+#define DVL_PERF_CONCAT_IMPL(a, b) a##b
+#define DVL_PERF_CONCAT(a, b) DVL_PERF_CONCAT_IMPL(a, b)
+#define DVL_PERF_SCOPE(name) ::devilution::PerfScope DVL_PERF_CONCAT(perfScope, __LINE__)(name)
+#define DVL_PERF_FUNCTION() DVL_PERF_SCOPE(__func__)
+#define DVL_PERF_FLUSH() ::devilution::FlushPerfTrace()
+
+#else
+
+#define DVL_PERF_SCOPE(name)
+#define DVL_PERF_FUNCTION()
+#define DVL_PERF_FLUSH()
+
+#endif
+
+} // namespace devilution
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "appfat.h"
+
+namespace devilution {
+
+/**
+ * @brief A list that keeps its elements in reusable fixed size chunks instead of allocating each node separately.
+ *
+ * Like std::list, elements are iterated in insertion order, elements added while iterating are visited by the same
+ * loop, and erasing an element doesn't move any of the others. Pointers and references to an element remain valid
+ * until it is erased. Memory is only given back when the list is destroyed.
+ *
+ * @tparam T element type.
+ * @tparam ChunkSize number of elements allocated at once.
+ */
+template <class T, size_t ChunkSize = 64>
+class PooledList {
+	using Index = uint32_t;
+	static constexpr Index InvalidIndex = std::numeric_limits<Index>::max();
+
+	struct Slot {
+		std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+		Index prev;
+		Index next;
+	};
+
+public:
+	template <class List, class U>
+	class Iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = std::remove_const_t<U>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = U *;
+		using reference = U &;
+
+		Iterator() = default;
+
+		Iterator(List *list, Index index)
+		    : list_(list)
+		    , index_(index)
+		{
+		}
+
+		// Allows converting a mutable iterator to a const one
+		template <class OtherList, class OtherU>
+		Iterator(const Iterator<OtherList, OtherU> &other) // NOLINT(google-explicit-constructor)
+		    : list_(other.list_)
+		    , index_(other.index_)
+		{
+		}
+
+		reference operator*() const
+		{
+			return list_->element(index_);
+		}
+
+		pointer operator->() const
+		{
+			return &list_->element(index_);
+		}
+
+		Iterator &operator++()
+		{
+			index_ = list_->slot(index_).next;
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			Iterator copy = *this;
+			++*this;
+			return copy;
+		}
+
+		bool operator==(const Iterator &other) const
+		{
+			return index_ == other.index_;
+		}
+
+		bool operator!=(const Iterator &other) const
+		{
+			return index_ != other.index_;
+		}
+
+	private:
+		template <class, class>
+		friend class Iterator;
+
+		List *list_ = nullptr;
+		Index index_ = InvalidIndex;
+	};
+
+	using iterator = Iterator<PooledList, T>;
+	using const_iterator = Iterator<const PooledList, const T>;
+
+	PooledList() = default;
+	PooledList(const PooledList &) = delete;
+	PooledList &operator=(const PooledList &) = delete;
+
+	~PooledList()
+	{
+		clear();
+	}
+
+	[[nodiscard]] iterator begin()
+	{
+		return { this, head_ };
+	}
+
+	[[nodiscard]] iterator end()
+	{
+		return { this, InvalidIndex };
+	}
+
+	[[nodiscard]] const_iterator begin() const
+	{
+		return { this, head_ };
+	}
+
+	[[nodiscard]] const_iterator end() const
+	{
+		return { this, InvalidIndex };
+	}
+
+	[[nodiscard]] const_iterator cbegin() const
+	{
+		return begin();
+	}
+
+	[[nodiscard]] const_iterator cend() const
+	{
+		return end();
+	}
+
+	[[nodiscard]] size_t size() const
+	{
+		return size_;
+	}
+
+	[[nodiscard]] bool empty() const
+	{
+		return size_ == 0;
+	}
+
+	[[nodiscard]] size_t max_size() const // NOLINT(readability-identifier-naming)
+	{
+		return InvalidIndex - 1;
+	}
+
+	[[nodiscard]] T &back()
+	{
+		assert(tail_ != InvalidIndex);
+		return element(tail_);
+	}
+
+	template <typename... Args>
+	T &emplace_back(Args &&...args) // NOLINT(readability-identifier-naming)
+	{
+		if (free_ == InvalidIndex)
+			AddChunk();
+
+		const Index index = free_;
+		Slot &newSlot = slot(index);
+		free_ = newSlot.next;
+		::new (&newSlot.storage) T(std::forward<Args>(args)...);
+
+		newSlot.prev = tail_;
+		newSlot.next = InvalidIndex;
+		if (tail_ != InvalidIndex)
+			slot(tail_).next = index;
+		else
+			head_ = index;
+		tail_ = index;
+		size_++;
+
+		return element(index);
+	}
+
+	T &push_back(const T &value) // NOLINT(readability-identifier-naming)
+	{
+		return emplace_back(value);
+	}
+
+	/**
+	 * @brief Erases all elements that satisfy the predicate, keeping the order of the remaining ones.
+	 */
+	template <typename Predicate>
+	void remove_if(Predicate predicate) // NOLINT(readability-identifier-naming)
+	{
+		Index index = head_;
+		while (index != InvalidIndex) {
+			const Index next = slot(index).next;
+			if (predicate(element(index)))
+				Erase(index);
+			index = next;
+		}
+	}
+
+	void clear()
+	{
+		while (head_ != InvalidIndex)
+			Erase(head_);
+	}
+
+private:
+	Slot &slot(Index index)
+	{
+		return chunks_[index / ChunkSize][index % ChunkSize];
+	}
+
+	const Slot &slot(Index index) const
+	{
+		return chunks_[index / ChunkSize][index % ChunkSize];
+	}
+
+	T &element(Index index)
+	{
+		return *std::launder(reinterpret_cast<T *>(&slot(index).storage));
+	}
+
+	const T &element(Index index) const
+	{
+		return *std::launder(reinterpret_cast<const T *>(&slot(index).storage));
+	}
+
+	void AddChunk()
+	{
+		const Index first = static_cast<Index>(chunks_.size() * ChunkSize);
+		chunks_.emplace_back(new Slot[ChunkSize]);
+		// Thread the new slots on to the free list so that they're handed out in ascending order
+		Slot *chunk = chunks_.back().get();
+		for (size_t i = 0; i < ChunkSize; i++)
+			chunk[i].next = i + 1 < ChunkSize ? static_cast<Index>(first + i + 1) : free_;
+		free_ = first;
+	}
+
+	void Erase(Index index)
+	{
+		Slot &erased = slot(index);
+		if (erased.prev != InvalidIndex)
+			slot(erased.prev).next = erased.next;
+		else
+			head_ = erased.next;
+		if (erased.next != InvalidIndex)
+			slot(erased.next).prev = erased.prev;
+		else
+			tail_ = erased.prev;
+
+		element(index).~T();
+		erased.next = free_;
+		free_ = index;
+		size_--;
+	}
+
+	std::vector<std::unique_ptr<Slot[]>> chunks_;
+	Index head_ = InvalidIndex;
+	Index tail_ = InvalidIndex;
+	Index free_ = InvalidIndex;
+	size_t size_ = 0;
+};
+
+} // namespace devilution
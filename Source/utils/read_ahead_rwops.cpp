@@ -0,0 +1,269 @@
+#include "utils/read_ahead_rwops.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include "utils/log.hpp"
+#include "utils/sdl_cond.h"
+#include "utils/sdl_mutex.h"
+#include "utils/sdl_thread.h"
+
+#ifdef USE_SDL1
+#include "utils/sdl2_to_1_2_backports.h"
+#endif
+
+namespace devilution {
+
+namespace {
+
+/** @brief About 3 seconds of 22 kHz 16-bit stereo audio. */
+constexpr size_t RingBufferSize = 256 * 1024;
+
+/** @brief How much the background thread reads from the source at once. */
+constexpr size_t ChunkSize = 16 * 1024;
+
+std::atomic<uint32_t> TotalUnderruns;
+
+struct Data {
+	/** Only used by the background thread, except for the size. */
+	SDL_RWops *source;
+	Sint64 size;
+
+	SdlMutex mutex;
+	/** Signalled by the background thread when data was added or reached EOF. */
+	SdlCond dataAvailable;
+	/** Signalled by the reader when space was freed, a seek was requested, or the stream is closing. */
+	SdlCond workAvailable;
+
+	std::unique_ptr<uint8_t[]> ring;
+	/** Ring buffer index of the next byte to read. */
+	size_t head = 0;
+	/** Number of bytes buffered starting at `head`. */
+	size_t buffered = 0;
+	/** Stream position of the byte at `head`. */
+	Sint64 position = 0;
+	/** Stream position the background thread has to seek the source to before reading further, or -1. */
+	Sint64 pendingSeek = -1;
+	/** Incremented on every seek that drops the buffer, so that a read that was in flight gets discarded. */
+	uint32_t generation = 0;
+	bool eof = false;
+	bool stopping = false;
+	/** Whether any data was buffered yet. Waiting for the very first chunk isn't counted as an underrun. */
+	bool primed = false;
+	uint32_t underruns = 0;
+
+	SdlThread worker;
+
+	explicit Data(SDL_RWops *source, Sint64 size)
+	    : source(source)
+	    , size(size)
+	    , ring(new uint8_t[RingBufferSize])
+	    , worker(WorkerMain, this)
+	{
+	}
+
+	static int SDLCALL WorkerMain(void *ptr)
+	{
+		Data &data = *static_cast<Data *>(ptr);
+		std::unique_lock<SdlMutex> lock(data.mutex);
+		while (true) {
+			if (data.stopping)
+				return 0;
+			if (data.pendingSeek >= 0) {
+				const Sint64 target = data.pendingSeek;
+				data.pendingSeek = -1;
+				lock.unlock();
+				const bool ok = SDL_RWseek(data.source, target, RW_SEEK_SET) == target;
+				lock.lock();
+				if (!ok) {
+					LogError("SDL_RWops_ReadAhead seek failed: {}", SDL_GetError());
+					data.eof = true;
+					data.dataAvailable.broadcast();
+				}
+				continue;
+			}
+			if (data.eof || data.buffered == RingBufferSize) {
+				data.workAvailable.wait(data.mutex);
+				continue;
+			}
+
+			const size_t tail = (data.head + data.buffered) % RingBufferSize;
+			const size_t len = std::min({ ChunkSize, RingBufferSize - data.buffered, RingBufferSize - tail });
+			const uint32_t generation = data.generation;
+			// The reader never touches the unbuffered part of the ring, so it is safe to fill without the lock.
+			lock.unlock();
+			const size_t numRead = SDL_RWread(data.source, &data.ring[tail], 1, len);
+			lock.lock();
+
+			if (generation != data.generation)
+				continue;
+			data.buffered += numRead;
+			if (numRead < len)
+				data.eof = true;
+			data.primed = true;
+			data.dataAvailable.broadcast();
+		}
+	}
+};
+
+Data *GetData(struct SDL_RWops *context)
+{
+	return reinterpret_cast<Data *>(context->hidden.unknown.data1);
+}
+
+void SetData(struct SDL_RWops *context, Data *data)
+{
+	context->hidden.unknown.data1 = data;
+}
+
+#ifndef USE_SDL1
+using OffsetType = Sint64;
+using SizeType = size_t;
+#else
+using OffsetType = int;
+using SizeType = int;
+#endif
+
+extern "C" {
+
+#ifndef USE_SDL1
+static Sint64 ReadAheadRwSize(struct SDL_RWops *context)
+{
+	return GetData(context)->size;
+}
+#endif
+
+static OffsetType ReadAheadRwSeek(struct SDL_RWops *context, OffsetType offset, int whence)
+{
+	Data &data = *GetData(context);
+	std::lock_guard<SdlMutex> lock(data.mutex);
+	Sint64 newPosition;
+	switch (whence) {
+	case RW_SEEK_SET:
+		newPosition = offset;
+		break;
+	case RW_SEEK_CUR:
+		newPosition = data.position + offset;
+		break;
+	case RW_SEEK_END:
+		newPosition = data.size + offset;
+		break;
+	default:
+		return -1;
+	}
+
+	if (newPosition < 0 || newPosition > data.size) {
+		SDL_SetError("ReadAheadRwSeek out of bounds (%d)", static_cast<int>(newPosition));
+		return -1;
+	}
+
+	if (newPosition >= data.position && newPosition <= data.position + static_cast<Sint64>(data.buffered)) {
+		// Skipping ahead within the buffered data.
+		const auto skip = static_cast<size_t>(newPosition - data.position);
+		data.head = (data.head + skip) % RingBufferSize;
+		data.buffered -= skip;
+		data.position = newPosition;
+		data.workAvailable.signal();
+		return static_cast<OffsetType>(newPosition);
+	}
+
+	data.head = 0;
+	data.buffered = 0;
+	data.position = newPosition;
+	data.pendingSeek = newPosition;
+	data.eof = false;
+	++data.generation;
+	data.workAvailable.signal();
+	return static_cast<OffsetType>(newPosition);
+}
+
+static SizeType ReadAheadRwRead(struct SDL_RWops *context, void *ptr, SizeType size, SizeType maxnum)
+{
+	Data &data = *GetData(context);
+	const size_t totalSize = static_cast<size_t>(size) * maxnum;
+	size_t remainingSize = totalSize;
+	auto *out = static_cast<uint8_t *>(ptr);
+
+	std::unique_lock<SdlMutex> lock(data.mutex);
+	bool waited = false;
+	while (remainingSize > 0) {
+		if (data.buffered == 0) {
+			if (data.eof)
+				break;
+			if (data.primed && !waited) {
+				waited = true;
+				++data.underruns;
+				++TotalUnderruns;
+			}
+			data.dataAvailable.wait(data.mutex);
+			continue;
+		}
+
+		const size_t len = std::min({ remainingSize, data.buffered, RingBufferSize - data.head });
+		std::memcpy(out, &data.ring[data.head], len);
+		out += len;
+		remainingSize -= len;
+		data.head = (data.head + len) % RingBufferSize;
+		data.buffered -= len;
+		data.position += len;
+		data.workAvailable.signal();
+	}
+
+	return static_cast<SizeType>((totalSize - remainingSize) / size);
+}
+
+static int ReadAheadRwClose(struct SDL_RWops *context)
+{
+	Data *data = GetData(context);
+	{
+		std::lock_guard<SdlMutex> lock(data->mutex);
+		data->stopping = true;
+		data->workAvailable.signal();
+	}
+	data->worker.join();
+	if (data->underruns != 0)
+		LogVerbose("Read-ahead stream had {} underruns", data->underruns);
+	SDL_RWclose(data->source);
+	delete data;
+	delete context;
+	return 0;
+}
+
+} // extern "C"
+
+} // namespace
+
+SDL_RWops *SDL_RWops_ReadAhead(SDL_RWops *source)
+{
+	const Sint64 size = SDL_RWsize(source);
+	if (size < 0)
+		return nullptr;
+
+	auto result = std::make_unique<SDL_RWops>();
+	std::memset(result.get(), 0, sizeof(*result));
+
+#ifndef USE_SDL1
+	result->size = &ReadAheadRwSize;
+	result->type = SDL_RWOPS_UNKNOWN;
+#else
+	result->type = 0;
+#endif
+
+	result->seek = &ReadAheadRwSeek;
+	result->read = &ReadAheadRwRead;
+	result->write = nullptr;
+	result->close = &ReadAheadRwClose;
+	SetData(result.get(), new Data(source, size));
+	return result.release();
+}
+
+uint32_t GetReadAheadUnderrunCount()
+{
+	return TotalUnderruns;
+}
+
+} // namespace devilution
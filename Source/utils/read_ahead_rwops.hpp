@@ -0,0 +1,29 @@
+/**
+ * @file read_ahead_rwops.hpp
+ *
+ * Interface of an SDL_RWops that reads its source ahead on a background thread.
+ */
+#pragma once
+
+#include <cstdint>
+
+#include <SDL.h>
+
+namespace devilution {
+
+/**
+ * @brief Wraps a seekable SDL_RWops in one that is read ahead into a ring buffer by a dedicated thread.
+ *
+ * Reads only copy from the buffer, so a slow source (e.g. decompressing MPQ blocks) doesn't stall the reader.
+ * The source must not be used by anything else afterwards. It is closed when the result is closed.
+ *
+ * @return The wrapper, or nullptr if the source's size is unknown.
+ */
+SDL_RWops *SDL_RWops_ReadAhead(SDL_RWops *source);
+
+/**
+ * @brief Returns the number of reads that had to wait for the background thread, over all read-ahead streams.
+ */
+uint32_t GetReadAheadUnderrunCount();
+
+} // namespace devilution
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 
 #include "./console.h"
 
@@ -212,6 +213,46 @@ void copy_row3(Uint8 *src, int src_w, Uint8 *dst, int dst_w)
 	}
 }
 
+/**
+ * Same result as `copy_row*` when `dst_w` is a power of two multiple of `src_w`,
+ * where the fixed-point step is exact and every pixel is repeated `factor` times.
+ */
+template <typename T>
+void UpscaleRow(const T *src, int src_w, T *dst, int factor)
+{
+	for (int i = 0; i < src_w; ++i) {
+		const T pixel = src[i];
+		for (int j = 0; j < factor; ++j)
+			*dst++ = pixel;
+	}
+}
+
+/**
+ * Same result as `copy_row*` when `src_w` is a multiple of `dst_w`, every `factor`-th pixel is kept.
+ */
+template <typename T>
+void DownscaleRow(const T *src, int dst_w, T *dst, int factor)
+{
+	for (int i = 0; i < dst_w; ++i)
+		dst[i] = src[i * factor];
+}
+
+bool IsPowerOfTwo(int value)
+{
+	return value > 0 && (value & (value - 1)) == 0;
+}
+
+template <typename T>
+void CopyRow(T *src, int src_w, T *dst, int dst_w, void (*copyRow)(T *, int, T *, int))
+{
+	if (dst_w > src_w && dst_w % src_w == 0 && IsPowerOfTwo(dst_w / src_w))
+		UpscaleRow<T>(src, src_w, dst, dst_w / src_w);
+	else if (dst_w < src_w && src_w % dst_w == 0)
+		DownscaleRow<T>(src, dst_w, dst, src_w / dst_w);
+	else
+		copyRow(src, src_w, dst, dst_w);
+}
+
 } // namespace
 
 int SDL_SoftStretch(SDL_Surface *src, const SDL_Rect *srcrect,
@@ -226,6 +267,8 @@ int SDL_SoftStretch(SDL_Surface *src, const SDL_Rect *srcrect,
 	int src_row, dst_row;
 	Uint8 *srcp = NULL;
 	Uint8 *dstp;
+	const Uint8 *prevSrcp = NULL;
+	const Uint8 *prevDstp = NULL;
 	SDL_Rect full_src;
 	SDL_Rect full_dst;
 	const int bpp = dst->format->BytesPerPixel;
@@ -299,22 +342,30 @@ int SDL_SoftStretch(SDL_Surface *src, const SDL_Rect *srcrect,
 			++src_row;
 			pos -= 0x10000L;
 		}
+		if (srcp == prevSrcp) {
+			// Upscaled rows repeat the previous one.
+			memcpy(dstp, prevDstp, static_cast<size_t>(dstrect->w) * bpp);
+			pos += inc;
+			continue;
+		}
 		switch (bpp) {
 		case 1:
-			copy_row1(srcp, srcrect->w, dstp, dstrect->w);
+			CopyRow<Uint8>(srcp, srcrect->w, dstp, dstrect->w, copy_row1);
 			break;
 		case 2:
-			copy_row2((Uint16 *)srcp, srcrect->w,
-			    (Uint16 *)dstp, dstrect->w);
+			CopyRow<Uint16>((Uint16 *)srcp, srcrect->w,
+			    (Uint16 *)dstp, dstrect->w, copy_row2);
 			break;
 		case 3:
 			copy_row3(srcp, srcrect->w, dstp, dstrect->w);
 			break;
 		case 4:
-			copy_row4((Uint32 *)srcp, srcrect->w,
-			    (Uint32 *)dstp, dstrect->w);
+			CopyRow<Uint32>((Uint32 *)srcp, srcrect->w,
+			    (Uint32 *)dstp, dstrect->w, copy_row4);
 			break;
 		}
+		prevSrcp = srcp;
+		prevDstp = dstp;
 		pos += inc;
 	}
 
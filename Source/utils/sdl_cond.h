@@ -35,6 +35,13 @@ public:
 			ErrSdl();
 	}
 
+	void broadcast()
+	{
+		int err = SDL_CondBroadcast(cond);
+		if (err < 0)
+			ErrSdl();
+	}
+
 	void wait(SdlMutex &mutex)
 	{
 		int err = SDL_CondWait(cond, mutex.get());
@@ -42,6 +49,18 @@ public:
 			ErrSdl();
 	}
 
+	/**
+	 * @brief Waits until signaled or until the timeout expires.
+	 * @return false if the timeout expired.
+	 */
+	bool wait_for(SdlMutex &mutex, Uint32 timeoutMs)
+	{
+		int err = SDL_CondWaitTimeout(cond, mutex.get(), timeoutMs);
+		if (err < 0)
+			ErrSdl();
+		return err != SDL_MUTEX_TIMEDOUT;
+	}
+
 private:
 	SDL_cond *cond;
 };
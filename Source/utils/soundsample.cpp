@@ -4,8 +4,6 @@
 #include <cmath>
 #include <utility>
 
-#include <Aulib/DecoderDrmp3.h>
-#include <Aulib/DecoderDrwav.h>
 #include <SDL.h>
 #ifdef USE_SDL1
 #include "utils/sdl2_to_1_2_backports.h"
@@ -18,6 +16,8 @@
 #include "utils/aulib.hpp"
 #include "utils/log.hpp"
 #include "utils/math.h"
+#include "utils/pcm_aulib_decoder.h"
+#include "utils/read_ahead_rwops.hpp"
 #include "utils/stubs.h"
 
 namespace devilution {
@@ -57,16 +57,9 @@ float PanLogToLinear(int logPan)
 	return copysign(1.F - factor, static_cast<float>(logPan));
 }
 
-std::unique_ptr<Aulib::Decoder> CreateDecoder(bool isMp3)
-{
-	if (isMp3)
-		return std::make_unique<Aulib::DecoderDrmp3>();
-	return std::make_unique<Aulib::DecoderDrwav>();
-}
-
 std::unique_ptr<Aulib::Stream> CreateStream(SDL_RWops *handle, bool isMp3)
 {
-	return std::make_unique<Aulib::Stream>(handle, CreateDecoder(isMp3), CreateAulibResampler(), /*closeRw=*/true);
+	return std::make_unique<Aulib::Stream>(handle, CreateAulibDecoder(isMp3), CreateAulibResampler(), /*closeRw=*/true);
 }
 
 /**
@@ -90,8 +83,8 @@ void SoundSample::Release()
 {
 	stream_ = nullptr;
 #ifndef STREAM_ALL_AUDIO
-	file_data_ = nullptr;
-	file_data_size_ = 0;
+	file_data_ = {};
+	pcm_ = nullptr;
 #endif
 }
 
@@ -112,7 +105,7 @@ bool SoundSample::Play(int numIterations)
 	return true;
 }
 
-int SoundSample::SetChunkStream(std::string filePath, bool isMp3, bool logErrors)
+int SoundSample::SetChunkStream(std::string filePath, bool isMp3, bool logErrors, bool readAhead)
 {
 	SDL_RWops *handle = OpenAsset(filePath.c_str(), /*threadsafe=*/true);
 	if (handle == nullptr) {
@@ -120,6 +113,10 @@ int SoundSample::SetChunkStream(std::string filePath, bool isMp3, bool logErrors
 			LogError(LogCategory::Audio, "OpenAsset failed (from SoundSample::SetChunkStream): {}", SDL_GetError());
 		return -1;
 	}
+	if (readAhead) {
+		if (SDL_RWops *readAheadHandle = SDL_RWops_ReadAhead(handle))
+			handle = readAheadHandle;
+	}
 	file_path_ = std::move(filePath);
 	isMp3_ = isMp3;
 	stream_ = CreateStream(handle, isMp3_);
@@ -133,26 +130,39 @@ int SoundSample::SetChunkStream(std::string filePath, bool isMp3, bool logErrors
 }
 
 #ifndef STREAM_ALL_AUDIO
-int SoundSample::SetChunk(ArraySharedPtr<std::uint8_t> fileData, std::size_t dwBytes, bool isMp3)
+int SoundSample::SetChunk(SharedAsset fileData, bool isMp3)
 {
 	isMp3_ = isMp3;
 	file_data_ = std::move(fileData);
-	file_data_size_ = dwBytes;
-	SDL_RWops *buf = SDL_RWFromConstMem(file_data_.get(), dwBytes);
-	if (buf == nullptr) {
-		return -1;
-	}
+	SDL_RWops *buf = SDL_RWops_FromSharedAsset(file_data_);
 
 	stream_ = CreateStream(buf, isMp3_);
 	if (!stream_->open()) {
 		stream_ = nullptr;
-		file_data_ = nullptr;
+		file_data_ = {};
 		LogError(LogCategory::Audio, "Aulib::Stream::open (from SoundSample::SetChunk): {}", SDL_GetError());
 		return -1;
 	}
 
 	return 0;
 }
+
+int SoundSample::SetPcm(std::shared_ptr<const PcmSamples> pcm)
+{
+	isMp3_ = false;
+	file_data_ = {};
+	pcm_ = std::move(pcm);
+
+	stream_ = std::make_unique<Aulib::Stream>(/*rwops=*/nullptr, std::make_unique<PcmAulibDecoder>(pcm_), CreateAulibResampler(), /*closeRw=*/false);
+	if (!stream_->open()) {
+		stream_ = nullptr;
+		pcm_ = nullptr;
+		LogError(LogCategory::Audio, "Aulib::Stream::open (from SoundSample::SetPcm): {}", SDL_GetError());
+		return -1;
+	}
+
+	return 0;
+}
 #endif
 
 void SoundSample::SetVolume(int logVolume, int logMin, int logMax)
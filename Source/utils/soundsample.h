@@ -6,11 +6,13 @@
 
 #include <Aulib/Stream.h>
 
+#include "engine/assets.hpp"
 #include "engine/sound_defs.hpp"
-#include "utils/stdcompat/shared_ptr_array.hpp"
 
 namespace devilution {
 
+struct PcmSamples;
+
 class SoundSample final {
 public:
 	SoundSample() = default;
@@ -25,8 +27,12 @@ public:
 	void Release();
 	bool IsPlaying();
 
-	// Returns 0 on success.
-	int SetChunkStream(std::string filePath, bool isMp3, bool logErrors = true);
+	/**
+	 * @brief Streams the sample from the given asset.
+	 * @param readAhead Whether to read the asset ahead on a background thread, so that playback never waits for the archive.
+	 * @return 0 on success, -1 otherwise
+	 */
+	int SetChunkStream(std::string filePath, bool isMp3, bool logErrors = true, bool readAhead = false);
 
 	void SetFinishCallback(Aulib::Stream::Callback &&callback)
 	{
@@ -36,18 +42,22 @@ public:
 #ifndef STREAM_ALL_AUDIO
 	/**
 	 * @brief Sets the sample's WAV, FLAC, or Ogg/Vorbis data.
-	 * @param fileData Buffer containing the data
-	 * @param dwBytes Length of buffer
+	 * @param fileData The data, shared with other samples of the same asset
 	 * @param isMp3 Whether the data is an MP3
 	 * @return 0 on success, -1 otherwise
 	 */
-	int SetChunk(ArraySharedPtr<std::uint8_t> fileData, std::size_t dwBytes, bool isMp3);
-#endif
+	int SetChunk(SharedAsset fileData, bool isMp3);
+
+	/**
+	 * @brief Sets the sample's audio to samples that were decoded ahead of time.
+	 * @param pcm The samples, shared with other samples of the same asset
+	 * @return 0 on success, -1 otherwise
+	 */
+	int SetPcm(std::shared_ptr<const PcmSamples> pcm);
 
-#ifndef STREAM_ALL_AUDIO
 	[[nodiscard]] bool IsStreaming() const
 	{
-		return file_data_ == nullptr;
+		return !file_data_ && pcm_ == nullptr;
 	}
 #endif
 
@@ -58,8 +68,26 @@ public:
 #else
 		if (other.IsStreaming())
 			return SetChunkStream(other.file_path_, other.isMp3_);
-		return SetChunk(other.file_data_, other.file_data_size_, other.isMp3_);
+		if (other.pcm_ != nullptr)
+			return SetPcm(other.pcm_);
+		return SetChunk(other.file_data_, other.isMp3_);
+#endif
+	}
+
+	/**
+	 * @brief Whether this sample plays the same audio as the other one, e.g. because it was duplicated from it.
+	 */
+	[[nodiscard]] bool HasSameSourceAs(const SoundSample &other) const
+	{
+		if (!IsLoaded() || !other.IsLoaded() || isMp3_ != other.isMp3_)
+			return false;
+#ifndef STREAM_ALL_AUDIO
+		if (pcm_ != nullptr || other.pcm_ != nullptr)
+			return pcm_ == other.pcm_;
+		if (!IsStreaming() || !other.IsStreaming())
+			return file_data_.data() == other.file_data_.data();
 #endif
+		return file_path_ == other.file_path_;
 	}
 
 	/**
@@ -106,8 +134,8 @@ public:
 private:
 #ifndef STREAM_ALL_AUDIO
 	// Non-streaming audio fields:
-	ArraySharedPtr<std::uint8_t> file_data_;
-	std::size_t file_data_size_;
+	SharedAsset file_data_;
+	std::shared_ptr<const PcmSamples> pcm_;
 #endif
 
 	// Set for streaming audio to allow for duplicating it:
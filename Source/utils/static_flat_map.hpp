@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "appfat.h"
+#include "utils/static_vector.hpp"
+
+namespace devilution {
+
+/**
+ * @brief A map with a fixed capacity that keeps its entries sorted in inline storage.
+ *
+ * Lookups are a binary search over contiguous memory, inserts move the entries after the new one, so it suits small
+ * maps that are read a lot more often than they are written.
+ *
+ * @tparam Key key type.
+ * @tparam Value mapped type.
+ * @tparam N capacity.
+ */
+template <class Key, class Value, size_t N>
+class StaticFlatMap {
+public:
+	using value_type = std::pair<Key, Value>;
+
+	[[nodiscard]] const value_type *begin() const
+	{
+		return entries_.begin();
+	}
+
+	[[nodiscard]] const value_type *end() const
+	{
+		return entries_.end();
+	}
+
+	[[nodiscard]] size_t size() const
+	{
+		return entries_.size();
+	}
+
+	[[nodiscard]] bool empty() const
+	{
+		return entries_.empty();
+	}
+
+	[[nodiscard]] const value_type *find(const Key &key) const
+	{
+		const value_type *it = LowerBound(key);
+		return it != end() && it->first == key ? it : end();
+	}
+
+	[[nodiscard]] bool contains(const Key &key) const
+	{
+		return find(key) != end();
+	}
+
+	[[nodiscard]] const Value &at(const Key &key) const
+	{
+		const value_type *it = find(key);
+		assert(it != end());
+		return it->second;
+	}
+
+	/** @brief Returns the value of the key, inserting a default constructed one if the key is missing. */
+	Value &operator[](const Key &key)
+	{
+		const value_type *it = LowerBound(key);
+		if (it != end() && it->first == key)
+			return const_cast<Value &>(it->second);
+		return entries_.emplace(it, key, Value {}).second;
+	}
+
+	void clear()
+	{
+		entries_.clear();
+	}
+
+private:
+	[[nodiscard]] const value_type *LowerBound(const Key &key) const
+	{
+		return std::lower_bound(begin(), end(), key, [](const value_type &entry, const Key &k) { return entry.first < k; });
+	}
+
+	StaticVector<value_type, N> entries_;
+};
+
+} // namespace devilution
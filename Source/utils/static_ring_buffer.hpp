@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "appfat.h"
+
+namespace devilution {
+
+/**
+ * @brief A queue with a fixed capacity in inline storage, adding to a full buffer replaces the oldest element.
+ *
+ * Elements never move once they are constructed, so pointers into them stay valid until they are removed.
+ *
+ * @tparam T element type.
+ * @tparam N capacity.
+ */
+template <class T, size_t N>
+class StaticRingBuffer {
+public:
+	StaticRingBuffer() = default;
+
+	StaticRingBuffer(const StaticRingBuffer &) = delete;
+	StaticRingBuffer &operator=(const StaticRingBuffer &) = delete;
+
+	[[nodiscard]] size_t size() const
+	{
+		return size_;
+	}
+
+	[[nodiscard]] bool empty() const
+	{
+		return size_ == 0;
+	}
+
+	[[nodiscard]] bool full() const
+	{
+		return size_ == N;
+	}
+
+	[[nodiscard]] static constexpr size_t capacity()
+	{
+		return N;
+	}
+
+	/** @brief Element at pos, counted from the oldest one. */
+	[[nodiscard]] T &operator[](size_t pos)
+	{
+		assert(pos < size_);
+		return *Slot((first_ + pos) % N);
+	}
+
+	[[nodiscard]] const T &operator[](size_t pos) const
+	{
+		assert(pos < size_);
+		return *Slot((first_ + pos) % N);
+	}
+
+	[[nodiscard]] T &front()
+	{
+		return (*this)[0];
+	}
+
+	[[nodiscard]] T &back()
+	{
+		return (*this)[size_ - 1];
+	}
+
+	template <typename... Args>
+	T &emplace_back(Args &&...args) // NOLINT(readability-identifier-naming)
+	{
+		if (full())
+			pop_front();
+		const size_t index = (first_ + size_) % N;
+		::new (&data_[index]) T(std::forward<Args>(args)...);
+		++size_;
+		return *Slot(index);
+	}
+
+	void pop_front() // NOLINT(readability-identifier-naming)
+	{
+		assert(size_ > 0);
+		Slot(first_)->~T();
+		first_ = (first_ + 1) % N;
+		--size_;
+	}
+
+	void clear()
+	{
+		while (size_ > 0)
+			pop_front();
+		first_ = 0;
+	}
+
+	~StaticRingBuffer()
+	{
+		clear();
+	}
+
+private:
+	T *Slot(size_t index)
+	{
+#if __cplusplus >= 201703L
+		return std::launder(reinterpret_cast<T *>(&data_[index]));
+#else
+		return reinterpret_cast<T *>(&data_[index]);
+#endif
+	}
+
+	const T *Slot(size_t index) const
+	{
+#if __cplusplus >= 201703L
+		return std::launder(reinterpret_cast<const T *>(&data_[index]));
+#else
+		return reinterpret_cast<const T *>(&data_[index]);
+#endif
+	}
+
+	std::aligned_storage_t<sizeof(T), alignof(T)> data_[N];
+	size_t first_ = 0;
+	size_t size_ = 0;
+};
+
+} // namespace devilution
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <initializer_list>
 #include <memory>
@@ -29,9 +30,27 @@ public:
 		}
 	}
 
+	StaticVector(const StaticVector &other)
+	{
+		for (const T &element : other) {
+			emplace_back(element);
+		}
+	}
+
+	StaticVector &operator=(const StaticVector &other)
+	{
+		if (this != &other) {
+			clear();
+			for (const T &element : other) {
+				emplace_back(element);
+			}
+		}
+		return *this;
+	}
+
 	[[nodiscard]] const T *begin() const
 	{
-		return &(*this)[0];
+		return data();
 	}
 
 	[[nodiscard]] const T *end() const
@@ -39,11 +58,64 @@ public:
 		return begin() + size_;
 	}
 
+	[[nodiscard]] T *begin()
+	{
+		return data();
+	}
+
+	[[nodiscard]] T *end()
+	{
+		return begin() + size_;
+	}
+
+	[[nodiscard]] const T *data() const
+	{
+#if __cplusplus >= 201703L
+		return std::launder(reinterpret_cast<const T *>(&data_[0]));
+#else
+		return reinterpret_cast<const T *>(&data_[0]);
+#endif
+	}
+
+	[[nodiscard]] T *data()
+	{
+#if __cplusplus >= 201703L
+		return std::launder(reinterpret_cast<T *>(&data_[0]));
+#else
+		return reinterpret_cast<T *>(&data_[0]);
+#endif
+	}
+
 	[[nodiscard]] size_t size() const
 	{
 		return size_;
 	}
 
+	[[nodiscard]] bool empty() const
+	{
+		return size_ == 0;
+	}
+
+	[[nodiscard]] bool full() const
+	{
+		return size_ == N;
+	}
+
+	[[nodiscard]] static constexpr size_t capacity()
+	{
+		return N;
+	}
+
+	[[nodiscard]] T &back()
+	{
+		return (*this)[size_ - 1];
+	}
+
+	[[nodiscard]] const T &back() const
+	{
+		return (*this)[size_ - 1];
+	}
+
 	template <typename... Args>
 	T &emplace_back(Args &&...args) // NOLINT(readability-identifier-naming)
 	{
@@ -67,15 +139,41 @@ public:
 #endif
 	}
 
-	~StaticVector()
+	T &operator[](std::size_t pos)
 	{
-		for (std::size_t pos = 0; pos < size_; ++pos) {
 #if __cplusplus >= 201703L
-			std::destroy_at(std::launder(reinterpret_cast<T *>(&data_[pos])));
+		return *std::launder(reinterpret_cast<T *>(&data_[pos]));
 #else
-			reinterpret_cast<T *>(&data_[pos])->~T();
+		return *reinterpret_cast<T *>(&data_[pos]);
 #endif
-		}
+	}
+
+	/** @brief Inserts an element before pos, moving the elements after it. */
+	template <typename... Args>
+	T &emplace(const T *pos, Args &&...args) // NOLINT(readability-identifier-naming)
+	{
+		const auto index = static_cast<size_t>(pos - begin());
+		emplace_back(std::forward<Args>(args)...);
+		std::rotate(begin() + index, end() - 1, end());
+		return (*this)[index];
+	}
+
+	void pop_back() // NOLINT(readability-identifier-naming)
+	{
+		assert(size_ > 0);
+		--size_;
+		(*this)[size_].~T();
+	}
+
+	void clear()
+	{
+		while (size_ > 0)
+			pop_back();
+	}
+
+	~StaticVector()
+	{
+		clear();
 	}
 
 private:
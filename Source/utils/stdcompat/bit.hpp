@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(__cplusplus) && __cplusplus >= 202002L && __has_include(<bit>)
+#include <bit> // IWYU pragma: export
+#endif
+
+namespace devilution {
+#if defined(__cpp_lib_bitops) && __cpp_lib_bitops >= 201907L
+using std::countl_one;  // NOLINT(misc-unused-using-decls)
+using std::countl_zero; // NOLINT(misc-unused-using-decls)
+using std::countr_zero; // NOLINT(misc-unused-using-decls)
+using std::popcount;    // NOLINT(misc-unused-using-decls)
+#else
+constexpr int countl_zero(std::uint32_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return x == 0 ? 32 : __builtin_clz(x);
+#else
+	int n = 0;
+	for (std::uint32_t bit = 0x80000000; bit != 0 && (x & bit) == 0; bit >>= 1)
+		++n;
+	return n;
+#endif
+}
+
+constexpr int countl_one(std::uint32_t x)
+{
+	return countl_zero(~x);
+}
+
+constexpr int countr_zero(std::uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return x == 0 ? 64 : __builtin_ctzll(x);
+#else
+	int n = 0;
+	for (std::uint64_t bit = 1; bit != 0 && (x & bit) == 0; bit <<= 1)
+		++n;
+	return n;
+#endif
+}
+
+constexpr int popcount(std::uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(x);
+#else
+	int n = 0;
+	for (; x != 0; x &= x - 1)
+		++n;
+	return n;
+#endif
+}
+#endif
+} // namespace devilution
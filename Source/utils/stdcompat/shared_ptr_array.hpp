@@ -10,6 +10,9 @@ namespace devilution {
 template <typename T>
 using ArraySharedPtr = std::shared_ptr<T[]>;
 
+template <typename T>
+using ArrayWeakPtr = std::weak_ptr<T[]>;
+
 template <typename T>
 ArraySharedPtr<T> MakeArraySharedPtr(std::size_t size)
 {
@@ -19,6 +22,9 @@ ArraySharedPtr<T> MakeArraySharedPtr(std::size_t size)
 template <typename T>
 using ArraySharedPtr = std::shared_ptr<T>;
 
+template <typename T>
+using ArrayWeakPtr = std::weak_ptr<T>;
+
 template <typename T>
 ArraySharedPtr<T> MakeArraySharedPtr(std::size_t size)
 {
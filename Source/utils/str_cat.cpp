@@ -25,4 +25,10 @@ void StrAppend(std::string &out, int value)
 	out.append(&buf[0], BufCopy(buf, value) - &buf[0]);
 }
 
+char *BufCopyTruncated(char *out, char *end, int value)
+{
+	char buf[MaxDecimalDigits<int> + 1];
+	return BufCopyTruncated(out, end, string_view(&buf[0], BufCopy(buf, value) - &buf[0]));
+}
+
 } // namespace devilution
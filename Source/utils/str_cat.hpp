@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <string>
 #include <type_traits>
@@ -79,4 +81,64 @@ std::string StrCat(Args &&...args)
 	return result;
 }
 
+/**
+ * @brief Writes as much of the integer as fits into [out, end).
+ * @return char* end of the written text
+ */
+char *BufCopyTruncated(char *out, char *end, int value);
+
+/**
+ * @brief Copies as much of the given string_view as fits into [out, end).
+ * @return char* end of the copied text
+ */
+inline char *BufCopyTruncated(char *out, char *end, string_view value)
+{
+	const size_t size = std::min(value.size(), static_cast<size_t>(end - out));
+	std::memcpy(out, value.data(), size);
+	return out + size;
+}
+
+/**
+ * @brief Copies as much of the given C string as fits into [out, end).
+ */
+inline char *BufCopyTruncated(char *out, char *end, const char *str)
+{
+	return BufCopyTruncated(out, end, string_view(str != nullptr ? str : "(nullptr)"));
+}
+
+template <typename Arg, typename... Args>
+inline typename std::enable_if<(sizeof...(Args) > 0), char *>::type
+BufCopyTruncated(char *out, char *end, Arg &&arg, Args &&...args)
+{
+	return BufCopyTruncated(BufCopyTruncated(out, end, std::forward<Arg>(arg)), end, std::forward<Args>(args)...);
+}
+
+/**
+ * @brief Appends the arguments to the null-terminated text in the buffer, for text that is built every frame.
+ *
+ * Nothing is allocated, whatever doesn't fit is cut off. The buffer stays null-terminated.
+ * @return The whole text in the buffer
+ */
+template <size_t N, typename... Args>
+string_view StrAppendTo(char (&out)[N], Args &&...args)
+{
+	static_assert(N > 0, "The buffer needs room for the null terminator");
+	size_t length = 0;
+	while (length < N - 1 && out[length] != '\0')
+		length++;
+	char *end = BufCopyTruncated(&out[length], &out[N - 1], std::forward<Args>(args)...);
+	*end = '\0';
+	return { out, static_cast<size_t>(end - out) };
+}
+
+/**
+ * @brief Like StrCat, but writes to the buffer instead of allocating, see StrAppendTo.
+ */
+template <size_t N, typename... Args>
+string_view StrCatTo(char (&out)[N], Args &&...args)
+{
+	out[0] = '\0';
+	return StrAppendTo(out, std::forward<Args>(args)...);
+}
+
 } // namespace devilution
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "utils/stdcompat/string_view.hpp"
+
+namespace devilution {
+
+/**
+ * @brief An immutable map from strings to values, built once with a minimal perfect hash.
+ *
+ * The keys are spread over buckets by their hash, then every bucket gets a displacement that moves all of its keys
+ * to free slots ("hash and displace"). A lookup hashes the key once and compares it with the one candidate slot.
+ * The map doesn't own the keys, they have to outlive it.
+ *
+ * @tparam Value mapped type.
+ */
+template <class Value>
+class StringPerfectHash {
+public:
+	using value_type = std::pair<const char *, Value>;
+
+	/**
+	 * @brief Replaces the entries of the map, the first of several entries with the same key wins.
+	 * @return false if no perfect hash was found, the map is empty then
+	 */
+	bool Build(std::vector<value_type> entries)
+	{
+		std::stable_sort(entries.begin(), entries.end(), [](const value_type &a, const value_type &b) {
+			return string_view(a.first) < string_view(b.first);
+		});
+		entries.erase(std::unique(entries.begin(), entries.end(), [](const value_type &a, const value_type &b) {
+			return string_view(a.first) == string_view(b.first);
+		}),
+		    entries.end());
+
+		for (uint64_t salt = 0; salt < MaxSalts; salt++) {
+			if (TryBuild(entries, salt))
+				return true;
+		}
+		Clear();
+		return false;
+	}
+
+	void Clear()
+	{
+		displacements_.clear();
+		slots_.clear();
+	}
+
+	[[nodiscard]] size_t size() const
+	{
+		return slots_.size();
+	}
+
+	[[nodiscard]] bool empty() const
+	{
+		return slots_.empty();
+	}
+
+	/** @return the value of the key or nullptr if the map doesn't contain it */
+	[[nodiscard]] const Value *Find(string_view key) const
+	{
+		if (slots_.empty())
+			return nullptr;
+		const uint64_t hash = Hash(key, salt_);
+		const value_type &slot = slots_[GetSlot(hash, displacements_[hash % displacements_.size()])];
+		if (string_view(slot.first) != key)
+			return nullptr;
+		return &slot.second;
+	}
+
+private:
+	/** @brief Average number of keys per bucket, more keys per bucket need less memory but take longer to build. */
+	static constexpr size_t KeysPerBucket = 4;
+	static constexpr uint32_t MaxDisplacement = 1 << 16;
+	/** @brief Two keys with the same hash can't be displaced apart, so the hash is salted differently on each attempt. */
+	static constexpr uint64_t MaxSalts = 8;
+
+	static uint64_t Hash(string_view key, uint64_t salt)
+	{
+		// 64-bit FNV-1a
+		uint64_t hash = 14695981039346656037ULL ^ (salt * 0x9E3779B97F4A7C15ULL);
+		for (char c : key) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	[[nodiscard]] size_t GetSlot(uint64_t hash, uint32_t displacement) const
+	{
+		// The splitmix64 finalizer, so that the slot doesn't correlate with the bucket.
+		uint64_t x = hash + (displacement + 1) * 0x9E3779B97F4A7C15ULL;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+		x ^= x >> 31;
+		return static_cast<size_t>(x % slots_.size());
+	}
+
+	bool TryBuild(const std::vector<value_type> &entries, uint64_t salt)
+	{
+		const size_t numKeys = entries.size();
+		salt_ = salt;
+		slots_.assign(numKeys, value_type {});
+		displacements_.assign(std::max<size_t>(1, (numKeys + KeysPerBucket - 1) / KeysPerBucket), 0);
+		if (numKeys == 0) {
+			slots_.clear();
+			return true;
+		}
+
+		std::vector<uint64_t> hashes(numKeys);
+		std::vector<std::vector<uint32_t>> buckets(displacements_.size());
+		for (size_t i = 0; i < numKeys; i++) {
+			hashes[i] = Hash(entries[i].first, salt);
+			buckets[hashes[i] % buckets.size()].push_back(static_cast<uint32_t>(i));
+		}
+		std::vector<uint32_t> order(buckets.size());
+		for (size_t i = 0; i < order.size(); i++)
+			order[i] = static_cast<uint32_t>(i);
+		// The buckets with the most keys are the hardest to place, so they go first while most slots are free.
+		std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) {
+			return buckets[a].size() > buckets[b].size();
+		});
+
+		std::vector<bool> occupied(numKeys, false);
+		std::vector<size_t> bucketSlots;
+		for (uint32_t bucketIndex : order) {
+			const std::vector<uint32_t> &bucket = buckets[bucketIndex];
+			if (bucket.empty())
+				break;
+			uint32_t displacement = 0;
+			for (; displacement < MaxDisplacement; displacement++) {
+				bucketSlots.clear();
+				bool fits = true;
+				for (uint32_t key : bucket) {
+					const size_t slot = GetSlot(hashes[key], displacement);
+					if (occupied[slot] || std::find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end()) {
+						fits = false;
+						break;
+					}
+					bucketSlots.push_back(slot);
+				}
+				if (fits)
+					break;
+			}
+			if (displacement == MaxDisplacement)
+				return false;
+			displacements_[bucketIndex] = displacement;
+			for (size_t i = 0; i < bucket.size(); i++) {
+				occupied[bucketSlots[i]] = true;
+				slots_[bucketSlots[i]] = entries[bucket[i]];
+			}
+		}
+		return true;
+	}
+
+	uint64_t salt_ = 0;
+	std::vector<uint32_t> displacements_;
+	std::vector<value_type> slots_;
+};
+
+} // namespace devilution
@@ -0,0 +1,74 @@
+#include "utils/thread_pool.hpp"
+
+namespace devilution {
+
+ThreadPool::ThreadPool(unsigned numWorkers)
+{
+	workers_.reserve(numWorkers);
+	for (unsigned i = 0; i < numWorkers; i++)
+		workers_.emplace_back(WorkerMain, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<SdlMutex> lock(mutex_);
+		stopping_ = true;
+		workAvailable_.broadcast();
+	}
+	for (SdlThread &worker : workers_)
+		worker.join();
+}
+
+int SDLCALL ThreadPool::WorkerMain(void *data)
+{
+	ThreadPool &pool = *static_cast<ThreadPool *>(data);
+	std::unique_lock<SdlMutex> lock(pool.mutex_);
+	unsigned seenGeneration = pool.generation_;
+	while (true) {
+		while (!pool.stopping_ && pool.generation_ == seenGeneration)
+			pool.workAvailable_.wait(pool.mutex_);
+		if (pool.stopping_)
+			return 0;
+		seenGeneration = pool.generation_;
+		pool.RunJobs(lock);
+	}
+}
+
+void ThreadPool::RunJobs(std::unique_lock<SdlMutex> &lock)
+{
+	while (next_ < count_) {
+		const int index = next_++;
+		lock.unlock();
+		(*job_)(index);
+		lock.lock();
+		if (--remaining_ == 0)
+			workDone_.broadcast();
+	}
+}
+
+void ThreadPool::ParallelFor(int count, tl::function_ref<void(int)> job)
+{
+	if (workers_.empty() || count <= 1) {
+		for (int i = 0; i < count; i++)
+			job(i);
+		return;
+	}
+
+	std::unique_lock<SdlMutex> lock(mutex_);
+	job_ = &job;
+	count_ = count;
+	next_ = 0;
+	remaining_ = count;
+	generation_++;
+	workAvailable_.broadcast();
+
+	RunJobs(lock);
+	while (remaining_ != 0)
+		workDone_.wait(mutex_);
+
+	job_ = nullptr;
+	count_ = 0;
+}
+
+} // namespace devilution
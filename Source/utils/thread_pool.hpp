@@ -0,0 +1,65 @@
+/**
+ * @file thread_pool.hpp
+ *
+ * Interface of a fixed set of worker threads that share batches of jobs with the calling thread.
+ */
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include <function_ref.hpp>
+
+#include "utils/sdl_cond.h"
+#include "utils/sdl_mutex.h"
+#include "utils/sdl_thread.h"
+
+namespace devilution {
+
+class ThreadPool final {
+public:
+	/**
+	 * @param numWorkers Number of threads started in addition to the thread calling ParallelFor
+	 */
+	explicit ThreadPool(unsigned numWorkers);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool(ThreadPool &&) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+	ThreadPool &operator=(ThreadPool &&) = delete;
+
+	/** @brief Number of threads that run jobs, including the calling thread. */
+	[[nodiscard]] unsigned concurrency() const
+	{
+		return static_cast<unsigned>(workers_.size()) + 1;
+	}
+
+	/**
+	 * @brief Calls `job(i)` for every `i` in [0, count) and returns once all of the calls have finished.
+	 *
+	 * The calls are spread over the workers and the calling thread in no particular order.
+	 * Must not be called from within a job.
+	 */
+	void ParallelFor(int count, tl::function_ref<void(int)> job);
+
+private:
+	static int SDLCALL WorkerMain(void *data);
+
+	/** @brief Runs jobs of the current batch until none are left to start. */
+	void RunJobs(std::unique_lock<SdlMutex> &lock);
+
+	SdlMutex mutex_;
+	SdlCond workAvailable_;
+	SdlCond workDone_;
+	std::vector<SdlThread> workers_;
+
+	const tl::function_ref<void(int)> *job_ = nullptr;
+	int count_ = 0;
+	int next_ = 0;
+	int remaining_ = 0;
+	unsigned generation_ = 0;
+	bool stopping_ = false;
+};
+
+} // namespace devilution
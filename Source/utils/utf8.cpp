@@ -25,7 +25,7 @@ string_view TruncateUtf8(string_view str, std::size_t len)
 
 } // namespace
 
-char32_t DecodeFirstUtf8CodePoint(string_view input, std::size_t *len)
+char32_t DecodeFirstMultiByteUtf8CodePoint(string_view input, std::size_t *len)
 {
 	uint32_t codepoint = 0;
 	uint8_t state = UTF8_ACCEPT;
@@ -44,6 +44,21 @@ char32_t DecodeFirstUtf8CodePoint(string_view input, std::size_t *len)
 	return Utf8DecodeError;
 }
 
+std::size_t CountAsciiPrefix(string_view input)
+{
+	constexpr uint64_t HighBits = 0x8080808080808080;
+	std::size_t i = 0;
+	for (; i + sizeof(uint64_t) <= input.size(); i += sizeof(uint64_t)) {
+		uint64_t word;
+		std::memcpy(&word, &input[i], sizeof(word));
+		if ((word & HighBits) != 0)
+			break;
+	}
+	while (i < input.size() && static_cast<unsigned char>(input[i]) < 0x80)
+		i++;
+	return i;
+}
+
 void CopyUtf8(char *dest, string_view source, std::size_t bytes)
 {
 	source = TruncateUtf8(source, bytes - 1);
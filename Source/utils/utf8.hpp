@@ -10,13 +10,31 @@ namespace devilution {
 
 constexpr char32_t Utf8DecodeError = 0xD83F;
 
+/**
+ * @brief Same as `DecodeFirstUtf8CodePoint` but without the fast path for a leading ASCII character.
+ */
+char32_t DecodeFirstMultiByteUtf8CodePoint(string_view input, std::size_t *len);
+
 /**
  * Decodes the first code point from UTF8-encoded input.
  *
  * Sets `len` to the length of the code point in bytes.
  * Returns `Utf8DecodeError` on error.
  */
-char32_t DecodeFirstUtf8CodePoint(string_view input, std::size_t *len);
+inline char32_t DecodeFirstUtf8CodePoint(string_view input, std::size_t *len)
+{
+	// Most of the game's text is ASCII, which doesn't need the decoder.
+	if (!input.empty() && static_cast<unsigned char>(input[0]) < 0x80) {
+		*len = 1;
+		return static_cast<unsigned char>(input[0]);
+	}
+	return DecodeFirstMultiByteUtf8CodePoint(input, len);
+}
+
+/**
+ * @brief Returns the length of the ASCII prefix of the input, checking a machine word at a time.
+ */
+std::size_t CountAsciiPrefix(string_view input);
 
 /**
  * Decodes and removes the first code point from UTF8-encoded input.
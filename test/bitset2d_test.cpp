@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "utils/bitset2d.hpp"
+
+namespace devilution {
+namespace {
+
+// Wider than a word, so that the shifts and rectangles cross from one word to the next.
+constexpr size_t Width = 100;
+constexpr size_t Height = 20;
+using TestBitset = Bitset2d<Width, Height>;
+
+TestBitset RandomBitset(unsigned seed)
+{
+	std::mt19937 engine(seed);
+	TestBitset bits;
+	for (size_t y = 0; y < Height; y++) {
+		for (size_t x = 0; x < Width; x++)
+			bits.set(x, y, engine() % 4 == 0);
+	}
+	return bits;
+}
+
+TEST(Bitset2dTest, SetAndCount)
+{
+	TestBitset bits;
+	EXPECT_FALSE(bits.any());
+	bits.set(0, 0);
+	bits.set(63, 1);
+	bits.set(64, 1);
+	bits.set(99, 19);
+	EXPECT_TRUE(bits.test(63, 1));
+	EXPECT_TRUE(bits.test(64, 1));
+	EXPECT_FALSE(bits.test(65, 1));
+	EXPECT_EQ(bits.count(), 4U);
+	EXPECT_EQ(bits.rowWord(1, 0), uint64_t { 1 } << 63);
+	EXPECT_EQ(bits.rowWord(1, 1), 1U);
+	bits.set(63, 1, false);
+	bits.reset(99, 19);
+	EXPECT_EQ(bits.count(), 2U);
+	bits.reset();
+	EXPECT_FALSE(bits.any());
+}
+
+TEST(Bitset2dTest, BitwiseOperations)
+{
+	const TestBitset a = RandomBitset(1);
+	const TestBitset b = RandomBitset(2);
+	TestBitset andNot = a;
+	andNot.andNot(b);
+	const TestBitset both = a & b;
+	const TestBitset either = a | b;
+	for (size_t y = 0; y < Height; y++) {
+		for (size_t x = 0; x < Width; x++) {
+			EXPECT_EQ(both.test(x, y), a.test(x, y) && b.test(x, y));
+			EXPECT_EQ(either.test(x, y), a.test(x, y) || b.test(x, y));
+			EXPECT_EQ(andNot.test(x, y), a.test(x, y) && !b.test(x, y));
+		}
+	}
+}
+
+TEST(Bitset2dTest, Shifted)
+{
+	const TestBitset bits = RandomBitset(3);
+	for (const Displacement offset : { Displacement { 0, 0 }, Displacement { 1, 0 }, Displacement { -1, 0 }, Displacement { 0, 1 }, Displacement { 0, -1 },
+	         Displacement { 37, -5 }, Displacement { -64, 2 }, Displacement { 65, 0 }, Displacement { -99, 0 }, Displacement { 100, 0 }, Displacement { 0, -20 } }) {
+		const TestBitset moved = bits.shifted(offset);
+		size_t expectedCount = 0;
+		for (int y = 0; y < static_cast<int>(Height); y++) {
+			for (int x = 0; x < static_cast<int>(Width); x++) {
+				const int sourceX = x - offset.deltaX;
+				const int sourceY = y - offset.deltaY;
+				const bool expected = sourceX >= 0 && sourceX < static_cast<int>(Width) && sourceY >= 0 && sourceY < static_cast<int>(Height)
+				    && bits.test(sourceX, sourceY);
+				ASSERT_EQ(moved.test(x, y), expected) << offset.deltaX << "," << offset.deltaY << " at " << x << "," << y;
+				if (expected)
+					expectedCount++;
+			}
+		}
+		// Bits moved past the right edge must not linger beyond the width.
+		EXPECT_EQ(moved.count(), expectedCount);
+	}
+}
+
+TEST(Bitset2dTest, RectangleQueries)
+{
+	const TestBitset bits = RandomBitset(4);
+	for (const Rectangle rect : { Rectangle { { 0, 0 }, { 100, 20 } }, Rectangle { { 60, 3 }, { 10, 4 } }, Rectangle { { 64, 0 }, { 1, 20 } },
+	         Rectangle { { -5, -5 }, { 8, 8 } }, Rectangle { { 90, 15 }, { 50, 50 } }, Rectangle { { 10, 10 }, { 0, 5 } }, Rectangle { { 120, 0 }, { 5, 5 } } }) {
+		size_t expectedCount = 0;
+		std::optional<Point> expectedFirst;
+		for (int y = 0; y < static_cast<int>(Height); y++) {
+			for (int x = 0; x < static_cast<int>(Width); x++) {
+				if (!rect.contains({ x, y }) || !bits.test(x, y))
+					continue;
+				expectedCount++;
+				if (!expectedFirst)
+					expectedFirst = Point { x, y };
+			}
+		}
+		EXPECT_EQ(bits.countInRect(rect), expectedCount);
+		EXPECT_EQ(bits.anyInRect(rect), expectedCount != 0);
+		EXPECT_EQ(bits.findFirstInRect(rect), expectedFirst);
+	}
+}
+
+TEST(Bitset2dTest, FindFirstInEmptyRect)
+{
+	TestBitset bits;
+	bits.set(70, 5);
+	EXPECT_EQ(bits.findFirstInRect({ { 0, 0 }, { 70, 20 } }), std::nullopt);
+	EXPECT_EQ(bits.findFirstInRect({ { 0, 0 }, { 71, 20 } }), (Point { 70, 5 }));
+	EXPECT_FALSE(bits.anyInRect({ { 71, 0 }, { 29, 20 } }));
+}
+
+} // namespace
+} // namespace devilution
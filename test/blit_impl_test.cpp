@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+
+#include "engine/render/blit_impl.hpp"
+
+using namespace devilution;
+
+namespace {
+
+constexpr unsigned BufferSize = 64;
+
+struct BlitBuffers {
+	std::array<uint8_t, 256> colorMap;
+	std::array<uint8_t, BufferSize> src;
+	std::array<uint8_t, BufferSize> dst;
+};
+
+BlitBuffers MakeBuffers(std::mt19937 &engine)
+{
+	BlitBuffers buffers;
+	for (uint8_t &color : buffers.colorMap)
+		color = static_cast<uint8_t>(engine());
+	for (uint8_t &pixel : buffers.src)
+		pixel = static_cast<uint8_t>(engine());
+	for (uint8_t &pixel : buffers.dst)
+		pixel = static_cast<uint8_t>(engine());
+	return buffers;
+}
+
+void FillSymmetricTransparencyLookup(std::mt19937 &engine)
+{
+	for (int i = 0; i < 256; i++) {
+		for (int j = i; j < 256; j++) {
+			paletteTransparencyLookup[i][j] = static_cast<uint8_t>(engine());
+			paletteTransparencyLookup[j][i] = paletteTransparencyLookup[i][j];
+		}
+	}
+}
+
+} // namespace
+
+TEST(BlitImpl, BlitPixelsWithMap)
+{
+	std::mt19937 engine(1);
+	// Every length up to the buffer size, so that both the groups and the remainder are covered.
+	for (unsigned length = 0; length <= BufferSize; length++) {
+		BlitBuffers buffers = MakeBuffers(engine);
+		std::array<uint8_t, BufferSize> expected = buffers.dst;
+		for (unsigned i = 0; i < length; i++)
+			expected[i] = buffers.colorMap[buffers.src[i]];
+
+		BlitPixelsWithMap(buffers.dst.data(), buffers.src.data(), length, buffers.colorMap.data());
+		EXPECT_EQ(buffers.dst, expected) << "length " << length;
+	}
+}
+
+TEST(BlitImpl, BlitPixelsBlendedWithMap)
+{
+	std::mt19937 engine(2);
+	FillSymmetricTransparencyLookup(engine);
+	for (unsigned length = 0; length <= BufferSize; length++) {
+		BlitBuffers buffers = MakeBuffers(engine);
+		std::array<uint8_t, BufferSize> expected = buffers.dst;
+		for (unsigned i = 0; i < length; i++)
+			expected[i] = paletteTransparencyLookup[expected[i]][buffers.colorMap[buffers.src[i]]];
+
+		BlitPixelsBlendedWithMap(buffers.dst.data(), buffers.src.data(), length, buffers.colorMap.data());
+		EXPECT_EQ(buffers.dst, expected) << "length " << length;
+	}
+}
+
+TEST(BlitImpl, BlitFillBlendedWithMap)
+{
+	std::mt19937 engine(3);
+	FillSymmetricTransparencyLookup(engine);
+	for (unsigned length = 0; length <= BufferSize; length++) {
+		BlitBuffers buffers = MakeBuffers(engine);
+		const auto color = static_cast<uint8_t>(engine());
+		std::array<uint8_t, BufferSize> expected = buffers.dst;
+		for (unsigned i = 0; i < length; i++)
+			expected[i] = paletteTransparencyLookup[expected[i]][buffers.colorMap[color]];
+
+		BlitFillBlendedWithMap(buffers.dst.data(), length, color, buffers.colorMap.data());
+		EXPECT_EQ(buffers.dst, expected) << "length " << length;
+	}
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "engine/render/cl2_render.hpp"
+#include "engine/surface.hpp"
+
+namespace devilution {
+namespace {
+
+constexpr int SpriteWidth = 4;
+constexpr int FrameHeaderSize = 10;
+
+/**
+ * @brief Writes a CL2 sprite with a single frame to the start of the buffer, the buffer keeps its address.
+ * @param rows Pixels of the frame, from the bottom row up
+ */
+void WriteSprite(std::vector<byte> &buffer, const std::vector<std::array<uint8_t, SpriteWidth>> &rows)
+{
+	std::vector<uint8_t> sprite {};
+	const auto writeLE32 = [&](uint32_t value) {
+		for (int i = 0; i < 4; i++)
+			sprite.push_back(static_cast<uint8_t>(value >> (8 * i)));
+	};
+	const auto frameSize = static_cast<uint32_t>(FrameHeaderSize + rows.size() * (1 + SpriteWidth));
+	writeLE32(1);
+	writeLE32(12);
+	writeLE32(12 + frameSize);
+	sprite.push_back(FrameHeaderSize);
+	sprite.insert(sprite.end(), FrameHeaderSize - 1, 0);
+	for (const auto &row : rows) {
+		// A run of opaque pixels.
+		sprite.push_back(static_cast<uint8_t>(0x100 - SpriteWidth));
+		sprite.insert(sprite.end(), row.begin(), row.end());
+	}
+	ASSERT_LE(sprite.size(), buffer.size());
+	for (size_t i = 0; i < sprite.size(); i++)
+		buffer[i] = static_cast<byte>(sprite[i]);
+}
+
+std::vector<uint8_t> Pixels(const OwnedSurface &surface)
+{
+	std::vector<uint8_t> pixels;
+	for (int y = 0; y < surface.h(); y++) {
+		for (int x = 0; x < surface.w(); x++)
+			pixels.push_back(surface[Point { x, y }]);
+	}
+	return pixels;
+}
+
+/** @brief Draws the sprite through the cache and directly, both have to look the same. */
+void ExpectSameAsUncached(const std::vector<byte> &buffer, std::array<uint8_t, 256> &trn)
+{
+	OwnedSurface cached { 8, 8 };
+	OwnedSurface uncached { 8, 8 };
+	const CelSprite sprite { buffer.data(), SpriteWidth };
+	Cl2DrawTRNCached(cached, { 1, 6 }, sprite, 0, trn.data());
+	Cl2DrawTRN(uncached, { 1, 6 }, sprite, 0, trn.data());
+	EXPECT_EQ(Pixels(cached), Pixels(uncached));
+}
+
+std::array<uint8_t, 256> MakeTrn()
+{
+	std::array<uint8_t, 256> trn;
+	for (int i = 0; i < 256; i++)
+		trn[i] = static_cast<uint8_t>(255 - i);
+	return trn;
+}
+
+TEST(Cl2DrawTRNCachedTest, SpriteReloadedAtSameAddress)
+{
+	std::array<uint8_t, 256> trn = MakeTrn();
+	std::vector<byte> buffer(256);
+
+	WriteSprite(buffer, { { 1, 2, 3, 4 }, { 5, 6, 7, 8 } });
+	ExpectSameAsUncached(buffer, trn);
+	ExpectSameAsUncached(buffer, trn);
+
+	// The sprite was freed and another one of the same size was loaded in its place.
+	WriteSprite(buffer, { { 9, 10, 11, 12 }, { 13, 14, 15, 16 } });
+	ExpectSameAsUncached(buffer, trn);
+}
+
+TEST(Cl2DrawTRNCachedTest, LargerSpriteReloadedAtSameAddress)
+{
+	std::array<uint8_t, 256> trn = MakeTrn();
+	std::vector<byte> buffer(256);
+
+	WriteSprite(buffer, { { 21, 22, 23, 24 } });
+	ExpectSameAsUncached(buffer, trn);
+
+	// The cached frame is shorter than the new one, it must not be blitted with the new frame's size.
+	WriteSprite(buffer, { { 31, 32, 33, 34 }, { 35, 36, 37, 38 }, { 39, 40, 41, 42 } });
+	ExpectSameAsUncached(buffer, trn);
+}
+
+TEST(Cl2DrawTRNCachedTest, ForgetCachedFrames)
+{
+	std::array<uint8_t, 256> trn = MakeTrn();
+	std::vector<byte> buffer(256);
+
+	WriteSprite(buffer, { { 51, 52, 53, 54 }, { 55, 56, 57, 58 } });
+	ExpectSameAsUncached(buffer, trn);
+	Cl2ForgetCachedFrames(buffer.data(), buffer.size());
+
+	WriteSprite(buffer, { { 61, 62, 63, 64 } });
+	ExpectSameAsUncached(buffer, trn);
+}
+
+} // namespace
+} // namespace devilution
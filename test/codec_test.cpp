@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+
 #include "codec.h"
 
 using namespace devilution;
@@ -13,3 +16,21 @@ TEST(Codec, codec_get_encoded_len_eq)
 {
 	EXPECT_EQ(codec_get_encoded_len(128), 136);
 }
+
+TEST(Codec, codec_encode_decode)
+{
+	std::array<byte, 136> buffer {};
+	for (size_t i = 0; i < 100; i++)
+		buffer[i] = static_cast<byte>(i * 7);
+
+	codec_encode(buffer.data(), 100, buffer.size(), "xrgyrkj1");
+	EXPECT_EQ(buffer[0], static_cast<byte>(98));
+	EXPECT_EQ(buffer[99], static_cast<byte>(192));
+	// Checksum and size of the last chunk
+	const std::array<byte, 8> signature { byte { 198 }, byte { 185 }, byte { 212 }, byte { 173 }, byte { 0 }, byte { 36 }, byte { 0 }, byte { 0 } };
+	EXPECT_TRUE(std::equal(signature.begin(), signature.end(), buffer.end() - signature.size()));
+
+	ASSERT_EQ(codec_decode(buffer.data(), buffer.size(), "xrgyrkj1"), 100);
+	for (size_t i = 0; i < 100; i++)
+		EXPECT_EQ(buffer[i], static_cast<byte>(i * 7));
+}
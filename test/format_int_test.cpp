@@ -36,5 +36,27 @@ TEST(FormatIntegerTest, SevenDigits)
 	EXPECT_EQ(FormatInteger(-1234567), "-1,234,567");
 }
 
+TEST(FormatIntegerTest, Limits)
+{
+	EXPECT_EQ(FormatInteger(2147483647), "2,147,483,647");
+	EXPECT_EQ(FormatInteger(-2147483647 - 1), "-2,147,483,648");
+}
+
+TEST(FormatIntegerToTest, WritesToBuffer)
+{
+	char buf[FormatIntegerBufferSize];
+	EXPECT_EQ(FormatIntegerTo(buf, 12), "12");
+	EXPECT_EQ(FormatIntegerTo(buf, -1234567), "-1,234,567");
+	EXPECT_STREQ(buf, "-1,234,567");
+}
+
+TEST(FormatIntegerToTest, CutsOff)
+{
+	char buf[6];
+	EXPECT_EQ(FormatIntegerTo(buf, 1234567), "1,234");
+	EXPECT_STREQ(buf, "1,234");
+	EXPECT_EQ(FormatIntegerTo(buf, -123456), "-123,");
+}
+
 } // namespace
 } // namespace devilution
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "utils/frame_arena.hpp"
+
+namespace devilution {
+namespace {
+
+TEST(FrameArenaTest, AlignsAllocations)
+{
+	FrameArena arena(256);
+	arena.Allocate(1, 1);
+	void *ptr = arena.Allocate(8, 8);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 8, 0U);
+	EXPECT_EQ(arena.BytesUsed(), 16U);
+}
+
+TEST(FrameArenaTest, GrowsAndCoalescesOnReset)
+{
+	FrameArena arena(64);
+	for (int i = 0; i < 10; i++)
+		arena.Allocate(48, 1);
+	EXPECT_EQ(arena.BytesUsed(), 480U);
+	EXPECT_GE(arena.Capacity(), 480U);
+
+	const size_t capacity = arena.Capacity();
+	arena.Reset();
+	EXPECT_EQ(arena.BytesUsed(), 0U);
+	EXPECT_EQ(arena.Capacity(), capacity);
+
+	// Everything the last frame needed now fits in a single chunk.
+	byte *first = static_cast<byte *>(arena.Allocate(48, 1));
+	for (int i = 1; i < 10; i++)
+		EXPECT_EQ(arena.Allocate(48, 1), first + i * 48);
+}
+
+TEST(FrameArenaTest, DeallocatesLatestAllocation)
+{
+	FrameArena arena(256);
+	void *first = arena.Allocate(32, 1);
+	void *second = arena.Allocate(32, 1);
+	arena.Deallocate(first, 32);
+	EXPECT_EQ(arena.BytesUsed(), 64U);
+	arena.Deallocate(second, 32);
+	EXPECT_EQ(arena.BytesUsed(), 32U);
+	EXPECT_EQ(arena.Allocate(16, 1), second);
+}
+
+TEST(FrameArenaTest, Containers)
+{
+	GetFrameArena().Reset();
+	{
+		FrameVector<int> values;
+		for (int i = 0; i < 1000; i++)
+			values.push_back(i);
+		EXPECT_EQ(values[999], 999);
+
+		FrameString text;
+		for (int i = 0; i < 100; i++)
+			text += "abc";
+		EXPECT_EQ(text.size(), 300U);
+		EXPECT_EQ(text.substr(297), "abc");
+	}
+	GetFrameArena().Reset();
+	EXPECT_EQ(GetFrameArena().BytesUsed(), 0U);
+}
+
+} // namespace
+} // namespace devilution
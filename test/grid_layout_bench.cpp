@@ -0,0 +1,189 @@
+/**
+ * @file grid_layout_bench.cpp
+ *
+ * Google Benchmark suite comparing the layout of the per-tile dungeon grids, one array per field as the game stores
+ * them against one packed record per tile. The queries are modeled on the hot loops that read the grids: the walkability
+ * checks of the 8 neighbours that the monster AI and path finding do, the per-tile reads of the renderer and the
+ * whole-grid sweeps of the lighting.
+ *
+ * Usage: devilutionx_grid_layout_bench [benchmark options]
+ */
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "items.h"
+#include "levels/gendung.h"
+
+using namespace devilution;
+
+namespace {
+
+/** @brief Everything the game keeps per tile of the current level, packed into 16 bytes. */
+struct TileRecord {
+	uint16_t piece;
+	int16_t monster;
+	int8_t transVal;
+	char light;
+	char preLight;
+	DungeonFlag flags;
+	int8_t player;
+	int8_t corpse;
+	int8_t object;
+	int8_t item;
+	char special;
+	uint8_t padding[3];
+};
+
+static_assert(sizeof(TileRecord) == 16, "A tile record should fill a quarter of a cache line");
+
+std::unique_ptr<TileRecord[][MAXDUNY]> Records;
+
+const Displacement Neighbours[] = { { -1, -1 }, { 0, -1 }, { 1, -1 }, { -1, 0 }, { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+
+/** @brief Fills both layouts with the same mostly empty level, every few tiles holds a wall, monster or object. */
+void FillGrids()
+{
+	std::mt19937 engine(0);
+	for (int i = 0; i < MAXTILES; i++)
+		SOLData[i] = (i % 4 == 0) ? TileProperties::Solid : TileProperties::None;
+	Records = std::make_unique<TileRecord[][MAXDUNY]>(MAXDUNX);
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			const uint32_t r = engine();
+			dPiece[x][y] = static_cast<uint16_t>(r % MAXTILES);
+			dMonster[x][y] = (r >> 12) % 16 == 0 ? static_cast<int16_t>(1 + (r >> 16) % 200) : 0;
+			dPlayer[x][y] = (r >> 20) % 64 == 0 ? 1 : 0;
+			dObject[x][y] = (r >> 24) % 16 == 0 ? 1 : 0;
+			dItem[x][y] = (r >> 28) % 8 == 0 ? 1 : 0;
+			dCorpse[x][y] = 0;
+			dSpecial[x][y] = 0;
+			dFlags[x][y] = (r & 1) != 0 ? DungeonFlag::Visible : DungeonFlag::None;
+			dPreLight[x][y] = static_cast<char>(r % 16);
+			dLight[x][y] = 15;
+			dTransVal[x][y] = 0;
+
+			TileRecord &record = Records[x][y];
+			record = {};
+			record.piece = dPiece[x][y];
+			record.monster = dMonster[x][y];
+			record.player = dPlayer[x][y];
+			record.object = dObject[x][y];
+			record.item = dItem[x][y];
+			record.flags = dFlags[x][y];
+			record.preLight = dPreLight[x][y];
+			record.light = dLight[x][y];
+		}
+	}
+}
+
+bool IsAvailableSoA(Point position)
+{
+	return dPlayer[position.x][position.y] == 0 && dMonster[position.x][position.y] == 0 && dObject[position.x][position.y] == 0
+	    && !TileHasAny(dPiece[position.x][position.y], TileProperties::Solid);
+}
+
+bool IsAvailableAoS(Point position)
+{
+	const TileRecord &record = Records[position.x][position.y];
+	return record.player == 0 && record.monster == 0 && record.object == 0 && !TileHasAny(record.piece, TileProperties::Solid);
+}
+
+/** @brief Counts the free neighbours of tiles scattered over the level, like many monsters looking for a step. */
+template <bool (*IsAvailable)(Point)>
+void BM_Neighbourhood(benchmark::State &state)
+{
+	FillGrids();
+	std::mt19937 engine(1);
+	Point positions[1024];
+	for (Point &position : positions)
+		position = { 17 + static_cast<int>(engine() % (MAXDUNX - 34)), 17 + static_cast<int>(engine() % (MAXDUNY - 34)) };
+	size_t i = 0;
+	for (auto _ : state) {
+		const Point position = positions[i++ % 1024];
+		int free = 0;
+		for (Displacement neighbour : Neighbours) {
+			if (IsAvailable(position + neighbour))
+				free++;
+		}
+		benchmark::DoNotOptimize(free);
+	}
+}
+
+/** @brief Reads what the renderer reads for every tile of a 640x480 view, about 20 by 30 tiles. */
+void BM_DrawReadsSoA(benchmark::State &state)
+{
+	FillGrids();
+	for (auto _ : state) {
+		int sum = 0;
+		for (int y = 40; y < 70; y++) {
+			for (int x = 40; x < 60; x++) {
+				if (dFlags[x][y] == DungeonFlag::None)
+					continue;
+				sum += dPiece[x][y] + dLight[x][y] + dItem[x][y] + dMonster[x][y] + dCorpse[x][y] + dObject[x][y] + dSpecial[x][y] + dPlayer[x][y];
+			}
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+}
+
+void BM_DrawReadsAoS(benchmark::State &state)
+{
+	FillGrids();
+	for (auto _ : state) {
+		int sum = 0;
+		for (int y = 40; y < 70; y++) {
+			for (int x = 40; x < 60; x++) {
+				const TileRecord &record = Records[x][y];
+				if (record.flags == DungeonFlag::None)
+					continue;
+				sum += record.piece + record.light + record.item + record.monster + record.corpse + record.object + record.special + record.player;
+			}
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+}
+
+/** @brief Resets the lights of the whole level to the static ones, as every lighting update starts with. */
+void BM_LightResetSoA(benchmark::State &state)
+{
+	FillGrids();
+	for (auto _ : state) {
+		std::memcpy(dLight, dPreLight, sizeof(dLight));
+		benchmark::ClobberMemory();
+	}
+}
+
+void BM_LightResetAoS(benchmark::State &state)
+{
+	FillGrids();
+	for (auto _ : state) {
+		for (int x = 0; x < MAXDUNX; x++) {
+			for (int y = 0; y < MAXDUNY; y++)
+				Records[x][y].light = Records[x][y].preLight;
+		}
+		benchmark::ClobberMemory();
+	}
+}
+
+BENCHMARK_TEMPLATE(BM_Neighbourhood, IsAvailableSoA);
+BENCHMARK_TEMPLATE(BM_Neighbourhood, IsAvailableAoS);
+BENCHMARK(BM_DrawReadsSoA);
+BENCHMARK(BM_DrawReadsAoS);
+BENCHMARK(BM_LightResetSoA);
+BENCHMARK(BM_LightResetAoS);
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "utils/job_system.hpp"
+
+namespace devilution {
+namespace {
+
+TEST(JobSystemTest, WaitsForSubmittedJobs)
+{
+	JobSystem jobs(3);
+	JobCounter counter;
+	std::vector<std::atomic<int>> calls(100);
+	for (int i = 0; i < 100; i++)
+		jobs.Submit(counter, [&calls, i]() { calls[i]++; });
+	jobs.Wait(counter);
+	EXPECT_TRUE(counter.IsDone());
+	for (int i = 0; i < 100; i++)
+		EXPECT_EQ(calls[i], 1) << "job " << i;
+}
+
+TEST(JobSystemTest, NestedParallelFor)
+{
+	JobSystem jobs(3);
+	std::vector<std::atomic<int>> calls(8 * 8);
+	jobs.ParallelFor(8, [&](int i) {
+		jobs.ParallelFor(8, [&](int j) { calls[i * 8 + j]++; });
+	});
+	for (std::atomic<int> &call : calls)
+		EXPECT_EQ(call, 1);
+}
+
+TEST(JobSystemTest, JoinsInOrder)
+{
+	JobSystem jobs(3);
+	std::vector<int> results(50);
+	std::vector<int> joined;
+	jobs.ParallelForInOrder(
+	    50, [&](int i) { results[i] = i * i; },
+	    [&](int i) {
+		    EXPECT_EQ(results[i], i * i);
+		    joined.push_back(i);
+	    });
+	ASSERT_EQ(joined.size(), 50U);
+	for (int i = 0; i < 50; i++)
+		EXPECT_EQ(joined[i], i);
+}
+
+TEST(JobSystemTest, MainThreadJobsRunWhileWaiting)
+{
+	JobSystem jobs(2);
+	JobCounter counter;
+	std::atomic<bool> ranOnMainThread { false };
+	const SDL_threadID mainThread = this_sdl_thread::get_id();
+	jobs.Submit(counter, [&]() {
+		JobCounter mainThreadCounter;
+		jobs.SubmitToMainThread(mainThreadCounter, [&]() { ranOnMainThread = this_sdl_thread::get_id() == mainThread; });
+		jobs.Wait(mainThreadCounter);
+	});
+	jobs.Wait(counter);
+	EXPECT_TRUE(ranOnMainThread);
+}
+
+TEST(JobSystemTest, WithoutWorkers)
+{
+	JobSystem jobs(0);
+	JobCounter counter;
+	int sum = 0;
+	for (int i = 0; i < 4; i++)
+		jobs.Submit(counter, [&sum, i]() { sum += i; });
+	EXPECT_EQ(sum, 6);
+	jobs.ParallelFor(4, [&](int i) { sum += i; });
+	EXPECT_EQ(sum, 12);
+
+	bool ran = false;
+	jobs.SubmitToMainThread(counter, [&]() { ran = true; });
+	EXPECT_FALSE(ran);
+	jobs.RunMainThreadJobs();
+	EXPECT_TRUE(ran);
+	EXPECT_TRUE(counter.IsDone());
+}
+
+} // namespace
+} // namespace devilution
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include "control.h"
+#include "levels/gendung.h"
 #include "lighting.h"
 
 using namespace devilution;
@@ -31,3 +32,81 @@ TEST(Lighting, CrawlTables)
 		}
 	}
 }
+
+TEST(Lighting, CrawlIndexMatchesCrawlOrder)
+{
+	int index = 0;
+	for (int radius = 0; radius <= MaxCrawlIndexRadius; radius++) {
+		EXPECT_EQ(GetCrawlRingStart(radius), index) << "radius " << radius;
+		Crawl(radius, [&](Displacement displacement) {
+			EXPECT_EQ(GetCrawlIndex(displacement), index) << "displacement " << displacement.deltaX << ":" << displacement.deltaY;
+			index++;
+			return false;
+		});
+	}
+	EXPECT_EQ(GetCrawlRingStart(MaxCrawlIndexRadius + 1), index);
+
+	EXPECT_EQ(GetCrawlIndex({ MaxCrawlIndexRadius, MaxCrawlIndexRadius }), -1);
+	EXPECT_EQ(GetCrawlIndex({ MaxCrawlIndexRadius + 1, 0 }), -1);
+}
+
+TEST(Lighting, MovedLightsOnlyRelightTheirArea)
+{
+	memset(dPreLight, LightsMax, sizeof(dPreLight));
+	memcpy(dLight, dPreLight, sizeof(dLight));
+	InitLighting();
+
+	AddLight({ 20, 20 }, 10);
+	const int moving = AddLight({ 60, 60 }, 10);
+	ProcessLightList();
+	EXPECT_EQ(dLight[20][20], 0);
+	EXPECT_EQ(dLight[60][60], 0);
+
+	// Moves into the area of the other light
+	ChangeLightXY(moving, { 40, 40 });
+	ChangeLightOffset(moving, { 4, 4 });
+	ProcessLightList();
+	EXPECT_EQ(dLight[60][60], LightsMax);
+	EXPECT_EQ(dLight[40][40], 0);
+	EXPECT_EQ(dLight[30][30], 0);
+	EXPECT_EQ(dLight[20][20], 0);
+
+	AddUnLight(moving);
+	ProcessLightList();
+	EXPECT_EQ(dLight[50][50], LightsMax);
+	EXPECT_EQ(dLight[40][40], LightsMax);
+	EXPECT_EQ(dLight[30][30], 0);
+	EXPECT_EQ(dLight[20][20], 0);
+}
+
+namespace devilution {
+extern void TestLightingMakeRadiusTables();
+extern void TestLightingApplyLightPerTile(Point position, int nRadius, int lnum);
+} // namespace devilution
+
+TEST(Lighting, StampsMatchPerTileLoop)
+{
+	TestLightingMakeRadiusTables();
+	InitLighting();
+
+	static char expected[MAXDUNX][MAXDUNY];
+	for (Point position : { Point { 30, 40 }, Point { 56, 56 }, Point { 81, 70 } }) {
+		const int lid = AddLight(position, 1);
+		for (int radius = 1; radius < 16; radius++) {
+			for (int offsetY = -7; offsetY <= 7; offsetY += 2) {
+				for (int offsetX = -7; offsetX <= 7; offsetX++) {
+					ChangeLightOffset(lid, { offsetX, offsetY });
+
+					memset(dLight, LightsMax, sizeof(dLight));
+					TestLightingApplyLightPerTile(position, radius, lid);
+					memcpy(expected, dLight, sizeof(expected));
+
+					memset(dLight, LightsMax, sizeof(dLight));
+					DoLighting(position, radius, lid);
+					ASSERT_EQ(memcmp(expected, dLight, sizeof(dLight)), 0) << "light at " << position.x << ":" << position.y << " radius " << radius << " offset " << offsetX << ":" << offsetY;
+				}
+			}
+		}
+		AddUnLight(lid);
+	}
+}
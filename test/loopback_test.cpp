@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "dvlnet/loopback.h"
+#include "storm/storm_net.hpp"
+
+namespace devilution {
+namespace {
+
+TEST(LoopbackTest, ReceivesMessagesInOrder)
+{
+	net::loopback provider;
+	for (uint8_t i = 0; i < 100; i++) {
+		std::vector<uint8_t> message(i + 1U, i);
+		ASSERT_TRUE(provider.SNetSendMessage(SNPLAYER_ALL, message.data(), static_cast<unsigned>(message.size())));
+	}
+
+	for (uint8_t i = 0; i < 100; i++) {
+		int sender;
+		void *data;
+		uint32_t size;
+		ASSERT_TRUE(provider.SNetReceiveMessage(&sender, &data, &size));
+		EXPECT_EQ(sender, 0);
+		ASSERT_EQ(size, i + 1U);
+		EXPECT_EQ(static_cast<uint8_t *>(data)[i], i);
+	}
+	int sender;
+	void *data;
+	uint32_t size;
+	EXPECT_FALSE(provider.SNetReceiveMessage(&sender, &data, &size));
+}
+
+TEST(LoopbackTest, ReceivedMessageOutlivesSends)
+{
+	net::loopback provider;
+	uint8_t first[] = { 1, 2, 3 };
+	provider.SNetSendMessage(0, first, sizeof(first));
+
+	int sender;
+	void *data;
+	uint32_t size;
+	ASSERT_TRUE(provider.SNetReceiveMessage(&sender, &data, &size));
+	// Messages sent while handling one are queued behind it, even if the ring has to grow.
+	for (uint8_t i = 0; i < 64; i++)
+		provider.SNetSendMessage(0, &i, 1);
+	ASSERT_EQ(size, sizeof(first));
+	EXPECT_EQ(static_cast<uint8_t *>(data)[0], 1);
+	EXPECT_EQ(static_cast<uint8_t *>(data)[2], 3);
+
+	for (uint8_t i = 0; i < 64; i++) {
+		ASSERT_TRUE(provider.SNetReceiveMessage(&sender, &data, &size));
+		ASSERT_EQ(size, 1U);
+		EXPECT_EQ(*static_cast<uint8_t *>(data), i);
+	}
+	EXPECT_FALSE(provider.SNetReceiveMessage(&sender, &data, &size));
+}
+
+TEST(LoopbackTest, IgnoresMessagesToOtherPlayers)
+{
+	net::loopback provider;
+	uint8_t message = 5;
+	provider.SNetSendMessage(1, &message, 1);
+
+	int sender;
+	void *data;
+	uint32_t size;
+	EXPECT_FALSE(provider.SNetReceiveMessage(&sender, &data, &size));
+}
+
+} // namespace
+} // namespace devilution
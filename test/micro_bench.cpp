@@ -0,0 +1,394 @@
+/**
+ * @file micro_bench.cpp
+ *
+ * Google Benchmark suite for the kernels that dominate a frame or a level load, each measured on its own.
+ * The tiles and sprites are synthesized, the text and lighting benchmarks skip themselves without spawn.mpq or
+ * diabdat.mpq. Saving a game, including the codec, is covered by devilutionx_save_bench.
+ *
+ * Usage: devilutionx_microbench [benchmark options]
+ */
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "diablo.h"
+#include "encrypt.h"
+#include "engine/cel_sprite.hpp"
+#include "engine/palette.h"
+#include "engine/path.h"
+#include "engine/render/cl2_render.hpp"
+#include "engine/render/dun_render.hpp"
+#include "engine/render/text_render.hpp"
+#include "engine/surface.hpp"
+#include "init.h"
+#include "items.h"
+#include "levels/gendung.h"
+#include "lighting.h"
+#include "player.h"
+#include "quests.h"
+#include "utils/cel_to_cl2.hpp"
+#include "utils/endian.hpp"
+#include "utils/language.h"
+#include "utils/paths.h"
+
+using namespace devilution;
+
+namespace {
+
+constexpr int TileWidth = 32;
+constexpr int TileHeight = 32;
+/** @brief Square, TransparentSquare, LeftTriangle, RightTriangle, LeftTrapezoid and RightTrapezoid. */
+constexpr int NumTileTypes = 6;
+constexpr int TransparentSquareType = 1;
+
+constexpr uint16_t SpriteWidth = 64;
+constexpr int SpriteHeight = 96;
+
+bool HasGameData;
+
+/**
+ * @brief Replaces the level CEL with one frame per tile type, frame n + 1 holds the tile of type n.
+ *
+ * The transparent square has a run of pixels between two transparent runs on every line, the other types don't
+ * read past the pixels of a full square.
+ */
+void MakeDungeonCels()
+{
+	std::vector<uint8_t> frames[NumTileTypes];
+	for (int type = 0; type < NumTileTypes; type++) {
+		std::vector<uint8_t> &frame = frames[type];
+		if (type == TransparentSquareType) {
+			for (int y = 0; y < TileHeight; y++) {
+				frame.push_back(static_cast<uint8_t>(-8));
+				frame.push_back(16);
+				for (int x = 0; x < 16; x++)
+					frame.push_back(static_cast<uint8_t>(x + y));
+				frame.push_back(static_cast<uint8_t>(-8));
+			}
+		} else {
+			for (int i = 0; i < TileWidth * TileHeight; i++)
+				frame.push_back(static_cast<uint8_t>(i));
+		}
+	}
+
+	const size_t headerSize = 4 * (NumTileTypes + 2);
+	size_t size = headerSize;
+	for (const std::vector<uint8_t> &frame : frames)
+		size += frame.size();
+	pDungeonCels = std::unique_ptr<byte[]>(new byte[size]);
+	auto *data = reinterpret_cast<uint8_t *>(pDungeonCels.get());
+	WriteLE32(data, NumTileTypes);
+	size_t offset = headerSize;
+	for (int type = 0; type < NumTileTypes; type++) {
+		WriteLE32(&data[4 * (type + 1)], static_cast<uint32_t>(offset));
+		std::memcpy(&data[offset], frames[type].data(), frames[type].size());
+		offset += frames[type].size();
+	}
+	WriteLE32(&data[4 * (NumTileTypes + 1)], static_cast<uint32_t>(offset));
+}
+
+/** @brief A single frame sprite with transparent edges around a block of pixels, converted to CL2 like the game does. */
+OwnedCelSprite MakeSprite()
+{
+	std::vector<uint8_t> cel(12);
+	WriteLE32(cel.data(), 1);
+	WriteLE32(&cel[4], 12);
+	for (int y = 0; y < SpriteHeight; y++) {
+		cel.push_back(static_cast<uint8_t>(-8));
+		cel.push_back(48);
+		for (int x = 0; x < 48; x++)
+			cel.push_back(static_cast<uint8_t>(x < 8 ? 0x10 : x * 3 + y));
+		cel.push_back(static_cast<uint8_t>(-8));
+	}
+	WriteLE32(&cel[8], static_cast<uint32_t>(cel.size()));
+	return CelToCl2(cel.data(), cel.size(), PointerOrValue<uint16_t> { SpriteWidth });
+}
+
+void BM_RenderTile(benchmark::State &state)
+{
+	const auto type = static_cast<uint32_t>(state.range(0));
+	const auto maskType = static_cast<MaskType>(state.range(1));
+	const auto lightTableIndex = static_cast<int>(state.range(2));
+	MakeDungeonCels();
+	OwnedSurface out { 640, 480 };
+	const uint32_t levelCelBlock = (type + 1) | (type << 12);
+	int i = 0;
+	for (auto _ : state) {
+		// Steps through the columns so the tiles are never clipped and don't all hit the same cache lines.
+		RenderTile(out, { (i % 18) * TileWidth, 240 + (i / 18 % 4) * TileHeight }, levelCelBlock, maskType, lightTableIndex);
+		i++;
+	}
+	benchmark::DoNotOptimize(out.begin());
+	pDungeonCels = nullptr;
+}
+
+void TileArgs(benchmark::internal::Benchmark *benchmark)
+{
+	for (int type = 0; type < NumTileTypes; type++) {
+		for (MaskType maskType : { MaskType::Solid, MaskType::Transparent }) {
+			for (int light : { 0, 7 })
+				benchmark->Args({ type, static_cast<int>(maskType), light });
+		}
+	}
+	benchmark->ArgNames({ "type", "mask", "light" });
+}
+
+void BM_Cl2Draw(benchmark::State &state)
+{
+	const OwnedCelSprite sprite = MakeSprite();
+	OwnedSurface out { 640, 480 };
+	for (auto _ : state)
+		Cl2Draw(out, { 100, 200 }, CelSprite { sprite }, 0);
+	benchmark::DoNotOptimize(out.begin());
+}
+
+void BM_Cl2DrawTRN(benchmark::State &state)
+{
+	const OwnedCelSprite sprite = MakeSprite();
+	OwnedSurface out { 640, 480 };
+	uint8_t trn[256];
+	for (int i = 0; i < 256; i++)
+		trn[i] = static_cast<uint8_t>(255 - i);
+	for (auto _ : state)
+		Cl2DrawTRN(out, { 100, 200 }, CelSprite { sprite }, 0, trn);
+	benchmark::DoNotOptimize(out.begin());
+}
+
+void BM_Cl2DrawOutline(benchmark::State &state)
+{
+	const OwnedCelSprite sprite = MakeSprite();
+	OwnedSurface out { 640, 480 };
+	for (auto _ : state)
+		Cl2DrawOutline(out, PAL16_RED, { 100, 200 }, CelSprite { sprite }, 0);
+	benchmark::DoNotOptimize(out.begin());
+}
+
+/** @brief Blits a panel sized image where every few pixels are transparent, like the panels and flasks. */
+void BM_BlitSkipColorIndexZero(benchmark::State &state)
+{
+	OwnedSurface panel { 640, 128 };
+	for (int y = 0; y < panel.h(); y++) {
+		for (int x = 0; x < panel.w(); x++)
+			panel[{ x, y }] = (x / 4 + y) % 3 == 0 ? 0 : static_cast<uint8_t>(x + y);
+	}
+	OwnedSurface out { 640, 480 };
+	for (auto _ : state)
+		out.BlitFromSkipColorIndexZero(panel, MakeSdlRect(0, 0, panel.w(), panel.h()), { 0, 352 });
+	benchmark::DoNotOptimize(out.begin());
+}
+
+void BM_DrawString(benchmark::State &state)
+{
+	if (!HasGameData) {
+		state.SkipWithError("The fonts need spawn.mpq or diabdat.mpq");
+		return;
+	}
+	OwnedSurface out { 640, 480 };
+	const string_view text = "The quick brown fox jumps over the lazy dog. 0123456789";
+	for (auto _ : state)
+		DrawString(out, text, { { 10, 10 }, { 620, 100 } }, UiFlags::FontSize12 | UiFlags::ColorWhite);
+	if (GetFontCacheStats().fonts == 0)
+		state.SkipWithError("The font couldn't be loaded");
+}
+
+struct DungeonSeed {
+	int level;
+	uint32_t seed;
+};
+
+/** @brief Seeds of the dungeon fixtures, one level of each of the four level types. */
+constexpr DungeonSeed DungeonSeeds[] = {
+	{ 1, 2588 },
+	{ 6, 1824554527 },
+	{ 10, 879635115 },
+	{ 14, 717625719 },
+};
+
+void GenerateDungeon(const DungeonSeed &dungeonSeed)
+{
+	currlevel = dungeonSeed.level;
+	leveltype = GetLevelType(dungeonSeed.level);
+	CreateDungeon(dungeonSeed.seed, ENTRY_MAIN);
+}
+
+void BM_CreateDungeon(benchmark::State &state)
+{
+	const DungeonSeed &dungeonSeed = DungeonSeeds[state.range(0)];
+	pMegaTiles = std::make_unique<MegaTile[]>(256);
+	for (auto _ : state)
+		GenerateDungeon(dungeonSeed);
+}
+
+/** @brief Paths between floor tiles 10 to 20 tiles apart, most of them around walls. */
+void BM_FindPath(benchmark::State &state)
+{
+	pMegaTiles = std::make_unique<MegaTile[]>(256);
+	GenerateDungeon(DungeonSeeds[state.range(0)]);
+	InvalidatePathDistanceFields();
+
+	const auto isFloor = [](Point position) { return InDungeonBounds(position) && dTransVal[position.x][position.y] != 0; };
+	std::vector<Point> floor;
+	for (int y = 0; y < MAXDUNY; y += 3) {
+		for (int x = 0; x < MAXDUNX; x += 3) {
+			if (isFloor({ x, y }))
+				floor.emplace_back(x, y);
+		}
+	}
+	std::vector<std::pair<Point, Point>> pairs;
+	for (size_t i = 0; i < floor.size() && pairs.size() < 64; i++) {
+		for (size_t j = i + 1; j < floor.size(); j++) {
+			const int distance = floor[i].ExactDistance(floor[j]);
+			if (distance >= 10 && distance <= 20) {
+				pairs.emplace_back(floor[i], floor[j]);
+				break;
+			}
+		}
+	}
+	if (pairs.empty()) {
+		state.SkipWithError("No floor tiles far enough apart");
+		return;
+	}
+
+	int8_t path[MaxPathLength];
+	size_t i = 0;
+	for (auto _ : state) {
+		const std::pair<Point, Point> &pair = pairs[i++ % pairs.size()];
+		benchmark::DoNotOptimize(FindPath(isFloor, pair.first, pair.second, path));
+	}
+}
+
+void DungeonArgs(benchmark::internal::Benchmark *benchmark)
+{
+	for (size_t i = 0; i < sizeof(DungeonSeeds) / sizeof(DungeonSeeds[0]); i++)
+		benchmark->Arg(static_cast<int>(i));
+	benchmark->ArgName("level_type");
+}
+
+bool InitLightingBench(benchmark::State &state)
+{
+	if (!HasGameData) {
+		state.SkipWithError("The light tables need spawn.mpq or diabdat.mpq");
+		return false;
+	}
+	leveltype = DTYPE_CATHEDRAL;
+	MakeLightTable();
+	InitLighting();
+	return true;
+}
+
+void BM_DoLighting(benchmark::State &state)
+{
+	if (!InitLightingBench(state))
+		return;
+	const auto radius = static_cast<int>(state.range(0));
+	int i = 0;
+	for (auto _ : state) {
+		DoLighting({ 30 + i % 50, 40 + i % 31 }, radius, -1);
+		i++;
+	}
+}
+
+void BM_DoVision(benchmark::State &state)
+{
+	if (!InitLightingBench(state))
+		return;
+	const auto radius = static_cast<int>(state.range(0));
+	int i = 0;
+	for (auto _ : state) {
+		DoVision({ 30 + i % 50, 40 + i % 31 }, radius, MAP_EXP_NONE, true);
+		i++;
+	}
+}
+
+void BM_PkwareCompress(benchmark::State &state)
+{
+	// Repetitive with some noise, like a save game.
+	std::vector<byte> source(static_cast<size_t>(state.range(0)));
+	uint32_t x = 1;
+	for (size_t i = 0; i < source.size(); i++) {
+		x = x * 1103515245 + 12345;
+		source[i] = static_cast<byte>((i % 64) < 48 ? i % 7 : x >> 24);
+	}
+	// The compression works in place and the result can be larger than the source.
+	std::vector<byte> buffer(source.size() * 2);
+	for (auto _ : state) {
+		std::memcpy(buffer.data(), source.data(), source.size());
+		benchmark::DoNotOptimize(PkwareCompress(buffer.data(), static_cast<uint32_t>(source.size())));
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * @brief Generating a magic item as a monster drop does, with the affixes rolled by SetupAllItems.
+ *
+ * Every iteration uses a new seed, RecreateItem would return a cached copy for a seed it has seen before.
+ */
+void BM_SetupAllItems(benchmark::State &state)
+{
+	const auto level = static_cast<uint16_t>(state.range(0));
+	int idx = -1;
+	for (int i = 0; AllItemsList[i].iName != nullptr; i++) {
+		if (AllItemsList[i].itype == ItemType::Sword && AllItemsList[i].iRnd != IDROP_NEVER) {
+			idx = i;
+			break;
+		}
+	}
+	if (idx == -1) {
+		state.SkipWithError("No sword in the item list");
+		return;
+	}
+	int seed = 1;
+	for (auto _ : state) {
+		Item item {};
+		RecreateItem(item, idx, level | CF_ONLYGOOD, seed++, 0, false);
+		benchmark::DoNotOptimize(item._iMagical);
+	}
+}
+
+BENCHMARK(BM_RenderTile)->Apply(TileArgs);
+BENCHMARK(BM_Cl2Draw);
+BENCHMARK(BM_Cl2DrawTRN);
+BENCHMARK(BM_Cl2DrawOutline);
+BENCHMARK(BM_BlitSkipColorIndexZero);
+BENCHMARK(BM_DrawString)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CreateDungeon)->Apply(DungeonArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FindPath)->Apply(DungeonArgs)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DoLighting)->Arg(2)->Arg(7)->Arg(10)->ArgName("radius");
+BENCHMARK(BM_DoVision)->Arg(2)->Arg(7)->Arg(10)->ArgName("radius");
+BENCHMARK(BM_PkwareCompress)->Arg(4096)->Arg(65536)->ArgName("bytes")->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SetupAllItems)->Arg(5)->Arg(16)->Arg(30)->ArgName("level");
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	// Disable error dialogs, a missing MPQ only skips the benchmarks that need it.
+	HeadlessMode = true;
+	paths::SetPrefPath(paths::BasePath());
+	paths::SetConfigPath(paths::BasePath());
+	LoadCoreArchives();
+	LoadGameArchives();
+	HasGameData = spawn_mpq || diabdat_mpq;
+	gbIsSpawn = !diabdat_mpq;
+	if (HasGameData)
+		LanguageInitialize();
+
+	MyPlayerId = 0;
+	MyPlayer = &Players[MyPlayerId];
+	MyPlayer->pOriginalCathedral = true;
+	// Without quests no set pieces are loaded, so the dungeons generate without the fixtures.
+	for (Quest &quest : Quests)
+		quest._qactive = QUEST_NOTAVAIL;
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
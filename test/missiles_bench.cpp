@@ -0,0 +1,111 @@
+/**
+ * @file missiles_bench.cpp
+ *
+ * Google Benchmark suite for ProcessMissiles, with many missiles flying across an empty level.
+ * The interleaved and grouped orders measure how much processing the missiles type by type would gain, the order
+ * itself has to stay as it is because the missiles draw from the shared RNG and collide with what earlier ones left.
+ *
+ * Usage: devilutionx_missiles_bench [benchmark options]
+ */
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "engine/random.hpp"
+#include "lighting.h"
+#include "missiles.h"
+#include "player.h"
+
+using namespace devilution;
+
+namespace {
+
+/** @brief Ticks every iteration runs for, long enough for most missiles to reach the end of their range. */
+constexpr int Ticks = 16;
+
+const std::vector<missile_id> LinearTypes { MIS_ARROW, MIS_FIREBOLT };
+const std::vector<missile_id> MixedTypes { MIS_ARROW, MIS_FIREBOLT, MIS_FIREBALL, MIS_LIGHTCTRL };
+
+enum class SpawnOrder {
+	Interleaved,
+	Grouped,
+};
+
+void SpawnMissiles(int count, const std::vector<missile_id> &types, SpawnOrder order)
+{
+	InitLighting();
+	InitMissiles();
+	SetRndSeed(0);
+	std::mt19937 engine(0);
+	const int perType = count / static_cast<int>(types.size());
+	for (int i = 0; i < count; i++) {
+		const size_t type = order == SpawnOrder::Interleaved ? i % types.size() : std::min<size_t>(i / perType, types.size() - 1);
+		const Point src { 20 + static_cast<int>(engine() % 72), 20 + static_cast<int>(engine() % 72) };
+		const Point dst { 20 + static_cast<int>(engine() % 72), 20 + static_cast<int>(engine() % 72) };
+		if (src == dst)
+			continue;
+		AddMissile(src, dst, GetDirection(src, dst), types[type], TARGET_MONSTERS, MyPlayerId, 0, 1);
+	}
+}
+
+void ProcessMissilesBench(benchmark::State &state, const std::vector<missile_id> &types, SpawnOrder order)
+{
+	const auto count = static_cast<int>(state.range(0));
+	size_t missiles = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		SpawnMissiles(count, types, order);
+		missiles += Missiles.size();
+		state.ResumeTiming();
+		for (int tick = 0; tick < Ticks; tick++)
+			ProcessMissiles();
+	}
+	state.counters["missile_ticks"] = benchmark::Counter(static_cast<double>(missiles * Ticks), benchmark::Counter::kIsRate);
+}
+
+void BM_LinearInterleaved(benchmark::State &state)
+{
+	ProcessMissilesBench(state, LinearTypes, SpawnOrder::Interleaved);
+}
+
+void BM_LinearGrouped(benchmark::State &state)
+{
+	ProcessMissilesBench(state, LinearTypes, SpawnOrder::Grouped);
+}
+
+void BM_MixedInterleaved(benchmark::State &state)
+{
+	ProcessMissilesBench(state, MixedTypes, SpawnOrder::Interleaved);
+}
+
+void BM_MixedGrouped(benchmark::State &state)
+{
+	ProcessMissilesBench(state, MixedTypes, SpawnOrder::Grouped);
+}
+
+BENCHMARK(BM_LinearInterleaved)->Arg(64)->Arg(512)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LinearGrouped)->Arg(64)->Arg(512)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_MixedInterleaved)->Arg(64)->Arg(512)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_MixedGrouped)->Arg(64)->Arg(512)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	MyPlayerId = 0;
+	MyPlayer = &Players[MyPlayerId];
+	MyPlayer->plractive = true;
+	MyPlayer->_pIMinDam = 1;
+	MyPlayer->_pIMaxDam = 10;
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
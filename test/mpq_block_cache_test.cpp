@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+
+#include "mpq/mpq_block_cache.hpp"
+
+namespace devilution {
+namespace {
+
+std::array<uint8_t, 4> Block(uint8_t value)
+{
+	return { value, value, value, value };
+}
+
+TEST(MpqBlockCacheTest, ReadsInsertedBlocks)
+{
+	MpqBlockCache cache(16);
+	std::array<uint8_t, 4> out {};
+	EXPECT_FALSE(cache.Read(1, 0, out.data(), 4));
+
+	cache.Insert(1, 0, Block(1).data(), 4);
+	cache.Insert(2, 0, Block(2).data(), 4);
+	ASSERT_TRUE(cache.Read(1, 0, out.data(), 4));
+	EXPECT_EQ(out, Block(1));
+	ASSERT_TRUE(cache.Read(2, 0, out.data(), 4));
+	EXPECT_EQ(out, Block(2));
+	EXPECT_FALSE(cache.Read(1, 1, out.data(), 4)) << "Blocks are keyed by file and block number";
+	EXPECT_FALSE(cache.Read(1, 0, out.data(), 2)) << "Reads with an unexpected size miss";
+
+	const MpqBlockCache::Stats stats = cache.GetStats();
+	EXPECT_EQ(stats.hits, 2U);
+	EXPECT_EQ(stats.misses, 3U);
+}
+
+TEST(MpqBlockCacheTest, EvictsLeastRecentlyUsed)
+{
+	MpqBlockCache cache(12);
+	std::array<uint8_t, 4> out {};
+	cache.Insert(0, 0, Block(0).data(), 4);
+	cache.Insert(0, 1, Block(1).data(), 4);
+	cache.Insert(0, 2, Block(2).data(), 4);
+	EXPECT_TRUE(cache.Read(0, 0, out.data(), 4));
+
+	cache.Insert(0, 3, Block(3).data(), 4);
+	EXPECT_FALSE(cache.Read(0, 1, out.data(), 4)) << "The least recently used block is evicted first";
+	EXPECT_TRUE(cache.Read(0, 0, out.data(), 4));
+	EXPECT_TRUE(cache.Read(0, 2, out.data(), 4));
+	EXPECT_TRUE(cache.Read(0, 3, out.data(), 4));
+
+	std::array<uint8_t, 16> largeBlock {};
+	cache.Insert(0, 4, largeBlock.data(), 16);
+	EXPECT_FALSE(cache.Read(0, 4, largeBlock.data(), 16)) << "Blocks larger than the cache are not kept";
+	EXPECT_TRUE(cache.Read(0, 0, out.data(), 4));
+}
+
+TEST(MpqBlockCacheTest, ReplacingWithLargeBlockDropsOldOne)
+{
+	MpqBlockCache cache(12);
+	std::array<uint8_t, 4> out {};
+	cache.Insert(0, 0, Block(0).data(), 4);
+
+	std::array<uint8_t, 16> largeBlock {};
+	cache.Insert(0, 0, largeBlock.data(), 16);
+	EXPECT_FALSE(cache.Read(0, 0, out.data(), 4)) << "The replaced block must not be read";
+	EXPECT_FALSE(cache.Read(0, 0, largeBlock.data(), 16));
+}
+
+TEST(MpqBlockCacheTest, Disabled)
+{
+	MpqBlockCache cache(16);
+	std::array<uint8_t, 4> out {};
+	cache.Insert(0, 0, Block(0).data(), 4);
+	cache.SetCapacity(0);
+	EXPECT_FALSE(cache.Read(0, 0, out.data(), 4));
+	cache.Insert(0, 0, Block(0).data(), 4);
+	EXPECT_FALSE(cache.Read(0, 0, out.data(), 4));
+}
+
+} // namespace
+} // namespace devilution
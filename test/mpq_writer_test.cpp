@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mpq/mpq_reader.hpp"
+#include "mpq/mpq_writer.hpp"
+#include "utils/file_util.h"
+
+namespace devilution {
+namespace {
+
+constexpr const char *ArchivePath = "mpq_writer_test.sv";
+constexpr int NumFiles = 40;
+constexpr size_t FileSize = 16 * 1024;
+
+std::string FileName(int i)
+{
+	return "file" + std::to_string(i);
+}
+
+std::vector<byte> FileContents(int i)
+{
+	std::mt19937 engine(i);
+	std::vector<byte> contents(FileSize);
+	for (byte &value : contents)
+		value = static_cast<byte>(engine());
+	return contents;
+}
+
+std::uintmax_t ArchiveSize()
+{
+	std::uintmax_t size = 0;
+	EXPECT_TRUE(GetFileSize(ArchivePath, &size));
+	return size;
+}
+
+void ExpectFile(MpqArchive &archive, int i)
+{
+	size_t size;
+	int32_t error;
+	const std::unique_ptr<byte[]> data = archive.ReadFile(FileName(i).c_str(), size, error);
+	ASSERT_NE(data, nullptr) << FileName(i);
+	const std::vector<byte> expected = FileContents(i);
+	ASSERT_EQ(size, expected.size());
+	EXPECT_TRUE(std::equal(expected.begin(), expected.end(), data.get())) << FileName(i);
+}
+
+TEST(MpqWriterTest, CompactsRemovedFiles)
+{
+	std::remove(ArchivePath);
+	{
+		MpqWriter writer(ArchivePath);
+		for (int i = 0; i < NumFiles; i++)
+			ASSERT_TRUE(writer.WriteFile(FileName(i).c_str(), FileContents(i).data(), FileSize));
+	}
+	const std::uintmax_t fullSize = ArchiveSize();
+
+	{
+		MpqWriter writer(ArchivePath);
+		for (int i = 0; i < NumFiles; i += 2)
+			writer.RemoveHashEntry(FileName(i).c_str());
+	}
+	EXPECT_LT(ArchiveSize(), fullSize * 6 / 10) << "The holes of the removed files should have been closed";
+
+	{
+		int32_t error;
+		std::optional<MpqArchive> archive = MpqArchive::Open(ArchivePath, error);
+		ASSERT_TRUE(archive);
+		for (int i = 0; i < NumFiles; i++) {
+			if (i % 2 == 0)
+				EXPECT_FALSE(archive->HasFile(FileName(i).c_str()));
+			else
+				ExpectFile(*archive, i);
+		}
+	}
+
+	{
+		MpqWriter writer(ArchivePath);
+		for (int i = 0; i < NumFiles; i += 2)
+			ASSERT_TRUE(writer.WriteFile(FileName(i).c_str(), FileContents(i).data(), FileSize));
+	}
+	int32_t error;
+	std::optional<MpqArchive> archive = MpqArchive::Open(ArchivePath, error);
+	ASSERT_TRUE(archive);
+	for (int i = 0; i < NumFiles; i++)
+		ExpectFile(*archive, i);
+}
+
+TEST(MpqWriterTest, KeepsLookupsWorkingAfterDroppingDeletedEntries)
+{
+	std::remove(ArchivePath);
+	for (int round = 0; round < 5; round++) {
+		MpqWriter writer(ArchivePath);
+		for (int i = 0; i < NumFiles; i++) {
+			if ((i + round) % 3 == 0)
+				writer.RemoveHashEntry(FileName(i).c_str());
+			else
+				ASSERT_TRUE(writer.WriteFile(FileName(i).c_str(), FileContents(i).data(), FileSize));
+		}
+	}
+
+	MpqWriter writer(ArchivePath);
+	for (int i = 0; i < NumFiles; i++)
+		EXPECT_EQ(writer.HasFile(FileName(i).c_str()), (i + 4) % 3 != 0) << FileName(i);
+}
+
+} // namespace
+} // namespace devilution
@@ -2,6 +2,7 @@
 
 #include <gtest/gtest.h>
 
+#include "engine/random.hpp"
 #include "pack.h"
 #include "utils/paths.h"
 
@@ -353,6 +354,25 @@ TEST(PackTest, UnPackItem_diablo)
 	}
 }
 
+TEST(PackTest, UnPackItem_diablo_again)
+{
+	Item id;
+
+	gbIsHellfire = false;
+	gbIsMultiplayer = false;
+	gbIsSpawn = false;
+
+	for (size_t i = 0; i < sizeof(PackedDiabloItems) / sizeof(*PackedDiabloItems); i++) {
+		UnPackItem(PackedDiabloItems[i], id, false);
+		const uint32_t rngState = GetLCGEngineState();
+
+		// Recreated items are cached, the second one has to match generating it from scratch.
+		UnPackItem(PackedDiabloItems[i], id, false);
+		CompareItems(id, DiabloItems[i]);
+		EXPECT_EQ(GetLCGEngineState(), rngState);
+	}
+}
+
 TEST(PackTest, UnPackItem_diablo_unique_bug)
 {
 	ItemPack pkItemBug = { 6, 911, 14, 5, 60, 60, 0, 0, 0, 0 }; // Veil of Steel - with morph bug
@@ -150,6 +150,63 @@ TEST(PathTest, LongPaths)
 	CheckPath(startingPosition, startingPosition + Displacement { 25, 25 }, {});
 }
 
+TEST(PathTest, DistanceField)
+{
+	static int8_t pathSteps[MaxPathLength];
+	const auto walkable = [](Point position) { return IsTileWalkable(position, true); };
+
+	// Split the map in half with a wall
+	SOLData[0] = TileProperties::None;
+	SOLData[1] = TileProperties::Solid;
+	for (int y = 0; y < MAXDUNY; y++)
+		dPiece[20][y] = 1;
+	InvalidatePathDistanceFields();
+
+	const Point destination { 30, 30 };
+	PathDistanceField field;
+	field.Build(destination);
+	EXPECT_TRUE(field.isValid());
+	EXPECT_TRUE(field.MayReach({ 25, 40 })) << "Positions on the same side of the wall are reachable";
+	EXPECT_TRUE(field.MayReach(destination + Direction::South)) << "Neighbouring positions are reachable";
+	EXPECT_FALSE(field.MayReach({ 10, 30 })) << "Positions on the other side of the wall are not reachable";
+	EXPECT_EQ(FindPath(walkable, { 10, 30 }, destination, pathSteps), 0);
+	EXPECT_FALSE(field.MayReach({ 60, 30 })) << "Positions too far away for FindPath are not reachable";
+
+	// Placing a door in the wall opens up a path
+	dObject[20][30] = 1;
+	Objects[0]._otype = _object_id::OBJ_L1LDOOR;
+	InvalidatePathDistanceFields();
+	EXPECT_FALSE(field.isValid()) << "Fields need to be rebuilt after the layout changes";
+	field.Build(destination);
+	EXPECT_TRUE(field.MayReach({ 10, 30 }));
+	EXPECT_EQ(FindPath(walkable, { 10, 30 }, destination, pathSteps), 20);
+
+	dObject[20][30] = 0;
+	Objects[0] = {};
+	for (int y = 0; y < MAXDUNY; y++)
+		dPiece[20][y] = 0;
+	InvalidatePathDistanceFields();
+}
+
+TEST(PathTest, LayoutChanges)
+{
+	static int8_t pathSteps[MaxPathLength];
+	const auto anyPosition = [](Point) { return true; };
+	SOLData[0] = TileProperties::None;
+	SOLData[1] = TileProperties::Solid;
+	CheckPath({ 8, 8 }, { 10, 10 }, { 7, 7 });
+
+	// A solid corner blocks the diagonal step even though every position is accepted
+	dPiece[9][8] = 1;
+	InvalidatePathDistanceFields();
+	ASSERT_EQ(FindPath(anyPosition, { 8, 8 }, { 10, 10 }, pathSteps), 3);
+	EXPECT_NE(pathSteps[0], 7) << "FindPath must pick up solid tiles after the layout changed";
+
+	dPiece[9][8] = 0;
+	InvalidatePathDistanceFields();
+	CheckPath({ 8, 8 }, { 10, 10 }, { 7, 7 });
+}
+
 TEST(PathTest, Walkable)
 {
 	dPiece[5][5] = 0;
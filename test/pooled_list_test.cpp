@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <vector>
+
+#include "utils/pooled_list.hpp"
+
+namespace devilution {
+namespace {
+
+std::vector<int> ToVector(const PooledList<int, 4> &list)
+{
+	return { list.begin(), list.end() };
+}
+
+TEST(PooledListTest, KeepsInsertionOrder)
+{
+	PooledList<int, 4> list;
+	EXPECT_TRUE(list.empty());
+	for (int i = 0; i < 10; i++)
+		list.emplace_back(i);
+	EXPECT_EQ(list.size(), 10U);
+	EXPECT_EQ(list.back(), 9);
+	EXPECT_EQ(ToVector(list), (std::vector<int> { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+
+	auto it = list.cbegin();
+	std::advance(it, 8);
+	EXPECT_EQ(*it, 8);
+}
+
+TEST(PooledListTest, RemoveIf)
+{
+	PooledList<int, 4> list;
+	for (int i = 0; i < 10; i++)
+		list.emplace_back(i);
+
+	list.remove_if([](int value) { return value % 3 == 0; });
+	EXPECT_EQ(ToVector(list), (std::vector<int> { 1, 2, 4, 5, 7, 8 }));
+	EXPECT_EQ(list.back(), 8);
+
+	list.remove_if([](int value) { return value > 4; });
+	EXPECT_EQ(ToVector(list), (std::vector<int> { 1, 2, 4 }));
+	EXPECT_EQ(list.back(), 4);
+
+	list.clear();
+	EXPECT_TRUE(list.empty());
+	EXPECT_EQ(list.begin(), list.end());
+}
+
+TEST(PooledListTest, ElementsAreStable)
+{
+	PooledList<int, 4> list;
+	std::vector<int *> addresses;
+	for (int i = 0; i < 10; i++)
+		addresses.push_back(&list.emplace_back(i));
+
+	list.remove_if([](int value) { return value % 2 == 0; });
+	for (int i = 0; i < 20; i++)
+		list.emplace_back(i + 10);
+
+	for (int i = 1; i < 10; i += 2)
+		EXPECT_EQ(*addresses[i], i) << "Element " << i << " moved";
+}
+
+TEST(PooledListTest, VisitsElementsAddedWhileIterating)
+{
+	PooledList<int, 4> list;
+	list.emplace_back(5);
+
+	std::vector<int> visited;
+	for (int value : list) {
+		visited.push_back(value);
+		if (value > 0)
+			list.emplace_back(value - 1);
+	}
+	EXPECT_EQ(visited, (std::vector<int> { 5, 4, 3, 2, 1, 0 }));
+}
+
+} // namespace
+} // namespace devilution
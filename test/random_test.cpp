@@ -237,4 +237,46 @@ TEST(RandomTest, ModDistributionSignPreserving)
 	    << "Distribution must map negative numbers using sign preserving modulo";
 }
 
+TEST(RandomTest, GeneratorMatchesGlobalEngine)
+{
+	constexpr uint32_t seed = 1457187811;
+	SetRndSeed(seed);
+	DiabloGenerator generator { seed };
+	for (int i = 0; i < 1000; i++) {
+		const int32_t limit = i % 3 == 0 ? 65535 : i + 1;
+		ASSERT_EQ(generator.generateRnd(limit), GenerateRnd(limit)) << "Mismatch at value " << i;
+		ASSERT_EQ(generator.state(), GetLCGEngineState()) << "Mismatch at value " << i;
+	}
+	ASSERT_EQ(generator.advanceRndSeed(), AdvanceRndSeed());
+	ASSERT_EQ(generator.flipCoin(), FlipCoin());
+	ASSERT_EQ(generator.state(), GetLCGEngineState());
+
+	// A generator of its own doesn't touch the global state.
+	DiabloGenerator other { 0 };
+	other.advanceRndSeed();
+	ASSERT_EQ(generator.state(), GetLCGEngineState());
+}
+
+TEST(RandomTest, DiscardRandomValues)
+{
+	for (uint64_t count : { 0ULL, 1ULL, 2ULL, 3ULL, 7ULL, 64ULL, 1000ULL, 9999ULL }) {
+		DiabloGenerator stepped { 12345 };
+		for (uint64_t i = 0; i < count; i++)
+			stepped.advanceRndSeed();
+		DiabloGenerator skipped { 12345 };
+		skipped.discardRandomValues(count);
+		ASSERT_EQ(skipped.state(), stepped.state()) << "Wrong engine state after skipping " << count << " values";
+	}
+
+	// See RandomEngineParams, which advances the engine 10000 times from 0.
+	SetRndSeed(0);
+	DiscardRandomValues(10000);
+	ASSERT_EQ(GetLCGEngineState(), 3495122800U);
+
+	// The state has a period of 2^32.
+	DiabloGenerator generator { 42 };
+	generator.discardRandomValues(uint64_t { 1 } << 32);
+	ASSERT_EQ(generator.state(), 42U);
+}
+
 } // namespace devilution
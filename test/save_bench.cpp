@@ -0,0 +1,196 @@
+/**
+ * @file save_bench.cpp
+ *
+ * Google Benchmark suite for reading and writing saves, run against a copy of the timedemo fixture save.
+ * Besides the time, every benchmark reports the amount of data it handled so that format changes show up too.
+ *
+ * Usage: devilutionx_save_bench [benchmark options]
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <SDL.h>
+#include <benchmark/benchmark.h>
+
+#include "codec.h"
+#include "loadsave.h"
+#include "menu.h"
+#include "pfile.h"
+#include "player.h"
+#include "utils/file_util.h"
+#include "utils/paths.h"
+
+using namespace devilution;
+
+namespace {
+
+constexpr const char *FixtureSave = "/test/fixtures/timedemo/WarriorLevel1to2/spawn_0.sv";
+/** @brief Any password works for the codec benchmarks, this is the one of single player saves. */
+constexpr const char *Password = "xrgyrkj1";
+
+/** @brief Size of the level files in a vanilla save, a level is the largest file a save contains. */
+constexpr size_t LevelDataSize = 320 * 1024;
+
+std::uintmax_t SaveFileSize()
+{
+	std::uintmax_t size = 0;
+	GetFileSize((paths::PrefPath() + "spawn_0.sv").c_str(), &size);
+	return size;
+}
+
+/**
+ * @brief Copies the fixture save to a scratch folder, the benchmarks write to the save and the timedemo test
+ * expects the fixture to be unchanged.
+ */
+bool PrepareSave()
+{
+	const std::string folder = paths::BasePath() + "save_bench";
+	if (!CreateDir(folder.c_str()))
+		return false;
+	paths::SetPrefPath(folder);
+	paths::SetConfigPath(folder);
+
+	std::ifstream in(paths::BasePath() + FixtureSave, std::ios::binary);
+	std::ofstream out(paths::PrefPath() + "spawn_0.sv", std::ios::binary | std::ios::trunc);
+	if (!in || !out)
+		return false;
+	out << in.rdbuf();
+	if (!out)
+		return false;
+
+	gbIsSpawn = true;
+	gbIsHellfire = false;
+	gbIsHellfireSaveGame = false;
+	gbIsMultiplayer = false;
+	giNumberOfLevels = 17;
+	gSaveNumber = 0;
+	MyPlayerId = 0;
+	MyPlayer = &Players[MyPlayerId];
+	pfile_read_player_from_save(gSaveNumber, *MyPlayer);
+	return true;
+}
+
+/** @brief Fills a buffer with data that compresses about as well as a level. */
+std::unique_ptr<byte[]> MakeLevelData(size_t size)
+{
+	std::unique_ptr<byte[]> data { new byte[codec_get_encoded_len(size)] };
+	std::mt19937 engine(0);
+	for (size_t i = 0; i < size; i++)
+		data[i] = static_cast<byte>(engine() % 16 == 0 ? engine() : 0);
+	return data;
+}
+
+void BM_ReadHero(benchmark::State &state)
+{
+	for (auto _ : state) {
+		pfile_read_player_from_save(gSaveNumber, *MyPlayer);
+		benchmark::ClobberMemory();
+	}
+	state.counters["save_bytes"] = static_cast<double>(SaveFileSize());
+}
+
+void BM_WriteHero(benchmark::State &state)
+{
+	for (auto _ : state) {
+		pfile_write_hero();
+		pfile_wait_for_save();
+	}
+	state.counters["save_bytes"] = static_cast<double>(SaveFileSize());
+}
+
+/** @brief Loads and saves every level stored in the save, the same work as converting a save between game versions. */
+void BM_ConvertLevels(benchmark::State &state)
+{
+	for (auto _ : state) {
+		pfile_convert_levels();
+	}
+	state.counters["save_bytes"] = static_cast<double>(SaveFileSize());
+}
+
+void BM_EncodeLevel(benchmark::State &state)
+{
+	const std::unique_ptr<byte[]> source = MakeLevelData(LevelDataSize);
+	const size_t encodedSize = codec_get_encoded_len(LevelDataSize);
+	std::unique_ptr<byte[]> buffer { new byte[encodedSize] };
+	for (auto _ : state) {
+		std::memcpy(buffer.get(), source.get(), LevelDataSize);
+		codec_encode(buffer.get(), LevelDataSize, encodedSize, Password);
+		benchmark::DoNotOptimize(buffer.get());
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * LevelDataSize);
+}
+
+void BM_DecodeLevel(benchmark::State &state)
+{
+	const size_t encodedSize = codec_get_encoded_len(LevelDataSize);
+	const std::unique_ptr<byte[]> encoded = MakeLevelData(LevelDataSize);
+	codec_encode(encoded.get(), LevelDataSize, encodedSize, Password);
+	std::unique_ptr<byte[]> buffer { new byte[encodedSize] };
+	for (auto _ : state) {
+		std::memcpy(buffer.get(), encoded.get(), encodedSize);
+		if (codec_decode(buffer.get(), encodedSize, Password) != LevelDataSize) {
+			state.SkipWithError("Failed to decode the level");
+			break;
+		}
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * encodedSize);
+}
+
+/**
+ * @brief Throughput of rejecting corrupted save files.
+ *
+ * Every iteration flips a few bytes of an encoded level, anything the checksum lets through would reach LoadHelper,
+ * so an accepted input is reported as an error together with its seed.
+ */
+void BM_DecodeCorruptedLevel(benchmark::State &state)
+{
+	const size_t encodedSize = codec_get_encoded_len(LevelDataSize);
+	const std::unique_ptr<byte[]> encoded = MakeLevelData(LevelDataSize);
+	codec_encode(encoded.get(), LevelDataSize, encodedSize, Password);
+	std::unique_ptr<byte[]> buffer { new byte[encodedSize] };
+	std::mt19937 engine(0);
+	// Every rejected checksum is logged, which would otherwise dominate the timings.
+	SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_CRITICAL);
+	for (auto _ : state) {
+		std::memcpy(buffer.get(), encoded.get(), encodedSize);
+		const uint32_t seed = engine();
+		std::mt19937 mutator(seed);
+		const int flips = 1 + mutator() % 8;
+		for (int i = 0; i < flips; i++)
+			buffer[mutator() % encodedSize] ^= static_cast<byte>(1 + mutator() % 255);
+		if (codec_decode(buffer.get(), encodedSize, Password) != 0) {
+			state.SkipWithError(("Corrupted level was accepted, seed " + std::to_string(seed)).c_str());
+			break;
+		}
+	}
+	SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * encodedSize);
+}
+
+BENCHMARK(BM_ReadHero)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_WriteHero)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ConvertLevels)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EncodeLevel)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DecodeLevel)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DecodeCorruptedLevel)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+	if (!PrepareSave()) {
+		std::fputs("Failed to copy the fixture save\n", stderr);
+		return 1;
+	}
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,235 @@
+/**
+ * @file sound_bench.cpp
+ *
+ * Google Benchmark suite for the CPU cost of sound effects, from the positional math to mixing many voices.
+ * The sounds are synthesized, so no game data is needed.
+ *
+ * Usage: devilutionx_sound_bench [benchmark options]
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <SDL.h>
+#include <aulib.h>
+#include <benchmark/benchmark.h>
+
+#include "effects.h"
+#include "engine/sound.h"
+#include "engine/sound_defs.hpp"
+#include "options.h"
+#include "player.h"
+#include "utils/aulib.hpp"
+#include "utils/pcm_aulib_decoder.h"
+
+using namespace devilution;
+
+namespace {
+
+/** @brief Rate of the game's sound effects, the output runs at a different rate so that the resamplers have work to do. */
+constexpr int SourceRate = 22050;
+constexpr int OutputRate = 44100;
+constexpr int OutputBufferSize = 2048;
+
+/** @brief Wall-clock time every mixing benchmark iteration lets the audio callback run for. */
+constexpr std::chrono::milliseconds MixingWindow { 250 };
+
+enum class BenchResampler {
+	Speex,
+	Sdl,
+};
+
+std::shared_ptr<const PcmSamples> MakeTone()
+{
+	constexpr size_t Size = SourceRate;
+	auto tone = std::make_shared<PcmSamples>();
+	tone->data.reset(new float[Size]);
+	tone->size = Size;
+	tone->numChannels = 1;
+	tone->sampleRate = SourceRate;
+	for (size_t i = 0; i < Size; i++)
+		tone->data[i] = 0.25F * std::sin(static_cast<float>(i) * 440.F * 2.F * 3.14159265F / SourceRate);
+	return tone;
+}
+
+std::unique_ptr<Aulib::Resampler> MakeResampler(BenchResampler resampler, int quality)
+{
+	switch (resampler) {
+#ifdef DEVILUTIONX_RESAMPLER_SPEEX
+	case BenchResampler::Speex:
+		return std::make_unique<Aulib::ResamplerSpeex>(quality);
+#endif
+#ifdef DVL_AULIB_SUPPORTS_SDL_RESAMPLER
+	case BenchResampler::Sdl:
+		return std::make_unique<Aulib::ResamplerSdl>();
+#endif
+	default:
+		return nullptr;
+	}
+}
+
+void BM_CalculateSoundPosition(benchmark::State &state)
+{
+	MyPlayer = &Players[0];
+	MyPlayer->position.tile = { 50, 50 };
+	std::mt19937 engine(0);
+	std::vector<Point> positions;
+	for (int i = 0; i < 1024; i++)
+		positions.emplace_back(40 + static_cast<int>(engine() % 21), 40 + static_cast<int>(engine() % 21));
+	size_t i = 0;
+	for (auto _ : state) {
+		int volume;
+		int pan;
+		benchmark::DoNotOptimize(CalculateSoundPosition(positions[i++ % positions.size()], &volume, &pan));
+		benchmark::DoNotOptimize(volume);
+		benchmark::DoNotOptimize(pan);
+	}
+}
+
+/** @brief Converting the game's logarithmic volume and pan to the linear values Aulib takes. */
+void BM_SetVolumeAndPan(benchmark::State &state)
+{
+	SoundSample sample;
+	if (sample.SetPcm(MakeTone()) != 0) {
+		state.SkipWithError("Failed to create the sound");
+		return;
+	}
+	int i = 0;
+	for (auto _ : state) {
+		sample.SetVolume(-(i % -ATTENUATION_MIN), ATTENUATION_MIN, 0);
+		sample.SetStereoPosition(PAN_MIN + (i * 64) % (PAN_MAX - PAN_MIN));
+		i++;
+	}
+}
+
+/** @brief Playing the same effect over and over, every play after the first one takes a duplicate voice. */
+void BM_PlaySoundSpam(benchmark::State &state)
+{
+	auto snd = std::make_unique<TSnd>();
+	if (snd->DSB.SetPcm(MakeTone()) != 0) {
+		state.SkipWithError("Failed to create the sound");
+		return;
+	}
+	for (auto _ : state) {
+		// Plays of the same sound within 80 ms of each other are ignored.
+		snd->start_tc = SDL_GetTicks() - 81;
+		snd_play_snd(snd.get(), -64 * static_cast<int>(state.iterations() % 10), 0);
+	}
+	ClearDuplicateSounds();
+	snd->DSB.Stop();
+}
+
+/**
+ * @brief Mixes the given number of looping voices and reports the share of a CPU the audio callback takes.
+ *
+ * Aulib mixes on SDL's audio thread while this thread sleeps, so the process CPU time divided by the wall-clock
+ * time is the callback's share. The 0 voices run shows the baseline of mixing silence.
+ */
+void MixVoices(benchmark::State &state, BenchResampler resampler)
+{
+	const auto numVoices = static_cast<int>(state.range(0));
+	const auto quality = static_cast<int>(state.range(1));
+	const std::shared_ptr<const PcmSamples> tone = MakeTone();
+
+	std::vector<std::unique_ptr<Aulib::Stream>> voices;
+	for (int i = 0; i < numVoices; i++) {
+		std::unique_ptr<Aulib::Resampler> voiceResampler = MakeResampler(resampler, quality);
+		if (voiceResampler == nullptr) {
+			state.SkipWithError("The resampler isn't available in this build");
+			return;
+		}
+		auto voice = std::make_unique<Aulib::Stream>(/*rwops=*/nullptr, std::make_unique<PcmAulibDecoder>(tone), std::move(voiceResampler), /*closeRw=*/false);
+		if (!voice->open()) {
+			state.SkipWithError("Failed to open a voice");
+			return;
+		}
+		voice->setVolume(1.F / static_cast<float>(numVoices));
+		voice->setStereoPosition(static_cast<float>(i % 3 - 1) / 2.F);
+		voices.push_back(std::move(voice));
+	}
+	for (std::unique_ptr<Aulib::Stream> &voice : voices)
+		voice->play(/*iterations=*/0);
+
+	std::chrono::steady_clock::duration wallTime {};
+	std::clock_t cpuTime = 0;
+	for (auto _ : state) {
+		const auto wallStart = std::chrono::steady_clock::now();
+		const std::clock_t cpuStart = std::clock();
+		SDL_Delay(static_cast<Uint32>(MixingWindow.count()));
+		cpuTime += std::clock() - cpuStart;
+		wallTime += std::chrono::steady_clock::now() - wallStart;
+	}
+
+	for (std::unique_ptr<Aulib::Stream> &voice : voices)
+		voice->stop();
+
+	const double wallSeconds = std::chrono::duration<double>(wallTime).count();
+	state.counters["callback_cpu_share"] = wallSeconds > 0 ? static_cast<double>(cpuTime) / CLOCKS_PER_SEC / wallSeconds : 0;
+	state.counters["voices"] = numVoices;
+}
+
+#ifdef DEVILUTIONX_RESAMPLER_SPEEX
+void BM_MixVoicesSpeex(benchmark::State &state)
+{
+	MixVoices(state, BenchResampler::Speex);
+}
+#endif
+
+#ifdef DVL_AULIB_SUPPORTS_SDL_RESAMPLER
+void BM_MixVoicesSdl(benchmark::State &state)
+{
+	MixVoices(state, BenchResampler::Sdl);
+}
+#endif
+
+void MixingArgs(benchmark::internal::Benchmark *benchmark, bool hasQuality)
+{
+	for (int voices : { 0, 8, 32, 64 }) {
+		if (hasQuality) {
+			for (int quality : { 0, 3, 5, 10 })
+				benchmark->Args({ voices, quality });
+		} else {
+			benchmark->Args({ voices, 0 });
+		}
+	}
+	benchmark->ArgNames({ "voices", "quality" })->Iterations(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_CalculateSoundPosition);
+BENCHMARK(BM_SetVolumeAndPan);
+BENCHMARK(BM_PlaySoundSpam)->Unit(benchmark::kMicrosecond);
+#ifdef DEVILUTIONX_RESAMPLER_SPEEX
+BENCHMARK(BM_MixVoicesSpeex)->Apply([](benchmark::internal::Benchmark *benchmark) { MixingArgs(benchmark, /*hasQuality=*/true); });
+#endif
+#ifdef DVL_AULIB_SUPPORTS_SDL_RESAMPLER
+BENCHMARK(BM_MixVoicesSdl)->Apply([](benchmark::internal::Benchmark *benchmark) { MixingArgs(benchmark, /*hasQuality=*/false); });
+#endif
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	// Mix off-screen unless the caller asked for a specific audio driver.
+	if (SDL_getenv("SDL_AUDIODRIVER") == nullptr)
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+	if (!Aulib::init(OutputRate, AUDIO_S16, /*channels=*/2, OutputBufferSize, /*device=*/std::string {})) {
+		std::fprintf(stderr, "Failed to initialize audio: %s\n", SDL_GetError());
+		return 1;
+	}
+	gbSoundOn = true;
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	Aulib::quit();
+	return 0;
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <utility>
+
+#include "engine/state_hash.hpp"
+#include "monster.h"
+
+using namespace devilution;
+
+namespace {
+
+constexpr size_t MonstersIndex = static_cast<size_t>(StateHashCategory::Monsters);
+
+void SetUpMonsters()
+{
+	ActiveMonsterCount = 2;
+	ActiveMonsters[0] = 0;
+	ActiveMonsters[1] = 1;
+	Monsters[0] = {};
+	Monsters[1] = {};
+	Monsters[0].position.tile = { 10, 10 };
+	Monsters[1].position.tile = { 20, 20 };
+}
+
+} // namespace
+
+TEST(StateHash, SameStateHashesTheSame)
+{
+	SetUpMonsters();
+	EXPECT_EQ(ComputeGameStateHash(), ComputeGameStateHash());
+}
+
+TEST(StateHash, OnlyTheChangedCategoryDiffers)
+{
+	SetUpMonsters();
+	const GameStateHash before = ComputeGameStateHash();
+	Monsters[1].hitPoints -= 64;
+	const GameStateHash after = ComputeGameStateHash();
+	for (size_t i = 0; i < NumStateHashCategories; i++) {
+		if (i == MonstersIndex)
+			EXPECT_NE(before.categories[i], after.categories[i]);
+		else
+			EXPECT_EQ(before.categories[i], after.categories[i]) << GetStateHashCategoryName(static_cast<StateHashCategory>(i));
+	}
+}
+
+TEST(StateHash, ProcessingOrderMatters)
+{
+	SetUpMonsters();
+	const GameStateHash before = ComputeGameStateHash();
+	std::swap(ActiveMonsters[0], ActiveMonsters[1]);
+	EXPECT_NE(before.categories[MonstersIndex], ComputeGameStateHash().categories[MonstersIndex]);
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "utils/static_flat_map.hpp"
+
+namespace devilution {
+namespace {
+
+TEST(StaticFlatMapTest, KeepsKeysSorted)
+{
+	StaticFlatMap<uint8_t, int, 8> map;
+	EXPECT_TRUE(map.empty());
+	for (uint8_t key : { 5, 1, 7, 3 })
+		map[key] = key * 10;
+	EXPECT_EQ(map.size(), 4U);
+
+	uint8_t previous = 0;
+	for (const auto &entry : map) {
+		EXPECT_GT(entry.first, previous);
+		EXPECT_EQ(entry.second, entry.first * 10);
+		previous = entry.first;
+	}
+}
+
+TEST(StaticFlatMapTest, Lookup)
+{
+	StaticFlatMap<int, int, 4> map;
+	map[2] = 20;
+	map[4] = 40;
+	map[2] = 21;
+	EXPECT_EQ(map.size(), 2U);
+	EXPECT_EQ(map.at(2), 21);
+	EXPECT_EQ(map.at(4), 40);
+	EXPECT_TRUE(map.contains(4));
+	EXPECT_FALSE(map.contains(3));
+	EXPECT_EQ(map.find(5), map.end());
+
+	map.clear();
+	EXPECT_TRUE(map.empty());
+}
+
+} // namespace
+} // namespace devilution
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "utils/static_ring_buffer.hpp"
+
+namespace devilution {
+namespace {
+
+TEST(StaticRingBufferTest, ReplacesOldest)
+{
+	StaticRingBuffer<int, 3> buffer;
+	EXPECT_TRUE(buffer.empty());
+	for (int i = 0; i < 5; i++)
+		buffer.emplace_back(i);
+	EXPECT_TRUE(buffer.full());
+	EXPECT_EQ(buffer.front(), 2);
+	EXPECT_EQ(buffer[1], 3);
+	EXPECT_EQ(buffer.back(), 4);
+
+	buffer.pop_front();
+	EXPECT_EQ(buffer.size(), 2U);
+	EXPECT_EQ(buffer.front(), 3);
+}
+
+TEST(StaticRingBufferTest, ElementsDontMove)
+{
+	StaticRingBuffer<std::string, 4> buffer;
+	const std::string &first = buffer.emplace_back("first");
+	const char *data = first.data();
+	buffer.emplace_back("second");
+	buffer.emplace_back("third");
+	EXPECT_EQ(buffer.front().data(), data);
+	EXPECT_EQ(first, "first");
+}
+
+TEST(StaticRingBufferTest, DestroysElements)
+{
+	auto counter = std::make_shared<int>(0);
+	{
+		StaticRingBuffer<std::shared_ptr<int>, 2> buffer;
+		for (int i = 0; i < 4; i++)
+			buffer.emplace_back(counter);
+		EXPECT_EQ(counter.use_count(), 3);
+		buffer.clear();
+		EXPECT_EQ(counter.use_count(), 1);
+		buffer.emplace_back(counter);
+	}
+	EXPECT_EQ(counter.use_count(), 1);
+}
+
+} // namespace
+} // namespace devilution
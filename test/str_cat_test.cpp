@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include "utils/str_cat.hpp"
+
+namespace devilution {
+namespace {
+
+TEST(StrCatTest, StrCat)
+{
+	EXPECT_EQ(StrCat("a", 1, string_view("bc"), -23), "a1bc-23");
+}
+
+TEST(StrCatTest, StrCatTo)
+{
+	char buf[16];
+	EXPECT_EQ(StrCatTo(buf, "x", 12), "x12");
+	EXPECT_STREQ(buf, "x12");
+	EXPECT_EQ(StrCatTo(buf, 5, "/", 10), "5/10");
+}
+
+TEST(StrCatTest, StrAppendTo)
+{
+	char buf[16];
+	StrCatTo(buf, "Level ");
+	EXPECT_EQ(StrAppendTo(buf, 7), "Level 7");
+	EXPECT_EQ(StrAppendTo(buf, string_view("0 ms")), "Level 70 ms");
+}
+
+TEST(StrCatTest, CutsOff)
+{
+	char buf[6];
+	EXPECT_EQ(StrCatTo(buf, "abc", 12345), "abc12");
+	EXPECT_STREQ(buf, "abc12");
+	EXPECT_EQ(StrAppendTo(buf, "more"), "abc12");
+	EXPECT_EQ(StrCatTo(buf, ""), "");
+}
+
+} // namespace
+} // namespace devilution
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "utils/string_perfect_hash.hpp"
+
+namespace devilution {
+namespace {
+
+TEST(StringPerfectHashTest, FindsEveryKey)
+{
+	std::vector<std::string> keys;
+	for (int i = 0; i < 5000; i++)
+		keys.push_back("key " + std::to_string(i));
+
+	std::vector<StringPerfectHash<int>::value_type> entries;
+	for (size_t i = 0; i < keys.size(); i++)
+		entries.emplace_back(keys[i].c_str(), static_cast<int>(i));
+
+	StringPerfectHash<int> map;
+	ASSERT_TRUE(map.Build(entries));
+	EXPECT_EQ(map.size(), keys.size());
+	for (size_t i = 0; i < keys.size(); i++) {
+		const int *value = map.Find(keys[i]);
+		ASSERT_NE(value, nullptr) << keys[i];
+		EXPECT_EQ(*value, static_cast<int>(i));
+	}
+}
+
+TEST(StringPerfectHashTest, MissingKeys)
+{
+	StringPerfectHash<int> map;
+	EXPECT_EQ(map.Find("a"), nullptr);
+
+	ASSERT_TRUE(map.Build({ { "a", 1 }, { "b", 2 }, { "", 3 } }));
+	EXPECT_EQ(map.Find("c"), nullptr);
+	EXPECT_EQ(map.Find("ab"), nullptr);
+	ASSERT_NE(map.Find(""), nullptr);
+	EXPECT_EQ(*map.Find(""), 3);
+}
+
+TEST(StringPerfectHashTest, FirstDuplicateWins)
+{
+	StringPerfectHash<int> map;
+	ASSERT_TRUE(map.Build({ { "a", 1 }, { "b", 2 }, { "a", 3 } }));
+	EXPECT_EQ(map.size(), 2U);
+	ASSERT_NE(map.Find("a"), nullptr);
+	EXPECT_EQ(*map.Find("a"), 1);
+}
+
+TEST(StringPerfectHashTest, Empty)
+{
+	StringPerfectHash<int> map;
+	ASSERT_TRUE(map.Build({}));
+	EXPECT_TRUE(map.empty());
+	EXPECT_EQ(map.Find(""), nullptr);
+}
+
+} // namespace
+} // namespace devilution
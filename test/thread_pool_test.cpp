@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "utils/thread_pool.hpp"
+
+namespace devilution {
+namespace {
+
+TEST(ThreadPoolTest, RunsEveryJobOnce)
+{
+	ThreadPool pool(3);
+	EXPECT_EQ(pool.concurrency(), 4U);
+	for (int count = 0; count <= 16; count++) {
+		std::vector<std::atomic<int>> calls(count);
+		pool.ParallelFor(count, [&](int i) { calls[i]++; });
+		for (int i = 0; i < count; i++)
+			EXPECT_EQ(calls[i], 1) << "job " << i << " of " << count;
+	}
+}
+
+TEST(ThreadPoolTest, WithoutWorkers)
+{
+	ThreadPool pool(0);
+	EXPECT_EQ(pool.concurrency(), 1U);
+	int sum = 0;
+	pool.ParallelFor(4, [&](int i) { sum += i; });
+	EXPECT_EQ(sum, 6);
+}
+
+} // namespace
+} // namespace devilution
@@ -0,0 +1,242 @@
+/**
+ * @file timedemo_bench.cpp
+ *
+ * Replays the timedemo fixtures with rendering enabled and prints the per-stage frame timings as JSON.
+ *
+ * With --baseline, the percentiles of a single timedemo are compared against a stored baseline and the process
+ * fails if any of them regressed past the threshold. This is what the perf CTest label runs.
+ *
+ * Usage: devilutionx_bench [--baseline <file> [--threshold <percent>] | --write-baseline <file>] [timedemo folder name...]
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <SDL.h>
+
+#include "diablo.h"
+#include "engine/demomode.h"
+#include "engine/frame_timings.hpp"
+#include "init.h"
+#include "options.h"
+#include "pfile.h"
+#include "utils/display.h"
+#include "utils/language.h"
+#include "utils/paths.h"
+
+using namespace devilution;
+
+namespace {
+
+/** @brief Tells CTest that the benchmark could not run, e.g. because the MPQs or the baseline are missing. */
+constexpr int SkipExitCode = 77;
+
+/**
+ * @brief Regressions smaller than this are ignored regardless of the threshold, short stages are too noisy otherwise.
+ */
+constexpr uint32_t MinRegressionUs = 200;
+
+struct BenchOptions {
+	std::vector<std::string> demos;
+	std::string baselinePath;
+	std::string writeBaselinePath;
+	unsigned thresholdPercent = 25;
+};
+
+struct TimedemoResult {
+	std::string json;
+	bool sameOutcome;
+};
+
+bool Dummy_GetHeroInfo(_uiheroinfo *pInfo)
+{
+	return true;
+}
+
+TimedemoResult RunTimedemo(const std::string &timedemoFolderName)
+{
+	const std::string timedemoFolder = paths::BasePath() + "/test/fixtures/timedemo/" + timedemoFolderName;
+	paths::SetPrefPath(timedemoFolder);
+	paths::SetConfigPath(timedemoFolder);
+
+	const int demoNumber = 0;
+
+	// Currently only spawn.mpq is present when building on github actions
+	gbIsSpawn = true;
+	gbIsHellfire = false;
+	gbMusicOn = false;
+	gbSoundOn = false;
+	demo::InitPlayBack(demoNumber, true);
+
+	pfile_ui_set_hero_infos(Dummy_GetHeroInfo);
+	gbLoadGame = true;
+
+	demo::OverrideOptions();
+
+	AdjustToScreenGeometry(*sgOptions.Graphics.resolution);
+
+	StartFrameTimings();
+	StartGame(false, true);
+	StopFrameTimings();
+
+	const bool sameOutcome = pfile_compare_hero_demo(demoNumber) == HeroCompareResult::Same;
+	gbRunGame = false;
+
+	return { "{\"demo\":\"" + timedemoFolderName + "\",\"same_outcome\":" + (sameOutcome ? "true" : "false") + ",\"timings\":" + FrameTimingsToJson() + "}", sameOutcome };
+}
+
+/**
+ * @brief Stores the percentiles of the last timedemo, one line per stage: the name followed by the median, p95 and p99 in microseconds.
+ */
+bool WriteBaseline(const std::string &path)
+{
+	std::ofstream out(path, std::ios::trunc);
+	for (size_t i = 0; i < NumFrameStages; i++) {
+		const auto stage = static_cast<FrameStage>(i);
+		const std::optional<FrameStagePercentiles> percentiles = GetFrameStagePercentiles(stage);
+		if (percentiles)
+			out << GetFrameStageName(stage) << ' ' << percentiles->medianUs << ' ' << percentiles->p95Us << ' ' << percentiles->p99Us << '\n';
+	}
+	return static_cast<bool>(out);
+}
+
+/**
+ * @brief Compares the percentiles of the last timedemo against a baseline written by WriteBaseline.
+ * @return 0 if nothing regressed, 1 if something did, SkipExitCode if the baseline can't be read
+ */
+int CompareWithBaseline(const std::string &path, unsigned thresholdPercent)
+{
+	std::ifstream in(path);
+	if (!in) {
+		std::fprintf(stderr, "No baseline at %s, write one with --write-baseline\n", path.c_str());
+		return SkipExitCode;
+	}
+
+	int result = 0;
+	std::string line;
+	while (std::getline(in, line)) {
+		std::istringstream fields(line);
+		std::string stageName;
+		uint32_t baseline[3];
+		if (!(fields >> stageName >> baseline[0] >> baseline[1] >> baseline[2]))
+			continue;
+		for (size_t i = 0; i < NumFrameStages; i++) {
+			const auto stage = static_cast<FrameStage>(i);
+			if (stageName != GetFrameStageName(stage))
+				continue;
+			const std::optional<FrameStagePercentiles> percentiles = GetFrameStagePercentiles(stage);
+			if (!percentiles) {
+				std::fprintf(stderr, "%s: no frames were timed\n", stageName.c_str());
+				result = 1;
+				break;
+			}
+			const uint32_t current[3] = { percentiles->medianUs, percentiles->p95Us, percentiles->p99Us };
+			constexpr const char *PercentileNames[3] = { "median", "p95", "p99" };
+			for (int j = 0; j < 3; j++) {
+				const uint64_t limit = static_cast<uint64_t>(baseline[j]) * (100 + thresholdPercent) / 100 + MinRegressionUs;
+				if (current[j] > limit) {
+					std::fprintf(stderr, "%s %s regressed: %u us, baseline %u us\n", stageName.c_str(), PercentileNames[j], current[j], baseline[j]);
+					result = 1;
+				}
+			}
+		}
+	}
+	return result;
+}
+
+bool ParseOptions(int argc, char **argv, BenchOptions &options)
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		if (std::strncmp(arg, "--", 2) != 0) {
+			options.demos.emplace_back(arg);
+			continue;
+		}
+		if (i + 1 == argc) {
+			std::fprintf(stderr, "Missing value for %s\n", arg);
+			return false;
+		}
+		const char *value = argv[++i];
+		if (std::strcmp(arg, "--baseline") == 0) {
+			options.baselinePath = value;
+		} else if (std::strcmp(arg, "--write-baseline") == 0) {
+			options.writeBaselinePath = value;
+		} else if (std::strcmp(arg, "--threshold") == 0) {
+			options.thresholdPercent = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+		} else {
+			std::fprintf(stderr, "Unknown option %s\n", arg);
+			return false;
+		}
+	}
+	if (options.demos.empty())
+		options.demos.emplace_back("WarriorLevel1to2");
+	if ((!options.baselinePath.empty() || !options.writeBaselinePath.empty()) && options.demos.size() != 1) {
+		std::fputs("A baseline is for a single timedemo\n", stderr);
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	BenchOptions options;
+	if (!ParseOptions(argc, argv, options))
+		return 1;
+	const std::vector<std::string> &demos = options.demos;
+
+#ifndef USE_SDL1
+	// Render off-screen unless the caller asked for a specific video driver.
+	if (SDL_getenv("SDL_VIDEODRIVER") == nullptr)
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+	sgOptions.Graphics.hardwareCursor.SetValue(false);
+#endif
+
+	// The archives and options are loaded without UI so that a missing MPQ fails fast.
+	HeadlessMode = true;
+	paths::SetPrefPath(paths::BasePath() + "/test/fixtures/timedemo/" + demos.front());
+	paths::SetConfigPath(paths::PrefPath());
+	LoadCoreArchives();
+	LoadGameArchives();
+	if (!spawn_mpq && !diabdat_mpq) {
+		std::fputs("The benchmark needs spawn.mpq or diabdat.mpq\n", stderr);
+		return SkipExitCode;
+	}
+	InitKeymapActions();
+	LoadOptions();
+	LanguageInitialize();
+
+	// Drawing is skipped in headless mode, so the benchmark runs with a real (by default dummy) window.
+	HeadlessMode = false;
+	init_create_window();
+
+	int result = 0;
+	std::string out = "[";
+	for (size_t i = 0; i < demos.size(); i++) {
+		if (i != 0)
+			out += ",";
+		const TimedemoResult timedemo = RunTimedemo(demos[i]);
+		out += timedemo.json;
+		if (!timedemo.sameOutcome)
+			result = 1;
+	}
+	out += "]\n";
+	std::fputs(out.c_str(), stdout);
+
+	// The demo must replay correctly for its timings to mean anything.
+	if (result == 0 && !options.writeBaselinePath.empty() && !WriteBaseline(options.writeBaselinePath)) {
+		std::fprintf(stderr, "Failed to write %s\n", options.writeBaselinePath.c_str());
+		result = 1;
+	}
+	if (result == 0 && !options.baselinePath.empty())
+		result = CompareWithBaseline(options.baselinePath, options.thresholdPercent);
+
+	init_cleanup();
+	return result;
+}
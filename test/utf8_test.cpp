@@ -79,5 +79,26 @@ TEST(Utf8CodeUnits, BasicLatin)
 	}
 }
 
+TEST(DecodeFirstUtf8CodePointTest, Ascii)
+{
+	std::size_t len;
+	EXPECT_EQ(DecodeFirstUtf8CodePoint("a€", &len), U'a');
+	EXPECT_EQ(len, 1U);
+	EXPECT_EQ(DecodeFirstUtf8CodePoint("€a", &len), U'€');
+	EXPECT_EQ(len, 3U);
+	EXPECT_EQ(DecodeFirstUtf8CodePoint("", &len), Utf8DecodeError);
+	EXPECT_EQ(len, 0U);
+}
+
+TEST(CountAsciiPrefixTest, StopsAtFirstMultiByteCodePoint)
+{
+	EXPECT_EQ(CountAsciiPrefix(""), 0U);
+	EXPECT_EQ(CountAsciiPrefix("abc"), 3U);
+	EXPECT_EQ(CountAsciiPrefix("Griswold's Edge"), 15U);
+	EXPECT_EQ(CountAsciiPrefix("Grüße aus Tristram"), 2U);
+	EXPECT_EQ(CountAsciiPrefix("Tristram, Khanduras, Grüße"), 23U);
+	EXPECT_EQ(CountAsciiPrefix("あ"), 0U);
+}
+
 } // namespace
 } // namespace devilution
@@ -346,6 +346,7 @@ TEST(Writehero, pfile_write_hero)
 	UnPackPlayer(&pks, *MyPlayer, true);
 	AssertPlayer(Players[0]);
 	pfile_write_hero();
+	pfile_wait_for_save();
 
 	std::ifstream f("multi_0.sv", std::ios::binary);
 	std::vector<unsigned char> s(picosha2::k_digest_size);